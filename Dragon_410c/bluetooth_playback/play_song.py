@@ -4,6 +4,8 @@
 import os, time
 import pygame
 import sys, random
+import json
+import serial
 
 #accepting type of song as a commandline argument
 song_type = sys.argv[1]
@@ -16,6 +18,42 @@ bitsize = -16
 channel = 2
 buff_size = 1024
 
+#QCLI command that loads the tempo track on the QCA4020, the sensors
+#group and its Tempo command by menu number
+tempo_command = "4 11"
+
+#Reading the tempo track kept next to the song as <song>.tempo, each
+#line is "<song_ms> <bpm>" and a line with only "<bpm>" starts at 0
+def load_tempo_track(song_path):
+    track = []
+    tempo_path = os.path.splitext(song_path)[0] + ".tempo"
+    if not os.path.exists(tempo_path):
+        return track
+
+    with open(tempo_path) as f:
+        for line in f:
+            fields = line.split("#")[0].split()
+            if len(fields) == 1:
+                track.append((0, fields[0]))
+            elif len(fields) == 2:
+                track.append((int(fields[0]), fields[1]))
+    return sorted(track)
+
+#Writing QCLI commands to the QCA4020 console
+def send_commands(commands):
+    try:
+        with open('config/config.json') as f:
+            config = json.load(f)
+        se = serial.Serial(config["SERIAL_COMM"]["serial_port"], 115200)
+    except (IOError, OSError, ValueError, KeyError, serial.SerialException) as e:
+        print("Unable to send the tempo track : ", e)
+        return
+    for command in commands:
+        se.write((command + "\r\n").encode())
+        #let QCLI take each line before the next
+        time.sleep(0.05)
+    se.close()
+
 #Creating a playlist and shuffle the song
 def create_playlist(mediapath):
     for path, directory, element in os.walk(mediapath, topdown = False):
@@ -30,15 +68,29 @@ def create_playlist(mediapath):
 
 #Playing the song 
 def play(mp3s):
+    song_path = mediapath + mp3s.pop()
+
+    #upload the tempo track so bulb effects land on the beats, without
+    #one the effects change as soon as motion does
+    track = load_tempo_track(song_path)
+    commands = [tempo_command + " clear"]
+    commands += ["%s add %d %s" % (tempo_command, song_ms, bpm) for song_ms, bpm in track]
+    send_commands(commands)
+
     start_time = time.time()
     pygame.mixer.init(freq, bitsize, channel, buff_size)
-    pygame.mixer.music.load(mediapath + mp3s.pop())
+    pygame.mixer.music.load(song_path)
     
     flag = 0
     while(int(time.time() - start_time) < 30):
         if(flag == 0):
             pygame.mixer.music.play(1, 0)
+            #the song clock starts with the playback
+            if track:
+                send_commands([tempo_command + " start 0"])
             flag = 1
+    if track:
+        send_commands([tempo_command + " stop"])
     return flag
         
 #Main function        
@@ -20,6 +20,7 @@ import logging
 import time
 import json
 import serial
+from telemetry.tlm_decode import TelemetryDecoder
 
 # Custom MQTT message callback
 def customCallback(client, userdata, message):
@@ -29,6 +30,22 @@ def customCallback(client, userdata, message):
     print(message.topic)
     print("--------------\n\n")
 
+# Stages of a "LAT,<id>,<effect>,<edge>,<decide>,<dequeue>,<issue>,<confirm>"
+# line, times are in us from the first stage recorded and -1 when missing
+LAT_STAGES = ["edge", "decide", "dequeue", "issue", "confirm"]
+
+def lat_trace_record(line):
+    fields = line.strip().split(",")
+    if len(fields) != 3 + len(LAT_STAGES):
+        return None
+    try:
+        record = {'id': int(fields[1]), 'effect': fields[2], 'received': time.time() * 1000}
+        for stage, value in zip(LAT_STAGES, fields[3:]):
+            record[stage] = int(value)
+    except ValueError:
+        return None
+    return record
+
 def aws_iot_pub():
     with open('../config/config.json') as f:
         config = json.load(f)
@@ -67,23 +84,40 @@ def aws_iot_pub():
     myAWSIoTMQTTClient.connect()
     time.sleep(2)
 
-    # Publish to AWS IoT when PIR motion is detected
+    # Publish to AWS IoT when PIR motion is detected. The board sends
+    # binary telemetry frames between its console text, the decoder splits
+    # the two apart.
     loopCount = 0
     se = serial.Serial(config["SERIAL_COMM"]["serial_port"], 115200)
+    latencyLog = open("lat_trace.csv", "a")
+    decoder = TelemetryDecoder()
 
     while True:
-        str = se.readline()
-        print (str)
-        if (str.find("MUSIC_FESTIVAL_DEMO: PIR sensor detected motion") != -1):
-            message = {}
-            message['message'] = time.time() * 1000
-            message['sequence'] = loopCount
-            messageJson = json.dumps(message)
-            myAWSIoTMQTTClient.publish(topic, messageJson, 1)
-            if mode == 'publish':
-                print('Published topic %s: %s\n' % (topic, messageJson))
-            loopCount += 1
-        #time.sleep(1)
+        for event in decoder.feed(se.read(max(1, se.in_waiting))):
+            if event['type'] == 'motion':
+                message = {}
+                message['message'] = time.time() * 1000
+                message['sequence'] = loopCount
+                message['device_ms'] = event['device_ms']
+                message['intensity_epm'] = event['intensity_epm']
+                message['level'] = event['level']
+                messageJson = json.dumps(message)
+                myAWSIoTMQTTClient.publish(topic, messageJson, 1)
+                if mode == 'publish':
+                    print('Published topic %s: %s\n' % (topic, messageJson))
+                loopCount += 1
+            elif event['type'] in ('effect', 'bulb'):
+                myAWSIoTMQTTClient.publish(topic + "/" + event['type'], json.dumps(event), 1)
+            elif event['type'] == 'text':
+                line = event['text']
+                print (line)
+                if (line.find("LAT,") != -1):
+                    # Latency trace record streamed by "Latency stream 1"
+                    record = lat_trace_record(line[line.find("LAT,"):])
+                    if record:
+                        latencyLog.write(",".join(line[line.find("LAT,"):].strip().split(",")[1:]) + "\n")
+                        latencyLog.flush()
+                        myAWSIoTMQTTClient.publish(topic + "/latency", json.dumps(record), 1)
 
 if __name__ == '__main__':
     aws_iot_pub()
@@ -17,5 +17,9 @@ if [ ! -d ./aws-iot-device-sdk-python ]; then
 fi
 
 pip install pyserial
+
+# build the decoder for the board's telemetry frames
+make -C telemetry
 printf "\nAWS_IOT_CLIENT-------> OK\n"
 printf "Pyserial ------> OK\n"
+printf "Telemetry decoder ------> OK\n"
@@ -0,0 +1,242 @@
+/*
+ * Decoder for the binary telemetry frames the QCA4020 Music_Demo2 sends
+ * on its console UART, see tlm_decode.h.
+ */
+#include <string.h>
+#include "tlm_decode.h"
+
+#define TLM_STATE_TEXT			(0)
+#define TLM_STATE_SYNC			(1)	/* sync0 seen */
+#define TLM_STATE_FRAME			(2)	/* both sync bytes seen */
+
+static uint32_t tlm_get16(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t tlm_get32(const uint8_t *p)
+{
+	return tlm_get16(p) | (tlm_get16(p + 2) << 16);
+}
+
+static uint16_t tlm_crc16(const uint8_t *data, uint32_t length)
+{
+	uint16_t crc = 0xFFFF;
+	uint32_t i;
+	int bit;
+
+	for (i = 0; i < length; i++)
+	{
+		crc ^= (uint16_t)data[i] << 8;
+		for (bit = 0; bit < 8; bit++)
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+	}
+
+	return crc;
+}
+
+static int tlm_emit_line(tlm_decoder_t *decoder, tlm_event_t *event)
+{
+	uint32_t length = decoder->line_length;
+
+	if (length && (decoder->line[length - 1] == '\r'))
+		length--;
+
+	memcpy(event->text, decoder->line, length);
+	event->text[length] = '\0';
+	event->length = length;
+	event->kind = TLM_EVENT_TEXT;
+
+	decoder->line_length = 0;
+	decoder->lines++;
+
+	return 1;
+}
+
+/*
+ * A frame that fails its CRC may have started on noise or had its
+ * length hit, so everything after its first sync byte is searched again
+ * for a frame, ahead of the bytes still waiting there. The rest of those
+ * bytes is dropped, they are rarely good text. The replay never holds
+ * more than one frame.
+ */
+static void tlm_replay_frame(tlm_decoder_t *decoder)
+{
+	uint32_t unread = decoder->replay_tail - decoder->replay_head;
+	uint32_t count = decoder->frame_length - 1;
+
+	memmove(&decoder->replay[count], &decoder->replay[decoder->replay_head], unread);
+	memcpy(decoder->replay, &decoder->frame[1], count);
+	decoder->replay_head = 0;
+	decoder->replay_tail = count + unread;
+	decoder->hunting = 1;
+}
+
+static int tlm_frame_done(tlm_decoder_t *decoder, tlm_event_t *event)
+{
+	uint32_t length = decoder->frame[2];
+	uint32_t crc = tlm_get16(&decoder->frame[TLM_HEADER_SIZE + length]);
+	uint32_t sequence = decoder->frame[4];
+
+	decoder->state = TLM_STATE_TEXT;
+
+	if (crc != tlm_crc16(&decoder->frame[2], TLM_HEADER_SIZE - 2 + length))
+	{
+		decoder->crc_errors++;
+		tlm_replay_frame(decoder);
+		return 0;
+	}
+
+	if (decoder->have_sequence && (sequence != decoder->next_sequence))
+		decoder->lost_frames += (sequence - decoder->next_sequence) & 0xFF;
+	decoder->next_sequence = (sequence + 1) & 0xFF;
+	decoder->have_sequence = 1;
+	decoder->frames++;
+
+	event->kind = TLM_EVENT_FRAME;
+	event->type = decoder->frame[3];
+	event->sequence = sequence;
+	event->timestamp_ms = tlm_get32(&decoder->frame[5]);
+	event->length = length;
+	memcpy(event->payload, &decoder->frame[TLM_HEADER_SIZE], length);
+
+	return 1;
+}
+
+static int tlm_feed_byte(tlm_decoder_t *decoder, uint8_t b, tlm_event_t *event)
+{
+	switch (decoder->state)
+	{
+		case TLM_STATE_SYNC:
+			if (b == TLM_SYNC_1)
+			{
+				decoder->frame[1] = b;
+				decoder->frame_length = 2;
+				decoder->state = TLM_STATE_FRAME;
+				return 0;
+			}
+
+			//a lone sync0 is noise, the byte after it is looked at as text
+			decoder->noise_bytes++;
+			decoder->state = TLM_STATE_TEXT;
+			return tlm_feed_byte(decoder, b, event);
+
+		case TLM_STATE_FRAME:
+			decoder->frame[decoder->frame_length++] = b;
+			if ((decoder->frame_length >= TLM_HEADER_SIZE) &&
+				(decoder->frame_length == TLM_HEADER_SIZE + decoder->frame[2] + TLM_CRC_SIZE))
+				return tlm_frame_done(decoder, event);
+			return 0;
+
+		default:
+			break;
+	}
+
+	if (b == TLM_SYNC_0)
+	{
+		decoder->frame[0] = b;
+		decoder->frame_length = 1;
+		decoder->state = TLM_STATE_SYNC;
+		decoder->hunting = 0;
+		return 0;
+	}
+
+	if (decoder->hunting)
+	{
+		decoder->noise_bytes++;
+		return 0;
+	}
+
+	if (b == '\n')
+		return tlm_emit_line(decoder, event);
+
+	//QCLI only prints ASCII
+	if (b & 0x80)
+	{
+		decoder->noise_bytes++;
+		return 0;
+	}
+
+	decoder->line[decoder->line_length++] = (char)b;
+	if (decoder->line_length == TLM_MAX_LINE)
+		return tlm_emit_line(decoder, event);
+
+	return 0;
+}
+
+static int tlm_drain_replay(tlm_decoder_t *decoder, tlm_event_t *event)
+{
+	while (decoder->replay_head < decoder->replay_tail)
+	{
+		if (tlm_feed_byte(decoder, decoder->replay[decoder->replay_head++], event))
+			return 1;
+	}
+
+	decoder->hunting = 0;
+
+	return 0;
+}
+
+void tlm_decoder_init(tlm_decoder_t *decoder)
+{
+	memset(decoder, 0, sizeof(*decoder));
+	decoder->state = TLM_STATE_TEXT;
+}
+
+size_t tlm_decoder_feed(tlm_decoder_t *decoder, const uint8_t *data, size_t length, tlm_event_t *event)
+{
+	size_t i;
+
+	event->kind = TLM_EVENT_NONE;
+
+	if (tlm_drain_replay(decoder, event))
+		return 0;
+
+	for (i = 0; i < length; i++)
+	{
+		if (tlm_feed_byte(decoder, data[i], event) || tlm_drain_replay(decoder, event))
+			return i + 1;
+	}
+
+	return length;
+}
+
+int tlm_parse_motion(const tlm_event_t *event, tlm_motion_t *motion)
+{
+	if ((event->kind != TLM_EVENT_FRAME) || (event->type != TLM_TYPE_MOTION) || (event->length < 8))
+		return -1;
+
+	motion->edge = tlm_get32(&event->payload[0]);
+	motion->intensity_epm = tlm_get16(&event->payload[4]);
+	motion->level = event->payload[6];
+	motion->window_edges = event->payload[7];
+
+	return 0;
+}
+
+int tlm_parse_effect(const tlm_event_t *event, tlm_effect_t *effect)
+{
+	if ((event->kind != TLM_EVENT_FRAME) || (event->type != TLM_TYPE_EFFECT) || (event->length < 12))
+		return -1;
+
+	effect->value = (uint64_t)tlm_get32(&event->payload[0]) | ((uint64_t)tlm_get32(&event->payload[4]) << 32);
+	effect->bulbs_ready = event->payload[8];
+	effect->bulbs_confirmed = event->payload[9];
+	effect->spread_ms = tlm_get16(&event->payload[10]);
+
+	return 0;
+}
+
+int tlm_parse_bulb(const tlm_event_t *event, tlm_bulb_t *bulb)
+{
+	if ((event->kind != TLM_EVENT_FRAME) || (event->type != TLM_TYPE_BULB) || (event->length < 12))
+		return -1;
+
+	bulb->index = event->payload[0];
+	bulb->state = event->payload[1];
+	memcpy(bulb->bd_addr, &event->payload[2], sizeof(bulb->bd_addr));
+	bulb->confirmed = event->payload[8];
+	bulb->latency_ms = tlm_get16(&event->payload[10]);
+
+	return 0;
+}
@@ -0,0 +1,108 @@
+/*
+ * Decoder for the binary telemetry frames the QCA4020 Music_Demo2 sends
+ * on its console UART between the QCLI text. The frame layout is set
+ * by src/qcli/qcli_api.h and the payloads by src/sensors/telemetry.h in
+ * the firmware, and must be kept in step with them.
+ *
+ *   sync0 sync1 length type sequence timestamp[4] payload[length] crc[2]
+ */
+#ifndef __TLM_DECODE_H__
+#define __TLM_DECODE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TLM_SYNC_0			(0xA5)
+#define TLM_SYNC_1			(0x5A)
+#define TLM_HEADER_SIZE			(9)
+#define TLM_CRC_SIZE			(2)
+#define TLM_MAX_PAYLOAD			(255)
+#define TLM_MAX_FRAME			(TLM_HEADER_SIZE + TLM_MAX_PAYLOAD + TLM_CRC_SIZE)
+#define TLM_MAX_LINE			(256)
+
+#define TLM_TYPE_MOTION			(1)
+#define TLM_TYPE_EFFECT			(2)
+#define TLM_TYPE_BULB			(3)
+
+#define TLM_LEVEL_NONE			(0xFF)
+
+/* what tlm_decoder_feed() found */
+#define TLM_EVENT_NONE			(0)
+#define TLM_EVENT_TEXT			(1)	/* a QCLI text line, without the line end */
+#define TLM_EVENT_FRAME			(2)	/* a frame that passed its CRC */
+
+typedef struct tlm_event_s
+{
+	uint32_t kind;
+	uint32_t type;
+	uint32_t sequence;
+	uint32_t timestamp_ms;
+	uint32_t length;			//payload bytes, or text bytes
+	uint8_t payload[TLM_MAX_PAYLOAD + 1];
+	char text[TLM_MAX_LINE + 1];		//NUL terminated
+} tlm_event_t;
+
+typedef struct tlm_motion_s
+{
+	uint32_t edge;				//edge number since the board started
+	uint32_t intensity_epm;
+	uint32_t level;				//0 slow, 1 medium, 2 fast or TLM_LEVEL_NONE
+	uint32_t window_edges;
+} tlm_motion_t;
+
+typedef struct tlm_effect_s
+{
+	uint64_t value;
+	uint32_t bulbs_ready;
+	uint32_t bulbs_confirmed;
+	uint32_t spread_ms;			//0 while the effect is still being written
+} tlm_effect_t;
+
+typedef struct tlm_bulb_s
+{
+	uint32_t index;
+	uint32_t state;				//0 scanned, 1 connecting, 2 discovering, 3 ready, 4 backoff
+	uint8_t bd_addr[6];			//as sent, BD_ADDR0 first
+	uint32_t confirmed;
+	uint32_t latency_ms;
+} tlm_bulb_t;
+
+typedef struct tlm_decoder_s
+{
+	uint32_t state;
+	uint8_t frame[TLM_MAX_FRAME];
+	uint32_t frame_length;
+	char line[TLM_MAX_LINE + 1];
+	uint32_t line_length;
+	uint8_t replay[TLM_MAX_FRAME];		//bytes to look at again after a bad frame
+	uint32_t replay_head;
+	uint32_t replay_tail;
+	uint32_t hunting;			//replaying, only a sync byte is of interest
+	uint32_t next_sequence;
+	uint32_t have_sequence;
+
+	/* counters, never cleared by the decoder */
+	uint32_t frames;
+	uint32_t lines;
+	uint32_t crc_errors;
+	uint32_t lost_frames;			//sequence gaps between good frames
+	uint32_t noise_bytes;			//non text bytes outside a frame
+} tlm_decoder_t;
+
+void tlm_decoder_init(tlm_decoder_t *decoder);
+
+/*
+ * Runs bytes through the decoder until one event is complete. Returns
+ * the number of bytes taken, the event is in *event and its kind is
+ * TLM_EVENT_NONE if all the bytes were taken without completing one.
+ * Call it again with the remaining bytes while it reports an event, it
+ * may report one without taking any bytes after a bad frame.
+ */
+size_t tlm_decoder_feed(tlm_decoder_t *decoder, const uint8_t *data, size_t length, tlm_event_t *event);
+
+/* the parsers return 0 on success, -1 if the event is not that frame */
+int tlm_parse_motion(const tlm_event_t *event, tlm_motion_t *motion);
+int tlm_parse_effect(const tlm_event_t *event, tlm_effect_t *effect);
+int tlm_parse_bulb(const tlm_event_t *event, tlm_bulb_t *bulb);
+
+#endif
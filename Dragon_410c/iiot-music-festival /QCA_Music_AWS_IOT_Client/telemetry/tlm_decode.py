@@ -0,0 +1,122 @@
+# Python binding of libtlm_decode.so, the decoder for the binary telemetry
+# frames the board sends between the QCLI text on its console UART.
+# Build the library with "make" in this directory.
+
+import ctypes
+import os
+
+TLM_MAX_PAYLOAD = 255
+TLM_MAX_FRAME = 9 + TLM_MAX_PAYLOAD + 2
+TLM_MAX_LINE = 256
+
+TLM_EVENT_NONE = 0
+TLM_EVENT_TEXT = 1
+TLM_EVENT_FRAME = 2
+
+LEVEL_NAMES = ["slow", "medium", "fast"]
+STATE_NAMES = ["scanned", "connecting", "discovering", "ready", "backoff"]
+
+# The structures below mirror tlm_decode.h
+class _Event(ctypes.Structure):
+    _fields_ = [("kind", ctypes.c_uint32),
+                ("type", ctypes.c_uint32),
+                ("sequence", ctypes.c_uint32),
+                ("timestamp_ms", ctypes.c_uint32),
+                ("length", ctypes.c_uint32),
+                ("payload", ctypes.c_uint8 * (TLM_MAX_PAYLOAD + 1)),
+                ("text", ctypes.c_char * (TLM_MAX_LINE + 1))]
+
+class _Motion(ctypes.Structure):
+    _fields_ = [("edge", ctypes.c_uint32),
+                ("intensity_epm", ctypes.c_uint32),
+                ("level", ctypes.c_uint32),
+                ("window_edges", ctypes.c_uint32)]
+
+class _Effect(ctypes.Structure):
+    _fields_ = [("value", ctypes.c_uint64),
+                ("bulbs_ready", ctypes.c_uint32),
+                ("bulbs_confirmed", ctypes.c_uint32),
+                ("spread_ms", ctypes.c_uint32)]
+
+class _Bulb(ctypes.Structure):
+    _fields_ = [("index", ctypes.c_uint32),
+                ("state", ctypes.c_uint32),
+                ("bd_addr", ctypes.c_uint8 * 6),
+                ("confirmed", ctypes.c_uint32),
+                ("latency_ms", ctypes.c_uint32)]
+
+class _Decoder(ctypes.Structure):
+    _fields_ = [("state", ctypes.c_uint32),
+                ("frame", ctypes.c_uint8 * TLM_MAX_FRAME),
+                ("frame_length", ctypes.c_uint32),
+                ("line", ctypes.c_char * (TLM_MAX_LINE + 1)),
+                ("line_length", ctypes.c_uint32),
+                ("replay", ctypes.c_uint8 * TLM_MAX_FRAME),
+                ("replay_head", ctypes.c_uint32),
+                ("replay_tail", ctypes.c_uint32),
+                ("hunting", ctypes.c_uint32),
+                ("next_sequence", ctypes.c_uint32),
+                ("have_sequence", ctypes.c_uint32),
+                ("frames", ctypes.c_uint32),
+                ("lines", ctypes.c_uint32),
+                ("crc_errors", ctypes.c_uint32),
+                ("lost_frames", ctypes.c_uint32),
+                ("noise_bytes", ctypes.c_uint32)]
+
+_lib = ctypes.CDLL(os.path.join(os.path.dirname(os.path.abspath(__file__)), "libtlm_decode.so"))
+_lib.tlm_decoder_feed.restype = ctypes.c_size_t
+_lib.tlm_decoder_feed.argtypes = [ctypes.POINTER(_Decoder), ctypes.c_void_p, ctypes.c_size_t, ctypes.POINTER(_Event)]
+
+def _bd_addr_str(bd_addr):
+    return ":".join("%02X" % b for b in reversed(list(bd_addr)))
+
+class TelemetryDecoder(object):
+    """Splits the console byte stream into text lines and telemetry frames."""
+
+    def __init__(self):
+        self._decoder = _Decoder()
+        self._event = _Event()
+        _lib.tlm_decoder_init(ctypes.byref(self._decoder))
+
+    def counters(self):
+        d = self._decoder
+        return {'frames': d.frames, 'lines': d.lines, 'crc_errors': d.crc_errors,
+                'lost_frames': d.lost_frames, 'noise_bytes': d.noise_bytes}
+
+    def feed(self, data):
+        """Yields a dict for every text line and frame completed by data."""
+        buf = ctypes.create_string_buffer(data, len(data))
+        base = ctypes.addressof(buf)
+        offset = 0
+        while True:
+            offset += _lib.tlm_decoder_feed(ctypes.byref(self._decoder), base + offset,
+                                            len(data) - offset, ctypes.byref(self._event))
+            if self._event.kind == TLM_EVENT_NONE:
+                break
+            yield self._parse(self._event)
+
+    def _parse(self, event):
+        if event.kind == TLM_EVENT_TEXT:
+            text = event.text
+            if not isinstance(text, str):
+                text = text.decode("ascii", "replace")
+            return {'type': 'text', 'text': text}
+
+        record = {'device_ms': event.timestamp_ms, 'frame_sequence': event.sequence}
+        motion = _Motion()
+        effect = _Effect()
+        bulb = _Bulb()
+        if _lib.tlm_parse_motion(ctypes.byref(event), ctypes.byref(motion)) == 0:
+            record.update({'type': 'motion', 'edge': motion.edge, 'intensity_epm': motion.intensity_epm,
+                           'level': LEVEL_NAMES[motion.level] if motion.level < len(LEVEL_NAMES) else None,
+                           'window_edges': motion.window_edges})
+        elif _lib.tlm_parse_effect(ctypes.byref(event), ctypes.byref(effect)) == 0:
+            record.update({'type': 'effect', 'value': "%016x" % effect.value, 'bulbs_ready': effect.bulbs_ready,
+                           'bulbs_confirmed': effect.bulbs_confirmed, 'spread_ms': effect.spread_ms})
+        elif _lib.tlm_parse_bulb(ctypes.byref(event), ctypes.byref(bulb)) == 0:
+            record.update({'type': 'bulb', 'index': bulb.index, 'bd_addr': _bd_addr_str(bulb.bd_addr),
+                           'state': STATE_NAMES[bulb.state] if bulb.state < len(STATE_NAMES) else bulb.state,
+                           'confirmed': bool(bulb.confirmed), 'latency_ms': bulb.latency_ms})
+        else:
+            record.update({'type': 'frame_%u' % event.type})
+        return record
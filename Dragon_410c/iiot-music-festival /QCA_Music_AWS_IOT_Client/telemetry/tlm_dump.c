@@ -0,0 +1,81 @@
+/*
+ * Prints the telemetry frames and text lines read from a file, a serial
+ * port set up beforehand (stty -F /dev/ttyUSB0 115200 raw) or stdin.
+ *
+ *   tlm_dump [file]
+ */
+#include <stdio.h>
+#include <inttypes.h>
+#include "tlm_decode.h"
+
+static const char *tlm_level_names[] = {"slow", "medium", "fast"};
+static const char *tlm_state_names[] = {"scanned", "connecting", "discovering", "ready", "backoff"};
+
+static void tlm_print(const tlm_event_t *event)
+{
+	tlm_motion_t motion;
+	tlm_effect_t effect;
+	tlm_bulb_t bulb;
+
+	if (event->kind == TLM_EVENT_TEXT)
+	{
+		printf("%s\n", event->text);
+	}
+	else if (!tlm_parse_motion(event, &motion))
+	{
+		printf("[%10u] motion edge %u, %u edges/min, level %s, %u in window\n", event->timestamp_ms,
+			motion.edge, motion.intensity_epm, (motion.level < 3) ? tlm_level_names[motion.level] : "none",
+			motion.window_edges);
+	}
+	else if (!tlm_parse_effect(event, &effect))
+	{
+		printf("[%10u] effect 0x%016" PRIx64 ", %u of %u bulbs, %u ms\n", event->timestamp_ms,
+			effect.value, effect.bulbs_confirmed, effect.bulbs_ready, effect.spread_ms);
+	}
+	else if (!tlm_parse_bulb(event, &bulb))
+	{
+		printf("[%10u] bulb %u %02X:%02X:%02X:%02X:%02X:%02X %s%s, last write %u ms\n", event->timestamp_ms,
+			bulb.index, bulb.bd_addr[5], bulb.bd_addr[4], bulb.bd_addr[3], bulb.bd_addr[2], bulb.bd_addr[1],
+			bulb.bd_addr[0], (bulb.state < 5) ? tlm_state_names[bulb.state] : "unknown",
+			bulb.confirmed ? " confirmed" : "", bulb.latency_ms);
+	}
+	else
+	{
+		printf("[%10u] frame type %u, %u bytes\n", event->timestamp_ms, event->type, event->length);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	static tlm_decoder_t decoder;
+	static tlm_event_t event;
+	uint8_t buffer[512];
+	FILE *input = stdin;
+	size_t length;
+	size_t offset;
+
+	if ((argc > 1) && ((input = fopen(argv[1], "rb")) == NULL))
+	{
+		perror(argv[1]);
+		return 1;
+	}
+
+	tlm_decoder_init(&decoder);
+
+	while ((length = fread(buffer, 1, sizeof(buffer), input)) > 0)
+	{
+		offset = 0;
+		do
+		{
+			offset += tlm_decoder_feed(&decoder, &buffer[offset], length - offset, &event);
+			if (event.kind != TLM_EVENT_NONE)
+				tlm_print(&event);
+			fflush(stdout);
+		} while (event.kind != TLM_EVENT_NONE);
+	}
+
+	fprintf(stderr, "%u frames, %u lines, %u bad CRC, %u lost, %u noise bytes\n", decoder.frames,
+		decoder.lines, decoder.crc_errors, decoder.lost_frames, decoder.noise_bytes);
+
+	return 0;
+}
@@ -0,0 +1,146 @@
+#!/usr/bin/python
+
+#============================================================================
+#
+# cpuProfilerSymbols main script
+#
+# GENERAL DESCRIPTION
+#    Post-link step that fills the CPU profiler symbol table of an image.
+#
+#    The QCLI_demo CPU profiler maps sampled PCs to functions with a sorted
+#    list of function start addresses. This script collects the addresses of
+#    every function symbol of the linked ELF (including the ROM functions
+#    linked in from the .sym files) and writes them into the
+#    g_cpu_profiler_symbol_table placeholder that cpu_profiler_demo.c reserves
+#    in its .cpu_profiler.symbols flash section, so the profiler needs no
+#    host to run.
+#
+#===============================================================================
+# Copyright (c) 2018 Qualcomm Technologies, Inc.
+# All Rights Reserved.
+# Copyright (c) 2018 Qualcomm Technologies, Inc.
+# All rights reserved.
+# Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below)
+# provided that the following conditions are met:
+# Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+# Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+# Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived
+# from this software without specific prior written permission.
+# NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE.
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+# BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+# OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+# EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#===============================================================================
+
+import elfManipulator.include.elfFileClass as elfFileClass
+import elfManipulator.include.elfConstants as const
+import optparse
+import struct
+from os.path import exists as pe
+
+tableSymbol = 'g_cpu_profiler_symbol_table'
+tableMagic = 0x50555043 # "CPUP", must match CPU_PROFILER_SYMBOL_TABLE_MAGIC
+
+# offsets in cpu_profiler_symbol_table_t
+tableMagicOffset = 0
+tableCapacityOffset = 4
+tableCountOffset = 8
+tableAddressesOffset = 12
+
+#============================================================================================
+#Collects the function start addresses of source_elf, writes them into the symbol
+#table placeholder and writes out target_elf. Returns 0 on success.
+#============================================================================================
+def cpu_profiler_fill_symbol_table(target_elf, source_elf):
+   elfObject = elfFileClass.elfFile(source_elf)
+
+   table = elfObject.getSymbolByName(tableSymbol)
+   if table == const.RC_ERROR:
+      print "cpuProfilerSymbols: " + tableSymbol + " not found, image is not built with the CPU profiler"
+      return 1
+
+   magic = elfObject.readDataByAddress(table.st_value + tableMagicOffset, 4)
+   capacity = elfObject.readDataByAddress(table.st_value + tableCapacityOffset, 4)
+   if magic != tableMagic:
+      print "cpuProfilerSymbols: " + tableSymbol + " has a bad magic value " + hex(magic)
+      return 1
+
+   addresses = getFunctionAddresses(elfObject)
+   if len(addresses) == 0:
+      print "cpuProfilerSymbols: no function symbols found"
+      return 1
+   if len(addresses) > capacity:
+      print "cpuProfilerSymbols: %d functions do not fit in a table of %d, increase CPU_PROFILER_SYMBOL_TABLE_CAPACITY" % (len(addresses), capacity)
+      return 1
+
+   section = getSectionByAddressRange(elfObject, table.st_value, tableAddressesOffset + 4 * capacity)
+   if section == const.RC_ERROR:
+      print "cpuProfilerSymbols: no section holds " + tableSymbol
+      return 1
+
+   # write the count and the addresses in one go, the table can be large
+   offset = table.st_value - section.sh_addr + tableCountOffset
+   data = struct.pack('<I', len(addresses)) + struct.pack('<%dI' % len(addresses), *addresses)
+   section.contents = "".join([section.contents[:offset], data, section.contents[offset + len(data):]])
+
+   print "cpuProfilerSymbols: %d functions from %s to %s" % (len(addresses), hex(addresses[0]), hex(addresses[-1]))
+   print "cpuProfilerSymbols: Saving the elf", target_elf
+   elfObject.writeOutELF(target_elf)
+   return 0
+
+#--------------------------------------------------------------------
+#Sorted, unique start addresses of the defined function symbols.
+#The ROM functions come from "name = address;" assignments in the .sym
+#files, they are untyped absolute symbols and are told apart from data
+#by the Thumb bit. Thumb function addresses have bit 0 set, it is cleared.
+#--------------------------------------------------------------------
+def getFunctionAddresses(elfObject):
+   symtab = elfObject.getSectionByName(".symtab")
+   strtab = elfObject.getSectionByName(".strtab")
+   addresses = set()
+   for symbol in elfFileClass.Elf32_SymGenerator(symtab, strtab):
+      symbolType = symbol.st_info & 0xf
+      if symbol.st_shndx == const.specialSectionsIndexes.SHN_UNDEF:
+         continue
+      if symbolType == const.symbolTypes.STT_FUNC:
+         addresses.add(symbol.st_value & ~1)
+      elif (symbolType == const.symbolTypes.STT_NOTYPE and
+            symbol.st_shndx == const.specialSectionsIndexes.SHN_ABS and
+            symbol.st_value & 1):
+         addresses.add(symbol.st_value & ~1)
+   return sorted(addresses)
+
+#--------------------------------------------------------------------
+#Section holding the whole [address, address + size) range
+#--------------------------------------------------------------------
+def getSectionByAddressRange(elfObject, address, size):
+   for section in elfObject.sectionHeaderTable:
+      if (section.sh_addr <= address and
+          address + size <= section.sh_addr + len(section.contents)):
+         return section
+   return const.RC_ERROR
+
+#----------------------------------------------------------------------------------------------
+#main function
+#----------------------------------------------------------------------------------------------
+def main():
+   use = "Usage: python %prog <Output ELF> <Input ELF>"
+   parser = optparse.OptionParser(usage = use, version="%prog 1.0")
+   options, arguments = parser.parse_args()
+
+   if len(arguments) != 2:
+      parser.error("Unexpected argument length")
+
+   if not pe(arguments[1]):
+      parser.error("Specified ELF file does not exist.")
+
+   exit(cpu_profiler_fill_symbol_table(arguments[0], arguments[1]))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,248 @@
+#!/usr/bin/python
+# Copyright (c) 2016-2018 Qualcomm Technologies, Inc.
+# All Rights Reserved.
+# Copyright (c) 2018 Qualcomm Technologies, Inc.
+# All rights reserved.
+# Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below)
+# provided that the following conditions are met:
+# Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+# Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+# Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived
+# from this software without specific prior written permission.
+# NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE.
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+# BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+# OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+
+''' Delta image for firmware upgrade
+
+A delta image rebuilds the new image from the image the device runs, so only
+the changes go on the air. The format is decoded by fw_upgrade_delta.c:
+
+  header  uint32 magic, uint32 source length, uint32 target length, SHA-256 of source
+  ADD     0x01 <zigzag varint source offset from end of last ADD> <varint length>
+          (<varint unchanged length> [<varint changed length> <changed bytes>])...
+  DATA    0x02 <varint length> <bytes>
+
+An ADD adds the changed bytes (mod 256) to the source bytes, so code which only
+moved keeps most of its bytes unchanged even when addresses in it changed.
+'''
+
+import struct
+import hashlib
+import logging
+import sys
+
+DELTA_MAGIC = 0x4C544446
+DELTA_HDR_FORMAT = '<III'
+DELTA_OP_ADD = 1
+DELTA_OP_DATA = 2
+
+MATCH_LEN = 16              # bytes hashed to find a match
+MATCH_STRIDE = 4            # source positions indexed
+MATCH_SLACK = 32            # score drop which ends an ADD
+SAME_GAP = 3                # unchanged bytes kept inside a changed run
+
+def put_varint(out, value):
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+
+def get_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        c = data[pos]
+        pos += 1
+        value |= (c & 0x7F) << shift
+        shift += 7
+        if c & 0x80 == 0:
+            return value, pos
+
+def extend_match(source, spos, target, tpos):
+    ''' Returns the length of the ADD at spos/tpos. Equal bytes score 1 and
+    different ones -1, the ADD ends at the best score. '''
+    limit = min(len(source) - spos, len(target) - tpos)
+    i = 0
+    score = 0
+    best = 0
+    best_len = 0
+    while i < limit:
+        n = min(64, limit - i)
+        if source[spos+i:spos+i+n] == target[tpos+i:tpos+i+n]:
+            i += n
+            score += n
+        else:
+            if source[spos+i] == target[tpos+i]:
+                score += 1
+            else:
+                score -= 1
+            i += 1
+        if score > best:
+            best = score
+            best_len = i
+        elif score < best - MATCH_SLACK:
+            break
+    return best_len
+
+def put_add(out, source, spos, target, tpos, length):
+    ''' ADD of length bytes, diff runs split on unchanged runs '''
+    diff = bytearray(length)
+    for i in range(length):
+        diff[i] = (target[tpos+i] - source[spos+i]) & 0xFF
+    put_varint(out, length)
+
+    i = 0
+    while i < length:
+        start = i
+        while i < length and diff[i] == 0:
+            i += 1
+        put_varint(out, i - start)
+        if i == length:
+            break
+        start = i
+        while i < length:
+            if diff[i] != 0:
+                i += 1
+                continue
+            same = i
+            while same < length and same - i < SAME_GAP and diff[same] == 0:
+                same += 1
+            if same == length or same - i >= SAME_GAP:
+                break
+            i = same
+        put_varint(out, i - start)
+        out.extend(diff[start:i])
+
+def put_data(out, target, start, end):
+    if end > start:
+        out.append(DELTA_OP_DATA)
+        put_varint(out, end - start)
+        out.extend(target[start:end])
+
+def create_delta(source, target):
+    ''' Returns the delta which rebuilds target from source '''
+    source = bytearray(source)
+    target = bytearray(target)
+    src = bytes(source)
+    tgt = bytes(target)
+
+    index = {}
+    for p in range(0, len(src) - MATCH_LEN + 1, MATCH_STRIDE):
+        index.setdefault(src[p:p+MATCH_LEN], p)
+
+    out = bytearray(struct.pack(DELTA_HDR_FORMAT, DELTA_MAGIC, len(source), len(target)))
+    out.extend(bytearray(hashlib.sha256(src).digest()))
+
+    src_pos = 0         # source position after last ADD
+    last_shift = None   # source - target position of last ADD
+    lit = 0             # first target byte not in a command yet
+    t = 0
+    while t + MATCH_LEN <= len(tgt):
+        key = tgt[t:t+MATCH_LEN]
+        spos = None
+        # keep on with the last ADD alignment, else look it up
+        if last_shift is not None and 0 <= t + last_shift <= len(src) - MATCH_LEN and src[t+last_shift:t+last_shift+MATCH_LEN] == key:
+            spos = t + last_shift
+        else:
+            spos = index.get(key)
+        if spos is None:
+            t += 1
+            continue
+
+        # extend back over bytes not in a command yet
+        tpos = t
+        while tpos > lit and spos > 0 and source[spos-1] == target[tpos-1]:
+            tpos -= 1
+            spos -= 1
+        length = extend_match(source, spos, target, tpos)
+
+        put_data(out, target, lit, tpos)
+        out.append(DELTA_OP_ADD)
+        offset = spos - src_pos
+        put_varint(out, (offset << 1) if offset >= 0 else ((-offset << 1) - 1))
+        put_add(out, source, spos, target, tpos, length)
+
+        src_pos = spos + length
+        last_shift = spos - tpos
+        t = tpos + length
+        lit = t
+
+    put_data(out, target, lit, len(target))
+    return out
+
+def apply_delta(source, delta):
+    ''' Rebuilds the target from source and delta, as the device does '''
+    source = bytearray(source)
+    delta = bytearray(delta)
+    hdr_len = struct.calcsize(DELTA_HDR_FORMAT)
+    magic, source_len, target_len = struct.unpack(DELTA_HDR_FORMAT, bytes(delta[:hdr_len]))
+    if magic != DELTA_MAGIC:
+        raise ValueError('not a delta image')
+    if source_len > len(source) or hashlib.sha256(bytes(source[:source_len])).digest() != bytes(delta[hdr_len:hdr_len+32]):
+        raise ValueError('delta is not for this source image')
+
+    target = bytearray()
+    src_pos = 0
+    pos = hdr_len + 32
+    while len(target) < target_len:
+        op = delta[pos]
+        pos += 1
+        if op == DELTA_OP_ADD:
+            value, pos = get_varint(delta, pos)
+            src_pos += (value >> 1) if (value & 1) == 0 else -((value + 1) >> 1)
+            length, pos = get_varint(delta, pos)
+            end = src_pos + length
+            while src_pos < end:
+                same, pos = get_varint(delta, pos)
+                target.extend(source[src_pos:src_pos+same])
+                src_pos += same
+                if src_pos == end:
+                    break
+                changed, pos = get_varint(delta, pos)
+                for i in range(changed):
+                    target.append((source[src_pos+i] + delta[pos+i]) & 0xFF)
+                src_pos += changed
+                pos += changed
+        elif op == DELTA_OP_DATA:
+            length, pos = get_varint(delta, pos)
+            target.extend(delta[pos:pos+length])
+            pos += length
+        else:
+            raise ValueError('bad delta command %d' % op)
+    if len(target) != target_len or pos != len(delta):
+        raise ValueError('delta length is not correct')
+    return target
+
+def main():
+    import argparse
+
+    parser = argparse.ArgumentParser(description='Tool to generate a delta between two firmware images\n\nExample Usage:\nRun: python gen_fw_delta.py --old old.bin --new new.bin --output new.delta',
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--old', type=str, required=True, help='The image the device runs')
+    parser.add_argument('--new', type=str, required=True, help='The image to upgrade to')
+    parser.add_argument('--output', type=str, required=True, help='The output file where to store the delta')
+    args = parser.parse_args()
+
+    with open(args.old, 'rb') as f:
+        old = f.read()
+    with open(args.new, 'rb') as f:
+        new = f.read()
+
+    delta = create_delta(old, new)
+    if apply_delta(old, delta) != bytearray(new):
+        sys.stderr.write('Delta does not rebuild the new image\n')
+        return 1
+
+    with open(args.output, 'wb') as f:
+        f.write(delta)
+    sys.stdout.write('Delta is %d bytes for %d bytes image\n' % (len(delta), len(new)))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,189 @@
+#!/usr/bin/python
+# Copyright (c) 2016-2018 Qualcomm Technologies, Inc.
+# All Rights Reserved.
+# Copyright (c) 2018 Qualcomm Technologies, Inc.
+# All rights reserved.
+# Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below)
+# provided that the following conditions are met:
+# Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+# Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+# Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived
+# from this software without specific prior written permission.
+# NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE.
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+# BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+# OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+
+''' Compressed image for firmware upgrade
+
+The image is sent compressed and decompressed by fw_upgrade_lz.c while it is
+received. The device keeps a window of WINDOW_SIZE bytes, a larger window is
+rejected by the device.
+
+  header    uint32 magic, uint32 image length, uint32 window size
+  sequence  <token> [<varint literal length - 15>] <literals> <uint16 offset> [<varint match length - 19>]
+
+The token holds the literal length in the high nibble and the match length -
+MIN_MATCH in the low one, 15 means a varint follows. The last sequence has only
+literals.
+'''
+
+import struct
+import logging
+import sys
+
+LZ_MAGIC = 0x5A4C4446
+LZ_HDR_FORMAT = '<III'
+WINDOW_SIZE = 1024
+MIN_MATCH = 4
+CHAIN_DEPTH = 32            # candidates tried for each position
+
+def put_varint(out, value):
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+
+def get_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        c = data[pos]
+        pos += 1
+        value |= (c & 0x7F) << shift
+        shift += 7
+        if c & 0x80 == 0:
+            return value, pos
+
+def put_sequence(out, literals, offset, length):
+    lit_len = len(literals)
+    match = length - MIN_MATCH if length > 0 else 0
+    out.append((min(lit_len, 15) << 4) | min(match, 15))
+    if lit_len >= 15:
+        put_varint(out, lit_len - 15)
+    out.extend(literals)
+    if length > 0:
+        out.extend(struct.pack('<H', offset))
+        if match >= 15:
+            put_varint(out, match - 15)
+
+def compress(data, window_size=WINDOW_SIZE):
+    ''' Returns the compressed image of data '''
+    data = bytearray(data)
+    raw = bytes(data)
+    size = len(data)
+    out = bytearray(struct.pack(LZ_HDR_FORMAT, LZ_MAGIC, size, window_size))
+
+    head = {}
+    prev = [-1] * size
+
+    def insert(pos):
+        key = raw[pos:pos+MIN_MATCH]
+        prev[pos] = head.get(key, -1)
+        head[key] = pos
+
+    def find(pos):
+        ''' longest match for pos, as (length, offset) '''
+        best = 0
+        offset = 0
+        cand = head.get(raw[pos:pos+MIN_MATCH], -1)
+        depth = CHAIN_DEPTH
+        while cand >= 0 and pos - cand <= window_size and depth > 0:
+            if data[cand+best:cand+best+1] == data[pos+best:pos+best+1]:
+                length = MIN_MATCH
+                while pos + length < size and data[cand+length] == data[pos+length]:
+                    length += 1
+                if length > best:
+                    best = length
+                    offset = pos - cand
+            cand = prev[cand]
+            depth -= 1
+        return best, offset
+
+    lit = 0
+    pos = 0
+    while pos + MIN_MATCH <= size:
+        length, offset = find(pos)
+        insert(pos)
+        if length < MIN_MATCH:
+            pos += 1
+            continue
+        # leave the byte as literal if a longer match starts at the next one
+        if pos + 1 + MIN_MATCH <= size and find(pos + 1)[0] > length:
+            pos += 1
+            continue
+
+        put_sequence(out, data[lit:pos], offset, length)
+        for p in range(pos + 1, min(pos + length, size - MIN_MATCH + 1)):
+            insert(p)
+        pos += length
+        lit = pos
+
+    if lit < size:
+        put_sequence(out, data[lit:], 0, 0)
+    return out
+
+def decompress(data):
+    ''' Returns the image of a compressed image, as the device does '''
+    data = bytearray(data)
+    hdr_len = struct.calcsize(LZ_HDR_FORMAT)
+    magic, size, window_size = struct.unpack(LZ_HDR_FORMAT, bytes(data[:hdr_len]))
+    if magic != LZ_MAGIC:
+        raise ValueError('not a compressed image')
+
+    out = bytearray()
+    pos = hdr_len
+    while len(out) < size:
+        token = data[pos]
+        pos += 1
+        lit_len = token >> 4
+        if lit_len == 15:
+            value, pos = get_varint(data, pos)
+            lit_len += value
+        out.extend(data[pos:pos+lit_len])
+        pos += lit_len
+        if len(out) >= size:
+            break
+        offset = data[pos] | (data[pos+1] << 8)
+        pos += 2
+        length = token & 0x0F
+        if length == 15:
+            value, pos = get_varint(data, pos)
+            length += value
+        length += MIN_MATCH
+        if offset == 0 or offset > window_size or offset > len(out):
+            raise ValueError('bad match offset %d' % offset)
+        for i in range(length):
+            out.append(out[-offset])
+    if len(out) != size or pos != len(data):
+        raise ValueError('compressed image length is not correct')
+    return out
+
+def main():
+    import argparse
+
+    parser = argparse.ArgumentParser(description='Tool to compress a firmware image\n\nExample Usage:\nRun: python gen_fw_lz.py --input new.bin --output new.lz',
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--input', type=str, required=True, help='The image to compress')
+    parser.add_argument('--output', type=str, required=True, help='The output file where to store the compressed image')
+    args = parser.parse_args()
+
+    with open(args.input, 'rb') as f:
+        data = f.read()
+
+    packed = compress(data)
+    if decompress(packed) != bytearray(data):
+        sys.stderr.write('Compressed image does not decompress to the image\n')
+        return 1
+
+    with open(args.output, 'wb') as f:
+        f.write(packed)
+    sys.stdout.write('Compressed image is %d bytes for %d bytes image\n' % (len(packed), len(data)))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -27,6 +27,13 @@ import hashlib
 import logging
 import os
 import sys
+import gen_fw_delta
+import gen_fw_lz
+
+# HASH_TYPE flag of an image which is sent as a delta against the active image
+HASH_TYPE_DELTA = 0x80000000
+# HASH_TYPE flag of an image which is sent compressed
+HASH_TYPE_COMPRESSED = 0x40000000
 
 class Fw_Upgrade_Img_Descriptor_Entry:
     ''' Firmware Upgrade Image Descriptor Entry, stores the data and translates it into
@@ -59,6 +66,8 @@ class Fw_Upgrade_Img_Descriptor_Entry:
         self.image_len = 0
         self.hash_type = 0
         self.hash = bytearray([0x00]*32)
+        self.delta_base = ""
+        self.compress = 0
 		
     def update_image_len (self, image_len):
         ''' Update the block size used for the entry. Changing the block size
@@ -89,6 +98,52 @@ class Fw_Upgrade_Img_Descriptor_Entry:
         self.hash = m.digest()
         return
 
+    def gen_payload(self, data):
+        ''' Generate what is sent for image data: the delta from the delta_base
+        image, which the device applies to the same image at its active FWD, and
+        compressed when it gets smaller. Returns the payload and the file suffix
+        for it, or None on failure. '''
+        payload = data
+        suffix = ''
+        if len(self.delta_base) > 0:
+            payload = self.gen_delta(data)
+            if payload is None:
+                return None
+            suffix = '.delta'
+
+        if self.compress != 0:
+            packed = gen_fw_lz.compress(payload)
+            if gen_fw_lz.decompress(packed) != bytearray(payload):
+                print 'Compressed %s does not decompress' % (self.filename)
+                return None
+            if len(packed) < len(payload):
+                logging.info('Compressed %s is %d bytes for %d bytes' % (self.filename, len(packed), len(payload)))
+                self.hash_type = self.hash_type | HASH_TYPE_COMPRESSED
+                payload = packed
+                suffix = suffix + '.lz'
+            else:
+                logging.info('%s does not compress, it is sent as is' % (self.filename))
+        return payload, suffix
+
+    def gen_delta(self, data):
+        ''' Generate the delta from the delta_base image to data. '''
+        try:
+            with open(self.delta_base, 'rb') as f:
+                base = f.read()
+        except IOError as e:
+            logging.exception("Unable to open the file '%s'\n" % (self.delta_base))
+            print "Can't open file %s" % (self.delta_base)
+            return None
+
+        delta = gen_fw_delta.create_delta(base, data)
+        if gen_fw_delta.apply_delta(base, delta) != bytearray(data):
+            print 'Delta from %s does not rebuild %s' % (self.delta_base, self.filename)
+            return None
+
+        self.hash_type = self.hash_type | HASH_TYPE_DELTA
+        logging.info('Delta of %s is %d bytes for %d bytes image' % (self.filename, len(delta), len(data)))
+        return delta
+
     def to_binary (self):
         ''' Convert the firmware descriptor entry into a packed binary
         form '''
@@ -106,6 +161,8 @@ class Fw_Upgrade_Img_Descriptor_Entry:
         ''' Parses the XML Root from an ElementTree, the XML data should
         look like:
 		<partition filename="ioe_ram_m4_free_rtos.mbn" signature="0x54445746" image_id="10" ver="1" HASH_TYPE="1"/>
+        delta_base is optional, it names the image the device runs and the image is sent as a delta against it
+        compress="1" is optional, the image is sent compressed
         '''
         if xml_root.tag != 'partition':
             raise AssertionError("Trying to parse something that is not a partition." % (size))
@@ -116,6 +173,8 @@ class Fw_Upgrade_Img_Descriptor_Entry:
         self.disk_size = int(xml_root.attrib['size_in_kb'], 0) * 1024
         self.signature = int(xml_root.attrib['signature'], 0)
         self.hash_type = int(xml_root.attrib['HASH_TYPE'], 0)
+        self.delta_base = xml_root.attrib.get('delta_base', '')
+        self.compress = int(xml_root.attrib.get('compress', '0'), 0)
 
         if self.image_id == 0:
             print '0 is not valid image id'
@@ -295,9 +354,19 @@ class Fw_Upgrade_Img_Descriptor:
                             temp.seek(0,0)
                             total_data = temp.read(total_size)
                             entry.update_hash(total_data)
-                            entry.update_image_len(size)
                             entry.update_disk_size(total_size)
 
+                            # A delta or compressed image is sent as its own file instead of the image
+                            result = entry.gen_payload(data)
+                            if result is None:
+                                return 0
+                            payload, suffix = result
+                            if len(suffix) > 0:
+                                entry.filename = entry.filename + suffix
+                                with open(entry.filename, 'wb') as d:
+                                    d.write(payload)
+                            entry.update_image_len(len(payload))
+
                             #close the temporary file and delete it.
                             temp.close()
                             os.remove('temp_file')
@@ -322,11 +391,18 @@ class Fw_Upgrade_Img_Descriptor:
                             f.seek(0,0)
                             data = f.read(size)
 
+                            #a delta or compressed image is sent instead of the image
+                            result = entry.gen_payload(data)
+                            if result is None:
+                                return 0
+                            payload = result[0]
+                            entry.update_disk_size(size)
+
                             #place it on the output file
-                            out.write(data)
+                            out.write(payload)
 
                             #update image len at partion entry
-                            entry.update_image_len(size)
+                            entry.update_image_len(len(payload))
                             
                             #update HASH at parttion entry
                             entry.update_hash(data)
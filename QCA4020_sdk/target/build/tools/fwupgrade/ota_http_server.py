@@ -0,0 +1,226 @@
+#!/usr/bin/python
+# Copyright (c) 2016-2018 Qualcomm Technologies, Inc.
+# All Rights Reserved.
+# Copyright (c) 2018 Qualcomm Technologies, Inc.
+# All rights reserved.
+# Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below)
+# provided that the following conditions are met:
+# Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+# Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+# Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived
+# from this software without specific prior written permission.
+# NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE.
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+# BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+# OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+
+''' HTTP server stand-in for firmware upgrade over HTTP
+
+Serves the files of a directory to the QCLI "fwup http" command. GET requests
+may carry a single "Range: bytes=<first>-[<last>]" header, which the HTTP
+plugin uses to fetch an image in ranges of flash blocks over two sessions and
+to resume a download. --no-range answers every request with the whole file,
+as a plain server would. --rate and --latency throttle the link so the plugin
+can be compared against the previous one on a known link.
+
+Each request is logged with its range and duration, each connection with its
+total size and throughput.
+
+  python ota_http_server.py -d <image dir> [-p 8080] [--rate KBps] [--latency ms]
+'''
+
+import os
+import re
+import sys
+import time
+import socket
+import logging
+import argparse
+import threading
+
+try:
+    from BaseHTTPServer import BaseHTTPRequestHandler, HTTPServer
+    from SocketServer import ThreadingMixIn
+except ImportError:
+    from http.server import BaseHTTPRequestHandler, HTTPServer
+    from socketserver import ThreadingMixIn
+
+SEND_CHUNK = 1460
+RANGE_RE = re.compile(r'^bytes=(\d*)-(\d*)$')
+
+class Stats(object):
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.bytes = 0
+        self.requests = 0
+        self.first = None
+        self.last = None
+
+    def add(self, start, end, nbytes):
+        with self.lock:
+            self.bytes += nbytes
+            self.requests += 1
+            if self.first is None or start < self.first:
+                self.first = start
+            if self.last is None or end > self.last:
+                self.last = end
+
+    def report(self):
+        with self.lock:
+            if self.requests and self.last > self.first:
+                elapsed = self.last - self.first
+                logging.info('%d requests, %d bytes in %.3f s, %.1f KB/s',
+                             self.requests, self.bytes, elapsed, self.bytes / 1024.0 / elapsed)
+            self.__init__()
+
+class ThreadedHTTPServer(ThreadingMixIn, HTTPServer):
+    daemon_threads = True
+    allow_reuse_address = True
+
+class OtaHandler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def log_message(self, format, *args):
+        logging.debug('%s %s', self.client_address[0], format % args)
+
+    def setup(self):
+        BaseHTTPRequestHandler.setup(self)
+        self.conn_bytes = 0
+        self.conn_start = time.time()
+
+    def finish(self):
+        BaseHTTPRequestHandler.finish(self)
+        elapsed = time.time() - self.conn_start
+        if self.conn_bytes:
+            logging.info('%s:%d closed, %d bytes in %.3f s, %.1f KB/s', self.client_address[0], self.client_address[1],
+                         self.conn_bytes, elapsed, self.conn_bytes / 1024.0 / max(elapsed, 1e-6))
+
+    def send_error_page(self, code, text, size=None):
+        body = ('%d %s\r\n' % (code, text)).encode('ascii')
+        self.send_response(code, text)
+        self.send_header('Content-Type', 'text/plain')
+        self.send_header('Content-Length', str(len(body)))
+        if size is not None:
+            self.send_header('Content-Range', 'bytes */%d' % size)
+        self.end_headers()
+        if self.command != 'HEAD':
+            self.wfile.write(body)
+
+    def parse_range(self, size):
+        ''' returns (first, last), None for the whole file, or False if not satisfiable '''
+        value = self.headers.get('Range')
+        if value is None or self.server.no_range:
+            return None
+        m = RANGE_RE.match(value.strip())
+        if m is None or (m.group(1) == '' and m.group(2) == ''):
+            return None
+        if m.group(1) == '':
+            # suffix range, the last N bytes
+            n = int(m.group(2))
+            if n == 0:
+                return False
+            return max(size - n, 0), size - 1
+        first = int(m.group(1))
+        last = int(m.group(2)) if m.group(2) != '' else size - 1
+        if first >= size or last < first:
+            return False
+        return first, min(last, size - 1)
+
+    def send_data(self, f, length):
+        rate = self.server.rate
+        start = time.time()
+        sent = 0
+        while sent < length:
+            data = f.read(min(SEND_CHUNK, length - sent))
+            if not data:
+                break
+            self.wfile.write(data)
+            sent += len(data)
+            if rate:
+                ahead = sent / float(rate) - (time.time() - start)
+                if ahead > 0:
+                    time.sleep(ahead)
+        return sent
+
+    def do_HEAD(self):
+        self.do_GET()
+
+    def do_GET(self):
+        start = time.time()
+        if self.server.latency:
+            time.sleep(self.server.latency)
+
+        name = os.path.normpath(self.path.split('?', 1)[0].lstrip('/'))
+        path = os.path.join(self.server.root, name)
+        if name.startswith('..') or not os.path.isfile(path):
+            self.send_error_page(404, 'Not Found')
+            return
+
+        size = os.path.getsize(path)
+        rng = self.parse_range(size)
+        if rng is False:
+            logging.info('%s %s range %s past the end of %d', self.client_address[0], name, self.headers.get('Range'), size)
+            self.send_error_page(416, 'Requested Range Not Satisfiable', size)
+            return
+
+        if rng is None:
+            first, last = 0, size - 1
+            self.send_response(200)
+        else:
+            first, last = rng
+            self.send_response(206)
+            self.send_header('Content-Range', 'bytes %d-%d/%d' % (first, last, size))
+        length = last - first + 1
+        self.send_header('Content-Type', 'application/octet-stream')
+        self.send_header('Content-Length', str(length))
+        self.send_header('Accept-Ranges', 'none' if self.server.no_range else 'bytes')
+        self.end_headers()
+        if self.command == 'HEAD':
+            return
+
+        with open(path, 'rb') as f:
+            f.seek(first)
+            sent = self.send_data(f, length)
+        self.wfile.flush()
+
+        end = time.time()
+        self.conn_bytes += sent
+        self.server.stats.add(start, end, sent)
+        logging.info('%s:%d %s %d-%d/%d %d bytes in %.3f s', self.client_address[0], self.client_address[1],
+                     name, first, last, size, sent, end - start)
+        # whole file sent, report the download
+        if last == size - 1:
+            self.server.stats.report()
+
+def main():
+    parser = argparse.ArgumentParser(description='HTTP server for firmware upgrade over HTTP, with Range support')
+    parser.add_argument('-d', '--dir', default='.', help='directory with the upgrade images')
+    parser.add_argument('-p', '--port', type=int, default=8080, help='TCP port, default 8080')
+    parser.add_argument('--rate', type=float, default=0, help='limit each response to KB/s, 0 for no limit')
+    parser.add_argument('--latency', type=float, default=0, help='delay in ms before each response')
+    parser.add_argument('--no-range', action='store_true', help='ignore Range: and always send the whole file')
+    parser.add_argument('-v', '--verbose', action='store_true', help='log every HTTP request line')
+    args = parser.parse_args()
+
+    logging.basicConfig(level=logging.DEBUG if args.verbose else logging.INFO,
+                        format='%(asctime)s %(message)s')
+
+    server = ThreadedHTTPServer(('', args.port), OtaHandler)
+    server.root = os.path.abspath(args.dir)
+    server.rate = int(args.rate * 1024)
+    server.latency = args.latency / 1000.0
+    server.no_range = args.no_range
+    server.stats = Stats()
+    logging.info('serving %s on port %d%s', server.root, args.port, ', ranges disabled' if args.no_range else '')
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    server.server_close()
+
+if __name__ == '__main__':
+    main()
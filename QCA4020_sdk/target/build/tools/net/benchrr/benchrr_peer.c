@@ -0,0 +1,722 @@
+/*
+ * Copyright (c) 2014-2018 Qualcomm Technologies, Inc.
+ * All Rights Reserved.
+ */
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below)
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE.
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/****************************************************************************************
+ * Request/response peer for the QCLI "benchrr" command
+ *
+ * Server mode answers TCP_RR, TCP_CRR and UDP_RR requests from a board running
+ * "benchrr <host> ...". Client mode runs the same tests against a board running
+ * "benchrr -s ...", timing transactions with microsecond resolution.
+ *
+ * Every request and response starts with the 16 byte header of net/bench.h:
+ * magic "BRR1", sequence number, request length and response length, all in
+ * network byte order. The responder echoes the header and pads the response to
+ * the requested length.
+***************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <poll.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+
+#define DEFAULT_PORT        5003
+#define RR_MAGIC            0x42525231
+#define RR_HDR_SIZE         16
+#define RR_MAX_SIZE         1400
+#define RR_MAX_DEPTH        16
+#define RR_MAX_CLIENTS      32
+#define UDP_TIMEOUT_US      1000000
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t req_len;
+    uint32_t resp_len;
+} rr_hdr_t;
+
+enum { TCP_RR, TCP_CRR, UDP_RR };
+
+// ============================================================================
+// Globals
+// ============================================================================
+
+/** Command-line options */
+static struct
+{
+    int server;
+    const char *host;
+    int port;
+    int mode;
+    int reqSize;
+    int respSize;
+    int seconds;
+    int depth;
+} opt = { 0, NULL, DEFAULT_PORT, TCP_RR, 64, 64, 10, 1 };
+
+static volatile sig_atomic_t quit;
+
+/** Latency of every completed transaction, in microseconds */
+static uint32_t *latency;
+static size_t latencyCount, latencySize;
+static unsigned long lost, late, errors;
+
+static void onSignal(int sig)
+{
+    (void)sig;
+    quit = 1;
+}
+
+static uint64_t nowUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void putHeader(char *buf, uint32_t seq, uint32_t reqLen, uint32_t respLen)
+{
+    rr_hdr_t hdr;
+
+    hdr.magic    = htonl(RR_MAGIC);
+    hdr.seq      = htonl(seq);
+    hdr.req_len  = htonl(reqLen);
+    hdr.resp_len = htonl(respLen);
+    memcpy(buf, &hdr, sizeof(hdr));
+}
+
+static int getHeader(const char *buf, rr_hdr_t *hdr)
+{
+    memcpy(hdr, buf, sizeof(*hdr));
+    hdr->magic    = ntohl(hdr->magic);
+    hdr->seq      = ntohl(hdr->seq);
+    hdr->req_len  = ntohl(hdr->req_len);
+    hdr->resp_len = ntohl(hdr->resp_len);
+
+    return (hdr->magic == RR_MAGIC && hdr->req_len >= RR_HDR_SIZE && hdr->req_len <= RR_MAX_SIZE &&
+            hdr->resp_len >= RR_HDR_SIZE && hdr->resp_len <= RR_MAX_SIZE) ? 0 : -1;
+}
+
+static int sendAll(int sd, const char *buf, int len)
+{
+    int sent = 0, rc;
+
+    while (sent < len)
+    {
+        rc = send(sd, buf + sent, len - sent, MSG_NOSIGNAL);
+        if (rc < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (rc <= 0)
+        {
+            return -1;
+        }
+        sent += rc;
+    }
+    return 0;
+}
+
+static int recvAll(int sd, char *buf, int len)
+{
+    int have = 0, rc;
+
+    while (have < len && !quit)
+    {
+        rc = recv(sd, buf + have, len - have, 0);
+        if (rc < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (rc <= 0)
+        {
+            return -1;
+        }
+        have += rc;
+    }
+    return (have == len) ? 0 : -1;
+}
+
+// ============================================================================
+// Server
+// ============================================================================
+
+/** State of one TCP connection, requests can arrive split or back to back */
+typedef struct
+{
+    int sd;
+    int have;
+    char buf[RR_MAX_SIZE];
+} client_t;
+
+static int serverSocket(int type)
+{
+    struct sockaddr_in6 addr;
+    int sd, on = 1, off = 0;
+
+    if ((sd = socket(AF_INET6, type, 0)) < 0)
+    {
+        perror("socket");
+        return -1;
+    }
+
+    setsockopt(sd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    setsockopt(sd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr   = in6addr_any;
+    addr.sin6_port   = htons(opt.port);
+
+    if (bind(sd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        (type == SOCK_STREAM && listen(sd, 8) < 0))
+    {
+        perror("bind");
+        close(sd);
+        return -1;
+    }
+    return sd;
+}
+
+/** Answers every complete request in the connection buffer. Returns how many, or -1 to close the connection. */
+static int serveClient(client_t *c)
+{
+    char resp[RR_MAX_SIZE];
+    rr_hdr_t hdr;
+    int rc, answered = 0;
+
+    rc = recv(c->sd, c->buf + c->have, sizeof(c->buf) - c->have, 0);
+    if (rc <= 0)
+    {
+        return -1;
+    }
+    c->have += rc;
+
+    while (c->have >= RR_HDR_SIZE)
+    {
+        if (getHeader(c->buf, &hdr) != 0)
+        {
+            fprintf(stderr, "Bad request, closing connection\n");
+            return -1;
+        }
+        if (c->have < (int)hdr.req_len)
+        {
+            break;
+        }
+
+        memset(resp, 0, hdr.resp_len);
+        putHeader(resp, hdr.seq, hdr.req_len, hdr.resp_len);
+        if (sendAll(c->sd, resp, hdr.resp_len) != 0)
+        {
+            return -1;
+        }
+
+        c->have -= hdr.req_len;
+        memmove(c->buf, c->buf + hdr.req_len, c->have);
+        answered++;
+    }
+    return answered;
+}
+
+static int server()
+{
+    struct pollfd fds[2 + RR_MAX_CLIENTS];
+    client_t *clients[RR_MAX_CLIENTS];
+    char buf[RR_MAX_SIZE];
+    struct sockaddr_storage from;
+    socklen_t fromLen;
+    rr_hdr_t hdr;
+    unsigned long answered = 0;
+    int nclients = 0, i, rc, sd, on = 1;
+
+    if ((fds[0].fd = serverSocket(SOCK_STREAM)) < 0 || (fds[1].fd = serverSocket(SOCK_DGRAM)) < 0)
+    {
+        return -1;
+    }
+    fds[0].events = fds[1].events = POLLIN;
+
+    printf("Answering TCP and UDP requests on port %d, Ctrl-C to stop\n", opt.port);
+
+    while (!quit)
+    {
+        for (i = 0; i < nclients; i++)
+        {
+            fds[2 + i].fd     = clients[i]->sd;
+            fds[2 + i].events = POLLIN;
+        }
+
+        if (poll(fds, 2 + nclients, 500) <= 0)
+        {
+            continue;
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            if ((sd = accept(fds[0].fd, NULL, NULL)) >= 0)
+            {
+                if (nclients == RR_MAX_CLIENTS)
+                {
+                    close(sd);
+                }
+                else
+                {
+                    setsockopt(sd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+                    clients[nclients] = calloc(1, sizeof(client_t));
+                    clients[nclients++]->sd = sd;
+                }
+            }
+        }
+
+        if (fds[1].revents & POLLIN)
+        {
+            fromLen = sizeof(from);
+            rc = recvfrom(fds[1].fd, buf, sizeof(buf), 0, (struct sockaddr *)&from, &fromLen);
+            if (rc >= RR_HDR_SIZE && getHeader(buf, &hdr) == 0)
+            {
+                memset(buf + RR_HDR_SIZE, 0, hdr.resp_len - RR_HDR_SIZE);
+                putHeader(buf, hdr.seq, hdr.req_len, hdr.resp_len);
+                sendto(fds[1].fd, buf, hdr.resp_len, 0, (struct sockaddr *)&from, fromLen);
+                answered++;
+            }
+        }
+
+        for (i = nclients - 1; i >= 0; i--)
+        {
+            if (fds[2 + i].revents == 0 || fds[2 + i].fd != clients[i]->sd)
+            {
+                continue;
+            }
+            if ((rc = serveClient(clients[i])) < 0)
+            {
+                close(clients[i]->sd);
+                free(clients[i]);
+                clients[i] = clients[--nclients];
+            }
+            else
+            {
+                answered += rc;
+            }
+        }
+    }
+
+    printf("\n%lu requests answered\n", answered);
+    return 0;
+}
+
+// ============================================================================
+// Client
+// ============================================================================
+
+static void record(uint64_t sentUs)
+{
+    if (latencyCount == latencySize)
+    {
+        latencySize = latencySize ? latencySize * 2 : 4096;
+        if ((latency = realloc(latency, latencySize * sizeof(*latency))) == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+    }
+    latency[latencyCount++] = (uint32_t)(nowUs() - sentUs);
+}
+
+static int connectTo(struct addrinfo *ai)
+{
+    int sd, on = 1;
+
+    if ((sd = socket(ai->ai_family, ai->ai_socktype, 0)) < 0)
+    {
+        perror("socket");
+        return -1;
+    }
+    if (ai->ai_socktype == SOCK_STREAM)
+    {
+        setsockopt(sd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+    if (connect(sd, ai->ai_addr, ai->ai_addrlen) < 0)
+    {
+        perror("connect");
+        close(sd);
+        return -1;
+    }
+    return sd;
+}
+
+static int sendRequest(int sd, char *buf, uint32_t seq)
+{
+    putHeader(buf, seq, opt.reqSize, opt.respSize);
+    return sendAll(sd, buf, opt.reqSize);
+}
+
+static int recvResponse(int sd, char *buf, uint32_t *seq)
+{
+    rr_hdr_t hdr;
+
+    if (recvAll(sd, buf, opt.respSize) != 0 || getHeader(buf, &hdr) != 0)
+    {
+        return -1;
+    }
+    *seq = hdr.seq;
+    return 0;
+}
+
+/** TCP_RR: up to opt.depth requests in flight on one connection, answered in order */
+static void clientTcpRr(struct addrinfo *ai, uint64_t endUs)
+{
+    char buf[RR_MAX_SIZE];
+    uint64_t sentUs[RR_MAX_DEPTH];
+    uint32_t next = 0, done = 0, seq;
+    int sd;
+
+    if ((sd = connectTo(ai)) < 0)
+    {
+        errors++;
+        return;
+    }
+    memset(buf, 0, sizeof(buf));
+
+    while (!quit)
+    {
+        while (next - done < (uint32_t)opt.depth && nowUs() < endUs)
+        {
+            sentUs[next % opt.depth] = nowUs();
+            if (sendRequest(sd, buf, next) != 0)
+            {
+                errors++;
+                goto done;
+            }
+            next++;
+        }
+        if (next == done)
+        {
+            break;
+        }
+        if (recvResponse(sd, buf, &seq) != 0 || seq != done)
+        {
+            errors++;
+            break;
+        }
+        record(sentUs[done % opt.depth]);
+        done++;
+    }
+done:
+    close(sd);
+}
+
+/** TCP_CRR: a new connection for every transaction, the latency includes the handshake */
+static void clientTcpCrr(struct addrinfo *ai, uint64_t endUs)
+{
+    char buf[RR_MAX_SIZE];
+    uint64_t startUs;
+    uint32_t next = 0, seq;
+    int sd;
+
+    memset(buf, 0, sizeof(buf));
+
+    while (!quit && nowUs() < endUs)
+    {
+        startUs = nowUs();
+        if ((sd = connectTo(ai)) < 0)
+        {
+            errors++;
+            break;
+        }
+        if (sendRequest(sd, buf, next) != 0 || recvResponse(sd, buf, &seq) != 0 || seq != next)
+        {
+            errors++;
+            close(sd);
+            break;
+        }
+        record(startUs);
+        next++;
+        close(sd);
+    }
+}
+
+/** UDP_RR: up to opt.depth requests in flight, unanswered ones are lost after UDP_TIMEOUT_US */
+static void clientUdpRr(struct addrinfo *ai, uint64_t endUs)
+{
+    char buf[RR_MAX_SIZE];
+    struct { uint32_t seq; uint64_t sentUs; int inUse; } slot[RR_MAX_DEPTH];
+    struct pollfd pfd;
+    rr_hdr_t hdr;
+    uint32_t next = 0;
+    uint64_t now;
+    int sd, i, outstanding = 0, rc;
+
+    if ((sd = connectTo(ai)) < 0)
+    {
+        errors++;
+        return;
+    }
+    memset(buf, 0, sizeof(buf));
+    memset(slot, 0, sizeof(slot));
+
+    while (!quit)
+    {
+        for (i = 0; i < opt.depth && nowUs() < endUs; i++)
+        {
+            if (slot[i].inUse)
+            {
+                continue;
+            }
+            slot[i].seq    = next;
+            slot[i].sentUs = nowUs();
+            putHeader(buf, next, opt.reqSize, opt.respSize);
+            if (send(sd, buf, opt.reqSize, 0) != opt.reqSize)
+            {
+                break;
+            }
+            slot[i].inUse = 1;
+            next++;
+            outstanding++;
+        }
+        if (outstanding == 0)
+        {
+            if (nowUs() >= endUs)
+            {
+                break;
+            }
+            usleep(1000);
+            continue;
+        }
+
+        pfd.fd     = sd;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, 10) > 0)
+        {
+            rc = recv(sd, buf, sizeof(buf), 0);
+            if (rc >= RR_HDR_SIZE && getHeader(buf, &hdr) == 0)
+            {
+                for (i = 0; i < opt.depth; i++)
+                {
+                    if (slot[i].inUse && slot[i].seq == hdr.seq)
+                    {
+                        break;
+                    }
+                }
+                if (i < opt.depth)
+                {
+                    record(slot[i].sentUs);
+                    slot[i].inUse = 0;
+                    outstanding--;
+                }
+                else
+                {
+                    late++;
+                }
+            }
+        }
+
+        now = nowUs();
+        for (i = 0; i < opt.depth; i++)
+        {
+            if (slot[i].inUse && now - slot[i].sentUs >= UDP_TIMEOUT_US)
+            {
+                slot[i].inUse = 0;
+                lost++;
+                outstanding--;
+            }
+        }
+    }
+    close(sd);
+}
+
+static int compareU32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static double percentile(double p)
+{
+    size_t idx = (size_t)(p * latencyCount + 0.999999);
+
+    if (idx > 0)
+    {
+        idx--;
+    }
+    if (idx >= latencyCount)
+    {
+        idx = latencyCount - 1;
+    }
+    return latency[idx] / 1000.0;
+}
+
+static int client()
+{
+    static const char *modeName[] = { "TCP_RR", "TCP_CRR", "UDP_RR" };
+    struct addrinfo hints, *ai;
+    char port[8];
+    uint64_t startUs, elapsedUs, sum = 0;
+    size_t i;
+    int rc;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = (opt.mode == UDP_RR) ? SOCK_DGRAM : SOCK_STREAM;
+    snprintf(port, sizeof(port), "%d", opt.port);
+
+    if ((rc = getaddrinfo(opt.host, port, &hints, &ai)) != 0)
+    {
+        fprintf(stderr, "%s: %s\n", opt.host, gai_strerror(rc));
+        return -1;
+    }
+
+    printf("%s test to %s port %d, request %d bytes, response %d bytes, %d in flight, %d seconds\n",
+           modeName[opt.mode], opt.host, opt.port, opt.reqSize, opt.respSize, opt.depth, opt.seconds);
+
+    startUs = nowUs();
+    switch (opt.mode)
+    {
+        case TCP_RR:  clientTcpRr(ai, startUs + opt.seconds * 1000000ULL); break;
+        case TCP_CRR: clientTcpCrr(ai, startUs + opt.seconds * 1000000ULL); break;
+        case UDP_RR:  clientUdpRr(ai, startUs + opt.seconds * 1000000ULL); break;
+    }
+    elapsedUs = nowUs() - startUs;
+    freeaddrinfo(ai);
+
+    printf("\n%zu transactions in %.3f seconds (%lu lost, %lu late, %lu errors)\n",
+           latencyCount, elapsedUs / 1e6, lost, late, errors);
+    printf("Transactions/sec: %.1f\n", elapsedUs ? latencyCount * 1e6 / elapsedUs : 0.0);
+
+    if (latencyCount)
+    {
+        qsort(latency, latencyCount, sizeof(*latency), compareU32);
+        for (i = 0; i < latencyCount; i++)
+        {
+            sum += latency[i];
+        }
+        printf("Latency: min %.3f avg %.3f p50 %.3f p90 %.3f p99 %.3f p99.9 %.3f max %.3f ms\n",
+               latency[0] / 1000.0, (double)sum / latencyCount / 1000.0, percentile(0.5), percentile(0.9),
+               percentile(0.99), percentile(0.999), latency[latencyCount - 1] / 1000.0);
+    }
+
+    free(latency);
+    return errors ? -1 : 0;
+}
+
+// ============================================================================
+// Command line
+// ============================================================================
+
+static void printUsage(char *argv[])
+{
+    printf("Usage: %s -s [-p port]\n", argv[0]);
+    printf("       %s -c host [-p port] [-m tcp_rr|tcp_crr|udp_rr] [-r request_size] [-R response_size]\n", argv[0]);
+    printf("          [-t seconds] [-d depth]\n\n");
+    printf("  -s  answer requests from \"benchrr <this host> ...\" on the board\n");
+    printf("  -c  measure a board running \"benchrr -s <port> <tcp|udp>\"\n");
+    printf("  -p  port, %d by default\n", DEFAULT_PORT);
+    printf("  -m  test, tcp_rr by default\n");
+    printf("  -r  request size, -R response size, %d to %d bytes, 64 by default\n", RR_HDR_SIZE, RR_MAX_SIZE);
+    printf("  -t  test time, 10 seconds by default\n");
+    printf("  -d  requests in flight, 1 to %d, 1 by default (tcp_crr always uses 1)\n", RR_MAX_DEPTH);
+}
+
+static void parseInt(char *argv[], const char *optionName, const char *value, int *result, int min, int max)
+{
+    char *end;
+    long v = strtol(value, &end, 0);
+
+    if (*value == '\0' || *end != '\0' || v < min || v > max)
+    {
+        fprintf(stderr, "Invalid value for %s: %s\n", optionName, value);
+        printUsage(argv);
+        exit(1);
+    }
+    *result = (int)v;
+}
+
+static void parseCommandLine(int argc, char *argv[])
+{
+    int c;
+
+    while ((c = getopt(argc, argv, "sc:p:m:r:R:t:d:h")) != -1)
+    {
+        switch (c)
+        {
+            case 's': opt.server = 1; break;
+            case 'c': opt.host = optarg; break;
+            case 'p': parseInt(argv, "-p", optarg, &opt.port, 1, 65535); break;
+            case 'r': parseInt(argv, "-r", optarg, &opt.reqSize, RR_HDR_SIZE, RR_MAX_SIZE); break;
+            case 'R': parseInt(argv, "-R", optarg, &opt.respSize, RR_HDR_SIZE, RR_MAX_SIZE); break;
+            case 't': parseInt(argv, "-t", optarg, &opt.seconds, 1, 86400); break;
+            case 'd': parseInt(argv, "-d", optarg, &opt.depth, 1, RR_MAX_DEPTH); break;
+            case 'm':
+                if (strcasecmp(optarg, "tcp_rr") == 0)
+                    opt.mode = TCP_RR;
+                else if (strcasecmp(optarg, "tcp_crr") == 0)
+                    opt.mode = TCP_CRR;
+                else if (strcasecmp(optarg, "udp_rr") == 0)
+                    opt.mode = UDP_RR;
+                else
+                {
+                    fprintf(stderr, "Invalid test: %s\n", optarg);
+                    exit(1);
+                }
+                break;
+            default:
+                printUsage(argv);
+                exit(1);
+        }
+    }
+
+    if (opt.server == (opt.host != NULL))
+    {
+        printUsage(argv);
+        exit(1);
+    }
+    if (opt.mode == TCP_CRR)
+    {
+        opt.depth = 1;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    struct sigaction sa;
+
+    parseCommandLine(argc, argv);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onSignal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    return ((opt.server ? server() : client()) == 0) ? 0 : 1;
+}
@@ -136,6 +136,22 @@ typedef qapi_Fw_Upgrade_Status_Code_t (*qapi_Fw_Upgrade_Plugin_Abort_t)(void);
  */
 typedef qapi_Fw_Upgrade_Status_Code_t (*qapi_Fw_Upgrade_Plugin_Resume_t)(const char* interface_name, const char *url, const uint32_t offset);
 
+/**
+ * Declaration of an optional callback function called by the firmware upgrade state machine to receive
+ * a packet from the plugin without copying it.
+ * The plugin module implements this callback and returns a pointer to its own receive buffer. The
+ * buffer must stay valid until the next receive callback, or until the finish or abort callback is invoked.
+ * The application passes this callback as a parameter to the qapi_Fw_Upgrade() API.
+ *
+ * @param[out] buffer      Pointer to the received data.
+ * @param[in]  buf_len     Maximum data size to return.
+ * @param[out] ret_size    Received data size.
+ *
+ * @return
+ * Status defined by enum #qapi_Fw_Upgrade_Status.
+ */
+typedef qapi_Fw_Upgrade_Status_Code_t (*qapi_Fw_Upgrade_Plugin_Recv_Buffer_t)(uint8_t **buffer, uint32_t buf_len, uint32_t *ret_size);
+
 
 /**
  * Represents a set of firmware upgrade plugin callbacks.
@@ -155,6 +171,8 @@ typedef struct {
     /**< Firmware upgrade plugin resume callback. */
     qapi_Fw_Upgrade_Plugin_Fin_t       fw_Upgrade_Plugin_Fin;
     /**< Firmware upgrade plugin finish callback. */
+    qapi_Fw_Upgrade_Plugin_Recv_Buffer_t fw_Upgrade_Plugin_Recv_Buffer;
+    /**< Optional callback to retrieve data without a copy, NULL if not supported. */
 } qapi_Fw_Upgrade_Plugin_t;
 
 /** @} */ /* end_addtogroup qapi_Fw_Upgrade */ 
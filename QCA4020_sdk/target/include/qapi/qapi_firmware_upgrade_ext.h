@@ -214,6 +214,8 @@ typedef enum qapi_Fw_Upgrade_Status{
     QAPI_FW_UPGRADE_ERR_CREATE_THREAD_ERROR_E,
     /**< Firmware upgrade create thread failure */
     QAPI_FW_UPGRADE_ERR_PRESERVE_LAST_FAILED_E,
+    QAPI_FW_UPGRADE_ERR_DELTA_SOURCE_MISMATCH_E,
+    /**< Delta image was not generated against the active image. */
 } /** @cond */ qapi_Fw_Upgrade_Status_Code_t /** @endcond */;
 
 /** @} */ /* end_addtogroup qapi_Fw_Upgrade */ 
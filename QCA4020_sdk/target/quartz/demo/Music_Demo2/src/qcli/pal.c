@@ -26,6 +26,7 @@
  *-----------------------------------------------------------------------*/
 
 #include <stdio.h>
+#include <string.h>
 
 #include "qapi_types.h"
 
@@ -96,12 +97,22 @@
 
 #define PAL_EVENT_MASK_RECEIVE                          (0x00000001)
 #define PAL_EVENT_MASK_TRANSMIT                         (0x00000002)
+#define PAL_EVENT_MASK_TRANSMIT_PENDING                 (0x00000004)
 
 #define PAL_THREAD_STACK_SIZE                           (3072)
 #define PAL_THREAD_PRIORITY                             (10)
 
-#define PAL_ENTER_CRITICAL()                            do { __asm("cpsid i"); } while(0)
-#define PAL_EXIT_CRITICAL()                             do { __asm("cpsie i"); } while(0)
+/* The transmit thread mostly waits on the UART so it runs at the QCLI
+   priority to keep the buffer draining. */
+#define PAL_TRANSMIT_BUFFER_SIZE                        (2048)
+#define PAL_TRANSMIT_THREAD_STACK_SIZE                  (1024)
+#define PAL_TRANSMIT_THREAD_PRIORITY                    (10)
+
+/* How long PAL_Console_Flush() waits for the buffer to drain, in ticks. */
+#define PAL_TRANSMIT_FLUSH_TICKS                        (200)
+
+#define PAL_ENTER_CRITICAL()                            do { __asm volatile("cpsid i" : : : "memory"); } while(0)
+#define PAL_EXIT_CRITICAL()                             do { __asm volatile("cpsie i" : : : "memory"); } while(0)
 
 /* The following is a simple macro to facilitate printing strings directly
    to the console. As it uses the sizeof operator on the size of the string
@@ -190,6 +201,25 @@ typedef struct PAL_Context_s
    volatile uint32_t  Rx_Buffers_Free;
    volatile uint32_t  BytesToTx;
    qurt_signal_t      Event;
+
+   /* The transmit buffer is a ring, the indexes run free and are only
+      reduced modulo the size when the buffer is accessed.  A writer
+      reserves its space by moving Tx_Reserve_Index and copies its data
+      with interrupts enabled.  The last writer to finish moves Tx_In_Index
+      up to Tx_Reserve_Index, so the transmit thread only sees complete
+      data.  Interrupts are masked only while the indexes are updated, only
+      the transmit thread moves Tx_Out_Index. */
+   char               Tx_Buffer[PAL_TRANSMIT_BUFFER_SIZE];
+   volatile uint32_t  Tx_Reserve_Index;
+   volatile uint32_t  Tx_In_Index;
+   volatile uint32_t  Tx_Writers;
+   volatile uint32_t  Tx_Out_Index;
+   volatile qbool_t   Tx_Idle;
+   qbool_t            Tx_Thread_Running;
+   qurt_signal_t      Tx_Event;
+   qurt_thread_t      QCLI_Thread_Handle;
+   PAL_Tx_Policy_t    Tx_Policy;
+   PAL_Console_Stats_t Tx_Stats;
 } PAL_Context_t;
 
 
@@ -207,6 +237,7 @@ static void Initialize_Samples(void);
 static void Uart_Tx_CB(uint32 num_bytes, void* cb_data);
 static void Uart_Rx_CB(uint32 num_bytes, void* cb_data);
 static void QCLI_Thread(void *Param);
+static void Console_Tx_Thread(void *Param);
 static qbool_t PAL_Initialize(void);
 
 /*-------------------------------------------------------------------------
@@ -243,7 +274,7 @@ static void Uart_Tx_CB(uint32 Num_Bytes, void* CB_Data)
       PAL_Context.BytesToTx -= Num_Bytes;
       if(PAL_Context.BytesToTx == 0)
       {
-         qurt_signal_set(&(PAL_Context.Event), PAL_EVENT_MASK_TRANSMIT);
+         qurt_signal_set(&(PAL_Context.Tx_Event), PAL_EVENT_MASK_TRANSMIT);
       }
    }
 }
@@ -297,6 +328,7 @@ static void QCLI_Thread(void *Param)
 {
    uint32_t CurrentIndex;
 
+   PAL_Context.QCLI_Thread_Handle = qurt_thread_get_id();
 
    /* Display the initialize command list. */
    QCLI_Display_Command_List();
@@ -331,6 +363,126 @@ static void QCLI_Thread(void *Param)
    }
 }
 
+/**
+   @brief This function sends the contents of the transmit buffer.
+
+   Everything written since the last transmit is sent with a single UART
+   transmit (two if it wraps the end of the buffer), so writers never wait
+   on the UART themselves.
+*/
+static void Console_Tx_Thread(void *Param)
+{
+   uint32_t Offset;
+   uint32_t Length;
+
+   while(true)
+   {
+      qurt_signal_wait(&(PAL_Context.Tx_Event), PAL_EVENT_MASK_TRANSMIT_PENDING, QURT_SIGNAL_ATTR_WAIT_ANY | QURT_SIGNAL_ATTR_CLEAR_MASK);
+
+      PAL_Context.Tx_Idle = false;
+
+      while(((Length = PAL_Context.Tx_In_Index - PAL_Context.Tx_Out_Index) != 0) && (PAL_Context.Uart_Enabled))
+      {
+         Offset = PAL_Context.Tx_Out_Index % PAL_TRANSMIT_BUFFER_SIZE;
+         if(Length > PAL_TRANSMIT_BUFFER_SIZE - Offset)
+         {
+            Length = PAL_TRANSMIT_BUFFER_SIZE - Offset;
+         }
+
+         PAL_Context.BytesToTx = Length;
+         PAL_Context.Tx_Stats.Transmits ++;
+
+         if(qapi_UART_Transmit(PAL_Context.Console_UART, &(PAL_Context.Tx_Buffer[Offset]), Length, NULL) == QAPI_OK)
+         {
+            /* Wait for the packet to be sent. */
+            qurt_signal_wait(&(PAL_Context.Tx_Event), PAL_EVENT_MASK_TRANSMIT, QURT_SIGNAL_ATTR_WAIT_ANY | QURT_SIGNAL_ATTR_CLEAR_MASK);
+         }
+
+         /* The data is released even if the transmit failed so that the
+            buffer cannot stall. */
+         PAL_Context.Tx_Out_Index += Length;
+      }
+
+      /* Writers only signal an idle thread, so check again after going
+         idle in case a write slipped in. */
+      PAL_Context.Tx_Idle = true;
+      if((PAL_Context.Tx_In_Index != PAL_Context.Tx_Out_Index) && (PAL_Context.Uart_Enabled))
+      {
+         qurt_signal_set(&(PAL_Context.Tx_Event), PAL_EVENT_MASK_TRANSMIT_PENDING);
+      }
+   }
+}
+
+/**
+   @brief This function copies data to the transmit buffer if there is
+          room for all of it.
+
+   Interrupts are masked only to reserve the space and to publish it, the
+   copy itself runs with interrupts enabled.
+
+   @return true if the data was buffered.
+*/
+static qbool_t Console_Tx_Put(uint32_t Length, const char *Buffer)
+{
+   uint32_t Offset;
+   uint32_t First;
+   uint32_t Used;
+   qbool_t  Ret_Val;
+
+   PAL_ENTER_CRITICAL();
+
+   Used = PAL_Context.Tx_Reserve_Index - PAL_Context.Tx_Out_Index;
+   if(Length <= PAL_TRANSMIT_BUFFER_SIZE - Used)
+   {
+      Offset = PAL_Context.Tx_Reserve_Index % PAL_TRANSMIT_BUFFER_SIZE;
+
+      PAL_Context.Tx_Reserve_Index += Length;
+      PAL_Context.Tx_Writers ++;
+      Used += Length;
+
+      PAL_Context.Tx_Stats.Bytes_Written += Length;
+      if(Used > PAL_Context.Tx_Stats.High_Water)
+      {
+         PAL_Context.Tx_Stats.High_Water = Used;
+      }
+
+      Ret_Val = true;
+   }
+   else
+   {
+      Ret_Val = false;
+   }
+
+   PAL_EXIT_CRITICAL();
+
+   if(Ret_Val)
+   {
+      /* The reserved space belongs to this writer until it is published. */
+      First = PAL_TRANSMIT_BUFFER_SIZE - Offset;
+      if(First > Length)
+      {
+         First = Length;
+      }
+
+      memcpy(&(PAL_Context.Tx_Buffer[Offset]), Buffer, First);
+      memcpy(PAL_Context.Tx_Buffer, &(Buffer[First]), Length - First);
+
+      /* Publish everything reserved so far once no other writer is still
+         copying into it. */
+      PAL_ENTER_CRITICAL();
+
+      PAL_Context.Tx_Writers --;
+      if(PAL_Context.Tx_Writers == 0)
+      {
+         PAL_Context.Tx_In_Index = PAL_Context.Tx_Reserve_Index;
+      }
+
+      PAL_EXIT_CRITICAL();
+   }
+
+   return(Ret_Val);
+}
+
 /**
    @brief This function is used to initialize the Platform, predominately
           the console port.
@@ -345,6 +497,9 @@ static qbool_t PAL_Initialize(void)
 
    memset(&PAL_Context, 0, sizeof(PAL_Context));
    PAL_Context.Rx_Buffers_Free = PAL_RECIEVE_BUFFER_COUNT;
+   PAL_Context.Tx_Idle         = true;
+   PAL_Context.Tx_Policy       = PAL_TX_POLICY_DROP_E;
+   qurt_signal_init(&(PAL_Context.Tx_Event));
 
    Ret_Val = PAL_Uart_Init();
 
@@ -401,6 +556,19 @@ void app_start(qbool_t ColdBoot)
 
    if(PAL_Context.Initialized)
    {
+      /* Start the console transmit thread. */
+      qurt_thread_attr_init(&Thread_Attribte);
+      qurt_thread_attr_set_name(&Thread_Attribte, "Console Tx");
+      qurt_thread_attr_set_priority(&Thread_Attribte, PAL_TRANSMIT_THREAD_PRIORITY);
+      qurt_thread_attr_set_stack_size(&Thread_Attribte, PAL_TRANSMIT_THREAD_STACK_SIZE);
+      if(qurt_thread_create(&Thread_Handle, &Thread_Attribte, Console_Tx_Thread, NULL) == QURT_EOK)
+      {
+         PAL_Context.Tx_Thread_Running = true;
+
+         /* Send whatever was written during initialization. */
+         qurt_signal_set(&(PAL_Context.Tx_Event), PAL_EVENT_MASK_TRANSMIT_PENDING);
+      }
+
       /* Start the main demo thread. */
       qurt_thread_attr_init(&Thread_Attribte);
       qurt_thread_attr_set_name(&Thread_Attribte, "QCLI Thread");
@@ -446,6 +614,12 @@ qbool_t PAL_Uart_Init(void)
          qapi_UART_Receive(PAL_Context.Console_UART, (char *)(PAL_Context.Rx_Buffer[Index]), PAL_RECIEVE_BUFFER_SIZE, (void *)Index);
       }
 
+      /* Send anything left over from before the UART was turned off. */
+      if(PAL_Context.Tx_Thread_Running)
+      {
+         qurt_signal_set(&(PAL_Context.Tx_Event), PAL_EVENT_MASK_TRANSMIT_PENDING);
+      }
+
       Ret_Val = true;
    }
    else
@@ -464,30 +638,137 @@ qbool_t PAL_Uart_Init(void)
 */
 qbool_t PAL_Uart_Deinit(void)
 {
+   PAL_Console_Flush();
+
    PAL_Context.Uart_Enabled = false;
    return(qapi_UART_Close(PAL_Context.Console_UART));
 }
 
 /**
    @brief This function is used to write a buffer to the console. Note
-          that when this function returns, all data from the buffer will
-          be written to the console or buffered locally.
+          that when this function returns, the data has been copied to the
+          transmit buffer, or dropped if there was no room and the policy
+          is PAL_TX_POLICY_DROP_E.  A write is either buffered whole or
+          dropped whole.
 
    @param Length is the length of the data to be written.
    @param Buffer is a pointer to the buffer to be written to the console.
 */
 void PAL_Console_Write(uint32_t Length, const char *Buffer)
 {
+   qbool_t Wait;
+   qbool_t Blocked;
+   uint32_t Chunk;
+
    if((Length != 0) && (Buffer != NULL) && (PAL_Context.Uart_Enabled))
    {
-      PAL_Context.BytesToTx = Length;
+      /* Waiting needs the transmit thread to make room.  The QCLI thread
+         only prints command output, so it always waits. */
+      Wait    = (PAL_Context.Tx_Thread_Running) && ((PAL_Context.Tx_Policy == PAL_TX_POLICY_BLOCK_E) || (qurt_thread_get_id() == PAL_Context.QCLI_Thread_Handle));
+      Blocked = false;
+
+      while(Length != 0)
+      {
+         /* A waiting writer may send more than fits in the buffer by
+            splitting it. */
+         Chunk = Length;
+         if((Wait) && (Chunk > PAL_TRANSMIT_BUFFER_SIZE / 2))
+         {
+            Chunk = PAL_TRANSMIT_BUFFER_SIZE / 2;
+         }
+
+         if(Console_Tx_Put(Chunk, Buffer))
+         {
+            Buffer += Chunk;
+            Length -= Chunk;
+
+            if(PAL_Context.Tx_Idle)
+            {
+               qurt_signal_set(&(PAL_Context.Tx_Event), PAL_EVENT_MASK_TRANSMIT_PENDING);
+            }
+         }
+         else if(Wait)
+         {
+            if(!Blocked)
+            {
+               PAL_Context.Tx_Stats.Writes_Blocked ++;
+               Blocked = true;
+            }
+
+            qurt_thread_sleep(1);
+         }
+         else
+         {
+            PAL_ENTER_CRITICAL();
+            PAL_Context.Tx_Stats.Writes_Dropped ++;
+            PAL_Context.Tx_Stats.Bytes_Dropped += Length;
+            PAL_EXIT_CRITICAL();
+            break;
+         }
+      }
+   }
+}
+
+/**
+   @brief This function sets what happens to a console write that does not
+          fit in the transmit buffer.
+
+   @param Policy is the new overflow policy.
+*/
+void PAL_Console_Set_Policy(PAL_Tx_Policy_t Policy)
+{
+   PAL_Context.Tx_Policy = Policy;
+}
+
+/**
+   @brief This function returns the current overflow policy.
+*/
+PAL_Tx_Policy_t PAL_Console_Get_Policy(void)
+{
+   return(PAL_Context.Tx_Policy);
+}
+
+/**
+   @brief This function reads the console transmit counters.
+
+   @param Stats is where the counters are copied.
+   @param Reset clears the counters after they are read if true.
+*/
+void PAL_Console_Get_Stats(PAL_Console_Stats_t *Stats, qbool_t Reset)
+{
+   if(Stats != NULL)
+   {
+      PAL_ENTER_CRITICAL();
+
+      *Stats             = PAL_Context.Tx_Stats;
+      Stats->Buffer_Size = PAL_TRANSMIT_BUFFER_SIZE;
 
-      /* Transmit the data. */
-      if(qapi_UART_Transmit(PAL_Context.Console_UART, (char *)Buffer, Length, NULL) == QAPI_OK)
+      if(Reset)
       {
-         /* Wait for the packet to be sent. */
-         qurt_signal_wait(&(PAL_Context.Event), PAL_EVENT_MASK_TRANSMIT, QURT_SIGNAL_ATTR_WAIT_ANY | QURT_SIGNAL_ATTR_CLEAR_MASK);
+         memset(&(PAL_Context.Tx_Stats), 0, sizeof(PAL_Context.Tx_Stats));
+         PAL_Context.Tx_Stats.High_Water = PAL_Context.Tx_Reserve_Index - PAL_Context.Tx_Out_Index;
       }
+
+      PAL_EXIT_CRITICAL();
+   }
+}
+
+/**
+   @brief This function waits, for a limited time, until everything in the
+          transmit buffer has been sent.
+*/
+void PAL_Console_Flush(void)
+{
+   uint32_t Ticks;
+
+   for(Ticks = 0; (Ticks < PAL_TRANSMIT_FLUSH_TICKS) && (PAL_Context.Tx_Thread_Running) && (PAL_Context.Uart_Enabled); Ticks ++)
+   {
+      if((PAL_Context.Tx_Reserve_Index == PAL_Context.Tx_Out_Index) && (PAL_Context.Tx_Idle))
+      {
+         break;
+      }
+
+      qurt_thread_sleep(1);
    }
 }
 
@@ -501,7 +782,7 @@ void PAL_Exit(void)
    PAL_CONSOLE_WRITE_STRING_LITERAL(PAL_OUTPUT_END_OF_LINE_STRING);
 
    /* Wait for the transmit buffers to flush.                           */
-   qurt_thread_sleep(10);
+   PAL_Console_Flush();
 
    /* Exit the application.                                             */
 //xxx
@@ -520,7 +801,7 @@ void PAL_Reset(void)
    PAL_CONSOLE_WRITE_STRING_LITERAL(PAL_OUTPUT_END_OF_LINE_STRING);
 
    /* Wait for the transmit buffers to flush.                           */
-   qurt_thread_sleep(10);
+   PAL_Console_Flush();
 
    /* Reset the platform.                                               */
    qapi_System_Reset();
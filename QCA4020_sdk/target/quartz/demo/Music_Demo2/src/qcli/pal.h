@@ -49,6 +49,31 @@
  * Type Declarations
  *-----------------------------------------------------------------------*/
 
+/**
+   This enumeration represents what PAL_Console_Write() does when the
+   transmit buffer has no room for the data.  Output from the QCLI thread
+   itself always waits, so command output is never lost.
+*/
+typedef enum
+{
+   PAL_TX_POLICY_DROP_E,   /**< The write is dropped and counted.            */
+   PAL_TX_POLICY_BLOCK_E   /**< The writer sleeps until there is room.       */
+} PAL_Tx_Policy_t;
+
+/**
+   This structure holds the console transmit counters.
+*/
+typedef struct PAL_Console_Stats_s
+{
+   uint32_t Bytes_Written;    /**< Bytes put in the transmit buffer.         */
+   uint32_t Bytes_Dropped;    /**< Bytes dropped for lack of room.           */
+   uint32_t Writes_Dropped;   /**< Writes dropped for lack of room.          */
+   uint32_t Writes_Blocked;   /**< Writes that had to wait for room.         */
+   uint32_t Transmits;        /**< UART transmits issued.                    */
+   uint32_t High_Water;       /**< Most bytes waiting in the buffer at once. */
+   uint32_t Buffer_Size;      /**< Size of the transmit buffer.              */
+} PAL_Console_Stats_t;
+
 /*-------------------------------------------------------------------------
  * Function Declarations and Documentation
  *-----------------------------------------------------------------------*/
@@ -71,14 +96,43 @@ qbool_t PAL_Uart_Deinit(void);
 
 /**
    @brief This function is used to write a buffer to the console. Note
-          that when this function returns, all data from the buffer will
-          be written to the console or buffered locally.
+          that when this function returns, the data has been copied to the
+          transmit buffer, or dropped if there was no room and the policy
+          is PAL_TX_POLICY_DROP_E.  A write is either buffered whole or
+          dropped whole.
 
    @param Length is the length of the data to be written.
    @param Buffer is a pointer to the buffer to be written to the console.
 */
 void PAL_Console_Write(uint32_t Length, const char *Buffer);
 
+/**
+   @brief This function sets what happens to a console write that does not
+          fit in the transmit buffer.
+
+   @param Policy is the new overflow policy.
+*/
+void PAL_Console_Set_Policy(PAL_Tx_Policy_t Policy);
+
+/**
+   @brief This function returns the current overflow policy.
+*/
+PAL_Tx_Policy_t PAL_Console_Get_Policy(void);
+
+/**
+   @brief This function reads the console transmit counters.
+
+   @param Stats is where the counters are copied.
+   @param Reset clears the counters after they are read if true.
+*/
+void PAL_Console_Get_Stats(PAL_Console_Stats_t *Stats, qbool_t Reset);
+
+/**
+   @brief This function waits, for a limited time, until everything in the
+          transmit buffer has been sent.
+*/
+void PAL_Console_Flush(void);
+
 /**
    @brief This function indicates to the PAL layer that the application
           should exit.
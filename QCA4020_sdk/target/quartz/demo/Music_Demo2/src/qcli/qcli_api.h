@@ -33,6 +33,113 @@
  * Preprocessor Definitions and Constants
  *-----------------------------------------------------------------------*/
 
+/**
+   Value of the Start_Thread member of QCLI_Command_t for commands that
+   need more stack than the default command workers have.  These commands
+   are run by the large stack command workers.
+*/
+#define QCLI_THREAD_LARGE_STACK                                         (2)
+
+/**
+   These definitions describe the binary frames that can be sent on the
+   console between the QCLI text.  QCLI only prints ASCII, so the sync
+   bytes never start a frame by accident.  All fields are little endian.
+
+      sync0 sync1 length type sequence timestamp[4] payload[length] crc[2]
+
+   The length is the payload length, the timestamp is the device time in
+   milliseconds and the CRC-16/CCITT (0x1021, init 0xFFFF) covers the
+   length to the end of the payload.
+*/
+#define QCLI_FRAME_SYNC_0                                               (0xA5)
+#define QCLI_FRAME_SYNC_1                                               (0x5A)
+#define QCLI_FRAME_HEADER_SIZE                                          (9)
+#define QCLI_FRAME_CRC_SIZE                                             (2)
+#define QCLI_FRAME_MAX_PAYLOAD                                          (96)
+
+/**
+   Frame type used for the messages of QCLI_LOG() when QCLI_LOG_COMPACT is
+   defined.  Types below this value are left to the applications.
+
+   The payload is the 32-bit string ID of the format followed by the
+   arguments in order: 4 bytes for each integer or pointer, 8 bytes for
+   each 64-bit integer and the NUL terminated text of each string.  The ID
+   is looked up in the string database written by diagMsgCompact.py when
+   the image is linked.
+*/
+#define QCLI_FRAME_TYPE_LOG                                             (0x10)
+
+/**
+   The maximum number of arguments that can be passed to QCLI_LOG().
+*/
+#define QCLI_LOG_MAXIMUM_ARGUMENTS                                      (8)
+
+/**
+   Argument types passed to QCLI_Log_Write(), two bits per argument with
+   the first argument in the least significant bits.
+*/
+#define QCLI_LOG_ARG_TYPE_INT                                           (0)
+#define QCLI_LOG_ARG_TYPE_LONG_LONG                                     (1)
+#define QCLI_LOG_ARG_TYPE_STRING                                        (2)
+
+#define QCLI_LOG_ARG_TYPE(_Arg)                                                 \
+   _Generic((_Arg) + 0,                                                         \
+            char *:               QCLI_LOG_ARG_TYPE_STRING,                     \
+            const char *:         QCLI_LOG_ARG_TYPE_STRING,                     \
+            long long:            QCLI_LOG_ARG_TYPE_LONG_LONG,                  \
+            unsigned long long:   QCLI_LOG_ARG_TYPE_LONG_LONG,                  \
+            default:              QCLI_LOG_ARG_TYPE_INT)
+
+#define QCLI_LOG_COUNT(...)           QCLI_LOG_COUNT_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define QCLI_LOG_COUNT_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _N, ...) _N
+
+#define QCLI_LOG_CONCAT(_A, _B)       QCLI_LOG_CONCAT_(_A, _B)
+#define QCLI_LOG_CONCAT_(_A, _B)      _A##_B
+
+#define QCLI_LOG_TYPES(...)           QCLI_LOG_CONCAT(QCLI_LOG_TYPES_, QCLI_LOG_COUNT(__VA_ARGS__))(__VA_ARGS__)
+#define QCLI_LOG_TYPES_0()            0
+#define QCLI_LOG_TYPES_1(_A)          QCLI_LOG_ARG_TYPE(_A)
+#define QCLI_LOG_TYPES_2(_A, ...)     (QCLI_LOG_ARG_TYPE(_A) | (QCLI_LOG_TYPES_1(__VA_ARGS__) << 2))
+#define QCLI_LOG_TYPES_3(_A, ...)     (QCLI_LOG_ARG_TYPE(_A) | (QCLI_LOG_TYPES_2(__VA_ARGS__) << 2))
+#define QCLI_LOG_TYPES_4(_A, ...)     (QCLI_LOG_ARG_TYPE(_A) | (QCLI_LOG_TYPES_3(__VA_ARGS__) << 2))
+#define QCLI_LOG_TYPES_5(_A, ...)     (QCLI_LOG_ARG_TYPE(_A) | (QCLI_LOG_TYPES_4(__VA_ARGS__) << 2))
+#define QCLI_LOG_TYPES_6(_A, ...)     (QCLI_LOG_ARG_TYPE(_A) | (QCLI_LOG_TYPES_5(__VA_ARGS__) << 2))
+#define QCLI_LOG_TYPES_7(_A, ...)     (QCLI_LOG_ARG_TYPE(_A) | (QCLI_LOG_TYPES_6(__VA_ARGS__) << 2))
+#define QCLI_LOG_TYPES_8(_A, ...)     (QCLI_LOG_ARG_TYPE(_A) | (QCLI_LOG_TYPES_7(__VA_ARGS__) << 2))
+
+/**
+   QCLI_LOG() prints a message in the same way as QCLI_Printf().
+
+   When QCLI_LOG_COMPACT is defined, the format string is instead placed
+   in the diag string section, which is not loaded on the device.  The
+   post-link step (diagMsgCompact.py) replaces the string address held by
+   the _diag_msg_compact structure with a string ID and writes the string
+   database.  Only the ID and the raw arguments are then sent, as a
+   QCLI_FRAME_TYPE_LOG frame, and tools/qdt/qcli_log_decode.py rebuilds
+   the text on the host.
+
+   The format must be a string literal and the arguments integers,
+   pointers or strings (up to QCLI_LOG_MAXIMUM_ARGUMENTS).  The string ID
+   is read through a pointer at run time so the compiler never folds the
+   link time string address into the code.
+*/
+#ifdef QCLI_LOG_COMPACT
+
+#define QCLI_LOG(_Group_Handle, _Format, ...)                                   \
+   do                                                                           \
+   {                                                                            \
+      static const char _qcli_Log_Format[] __attribute__((section(".diagmsg.format"), aligned(4))) = _Format; \
+      static const QCLI_Log_Compact_t _diag_msg_compact = {_qcli_Log_Format};  \
+      QCLI_Log_Write((_Group_Handle), &_diag_msg_compact, QCLI_LOG_COUNT(__VA_ARGS__), QCLI_LOG_TYPES(__VA_ARGS__), ##__VA_ARGS__); \
+   } while(0)
+
+#else
+
+#define QCLI_LOG(_Group_Handle, _Format, ...)                                   \
+   QCLI_Printf((_Group_Handle), _Format, ##__VA_ARGS__)
+
+#endif
+
 /*-------------------------------------------------------------------------
  * Type Declarations
  *-----------------------------------------------------------------------*/
@@ -54,6 +161,16 @@ typedef enum
 */
 typedef void *QCLI_Group_Handle_t;
 
+/**
+   This union holds the format string of a QCLI_LOG() message.  The
+   post-link step replaces the string address with the string ID.
+*/
+typedef union QCLI_Log_Compact_u
+{
+   const char *Format;
+   uint32_t    String_ID;
+} QCLI_Log_Compact_t;
+
 /**
    This structure contains the information for a single parameter entered
    into the command line.  It contains the string value (as entered), the
@@ -93,7 +210,7 @@ typedef QCLI_Command_Status_t (*QCLI_Command_Function_t)(uint32_t Parameter_Coun
 typedef struct QCLI_Command_s
 {
    QCLI_Command_Function_t  Command_Function; /** The function that will be called when the command is executed from the CLI. */
-   qbool_t                  Start_Thread;     /** A flag which indicates if the command should start on its own thread.       */
+   qbool_t                  Start_Thread;     /** Run on a command worker (true or QCLI_THREAD_LARGE_STACK).                   */
    const char              *Command_String;   /** The string representation of the function.                                  */
    const char              *Usage_String;     /** The usage string for the command.                                           */
    const char              *Description;      /** The description string for the commmand.                                    */
@@ -166,5 +283,39 @@ void QCLI_Display_Prompt(void);
 */
 void QCLI_Printf(QCLI_Group_Handle_t Group_Handle, const char *format, ...);
 
+/**
+   @brief This function writes a binary frame to the console.
+
+   The frame header and CRC described by QCLI_FRAME_SYNC_0 are added to the
+   payload.  The sequence number is assigned and the frame written while
+   holding the CLI lock, so frames reach the console in sequence order and
+   are never split by text from QCLI_Printf().
+
+   @param Type is the frame type.
+   @param Length is the length of the payload, at most
+          QCLI_FRAME_MAX_PAYLOAD.
+   @param Payload is the payload of the frame.
+
+   @return The number of bytes written to the console, or zero if the frame
+           could not be written.
+*/
+uint32_t QCLI_Write_Frame(uint8_t Type, uint32_t Length, const uint8_t *Payload);
+
+/**
+   @brief This function sends a compact QCLI_LOG() message.
+
+   It is not normally called directly, use QCLI_LOG() instead.  String
+   arguments that do not fit in the frame are truncated.
+
+   @param Group_Handle is the handle for the group associated with the
+          message.
+   @param Compact is the structure holding the string ID of the format.
+   @param Arg_Count is the number of arguments that follow.
+   @param Arg_Types gives the type of each argument, two bits each as
+          given by QCLI_LOG_ARG_TYPE().
+   @param ... are the arguments of the message.
+*/
+void QCLI_Log_Write(QCLI_Group_Handle_t Group_Handle, const QCLI_Log_Compact_t *Compact, uint32_t Arg_Count, uint32_t Arg_Types, ...);
+
 #endif   // ] #ifndef __QCLI_API_H__
 
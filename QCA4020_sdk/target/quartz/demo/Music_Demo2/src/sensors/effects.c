@@ -0,0 +1,391 @@
+/*
+ * Copyright (c) 2015-2018 Qualcomm Technologies, Inc.
+ * 2015-2016 Qualcomm Atheros, Inc.
+ * All Rights Reserved.
+ */
+
+#include <string.h>
+#include "stdint.h"
+#include <qcli.h>
+#include <qcli_api.h>
+#include <qurt_timer.h>
+#include <qurt_mutex.h>
+#include "qapi_timer.h"
+#include "effects.h"
+
+//effects that miss their write time by more than this are counted late
+#define FX_LATE_MS			(10)
+#define FX_MIN_MILLI_BPM		(20000)
+#define FX_MAX_MILLI_BPM		(400000)
+
+typedef struct fx_keyframe_s
+{
+	uint64_t effect;
+	qurt_time_t due;			//the beat the effect lands on
+	qurt_time_t issue;			//when the writes start
+} fx_keyframe_t;
+
+typedef struct fx_segment_s
+{
+	uint32_t song_ms;
+	uint32_t milli_bpm;
+} fx_segment_t;
+
+typedef struct fx_stats_s
+{
+	uint32_t immediate;			//applied at once, no song clock
+	uint32_t scheduled;
+	uint32_t replaced;			//overtaken by a newer request
+	uint32_t committed;
+	uint32_t late;
+	uint32_t max_late_ms;
+} fx_stats_t;
+
+extern void mscd_effect_due_callback();
+extern uint32_t mscd_get_fanout_spread_ms();
+
+static qurt_mutex_t fx_lock;
+static int fx_lock_created;
+static qapi_TIMER_handle_t fx_timer;
+static qapi_TIMER_define_attr_t fx_timer_def_attr;
+static qapi_TIMER_set_attr_t fx_timer_set_attr;
+
+//keyframes in due order, a request drops the ones due at or after it
+static fx_keyframe_t fx_timeline[FX_MAX_KEYFRAMES];
+static uint32_t fx_keyframes;
+
+static fx_segment_t fx_track[FX_MAX_TEMPO_SEGMENTS];
+static uint32_t fx_segments;
+static int fx_clock_running;
+static qurt_time_t fx_origin_ticks;		//song clock was at fx_origin_ms here
+static uint32_t fx_origin_ms;
+static uint32_t fx_quantum = 1;
+static uint32_t fx_lead_ms = FX_LEAD_AUTO;
+static fx_stats_t fx_stats;
+
+static uint32_t fx_ticks_to_ms(qurt_time_t ticks)
+{
+	return (uint32_t)qurt_timer_convert_ticks_to_time(ticks, QURT_TIME_MSEC);
+}
+
+static qurt_time_t fx_ms_to_ticks(uint32_t ms)
+{
+	return qurt_timer_convert_time_to_ticks(ms, QURT_TIME_MSEC);
+}
+
+static uint32_t fx_song_ms(qurt_time_t now)
+{
+	return fx_origin_ms + fx_ticks_to_ms(now - fx_origin_ticks);
+}
+
+static uint32_t fx_lead(void)
+{
+	uint32_t lead = (fx_lead_ms == FX_LEAD_AUTO) ? mscd_get_fanout_spread_ms() : fx_lead_ms;
+
+	return (lead > FX_MAX_LEAD_MS) ? FX_MAX_LEAD_MS : lead;
+}
+
+/*
+ * Finds the first beat at or after 'from_ms' in song time. Each segment
+ * starts on a beat and beats are counted in steps of fx_quantum from
+ * there. Returns 0 if the track has no beat left.
+ */
+static int fx_next_beat(uint32_t from_ms, uint32_t *beat_ms)
+{
+	uint64_t period_us;
+	uint64_t beats;
+	uint32_t start;
+	uint32_t end;
+	uint32_t beat;
+	uint32_t i;
+
+	for (i = 0; i < fx_segments; i++)
+	{
+		start = fx_track[i].song_ms;
+		end = ((i + 1) < fx_segments) ? fx_track[i + 1].song_ms : 0xFFFFFFFF;
+
+		if (from_ms >= end)
+			continue;
+
+		if (from_ms <= start)
+		{
+			*beat_ms = start;
+			return 1;
+		}
+
+		period_us = (60000000000ULL / fx_track[i].milli_bpm) * fx_quantum;
+		beats = (((uint64_t)(from_ms - start) * 1000) + period_us - 1) / period_us;
+		beat = start + (uint32_t)((beats * period_us + 999) / 1000);
+
+		//a beat cut short by the next segment moves to its start
+		*beat_ms = (beat < end) ? beat : end;
+		return 1;
+	}
+
+	return 0;
+}
+
+/* starts the timer for the first keyframe, called with the lock held */
+static void fx_arm(qurt_time_t now)
+{
+	qapi_Timer_Stop(fx_timer);
+
+	if (!fx_keyframes)
+		return;
+
+	if (fx_timeline[0].issue <= now)
+	{
+		mscd_effect_due_callback();
+		return;
+	}
+
+	fx_timer_set_attr.time = fx_ticks_to_ms(fx_timeline[0].issue - now);
+	if (!fx_timer_set_attr.time)
+		fx_timer_set_attr.time = 1;
+	fx_timer_set_attr.reload = false;
+	fx_timer_set_attr.max_deferrable_timeout = 0;
+	fx_timer_set_attr.unit = QAPI_TIMER_UNIT_MSEC;
+	qapi_Timer_Set(fx_timer, &fx_timer_set_attr);
+}
+
+static void fx_timer_callback(uint32_t data)
+{
+	mscd_effect_due_callback();
+}
+
+void fx_init(void)
+{
+	if (fx_lock_created)
+		return;
+
+	qurt_mutex_create(&fx_lock);
+
+	fx_timer_def_attr.deferrable = false;
+	fx_timer_def_attr.cb_type = QAPI_TIMER_FUNC1_CB_TYPE;
+	fx_timer_def_attr.sigs_func_ptr = fx_timer_callback;
+	fx_timer_def_attr.sigs_mask_data = 0;
+	qapi_Timer_Def(&fx_timer, &fx_timer_def_attr);
+
+	fx_lock_created = 1;
+}
+
+int fx_request(uint64_t effect)
+{
+	qurt_time_t now;
+	qurt_time_t due;
+	uint32_t lead;
+	uint32_t beat_ms;
+
+	if (!fx_lock_created)
+		return 0;
+
+	qurt_mutex_lock(&fx_lock);
+
+	now = qurt_timer_get_ticks();
+	lead = fx_lead();
+
+	if (!fx_clock_running || !fx_next_beat(fx_song_ms(now) + lead, &beat_ms))
+	{
+		fx_stats.immediate++;
+		qurt_mutex_unlock(&fx_lock);
+		return 0;
+	}
+
+	//the newest request wins over the ones due on the same beat or
+	//later, what is left is due before it so it goes on the end
+	due = fx_origin_ticks + fx_ms_to_ticks(beat_ms - fx_origin_ms);
+	while (fx_keyframes && (fx_timeline[fx_keyframes - 1].due >= due))
+	{
+		fx_keyframes--;
+		fx_stats.replaced++;
+	}
+	if (fx_keyframes == FX_MAX_KEYFRAMES)
+	{
+		fx_keyframes--;
+		fx_stats.replaced++;
+	}
+
+	fx_timeline[fx_keyframes].effect = effect;
+	fx_timeline[fx_keyframes].due = due;
+	fx_timeline[fx_keyframes].issue = due - fx_ms_to_ticks(lead);
+	fx_keyframes++;
+	fx_stats.scheduled++;
+
+	fx_arm(now);
+
+	qurt_mutex_unlock(&fx_lock);
+
+	return 1;
+}
+
+void fx_cancel(void)
+{
+	if (!fx_lock_created)
+		return;
+
+	qurt_mutex_lock(&fx_lock);
+	fx_stats.replaced += fx_keyframes;
+	fx_keyframes = 0;
+	qapi_Timer_Stop(fx_timer);
+	qurt_mutex_unlock(&fx_lock);
+}
+
+int fx_run(uint64_t *effect)
+{
+	qurt_time_t now;
+	uint32_t late_ms;
+	uint32_t taken = 0;
+
+	if (!fx_lock_created)
+		return 0;
+
+	qurt_mutex_lock(&fx_lock);
+
+	//the timer has 1 ms steps, a keyframe that close is taken now
+	now = qurt_timer_get_ticks();
+	while ((taken < fx_keyframes) && (fx_timeline[taken].issue <= (now + fx_ms_to_ticks(1))))
+	{
+		*effect = fx_timeline[taken].effect;
+		late_ms = (now > fx_timeline[taken].issue) ? fx_ticks_to_ms(now - fx_timeline[taken].issue) : 0;
+		if (late_ms > FX_LATE_MS)
+			fx_stats.late++;
+		if (late_ms > fx_stats.max_late_ms)
+			fx_stats.max_late_ms = late_ms;
+		taken++;
+	}
+
+	if (taken)
+	{
+		//only the last of several due at once is written
+		fx_stats.committed++;
+		fx_stats.replaced += taken - 1;
+		fx_keyframes -= taken;
+		memmove(fx_timeline, &fx_timeline[taken], fx_keyframes * sizeof(fx_keyframe_t));
+	}
+
+	fx_arm(now);
+
+	qurt_mutex_unlock(&fx_lock);
+
+	return (taken != 0);
+}
+
+void fx_tempo_clear(void)
+{
+	if (!fx_lock_created)
+		return;
+
+	fx_tempo_stop();
+
+	qurt_mutex_lock(&fx_lock);
+	fx_segments = 0;
+	qurt_mutex_unlock(&fx_lock);
+}
+
+int fx_tempo_add(uint32_t song_ms, uint32_t milli_bpm)
+{
+	int ret = -1;
+
+	if (!fx_lock_created || (milli_bpm < FX_MIN_MILLI_BPM) || (milli_bpm > FX_MAX_MILLI_BPM))
+		return -1;
+
+	qurt_mutex_lock(&fx_lock);
+	if ((fx_segments < FX_MAX_TEMPO_SEGMENTS) &&
+		(!fx_segments || (song_ms > fx_track[fx_segments - 1].song_ms)))
+	{
+		fx_track[fx_segments].song_ms = song_ms;
+		fx_track[fx_segments].milli_bpm = milli_bpm;
+		fx_segments++;
+		ret = 0;
+	}
+	qurt_mutex_unlock(&fx_lock);
+
+	return ret;
+}
+
+int fx_tempo_start(uint32_t song_ms)
+{
+	int ret = -1;
+
+	if (!fx_lock_created)
+		return -1;
+
+	qurt_mutex_lock(&fx_lock);
+	if (fx_segments)
+	{
+		fx_origin_ticks = qurt_timer_get_ticks();
+		fx_origin_ms = song_ms;
+		fx_clock_running = 1;
+		ret = 0;
+	}
+	qurt_mutex_unlock(&fx_lock);
+
+	return ret;
+}
+
+void fx_tempo_stop(void)
+{
+	qurt_time_t now;
+	uint32_t i;
+
+	if (!fx_lock_created)
+		return;
+
+	//keyframes still waiting are written at once
+	qurt_mutex_lock(&fx_lock);
+	now = qurt_timer_get_ticks();
+	fx_clock_running = 0;
+	for (i = 0; i < fx_keyframes; i++)
+		fx_timeline[i].issue = now;
+	fx_arm(now);
+	qurt_mutex_unlock(&fx_lock);
+}
+
+void fx_set_quantum(uint32_t beats)
+{
+	fx_quantum = beats ? beats : 1;
+}
+
+void fx_set_lead(uint32_t lead_ms)
+{
+	fx_lead_ms = lead_ms;
+}
+
+void fx_print(QCLI_Group_Handle_t group, int reset)
+{
+	qurt_time_t now = qurt_timer_get_ticks();
+	uint32_t i;
+
+	if (!fx_lock_created)
+	{
+		QCLI_Printf(group, "Effect timeline not started\n");
+		return;
+	}
+
+	qurt_mutex_lock(&fx_lock);
+
+	if (fx_clock_running)
+		QCLI_Printf(group, "Song clock at %u ms", fx_song_ms(now));
+	else
+		QCLI_Printf(group, "Song clock stopped");
+	QCLI_Printf(group, ", %u beat steps, lead %u ms%s\n", fx_quantum, fx_lead(),
+		(fx_lead_ms == FX_LEAD_AUTO) ? " (auto)" : "");
+
+	for (i = 0; i < fx_segments; i++)
+		QCLI_Printf(group, "  from %8u ms  %3u.%03u bpm\n", fx_track[i].song_ms,
+			fx_track[i].milli_bpm / 1000, fx_track[i].milli_bpm % 1000);
+
+	for (i = 0; i < fx_keyframes; i++)
+		QCLI_Printf(group, "  effect %08x%08x due in %d ms\n", (unsigned int)(fx_timeline[i].effect >> 32),
+			(unsigned int)fx_timeline[i].effect, (fx_timeline[i].due > now) ? (int)fx_ticks_to_ms(fx_timeline[i].due - now) :
+			-(int)fx_ticks_to_ms(now - fx_timeline[i].due));
+
+	QCLI_Printf(group, "%u immediate, %u scheduled, %u replaced, %u committed, %u late (max %u ms)\n",
+		fx_stats.immediate, fx_stats.scheduled, fx_stats.replaced, fx_stats.committed,
+		fx_stats.late, fx_stats.max_late_ms);
+
+	if (reset)
+		memset(&fx_stats, 0, sizeof(fx_stats));
+
+	qurt_mutex_unlock(&fx_lock);
+}
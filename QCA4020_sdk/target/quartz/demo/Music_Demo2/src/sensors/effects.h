@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2015-2018 Qualcomm Technologies, Inc.
+ * 2015-2016 Qualcomm Atheros, Inc.
+ * All Rights Reserved.
+ */
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef __EFFECTS_H__
+#define __EFFECTS_H__
+
+#include <stdint.h>
+#include "qcli_api.h"
+
+/*
+ * Effect timeline. Without a tempo track an effect is applied as soon
+ * as it is asked for. Once the gateway has loaded a track and started
+ * the song clock, each effect is held as a keyframe due on the next
+ * beat (or bar, see fx_set_quantum()) and written ahead of it by the
+ * lead time, so that every bulb has taken it when the beat lands.
+ *
+ * The bulbs apply an effect as soon as it is written, there is no
+ * separate commit, so the lead time is what lines them up. By default
+ * it is the time the last effect took to reach every bulb.
+ */
+#define FX_MAX_KEYFRAMES		(8)
+#define FX_MAX_TEMPO_SEGMENTS		(16)
+#define FX_MAX_LEAD_MS			(1000)
+#define FX_LEAD_AUTO			(0xFFFFFFFF)
+
+/**
+   @brief Sets up the timeline lock and timer, safe to call more than once.
+*/
+void fx_init(void);
+
+/**
+   @brief Asks for an effect. Returns 1 if it was put on the timeline, 0
+          if there is no song clock and the caller applies it at once.
+*/
+int fx_request(uint64_t effect);
+
+/**
+   @brief Drops the keyframes still waiting, for when the effect is set
+          directly.
+*/
+void fx_cancel(void);
+
+/**
+   @brief Called by mscd_thread when a keyframe is due to be written.
+          Returns 1 and the effect to write, or 0 if nothing is due.
+*/
+int fx_run(uint64_t *effect);
+
+/**
+   @brief Drops the tempo track and stops the song clock.
+*/
+void fx_tempo_clear(void);
+
+/**
+   @brief Adds a tempo segment starting at song_ms, which must be later
+          than the previous one. The segment starts on a beat. Returns
+          0 on success.
+*/
+int fx_tempo_add(uint32_t song_ms, uint32_t milli_bpm);
+
+/**
+   @brief Starts the song clock, song_ms is the song position now.
+          Returns 0 on success, -1 if there is no track.
+*/
+int fx_tempo_start(uint32_t song_ms);
+
+/**
+   @brief Stops the song clock, the track is kept.
+*/
+void fx_tempo_stop(void);
+
+/**
+   @brief Sets the number of beats effects are lined up to, 1 for a beat
+          or 4 for a bar of four.
+*/
+void fx_set_quantum(uint32_t beats);
+
+/**
+   @brief Sets the lead time in ms, or FX_LEAD_AUTO to follow the bulbs.
+*/
+void fx_set_lead(uint32_t lead_ms);
+
+/**
+   @brief Prints the track, the keyframes and the counters, and clears
+          the counters if requested.
+*/
+void fx_print(QCLI_Group_Handle_t group, int reset);
+
+#endif
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2015-2018 Qualcomm Technologies, Inc.
+ * 2015-2016 Qualcomm Atheros, Inc.
+ * All Rights Reserved.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "stdint.h"
+#include <qcli.h>
+#include <qcli_api.h>
+#include "qapi/qurt_thread.h"
+#include <qurt_timer.h>
+#include "lat_trace.h"
+
+#define LAT_TRACE_ENTRIES		(64)
+#define LAT_CALIBRATE_MS		(20)
+
+#define LAT_DEMCR			(*(volatile uint32_t *)0xE000EDFC)
+#define LAT_DEMCR_TRCENA		(1 << 24)
+#define LAT_DWT_CTRL			(*(volatile uint32_t *)0xE0001000)
+#define LAT_DWT_CTRL_CYCCNTENA		(1 << 0)
+
+/*
+ * A record is started by pir_thread only, the later stages are stamped
+ * by mscd_thread. Each stage has its own flag so no stamp needs a lock,
+ * and the ID is written last so a reader never sees half a record.
+ */
+typedef struct lat_trace_record_s
+{
+	volatile uint32_t id;
+	uint64_t effect;
+	uint32_t cycles[LAT_NUM_STAGES];
+	volatile uint8_t stamped[LAT_NUM_STAGES];
+} lat_trace_record_t;
+
+static lat_trace_record_t lat_trace_ring[LAT_TRACE_ENTRIES];
+static volatile uint32_t lat_trace_next_id = 1;
+static volatile uint32_t lat_trace_newest;
+static uint32_t lat_cycles_per_ms;
+static QCLI_Group_Handle_t lat_stream_group;
+
+static const char *lat_interval_names[] =
+{
+	"edge->decide",
+	"decide->dequeue",
+	"dequeue->issue",
+	"issue->confirm",
+	"edge->confirm"
+};
+
+#define LAT_NUM_INTERVALS		(sizeof(lat_interval_names) / sizeof(lat_interval_names[0]))
+
+static lat_trace_record_t *lat_trace_record(uint32_t id)
+{
+	lat_trace_record_t *rec;
+
+	if (!id)
+		return NULL;
+
+	rec = &lat_trace_ring[id % LAT_TRACE_ENTRIES];
+
+	return (rec->id == id) ? rec : NULL;
+}
+
+static uint32_t lat_cycles_to_us(uint32_t cycles)
+{
+	if (!lat_cycles_per_ms)
+		return 0;
+
+	return (uint32_t)(((uint64_t)cycles * 1000) / lat_cycles_per_ms);
+}
+
+/* gets the cycles between two stages, returns 0 if one is missing */
+static int lat_interval(const lat_trace_record_t *rec, int from, int to, uint32_t *cycles)
+{
+	if (!rec->stamped[from] || !rec->stamped[to])
+		return 0;
+
+	*cycles = rec->cycles[to] - rec->cycles[from];
+
+	return 1;
+}
+
+/* interval i is stage i to stage i+1, the last one is end to end */
+static int lat_record_interval(const lat_trace_record_t *rec, uint32_t i, uint32_t *cycles)
+{
+	if (i == (LAT_NUM_INTERVALS - 1))
+		return lat_interval(rec, LAT_STAGE_EDGE, LAT_STAGE_CONFIRM, cycles);
+
+	return lat_interval(rec, i, i + 1, cycles);
+}
+
+static void lat_print_record(QCLI_Group_Handle_t group, const lat_trace_record_t *rec)
+{
+	char line[128];
+	int len;
+	int stage;
+	int first = -1;
+
+	for (stage = 0; stage < LAT_NUM_STAGES; stage++)
+	{
+		if (rec->stamped[stage])
+		{
+			first = stage;
+			break;
+		}
+	}
+
+	if (first < 0)
+		return;
+
+	/* stage times are in us from the first stamped stage, -1 if missing */
+	len = snprintf(line, sizeof(line), "LAT,%u,%08x%08x", rec->id,
+		(unsigned int)(rec->effect >> 32), (unsigned int)rec->effect);
+
+	for (stage = 0; stage < LAT_NUM_STAGES; stage++)
+	{
+		if (rec->stamped[stage])
+			len += snprintf(line + len, sizeof(line) - len, ",%u",
+				lat_cycles_to_us(rec->cycles[stage] - rec->cycles[first]));
+		else
+			len += snprintf(line + len, sizeof(line) - len, ",-1");
+	}
+
+	QCLI_Printf(group, "%s\n", line);
+}
+
+void lat_trace_init(void)
+{
+	qurt_time_t start_ticks;
+	uint32_t start_cycles;
+	uint32_t elapsed_ms;
+
+#ifndef CONFIG_HOST_MSCD_DEMO
+	LAT_DEMCR |= LAT_DEMCR_TRCENA;
+	LAT_DWT_CTRL |= LAT_DWT_CTRL_CYCCNTENA;
+#endif
+
+	if (lat_cycles_per_ms)
+		return;
+
+	start_ticks = qurt_timer_get_ticks();
+	start_cycles = lat_trace_cycles();
+	qurt_thread_sleep(qurt_timer_convert_time_to_ticks(LAT_CALIBRATE_MS, QURT_TIME_MSEC));
+	elapsed_ms = (uint32_t)qurt_timer_convert_ticks_to_time(qurt_timer_get_ticks() - start_ticks, QURT_TIME_MSEC);
+
+	if (elapsed_ms)
+		lat_cycles_per_ms = (lat_trace_cycles() - start_cycles) / elapsed_ms;
+}
+
+uint32_t lat_trace_begin(uint64_t effect, const uint32_t *edge_cycles)
+{
+	uint32_t id = lat_trace_next_id++;
+	lat_trace_record_t *rec;
+
+	/* 0 means no record */
+	if (!id)
+		id = lat_trace_next_id++;
+
+	rec = &lat_trace_ring[id % LAT_TRACE_ENTRIES];
+
+	rec->id = 0;
+	memset((void *)rec->stamped, 0, sizeof(rec->stamped));
+	rec->effect = effect;
+
+	if (edge_cycles)
+	{
+		rec->cycles[LAT_STAGE_EDGE] = *edge_cycles;
+		rec->stamped[LAT_STAGE_EDGE] = 1;
+	}
+
+	rec->cycles[LAT_STAGE_DECIDE] = lat_trace_cycles();
+	rec->stamped[LAT_STAGE_DECIDE] = 1;
+
+	rec->id = id;
+	lat_trace_newest = id;
+
+	return id;
+}
+
+uint32_t lat_trace_current(void)
+{
+	return lat_trace_newest;
+}
+
+uint32_t lat_trace_find(uint64_t effect)
+{
+	lat_trace_record_t *rec = lat_trace_record(lat_trace_newest);
+
+	if (!rec || (rec->effect != effect) || rec->stamped[LAT_STAGE_CONFIRM])
+		return 0;
+
+	return rec->id;
+}
+
+void lat_trace_stamp(uint32_t id, int stage)
+{
+	uint32_t cycles = lat_trace_cycles();
+	lat_trace_record_t *rec = lat_trace_record(id);
+
+	if (!rec || (stage < 0) || (stage >= LAT_NUM_STAGES) || rec->stamped[stage])
+		return;
+
+	rec->cycles[stage] = cycles;
+	rec->stamped[stage] = 1;
+
+	if ((stage == LAT_STAGE_CONFIRM) && lat_stream_group)
+		lat_print_record(lat_stream_group, rec);
+}
+
+void lat_trace_print(QCLI_Group_Handle_t group)
+{
+	uint32_t samples[LAT_TRACE_ENTRIES];
+	uint32_t count;
+	uint32_t value;
+	uint32_t i;
+	uint32_t j;
+	uint32_t k;
+
+	QCLI_Printf(group, "%-16s %5s %9s %9s %9s %9s (us)\n", "stage", "count", "p50", "p95", "p99", "max");
+
+	for (i = 0; i < LAT_NUM_INTERVALS; i++)
+	{
+		count = 0;
+
+		/* insertion sort, the ring is small */
+		for (j = 0; j < LAT_TRACE_ENTRIES; j++)
+		{
+			if (!lat_trace_ring[j].id || !lat_record_interval(&lat_trace_ring[j], i, &value))
+				continue;
+
+			for (k = count; (k > 0) && (samples[k - 1] > value); k--)
+				samples[k] = samples[k - 1];
+			samples[k] = value;
+			count++;
+		}
+
+		if (!count)
+		{
+			QCLI_Printf(group, "%-16s %5u %9s %9s %9s %9s\n", lat_interval_names[i], 0, "-", "-", "-", "-");
+			continue;
+		}
+
+		/* nearest rank percentiles */
+		QCLI_Printf(group, "%-16s %5u %9u %9u %9u %9u\n", lat_interval_names[i], count,
+			lat_cycles_to_us(samples[((count * 50) + 99) / 100 - 1]),
+			lat_cycles_to_us(samples[((count * 95) + 99) / 100 - 1]),
+			lat_cycles_to_us(samples[((count * 99) + 99) / 100 - 1]),
+			lat_cycles_to_us(samples[count - 1]));
+	}
+
+	QCLI_Printf(group, "%u cycles per ms\n", lat_cycles_per_ms);
+}
+
+void lat_trace_dump(QCLI_Group_Handle_t group)
+{
+	uint32_t newest = lat_trace_newest;
+	uint32_t id;
+
+	/* oldest first */
+	for (id = (newest > LAT_TRACE_ENTRIES) ? (newest - LAT_TRACE_ENTRIES + 1) : 1; newest && (id <= newest); id++)
+	{
+		lat_trace_record_t *rec = lat_trace_record(id);
+
+		if (rec)
+			lat_print_record(group, rec);
+	}
+}
+
+void lat_trace_stream(QCLI_Group_Handle_t group, int enable)
+{
+	lat_stream_group = enable ? group : NULL;
+}
+
+void lat_trace_reset(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < LAT_TRACE_ENTRIES; i++)
+		lat_trace_ring[i].id = 0;
+
+	lat_trace_newest = 0;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2015-2018 Qualcomm Technologies, Inc.
+ * 2015-2016 Qualcomm Atheros, Inc.
+ * All Rights Reserved.
+ */
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef __LAT_TRACE_H__
+#define __LAT_TRACE_H__
+
+#include <stdint.h>
+#include "qcli_api.h"
+
+/*
+ * Stages of the PIR to light pipeline. Every effect change gets a
+ * record in the trace ring holding the cycle count at each stage.
+ */
+#define LAT_STAGE_EDGE			(0)	/* PIR edge interrupt */
+#define LAT_STAGE_DECIDE		(1)	/* pir_thread picked a new effect */
+#define LAT_STAGE_DEQUEUE		(2)	/* mscd_thread took the write signal */
+#define LAT_STAGE_ISSUE			(3)	/* first GATT write of the effect issued */
+#define LAT_STAGE_CONFIRM		(4)	/* every ready bulb confirmed the effect */
+#define LAT_NUM_STAGES			(5)
+
+#ifdef CONFIG_HOST_MSCD_DEMO
+
+/**
+   @brief Returns a microsecond count, the host has no DWT to read.
+*/
+uint32_t lat_trace_cycles(void);
+
+#else
+
+/* Cortex-M4 DWT cycle counter */
+#define LAT_DWT_CYCCNT			(*(volatile uint32_t *)0xE0001004)
+
+/**
+   @brief Returns the current cycle count, safe to call from interrupts.
+*/
+static inline uint32_t lat_trace_cycles(void)
+{
+	return LAT_DWT_CYCCNT;
+}
+
+#endif
+
+/**
+   @brief Enables the cycle counter and measures its rate.
+*/
+void lat_trace_init(void);
+
+/**
+   @brief Starts a record for a new effect. edge_cycles is the cycle count
+          of the PIR edge that caused it, or NULL if there was none.
+
+   @return The record ID.
+*/
+uint32_t lat_trace_begin(uint64_t effect, const uint32_t *edge_cycles);
+
+/**
+   @brief Returns the ID of the newest record, or 0 if there is none.
+*/
+uint32_t lat_trace_current(void);
+
+/**
+   @brief Returns the ID of the newest record if it is for the given effect
+          and is not complete yet, otherwise 0.
+*/
+uint32_t lat_trace_find(uint64_t effect);
+
+/**
+   @brief Stamps a stage of a record with the current cycle count. Only the
+          first stamp of a stage is kept, stale IDs are ignored.
+*/
+void lat_trace_stamp(uint32_t id, int stage);
+
+/**
+   @brief Prints p50/p95/p99/max latency per stage.
+*/
+void lat_trace_print(QCLI_Group_Handle_t group);
+
+/**
+   @brief Prints the raw records, one "LAT," line each.
+*/
+void lat_trace_dump(QCLI_Group_Handle_t group);
+
+/**
+   @brief Prints every record as a "LAT," line as soon as it completes.
+*/
+void lat_trace_stream(QCLI_Group_Handle_t group, int enable);
+
+/**
+   @brief Drops all records.
+*/
+void lat_trace_reset(void);
+
+#endif
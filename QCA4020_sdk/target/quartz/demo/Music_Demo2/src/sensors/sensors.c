@@ -23,6 +23,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "qurt_signal.h"
 #include "qapi/qurt_thread.h"
 #include "stdint.h"
@@ -30,12 +31,16 @@
 #include <qcli_api.h>
 #include <qurt_timer.h>
 #include <qurt_pipe.h>
+#include <qurt_mutex.h>
 #include "qapi_timer.h"
 #include "qapi/qapi_status.h"
 #include <qapi_i2c_master.h>
 #include "qapi_tlmm.h"
 #include "qapi_gpioint.h"
 #include "sensors_demo.h"
+#include "lat_trace.h"
+#include "telemetry.h"
+#include "effects.h"
 #define PIR_THREAD_STACK_SIZE		(1024)
 #define PIR_THREAD_PRIORITY		(10)
 #define PIR_PIN				27
@@ -64,11 +69,32 @@ void mot_print(char *str)
 #ifdef CONFIG_CDB_PLATFORM
 
 static qurt_signal_t pir_int_signal;
+
+//edge timestamps from the interrupt, the interrupt only moves the head
+//and pir_thread only moves the tail
+#define PIR_EDGE_RING_SIZE		(32)
+static qurt_time_t pir_edge_ring[PIR_EDGE_RING_SIZE];
+static uint32_t pir_edge_cycles[PIR_EDGE_RING_SIZE];
+static volatile uint32_t pir_edge_head;
+static volatile uint32_t pir_edge_tail;
+static uint32_t pir_edge_overflows;
+
 /**
  * Int_Callback function is to handle the PIR interrupts
  */
 void pir_int_callback(qapi_GPIOINT_Callback_Data_t data)
 {
+	uint32_t head = pir_edge_head;
+
+	if ((head - pir_edge_tail) < PIR_EDGE_RING_SIZE)
+	{
+		pir_edge_cycles[head % PIR_EDGE_RING_SIZE] = lat_trace_cycles();
+		pir_edge_ring[head % PIR_EDGE_RING_SIZE] = qurt_timer_get_ticks();
+		pir_edge_head = head + 1;
+	}
+	else
+		pir_edge_overflows++;
+
 	qurt_signal_set(&pir_int_signal, PIR_THREAD_SIGNAL_INTR);
 	return;
 }
@@ -80,9 +106,9 @@ static qapi_TIMER_handle_t PeriodicMotionTimer;
 qapi_TIMER_define_attr_t Create_Timer_Attr_M;
 uint32_t motion_frequency_threshold = 3;
 uint32_t duration = 3;
+uint32_t num_bulbs = 5;
 extern int  RegisterMotDet_Service();
 uint64_t mot_rate = PULSE_WHITE;
-uint64_t prev_mot_rate = 0x0;
 uint8_t	is_music_on = 0;
 void mscd_write_callback();
 char* mot_rate_func()
@@ -90,6 +116,218 @@ char* mot_rate_func()
 	return (char*)&mot_rate;
 }
 
+/*
+ * Motion intensity estimator. Every PIR edge updates an exponentially
+ * decayed rate and a sliding window of edge timestamps in O(1). The
+ * intensity is the larger of the two, so the lights follow a rising
+ * crowd on the first edges while the window holds the level through
+ * short pauses. Levels have hysteresis bands and a minimum dwell time
+ * before stepping down so the effect does not bounce.
+ */
+#define MOTION_EVAL_MS			(100)
+#define MOTION_WINDOW_EDGES		(64)
+#define MOTION_LEVEL_NONE		(-1)
+#define MOTION_LEVEL_SLOW		(0)
+#define MOTION_LEVEL_MEDIUM		(1)
+#define MOTION_LEVEL_FAST		(2)
+
+typedef struct Motion_Config_s
+{
+	uint32_t tau_ms;		//decay time constant of the rate
+	uint32_t window_ms;		//sliding window length
+	uint32_t medium_epm;		//edges per minute to enter medium
+	uint32_t fast_epm;		//edges per minute to enter fast
+	uint32_t hysteresis_pct;	//how far below a threshold to leave it
+	uint32_t dwell_ms;		//time at a level before stepping down
+} Motion_Config_t;
+
+static Motion_Config_t motion_config = {3000, 3000, 60, 120, 25, 600};
+
+static qurt_time_t motion_window[MOTION_WINDOW_EDGES];
+static uint32_t motion_window_head;
+static uint32_t motion_window_tail;
+static uint32_t motion_rate;			//milli-edges per second at the last edge
+static qurt_time_t motion_last_edge;
+static int motion_level = MOTION_LEVEL_NONE;
+static qurt_time_t motion_level_since;
+static uint32_t motion_intensity_epm;
+static uint32_t motion_edges;			//edges taken since boot, numbers the motion frames
+
+static const uint64_t motion_effects[] = {PULSE_SLOW_PINK, RAINBOW_FAST, FLASH_FAST_YELLOW};
+static const char *motion_level_names[] = {"Slow", "Medium", "Fast"};
+
+static uint32_t motion_ticks_to_ms(qurt_time_t ticks)
+{
+	return (uint32_t)qurt_timer_convert_ticks_to_time(ticks, QURT_TIME_MSEC);
+}
+
+static void motion_reset(void)
+{
+	motion_window_head = 0;
+	motion_window_tail = 0;
+	motion_rate = 0;
+	motion_level = MOTION_LEVEL_NONE;
+	motion_intensity_epm = 0;
+}
+
+/* e^(-k/16) in Q15, k = 0..16 */
+static const uint16_t motion_exp_q15[17] = {
+	32768, 30783, 28918, 27166, 25520, 23974, 22521, 21157, 19875,
+	18671, 17539, 16477, 15479, 14541, 13660, 12832, 12055
+};
+
+/* returns e^(-dt/tau) in Q15 */
+static uint32_t motion_decay_q15(uint32_t dt_ms)
+{
+	uint32_t tau = motion_config.tau_ms;
+	uint32_t whole = dt_ms / tau;
+	uint32_t frac = (uint32_t)(((uint64_t)(dt_ms % tau) << 8) / tau);	//fraction of tau in 1/256
+	uint32_t k = frac >> 4;
+	uint32_t q;
+
+	//e^-11 is below one Q15 step
+	if (whole >= 11)
+		return 0;
+
+	//the fraction from the table, interpolated between 1/16 steps
+	q = (motion_exp_q15[k] * (16 - (frac & 15)) + motion_exp_q15[k + 1] * (frac & 15)) >> 4;
+
+	//times e^-1 for each whole tau
+	while (whole--)
+		q = (q * motion_exp_q15[16]) >> 15;
+
+	return q;
+}
+
+/* returns the rate at 't', decayed by e^(-dt/tau) since the last edge */
+static uint32_t motion_decayed_rate(qurt_time_t t)
+{
+	if (!motion_rate)
+		return 0;
+
+	return (uint32_t)(((uint64_t)motion_rate * motion_decay_q15(motion_ticks_to_ms(t - motion_last_edge))) >> 15);
+}
+
+static void motion_add_edge(qurt_time_t t)
+{
+	motion_rate = motion_decayed_rate(t) + (1000000 / motion_config.tau_ms);
+	motion_last_edge = t;
+
+	//a full window drops its oldest edge
+	if ((motion_window_head - motion_window_tail) == MOTION_WINDOW_EDGES)
+		motion_window_tail++;
+	motion_window[motion_window_head++ % MOTION_WINDOW_EDGES] = t;
+}
+
+/* returns the intensity at 'now' in edges per minute */
+static uint32_t motion_intensity(qurt_time_t now)
+{
+	qurt_time_t window_ticks = qurt_timer_convert_time_to_ticks(motion_config.window_ms, QURT_TIME_MSEC);
+	uint32_t decayed = motion_decayed_rate(now);
+	uint32_t windowed;
+
+	while ((motion_window_tail != motion_window_head) &&
+		((now - motion_window[motion_window_tail % MOTION_WINDOW_EDGES]) > window_ticks))
+		motion_window_tail++;
+
+	windowed = (uint32_t)(((uint64_t)(motion_window_head - motion_window_tail) * 1000000) / motion_config.window_ms);
+
+	return ((decayed > windowed) ? decayed : windowed) * 60 / 1000;
+}
+
+static int motion_classify(uint32_t epm, int level)
+{
+	uint32_t keep = 100 - motion_config.hysteresis_pct;
+
+	if ((epm >= motion_config.fast_epm) ||
+		((level == MOTION_LEVEL_FAST) && (epm * 100 >= motion_config.fast_epm * keep)))
+		return MOTION_LEVEL_FAST;
+
+	if ((epm >= motion_config.medium_epm) ||
+		((level >= MOTION_LEVEL_MEDIUM) && (epm * 100 >= motion_config.medium_epm * keep)))
+		return MOTION_LEVEL_MEDIUM;
+
+	return MOTION_LEVEL_SLOW;
+}
+
+/* edge_cycles is the cycle count of the edge just taken, NULL if none */
+static void motion_evaluate(qurt_time_t now, const uint32_t *edge_cycles)
+{
+	int level;
+
+	motion_intensity_epm = motion_intensity(now);
+	level = motion_classify(motion_intensity_epm, motion_level);
+
+	if (level == motion_level)
+		return;
+
+	//step up at once, step down only after the dwell time
+	if ((level < motion_level) && (motion_ticks_to_ms(now - motion_level_since) < motion_config.dwell_ms))
+		return;
+
+	motion_level = level;
+	motion_level_since = now;
+	lat_trace_begin(motion_effects[level], edge_cycles);
+	QCLI_LOG(qcli_sensors_group, "%s motion detected : %u edges/min\n", motion_level_names[level], motion_intensity_epm);
+
+	//with a song clock running the effect waits for the next beat
+	if (!fx_request(motion_effects[level]))
+	{
+		mot_rate = motion_effects[level];
+		mscd_write_callback();
+	}
+}
+
+/* derives the estimator settings from the PIR duration and threshold */
+static void motion_config_from_pir(void)
+{
+	if (!duration || !motion_frequency_threshold)
+		return;
+
+	motion_config.tau_ms = duration * 1000;
+	motion_config.window_ms = duration * 1000;
+	motion_config.medium_epm = (motion_frequency_threshold * 60) / duration;
+	motion_config.fast_epm = motion_config.medium_epm * 2;
+}
+
+/**
+ * Shows the motion estimator state, or changes its settings. The
+ * settings are positional, those left out keep their value.
+ */
+int32_t sensors_motion_config(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+	Motion_Config_t config = motion_config;
+	uint32_t *fields[] = {&config.tau_ms, &config.window_ms, &config.medium_epm,
+				&config.fast_epm, &config.hysteresis_pct, &config.dwell_ms};
+	uint32_t i;
+
+	if (Parameter_Count > (sizeof(fields) / sizeof(fields[0])))
+		return -1;
+
+	for (i = 0; i < Parameter_Count; i++)
+	{
+		if (!Parameter_List[i].Integer_Is_Valid || (Parameter_List[i].Integer_Value < 0))
+			return -1;
+		*fields[i] = (uint32_t)Parameter_List[i].Integer_Value;
+	}
+
+	if (!config.tau_ms || !config.window_ms || !config.medium_epm ||
+		(config.fast_epm <= config.medium_epm) || (config.hysteresis_pct >= 100))
+	{
+		QCLI_Printf(qcli_sensors_group, "Need tau and window > 0, 0 < medium < fast and hysteresis < 100\n");
+		return -1;
+	}
+
+	motion_config = config;
+
+	QCLI_Printf(qcli_sensors_group, "tau %u ms, window %u ms, medium %u/min, fast %u/min, hysteresis %u%%, dwell %u ms\n",
+		config.tau_ms, config.window_ms, config.medium_epm, config.fast_epm, config.hysteresis_pct, config.dwell_ms);
+	QCLI_Printf(qcli_sensors_group, "intensity %u edges/min, level %s, %u edges lost\n", motion_intensity_epm,
+		(motion_level == MOTION_LEVEL_NONE) ? "none" : motion_level_names[motion_level], pir_edge_overflows);
+
+	return 0;
+}
+
 #endif
 
 /**
@@ -101,8 +339,12 @@ void pir_thread(void *param)
 {
 	int32_t gpio_pin = PIR_PIN;
 	uint32_t sig;
-  uint32_t motion_cnt = 0; 
- 	int motion_announced = 0;
+#ifdef QC_MSC_FESTIVAL
+	qurt_time_t now;
+	uint32_t edge_cycles = 0;
+	uint32_t first_edge;
+	int have_edge;
+#endif
 	// Necessary Data Type declarations
 	qapi_GPIO_ID_t  gpio_id;
 	qapi_Instance_Handle_t pH1;
@@ -145,8 +387,8 @@ void pir_thread(void *param)
   Create_Timer_Attr_M.sigs_mask_data = MOTION_TIMER_SIGNAL_INTR;
   qapi_Timer_Def(&(PeriodicMotionTimer), &Create_Timer_Attr_M);
 
-  /* Start the timer for periodic transmissions.     */
-  Set_Timer_Attr_M.time                   = duration * 1000; 
+  /* Start the timer that lets the motion intensity decay.     */
+  Set_Timer_Attr_M.time                   = MOTION_EVAL_MS; 
   Set_Timer_Attr_M.reload                 = true;
   Set_Timer_Attr_M.max_deferrable_timeout = 0; 
   Set_Timer_Attr_M.unit                   = QAPI_TIMER_UNIT_MSEC;
@@ -164,44 +406,42 @@ void pir_thread(void *param)
 			break;
 		}
 
-		if(!is_music_on)
-			continue;
-
-		if (sig & PIR_THREAD_SIGNAL_INTR)
+#ifdef QC_MSC_FESTIVAL
+		//take the edges recorded by the interrupt, edges seen while the
+		//music is off are dropped
+		have_edge = 0;
+		first_edge = motion_edges + 1;
+		while (pir_edge_tail != pir_edge_head)
 		{
-			QCLI_Printf(qcli_sensors_group, "PIR sensor detected motion = %d\n", (motion_cnt + 1));
-      motion_cnt++;
-
-			if((motion_cnt > motion_frequency_threshold * 2) && (motion_announced < 2))
+			if (is_music_on)
 			{
-				mot_rate = FLASH_FAST_YELLOW; 
-				QCLI_Printf(qcli_sensors_group, "Fast motion detected : *****\n");
-				mscd_write_callback();
-				motion_announced = 2;
+				motion_add_edge(pir_edge_ring[pir_edge_tail % PIR_EDGE_RING_SIZE]);
+				edge_cycles = pir_edge_cycles[pir_edge_tail % PIR_EDGE_RING_SIZE];
+				have_edge = 1;
+				motion_edges++;
+				//without telemetry frames the gateway publishes a motion
+				//timestamp for every line
+				if (!tlm_enabled())
+					QCLI_Printf(qcli_sensors_group, "PIR sensor detected motion = %u\n", (motion_window_head - motion_window_tail));
 			}
-			else if((motion_cnt <= (motion_frequency_threshold * 2)) && (motion_cnt >= motion_frequency_threshold) && !motion_announced)
-			{
-				mot_rate = RAINBOW_FAST;
-				QCLI_Printf(qcli_sensors_group, "Mediam motion detected : **\n");
-				mscd_write_callback();
-				motion_announced = 1;
+			pir_edge_tail++;
+		}
+		now = qurt_timer_get_ticks();
 
-			}	
+		if(!is_music_on)
+		{
+			motion_reset();
+			continue;
 		}
 
-#ifdef QC_MSC_FESTIVAL
+		//an edge is acted on at once, the timer lets the intensity decay
+		motion_evaluate(now, have_edge ? &edge_cycles : NULL);
 
-	if (sig & MOTION_TIMER_SIGNAL_INTR)
-	{
-		motion_announced = 0;
-		if(motion_cnt < motion_frequency_threshold)
-    {
-			mot_rate = PULSE_SLOW_PINK;
-			QCLI_Printf(qcli_sensors_group, "Slow motion detected : *\n");
-			mscd_write_callback();
-		}
-		motion_cnt = 0;
-	}
+		//the gateway publishes a motion timestamp for every frame
+		for (; have_edge && (first_edge <= motion_edges); first_edge++)
+			tlm_motion(first_edge, motion_intensity_epm,
+				(motion_level == MOTION_LEVEL_NONE) ? TLM_LEVEL_NONE : (uint32_t)motion_level,
+				(motion_window_head - motion_window_tail));
 #endif
 	}
 
@@ -224,11 +464,9 @@ release_gpio:
 
 #define MSCD_THREAD_STACK_SIZE		(4096)
 #define MSCD_THREAD_PRIORITY		(12)
-#define MSCD_THREAD_STOP			(1<<5)
+#define MSCD_THREAD_STOP			(2)
 
 #define MSCD_SCAN_RESULT_SIGNAL_INTR		(1)
-#define MSCD_CONNECTION_SUCCESS_SIGNAL_INTR		(2)
-#define MSCD_SERVICE_DISCOVERY_SIGNAL_INTR (3)
 #define MSCD_PERIODIC_TIMER_SIGNAL_INTR (4)
 #define MSCD_SCAN_STOPPED_SIGNAL_INTR (5)
 
@@ -236,152 +474,306 @@ release_gpio:
 #define MSCD_CONNECTION_RESULT		(7)
 #define MSCD_SERVICE_DISCOVERY_RESULT (8)
 #define MSCD_DISCONNECTION_RESULT (9)
-#define MSCD_CONNECTION_FAILED_SIGNAL_INTR (10)
+#define MSCD_EFFECT_DUE_SIGNAL_INTR		(10)
 #define MSCD_WRITE_SIGNAL_INTR			(11)
-//wait 20 secs (1 tick = 5 secs) for connection response
-//if no response is received within 20 secs
-//close connection request, clear scan data
-//and try to connect to next device in scanned list
-#define MSCD_CONNECTION_TICKS 4
+#define MSCD_MTU_EXCHANGE_RESULT		(12)
+#define MSCD_CONNECTION_FAILED_RESULT		(13)
+#define MSCD_SERVICE_DISCOVERY_COMPLETE		(14)
+#define MSCD_WRITE_RESULT		(15)
+
+//connection manager tick, the connection, discovery and backoff
+//timeouts in spple_demo.c are counted in these ticks
+#define MSCD_TICK_MS			(500)
+//look for missing bulbs every 5 secs
+#define MSCD_SCAN_INTERVAL_TICKS	(10)
+//event records come from a fixed pool, the pipe holds the whole pool so
+//posting never blocks, an event that finds the pool empty is counted
+//and dropped
+#define MSCD_EVENT_POOL_SIZE		(32)
+#define MSCD_EVENT_DATA_SIZE		(16)
+#define MSCD_NUM_EVENT_TYPES		(16)
+
 typedef struct MSCD_Q_s
 {
    int event_type;
-   void *data;
+   union
+   {
+      int value;
+      uint8_t bytes[MSCD_EVENT_DATA_SIZE];
+   } data;
 } MSCD_Q_t;
 
+typedef struct MSCD_Event_Stats_s
+{
+   uint32_t posted;
+   uint32_t coalesced;
+   uint32_t dropped;
+} MSCD_Event_Stats_t;
+
+static const char *mscd_event_names[MSCD_NUM_EVENT_TYPES] =
+{
+   NULL, "scan done", "thread stop", NULL, "timer", "scan stopped", "scan result", "connection",
+   "discovery result", "disconnection", "effect due", "write signal", "mtu exchange", "connect failed",
+   "discovery done", "write result"
+};
 
 qapi_TIMER_set_attr_t MSCD_Set_Timer_Attr;
 static qapi_TIMER_handle_t PeriodicScanTimer;
 qapi_TIMER_define_attr_t MSCD_Create_Timer_Attr;
-uint32_t mscd_duration = 5000;
+uint32_t mscd_duration = MSCD_TICK_MS;
 //static qurt_signal_t mscd_int_signal;
 static qurt_pipe_attr_t mscd_qattr;
 static qurt_pipe_t mscd_q;
 extern QCLI_Command_Status_t mscd_InitializeBluetooth();
+extern int mscd_registry_init(unsigned int NumBulbs);
 extern int mscd_start_scan();
-extern int mscd_start_connect();
-extern void mscd_discover_services();
 extern void mscd_add_scan_entry(void *);
 extern int mscd_assign_connection_info(void * data);
 extern void mscd_attach_handles( void * data);
 extern int mscd_handle_disconnection(void *data);
-extern int ResetMSCDSelectedDeviceData();
-extern void mscd_write_motion_data();
+extern int mscd_handle_connection_failed(void *data);
+extern void mscd_handle_mtu_exchanged(void *data);
+extern void mscd_handle_discovery_complete(int deviceIndex);
+extern void mscd_connmgr_tick();
+extern int mscd_connmgr_run(int scan_active);
+extern void mscd_fanout_run();
+extern void mscd_handle_write_result(void *data);
 
 MSCD_Q_t *mscd_qdata;
-MSCD_Q_t timer_signal = {MSCD_PERIODIC_TIMER_SIGNAL_INTR, 0};
-MSCD_Q_t scan_result_signal = {MSCD_SCAN_RESULT_SIGNAL_INTR, 0};
-MSCD_Q_t scan_stopped_signal = {MSCD_SCAN_STOPPED_SIGNAL_INTR, 0};
-MSCD_Q_t services_discovered_signal = {MSCD_SERVICE_DISCOVERY_SIGNAL_INTR, 0};
-MSCD_Q_t connection_result_signal = {MSCD_CONNECTION_SUCCESS_SIGNAL_INTR, 0};
-MSCD_Q_t disconnection_result_signal = {MSCD_CONNECTION_FAILED_SIGNAL_INTR, 0};
-MSCD_Q_t mscd_thread_stop_signal = {MSCD_THREAD_STOP, 0};
-MSCD_Q_t mscd_write_signal = {MSCD_WRITE_SIGNAL_INTR, 0};
+static MSCD_Q_t mscd_event_pool[MSCD_EVENT_POOL_SIZE];
+static MSCD_Q_t *mscd_event_free[MSCD_EVENT_POOL_SIZE];
+static uint32_t mscd_event_free_count;
+static MSCD_Q_t mscd_thread_stop_signal = {MSCD_THREAD_STOP};
+static qurt_mutex_t mscd_event_lock;
+static int mscd_event_lock_created;
+static volatile int mscd_event_ready;
+static uint8_t mscd_event_pending[MSCD_NUM_EVENT_TYPES];
+static uint32_t mscd_event_in_use;
+static uint32_t mscd_event_high_water;
+static MSCD_Event_Stats_t mscd_event_stats[MSCD_NUM_EVENT_TYPES];
+
+/* timer ticks and write signals carry no data, one queued is enough */
+static int mscd_event_coalesces(int event_type)
+{
+  return ((event_type == MSCD_PERIODIC_TIMER_SIGNAL_INTR) || (event_type == MSCD_WRITE_SIGNAL_INTR) ||
+    (event_type == MSCD_EFFECT_DUE_SIGNAL_INTR));
+}
 
-void mscd_scan_stopped_callback()
+/**
+ * Queues an event for mscd_thread, data is copied into the event
+ * record. Never blocks and never allocates, so it is safe to call from
+ * the BLE stack callbacks. Returns 0 if the event was queued or merged
+ * with one already queued.
+ */
+static int mscd_post_event(int event_type, const void *data, uint32_t length)
 {
-	MSCD_Q_t *mscd_sig = &scan_stopped_signal;
-  qurt_pipe_send (mscd_q, &mscd_sig);
-	return;
+  MSCD_Q_t *t_qdata = NULL;
+
+  if (!mscd_event_ready || (event_type <= 0) || (event_type >= MSCD_NUM_EVENT_TYPES))
+    return -1;
+
+  qurt_mutex_lock(&mscd_event_lock);
+
+  if (mscd_event_coalesces(event_type) && mscd_event_pending[event_type])
+  {
+    mscd_event_stats[event_type].coalesced++;
+    qurt_mutex_unlock(&mscd_event_lock);
+    return 0;
+  }
+
+  if (mscd_event_free_count && (length <= MSCD_EVENT_DATA_SIZE))
+  {
+    t_qdata = mscd_event_free[--mscd_event_free_count];
+    if (++mscd_event_in_use > mscd_event_high_water)
+      mscd_event_high_water = mscd_event_in_use;
+    if (mscd_event_coalesces(event_type))
+      mscd_event_pending[event_type] = 1;
+    mscd_event_stats[event_type].posted++;
+  }
+  else
+    mscd_event_stats[event_type].dropped++;
+
+  qurt_mutex_unlock(&mscd_event_lock);
+
+  if (!t_qdata)
+    return -1;
+
+  t_qdata->event_type = event_type;
+  if (length)
+    memcpy(t_qdata->data.bytes, data, length);
+  qurt_pipe_send (mscd_q, &t_qdata);
+
+  return 0;
 }
 
+/* called by mscd_thread before it handles an event */
+static void mscd_take_event(MSCD_Q_t *event)
+{
+  if (event == &mscd_thread_stop_signal)
+    return;
+
+  qurt_mutex_lock(&mscd_event_lock);
+  if (mscd_event_coalesces(event->event_type))
+    mscd_event_pending[event->event_type] = 0;
+  qurt_mutex_unlock(&mscd_event_lock);
+}
 
-void mscd_disconnection_result_callback()
+/* called by mscd_thread once it has handled an event */
+static void mscd_release_event(MSCD_Q_t *event)
 {
-	MSCD_Q_t *mscd_sig = &disconnection_result_signal;
-  qurt_pipe_send (mscd_q, &mscd_sig);
+  if (event == &mscd_thread_stop_signal)
+    return;
+
+  qurt_mutex_lock(&mscd_event_lock);
+  mscd_event_free[mscd_event_free_count++] = event;
+  mscd_event_in_use--;
+  qurt_mutex_unlock(&mscd_event_lock);
+}
+
+static void mscd_event_pool_init(void)
+{
+  uint32_t i;
+
+  if (!mscd_event_lock_created)
+  {
+    qurt_mutex_create(&mscd_event_lock);
+    mscd_event_lock_created = 1;
+  }
+
+  qurt_mutex_lock(&mscd_event_lock);
+  for (i = 0; i < MSCD_EVENT_POOL_SIZE; i++)
+    mscd_event_free[i] = &mscd_event_pool[i];
+  mscd_event_free_count = MSCD_EVENT_POOL_SIZE;
+  mscd_event_in_use = 0;
+  memset(mscd_event_pending, 0, sizeof(mscd_event_pending));
+  qurt_mutex_unlock(&mscd_event_lock);
+}
+
+/**
+ * Shows the event pool high-water mark and the per event type counters,
+ * and clears them if requested.
+ */
+void mscd_print_event_stats(QCLI_Group_Handle_t group, int reset)
+{
+  int i;
+
+  QCLI_Printf(group, "Event pool: %u records, %u in use, high-water %u\n", MSCD_EVENT_POOL_SIZE,
+    mscd_event_in_use, mscd_event_high_water);
+  QCLI_Printf(group, "%-17s %8s %9s %7s\n", "event", "posted", "coalesced", "dropped");
+
+  for (i = 0; i < MSCD_NUM_EVENT_TYPES; i++)
+  {
+    if (mscd_event_names[i])
+      QCLI_Printf(group, "%-17s %8u %9u %7u\n", mscd_event_names[i], mscd_event_stats[i].posted,
+        mscd_event_stats[i].coalesced, mscd_event_stats[i].dropped);
+  }
+
+  if (reset)
+  {
+    qurt_mutex_lock(&mscd_event_lock);
+    memset(mscd_event_stats, 0, sizeof(mscd_event_stats));
+    mscd_event_high_water = mscd_event_in_use;
+    qurt_mutex_unlock(&mscd_event_lock);
+  }
+}
+
+void mscd_scan_stopped_callback()
+{
+  mscd_post_event(MSCD_SCAN_STOPPED_SIGNAL_INTR, NULL, 0);
 	return;
 }
 
 
 void mscd_scan_result_callback()
 {
-	MSCD_Q_t *mscd_sig = &scan_result_signal;
-  qurt_pipe_send (mscd_q, &mscd_sig);
+  mscd_post_event(MSCD_SCAN_RESULT_SIGNAL_INTR, NULL, 0);
 }
 
-void mscd_connection_result_callback()
+void mscd_scan_result(const void *scan_data, uint32_t length)
 {
-	MSCD_Q_t *mscd_sig = &connection_result_signal;
-  qurt_pipe_send (mscd_q, &mscd_sig);
+  mscd_post_event(MSCD_SCAN_RESULT, scan_data, length);
+	return;
 }
 
-void mscd_service_discovery_callback()
+void mscd_connection_result(const void *conn_data, uint32_t length)
 {
-	MSCD_Q_t *mscd_sig = &services_discovered_signal;
-  qurt_pipe_send (mscd_q, &mscd_sig);
+  mscd_post_event(MSCD_CONNECTION_RESULT, conn_data, length);
+	return;
 }
 
-void mscd_scan_result(void *scan_data)
+void mscd_connection_failed_result(const void *conn_data, uint32_t length)
 {
-  MSCD_Q_t *t_qdata;
-  t_qdata = malloc(sizeof(MSCD_Q_t));
-  memset(t_qdata, 0, sizeof(MSCD_Q_t));
-  t_qdata->event_type = MSCD_SCAN_RESULT;
-  t_qdata->data = scan_data;
-  qurt_pipe_send (mscd_q, &t_qdata);
+  mscd_post_event(MSCD_CONNECTION_FAILED_RESULT, conn_data, length);
 	return;
 }
 
-void mscd_connection_result(void *conn_data)
+void mscd_mtu_exchange_result(const void *mtu_data, uint32_t length)
 {
-  MSCD_Q_t *t_qdata;
-  t_qdata = malloc(sizeof(MSCD_Q_t));
-  memset(t_qdata, 0, sizeof(MSCD_Q_t));
-  t_qdata->event_type = MSCD_CONNECTION_RESULT;
-  t_qdata->data = conn_data;
-  qurt_pipe_send (mscd_q, &t_qdata);
+  mscd_post_event(MSCD_MTU_EXCHANGE_RESULT, mtu_data, length);
 	return;
 }
 
-void mscd_disconnection_result(void *disconn_data)
+void mscd_disconnection_result(const void *disconn_data, uint32_t length)
 {
-  MSCD_Q_t *t_qdata;
-  t_qdata = malloc(sizeof(MSCD_Q_t));
-  memset(t_qdata, 0, sizeof(MSCD_Q_t));
-  t_qdata->event_type = MSCD_DISCONNECTION_RESULT;
-  t_qdata->data = disconn_data;
-  qurt_pipe_send (mscd_q, &t_qdata);
+  mscd_post_event(MSCD_DISCONNECTION_RESULT, disconn_data, length);
 	return;
 }
 
-void mscd_service_discovery_result(void *service_data)
+void mscd_service_discovery_result(const void *service_data, uint32_t length)
 {
-  MSCD_Q_t *t_qdata;
-  t_qdata = malloc(sizeof(MSCD_Q_t));
-  memset(t_qdata, 0, sizeof(MSCD_Q_t));
-  t_qdata->event_type = MSCD_SERVICE_DISCOVERY_RESULT;
-  t_qdata->data = service_data;
-  qurt_pipe_send (mscd_q, &t_qdata);
+  mscd_post_event(MSCD_SERVICE_DISCOVERY_RESULT, service_data, length);
+	return;
+}
+
+void mscd_service_discovery_complete(int deviceIndex)
+{
+  mscd_post_event(MSCD_SERVICE_DISCOVERY_COMPLETE, &deviceIndex, sizeof(deviceIndex));
+	return;
+}
+
+void mscd_write_result(const void *write_data, uint32_t length)
+{
+  mscd_post_event(MSCD_WRITE_RESULT, write_data, length);
 	return;
 }
 
 void mscd_thread_stop_callback()
 {
 	MSCD_Q_t *mscd_sig = &mscd_thread_stop_signal;
-  qurt_pipe_send (mscd_q, &mscd_sig);
+
+	//the stop record is not part of the pool so it is never dropped
+	if (mscd_event_ready)
+		qurt_pipe_send (mscd_q, &mscd_sig);
 	return;
 }
 
 void mscd_write_callback()
 {
-	MSCD_Q_t *mscd_sig = &mscd_write_signal;
-  qurt_pipe_send (mscd_q, &mscd_sig);
+  mscd_post_event(MSCD_WRITE_SIGNAL_INTR, NULL, 0);
 	return;
 }
 
 void mscd_timer_callback()
 {
-	MSCD_Q_t *mscd_sig = &timer_signal;
-  qurt_pipe_send (mscd_q, &mscd_sig);
+  mscd_post_event(MSCD_PERIODIC_TIMER_SIGNAL_INTR, NULL, 0);
 }
 
+void mscd_effect_due_callback()
+{
+  mscd_post_event(MSCD_EFFECT_DUE_SIGNAL_INTR, NULL, 0);
+}
+
+/**
+ * func(): mscd_thread owns the bulb connection manager. Every
+ * event from the BLE stack is handed to spple_demo.c and the
+ * connection manager is run after it, so that connections and
+ * service discoveries to several bulbs proceed in parallel.
+ */
 void mscd_thread(void *param)
 {
-  int mscd_scan_permitted = 1;
-  int cnt = 0;
-  int connection_timer_on = 0;
-  int connection_ticks = 0;
+  int scan_active = 0;
+  int connect_pending = 0;
+  int scan_ticks = MSCD_SCAN_INTERVAL_TICKS;
 
   MSCD_Create_Timer_Attr.deferrable     = false;
   MSCD_Create_Timer_Attr.cb_type        = QAPI_TIMER_FUNC1_CB_TYPE;
@@ -401,118 +793,92 @@ void mscd_thread(void *param)
 	while(1)
 	{
     qurt_pipe_receive (mscd_q, &mscd_qdata);
- 		QCLI_Printf(qcli_sensors_group, "MSCD signal received %u\n", mscd_qdata->event_type);
+    mscd_take_event(mscd_qdata);
  		if(mscd_qdata->event_type == MSCD_WRITE_SIGNAL_INTR)
 		{
-			QCLI_Printf(qcli_sensors_group, "Received Write Signal\n");
-	   if(mscd_scan_permitted && (prev_mot_rate != mot_rate))
-	   	{
-	   			mscd_write_motion_data();
-	   			prev_mot_rate = mot_rate;
-	   	}
+			lat_trace_stamp(lat_trace_current(), LAT_STAGE_DEQUEUE);
+			//only bulbs that have not confirmed the effect are written
+			mscd_fanout_run();
+		}
+		else if(mscd_qdata->event_type == MSCD_EFFECT_DUE_SIGNAL_INTR)
+		{
+			//a keyframe is written its lead time ahead of the beat
+			if(fx_run(&mot_rate))
+			{
+				lat_trace_stamp(lat_trace_current(), LAT_STAGE_DEQUEUE);
+				mscd_fanout_run();
+			}
 		}
 		else if(mscd_qdata->event_type == MSCD_PERIODIC_TIMER_SIGNAL_INTR)
 		{
-	 		QCLI_Printf(qcli_sensors_group, "MSCD timer signal received 0x%d\n", mscd_scan_permitted);
-	 		if(connection_timer_on)
-	 		{
-				QCLI_Printf(qcli_sensors_group, "MSCD connection timer on\n");
-	 			connection_ticks++;
-	 			if(connection_ticks == MSCD_CONNECTION_TICKS)
+			mscd_connmgr_tick();
+
+			//scan for missing bulbs, never while a connection round
+			//is outstanding as the controller is initiating
+			if(!scan_active && !connect_pending && (++scan_ticks >= MSCD_SCAN_INTERVAL_TICKS))
+			{
+				scan_ticks = 0;
+				if(mscd_start_scan())
 				{
-					ResetMSCDSelectedDeviceData();
-					connection_timer_on = 0;
-					connection_ticks = 0;
-	      	mscd_disconnection_result_callback();
+					QCLI_LOG(qcli_sensors_group, "MSCD timer/scan event received\n");
+					scan_active = 1;
 				}
-	 		}
-	 		else if(mscd_scan_permitted)
-	 		{
-	 			//scan at an interval of 20 secs
-				switch (cnt%4)
-	      {
-	      case 0:
-		 			cnt = 0;
-		 			//fall through if scan is not needed
-					if(mscd_start_scan())
-					{
-			   		QCLI_Printf(qcli_sensors_group, "MSCD timer/scan event received\n");
-			   		mscd_scan_permitted = 0;
-						break;
-					}
-				default:
-      		mscd_write_motion_data();
-      		break;
-      	}
 			}
-	   	cnt++;
+
+			//retry bulbs whose writes were dropped
+			mscd_fanout_run();
 		}		
-		else if(mscd_qdata->event_type == MSCD_SCAN_STOPPED_SIGNAL_INTR)
+		else if(mscd_qdata->event_type == MSCD_SCAN_STOPPED_SIGNAL_INTR ||
+			mscd_qdata->event_type == MSCD_SCAN_RESULT_SIGNAL_INTR)
 		{
-			//make sure all devices we are looking for have not been found
-			//before enabling scan
-	   	mscd_scan_permitted = 1;
+			//bulbs found by the scan are connected by the
+			//connection manager below
+			QCLI_LOG(qcli_sensors_group, "MSCD scan completed event received\n");
+			scan_active = 0;
 		}
-		else if(mscd_qdata->event_type == MSCD_SCAN_RESULT_SIGNAL_INTR || 
-			mscd_qdata->event_type == MSCD_CONNECTION_FAILED_SIGNAL_INTR)
+		else if(mscd_qdata->event_type == MSCD_SCAN_RESULT)
 		{
-			//process the scan list - connect to devices in list 
-			//do not permit scan as we need to connect and configure 
-			//devices found in previous scan
-			connection_ticks = 0;
-			QCLI_Printf(qcli_sensors_group, "MSCD scan completed event received\n");
-			if((connection_timer_on = mscd_start_connect()))
-				mscd_scan_permitted = 0;
-			else
-				mscd_scan_permitted = 1;
+      mscd_add_scan_entry(mscd_qdata->data.bytes);
 		}
-    else if(mscd_qdata->event_type ==  MSCD_CONNECTION_SUCCESS_SIGNAL_INTR)
-		{
-			//process the scan list - connect to devices in list 
-			QCLI_Printf(qcli_sensors_group, "MSCD connection completed event received\n");
-			connection_timer_on = 0;
-			mscd_discover_services();
-		}		
-		else if(mscd_qdata->event_type == MSCD_SERVICE_DISCOVERY_SIGNAL_INTR)
+		else if(mscd_qdata->event_type == MSCD_CONNECTION_RESULT)
 		{
-
-			//process the scan list - connect to devices in list 
-			connection_ticks = 0;
-			QCLI_Printf(qcli_sensors_group, "MSCD service discovery completed event received\n");
-			if((connection_timer_on = mscd_start_connect()))
-				mscd_scan_permitted = 0;
-			else
-				mscd_scan_permitted = 1;
-
-		}		
-		else if(mscd_qdata->event_type == MSCD_SCAN_RESULT)
+      mscd_assign_connection_info(mscd_qdata->data.bytes);
+		}
+		else if(mscd_qdata->event_type == MSCD_CONNECTION_FAILED_RESULT)
 		{
-      mscd_add_scan_entry(mscd_qdata->data);
-      free(mscd_qdata);
+      mscd_handle_connection_failed(mscd_qdata->data.bytes);
 		}
-		else if(mscd_qdata->event_type == MSCD_CONNECTION_RESULT)
+		else if(mscd_qdata->event_type == MSCD_MTU_EXCHANGE_RESULT)
 		{
-      mscd_assign_connection_info(mscd_qdata->data);
-      free(mscd_qdata);
+      mscd_handle_mtu_exchanged(mscd_qdata->data.bytes);
 		}
 		else if(mscd_qdata->event_type == MSCD_DISCONNECTION_RESULT)
 		{
-      if(mscd_handle_disconnection(mscd_qdata->data))
-      	mscd_disconnection_result_callback();
-      free(mscd_qdata);
+      mscd_handle_disconnection(mscd_qdata->data.bytes);
 		}
 		else if(mscd_qdata->event_type == MSCD_SERVICE_DISCOVERY_RESULT)
 		{
-		  mscd_attach_handles(mscd_qdata->data);	
-      free(mscd_qdata);
+		  mscd_attach_handles(mscd_qdata->data.bytes);	
+		}
+		else if(mscd_qdata->event_type == MSCD_SERVICE_DISCOVERY_COMPLETE)
+		{
+		  mscd_handle_discovery_complete(mscd_qdata->data.value);
+		}
+		else if(mscd_qdata->event_type == MSCD_WRITE_RESULT)
+		{
+		  mscd_handle_write_result(mscd_qdata->data.bytes);
 		}
 		else if (mscd_qdata->event_type == MSCD_THREAD_STOP)
 		{
 			break;
 		}
+
+		mscd_release_event(mscd_qdata);
+		connect_pending = mscd_connmgr_run(scan_active);
 	}
 
 	QCLI_Printf(qcli_sensors_group, "Signal received to disable MSCD thread\n");
+	mscd_event_ready = 0;
 	qurt_pipe_delete(mscd_q);
   qapi_Timer_Undef(PeriodicScanTimer);	
 	qurt_thread_stop();
@@ -525,13 +891,16 @@ void mscd_demo_init()
 	qurt_thread_attr_t thread_attribute;
 	qurt_thread_t      thread_handle;
   qurt_pipe_attr_init (&mscd_qattr);
-  qurt_pipe_attr_set_elements (&mscd_qattr, 10);
-  qurt_pipe_attr_set_element_size (&mscd_qattr, sizeof(int *));
+  //room for the whole pool and the stop record
+  qurt_pipe_attr_set_elements (&mscd_qattr, MSCD_EVENT_POOL_SIZE + 1);
+  qurt_pipe_attr_set_element_size (&mscd_qattr, sizeof(MSCD_Q_t *));
 	if (0 != qurt_pipe_create (&mscd_q, &mscd_qattr))
 	{
 		QCLI_Printf(qcli_sensors_group, "Not able to initialize mscd q\n");
 		return;
 	}
+	mscd_event_pool_init();
+	mscd_event_ready = 1;
 	qurt_thread_attr_init(&thread_attribute);
 	qurt_thread_attr_set_name(&thread_attribute, "mscd2_thrd");
 	qurt_thread_attr_set_priority(&thread_attribute, MSCD_THREAD_PRIORITY);
@@ -540,6 +909,8 @@ void mscd_demo_init()
 	if (ret != QAPI_OK)
 	{
 		QCLI_Printf(qcli_sensors_group, "Music demo thread creation failed\n");
+		mscd_event_ready = 0;
+		qurt_pipe_delete(mscd_q);
 		return;
 	}
 
@@ -557,10 +928,11 @@ QCLI_Command_Status_t sensors_pir_driver_test(uint32_t Parameter_Count, QCLI_Par
 
 	if (Parameter_Count == 0)
 	{
-		QCLI_Printf(qcli_sensors_group, "USAGE: number <duration frequency_threshold>\n"
+		QCLI_Printf(qcli_sensors_group, "USAGE: number <duration frequency_threshold num_bulbs>\n"
 			"\tnumber = 0:disable pir | 1:enable pir \n  duration = sec (%d by default)\n"
-			"\tfrequency_threshold: number of detections to define motion speed (%d by default)\n", 
-							duration, motion_frequency_threshold);
+			"\tfrequency_threshold: number of detections to define motion speed (%d by default)\n"
+			"\tnum_bulbs: number of bulbs to drive (%d by default)\n", 
+							duration, motion_frequency_threshold, num_bulbs);
 		return 0;
 	}
 
@@ -574,15 +946,17 @@ QCLI_Command_Status_t sensors_pir_driver_test(uint32_t Parameter_Count, QCLI_Par
 	{
 		is_music_on = 0;
 		if(pir_enabled){
+			fx_cancel();
 			mot_rate = PULSE_WHITE;
 			mscd_write_callback();
 			QCLI_Printf(qcli_sensors_group, "Music OFF \n");
 		}
 		else{
-			QCLI_Printf(qcli_sensors_group, "USAGE: number <duration frequency_threshold>\n"
+			QCLI_Printf(qcli_sensors_group, "USAGE: number <duration frequency_threshold num_bulbs>\n"
 			"\tnumber = 0:disable pir | 1:enable pir \n  duration = sec (%d by default)\n"
-			"\tfrequency_threshold: number of detections to define motion speed (%d by default)\n", 
-							duration, motion_frequency_threshold);
+			"\tfrequency_threshold: number of detections to define motion speed (%d by default)\n"
+			"\tnum_bulbs: number of bulbs to drive (%d by default)\n", 
+							duration, motion_frequency_threshold, num_bulbs);
 		}
 	}		
 
@@ -590,15 +964,17 @@ QCLI_Command_Status_t sensors_pir_driver_test(uint32_t Parameter_Count, QCLI_Par
 	{
 		is_music_on = 1;
 		if(pir_enabled){
+			fx_cancel();
 			mot_rate = PULSE_SLOW_PINK;
 			mscd_write_callback();
 			QCLI_Printf(qcli_sensors_group, "Music ON \n");
 		}
 		else{
-			QCLI_Printf(qcli_sensors_group, "USAGE: number <duration frequency_threshold>\n"
+			QCLI_Printf(qcli_sensors_group, "USAGE: number <duration frequency_threshold num_bulbs>\n"
 			"\tnumber = 0:disable pir | 1:enable pir \n  duration = sec (%d by default)\n"
-			"\tfrequency_threshold: number of detections to define motion speed (%d by default)\n",
-							duration, motion_frequency_threshold);
+			"\tfrequency_threshold: number of detections to define motion speed (%d by default)\n"
+			"\tnum_bulbs: number of bulbs to drive (%d by default)\n",
+							duration, motion_frequency_threshold, num_bulbs);
 		}
 	}		
 
@@ -606,16 +982,22 @@ QCLI_Command_Status_t sensors_pir_driver_test(uint32_t Parameter_Count, QCLI_Par
 	{
 		if (Parameter_Count == 2)
 			duration = Parameter_List[1].Integer_Value ;
-		if (Parameter_Count == 3) {
+		if (Parameter_Count >= 3) {
 			duration = Parameter_List[1].Integer_Value;
       motion_frequency_threshold = Parameter_List[2].Integer_Value;
-      /*if (Parameter_List[3].Integer_Value > 5)
-      {
-      	QCLI_Printf(qcli_sensors_group, "Number of Bulbs can't be more than 5");
-      	return 0;
-      }*/
 		}
+		if (Parameter_Count >= 4)
+			num_bulbs = Parameter_List[3].Integer_Value;
+		motion_config_from_pir();
+		lat_trace_init();
+		tlm_init();
+		fx_init();
 		mscd_InitializeBluetooth();
+		if (mscd_registry_init(num_bulbs))
+		{
+			QCLI_Printf(qcli_sensors_group, "Unable to size registry for %u bulbs\n", num_bulbs);
+			return -1;
+		}
     mscd_demo_init();
 
 		//QC-MSC-FSTVL-End
@@ -640,6 +1022,7 @@ QCLI_Command_Status_t sensors_pir_driver_test(uint32_t Parameter_Count, QCLI_Par
 	else if(!Parameter_List[0].Integer_Value)
 	{
 		is_music_on = 0;
+		fx_cancel();
 		mot_rate = PULSE_WHITE;
 		mscd_write_callback();
 		qurt_signal_set(&pir_int_signal, PIR_THREAD_STOP);
@@ -648,10 +1031,11 @@ QCLI_Command_Status_t sensors_pir_driver_test(uint32_t Parameter_Count, QCLI_Par
 		mscd_thread_stop_callback();
 	}
 	else{
-		QCLI_Printf(qcli_sensors_group, "USAGE: number <duration frequency_threshold>\n"
+		QCLI_Printf(qcli_sensors_group, "USAGE: number <duration frequency_threshold num_bulbs>\n"
 			"\tnumber = 0:disable pir | 1:enable pir \n  duration = sec (%d by default)\n"
-			"\tfrequency_threshold: number of detections to define motion speed (%d by default)\n", 
-							duration, motion_frequency_threshold);
+			"\tfrequency_threshold: number of detections to define motion speed (%d by default)\n"
+			"\tnum_bulbs: number of bulbs to drive (%d by default)\n", 
+							duration, motion_frequency_threshold, num_bulbs);
 	}
 	return 0;
 }
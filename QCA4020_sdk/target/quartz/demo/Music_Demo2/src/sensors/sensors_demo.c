@@ -29,6 +29,10 @@
 #include <qapi_wlan.h>
 #include "qurt_thread.h"
 #include "sensors_demo.h"
+#include "lat_trace.h"
+#include "telemetry.h"
+#include "effects.h"
+#include "pal.h"
 
 extern QCLI_Group_Handle_t qcli_peripherals_group;              /* Handle for our peripherals subgroup. */
 
@@ -36,11 +40,25 @@ QCLI_Group_Handle_t qcli_sensors_group;              /* Handle for our QCLI Comm
 
 
 QCLI_Command_Status_t sensors_pir(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+QCLI_Command_Status_t sensors_bulb_stats(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+QCLI_Command_Status_t sensors_motion(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+QCLI_Command_Status_t sensors_latency(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+QCLI_Command_Status_t sensors_events(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+QCLI_Command_Status_t sensors_telemetry(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+QCLI_Command_Status_t sensors_console(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+QCLI_Command_Status_t sensors_tempo(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 
 const QCLI_Command_t sensors_cmd_list[] =
 {
    // cmd_function        start_thread          cmd_string               usage_string                   description
    { sensors_pir,          false,          "PIR",                          "",                    "pir motion sensor"   },
+   { sensors_bulb_stats,   false,          "BulbStats",                    "[reset]",             "bulb write latency and drop counters"   },
+   { sensors_motion,       false,          "Motion",                       "[tau_ms window_ms medium_per_min fast_per_min hysteresis_pct dwell_ms]", "motion intensity estimator settings"   },
+   { sensors_latency,      false,          "Latency",                      "[reset|dump|stream <0|1>]", "PIR to light latency per stage"   },
+   { sensors_events,       false,          "Events",                       "[reset]",             "MSCD event queue counters"   },
+   { sensors_telemetry,    false,          "Telemetry",                    "[0|1|reset]",         "binary telemetry frames to the gateway"   },
+   { sensors_console,      false,          "Console",                      "[drop|block|reset]",  "console transmit buffer policy and counters"   },
+   { sensors_tempo,        false,          "Tempo",                        "[clear|add <song_ms> <bpm>|start <song_ms>|stop|quantum <beats>|lead <ms|auto>|reset]", "beat synchronized effect timeline"   },
 };
 
 const QCLI_Command_Group_t sensors_cmd_group =
@@ -76,3 +94,211 @@ QCLI_Command_Status_t sensors_pir(uint32_t Parameter_Count, QCLI_Parameter_t *Pa
 
     return QCLI_STATUS_SUCCESS_E;
 }
+
+QCLI_Command_Status_t sensors_motion(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+    int32_t sensors_motion_config(uint32_t Parameter_Count, QCLI_Parameter_t *pvParameters);
+
+    if (sensors_motion_config(Parameter_Count, Parameter_List) != 0)
+       return QCLI_STATUS_USAGE_E;
+
+    return QCLI_STATUS_SUCCESS_E;
+}
+
+QCLI_Command_Status_t sensors_bulb_stats(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+    void mscd_print_write_stats(QCLI_Group_Handle_t Group, int Reset);
+    int reset = 0;
+
+    if (Parameter_Count >= 1)
+    {
+       if (strcmp((char *)Parameter_List[0].String_Value, "reset"))
+          return QCLI_STATUS_USAGE_E;
+
+       reset = 1;
+    }
+
+    mscd_print_write_stats(qcli_sensors_group, reset);
+
+    return QCLI_STATUS_SUCCESS_E;
+}
+
+QCLI_Command_Status_t sensors_events(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+    void mscd_print_event_stats(QCLI_Group_Handle_t group, int reset);
+    int reset = 0;
+
+    if (Parameter_Count >= 1)
+    {
+       if (strcmp((char *)Parameter_List[0].String_Value, "reset"))
+          return QCLI_STATUS_USAGE_E;
+
+       reset = 1;
+    }
+
+    mscd_print_event_stats(qcli_sensors_group, reset);
+
+    return QCLI_STATUS_SUCCESS_E;
+}
+
+QCLI_Command_Status_t sensors_telemetry(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+    int reset = 0;
+
+    if (Parameter_Count >= 1)
+    {
+       if (!strcmp((char *)Parameter_List[0].String_Value, "reset"))
+          reset = 1;
+       else if (Parameter_List[0].Integer_Is_Valid && (Parameter_List[0].Integer_Value == 0 || Parameter_List[0].Integer_Value == 1))
+          tlm_enable(Parameter_List[0].Integer_Value);
+       else
+          return QCLI_STATUS_USAGE_E;
+    }
+
+    tlm_print_stats(qcli_sensors_group, reset);
+
+    return QCLI_STATUS_SUCCESS_E;
+}
+
+QCLI_Command_Status_t sensors_console(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+    PAL_Console_Stats_t stats;
+    qbool_t reset = false;
+
+    if (Parameter_Count >= 1)
+    {
+       if (!strcmp((char *)Parameter_List[0].String_Value, "drop"))
+          PAL_Console_Set_Policy(PAL_TX_POLICY_DROP_E);
+       else if (!strcmp((char *)Parameter_List[0].String_Value, "block"))
+          PAL_Console_Set_Policy(PAL_TX_POLICY_BLOCK_E);
+       else if (!strcmp((char *)Parameter_List[0].String_Value, "reset"))
+          reset = true;
+       else
+          return QCLI_STATUS_USAGE_E;
+    }
+
+    PAL_Console_Get_Stats(&stats, reset);
+
+    QCLI_Printf(qcli_sensors_group, "Console tx: %s on overflow, %u byte buffer, high-water %u\n",
+       (PAL_Console_Get_Policy() == PAL_TX_POLICY_BLOCK_E) ? "block" : "drop", stats.Buffer_Size, stats.High_Water);
+    QCLI_Printf(qcli_sensors_group, "%u bytes in %u transmits, %u writes blocked, %u writes (%u bytes) dropped\n",
+       stats.Bytes_Written, stats.Transmits, stats.Writes_Blocked, stats.Writes_Dropped, stats.Bytes_Dropped);
+
+    return QCLI_STATUS_SUCCESS_E;
+}
+
+QCLI_Command_Status_t sensors_latency(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+    if (Parameter_Count == 0)
+    {
+       lat_trace_print(qcli_sensors_group);
+    }
+    else if (!strcmp((char *)Parameter_List[0].String_Value, "reset"))
+    {
+       lat_trace_reset();
+    }
+    else if (!strcmp((char *)Parameter_List[0].String_Value, "dump"))
+    {
+       lat_trace_dump(qcli_sensors_group);
+    }
+    else if ((!strcmp((char *)Parameter_List[0].String_Value, "stream")) && (Parameter_Count == 2) &&
+             (Parameter_List[1].Integer_Is_Valid))
+    {
+       lat_trace_stream(qcli_sensors_group, Parameter_List[1].Integer_Value);
+    }
+    else
+       return QCLI_STATUS_USAGE_E;
+
+    return QCLI_STATUS_SUCCESS_E;
+}
+
+/* parses a tempo such as "128" or "128.5" into thousandths of a beat per minute */
+static int sensors_parse_bpm(const char *str, uint32_t *milli_bpm)
+{
+    uint32_t value = 0;
+    uint32_t scale = 1000;
+
+    if (!*str)
+       return -1;
+
+    for (; (*str >= '0') && (*str <= '9'); str++)
+    {
+       value = (value * 10) + (*str - '0');
+       if (value > 1000)
+          return -1;
+    }
+    value *= 1000;
+
+    if (*str == '.')
+    {
+       for (str++; (*str >= '0') && (*str <= '9') && (scale > 1); str++)
+       {
+          scale /= 10;
+          value += (*str - '0') * scale;
+       }
+    }
+
+    if (*str)
+       return -1;
+
+    *milli_bpm = value;
+
+    return 0;
+}
+
+QCLI_Command_Status_t sensors_tempo(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+    uint32_t milli_bpm;
+    int reset = 0;
+
+    fx_init();
+
+    if (Parameter_Count >= 1)
+    {
+       const char *cmd = (const char *)Parameter_List[0].String_Value;
+
+       if (!strcmp(cmd, "clear"))
+          fx_tempo_clear();
+       else if (!strcmp(cmd, "stop"))
+          fx_tempo_stop();
+       else if (!strcmp(cmd, "reset"))
+          reset = 1;
+       else if (!strcmp(cmd, "add") && (Parameter_Count == 3) && Parameter_List[1].Integer_Is_Valid &&
+                (Parameter_List[1].Integer_Value >= 0) &&
+                !sensors_parse_bpm((const char *)Parameter_List[2].String_Value, &milli_bpm))
+       {
+          if (fx_tempo_add((uint32_t)Parameter_List[1].Integer_Value, milli_bpm))
+          {
+             QCLI_Printf(qcli_sensors_group, "Segments must be in song order, at most %u, 20 to 400 bpm\n", FX_MAX_TEMPO_SEGMENTS);
+             return QCLI_STATUS_ERROR_E;
+          }
+       }
+       else if (!strcmp(cmd, "start") && (Parameter_Count == 2) && Parameter_List[1].Integer_Is_Valid &&
+                (Parameter_List[1].Integer_Value >= 0))
+       {
+          if (fx_tempo_start((uint32_t)Parameter_List[1].Integer_Value))
+          {
+             QCLI_Printf(qcli_sensors_group, "No tempo track loaded\n");
+             return QCLI_STATUS_ERROR_E;
+          }
+       }
+       else if (!strcmp(cmd, "quantum") && (Parameter_Count == 2) && Parameter_List[1].Integer_Is_Valid &&
+                (Parameter_List[1].Integer_Value > 0))
+          fx_set_quantum((uint32_t)Parameter_List[1].Integer_Value);
+       else if (!strcmp(cmd, "lead") && (Parameter_Count == 2) && !strcmp((char *)Parameter_List[1].String_Value, "auto"))
+          fx_set_lead(FX_LEAD_AUTO);
+       else if (!strcmp(cmd, "lead") && (Parameter_Count == 2) && Parameter_List[1].Integer_Is_Valid &&
+                (Parameter_List[1].Integer_Value >= 0) && (Parameter_List[1].Integer_Value <= FX_MAX_LEAD_MS))
+          fx_set_lead((uint32_t)Parameter_List[1].Integer_Value);
+       else
+          return QCLI_STATUS_USAGE_E;
+
+       //the gateway sends a track line by line, only a query or reset prints
+       if (!reset)
+          return QCLI_STATUS_SUCCESS_E;
+    }
+
+    fx_print(qcli_sensors_group, reset);
+
+    return QCLI_STATUS_SUCCESS_E;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2015-2018 Qualcomm Technologies, Inc.
+ * 2015-2016 Qualcomm Atheros, Inc.
+ * All Rights Reserved.
+ */
+
+#include <string.h>
+#include "stdint.h"
+#include <qcli.h>
+#include <qcli_api.h>
+#include <qurt_mutex.h>
+#include "telemetry.h"
+
+typedef struct tlm_stats_s
+{
+	uint32_t frames;
+	uint32_t bytes;
+} tlm_stats_t;
+
+static const char *tlm_type_names[TLM_NUM_TYPES] = {NULL, "motion", "effect", "bulb"};
+
+static qurt_mutex_t tlm_lock;
+static int tlm_lock_created;
+static int tlm_on = 1;
+static tlm_stats_t tlm_stats[TLM_NUM_TYPES];
+
+static void tlm_put16(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+}
+
+static void tlm_put32(uint8_t *p, uint32_t v)
+{
+	tlm_put16(p, v);
+	tlm_put16(p + 2, v >> 16);
+}
+
+/*
+ * QCLI adds the header and CRC and keeps the frames in sequence order,
+ * the lock only covers the counters.
+ */
+static void tlm_send(uint8_t type, const uint8_t *payload, uint8_t length)
+{
+	uint32_t size;
+
+	if (!tlm_on || !tlm_lock_created)
+		return;
+
+	size = QCLI_Write_Frame(type, length, payload);
+
+	qurt_mutex_lock(&tlm_lock);
+	if (size)
+		tlm_stats[type].frames++;
+	tlm_stats[type].bytes += size;
+	qurt_mutex_unlock(&tlm_lock);
+}
+
+void tlm_init(void)
+{
+	if (tlm_lock_created)
+		return;
+
+	qurt_mutex_create(&tlm_lock);
+	tlm_lock_created = 1;
+}
+
+void tlm_enable(int enable)
+{
+	tlm_on = enable ? 1 : 0;
+}
+
+int tlm_enabled(void)
+{
+	return (tlm_on && tlm_lock_created);
+}
+
+void tlm_motion(uint32_t edge, uint32_t intensity_epm, uint32_t level, uint32_t window_edges)
+{
+	uint8_t payload[TLM_MOTION_SIZE];
+
+	tlm_put32(&payload[0], edge);
+	tlm_put16(&payload[4], (intensity_epm > 0xFFFF) ? 0xFFFF : intensity_epm);
+	payload[6] = (uint8_t)level;
+	payload[7] = (window_edges > 0xFF) ? 0xFF : (uint8_t)window_edges;
+
+	tlm_send(TLM_TYPE_MOTION, payload, sizeof(payload));
+}
+
+void tlm_effect(uint64_t value, uint32_t bulbs_ready, uint32_t bulbs_confirmed, uint32_t spread_ms)
+{
+	uint8_t payload[TLM_EFFECT_SIZE];
+
+	tlm_put32(&payload[0], (uint32_t)value);
+	tlm_put32(&payload[4], (uint32_t)(value >> 32));
+	payload[8] = (uint8_t)bulbs_ready;
+	payload[9] = (uint8_t)bulbs_confirmed;
+	tlm_put16(&payload[10], (spread_ms > 0xFFFF) ? 0xFFFF : spread_ms);
+
+	tlm_send(TLM_TYPE_EFFECT, payload, sizeof(payload));
+}
+
+void tlm_bulb(uint32_t index, uint32_t state, const void *bd_addr, int confirmed, uint32_t latency_ms)
+{
+	uint8_t payload[TLM_BULB_SIZE];
+
+	payload[0] = (uint8_t)index;
+	payload[1] = (uint8_t)state;
+	memcpy(&payload[2], bd_addr, 6);
+	payload[8] = confirmed ? 1 : 0;
+	payload[9] = 0;
+	tlm_put16(&payload[10], (latency_ms > 0xFFFF) ? 0xFFFF : latency_ms);
+
+	tlm_send(TLM_TYPE_BULB, payload, sizeof(payload));
+}
+
+void tlm_print_stats(QCLI_Group_Handle_t group, int reset)
+{
+	int i;
+
+	QCLI_Printf(group, "Telemetry %s\n", tlm_on ? "on" : "off");
+	QCLI_Printf(group, "%-8s %8s %8s\n", "frame", "sent", "bytes");
+
+	for (i = 0; i < TLM_NUM_TYPES; i++)
+	{
+		if (tlm_type_names[i])
+			QCLI_Printf(group, "%-8s %8u %8u\n", tlm_type_names[i], tlm_stats[i].frames, tlm_stats[i].bytes);
+	}
+
+	if (reset && tlm_lock_created)
+	{
+		qurt_mutex_lock(&tlm_lock);
+		memset(tlm_stats, 0, sizeof(tlm_stats));
+		qurt_mutex_unlock(&tlm_lock);
+	}
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2015-2018 Qualcomm Technologies, Inc.
+ * 2015-2016 Qualcomm Atheros, Inc.
+ * All Rights Reserved.
+ */
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef __TELEMETRY_H__
+#define __TELEMETRY_H__
+
+#include <stdint.h>
+#include "qcli_api.h"
+
+/*
+ * Binary telemetry frames sent on the console UART between the QCLI
+ * text, framed by QCLI_Write_Frame() (see qcli_api.h). All payload
+ * fields are little endian. The gateway decoder
+ * (QCA_Music_AWS_IOT_Client/telemetry on the DragonBoard) must be kept
+ * in step with this file.
+ */
+#define TLM_TYPE_MOTION			(1)	/* one PIR edge */
+#define TLM_TYPE_EFFECT			(2)	/* effect changed or reached every bulb */
+#define TLM_TYPE_BULB			(3)	/* bulb changed state */
+#define TLM_NUM_TYPES			(4)
+
+/* motion: edge[4] intensity_epm[2] level[1] window_edges[1] */
+#define TLM_MOTION_SIZE			(8)
+/* effect: value[8] bulbs_ready[1] bulbs_confirmed[1] spread_ms[2] */
+#define TLM_EFFECT_SIZE			(12)
+/* bulb: index[1] state[1] bd_addr[6] confirmed[1] reserved[1] latency_ms[2] */
+#define TLM_BULB_SIZE			(12)
+
+#define TLM_LEVEL_NONE			(0xFF)
+
+/**
+   @brief Sets up the counter lock, safe to call more than once.
+*/
+void tlm_init(void);
+
+/**
+   @brief Turns the frames on or off. Frames are on by default.
+*/
+void tlm_enable(int enable);
+
+/**
+   @brief Returns non-zero if frames are being sent.
+*/
+int tlm_enabled(void);
+
+/**
+   @brief Sends a motion frame for a PIR edge. level is TLM_LEVEL_NONE
+          until the estimator has picked one.
+*/
+void tlm_motion(uint32_t edge, uint32_t intensity_epm, uint32_t level, uint32_t window_edges);
+
+/**
+   @brief Sends an effect frame. spread_ms is 0 while the effect is still
+          being written.
+*/
+void tlm_effect(uint64_t value, uint32_t bulbs_ready, uint32_t bulbs_confirmed, uint32_t spread_ms);
+
+/**
+   @brief Sends a bulb status frame. bd_addr points to the 6 byte address.
+*/
+void tlm_bulb(uint32_t index, uint32_t state, const void *bd_addr, int confirmed, uint32_t latency_ms);
+
+/**
+   @brief Prints the frame and byte counters, and clears them if requested.
+*/
+void tlm_print_stats(QCLI_Group_Handle_t group, int reset);
+
+#endif
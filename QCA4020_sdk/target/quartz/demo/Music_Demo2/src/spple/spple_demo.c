@@ -31,6 +31,8 @@
 #include "spple_demo.h"    /* Main Application Prototypes and Constants.*/
 #include "qcli_util.h"
 #include "ble_ota_service.h" /* OTA service API.                        */
+#include "lat_trace.h"     /* PIR to light latency trace.               */
+#include "telemetry.h"     /* Binary telemetry frames for the gateway.  */
 #include "qapi_fs.h"
    /* Demo Constants.                                                   */
 #define QC_MSC_FESTIVAL 1
@@ -6753,188 +6755,828 @@ static int SetPairable(void)
 #ifdef QC_MSC_FESTIVAL
 
 #define MSCD_DEVICE_SIGNATURE "PIR-20-MSCD"
-#define MSCD_NUM_BULBS 5
+#define MSCD_MAX_NUM_BULBS                (64)   /* Largest registry.    */
 #define AD_TYPE_LOCAL_NAME 0x09
-static int mscd_selected_device;
+
+   /* MSCD connection manager constants.  All tick counts are in units  */
+   /* of the mscd_thread periodic timer (MSCD_TICK_MS in sensors.c).    */
+#define MSCD_MAX_CONNECTS_IN_FLIGHT       (4)    /* Bulbs placed in the  */
+                                                 /* white list for a     */
+                                                 /* single connection    */
+                                                 /* round.               */
+#define MSCD_MAX_DISCOVERIES_IN_FLIGHT    (3)    /* Concurrent GATT      */
+                                                 /* service discoveries. */
+#define MSCD_CONNECT_TIMEOUT_TICKS        (6)    /* Connection round     */
+                                                 /* timeout.             */
+#define MSCD_MTU_WAIT_TICKS               (2)    /* Time to wait for the */
+                                                 /* MTU exchange before  */
+                                                 /* starting discovery.  */
+#define MSCD_DISCOVERY_TIMEOUT_TICKS      (10)   /* Service discovery    */
+                                                 /* timeout.             */
+#define MSCD_BACKOFF_BASE_TICKS           (2)    /* First retry delay.   */
+#define MSCD_BACKOFF_MAX_SHIFT            (4)    /* Largest backoff is   */
+                                                 /* BASE << MAX_SHIFT.   */
+#define MSCD_MAX_RETRIES                  (6)    /* Failed attempts      */
+                                                 /* before the bulb is   */
+                                                 /* forgotten and has to */
+                                                 /* be scanned again.    */
+
+   /* MSCD effect write fan-out constants.                              */
+#define MSCD_EFFECT_LENGTH                (8)    /* Size of an effect.   */
+#define MSCD_MAX_WRITES_IN_FLIGHT         (8)    /* Unacknowledged writes*/
+                                                 /* across all bulbs,    */
+                                                 /* there is at most one */
+                                                 /* per connection.      */
+#define MSCD_WRITE_TIMEOUT_TICKS          (10)   /* Write response       */
+                                                 /* timeout, the bulb is */
+                                                 /* reconnected after it.*/
+
 static int mscd_start_ble_scan(uint32_t BluetoothStackID, qapi_BLE_GAP_LE_Filter_Policy_t FilterPolicy, unsigned int ScanDuration);
 int mscd_num_bulbs_found = 0;
-//int MSCD_NUM_BULBS = 5;
 #define QAPI_BLE_MSCD_COMPARE_CHAR_UUID_TO_UUID_16(_x)  QAPI_BLE_COMPARE_BLUETOOTH_UUID_16_TO_CONSTANT((_x), 0xFF, 0xFB)
 
 typedef struct mscd_device_chars
 {
    uint8_t                 Properties;
    uint16_t                Characteristic_Handle;
+   int                     device_index;
 }MSCD_DEVICE_CHARS;
 
-typedef struct mscd_dev_Instance_Info_t
+   /* The following structure is handed to mscd_thread for every bulb   */
+   /* found during a scan.                                              */
+typedef struct mscd_scan_entry_t
+{
+   qapi_BLE_BD_ADDR_t                BD_ADDR;
+   qapi_BLE_GAP_LE_Address_Type_t    Address_Type;
+} MSCD_Scan_Entry_t;
+
+   /* The following structure is handed to mscd_thread when a GATT      */
+   /* connection has been established.                                  */
+typedef struct mscd_connection_info_t
+{
+   qapi_BLE_BD_ADDR_t                RemoteAddress;
+   unsigned int                      ConnectionID;
+} MSCD_Connection_Info_t;
+
+   /* The following structure is handed to mscd_thread when a bulb has */
+   /* answered an effect write.                                         */
+typedef struct mscd_write_result_t
+{
+   int                               deviceIndex;
+   uint32_t                          TransactionID;
+   int                               Success;
+} MSCD_Write_Result_t;
+
+   /* The following structure holds the effect write counters of a bulb.*/
+   /* Latencies are from issuing the write to the write response.       */
+typedef struct mscd_write_stats_t
+{
+   uint32_t                          Writes;
+   uint32_t                          Confirmed;
+   uint32_t                          Drops;
+   uint32_t                          LastLatencyMs;
+   uint32_t                          MaxLatencyMs;
+   uint32_t                          TotalLatencyMs;
+} MSCD_Write_Stats_t;
+
+   /* The following enumerates the states of a bulb in the connection   */
+   /* manager.  A bulb moves SCANNED -> CONNECTING -> DISCOVERING ->    */
+   /* READY.  Any failure on the way parks the bulb in BACKOFF, after   */
+   /* which it becomes SCANNED again and is retried.                    */
+typedef enum
 {
-   qapi_BLE_GAP_LE_Advertising_Report_Data_t * scan_data;
-   DeviceInfo_t *connection_info;
-   MSCD_DEVICE_CHARS *dev_chars;
-   int valid;
-
-}MSCD_Device;
+   MSCD_DEVICE_STATE_SCANNED,
+   MSCD_DEVICE_STATE_CONNECTING,
+   MSCD_DEVICE_STATE_DISCOVERING,
+   MSCD_DEVICE_STATE_READY,
+   MSCD_DEVICE_STATE_BACKOFF
+} MSCD_Device_State_t;
 
-typedef struct mscd_temp_dev_Instance_Info_t
+   /* The following structure holds a bulb in the device registry.  The */
+   /* connection ID is zero while the bulb is not connected and the     */
+   /* write handle is zero until service discovery has found it.        */
+typedef struct mscd_dev_Instance_Info_t
 {
-   qapi_BLE_GAP_LE_Advertising_Report_Data_t scan_data;
+   qapi_BLE_BD_ADDR_t              bd_addr;
+   qapi_BLE_GAP_LE_Address_Type_t  address_type;
+   unsigned int                    connection_id;
+   MSCD_DEVICE_CHARS               dev_chars;
    int valid;
+   MSCD_Device_State_t state;
+   unsigned int state_ticks;
+   unsigned int backoff_ticks;
+   unsigned int retries;
+   int mtu_exchanged;
+   int discovery_started;
+
+   /* Effect write state.  The bulb is up to date when the last value  */
+   /* it confirmed is the current effect.                              */
+   int                confirmed;
+   uint64_t           confirmed_value;
+   uint64_t           write_value;
+   uint32_t           write_transaction;
+   qurt_time_t        write_start;
+   unsigned int       write_ticks;
+   MSCD_Write_Stats_t write_stats;
 
-}MSCD_Temp_Device;
-
-
-MSCD_Device mscd_devices[MSCD_NUM_BULBS];
+}MSCD_Device;
 
-MSCD_Temp_Device mscd_temp_devices[MSCD_NUM_BULBS];
+   /* The following structure is an open addressing (linear probing)    */
+   /* hash index of registry entries.  Slots hold an entry index, or -1 */
+   /* when empty, and the table is kept at most half full.              */
+typedef struct mscd_index_t
+{
+   int16_t      *slots;
+   unsigned int  mask;
+} MSCD_Index_t;
+
+typedef unsigned int (*MSCD_Index_Hash_t)(int Entry);
+typedef int (*MSCD_Index_Match_t)(int Entry, const void *Key);
+
+   /* The device registry.  All entries are allocated from a pool sized */
+   /* by mscd_registry_init(), and bulbs are looked up by address or by */
+   /* GATT connection ID in constant time.                              */
+static unsigned int  mscd_num_bulbs;
+static MSCD_Device  *mscd_devices;
+static int16_t      *mscd_free_list;
+static unsigned int  mscd_free_count;
+static MSCD_Index_t  mscd_addr_index;
+static MSCD_Index_t  mscd_conn_index;
+
+   /* Addresses of the bulbs reported by the scan in progress, used to  */
+   /* report every bulb only once per scan.  Only accessed from the     */
+   /* Bluetooth stack thread.                                           */
+static qapi_BLE_BD_ADDR_t *mscd_seen_addrs;
+static MSCD_Index_t        mscd_seen_index;
+
+   /* State of the white list based connection round.  Only one LE      */
+   /* Create Connection may be outstanding in the controller, so all    */
+   /* candidate bulbs are placed in the white list and the controller   */
+   /* connects to whichever of them it hears first.                     */
+static int mscd_connect_pending;
+static int mscd_connect_cancelled;
+static unsigned int mscd_connect_ticks;
+static unsigned int mscd_white_list_count;
+static qapi_BLE_GAP_LE_White_List_Entry_t mscd_white_list[MSCD_MAX_CONNECTS_IN_FLIGHT];
+
+   /* State of the effect write fan-out.  The spread is the time from  */
+   /* the first write of an effect to the last bulb confirming it.     */
+static unsigned int mscd_writes_in_flight;
+static uint64_t     mscd_fanout_value;
+static qurt_time_t  mscd_fanout_start;
+static uint32_t     mscd_fanout_spread_ms;
+static uint32_t     mscd_fanout_trace;
 
 extern void mscd_scan_result_callback();
-extern void mscd_connection_result_callback();
-extern void mscd_service_discovery_callback();   
 extern void mscd_scan_stopped_callback();
 extern char* mot_rate_func();
-extern void mscd_scan_result(void *scan_data);
-extern void mscd_connection_result(void *conn_data);
+extern void mscd_scan_result(const void *scan_data, uint32_t length);
+extern void mscd_connection_result(const void *conn_data, uint32_t length);
+extern void mscd_mtu_exchange_result(const void *mtu_data, uint32_t length);
+extern void mscd_connection_failed_result(const void *conn_data, uint32_t length);
 void mscd_add_scan_entry(void *);
 int mscd_assign_connection_info(void * data);
 void mscd_attach_handles(void * data);
 int mscd_reset_device_data(int devIndex);
-extern void mscd_service_discovery_result(void *service_data);
+extern void mscd_service_discovery_result(const void *service_data, uint32_t length);
+extern void mscd_service_discovery_complete(int deviceIndex);
+extern void mscd_write_result(const void *write_data, uint32_t length);
+void mscd_fanout_run();
 
 static void QAPI_BLE_BTPSAPI GATT_MSCD_Service_Discovery_Event_Callback(uint32_t BluetoothStackID, qapi_BLE_GATT_Service_Discovery_Event_Data_t *GATT_Service_Discovery_Event_Data, uint32_t CallbackParameter);
-static void mscd_populate_handles(AIOP_Client_Information_t *ClientInfo, 
-   qapi_BLE_GATT_Service_Discovery_Indication_Data_t *ServiceDiscoveryData);
-int mscd_add_device(qapi_BLE_GAP_LE_Advertising_Report_Data_t *dev_ptr);
+static void mscd_populate_handles(qapi_BLE_GATT_Service_Discovery_Indication_Data_t *ServiceDiscoveryData, int deviceIndex);
 static QCLI_Command_Status_t DiscoverMSCDServices(int deviceIndex);
 int mscd_match_device(qapi_BLE_BD_ADDR_t Board_Address);
-DeviceInfo_t *MSCDGetDeviceInfo(int deviceIndex);
-extern void mscd_disconnection_result(void *disconn_data);
+extern void mscd_disconnection_result(const void *disconn_data, uint32_t length);
+static void mscd_device_lost(int deviceIndex);
+static const char *mscd_state_name(MSCD_Device_State_t state);
 
 QCLI_Command_Status_t mscd_InitializeBluetooth()
 {
    return InitializeBluetooth();
 }
 
-int mscd_select_device_for_connection()
+static unsigned int mscd_hash_bd_addr(qapi_BLE_BD_ADDR_t BD_ADDR)
 {
-   int deviceIndex = 0;
+   uint32_t Hash = 2166136261UL;
+
+   Hash = (Hash ^ BD_ADDR.BD_ADDR0) * 16777619UL;
+   Hash = (Hash ^ BD_ADDR.BD_ADDR1) * 16777619UL;
+   Hash = (Hash ^ BD_ADDR.BD_ADDR2) * 16777619UL;
+   Hash = (Hash ^ BD_ADDR.BD_ADDR3) * 16777619UL;
+   Hash = (Hash ^ BD_ADDR.BD_ADDR4) * 16777619UL;
+   Hash = (Hash ^ BD_ADDR.BD_ADDR5) * 16777619UL;
+
+   return(Hash);
+}
+
+static unsigned int mscd_hash_connection_id(unsigned int ConnectionID)
+{
+   return(ConnectionID * 2654435761UL);
+}
+
+static int mscd_index_create(MSCD_Index_t *Index, unsigned int Entries)
+{
+   unsigned int Size = 4;
+
+   while(Size < (Entries * 2))
+      Size <<= 1;
+
+   if((Index->slots = malloc(Size * sizeof(int16_t))) == NULL)
+      return -1;
+
+   Index->mask = Size - 1;
+   memset(Index->slots, 0xFF, Size * sizeof(int16_t));
+
+   return 0;
+}
+
+static void mscd_index_destroy(MSCD_Index_t *Index)
+{
+   if(Index->slots)
+      free(Index->slots);
 
-   for(deviceIndex = 0; deviceIndex < MSCD_NUM_BULBS; deviceIndex++)
+   Index->slots = NULL;
+   Index->mask  = 0;
+}
+
+static void mscd_index_clear(MSCD_Index_t *Index)
+{
+   memset(Index->slots, 0xFF, (Index->mask + 1) * sizeof(int16_t));
+}
+
+static int mscd_index_find(MSCD_Index_t *Index, unsigned int Hash, MSCD_Index_Match_t Match, const void *Key)
+{
+   unsigned int Slot = Hash & Index->mask;
+
+   while(Index->slots[Slot] >= 0)
    {
-      if(mscd_devices[deviceIndex].valid &&
-       (!MSCDGetDeviceInfo(deviceIndex)))
-         return deviceIndex;
+      if((*Match)(Index->slots[Slot], Key))
+         return Index->slots[Slot];
+
+      Slot = (Slot + 1) & Index->mask;
    }
 
    return -1;
 }
 
+static void mscd_index_insert(MSCD_Index_t *Index, unsigned int Hash, int Entry)
+{
+   unsigned int Slot = Hash & Index->mask;
+
+   while(Index->slots[Slot] >= 0)
+      Slot = (Slot + 1) & Index->mask;
+
+   Index->slots[Slot] = (int16_t)Entry;
+}
 
-DeviceInfo_t *MSCDGetDeviceInfo(int deviceIndex)
+   /* The following function removes an entry from an index.  Entries  */
+   /* that follow it in the same probe run are shifted back into the   */
+   /* hole, so no tombstones are needed.                               */
+static void mscd_index_remove(MSCD_Index_t *Index, unsigned int Hash, int Entry, MSCD_Index_Hash_t HashOf)
 {
-   if(mscd_devices[deviceIndex].connection_info && 
-         mscd_devices[deviceIndex].connection_info->ConnectionID) {
-      //QCLI_Printf(ble_group, "Found Device Info\n");
-      return mscd_devices[deviceIndex].connection_info;
+   unsigned int Hole = Hash & Index->mask;
+   unsigned int Next;
+   unsigned int Home;
+
+   while((Index->slots[Hole] >= 0) && (Index->slots[Hole] != Entry))
+      Hole = (Hole + 1) & Index->mask;
+
+   if(Index->slots[Hole] < 0)
+      return;
+
+   for(Next = (Hole + 1) & Index->mask; Index->slots[Next] >= 0; Next = (Next + 1) & Index->mask)
+   {
+      Home = (*HashOf)(Index->slots[Next]) & Index->mask;
+
+      /* The entry may only move back if the hole lies between its home */
+      /* slot and its current slot.                                     */
+      if(((Next - Home) & Index->mask) >= ((Next - Hole) & Index->mask))
+      {
+         Index->slots[Hole] = Index->slots[Next];
+         Hole               = Next;
+      }
    }
 
-   return 0;
+   Index->slots[Hole] = -1;
 }
 
-uint16_t mscd_get_write_char_handle(int deviceIndex)
+static int mscd_match_addr_entry(int Entry, const void *Key)
 {
-   if(mscd_devices[deviceIndex].dev_chars[0].Characteristic_Handle){
-      //QCLI_Printf(ble_group, "Found Write Characteristic handler Info\n");
-      return mscd_devices[deviceIndex].dev_chars[0].Characteristic_Handle;
+   return(QAPI_BLE_COMPARE_BD_ADDR(mscd_devices[Entry].bd_addr, *((qapi_BLE_BD_ADDR_t *)Key)));
+}
+
+static unsigned int mscd_hash_addr_entry(int Entry)
+{
+   return(mscd_hash_bd_addr(mscd_devices[Entry].bd_addr));
+}
+
+static int mscd_match_conn_entry(int Entry, const void *Key)
+{
+   return(mscd_devices[Entry].connection_id == *((unsigned int *)Key));
+}
+
+static unsigned int mscd_hash_conn_entry(int Entry)
+{
+   return(mscd_hash_connection_id(mscd_devices[Entry].connection_id));
+}
+
+static int mscd_match_seen_entry(int Entry, const void *Key)
+{
+   return(QAPI_BLE_COMPARE_BD_ADDR(mscd_seen_addrs[Entry], *((qapi_BLE_BD_ADDR_t *)Key)));
+}
+
+static void mscd_registry_cleanup(void)
+{
+   if(mscd_devices)
+      free(mscd_devices);
+   if(mscd_free_list)
+      free(mscd_free_list);
+   if(mscd_seen_addrs)
+      free(mscd_seen_addrs);
+
+   mscd_devices    = NULL;
+   mscd_free_list  = NULL;
+   mscd_seen_addrs = NULL;
+   mscd_num_bulbs  = 0;
+   mscd_free_count = 0;
+
+   mscd_index_destroy(&mscd_addr_index);
+   mscd_index_destroy(&mscd_conn_index);
+   mscd_index_destroy(&mscd_seen_index);
+}
+
+   /* The following function sizes the bulb registry.  It must be called*/
+   /* before mscd_thread is started and drops every bulb known so far.  */
+   /* The function returns zero on success and a negative value if the */
+   /* size is out of range or memory could not be allocated.            */
+int mscd_registry_init(unsigned int NumBulbs)
+{
+   unsigned int Index;
+
+   if((NumBulbs == 0) || (NumBulbs > MSCD_MAX_NUM_BULBS))
+      return -1;
+
+   mscd_registry_cleanup();
+
+   mscd_devices    = malloc(NumBulbs * sizeof(MSCD_Device));
+   mscd_free_list  = malloc(NumBulbs * sizeof(int16_t));
+   mscd_seen_addrs = malloc(NumBulbs * sizeof(qapi_BLE_BD_ADDR_t));
+
+   if((!mscd_devices) || (!mscd_free_list) || (!mscd_seen_addrs) ||
+      (mscd_index_create(&mscd_addr_index, NumBulbs)) ||
+      (mscd_index_create(&mscd_conn_index, NumBulbs)) ||
+      (mscd_index_create(&mscd_seen_index, NumBulbs)))
+   {
+      mscd_registry_cleanup();
+      return -1;
    }
+
+   memset(mscd_devices, 0, NumBulbs * sizeof(MSCD_Device));
+
+   /* Entries are handed out lowest index first.                       */
+   for(Index = 0; Index < NumBulbs; Index++)
+      mscd_free_list[Index] = (int16_t)(NumBulbs - 1 - Index);
+
+   mscd_num_bulbs        = NumBulbs;
+   mscd_free_count       = NumBulbs;
+   mscd_num_bulbs_found  = 0;
+   mscd_connect_pending  = 0;
+   mscd_white_list_count = 0;
+   mscd_writes_in_flight = 0;
+   mscd_fanout_spread_ms = 0;
+
+   QCLI_Printf(ble_group, "Msc registry sized for %u bulbs\n", NumBulbs);
+
    return 0;
 }
 
-void mscd_write_motion_data()
+static int mscd_registry_alloc(qapi_BLE_BD_ADDR_t BD_ADDR, qapi_BLE_GAP_LE_Address_Type_t Address_Type)
 {
-   uint16_t char_handle;
-   int attr_len;
-   int Result;
    int deviceIndex;
-   char* val;
-   DeviceInfo_t *DeviceInfo;
 
-   val = mot_rate_func();
-   attr_len = 8;
-   //QCLI_Printf(ble_group, "Value = %s\n", val);
-   for(deviceIndex = 0; deviceIndex < MSCD_NUM_BULBS; deviceIndex++)
+   if(!mscd_free_count)
+      return -1;
+
+   deviceIndex = mscd_free_list[--mscd_free_count];
+
+   memset(&(mscd_devices[deviceIndex]), 0, sizeof(MSCD_Device));
+   mscd_devices[deviceIndex].bd_addr      = BD_ADDR;
+   mscd_devices[deviceIndex].address_type = Address_Type;
+   mscd_devices[deviceIndex].state        = MSCD_DEVICE_STATE_SCANNED;
+   mscd_devices[deviceIndex].valid        = 1;
+
+   mscd_index_insert(&mscd_addr_index, mscd_hash_bd_addr(BD_ADDR), deviceIndex);
+
+   return deviceIndex;
+}
+
+   /* The following function records the GATT connection ID of a bulb, */
+   /* zero meaning that the bulb is not connected.                     */
+static void mscd_set_connection_id(int deviceIndex, unsigned int ConnectionID)
+{
+   if(mscd_devices[deviceIndex].connection_id)
+      mscd_index_remove(&mscd_conn_index, mscd_hash_connection_id(mscd_devices[deviceIndex].connection_id), deviceIndex, mscd_hash_conn_entry);
+
+   mscd_devices[deviceIndex].connection_id = ConnectionID;
+
+   if(ConnectionID)
+      mscd_index_insert(&mscd_conn_index, mscd_hash_connection_id(ConnectionID), deviceIndex);
+}
+
+int mscd_match_device(qapi_BLE_BD_ADDR_t Board_Address)
+{
+   if(!mscd_devices)
+      return -1;
+
+   return mscd_index_find(&mscd_addr_index, mscd_hash_bd_addr(Board_Address), mscd_match_addr_entry, &Board_Address);
+}
+
+int mscd_match_connection(unsigned int ConnectionID)
+{
+   if((!mscd_devices) || (!ConnectionID))
+      return -1;
+
+   return mscd_index_find(&mscd_conn_index, mscd_hash_connection_id(ConnectionID), mscd_match_conn_entry, &ConnectionID);
+}
+
+uint16_t mscd_get_write_char_handle(int deviceIndex)
+{
+   return mscd_devices[deviceIndex].dev_chars.Characteristic_Handle;
+}
+
+   /* The following function is called from the Bluetooth stack with   */
+   /* the response to an effect write.  The callback parameter carries */
+   /* the bulb index.                                                   */
+static void QAPI_BLE_BTPSAPI GATT_MSCD_Write_Event_Callback(uint32_t BluetoothStackID, qapi_BLE_GATT_Client_Event_Data_t *GATT_Client_Event_Data, uint32_t CallbackParameter)
+{
+   MSCD_Write_Result_t  WriteResult;
+
+   if((!BluetoothStackID) || (!GATT_Client_Event_Data) || (CallbackParameter >= mscd_num_bulbs))
+      return;
+
+   WriteResult.deviceIndex = (int)CallbackParameter;
+
+   if((GATT_Client_Event_Data->Event_Data_Type == QAPI_BLE_ET_GATT_CLIENT_WRITE_RESPONSE_E) &&
+      (GATT_Client_Event_Data->Event_Data.GATT_Write_Response_Data))
+   {
+      WriteResult.TransactionID = GATT_Client_Event_Data->Event_Data.GATT_Write_Response_Data->TransactionID;
+      WriteResult.Success       = 1;
+   }
+   else if((GATT_Client_Event_Data->Event_Data_Type == QAPI_BLE_ET_GATT_CLIENT_ERROR_RESPONSE_E) &&
+      (GATT_Client_Event_Data->Event_Data.GATT_Request_Error_Data))
    {
-      if((DeviceInfo = MSCDGetDeviceInfo(deviceIndex)))
+      WriteResult.TransactionID = GATT_Client_Event_Data->Event_Data.GATT_Request_Error_Data->TransactionID;
+      WriteResult.Success       = 0;
+   }
+   else
+      return;
+
+   mscd_write_result(&WriteResult, sizeof(WriteResult));
+}
+
+   /* The following function records that a bulb has taken the value  */
+   /* written to it.  Once every ready bulb shows the current effect    */
+   /* the fan-out spread is recorded.                                   */
+static void mscd_write_confirmed(int deviceIndex)
+{
+   MSCD_Device  *Device = &(mscd_devices[deviceIndex]);
+   qurt_time_t   Now    = qurt_timer_get_ticks();
+   uint32_t      LatencyMs;
+   unsigned int  Index;
+   unsigned int  Ready;
+
+   LatencyMs = (uint32_t)qurt_timer_convert_ticks_to_time(Now - Device->write_start, QURT_TIME_MSEC);
+
+   Device->confirmed                    = 1;
+   Device->confirmed_value              = Device->write_value;
+   Device->write_stats.Confirmed++;
+   Device->write_stats.LastLatencyMs    = LatencyMs;
+   Device->write_stats.TotalLatencyMs  += LatencyMs;
+   if(LatencyMs > Device->write_stats.MaxLatencyMs)
+      Device->write_stats.MaxLatencyMs = LatencyMs;
+
+   if(Device->confirmed_value != mscd_fanout_value)
+      return;
+
+   for(Index = 0, Ready = 0; Index < mscd_num_bulbs; Index++)
+   {
+      if((mscd_devices[Index].valid) && (mscd_devices[Index].state == MSCD_DEVICE_STATE_READY))
       {
-         char_handle = mscd_get_write_char_handle(deviceIndex);
-         if(char_handle)
-         {
-            if((Result = qapi_BLE_GATT_Write_Without_Response_Request(BluetoothStackID, 
-               DeviceInfo->ConnectionID, char_handle, attr_len, val)) > 0)
-            {
-               QCLI_Printf(ble_group, "mscd_write_motion_data write success = %u\n", Result);
-            }
-            else if (Result == QAPI_BLE_GATT_ERROR_INVALID_CONNECTION_ID)
-            {
-               BoardStr_t                   BoardStr;
-               BD_ADDRToStr(DeviceInfo->RemoteAddress, BoardStr);
-               QCLI_Printf(ble_group, "addr = %s\n", BoardStr);
-               DisplayFunctionError("qapi_BLE_GATT_Write_Request", Result);
-               mscd_reset_device_data(deviceIndex);
+         if((!mscd_devices[Index].confirmed) || (mscd_devices[Index].confirmed_value != mscd_fanout_value))
+            return;
 
-            }
-            else
-            {
-               DisplayFunctionError("qapi_BLE_GATT_Write_Request", Result);
-               QCLI_Printf(ble_group, "Conn_id = %d", DeviceInfo->ConnectionID);
-            }
-         }
+         Ready++;
+      }
+   }
+
+   mscd_fanout_spread_ms = (uint32_t)qurt_timer_convert_ticks_to_time(Now - mscd_fanout_start, QURT_TIME_MSEC);
+   lat_trace_stamp(mscd_fanout_trace, LAT_STAGE_CONFIRM);
+   tlm_effect(mscd_fanout_value, Ready, Ready, mscd_fanout_spread_ms);
+}
+
+   /* The following function issues the current effect to a bulb.  A   */
+   /* Write Request is used when the bulb supports it so that the value */
+   /* is confirmed by the bulb, otherwise the value is taken to be      */
+   /* confirmed once the stack has accepted the Write Command.  The     */
+   /* function returns a positive value on success.                     */
+static int mscd_issue_write(int deviceIndex)
+{
+   MSCD_Device *Device = &(mscd_devices[deviceIndex]);
+   int          Result;
+
+   Device->write_value = mscd_fanout_value;
+   Device->write_start = qurt_timer_get_ticks();
+   Device->write_ticks = 0;
+   Device->write_stats.Writes++;
+
+   if(Device->dev_chars.Properties & QAPI_BLE_GATT_CHARACTERISTIC_PROPERTIES_WRITE)
+   {
+      if((Result = qapi_BLE_GATT_Write_Request(BluetoothStackID, Device->connection_id, Device->dev_chars.Characteristic_Handle,
+         MSCD_EFFECT_LENGTH, &(Device->write_value), GATT_MSCD_Write_Event_Callback, (uint32_t)deviceIndex)) > 0)
+      {
+         Device->write_transaction = (uint32_t)Result;
+         mscd_writes_in_flight++;
+         lat_trace_stamp(mscd_fanout_trace, LAT_STAGE_ISSUE);
+         return Result;
+      }
+   }
+   else
+   {
+      if((Result = qapi_BLE_GATT_Write_Without_Response_Request(BluetoothStackID, Device->connection_id,
+         Device->dev_chars.Characteristic_Handle, MSCD_EFFECT_LENGTH, &(Device->write_value))) > 0)
+      {
+         lat_trace_stamp(mscd_fanout_trace, LAT_STAGE_ISSUE);
+         mscd_write_confirmed(deviceIndex);
+         return Result;
       }
+   }
+
+   Device->write_stats.Drops++;
 
+   if(Result == QAPI_BLE_GATT_ERROR_INVALID_CONNECTION_ID)
+   {
+      BoardStr_t                   BoardStr;
+      BD_ADDRToStr(Device->bd_addr, BoardStr);
+      QCLI_LOG(ble_group, "addr = %s\n", BoardStr);
+      DisplayFunctionError("qapi_BLE_GATT_Write_Request", Result);
+      mscd_set_connection_id(deviceIndex, 0);
+      mscd_device_lost(deviceIndex);
    }
+   else if((Result != QAPI_BLE_GATT_ERROR_INSUFFICIENT_RESOURCES) && (Result != QAPI_BLE_BTPS_ERROR_INSUFFICIENT_RESOURCES))
+   {
+      /* Running out of buffers is expected under load, the bulb is    */
+      /* simply retried on the next run.                               */
+      DisplayFunctionError("qapi_BLE_GATT_Write_Request", Result);
+   }
+
+   return Result;
 }
 
-char *GetLocalNameInAD(qapi_BLE_GAP_LE_Advertising_Data_t *ad_ptr)
+   /* The following function brings every ready bulb up to date with  */
+   /* the current effect.  Only bulbs that have not confirmed it are    */
+   /* written, each connection has at most one write outstanding and    */
+   /* no more than MSCD_MAX_WRITES_IN_FLIGHT are outstanding in total.  */
+   /* The remaining bulbs are written as responses come back, so the    */
+   /* writes are spread over the following connection events instead   */
+   /* of flooding the controller.                                       */
+void mscd_fanout_run()
 {
+   uint64_t     Value;
+   unsigned int deviceIndex;
+   unsigned int Ready;
 
+   memcpy(&Value, mot_rate_func(), MSCD_EFFECT_LENGTH);
+
+   if(Value != mscd_fanout_value)
+   {
+      mscd_fanout_value = Value;
+      mscd_fanout_start = qurt_timer_get_ticks();
+      mscd_fanout_trace = lat_trace_find(Value);
+
+      for(deviceIndex = 0, Ready = 0; deviceIndex < mscd_num_bulbs; deviceIndex++)
+      {
+         if((mscd_devices[deviceIndex].valid) && (mscd_devices[deviceIndex].state == MSCD_DEVICE_STATE_READY))
+            Ready++;
+      }
+
+      tlm_effect(Value, Ready, 0, 0);
+   }
+
+   for(deviceIndex = 0; (deviceIndex < mscd_num_bulbs) && (mscd_writes_in_flight < MSCD_MAX_WRITES_IN_FLIGHT); deviceIndex++)
+   {
+      if((mscd_devices[deviceIndex].valid) && (mscd_devices[deviceIndex].state == MSCD_DEVICE_STATE_READY) &&
+         (!mscd_devices[deviceIndex].write_transaction) &&
+         ((!mscd_devices[deviceIndex].confirmed) || (mscd_devices[deviceIndex].confirmed_value != Value)))
+      {
+         mscd_issue_write(deviceIndex);
+      }
+   }
+}
+
+void mscd_handle_write_result(void *data)
+{
+   MSCD_Write_Result_t *WriteResult = (MSCD_Write_Result_t *)data;
+   int                  deviceIndex = WriteResult->deviceIndex;
+
+   /* Ignore responses to writes that have already been given up on.   */
+   if((mscd_devices[deviceIndex].valid) && (mscd_devices[deviceIndex].write_transaction) &&
+      (mscd_devices[deviceIndex].write_transaction == WriteResult->TransactionID))
+   {
+      mscd_devices[deviceIndex].write_transaction = 0;
+      mscd_writes_in_flight--;
+
+      if(WriteResult->Success)
+         mscd_write_confirmed(deviceIndex);
+      else
+         mscd_devices[deviceIndex].write_stats.Drops++;
+   }
+
+   mscd_fanout_run();
+}
+
+   /* The following function displays the effect write counters of    */
+   /* every bulb, and clears them if requested.                         */
+void mscd_print_write_stats(QCLI_Group_Handle_t Group, int Reset)
+{
+   unsigned int  deviceIndex;
+   BoardStr_t    BoardStr;
+   uint32_t      AverageMs;
+
+   QCLI_Printf(Group, "Bulb  Address       State        Writes  Confirmed  Drops  Last(ms)  Avg(ms)  Max(ms)\n");
+
+   for(deviceIndex = 0; deviceIndex < mscd_num_bulbs; deviceIndex++)
+   {
+      if(!mscd_devices[deviceIndex].valid)
+         continue;
+
+      BD_ADDRToStr(mscd_devices[deviceIndex].bd_addr, BoardStr);
+
+      AverageMs = 0;
+      if(mscd_devices[deviceIndex].write_stats.Confirmed)
+         AverageMs = mscd_devices[deviceIndex].write_stats.TotalLatencyMs / mscd_devices[deviceIndex].write_stats.Confirmed;
+
+      QCLI_Printf(Group, "%-4u  %s  %-11s  %6u  %9u  %5u  %8u  %7u  %7u\n", deviceIndex, BoardStr,
+         mscd_state_name(mscd_devices[deviceIndex].state), mscd_devices[deviceIndex].write_stats.Writes,
+         mscd_devices[deviceIndex].write_stats.Confirmed, mscd_devices[deviceIndex].write_stats.Drops,
+         mscd_devices[deviceIndex].write_stats.LastLatencyMs, AverageMs, mscd_devices[deviceIndex].write_stats.MaxLatencyMs);
+
+      if(Reset)
+         memset(&(mscd_devices[deviceIndex].write_stats), 0, sizeof(MSCD_Write_Stats_t));
+   }
+
+   QCLI_Printf(Group, "Writes in flight: %u, last effect on all bulbs in %u ms\n", mscd_writes_in_flight, mscd_fanout_spread_ms);
+}
+
+   /* The following function returns the time the last effect took to  */
+   /* reach every ready bulb, the effect timeline writes that far ahead */
+   /* of a beat.                                                        */
+uint32_t mscd_get_fanout_spread_ms()
+{
+   return(mscd_fanout_spread_ms);
+}
+
+   /* The following function checks, without copying it, whether the   */
+   /* advertised local name is the MSCD bulb signature.                 */
+static int mscd_match_local_name(qapi_BLE_GAP_LE_Advertising_Data_t *ad_ptr)
+{
    int i;
-   char *str = 0;
 
    for(i = 0; i < ad_ptr->Number_Data_Entries; i++)
    {
-      if(ad_ptr->Data_Entries[i].AD_Type == AD_TYPE_LOCAL_NAME)
+      if((ad_ptr->Data_Entries[i].AD_Type == AD_TYPE_LOCAL_NAME) &&
+         (ad_ptr->Data_Entries[i].AD_Data_Length == (sizeof(MSCD_DEVICE_SIGNATURE) - 1)) &&
+         (!Memcmpi(ad_ptr->Data_Entries[i].AD_Data_Buffer, MSCD_DEVICE_SIGNATURE, sizeof(MSCD_DEVICE_SIGNATURE) - 1)))
       {
-         str = malloc(ad_ptr->Data_Entries[i].AD_Data_Length + 1);
-         strncpy(str, (char *)ad_ptr->Data_Entries[i].AD_Data_Buffer, 
-            ad_ptr->Data_Entries[i].AD_Data_Length);
-         str[ad_ptr->Data_Entries[i].AD_Data_Length] = 0;
-
+         return 1;
       }
    }
-   return str;
+
+   return 0;
+}
+
+static const char *mscd_state_name(MSCD_Device_State_t state)
+{
+   switch(state)
+   {
+      case MSCD_DEVICE_STATE_SCANNED:
+         return "scanned";
+      case MSCD_DEVICE_STATE_CONNECTING:
+         return "connecting";
+      case MSCD_DEVICE_STATE_DISCOVERING:
+         return "discovering";
+      case MSCD_DEVICE_STATE_READY:
+         return "ready";
+      case MSCD_DEVICE_STATE_BACKOFF:
+         return "backoff";
+      default:
+         return "unknown";
+   }
+}
+
+static void mscd_set_state(int deviceIndex, MSCD_Device_State_t state)
+{
+   if(mscd_devices[deviceIndex].state != state)
+   {
+      QCLI_LOG(ble_group, "Msc device %d %s -> %s\n", deviceIndex,
+         mscd_state_name(mscd_devices[deviceIndex].state), mscd_state_name(state));
+   }
+
+   mscd_devices[deviceIndex].state       = state;
+   mscd_devices[deviceIndex].state_ticks = 0;
+
+   tlm_bulb((uint32_t)deviceIndex, (uint32_t)state, &(mscd_devices[deviceIndex].bd_addr),
+      ((mscd_devices[deviceIndex].confirmed) && (mscd_devices[deviceIndex].confirmed_value == mscd_fanout_value)),
+      mscd_devices[deviceIndex].write_stats.LastLatencyMs);
+}
+
+   /* The following function drops the GATT state held for a bulb so    */
+   /* that it can be connected and discovered again.                    */
+static void mscd_release_connection(int deviceIndex)
+{
+   mscd_set_connection_id(deviceIndex, 0);
+
+   /* A write still outstanding will never be confirmed.               */
+   if(mscd_devices[deviceIndex].write_transaction)
+   {
+      mscd_devices[deviceIndex].write_transaction = 0;
+      mscd_devices[deviceIndex].write_stats.Drops++;
+      mscd_writes_in_flight--;
+   }
+
+   mscd_devices[deviceIndex].confirmed         = 0;
+
+   mscd_devices[deviceIndex].mtu_exchanged     = 0;
+   mscd_devices[deviceIndex].discovery_started = 0;
+
+   memset(&(mscd_devices[deviceIndex].dev_chars), 0, sizeof(MSCD_DEVICE_CHARS));
+}
+
+   /* The following function parks a bulb after a failed connection or */
+   /* discovery.  The retry delay doubles with every consecutive failure*/
+   /* and the bulb is forgotten after MSCD_MAX_RETRIES, so that a bulb  */
+   /* which has been removed from the stage frees its slot for a rescan.*/
+static void mscd_enter_backoff(int deviceIndex)
+{
+   unsigned int shift;
+
+   mscd_release_connection(deviceIndex);
+
+   if(++mscd_devices[deviceIndex].retries > MSCD_MAX_RETRIES)
+   {
+      QCLI_LOG(ble_group, "Msc device %d dropped after %u retries\n", deviceIndex, MSCD_MAX_RETRIES);
+      mscd_reset_device_data(deviceIndex);
+      return;
+   }
+
+   shift = mscd_devices[deviceIndex].retries - 1;
+   if(shift > MSCD_BACKOFF_MAX_SHIFT)
+      shift = MSCD_BACKOFF_MAX_SHIFT;
+
+   mscd_devices[deviceIndex].backoff_ticks = MSCD_BACKOFF_BASE_TICKS << shift;
+   mscd_set_state(deviceIndex, MSCD_DEVICE_STATE_BACKOFF);
 }
 
-int ResetMSCDSelectedDeviceData()
+   /* The following function is called when the link to a bulb that was*/
+   /* connected has gone.  A bulb that was serving effects is retried   */
+   /* straight away since it is most likely just power cycling.         */
+static void mscd_device_lost(int deviceIndex)
 {
-   mscd_reset_device_data(mscd_selected_device);   
+   if((mscd_devices[deviceIndex].state != MSCD_DEVICE_STATE_DISCOVERING) &&
+      (mscd_devices[deviceIndex].state != MSCD_DEVICE_STATE_READY))
+   {
+      mscd_release_connection(deviceIndex);
+      return;
+   }
+
+   /* Make sure the link is really down, a GATT error alone does not    */
+   /* disconnect the remote device.                                     */
+   if(mscd_devices[deviceIndex].connection_id)
+      qapi_BLE_GAP_LE_Disconnect(BluetoothStackID, mscd_devices[deviceIndex].bd_addr);
+
+   if(mscd_devices[deviceIndex].state == MSCD_DEVICE_STATE_READY)
+   {
+      mscd_release_connection(deviceIndex);
+      mscd_devices[deviceIndex].retries = 0;
+      mscd_set_state(deviceIndex, MSCD_DEVICE_STATE_SCANNED);
+   }
+   else
+      mscd_enter_backoff(deviceIndex);
 }
 
+   /* The following function returns a bulb to the registry pool.       */
 int mscd_reset_device_data(int deviceIndex)
 {
 
-   if(deviceIndex < 0 || deviceIndex >= MSCD_NUM_BULBS)
+   if(deviceIndex < 0 || (unsigned int)deviceIndex >= mscd_num_bulbs || !mscd_devices[deviceIndex].valid)
       return -1;
 
-   mscd_devices[deviceIndex].valid = 0;
-   mscd_devices[deviceIndex].connection_info = 0;
+   mscd_release_connection(deviceIndex);
 
-   if(mscd_devices[deviceIndex].scan_data)
-      free(mscd_devices[deviceIndex].scan_data);
-   mscd_devices[deviceIndex].scan_data = 0;
+   mscd_index_remove(&mscd_addr_index, mscd_hash_bd_addr(mscd_devices[deviceIndex].bd_addr), deviceIndex, mscd_hash_addr_entry);
 
-   if(mscd_devices[deviceIndex].dev_chars)
-      free(mscd_devices[deviceIndex].dev_chars);
-   mscd_devices[deviceIndex].dev_chars = 0;
+   mscd_devices[deviceIndex].valid = 0;
+   mscd_free_list[mscd_free_count++] = (int16_t)deviceIndex;
 
    return 0;
 }
@@ -6950,233 +7592,323 @@ int mscd_handle_disconnection(void *data)
       BoardStr_t                   BoardStr;
       BD_ADDRToStr(*r_adr, BoardStr);
 
-      QCLI_Printf(ble_group, "mscd_handle_disconnection success = %s\n", BoardStr);
-      mscd_devices[deviceIndex].valid = 0;
-      mscd_devices[deviceIndex].connection_info = 0;
-
-      if(mscd_devices[deviceIndex].scan_data)
-         free(mscd_devices[deviceIndex].scan_data);
-      mscd_devices[deviceIndex].scan_data = 0;
-
-      if(mscd_devices[deviceIndex].dev_chars)
-         free(mscd_devices[deviceIndex].dev_chars);
-      mscd_devices[deviceIndex].dev_chars = 0;
-
-      if(deviceIndex == mscd_selected_device)
-         found = 1;
+      QCLI_LOG(ble_group, "mscd_handle_disconnection success = %s\n", BoardStr);
+      mscd_device_lost(deviceIndex);
+      found = 1;
    }
    else{
-      QCLI_Printf(ble_group, "mscd_handle_disconnection Failed \n");
+      QCLI_LOG(ble_group, "mscd_handle_disconnection Failed \n");
    }
 
-   free(data);
-
 
    return found;
 
 }
 
-int mscd_add_temp_device(qapi_BLE_GAP_LE_Advertising_Report_Data_t *dev_ptr)
+   /* The following function is called from the Bluetooth stack for    */
+   /* every advertising report.  Bulbs that are not yet known are       */
+   /* reported to mscd_thread once per scan.                            */
+int mscd_filter_device(qapi_BLE_GAP_LE_Advertising_Report_Data_t *dev_ptr, int add)
 {
-   int i = 0;
+   MSCD_Scan_Entry_t  ScanEntry;
 
-   for(i = 0; i < MSCD_NUM_BULBS; i++)
-   {
+   if((!mscd_seen_addrs) || (!mscd_match_local_name(&(dev_ptr->Advertising_Data))))
+      return 0;
 
-      if(!mscd_temp_devices[i].valid)
-      {
-         //msc_ble_bulb_data = malloc(qapi_BLE_GAP_LE_Advertising_Report_Data_t);
-         memset(&(mscd_temp_devices[i].scan_data),0, 
-          sizeof(qapi_BLE_GAP_LE_Advertising_Report_Data_t));
-         memcpy(&(mscd_temp_devices[i].scan_data), dev_ptr,
-         sizeof(qapi_BLE_GAP_LE_Advertising_Report_Data_t));
-         mscd_temp_devices[i].valid = 1;
-         mscd_num_bulbs_found++;
-         QCLI_Printf(ble_group, "Msc temp device added @ index %d\n", i);
-         return 1;
-      }
+   if(mscd_index_find(&mscd_seen_index, mscd_hash_bd_addr(dev_ptr->BD_ADDR), mscd_match_seen_entry, &(dev_ptr->BD_ADDR)) >= 0)
+   {
+      //QCLI_Printf(ble_group, "Duplicate Msc temp scan data ignoring\n");
+      return 0;
    }
 
-   return -1;
+   if((!add) || ((unsigned int)mscd_num_bulbs_found >= mscd_num_bulbs))
+      return 0;
+
+   mscd_seen_addrs[mscd_num_bulbs_found] = dev_ptr->BD_ADDR;
+   mscd_index_insert(&mscd_seen_index, mscd_hash_bd_addr(dev_ptr->BD_ADDR), mscd_num_bulbs_found);
+   mscd_num_bulbs_found++;
+
+   ScanEntry.BD_ADDR      = dev_ptr->BD_ADDR;
+   ScanEntry.Address_Type = dev_ptr->Address_Type;
+   mscd_scan_result(&ScanEntry, sizeof(ScanEntry));
+
+   return 1;
 }
 
-int mscd_match_temp_device(qapi_BLE_BD_ADDR_t Board_Address)
+
+void mscd_add_scan_entry(void *dev_ptr)
 {
-   int i = 0;
+   MSCD_Scan_Entry_t *t_devptr = (MSCD_Scan_Entry_t *)dev_ptr;
+   int                deviceIndex;
 
-   for(i = 0; i < MSCD_NUM_BULBS; i++)
+   if(mscd_match_device(t_devptr->BD_ADDR) >= 0)
    {
-      if(mscd_temp_devices[i].valid && QAPI_BLE_COMPARE_BD_ADDR(mscd_temp_devices[i].scan_data.BD_ADDR,
-         Board_Address))
-      {
-         return i;
-      }
+      QCLI_LOG(ble_group, "Duplicate Msc scan data in result ignoring\n");
+   }
+   else if((deviceIndex = mscd_registry_alloc(t_devptr->BD_ADDR, t_devptr->Address_Type)) >= 0)
+   {
+      QCLI_LOG(ble_group, "Msc device added @ index %d\n", deviceIndex);
    }
+}
 
-   return -1;
+void mscd_clear_remp_scan_data()
+{
+   if(mscd_seen_addrs)
+      mscd_index_clear(&mscd_seen_index);
+
+   QCLI_LOG(ble_group, "mscd_clear_remp_scan_data called \n");
 }
 
-int mscd_filter_device(qapi_BLE_GAP_LE_Advertising_Report_Data_t *dev_ptr, int add)
+   /* The following function is called when the GATT connection to a   */
+   /* remote device has been established.  If the remote device is one */
+   /* of our bulbs it moves on to service discovery, and since the     */
+   /* controller stops initiating after every connection the next      */
+   /* connection round may be started immediately.                     */
+int mscd_assign_connection_info(void *c_info)
 {
-   char *str;
-   int found = 0;
+   MSCD_Connection_Info_t *ConnectionInfo = (MSCD_Connection_Info_t *)c_info;
+   int                     deviceIndex;
 
-   str = GetLocalNameInAD(&(dev_ptr->Advertising_Data));
-   if(!str)
-      return 0;
+   if((deviceIndex = mscd_match_device(ConnectionInfo->RemoteAddress)) >= 0)
+   {
+      mscd_connect_pending = 0;
 
-   //QCLI_Printf(ble_group, "MSCD Print - device found %s\n", str);
+      mscd_release_connection(deviceIndex);
+      mscd_set_connection_id(deviceIndex, ConnectionInfo->ConnectionID);
+      mscd_set_state(deviceIndex, MSCD_DEVICE_STATE_DISCOVERING);
+   }
 
-   if(!stricmp(str, MSCD_DEVICE_SIGNATURE))
+   return deviceIndex;
+}
+
+   /* The following function is called when the controller reports a  */
+   /* failed LE connection or has completed a Create Connection Cancel.*/
+int mscd_handle_connection_failed(void *data)
+{
+   qapi_BLE_BD_ADDR_t *r_adr = (qapi_BLE_BD_ADDR_t *)data;
+   unsigned int        deviceIndex;
+
+   if(mscd_connect_pending)
    {
-      //QCLI_Printf(ble_group, "Msc temp device found %s\n", str);
+      mscd_connect_pending = 0;
 
-      if(mscd_match_temp_device(dev_ptr->BD_ADDR) >= 0)
-      {
-         //QCLI_Printf(ble_group, "Duplicate Msc temp scan data ignoring\n");
-      }
-      else if(add)
+      for(deviceIndex = 0; deviceIndex < mscd_num_bulbs; deviceIndex++)
       {
-         qapi_BLE_GAP_LE_Advertising_Report_Data_t *t_devptr;
-         mscd_add_temp_device(dev_ptr);
-         t_devptr = malloc(sizeof(qapi_BLE_GAP_LE_Advertising_Report_Data_t));
-         memset(t_devptr, 0, sizeof(qapi_BLE_GAP_LE_Advertising_Report_Data_t));
-         memcpy(t_devptr, dev_ptr, sizeof(qapi_BLE_GAP_LE_Advertising_Report_Data_t));
-         mscd_scan_result((void *)t_devptr);
-         found = 1;
-         //QCLI_Printf(ble_group, "  Address: 0x%02X%02X%02X%02X%02X%02X.\n", dev_ptr->BD_ADDR.BD_ADDR5, dev_ptr->BD_ADDR.BD_ADDR4, dev_ptr->BD_ADDR.BD_ADDR3, dev_ptr->BD_ADDR.BD_ADDR2, dev_ptr->BD_ADDR.BD_ADDR1, dev_ptr->BD_ADDR.BD_ADDR0);
+         if((mscd_devices[deviceIndex].valid) && (mscd_devices[deviceIndex].state == MSCD_DEVICE_STATE_CONNECTING))
+         {
+            /* A cancelled round means none of the candidates answered, */
+            /* otherwise only the bulb that failed is backed off and the*/
+            /* rest are retried in the next round.                      */
+            if((mscd_connect_cancelled) || (QAPI_BLE_COMPARE_BD_ADDR(mscd_devices[deviceIndex].bd_addr, *r_adr)))
+               mscd_enter_backoff(deviceIndex);
+         }
       }
    }
 
-   free(str);
-   return found;
+   return 0;
 }
 
+void mscd_handle_mtu_exchanged(void *data)
+{
+   qapi_BLE_BD_ADDR_t *r_adr = (qapi_BLE_BD_ADDR_t *)data;
+   int                 deviceIndex;
 
-void mscd_add_scan_entry(void *dev_ptr)
+   if(((deviceIndex = mscd_match_device(*r_adr)) >= 0) && (mscd_devices[deviceIndex].state == MSCD_DEVICE_STATE_DISCOVERING))
+      mscd_devices[deviceIndex].mtu_exchanged = 1;
+}
+
+   /* The following function is called once the service discovery of a*/
+   /* bulb has completed.  The bulb is ready if the effect             */
+   /* characteristic was found, in which case it is brought up to date */
+   /* with the current effect straight away.                           */
+void mscd_handle_discovery_complete(int deviceIndex)
 {
-   qapi_BLE_GAP_LE_Advertising_Report_Data_t *t_devptr = (qapi_BLE_GAP_LE_Advertising_Report_Data_t *)dev_ptr;
+   if((deviceIndex < 0) || ((unsigned int)deviceIndex >= mscd_num_bulbs) || (!mscd_devices[deviceIndex].valid) ||
+      (mscd_devices[deviceIndex].state != MSCD_DEVICE_STATE_DISCOVERING))
+      return;
 
-   if(mscd_match_device(t_devptr->BD_ADDR) >= 0)
+   if(mscd_get_write_char_handle(deviceIndex))
    {
-      QCLI_Printf(ble_group, "Duplicate Msc scan data in result ignoring\n");
-      return;
+      mscd_devices[deviceIndex].retries = 0;
+      mscd_set_state(deviceIndex, MSCD_DEVICE_STATE_READY);
+      mscd_fanout_run();
+   }
+   else
+   {
+      QCLI_LOG(ble_group, "Msc device %d has no effect characteristic\n", deviceIndex);
+      mscd_device_lost(deviceIndex);
    }
-
-   mscd_add_device(t_devptr);
-
 }
 
-int mscd_add_device(qapi_BLE_GAP_LE_Advertising_Report_Data_t *dev_ptr)
+   /* The following function starts a connection round.  Every bulb    */
+   /* that is waiting for a connection is placed in the white list and */
+   /* a single white list based Create Connection is issued, so all of */
+   /* them are being connected at the same time.  The white list may   */
+   /* only be modified while no connection is being created.           */
+static int mscd_start_connection_round(void)
 {
-   int i = 0;
+   int                                 Result;
+   unsigned int                        deviceIndex;
+   int                                 candidates[MSCD_MAX_CONNECTS_IN_FLIGHT];
+   uint32_t                            Count;
+   unsigned int                        Index;
 
-   for(i = 0; i < MSCD_NUM_BULBS; i++)
+   if(mscd_white_list_count)
    {
+      qapi_BLE_GAP_LE_Remove_Device_From_White_List(BluetoothStackID, mscd_white_list_count, mscd_white_list, &Count);
+      mscd_white_list_count = 0;
+   }
 
-      if(!mscd_devices[i].valid)
+   for(deviceIndex = 0; (deviceIndex < mscd_num_bulbs) && (mscd_white_list_count < MSCD_MAX_CONNECTS_IN_FLIGHT); deviceIndex++)
+   {
+      if((mscd_devices[deviceIndex].valid) &&
+         ((mscd_devices[deviceIndex].state == MSCD_DEVICE_STATE_SCANNED) || (mscd_devices[deviceIndex].state == MSCD_DEVICE_STATE_CONNECTING)))
       {
-         //msc_ble_bulb_data = malloc(qapi_BLE_GAP_LE_Advertising_Report_Data_t);
-         mscd_devices[i].scan_data = dev_ptr;
-         mscd_devices[i].valid = 1;
-         QCLI_Printf(ble_group, "Msc device added @ index %d\n", i);
+         memset(&(mscd_white_list[mscd_white_list_count]), 0, sizeof(qapi_BLE_GAP_LE_White_List_Entry_t));
+         mscd_white_list[mscd_white_list_count].Address_Type = mscd_devices[deviceIndex].address_type;
+         mscd_white_list[mscd_white_list_count].Address      = mscd_devices[deviceIndex].bd_addr;
 
-         return 1;
+         candidates[mscd_white_list_count++] = deviceIndex;
       }
    }
 
-   return -1;
-}
-
-void mscd_clear_remp_scan_data()
-{
-   int i = 0;
+   if(!mscd_white_list_count)
+      return 0;
 
-   for(i = 0; i < MSCD_NUM_BULBS; i++)
+   if((Result = qapi_BLE_GAP_LE_Add_Device_To_White_List(BluetoothStackID, mscd_white_list_count, mscd_white_list, &Count)) != 0)
    {
+      QCLI_LOG(ble_group, "Msc unable to add %u bulbs to white list: %d\n", mscd_white_list_count, Result);
+      mscd_white_list_count = 0;
+      return 0;
+   }
 
-      mscd_temp_devices[i].valid = 0;
-      memset(&(mscd_temp_devices[i].scan_data), 0,
-         sizeof(qapi_BLE_GAP_LE_Advertising_Report_Data_t));
+   if(ConnectLEDevice(BluetoothStackID, TRUE, NULL, 0))
+      return 0;
 
-      QCLI_Printf(ble_group, "mscd_clear_remp_scan_data called \n");
+   mscd_connect_pending   = 1;
+   mscd_connect_cancelled = 0;
+   mscd_connect_ticks     = 0;
 
+   for(Index = 0; Index < mscd_white_list_count; Index++)
+   {
+      if(mscd_devices[candidates[Index]].state != MSCD_DEVICE_STATE_CONNECTING)
+         mscd_set_state(candidates[Index], MSCD_DEVICE_STATE_CONNECTING);
    }
 
+   return 1;
 }
 
-int mscd_match_device(qapi_BLE_BD_ADDR_t Board_Address)
+   /* The following function advances the per-bulb timers.  It is      */
+   /* called from mscd_thread on every periodic timer tick.             */
+void mscd_connmgr_tick()
 {
-   int i = 0;
+   unsigned int deviceIndex;
 
-   for(i = 0; i < MSCD_NUM_BULBS; i++)
+   for(deviceIndex = 0; deviceIndex < mscd_num_bulbs; deviceIndex++)
    {
-      if(mscd_devices[i].valid)
+      if(!mscd_devices[deviceIndex].valid)
+         continue;
+
+      mscd_devices[deviceIndex].state_ticks++;
+
+      if((mscd_devices[deviceIndex].state == MSCD_DEVICE_STATE_DISCOVERING) &&
+         (mscd_devices[deviceIndex].state_ticks >= MSCD_DISCOVERY_TIMEOUT_TICKS))
       {
-         if(QAPI_BLE_COMPARE_BD_ADDR(mscd_devices[i].scan_data->BD_ADDR,
-          Board_Address))
-         {
-            return i;
-         }
+         QCLI_LOG(ble_group, "Msc device %d discovery timed out\n", deviceIndex);
+         mscd_device_lost(deviceIndex);
+      }
+      else if((mscd_devices[deviceIndex].state == MSCD_DEVICE_STATE_BACKOFF) &&
+         (mscd_devices[deviceIndex].state_ticks >= mscd_devices[deviceIndex].backoff_ticks))
+      {
+         mscd_set_state(deviceIndex, MSCD_DEVICE_STATE_SCANNED);
+      }
+      else if((mscd_devices[deviceIndex].write_transaction) &&
+         (++mscd_devices[deviceIndex].write_ticks >= MSCD_WRITE_TIMEOUT_TICKS))
+      {
+         QCLI_LOG(ble_group, "Msc device %d write timed out\n", deviceIndex);
+         mscd_device_lost(deviceIndex);
       }
    }
 
-   return -1;
-}
-
+   if(mscd_connect_pending)
+   {
+      mscd_connect_ticks++;
 
-int mscd_assign_connection_info(void *c_info)
-{
-   if(mscd_selected_device < 0 || mscd_selected_device >= MSCD_NUM_BULBS)
-      return -1;
+      if((!mscd_connect_cancelled) && (mscd_connect_ticks >= MSCD_CONNECT_TIMEOUT_TICKS))
+      {
+         /* None of the candidates answered, the cancel is confirmed by */
+         /* a connection complete event which backs them off.           */
+         QCLI_LOG(ble_group, "Msc connection round timed out\n");
+         mscd_connect_cancelled = 1;
+         if(qapi_BLE_GAP_LE_Cancel_Create_Connection(BluetoothStackID))
+            mscd_connect_ticks = (MSCD_CONNECT_TIMEOUT_TICKS * 2);
+      }
 
-   mscd_devices[mscd_selected_device].connection_info = (DeviceInfo_t *)c_info;
+      /* Do not wait forever for the cancel to be confirmed.            */
+      if(mscd_connect_ticks >= (MSCD_CONNECT_TIMEOUT_TICKS * 2))
+      {
+         for(deviceIndex = 0; deviceIndex < mscd_num_bulbs; deviceIndex++)
+         {
+            if((mscd_devices[deviceIndex].valid) && (mscd_devices[deviceIndex].state == MSCD_DEVICE_STATE_CONNECTING))
+               mscd_enter_backoff(deviceIndex);
+         }
 
-   return 1;
+         mscd_connect_pending = 0;
+      }
+   }
 }
 
-void mscd_discover_services()
+   /* The following function drives the connection manager.  It starts */
+   /* service discovery on connected bulbs, up to                       */
+   /* MSCD_MAX_DISCOVERIES_IN_FLIGHT at a time, and starts a new        */
+   /* connection round when none is outstanding.  No connection is     */
+   /* started while a scan is running.  The function returns non-zero  */
+   /* while a connection round is outstanding.                         */
+int mscd_connmgr_run(int scan_active)
 {
-   QCLI_Printf(ble_group, "inside mscd_discover_services \n");
-   DiscoverMSCDServices(mscd_selected_device);
-}
+   unsigned int deviceIndex;
+   int          discoveries = 0;
 
-int  mscd_start_connect()
-{
-   mscd_selected_device = mscd_select_device_for_connection();
-   if(mscd_selected_device >= 0)
+   for(deviceIndex = 0; deviceIndex < mscd_num_bulbs; deviceIndex++)
    {
-      ConnectLEDevice(BluetoothStackID, FALSE,
-      &(mscd_devices[mscd_selected_device].scan_data->BD_ADDR),
-      mscd_devices[mscd_selected_device].scan_data->Address_Type);
-      return 1;
+      if((mscd_devices[deviceIndex].valid) && (mscd_devices[deviceIndex].state == MSCD_DEVICE_STATE_DISCOVERING) &&
+         (mscd_devices[deviceIndex].discovery_started))
+         discoveries++;
    }
 
-   return 0;
+   for(deviceIndex = 0; (deviceIndex < mscd_num_bulbs) && (discoveries < MSCD_MAX_DISCOVERIES_IN_FLIGHT); deviceIndex++)
+   {
+      if((mscd_devices[deviceIndex].valid) && (mscd_devices[deviceIndex].state == MSCD_DEVICE_STATE_DISCOVERING) &&
+         (!mscd_devices[deviceIndex].discovery_started) &&
+         ((mscd_devices[deviceIndex].mtu_exchanged) || (mscd_devices[deviceIndex].state_ticks >= MSCD_MTU_WAIT_TICKS)))
+      {
+         if(DiscoverMSCDServices(deviceIndex) == QCLI_STATUS_SUCCESS_E)
+         {
+            mscd_devices[deviceIndex].discovery_started = 1;
+            discoveries++;
+         }
+         else
+            mscd_device_lost(deviceIndex);
+      }
+   }
+
+   if((!mscd_connect_pending) && (!scan_active))
+      mscd_start_connection_round();
+
+   return mscd_connect_pending;
 }
 
 int mscd_any_device_tobe_scanned()
 {
-   int deviceIndex = 0;
-
-   for(deviceIndex = 0; deviceIndex < MSCD_NUM_BULBS; deviceIndex++)
-   {
-      if(mscd_devices[deviceIndex].valid == 0)
-         return 1;
-   }
-
-   return 0;
+   return(mscd_free_count != 0);
 }
 
 int mscd_start_scan()
 {
-   QCLI_Printf(ble_group, "inside mscd_start_scan \n");
+   QCLI_LOG(ble_group, "inside mscd_start_scan \n");
 
-   if(mscd_any_device_tobe_scanned())
-   {
-      mscd_start_ble_scan(BluetoothStackID, QAPI_BLE_FP_NO_FILTER_E, 2);
+   if((mscd_any_device_tobe_scanned()) && (!mscd_start_ble_scan(BluetoothStackID, QAPI_BLE_FP_NO_FILTER_E, 2)))
       return 1;
-   }
 
    return 0;
 }
@@ -7186,11 +7918,11 @@ static int mscd_start_ble_scan(uint32_t BluetoothStackID, qapi_BLE_GAP_LE_Filter
 {
    int Result;
 
-   QCLI_Printf(ble_group, "Msc scan enter \n");
+   QCLI_LOG(ble_group, "Msc scan enter \n");
    /* First, determine if the input parameters appear to be semi-valid. */
    if(BluetoothStackID)
    {
-      QCLI_Printf(ble_group, "Msc valid bt stack id %d\n", BluetoothStackID);
+      QCLI_LOG(ble_group, "Msc valid bt stack id %d\n", BluetoothStackID);
       /* Check to see if we need to configure the default Scan          */
       /* Parameters.                                                    */
       if(!(BLEParameters.Flags & BLE_PARAMETERS_FLAGS_SCAN_PARAMETERS_VALID))
@@ -7203,7 +7935,7 @@ static int mscd_start_ble_scan(uint32_t BluetoothStackID, qapi_BLE_GAP_LE_Filter
          BLEParameters.Flags |= BLE_PARAMETERS_FLAGS_SCAN_PARAMETERS_VALID;
       }
 
-      QCLI_Printf(ble_group, "Msc before scan duration \n");
+      QCLI_LOG(ble_group, "Msc before scan duration \n");
       /* See if we should start a timer for this scan.                  */
       if(ScanDuration)
       {
@@ -7225,12 +7957,12 @@ static int mscd_start_ble_scan(uint32_t BluetoothStackID, qapi_BLE_GAP_LE_Filter
          /* scan.                                                       */
          Result = qapi_BLE_GAP_LE_Perform_Scan(BluetoothStackID, QAPI_BLE_ST_ACTIVE_E, BLEParameters.ScanParameters.ScanInterval, BLEParameters.ScanParameters.ScanWindow, QAPI_BLE_LAT_PUBLIC_E, FilterPolicy, TRUE, GAP_LE_Event_Callback, 0);
          if(!Result)
-            QCLI_Printf(ble_group, "Msc scan started successfully. Scan Window: %u, Scan Interval: %u.\n", (unsigned int)BLEParameters.ScanParameters.ScanWindow, (unsigned int)BLEParameters.ScanParameters.ScanInterval);
+            QCLI_LOG(ble_group, "Msc scan started successfully. Scan Window: %u, Scan Interval: %u.\n", (unsigned int)BLEParameters.ScanParameters.ScanWindow, (unsigned int)BLEParameters.ScanParameters.ScanInterval);
          else
-            QCLI_Printf(ble_group, "Msc unable to perform scan: %d\n", Result);
+            QCLI_LOG(ble_group, "Msc unable to perform scan: %d\n", Result);
       }
       else
-         QCLI_Printf(ble_group, "Msc unable to start scan timer: %d\n", Result);
+         QCLI_LOG(ble_group, "Msc unable to start scan timer: %d\n", Result);
    }
    else
       Result = -1;
@@ -7238,6 +7970,7 @@ static int mscd_start_ble_scan(uint32_t BluetoothStackID, qapi_BLE_GAP_LE_Filter
    return(Result);
 }
 
+
    /* Generic Attribute Profile (GATT) QCLI command functions.          */
 
    /* The following function is responsible for performing a GATT       */
@@ -7246,68 +7979,45 @@ static int mscd_start_ble_scan(uint32_t BluetoothStackID, qapi_BLE_GAP_LE_Filter
 static QCLI_Command_Status_t DiscoverMSCDServices(int deviceIndex)
 {
    int                                     Result;
-   DeviceInfo_t                           *DeviceInfo;
    QCLI_Command_Status_t                   ret_val;
 
    /* Verify that there is a connection that is established.            */
-   if(mscd_devices[deviceIndex].connection_info->ConnectionID)
+   if(mscd_devices[deviceIndex].connection_id)
    {
       /* Lock the Bluetooth stack.                                      */
       if(!qapi_BLE_BSC_LockBluetoothStack(BluetoothStackID))
       {
-         /* Get the device info for the connection device.              */
-         if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, 
-            mscd_devices[deviceIndex].connection_info->RemoteAddress)) != NULL)
-         {
-            QCLI_Printf(ble_group, "inside DiscoverMSCDServices \n");
-            /* Verify that no service discovery is outstanding for this */
-            /* device.                                                  */
-            if(!(DeviceInfo->Flags & DEVICE_INFO_FLAGS_SERVICE_DISCOVERY_OUTSTANDING))
-            {
-               /* Start the service discovery process.                  */
-               Result = qapi_BLE_GATT_Start_Service_Discovery(BluetoothStackID, DeviceInfo->ConnectionID, 0, NULL, 
-                  GATT_MSCD_Service_Discovery_Event_Callback, 0);
+         QCLI_LOG(ble_group, "inside DiscoverMSCDServices \n");
 
-               if(!Result)
-               {
-                  /* Display success message.                           */
-                  QCLI_Printf(ble_group, "qapi_BLE_GATT_Service_Discovery_Start() success.\n");
+         /* Start the service discovery process.                        */
+         Result = qapi_BLE_GATT_Start_Service_Discovery(BluetoothStackID, mscd_devices[deviceIndex].connection_id, 0, NULL,
+            GATT_MSCD_Service_Discovery_Event_Callback, (uint32_t)deviceIndex);
 
-                  /* Flag that a Service Discovery Operation is         */
-                  /* outstanding.                                       */
-                  DeviceInfo->Flags |= DEVICE_INFO_FLAGS_SERVICE_DISCOVERY_OUTSTANDING;
-                  ret_val = QCLI_STATUS_SUCCESS_E;
-               }
-               else
-               {
-                  /* An error occur so just clean-up.                   */
-                  QCLI_Printf(ble_group, "Error - MSCD GATT_Service_Discovery_Start returned %d.\n", Result);
-                  ret_val = QCLI_STATUS_ERROR_E;
-               }
-            }
-            else
-            {
-               QCLI_Printf(ble_group, "MSCD Service Discovery Operation Outstanding for Device. %d\n", deviceIndex);
-               ret_val = QCLI_STATUS_ERROR_E;
-            }
+         if(!Result)
+         {
+            /* Display success message.                                 */
+            QCLI_LOG(ble_group, "qapi_BLE_GATT_Service_Discovery_Start() success.\n");
+            ret_val = QCLI_STATUS_SUCCESS_E;
          }
          else
          {
-            QCLI_Printf(ble_group, "No Device Info.\n");
+            /* An error occur so just clean-up.                         */
+            QCLI_LOG(ble_group, "Error - MSCD GATT_Service_Discovery_Start returned %d.\n", Result);
             ret_val = QCLI_STATUS_ERROR_E;
          }
+
          /* Un-lock the Bluetooth Stack.                                */
          qapi_BLE_BSC_UnLockBluetoothStack(BluetoothStackID);
       }
       else
       {
-         QCLI_Printf(ble_group, "Unable to acquire Bluetooth Stack Lock.\n");
+         QCLI_LOG(ble_group, "Unable to acquire Bluetooth Stack Lock.\n");
          ret_val = QCLI_STATUS_ERROR_E;
       }
    }
    else
    {
-      QCLI_Printf(ble_group, "No Connection Established\n");
+      QCLI_LOG(ble_group, "No Connection Established\n");
       ret_val = QCLI_STATUS_ERROR_E;
    }
 
@@ -7316,69 +8026,60 @@ static QCLI_Command_Status_t DiscoverMSCDServices(int deviceIndex)
 
 static void QAPI_BLE_BTPSAPI GATT_MSCD_Service_Discovery_Event_Callback(uint32_t BluetoothStackID, qapi_BLE_GATT_Service_Discovery_Event_Data_t *GATT_Service_Discovery_Event_Data, uint32_t CallbackParameter)
 {
-   DeviceInfo_t *DeviceInfo;
-
-   if(!mscd_devices[mscd_selected_device].valid)
+   /* The callback parameter carries the bulb index, several discovery */
+   /* operations may be outstanding at the same time.                  */
+   if(CallbackParameter >= mscd_num_bulbs)
       return;
-   
+
    if((BluetoothStackID) && (GATT_Service_Discovery_Event_Data))
    {
-      if((DeviceInfo = SearchDeviceInfoEntryByBD_ADDR(&DeviceInfoList, 
-         mscd_devices[mscd_selected_device].connection_info->RemoteAddress)) != NULL)
+      switch(GATT_Service_Discovery_Event_Data->Event_Data_Type)
       {
-         switch(GATT_Service_Discovery_Event_Data->Event_Data_Type)
-         {
-            case QAPI_BLE_ET_GATT_SERVICE_DISCOVERY_INDICATION_E:
-               /* Verify the event data.                                */
-               if(GATT_Service_Discovery_Event_Data->Event_Data.GATT_Service_Discovery_Indication_Data)
-               {
-                  /*QCLI_Printf(ble_group, "Service 0x%04X - 0x%04X, UUID: ", 
-                     GATT_Service_Discovery_Event_Data->Event_Data.GATT_Service_Discovery_Indication_Data->ServiceInformation.Service_Handle, 
-                     GATT_Service_Discovery_Event_Data->Event_Data.GATT_Service_Discovery_Indication_Data->ServiceInformation.End_Group_Handle);
-                  DisplayUUID(&(GATT_Service_Discovery_Event_Data->Event_Data.GATT_Service_Discovery_Indication_Data->ServiceInformation.UUID));
-                  QCLI_Printf(ble_group, "\n");*/
-                  /* Attempt to populate MSCD handles.                  */
-                  mscd_populate_handles(&(DeviceInfo->AIOPClientInfo), GATT_Service_Discovery_Event_Data->Event_Data.GATT_Service_Discovery_Indication_Data);
-
-               }
-               break;
-            case QAPI_BLE_ET_GATT_SERVICE_DISCOVERY_COMPLETE_E:
-               /* Verify the event data.                                */
-               if(GATT_Service_Discovery_Event_Data->Event_Data.GATT_Service_Discovery_Complete_Data)
-               {
-                  QCLI_Printf(ble_group, "Service Discovery Operation Complete, Status 0x%02X.\n", GATT_Service_Discovery_Event_Data->Event_Data.GATT_Service_Discovery_Complete_Data->Status);
-                  /* Flag that no service discovery operation is        */
-                  /* outstanding for this device.                       */
-                  DeviceInfo->Flags &= ~DEVICE_INFO_FLAGS_SERVICE_DISCOVERY_OUTSTANDING;
-                  mscd_service_discovery_callback();
-               }
-               break;
-            default:
-               break;
-         }
+         case QAPI_BLE_ET_GATT_SERVICE_DISCOVERY_INDICATION_E:
+            /* Verify the event data.                                   */
+            if(GATT_Service_Discovery_Event_Data->Event_Data.GATT_Service_Discovery_Indication_Data)
+            {
+               /* Attempt to populate MSCD handles.                     */
+               mscd_populate_handles(GATT_Service_Discovery_Event_Data->Event_Data.GATT_Service_Discovery_Indication_Data, (int)CallbackParameter);
+            }
+            break;
+         case QAPI_BLE_ET_GATT_SERVICE_DISCOVERY_COMPLETE_E:
+            /* Verify the event data.                                   */
+            if(GATT_Service_Discovery_Event_Data->Event_Data.GATT_Service_Discovery_Complete_Data)
+            {
+               QCLI_LOG(ble_group, "Service Discovery Operation Complete, Status 0x%02X.\n", GATT_Service_Discovery_Event_Data->Event_Data.GATT_Service_Discovery_Complete_Data->Status);
+               mscd_service_discovery_complete((int)CallbackParameter);
+            }
+            break;
+         default:
+            break;
       }
-
    }
 }
 
 void mscd_attach_handles(void *data)
 {
-   mscd_devices[mscd_selected_device].dev_chars = (MSCD_DEVICE_CHARS *)data;
+   MSCD_DEVICE_CHARS *dev_chars = (MSCD_DEVICE_CHARS *)data;
+   int                deviceIndex = dev_chars->device_index;
+
+   /* Only keep the handles if the bulb is still being discovered.     */
+   if((mscd_devices[deviceIndex].valid) && (mscd_devices[deviceIndex].state == MSCD_DEVICE_STATE_DISCOVERING) &&
+      (!mscd_devices[deviceIndex].dev_chars.Characteristic_Handle))
+      mscd_devices[deviceIndex].dev_chars = *dev_chars;
 }
    /* The following function is a utility function that provides a      */
    /* mechanism of populating a MSCD Client Information structure with  */
    /* the information discovered from a MSCD Discovery operation.       */
    /* * NOTE * We will only store characteristc attribute handles that  */
    /*          are supported by this demo.                              */
-static void mscd_populate_handles(AIOP_Client_Information_t *ClientInfo, 
-   qapi_BLE_GATT_Service_Discovery_Indication_Data_t *ServiceDiscoveryData)
+static void mscd_populate_handles(qapi_BLE_GATT_Service_Discovery_Indication_Data_t *ServiceDiscoveryData, int deviceIndex)
 {
    unsigned int                                           Index;
    qapi_BLE_GATT_Characteristic_Information_t            *CharacteristicInfoPtr;
-   MSCD_DEVICE_CHARS                          *InstanceInfoPtr;
+   MSCD_DEVICE_CHARS                                      InstanceInfo;
    //QCLI_Printf(ble_group, "Inside mscd_populate_handles\n");
    /* Verify that the input parameters are semi-valid.                  */
-   if((ClientInfo) && (ServiceDiscoveryData))
+   if(ServiceDiscoveryData)
    {
      /* Loop through all characteristics discovered in the service and  */
      /* populate the correct entry.                                     */
@@ -7390,18 +8091,17 @@ static void mscd_populate_handles(AIOP_Client_Information_t *ClientInfo,
         /* information.                                                 */
          for(Index = 0; Index < ServiceDiscoveryData->NumberOfCharacteristics; Index++)
          {
-            //InstanceInfoPtr[Index].Valid =  TRUE;        
             /* Store the properties. */
             if(QAPI_BLE_MSCD_COMPARE_CHAR_UUID_TO_UUID_16(CharacteristicInfoPtr[Index].Characteristic_UUID.UUID.UUID_16 ))
             { 
-               InstanceInfoPtr =  malloc(sizeof(MSCD_DEVICE_CHARS) * 1);                      
-               InstanceInfoPtr[0].Properties = CharacteristicInfoPtr[Index].Characteristic_Properties;
-               InstanceInfoPtr[0].Characteristic_Handle = CharacteristicInfoPtr[Index].Characteristic_Handle;
+               InstanceInfo.Properties = CharacteristicInfoPtr[Index].Characteristic_Properties;
+               InstanceInfo.Characteristic_Handle = CharacteristicInfoPtr[Index].Characteristic_Handle;
+               InstanceInfo.device_index = deviceIndex;
                QCLI_Printf(ble_group, "   Handle:        0x%04X\n", CharacteristicInfoPtr[Index].Characteristic_Handle);
                QCLI_Printf(ble_group, "   Properties:    0x%02X\n", CharacteristicInfoPtr[Index].Characteristic_Properties);
                QCLI_Printf(ble_group, "   UUID:          0x");
                DisplayUUID(&(CharacteristicInfoPtr[Index].Characteristic_UUID));
-               mscd_service_discovery_result(InstanceInfoPtr);
+               mscd_service_discovery_result(&InstanceInfo, sizeof(InstanceInfo));
                break;
             }               
          }
@@ -16286,6 +16986,15 @@ static void QAPI_BLE_BTPSAPI GAP_LE_Event_Callback(uint32_t BluetoothStackID, qa
                      }
                   }
                }
+#ifdef QC_MSC_FESTIVAL
+               else
+               {
+                  /* Let the MSCD connection manager know that the      */
+                  /* connection round has ended without a connection.   */
+                  mscd_connection_failed_result(&(GAP_LE_Event_Data->Event_Data.GAP_LE_Connection_Complete_Event_Data->Peer_Address),
+                     sizeof(qapi_BLE_BD_ADDR_t));
+               }
+#endif
             }
             break;
          case QAPI_BLE_ET_LE_DISCONNECTION_COMPLETE_E:
@@ -17120,7 +17829,13 @@ static void QAPI_BLE_BTPSAPI GATT_Connection_Event_Callback(uint32_t BluetoothSt
                   }
 
                   #ifdef QC_MSC_FESTIVAL
-                     mscd_connection_result((void *)DeviceInfo);
+                  {
+                     MSCD_Connection_Info_t MSCD_Connection_Info;
+
+                     MSCD_Connection_Info.RemoteAddress = DeviceInfo->RemoteAddress;
+                     MSCD_Connection_Info.ConnectionID  = DeviceInfo->ConnectionID;
+                     mscd_connection_result(&MSCD_Connection_Info, sizeof(MSCD_Connection_Info));
+                  }
                   #endif
                }
                else
@@ -17192,14 +17907,8 @@ static void QAPI_BLE_BTPSAPI GATT_Connection_Event_Callback(uint32_t BluetoothSt
                      }
                   }
                   
-                  {
-                     qapi_BLE_BD_ADDR_t *MSCD_Board_Address = malloc(sizeof(qapi_BLE_BD_ADDR_t));
-                     memset(MSCD_Board_Address, 0, sizeof(qapi_BLE_BD_ADDR_t));
-                     memcpy(MSCD_Board_Address, 
-                        &GATT_Connection_Event_Data->Event_Data.GATT_Device_Disconnection_Data->RemoteDevice,
-                        sizeof(qapi_BLE_BD_ADDR_t));
-                     mscd_disconnection_result(MSCD_Board_Address);
-                  }
+                  mscd_disconnection_result(&(GATT_Connection_Event_Data->Event_Data.GATT_Device_Disconnection_Data->RemoteDevice),
+                     sizeof(qapi_BLE_BD_ADDR_t));
                }
 
                /* If a remote device is still connected, then the first */
@@ -20236,13 +20945,10 @@ static void QAPI_BLE_BTPSAPI GATT_ClientEventCallback_GAPS(uint32_t BluetoothSta
             else
                QCLI_Printf(gaps_group, "Error - Null Error Response Data.\n");
 
+            if(GATT_Client_Event_Data->Event_Data.GATT_Request_Error_Data)
             {
-               qapi_BLE_BD_ADDR_t *MSCD_Board_Address = malloc(sizeof(qapi_BLE_BD_ADDR_t));
-               memset(MSCD_Board_Address, 0, sizeof(qapi_BLE_BD_ADDR_t));
-               memcpy(MSCD_Board_Address, 
-                  &GATT_Client_Event_Data->Event_Data.GATT_Request_Error_Data->RemoteDevice,
+               mscd_disconnection_result(&(GATT_Client_Event_Data->Event_Data.GATT_Request_Error_Data->RemoteDevice),
                   sizeof(qapi_BLE_BD_ADDR_t));
-               mscd_disconnection_result(MSCD_Board_Address);
             }
 /*
 
@@ -20267,7 +20973,8 @@ static void QAPI_BLE_BTPSAPI GATT_ClientEventCallback_GAPS(uint32_t BluetoothSta
                QCLI_Printf(gaps_group, "BD_ADDR:         %s.\n", BoardStr);
                QCLI_Printf(gaps_group, "MTU:             %u.\n", GATT_Client_Event_Data->Event_Data.GATT_Exchange_MTU_Response_Data->ServerMTU);
 #ifdef QC_MSC_FESTIVAL
-               mscd_connection_result_callback();
+               mscd_mtu_exchange_result(&(GATT_Client_Event_Data->Event_Data.GATT_Exchange_MTU_Response_Data->RemoteDevice),
+                  sizeof(qapi_BLE_BD_ADDR_t));
 #endif
 
             }
@@ -37,6 +37,7 @@
 #include "qurt_mutex.h"
 #include "qurt_signal.h"
 #include "qurt_thread.h"
+#include "qurt_timer.h"
 #include "qurt_types.h"
 #include "string.h"
 
@@ -71,16 +72,36 @@
 #define MAXIMUM_PRINTF_LENGTH                                           (1024)
 
 /**
-   This definition determines the maximum number of command threads that
-   the QCLI allows to be running at a time.
+   This definition determines the number of command workers that run the
+   commands which have Start_Thread set to true.  This is also the number
+   of these commands that can be running at a time.
 */
-#define MAXIMUM_THREAD_COUNT                                            (5)
+#define DEFAULT_WORKER_COUNT                                            (5)
 
 /**
-   This definition determines the size of the stack (in bytes) that is used
-   for command threads.
+   This definition determines the size of the stack (in bytes) of the
+   default command workers.
 */
-#define THREAD_STACK_SIZE                                               (3072)
+#define DEFAULT_WORKER_STACK_SIZE                                       (3072)
+
+/**
+   This definition determines the number of command workers that run the
+   commands which have Start_Thread set to QCLI_THREAD_LARGE_STACK.
+*/
+#define LARGE_WORKER_COUNT                                              (1)
+
+/**
+   This definition determines the size of the stack (in bytes) of the large
+   stack command workers.
+*/
+#define LARGE_WORKER_STACK_SIZE                                         (6144)
+
+/**
+   This definition determines the number of commands that can be waiting
+   for a worker of each worker class.  A command is rejected if the queue
+   of its class is full.
+*/
+#define COMMAND_QUEUE_SIZE                                              (4)
 
 /**
    This definition indicates if received characters should be echoed to
@@ -103,7 +124,7 @@
 
 /**
 */
-#define THREAD_READY_EVENT_MASK                                         0x00000001
+#define COMMAND_QUEUED_EVENT_MASK                                       0x00000001
 
 /**
 */
@@ -112,6 +133,20 @@
 #define TAKE_LOCK(__lock__)                                             ((qurt_mutex_lock_timed(&(__lock__), QURT_TIME_WAIT_FOREVER)) == QURT_EOK)
 #define RELEASE_LOCK(__lock__)                                          do { qurt_mutex_unlock(&(__lock__)); } while(0)
 
+/**
+   The number of subgroups a group's lookup index is given room for on top
+   of the ones already registered, so that registering a few more subgroups
+   doesn't need a new allocation.
+*/
+#define COMMAND_INDEX_SPARE_SUBGROUPS                                   (4)
+
+/**
+   The indexes of the worker classes in the QCLI context.
+*/
+#define DEFAULT_WORKER_CLASS                                            (0)
+#define LARGE_WORKER_CLASS                                              (1)
+#define WORKER_CLASS_COUNT                                              (2)
+
 /*-------------------------------------------------------------------------
  * Type Declarations
  *-----------------------------------------------------------------------*/
@@ -125,8 +160,29 @@ typedef struct Group_List_Entry_s
    struct Group_List_Entry_s  *Parent_Group;          /**< the parent group for this subgroup. */
    struct Group_List_Entry_s  *Subgroup_List;         /**< The list of subgroups registerd for this group. */
    struct Group_List_Entry_s  *Next_Group_List_Entry; /**< The next entry in the list. */
+   struct Command_Index_s     *Command_Index;         /**< The lookup index of the group's commands and subgroups. */
 } Group_List_Entry_t;
 
+/**
+   This structure is the lookup index of a group, it lets Find_Command()
+   find a name without searching the command lists.  It is rebuilt
+   whenever a subgroup is registered or unregistered.
+
+   The hash table holds every name that can be entered in the group (the
+   common commands, the group's commands and its subgroups) and uses linear
+   probing.  Each slot holds the command index of an entry plus one, zero
+   marks an empty slot.
+*/
+typedef struct Command_Index_s
+{
+   uint32_t                   Entry_Count;       /**< The number of commands and subgroups of the group.          */
+   uint32_t                   Subgroup_Count;    /**< The number of subgroups in the subgroup array.               */
+   uint32_t                   Subgroup_Capacity; /**< The number of subgroups the subgroup array has room for.     */
+   uint32_t                   Hash_Mask;         /**< The size of the hash table minus one (a power of two).       */
+   uint16_t                  *Hash_Table;        /**< The hash table of the names.                                 */
+   struct Group_List_Entry_s **Subgroup_Array;   /**< The subgroups of the group, in the order of the subgroup list. */
+} Command_Index_t;
+
 /**
    This structure reprents the result of a Find_Command() operation.
 */
@@ -141,17 +197,54 @@ typedef struct Find_Result_s
 } Find_Result_t;
 
 /**
-   This structure contains the information needed for starting a command
-   thread.
+   This structure contains a command that is waiting for, or being run by,
+   a command worker.  The input string is copied with the parameters so
+   the console can take the next command while the job is queued.
+*/
+typedef struct Command_Job_s
+{
+   uint32_t              Command_Index;                                        /**< The index of the command that will be executed. */
+   const QCLI_Command_t *Command;                                              /**< The command that will be executed. */
+   uint32_t              Parameter_Count;                                      /**< The number of parameters specified for the command. */
+   QCLI_Parameter_t      Parameter_List[MAXIMUM_NUMBER_OF_PARAMETERS];         /**< The list of paramters for the command. */
+   char                  Input_String[MAXIMUM_QCLI_COMMAND_STRING_LENGTH + 1]; /**< The input string the parameters point into. */
+   qurt_time_t           Queue_Time;                                           /**< The time (in ticks) the command was queued. */
+} Command_Job_t;
+
+/**
+   This structure contains the statistics of a worker class, which are
+   displayed by the "Stats" command.  Times are in milliseconds.
 */
-typedef struct Thread_Info_s
+typedef struct Worker_Stats_s
 {
-   qurt_signal_t         Thread_Ready_Event; /**< Event which indicates the thread no longer needs this information structure. */
-   uint32_t              Command_Index;      /**< The index of the command that will be executed. */
-   const QCLI_Command_t *Command;            /**< The command that will be executed. */
-   uint32_t              Parameter_Count;    /**< The number of parameters specified for the command. */
-   QCLI_Parameter_t     *Parameter_List;     /**< The list of paramters for the command. */
-} Thread_Info_t;
+   uint32_t Jobs_Started;    /**< The number of commands taken from the queue.       */
+   uint32_t Jobs_Completed;  /**< The number of commands that have returned.         */
+   uint32_t Jobs_Rejected;   /**< The number of commands refused with a full queue.  */
+   uint32_t Max_Queue_Count; /**< The largest number of commands that were queued.   */
+   uint32_t Max_Busy_Count;  /**< The largest number of workers that were busy.      */
+   uint32_t Total_Wait_Time; /**< The total time commands spent in the queue.        */
+   uint32_t Max_Wait_Time;   /**< The longest time a command spent in the queue.     */
+   uint32_t Total_Run_Time;  /**< The total time commands took to return.            */
+   uint32_t Max_Run_Time;    /**< The longest time a command took to return.         */
+} Worker_Stats_t;
+
+/**
+   This structure represents a class of command workers.  The workers of a
+   class are created when the QCLI is initialized, share a stack size and
+   take their commands from the queue of the class.
+*/
+typedef struct Worker_Class_s
+{
+   const char     *Name;                      /**< The name of the class, as displayed by "Stats".     */
+   uint32_t        Stack_Size;                /**< The stack size (in bytes) of the workers.           */
+   uint32_t        Worker_Count;              /**< The number of workers of the class.                 */
+   uint32_t        Busy_Count;                /**< The number of workers that are running a command.   */
+   qurt_signal_t   Queue_Event;               /**< Event which is set while the queue holds a command. */
+   uint32_t        Queue_Head;                /**< The index of the oldest command in the queue.       */
+   uint32_t        Queue_Count;               /**< The number of commands in the queue.                */
+   Command_Job_t   Queue[COMMAND_QUEUE_SIZE]; /**< The queue of commands waiting for a worker.         */
+   Worker_Stats_t  Stats;                     /**< The statistics of the class.                        */
+} Worker_Class_t;
 
 /**
    This structure contains the context information for the QCLI module.
@@ -166,8 +259,7 @@ typedef struct QCLI_Context_s
    char                Input_String[MAXIMUM_QCLI_COMMAND_STRING_LENGTH + 1]; /**< Buffer containing the current console input string.                      */
    QCLI_Parameter_t    Parameter_List[MAXIMUM_NUMBER_OF_PARAMETERS + 1];     /**< List of parameters for input command.                                    */
 
-   uint32_t            Thread_Count;                                         /**< THe number of command threads that are currently running.                */
-   Thread_Info_t       Thread_Info;                                          /**< Information structure for passing information to command threads.        */
+   Worker_Class_t      Worker_Class[WORKER_CLASS_COUNT];                     /**< The command worker classes.                                              */
    qurt_mutex_t        CLI_Mutex;                                            /**< The Mutex used to protect shared resources of the module.                */
 
    char                Printf_Buffer[MAXIMUM_PRINTF_LENGTH];                 /**< The buffer used for formatted output strings.                            */
@@ -186,16 +278,26 @@ static QCLI_Command_Status_t Command_Help(uint32_t Parameter_Count, QCLI_Paramet
 static QCLI_Command_Status_t Command_Exit(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 static QCLI_Command_Status_t Command_Up(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 static QCLI_Command_Status_t Command_Root(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+static QCLI_Command_Status_t Command_Stats(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 
 static void Display_Group_Name(const Group_List_Entry_t *Group_List_Entry);
 static uint32_t Display_Help(Group_List_Entry_t *Command_Group, uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 static void Display_Usage(uint32_t Command_Index, const QCLI_Command_t *Command);
 static void Display_Command_List(const Group_List_Entry_t *Group_List_Entry);
 
-static void Command_Thread(void *Thread_Parameter);
+static void Copy_Command_Job(Command_Job_t *Job, const char *Input_String, uint32_t Command_Index, const QCLI_Command_t *Command, uint32_t Parameter_Count, const QCLI_Parameter_t *Parameter_List);
+static void Command_Worker_Thread(void *Thread_Parameter);
+static qbool_t Start_Worker_Class(Worker_Class_t *Worker_Class, const char *Name, uint32_t Stack_Size, uint32_t Worker_Count);
 
 static void Execute_Command(uint32_t Command_Index, const QCLI_Command_t *Command, uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+static uint32_t Hash_Command_String(const char *String, uint32_t Length);
+static const char *Get_Command_Entry(Group_List_Entry_t *Group_List_Entry, uint32_t Command_Index, Find_Result_t *Find_Result);
+static uint32_t Find_Hash_Slot(Group_List_Entry_t *Group_List_Entry, const char *String, uint32_t Length);
+static qbool_t Lookup_Command(Group_List_Entry_t *Group_List_Entry, const char *String, uint32_t Length, uint32_t *Command_Index);
+static qbool_t Build_Command_Index(Group_List_Entry_t *Group_List_Entry);
 static qbool_t Find_Command(Group_List_Entry_t *Group_List_Entry, QCLI_Parameter_t *Command_Parameter, Find_Result_t *Find_Result);
+static void Append_Input_String(const char *String, uint32_t Length);
+static void Complete_Command(void);
 static void Process_Command(void);
 static qbool_t Unregister_Command_Group(Group_List_Entry_t *Group_List_Entry);
 
@@ -203,9 +305,9 @@ static qbool_t Unregister_Command_Group(Group_List_Entry_t *Group_List_Entry);
    not in a group. */
 const QCLI_Command_t Root_Command_List[] =
 {
-   {Command_Ver,  false, "Ver",  "",                     "Display Build Info"},
-   {Command_Help, false, "Help", "[Command (optional)]", "Display Command list or usage for a command"},
-   {Command_Exit, false, "Exit", "[Restart (1=Yes)]",    "Exits the application."}
+   {Command_Ver,   false, "Ver",   "",                     "Display Build Info"},
+   {Command_Help,  false, "Help",  "[Command (optional)]", "Display Command list or usage for a command"},
+   {Command_Exit,  false, "Exit",  "[Restart (1=Yes)]",    "Exits the application."}
 };
 
 #define ROOT_COMMAND_LIST_SIZE                        (sizeof(Root_Command_List) / sizeof(QCLI_Command_t))
@@ -214,14 +316,20 @@ const QCLI_Command_t Root_Command_List[] =
    in a group. */
 const QCLI_Command_t Common_Command_List[] =
 {
-   {Command_Ver,  false, "Ver",  "",                     "Display Build Info"},
-   {Command_Help, false, "Help", "[Command (optional)]", "Display Command list or usage for a command"},
-   {Command_Up,   false, "Up",   "",                     "Exit command group (move to parent group)"},
-   {Command_Root, false, "Root", "",                     "Move to top-level group list"}
+   {Command_Ver,   false, "Ver",   "",                     "Display Build Info"},
+   {Command_Help,  false, "Help",  "[Command (optional)]", "Display Command list or usage for a command"},
+   {Command_Up,    false, "Up",    "",                     "Exit command group (move to parent group)"},
+   {Command_Root,  false, "Root",  "",                     "Move to top-level group list"}
 };
 
 #define COMMON_COMMAND_LIST_SIZE                      (sizeof(Common_Command_List) / sizeof(QCLI_Command_t))
 
+/* The following command is supported in every group but only by name.  It is
+   kept out of the numbered lists so the command indices used by scripted
+   numeric commands don't change. */
+const QCLI_Command_t Stats_Command =
+   {Command_Stats, false, "Stats", "[Reset (1=Yes)]",      "Display command queue and latency statistics"};
+
 /*-------------------------------------------------------------------------
  * Function Definitions
  *-----------------------------------------------------------------------*/
@@ -414,6 +522,65 @@ static QCLI_Command_Status_t Command_Root(uint32_t Parameter_Count, QCLI_Paramet
    return(QCLI_STATUS_SUCCESS_E);
 }
 
+/**
+   @brief This function processes the "Stats" command from the CLI.
+
+   It displays the queue depth and latency statistics of each class of
+   command workers.  The statistics are cleared if the parameter is 1.
+*/
+static QCLI_Command_Status_t Command_Stats(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+   QCLI_Command_Status_t  Ret_Val;
+   Worker_Class_t        *Worker_Class;
+   qbool_t                Reset;
+   uint32_t               Index;
+
+   if((Parameter_Count >= 1) && (!(Parameter_List[0].Integer_Is_Valid)))
+   {
+      Ret_Val = QCLI_STATUS_USAGE_E;
+   }
+   else if(TAKE_LOCK(QCLI_Context.CLI_Mutex))
+   {
+      Reset = (qbool_t)((Parameter_Count >= 1) && (Parameter_List[0].Integer_Value == 1));
+
+      QCLI_Printf(MAIN_PRINTF_HANDLE, "Class    Stack  Workers  Busy  MaxBusy  Queued  MaxQueued  Started  Done  Rejected  WaitAvg  WaitMax  RunAvg  RunMax\n");
+
+      for(Index = 0; Index < WORKER_CLASS_COUNT; Index ++)
+      {
+         Worker_Class = &(QCLI_Context.Worker_Class[Index]);
+
+         QCLI_Printf(MAIN_PRINTF_HANDLE, "%-7s  %5u  %7u  %4u  %7u  %6u  %9u  %7u  %4u  %8u  %7u  %7u  %6u  %6u\n",
+                     Worker_Class->Name, Worker_Class->Stack_Size, Worker_Class->Worker_Count, Worker_Class->Busy_Count,
+                     Worker_Class->Stats.Max_Busy_Count, Worker_Class->Queue_Count, Worker_Class->Stats.Max_Queue_Count,
+                     Worker_Class->Stats.Jobs_Started, Worker_Class->Stats.Jobs_Completed, Worker_Class->Stats.Jobs_Rejected,
+                     (Worker_Class->Stats.Jobs_Started != 0) ? (Worker_Class->Stats.Total_Wait_Time / Worker_Class->Stats.Jobs_Started) : 0,
+                     Worker_Class->Stats.Max_Wait_Time,
+                     (Worker_Class->Stats.Jobs_Completed != 0) ? (Worker_Class->Stats.Total_Run_Time / Worker_Class->Stats.Jobs_Completed) : 0,
+                     Worker_Class->Stats.Max_Run_Time);
+
+         if(Reset)
+         {
+            /* Start the maximums from what is busy and queued now. */
+            memset(&(Worker_Class->Stats), 0, sizeof(Worker_Stats_t));
+            Worker_Class->Stats.Max_Busy_Count  = Worker_Class->Busy_Count;
+            Worker_Class->Stats.Max_Queue_Count = Worker_Class->Queue_Count;
+         }
+      }
+
+      QCLI_Printf(MAIN_PRINTF_HANDLE, "Times are in ms.\n");
+
+      RELEASE_LOCK(QCLI_Context.CLI_Mutex);
+
+      Ret_Val = QCLI_STATUS_SUCCESS_E;
+   }
+   else
+   {
+      Ret_Val = QCLI_STATUS_ERROR_E;
+   }
+
+   return(Ret_Val);
+}
+
 /**
    @brief This function will display the group name, recursively displaying
           the name of the groups parents.
@@ -575,6 +742,9 @@ static void Display_Command_List(const Group_List_Entry_t *Group_List_Entry)
          Command_Index ++;
       }
 
+      /* Stats is only reached by name, so it is listed without an index. */
+      QCLI_Printf(MAIN_PRINTF_HANDLE, "        %s\n", Stats_Command.Command_String);
+
       /* Display the command list. */
       if((Group_List_Entry->Command_Group != NULL) && (Group_List_Entry->Command_Group->Command_List != NULL))
       {
@@ -608,74 +778,196 @@ static void Display_Command_List(const Group_List_Entry_t *Group_List_Entry)
 }
 
 /**
-   @brief This function is a wrapper for commands which start in their own
-          thread.
+   @brief This function copies a command and its parameters into a job.
+          The parameters are adjusted to point into the input string of
+          the job.
 
-   @param Thread_Parameter is the parameter specified when the thread was
-          started. It is expected to be a pointer to a Thread_Info_t
-          structure.
+   @param Job is the job to copy the command into.
+   @param Input_String is the input string the parameters point into.
+   @param Command_Index is the index of the command in its associated
+          command group.
+   @param Command is the command to copy.
+   @param Parameter_Count is the number of parameters for the command.
+   @param Parameter_List is the list of parameters for the command.
 */
-static void Command_Thread(void *Thread_Parameter)
+static void Copy_Command_Job(Command_Job_t *Job, const char *Input_String, uint32_t Command_Index, const QCLI_Command_t *Command, uint32_t Parameter_Count, const QCLI_Parameter_t *Parameter_List)
 {
-   uint32_t              Index;
-   Thread_Info_t        *Thread_Info;
-   char                  Input_String[MAXIMUM_QCLI_COMMAND_STRING_LENGTH + 1];
-   QCLI_Parameter_t      Parameter_List[MAXIMUM_NUMBER_OF_PARAMETERS];
-   uint32_t              Parameter_Count;
-   uint32_t              Command_Index;
-   const QCLI_Command_t *Command;
+   uint32_t Index;
 
-   QCLI_Command_Status_t Result;
+   memset(Job->Parameter_List, 0, sizeof(Job->Parameter_List));
+   memscpy(Job->Input_String, sizeof(Job->Input_String), Input_String, MAXIMUM_QCLI_COMMAND_STRING_LENGTH + 1);
 
-   if(Thread_Parameter)
+   if(Parameter_Count != 0)
    {
-      memset(&Parameter_List, 0, sizeof(Parameter_List));
+      memscpy(Job->Parameter_List, sizeof(Job->Parameter_List), Parameter_List, Parameter_Count * sizeof(QCLI_Parameter_t));
+   }
 
-      /* Copy the thread info to local storage. */
-      Thread_Info = (Thread_Info_t*)Thread_Parameter;
-      memscpy(&Input_String, sizeof(Input_String), QCLI_Context.Input_String, sizeof(QCLI_Context.Input_String));
-      memscpy(&Parameter_List, sizeof(Parameter_List), Thread_Info->Parameter_List, Thread_Info->Parameter_Count * sizeof(QCLI_Parameter_t));
-      Parameter_Count = Thread_Info->Parameter_Count;
-      Command         = Thread_Info->Command;
-      Command_Index   = Thread_Info->Command_Index;
+   /* Adjust the pointers in the paramter list for the copied input string. */
+   for(Index = 0; Index < Parameter_Count; Index ++)
+   {
+      Job->Parameter_List[Index].String_Value = Job->Input_String + (Parameter_List[Index].String_Value - Input_String);
+   }
 
-      /* Adjust the pointers in the paramter list for the local input string. */
-      for(Index = 0; Index < Thread_Info->Parameter_Count; Index ++)
-      {
-         Parameter_List[Index].String_Value += (Input_String - QCLI_Context.Input_String);
-      }
+   Job->Command_Index   = Command_Index;
+   Job->Command         = Command;
+   Job->Parameter_Count = Parameter_Count;
+}
 
-      /* Signal that the thread is ready.  The Thread parameter should be
-         considered invalid after this point. */
-      qurt_signal_set(&(Thread_Info->Thread_Ready_Event), THREAD_READY_EVENT_MASK);
+/**
+   @brief This function is the thread of a command worker.  It runs the
+          commands queued for its worker class, one at a time.
 
-      /* Execute the command. */
-      Result = (*(Command->Command_Function))(Parameter_Count, Parameter_List);
+   @param Thread_Parameter is the parameter specified when the thread was
+          started. It is expected to be a pointer to the Worker_Class_t
+          structure of the worker.
+*/
+static void Command_Worker_Thread(void *Thread_Parameter)
+{
+   Worker_Class_t       *Worker_Class;
+   Command_Job_t        *Queued_Job;
+   Command_Job_t         Job;
+   qbool_t               Job_Taken;
+   qurt_time_t           Start_Time;
+   uint32_t              Elapsed_Time;
+   QCLI_Command_Status_t Result;
+
+   Worker_Class = (Worker_Class_t *)Thread_Parameter;
+
+   while(true)
+   {
+      /* Wait for a command to be queued. */
+      qurt_signal_wait(&(Worker_Class->Queue_Event), COMMAND_QUEUED_EVENT_MASK, QURT_SIGNAL_ATTR_WAIT_ANY);
+
+      Job_Taken = false;
 
-      /* Take the mutex before modifying any global variables. */
       if(TAKE_LOCK(QCLI_Context.CLI_Mutex))
       {
-         if(Result == QCLI_STATUS_USAGE_E)
+         /* Another worker may have taken the command already. */
+         if(Worker_Class->Queue_Count != 0)
          {
-            /* Print the usage message. */
-            Display_Usage(Command_Index, Command);
-            QCLI_Display_Prompt();
+            /* Copy the job to local storage so its queue entry can be
+               reused. */
+            Queued_Job = &(Worker_Class->Queue[Worker_Class->Queue_Head]);
+            Copy_Command_Job(&Job, Queued_Job->Input_String, Queued_Job->Command_Index, Queued_Job->Command, Queued_Job->Parameter_Count, Queued_Job->Parameter_List);
+
+            Worker_Class->Queue_Head = (Worker_Class->Queue_Head + 1) % COMMAND_QUEUE_SIZE;
+            Worker_Class->Queue_Count --;
+            Worker_Class->Busy_Count ++;
+
+            Start_Time   = qurt_timer_get_ticks();
+            Elapsed_Time = (uint32_t)qurt_timer_convert_ticks_to_time(Start_Time - Queued_Job->Queue_Time, QURT_TIME_MSEC);
+
+            Worker_Class->Stats.Jobs_Started ++;
+            Worker_Class->Stats.Total_Wait_Time += Elapsed_Time;
+
+            if(Elapsed_Time > Worker_Class->Stats.Max_Wait_Time)
+            {
+               Worker_Class->Stats.Max_Wait_Time = Elapsed_Time;
+            }
+
+            if(Worker_Class->Busy_Count > Worker_Class->Stats.Max_Busy_Count)
+            {
+               Worker_Class->Stats.Max_Busy_Count = Worker_Class->Busy_Count;
+            }
+
+            Job_Taken = true;
          }
 
-         /* Decrement the number of active threads. */
-         QCLI_Context.Thread_Count --;
+         if(Worker_Class->Queue_Count == 0)
+         {
+            qurt_signal_clear(&(Worker_Class->Queue_Event), COMMAND_QUEUED_EVENT_MASK);
+         }
 
          RELEASE_LOCK(QCLI_Context.CLI_Mutex);
       }
+
+      if(Job_Taken)
+      {
+         /* Execute the command. */
+         Result = (*(Job.Command->Command_Function))(Job.Parameter_Count, Job.Parameter_List);
+
+         Elapsed_Time = (uint32_t)qurt_timer_convert_ticks_to_time(qurt_timer_get_ticks() - Start_Time, QURT_TIME_MSEC);
+
+         /* Take the mutex before modifying any global variables. */
+         if(TAKE_LOCK(QCLI_Context.CLI_Mutex))
+         {
+            if(Result == QCLI_STATUS_USAGE_E)
+            {
+               /* Print the usage message. */
+               Display_Usage(Job.Command_Index, Job.Command);
+               QCLI_Display_Prompt();
+            }
+
+            Worker_Class->Busy_Count --;
+
+            Worker_Class->Stats.Jobs_Completed ++;
+            Worker_Class->Stats.Total_Run_Time += Elapsed_Time;
+
+            if(Elapsed_Time > Worker_Class->Stats.Max_Run_Time)
+            {
+               Worker_Class->Stats.Max_Run_Time = Elapsed_Time;
+            }
+
+            RELEASE_LOCK(QCLI_Context.CLI_Mutex);
+         }
+      }
+   }
+}
+
+/**
+   @brief This function creates the command workers of a worker class.
+
+   @param Worker_Class is the worker class to create the workers of.
+   @param Name is the name of the class.
+   @param Stack_Size is the stack size (in bytes) of the workers.
+   @param Worker_Count is the number of workers to create.
+
+   @return
+    - true if all the workers were created.
+    - false if a worker could not be created.
+*/
+static qbool_t Start_Worker_Class(Worker_Class_t *Worker_Class, const char *Name, uint32_t Stack_Size, uint32_t Worker_Count)
+{
+   qbool_t            Ret_Val;
+   qurt_thread_attr_t Thread_Attribte;
+   qurt_thread_t      Thread_Handle;
+   int                Thread_Result;
+
+   Worker_Class->Name       = Name;
+   Worker_Class->Stack_Size = Stack_Size;
+
+   qurt_signal_init(&(Worker_Class->Queue_Event));
+
+   Ret_Val = true;
+
+   while((Ret_Val) && (Worker_Class->Worker_Count < Worker_Count))
+   {
+      qurt_thread_attr_init(&Thread_Attribte);
+      qurt_thread_attr_set_name(&Thread_Attribte, "Command Worker");
+      qurt_thread_attr_set_priority(&Thread_Attribte, COMMAND_THREAD_PRIORITY);
+      qurt_thread_attr_set_stack_size(&Thread_Attribte, Stack_Size);
+      Thread_Result = qurt_thread_create(&Thread_Handle, &Thread_Attribte, Command_Worker_Thread, (void *)Worker_Class);
+
+      if(Thread_Result == QURT_EOK)
+      {
+         Worker_Class->Worker_Count ++;
+      }
+      else
+      {
+         Ret_Val = false;
+      }
    }
 
-   /* Terminate the thread. */
-   qurt_thread_stop();
+   return(Ret_Val);
 }
 
 /**
    @brief This function executes a given command function.
 
+   Commands which start on a thread are queued for a command worker of the
+   class selected by their Start_Thread member.  Other commands are run
+   directly.
+
    @param Command_Index is the index of the command to be executed in its
           associated command group.
    @param command is the information structure for the command to be
@@ -687,53 +979,43 @@ static void Command_Thread(void *Thread_Parameter)
 */
 static void Execute_Command(uint32_t Command_Index, const QCLI_Command_t *Command, uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
 {
-   QCLI_Command_Status_t Result;
-   qurt_thread_attr_t    Thread_Attribte;
-   uint32                Signal_Waiting;
-   qurt_thread_t         Thread_Handle;
-   int                   Thread_Result;
+   QCLI_Command_Status_t  Result;
+   Worker_Class_t        *Worker_Class;
+   Command_Job_t         *Job;
 
    if(Command->Start_Thread)
    {
-      /* Make sure we haven't maxed out the number of supported threads. */
-      if(QCLI_Context.Thread_Count < MAXIMUM_THREAD_COUNT)
+      if(Command->Start_Thread == QCLI_THREAD_LARGE_STACK)
       {
-         QCLI_Context.Thread_Count ++;
-
-         /* Make sure the running event semaphore is taken. */
-         qurt_signal_clear(&QCLI_Context.Thread_Info.Thread_Ready_Event, THREAD_READY_EVENT_MASK);
+         Worker_Class = &(QCLI_Context.Worker_Class[LARGE_WORKER_CLASS]);
+      }
+      else
+      {
+         Worker_Class = &(QCLI_Context.Worker_Class[DEFAULT_WORKER_CLASS]);
+      }
 
-         /* Pass the function to the thread pool. */
-         QCLI_Context.Thread_Info.Command         = Command;
-         QCLI_Context.Thread_Info.Command_Index   = Command_Index;
-         QCLI_Context.Thread_Info.Parameter_Count = Parameter_Count;
-         QCLI_Context.Thread_Info.Parameter_List  = Parameter_List;
+      /* Make sure there is room in the queue of the class. */
+      if(Worker_Class->Queue_Count < COMMAND_QUEUE_SIZE)
+      {
+         Job = &(Worker_Class->Queue[(Worker_Class->Queue_Head + Worker_Class->Queue_Count) % COMMAND_QUEUE_SIZE]);
+         Copy_Command_Job(Job, QCLI_Context.Input_String, Command_Index, Command, Parameter_Count, Parameter_List);
+         Job->Queue_Time = qurt_timer_get_ticks();
 
-         /* Create a thread for the command. */
-         qurt_thread_attr_init(&Thread_Attribte);
-         qurt_thread_attr_set_name(&Thread_Attribte, "Commad Thread");
-         qurt_thread_attr_set_priority(&Thread_Attribte, COMMAND_THREAD_PRIORITY);
-         qurt_thread_attr_set_stack_size(&Thread_Attribte, THREAD_STACK_SIZE);
-         Thread_Result = qurt_thread_create(&Thread_Handle, &Thread_Attribte, Command_Thread, (void *)&(QCLI_Context.Thread_Info));
+         Worker_Class->Queue_Count ++;
 
-         if(Thread_Result == QURT_EOK)
+         if(Worker_Class->Queue_Count > Worker_Class->Stats.Max_Queue_Count)
          {
-            /* Wait for the thread to take over. */
-            if(qurt_signal_wait_timed(&QCLI_Context.Thread_Info.Thread_Ready_Event, THREAD_READY_EVENT_MASK, QURT_SIGNAL_ATTR_WAIT_ANY, &Signal_Waiting, QURT_TIME_WAIT_FOREVER) != QURT_EOK)
-            {
-               QCLI_Printf(MAIN_PRINTF_HANDLE, "Thread failed to start for command.\n");
-            }
+            Worker_Class->Stats.Max_Queue_Count = Worker_Class->Queue_Count;
          }
-         else
-         {
-            QCLI_Printf(MAIN_PRINTF_HANDLE, "Failed to create thread for command (%d).\n", Thread_Result);
 
-            QCLI_Context.Thread_Count --;
-         }
+         /* Wake the workers of the class. */
+         qurt_signal_set(&(Worker_Class->Queue_Event), COMMAND_QUEUED_EVENT_MASK);
       }
       else
       {
-         QCLI_Printf(MAIN_PRINTF_HANDLE, "Max threads reached.\n");
+         Worker_Class->Stats.Jobs_Rejected ++;
+
+         QCLI_Printf(MAIN_PRINTF_HANDLE, "Command queue full.\n");
       }
    }
    else
@@ -756,177 +1038,525 @@ static void Execute_Command(uint32_t Command_Index, const QCLI_Command_t *Comman
 }
 
 /**
-   @brief This function searches the command and/or group lists for a
-          match to the provided parameter.
+   @brief This function calculates the case insensitive hash (FNV-1a) of a
+          command or group name.
 
-   @param Group_List_Entry is the group to search.
-   @param Command_Parameter is the paramter to search for.
-   @param Find_Result is a pointer to where the found entry will be stored
-          if successful (i.e., true was returned).
+   @param String is the name to hash.
+   @param Length is the length of the name.
+
+   @return The hash of the name.
+*/
+static uint32_t Hash_Command_String(const char *String, uint32_t Length)
+{
+   uint32_t Hash;
+   uint8_t  Byte;
+
+   Hash = 2166136261UL;
+
+   while(Length)
+   {
+      /* Fold the case the same way as Memcmpi(). */
+      Byte = (uint8_t)(*String);
+      if((Byte >= 'a') && (Byte <= 'z'))
+      {
+         Byte = Byte - ('a' - 'A');
+      }
+
+      Hash ^= Byte;
+      Hash *= 16777619UL;
+
+      String ++;
+      Length --;
+   }
+
+   return(Hash);
+}
+
+/**
+   @brief This function gets an entry of a group from its command index.
+
+   The command index counts the common commands first, then the group's
+   commands and then its subgroups, in the same order they are displayed
+   by Display_Command_List() (less COMMAND_START_INDEX).
+
+   @param Group_List_Entry is the group the entry belongs to.
+   @param Command_Index is the command index of the entry.
+   @param Find_Result is a pointer to where the entry will be stored if it
+          exists.  This parameter may be NULL if only the name is needed.
 
    @return
-    - true if a matching command or group was found in the list.
-    - false if the command or group was not found.
+    - The name of the entry.
+    - NULL if the command index is not valid for the group.
 */
-static qbool_t Find_Command(Group_List_Entry_t *Group_List_Entry, QCLI_Parameter_t *Command_Parameter, Find_Result_t *Find_Result)
+static const char *Get_Command_Entry(Group_List_Entry_t *Group_List_Entry, uint32_t Command_Index, Find_Result_t *Find_Result)
 {
-   qbool_t               Ret_Val;
-   uint32_t              Index;
-   uint32_t              Command_Index;
-   uint32_t              String_Length;
+   const char           *Ret_Val;
+   const QCLI_Command_t *Command;
    const QCLI_Command_t *Command_List;
    uint32_t              Command_List_Length;
    Group_List_Entry_t   *Subgroup_List_Entry;
 
-   /* Get the size of the string. Include the null byte so the comparison
-      doesn't match substrings. */
-   String_Length = strlen((const char *)(Command_Parameter->String_Value)) + 1;
+   /* Determine which common command list is used by the group. */
+   if(Group_List_Entry == &(QCLI_Context.Root_Group))
+   {
+      Command_List        = Root_Command_List;
+      Command_List_Length = ROOT_COMMAND_LIST_SIZE;
+   }
+   else
+   {
+      Command_List        = Common_Command_List;
+      Command_List_Length = COMMON_COMMAND_LIST_SIZE;
+   }
 
-   if(Group_List_Entry != NULL)
+   Ret_Val = NULL;
+   Command = NULL;
+
+   if(Command_Index < Command_List_Length)
    {
-      /* Determine which common command list is going to be used. */
-      if(Group_List_Entry == &(QCLI_Context.Root_Group))
+      /* Entry is in the common command list. */
+      Command = &(Command_List[Command_Index]);
+   }
+   else
+   {
+      Command_Index -= Command_List_Length;
+
+      if((Group_List_Entry->Command_Group != NULL) && (Command_Index < Group_List_Entry->Command_Group->Command_Count))
       {
-         Command_List        = Root_Command_List;
-         Command_List_Length = ROOT_COMMAND_LIST_SIZE;
+         /* Entry is in the group's command list. */
+         Command = &(Group_List_Entry->Command_Group->Command_List[Command_Index]);
       }
       else
       {
-         Command_List        = Common_Command_List;
-         Command_List_Length = COMMON_COMMAND_LIST_SIZE;
-      }
+         if(Group_List_Entry->Command_Group != NULL)
+         {
+            Command_Index -= Group_List_Entry->Command_Group->Command_Count;
+         }
 
-      if(Command_Parameter->Integer_Is_Valid)
-      {
-         /* Command was specified as an integer. */
-         if(Command_Parameter->Integer_Value >= COMMAND_START_INDEX)
+         if((Group_List_Entry->Command_Index != NULL) && (Command_Index < Group_List_Entry->Command_Index->Subgroup_Count))
          {
-            Command_Index = Command_Parameter->Integer_Value - COMMAND_START_INDEX;
+            /* Entry is in the subgroup list. */
+            Subgroup_List_Entry = Group_List_Entry->Command_Index->Subgroup_Array[Command_Index];
+            Ret_Val             = Subgroup_List_Entry->Command_Group->Group_String;
 
-            /* If the integer is a valid value for the command group, use it. */
-            if(Command_Index < Command_List_Length)
+            if(Find_Result != NULL)
             {
-               /* Command is in the common command list. */
-               Ret_Val                   = true;
-               Find_Result->Is_Group     = false;
-               Find_Result->Data.Command = &(Command_List[Command_Index]);
+               Find_Result->Is_Group              = true;
+               Find_Result->Data.Group_List_Entry = Subgroup_List_Entry;
             }
-            else
-            {
-               Command_Index -= Command_List_Length;
+         }
+      }
+   }
 
-               if((Group_List_Entry->Command_Group != NULL) && (Command_Index < Group_List_Entry->Command_Group->Command_Count))
-               {
-                  /* Command is in the group's command list. */
-                  Ret_Val                   = true;
-                  Find_Result->Is_Group     = false;
-                  Find_Result->Data.Command = &(Group_List_Entry->Command_Group->Command_List[Command_Index]);
-               }
-               else
-               {
-                  if(Group_List_Entry->Command_Group != NULL)
-                  {
-                     Command_Index -= Group_List_Entry->Command_Group->Command_Count;
-                  }
+   if(Command != NULL)
+   {
+      Ret_Val = Command->Command_String;
 
-                  /* Search the group list. */
-                  Group_List_Entry = Group_List_Entry->Subgroup_List;
-                  while((Group_List_Entry != NULL) && (Command_Index != 0))
-                  {
-                     Group_List_Entry = Group_List_Entry->Next_Group_List_Entry;
-                     Command_Index --;
-                  }
+      if(Find_Result != NULL)
+      {
+         Find_Result->Is_Group     = false;
+         Find_Result->Data.Command = Command;
+      }
+   }
 
-                  if(Group_List_Entry != NULL)
-                  {
-                     /* Command is in the subgroup list. */
-                     Ret_Val                            = true;
-                     Find_Result->Is_Group              = true;
-                     Find_Result->Data.Group_List_Entry = Group_List_Entry;
-                  }
-                  else
-                  {
-                     Ret_Val = false;
-                  }
-               }
-            }
+   return(Ret_Val);
+}
+
+/**
+   @brief This function finds the slot of the hash table of a group that
+          holds a name, or the empty slot the name would be added to.
+
+   @param Group_List_Entry is the group to search.  Its index must exist.
+   @param String is the name to search for.  It doesn't need to be NULL
+          terminated.
+   @param Length is the length of the name.
+
+   @return The slot of the hash table.
+*/
+static uint32_t Find_Hash_Slot(Group_List_Entry_t *Group_List_Entry, const char *String, uint32_t Length)
+{
+   Command_Index_t *Index;
+   uint32_t         Slot;
+   const char      *Name;
+
+   Index = Group_List_Entry->Command_Index;
+   Slot  = Hash_Command_String(String, Length) & Index->Hash_Mask;
+
+   /* The table is never more than half full, so an empty slot is always
+      reached. */
+   while(Index->Hash_Table[Slot] != 0)
+   {
+      Name = Get_Command_Entry(Group_List_Entry, Index->Hash_Table[Slot] - 1, NULL);
+
+      if((Memcmpi(String, Name, Length) == 0) && (Name[Length] == '\0'))
+      {
+         break;
+      }
+
+      Slot = (Slot + 1) & Index->Hash_Mask;
+   }
+
+   return(Slot);
+}
+
+/**
+   @brief This function looks up a command or subgroup name in the index
+          of a group.  The comparison is case insensitive.
+
+   @param Group_List_Entry is the group to search.
+   @param String is the name to search for.  It doesn't need to be NULL
+          terminated.
+   @param Length is the length of the name.
+   @param Command_Index is a pointer to where the command index of the
+          entry will be stored if it was found.
+
+   @return
+    - true if the name was found.
+    - false if the name was not found.
+*/
+static qbool_t Lookup_Command(Group_List_Entry_t *Group_List_Entry, const char *String, uint32_t Length, uint32_t *Command_Index)
+{
+   qbool_t  Ret_Val;
+   uint32_t Slot;
+
+   Ret_Val = false;
+
+   if(Group_List_Entry->Command_Index != NULL)
+   {
+      Slot = Find_Hash_Slot(Group_List_Entry, String, Length);
+
+      if(Group_List_Entry->Command_Index->Hash_Table[Slot] != 0)
+      {
+         *Command_Index = Group_List_Entry->Command_Index->Hash_Table[Slot] - 1;
+         Ret_Val        = true;
+      }
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function (re)builds the lookup index of a group from its
+          command lists and subgroup list.
+
+   The existing index is reused if it has room for all the subgroups, so
+   rebuilding the index after a subgroup was removed can't fail.
+
+   @param Group_List_Entry is the group to build the index for.
+
+   @return
+    - true if the index was built.
+    - false if there was not enough memory for the index.
+*/
+static qbool_t Build_Command_Index(Group_List_Entry_t *Group_List_Entry)
+{
+   qbool_t             Ret_Val;
+   Command_Index_t    *Index;
+   Group_List_Entry_t *Subgroup_List_Entry;
+   uint32_t            Subgroup_Count;
+   uint32_t            Entry_Count;
+   uint32_t            Capacity;
+   uint32_t            Table_Size;
+   uint32_t            Command_Index;
+   uint32_t            Slot;
+   const char         *Name;
+
+   /* Count the entries of the group. */
+   Subgroup_Count = 0;
+   for(Subgroup_List_Entry = Group_List_Entry->Subgroup_List; Subgroup_List_Entry != NULL; Subgroup_List_Entry = Subgroup_List_Entry->Next_Group_List_Entry)
+   {
+      Subgroup_Count ++;
+   }
+
+   Entry_Count = (Group_List_Entry == &(QCLI_Context.Root_Group)) ? ROOT_COMMAND_LIST_SIZE : COMMON_COMMAND_LIST_SIZE;
+   if(Group_List_Entry->Command_Group != NULL)
+   {
+      Entry_Count += Group_List_Entry->Command_Group->Command_Count;
+   }
+   Entry_Count += Subgroup_Count;
+
+   Index = Group_List_Entry->Command_Index;
+
+   if((Index == NULL) || (Subgroup_Count > Index->Subgroup_Capacity))
+   {
+      /* Allocate a new index with room for a few more subgroups. The hash
+         table is sized so it is never more than half full. */
+      Capacity   = Subgroup_Count + COMMAND_INDEX_SPARE_SUBGROUPS;
+      Table_Size = 8;
+      while(Table_Size < 2 * (Entry_Count + COMMAND_INDEX_SPARE_SUBGROUPS))
+      {
+         Table_Size <<= 1;
+      }
+
+      Index = (Command_Index_t *)malloc(sizeof(Command_Index_t) + (Capacity * sizeof(Group_List_Entry_t *)) + (Table_Size * sizeof(uint16_t)));
+      if(Index != NULL)
+      {
+         Index->Subgroup_Capacity = Capacity;
+         Index->Hash_Mask         = Table_Size - 1;
+         Index->Subgroup_Array    = (Group_List_Entry_t **)(Index + 1);
+         Index->Hash_Table        = (uint16_t *)(Index->Subgroup_Array + Capacity);
+
+         if(Group_List_Entry->Command_Index != NULL)
+         {
+            free(Group_List_Entry->Command_Index);
          }
-         else
+
+         Group_List_Entry->Command_Index = Index;
+      }
+   }
+
+   if(Index != NULL)
+   {
+      Index->Entry_Count    = Entry_Count;
+      Index->Subgroup_Count = 0;
+
+      for(Subgroup_List_Entry = Group_List_Entry->Subgroup_List; Subgroup_List_Entry != NULL; Subgroup_List_Entry = Subgroup_List_Entry->Next_Group_List_Entry)
+      {
+         Index->Subgroup_Array[Index->Subgroup_Count] = Subgroup_List_Entry;
+         Index->Subgroup_Count ++;
+      }
+
+      memset(Index->Hash_Table, 0, (Index->Hash_Mask + 1) * sizeof(uint16_t));
+
+      /* Add the names in command index order. A name that is already in the
+         table is skipped so the first entry with a name is found, as when
+         the lists were searched in order. */
+      for(Command_Index = 0; Command_Index < Entry_Count; Command_Index ++)
+      {
+         Name = Get_Command_Entry(Group_List_Entry, Command_Index, NULL);
+         Slot = Find_Hash_Slot(Group_List_Entry, Name, strlen(Name));
+
+         if(Index->Hash_Table[Slot] == 0)
          {
-            Ret_Val = false;
+            Index->Hash_Table[Slot] = (uint16_t)(Command_Index + 1);
          }
       }
+
+      Ret_Val = true;
+   }
+   else
+   {
+      Ret_Val = false;
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function adds characters to the end of the current console
+          input, as if they were typed.
+
+   @param String is the characters to add.
+   @param Length is the number of characters to add.
+*/
+static void Append_Input_String(const char *String, uint32_t Length)
+{
+   while((Length) && (QCLI_Context.Input_Length < MAXIMUM_QCLI_COMMAND_STRING_LENGTH))
+   {
+#if ECHO_CHARACTERS
+
+      PAL_Console_Write(1, String);
+
+#endif
+
+      QCLI_Context.Input_String[QCLI_Context.Input_Length] = *String;
+      QCLI_Context.Input_Length++;
+
+      String ++;
+      Length --;
+   }
+}
+
+/**
+   @brief This function completes the last word of the current console
+          input.
+
+   The words before it are followed as subgroups from the current group.
+   If a single command or subgroup name starts with the last word, the word
+   is completed.  If several do, the word is extended to their common
+   prefix, or they are listed if it can't be extended.
+*/
+static void Complete_Command(void)
+{
+   qbool_t             Valid;
+   qbool_t             Done;
+   Group_List_Entry_t *Group_List_Entry;
+   Find_Result_t       Find_Result;
+   uint32_t            Index;
+   uint32_t            Word_Start;
+   uint32_t            Word_Length;
+   uint32_t            Command_Index;
+   uint32_t            Match_Count;
+   uint32_t            Match_Length;
+   uint32_t            Length;
+   const char         *Match;
+   const char         *Name;
+
+   Group_List_Entry = QCLI_Context.Current_Group;
+   Valid            = true;
+   Done             = false;
+   Index            = 0;
+   Word_Start       = 0;
+
+   /* Follow the complete words through the subgroups. */
+   while((Valid) && (!Done))
+   {
+      while((Index < QCLI_Context.Input_Length) && (QCLI_Context.Input_String[Index] == ' '))
+      {
+         Index ++;
+      }
+
+      Word_Start = Index;
+
+      while((Index < QCLI_Context.Input_Length) && (QCLI_Context.Input_String[Index] != ' '))
+      {
+         Index ++;
+      }
+
+      if(Index == QCLI_Context.Input_Length)
+      {
+         /* This is the word to complete. */
+         Done = true;
+      }
       else
       {
-         /* Command was specified as a string. */
-         Command_Index = COMMAND_START_INDEX;
-         Ret_Val       = false;
+         /* Anything but a subgroup means parameters are being entered,
+            which are not completed. */
+         Valid = false;
 
-         /* Search the common command list. */
-         for(Index = 0; (Index < Command_List_Length) && (!Ret_Val); Index ++)
+         if(Lookup_Command(Group_List_Entry, &(QCLI_Context.Input_String[Word_Start]), Index - Word_Start, &Command_Index))
          {
-            if(Memcmpi(Command_Parameter->String_Value, Command_List[Index].Command_String, String_Length) == 0)
-            {
-               /* Command found. */
-               Ret_Val                          = true;
-               Find_Result->Is_Group            = false;
-               Find_Result->Data.Command        = &(Command_List[Index]);
-               Command_Parameter->Integer_Value = Command_Index;
-            }
-            else
+            Get_Command_Entry(Group_List_Entry, Command_Index, &Find_Result);
+
+            if(Find_Result.Is_Group)
             {
-               Command_Index ++;
+               Group_List_Entry = Find_Result.Data.Group_List_Entry;
+               Valid            = true;
             }
          }
+      }
+   }
+
+   if((Valid) && (Group_List_Entry->Command_Index != NULL))
+   {
+      Word_Length  = Index - Word_Start;
+      Match_Count  = 0;
+      Match_Length = 0;
+      Match        = NULL;
 
-         /* Only search the command group if it isn't NULL. */
-         if((!Ret_Val) && (Group_List_Entry->Command_Group != NULL))
+      /* Find the names that start with the word and their common prefix. */
+      for(Command_Index = 0; Command_Index < Group_List_Entry->Command_Index->Entry_Count; Command_Index ++)
+      {
+         Name = Get_Command_Entry(Group_List_Entry, Command_Index, NULL);
+
+         if(Memcmpi(Name, &(QCLI_Context.Input_String[Word_Start]), Word_Length) == 0)
          {
-            /* If the comamnd wasn't found yet, search the group's command list. */
-            for(Index = 0; (Index < Group_List_Entry->Command_Group->Command_Count) && (!Ret_Val); Index ++)
+            if(Match == NULL)
             {
-               if(Memcmpi(Command_Parameter->String_Value, Group_List_Entry->Command_Group->Command_List[Index].Command_String, String_Length) == 0)
-               {
-                  /* Command found. */
-                  Ret_Val                           = true;
-                  Find_Result->Is_Group             = false;
-                  Find_Result->Data.Command         = &(Group_List_Entry->Command_Group->Command_List[Index]);
-                  Command_Parameter->Integer_Value  = Command_Index;
-               }
-               else
+               Match        = Name;
+               Match_Length = strlen(Name);
+            }
+            else
+            {
+               Length = Word_Length;
+               while((Length < Match_Length) && (Memcmpi(&(Match[Length]), &(Name[Length]), 1) == 0))
                {
-                  Command_Index ++;
+                  Length ++;
                }
+
+               Match_Length = Length;
             }
+
+            Match_Count ++;
          }
+      }
+
+      if(Match_Length > Word_Length)
+      {
+         Append_Input_String(&(Match[Word_Length]), Match_Length - Word_Length);
+      }
 
-         if(!Ret_Val)
+      if(Match_Count == 1)
+      {
+         /* The name is complete, move on to the next word. */
+         Append_Input_String(" ", 1);
+      }
+      else
+      {
+         if((Match_Count > 1) && (Match_Length == Word_Length))
          {
-            /* If the comamnd wasn't found yet, search the group's subgroup
-               list. */
-            Subgroup_List_Entry = Group_List_Entry->Subgroup_List;
-            while((Subgroup_List_Entry != NULL) && (!Ret_Val))
+            /* The word is ambiguous, list the names it could be. */
+            QCLI_Printf(MAIN_PRINTF_HANDLE, "\n");
+
+            for(Command_Index = 0; Command_Index < Group_List_Entry->Command_Index->Entry_Count; Command_Index ++)
             {
-               if(Memcmpi(Command_Parameter->String_Value, Subgroup_List_Entry->Command_Group->Group_String, String_Length) == 0)
-               {
-                  /* Command found. */
-                  Ret_Val                            = true;
-                  Find_Result->Is_Group              = true;
-                  Find_Result->Data.Group_List_Entry = Subgroup_List_Entry;
-                  Command_Parameter->Integer_Value   = Command_Index;
-               }
-               else
+               Name = Get_Command_Entry(Group_List_Entry, Command_Index, NULL);
+
+               if(Memcmpi(Name, &(QCLI_Context.Input_String[Word_Start]), Word_Length) == 0)
                {
-                  Command_Index ++;
-                  Subgroup_List_Entry = Subgroup_List_Entry->Next_Group_List_Entry;
+                  QCLI_Printf(MAIN_PRINTF_HANDLE, "   %s\n", Name);
                }
             }
+
+            QCLI_Display_Prompt();
          }
       }
    }
-   else
+}
+
+/**
+   @brief This function searches the command and/or group lists for a
+          match to the provided parameter.
+
+   @param Group_List_Entry is the group to search.
+   @param Command_Parameter is the paramter to search for.
+   @param Find_Result is a pointer to where the found entry will be stored
+          if successful (i.e., true was returned).
+
+   @return
+    - true if a matching command or group was found in the list.
+    - false if the command or group was not found.
+*/
+static qbool_t Find_Command(Group_List_Entry_t *Group_List_Entry, QCLI_Parameter_t *Command_Parameter, Find_Result_t *Find_Result)
+{
+   qbool_t  Ret_Val;
+   uint32_t Command_Index;
+
+   Ret_Val = false;
+
+   if(Group_List_Entry != NULL)
    {
-      Ret_Val = false;
+      if(Command_Parameter->Integer_Is_Valid)
+      {
+         /* Command was specified as an integer. */
+         if((Command_Parameter->Integer_Value >= COMMAND_START_INDEX) && (Get_Command_Entry(Group_List_Entry, Command_Parameter->Integer_Value - COMMAND_START_INDEX, Find_Result) != NULL))
+         {
+            Ret_Val = true;
+         }
+      }
+      else
+      {
+         /* Command was specified as a string, look it up in the group's
+            index. */
+         if(Lookup_Command(Group_List_Entry, Command_Parameter->String_Value, strlen((const char *)(Command_Parameter->String_Value)), &Command_Index))
+         {
+            Get_Command_Entry(Group_List_Entry, Command_Index, Find_Result);
+
+            Command_Parameter->Integer_Value = Command_Index + COMMAND_START_INDEX;
+            Ret_Val                          = true;
+         }
+         else if(Memcmpi(Command_Parameter->String_Value, Stats_Command.Command_String, sizeof("Stats")) == 0)
+         {
+            /* The unnumbered command. */
+            if(Find_Result != NULL)
+            {
+               Find_Result->Is_Group     = false;
+               Find_Result->Data.Command = &Stats_Command;
+            }
+
+            Command_Parameter->Integer_Value = 0;
+            Ret_Val                          = true;
+         }
+      }
    }
 
    return(Ret_Val);
@@ -1139,13 +1769,17 @@ static qbool_t Unregister_Command_Group(Group_List_Entry_t *Group_List_Entry)
 
    if(Group_Is_Valid)
    {
-      /* Unregsiter any subgroups of the command. */
-      Current_Entry = Group_List_Entry->Subgroup_List;
-      Ret_Val       = false;
+      /* Remove the group from the index of its parent. The parent's index
+         is reused, so this can't fail. */
+      Build_Command_Index(Group_List_Entry->Parent_Group);
+
+      /* Unregsiter any subgroups of the command. Each one removes itself
+         from the subgroup list. */
+      Ret_Val = false;
 
-      while(Current_Entry != NULL)
+      while(Group_List_Entry->Subgroup_List != NULL)
       {
-         if(Unregister_Command_Group(Current_Entry))
+         if(Unregister_Command_Group(Group_List_Entry->Subgroup_List))
          {
             Ret_Val = true;
          }
@@ -1159,6 +1793,11 @@ static qbool_t Unregister_Command_Group(Group_List_Entry_t *Group_List_Entry)
       }
 
       /* Free the resources for the group. */
+      if(Group_List_Entry->Command_Index != NULL)
+      {
+         free(Group_List_Entry->Command_Index);
+      }
+
       free(Group_List_Entry);
    }
    else
@@ -1180,6 +1819,8 @@ static qbool_t Unregister_Command_Group(Group_List_Entry_t *Group_List_Entry)
 */
 qbool_t QCLI_Initialize(void)
 {
+   qbool_t Ret_Val;
+
    /* Initialize the context information. */
    memset(&QCLI_Context, 0, sizeof(QCLI_Context));
    QCLI_Context.Current_Group = &(QCLI_Context.Root_Group);
@@ -1187,10 +1828,21 @@ qbool_t QCLI_Initialize(void)
    /* Attempt to create a mutex for the QCLI module. */
    qurt_mutex_init(&(QCLI_Context.CLI_Mutex));
 
-   /* Initialize the thread ready event. */
-   qurt_signal_init(&QCLI_Context.Thread_Info.Thread_Ready_Event);
+   /* Create the command workers. */
+   Ret_Val = Start_Worker_Class(&(QCLI_Context.Worker_Class[DEFAULT_WORKER_CLASS]), "Default", DEFAULT_WORKER_STACK_SIZE, DEFAULT_WORKER_COUNT);
+
+   if(Ret_Val)
+   {
+      Ret_Val = Start_Worker_Class(&(QCLI_Context.Worker_Class[LARGE_WORKER_CLASS]), "Large", LARGE_WORKER_STACK_SIZE, LARGE_WORKER_COUNT);
+   }
+
+   if(Ret_Val)
+   {
+      /* Index the commands of the root group. */
+      Ret_Val = Build_Command_Index(&(QCLI_Context.Root_Group));
+   }
 
-   return(true);
+   return(Ret_Val);
 }
 
 /**
@@ -1250,6 +1902,11 @@ void QCLI_Process_Input_Data(uint32_t Length, char *Buffer)
                      QCLI_Context.Input_String[QCLI_Context.Input_Length] = '\0';
                   }
                }
+               else if(Buffer[0] == '\t')
+               {
+                  /* Complete the command or group name being entered. */
+                  Complete_Command();
+               }
                else
                {
                   /* Check for a valid character, which here is any non control
@@ -1330,6 +1987,7 @@ QCLI_Group_Handle_t QCLI_Register_Command_Group(QCLI_Group_Handle_t Parent_Group
          New_Entry->Command_Group         = Command_Group;
          New_Entry->Next_Group_List_Entry = NULL;
          New_Entry->Subgroup_List         = NULL;
+         New_Entry->Command_Index         = NULL;
 
          if(Parent_Group == NULL)
          {
@@ -1339,22 +1997,31 @@ QCLI_Group_Handle_t QCLI_Register_Command_Group(QCLI_Group_Handle_t Parent_Group
          {
             New_Entry->Parent_Group = (Group_List_Entry_t *)Parent_Group;
          }
-      }
 
-      /* Add the new entry to its parents subgroup list. */
-      if(New_Entry->Parent_Group->Subgroup_List == NULL)
-      {
-         New_Entry->Parent_Group->Subgroup_List = New_Entry;
-      }
-      else
-      {
-         Current_Entry = New_Entry->Parent_Group->Subgroup_List;
-         while(Current_Entry->Next_Group_List_Entry != NULL)
+         /* Add the new entry to its parents subgroup list. */
+         if(New_Entry->Parent_Group->Subgroup_List == NULL)
          {
-            Current_Entry = Current_Entry->Next_Group_List_Entry;
+            New_Entry->Parent_Group->Subgroup_List = New_Entry;
+         }
+         else
+         {
+            Current_Entry = New_Entry->Parent_Group->Subgroup_List;
+            while(Current_Entry->Next_Group_List_Entry != NULL)
+            {
+               Current_Entry = Current_Entry->Next_Group_List_Entry;
+            }
+
+            Current_Entry->Next_Group_List_Entry = New_Entry;
          }
 
-         Current_Entry->Next_Group_List_Entry = New_Entry;
+         /* Index the commands of the new group and add the group to the
+            index of its parent. */
+         if((!Build_Command_Index(New_Entry)) || (!Build_Command_Index(New_Entry->Parent_Group)))
+         {
+            Unregister_Command_Group(New_Entry);
+
+            New_Entry = NULL;
+         }
       }
 
       RELEASE_LOCK(QCLI_Context.CLI_Mutex);
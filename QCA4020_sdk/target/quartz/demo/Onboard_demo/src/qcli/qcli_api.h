@@ -33,6 +33,13 @@
  * Preprocessor Definitions and Constants
  *-----------------------------------------------------------------------*/
 
+/**
+   Value of the Start_Thread member of QCLI_Command_t for commands that
+   need more stack than the default command workers have.  These commands
+   are run by the large stack command workers.
+*/
+#define QCLI_THREAD_LARGE_STACK                                         (2)
+
 /*-------------------------------------------------------------------------
  * Type Declarations
  *-----------------------------------------------------------------------*/
@@ -93,7 +100,7 @@ typedef QCLI_Command_Status_t (*QCLI_Command_Function_t)(uint32_t Parameter_Coun
 typedef struct QCLI_Command_s
 {
    QCLI_Command_Function_t  Command_Function; /** The function that will be called when the command is executed from the CLI. */
-   qbool_t                  Start_Thread;     /** A flag which indicates if the command should start on its own thread.       */
+   qbool_t                  Start_Thread;     /** Run on a command worker (true or QCLI_THREAD_LARGE_STACK).                   */
    const char              *Command_String;   /** The string representation of the function.                                  */
    const char              *Usage_String;     /** The usage string for the command.                                           */
    const char              *Description;      /** The description string for the commmand.                                    */
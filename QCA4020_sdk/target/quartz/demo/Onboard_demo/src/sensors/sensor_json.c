@@ -600,6 +600,21 @@ error:
 #ifdef AWS_IOT
 char token_name[128];
 char sub_token[32];
+
+/**
+ * @func  : copy_token
+ * @breif : copies a token into a buffer, truncated to the buffer size
+ */
+static void copy_token(char *buf, uint32_t size, char *jsonbuf, jsmntok_t *tok)
+{
+    uint32_t len = tok->end - tok->start;
+
+    if (len >= size)
+        len = size - 1;
+    memcpy(buf, jsonbuf + tok->start, len);
+    buf[len] = '\0';
+}
+
 int32_t parse_recived_data(char *jsonbuf)
 {
     int i;
@@ -623,19 +638,21 @@ int32_t parse_recived_data(char *jsonbuf)
     {
         if (t[i].parent == 0)
         {
-            memset(token_name, 0, sizeof(token_name));
-            memcpy(token_name, jsonbuf+t[i].start, t[i].end-t[i].start);
+            copy_token(token_name, sizeof(token_name), jsonbuf, &t[i]);
             LOG_INFO(" Device_name: %s\n", token_name);
         }
 
         if (t[i].parent == 2)
         {
             i = i +2;
-            memset(token_name, 0, sizeof(token_name));
-            memcpy(token_name, jsonbuf+t[i].start, t[i].end-t[i].start);
-
-            memset(sub_token, 0, sizeof(sub_token));
-            memcpy(sub_token, jsonbuf+t[i+1].start, t[i+1].end-t[i+1].start);
+            /* the key and its value must both have been parsed */
+            if (i + 1 >= tokens)
+            {
+                LOG_ERROR("Incomplete json\n");
+                return FAILURE;
+            }
+            copy_token(token_name, sizeof(token_name), jsonbuf, &t[i]);
+            copy_token(sub_token, sizeof(sub_token), jsonbuf, &t[i+1]);
 
             rc = strncmp(DIMMER_ID, token_name, strlen(DIMMER_ID));
 
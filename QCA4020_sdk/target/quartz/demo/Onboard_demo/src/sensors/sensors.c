@@ -363,6 +363,15 @@ int32_t sensors_humidity_get_measured_value(sensor_info_t *sensor_data)
     T1_OUT_val = humidity_read_sensor_reg16(&config_humidity, HUMIDITY_I2C_REG_ADDR_T1_OUT);
     SENSOR_VERBOSE( "register 2's comp T0:%d T1:%d T:%d\n", T0_OUT_val, T1_OUT_val, T_OUT_val);
 
+    // equal calibration points mean the sensor is not answering, the slope would divide by zero
+    if (T1_OUT_val == T0_OUT_val)
+    {
+        SENSOR_ERROR("Invalid temperature calibration\n");
+        sensor_data->s.temp.mantissa = 0;
+        sensor_data->s.temp.exponent = 0;
+        return FAILURE;
+    }
+
     T0_DegCx8_f = T0_DegCx8;
     T1_DegCx8_f = T1_DegCx8;
     T_DegCx8_fx10 = (T1_DegCx8_f - T0_DegCx8_f)  * (T_OUT_val - T0_OUT_val) * 10 / (T1_OUT_val - T0_OUT_val) + T0_DegCx8_f * 10;
@@ -388,6 +397,14 @@ int32_t sensors_humidity_get_measured_value(sensor_info_t *sensor_data)
     H1_T0_OUT_val = humidity_read_sensor_reg16(&config_humidity, HUMIDITY_I2C_REG_ADDR_H1_T0_OUT);
     SENSOR_VERBOSE( "2's comp H0_T0:%d H1_T0:%d H:%d\n", H0_T0_OUT_val, H1_T0_OUT_val, H_OUT_val);
 
+    if (H1_T0_OUT_val == H0_T0_OUT_val)
+    {
+        SENSOR_ERROR("Invalid humidity calibration\n");
+        sensor_data->s.hum.mantissa = 0;
+        sensor_data->s.hum.exponent = 0;
+        return FAILURE;
+    }
+
     H_rHx2_fx10 = (H1_rHx2 - H0_rHx2)  * (H_OUT_val - H0_T0_OUT_val) * 10 / (H1_T0_OUT_val - H0_T0_OUT_val) + H0_rHx2 * 10;
 
     SENSOR_VERBOSE( "rHx2 Hx10:%d\n", H_rHx2_fx10);
@@ -275,6 +275,8 @@ SET CWallSrcs=%CWallSrcs% net\bench_tcp.c
 SET CWallSrcs=%CWallSrcs% net\bench_raw.c
 SET CWallSrcs=%CWallSrcs% net\bench_ssl.c
 SET CWallSrcs=%CWallSrcs% net\bench_uapsd.c
+SET CWallSrcs=%CWallSrcs% net\bench_rr.c
+SET CWallSrcs=%CWallSrcs% net\bench_multi.c
 SET CWallSrcs=%CWallSrcs% net\bench.c
 SET CWallSrcs=%CWallSrcs% net\iperf.c
 SET CWallSrcs=%CWallSrcs% net\eth_raw.c
@@ -935,6 +937,9 @@ IF "%ENABLE_CPU_PROFILER%"=="1" (
     for /f "usebackq" %%A in (`TYPE %SymFileUnpatched% ^| find /v /c "" `) do set libs_numlines=%%A
     set /a "numlines=%demo_numlines%+%libs_numlines%"
     python %ScriptDir%\update_uint32_symbol_value_by_name.py %OutDir%\%Project%_orig.elf %OutDir%\%Project%.elf g_cpu_profiler_number_of_functions %numlines%
+    REM Embed the function addresses for offline profiling
+    python %ScriptDir%\cpuProfilerSymbols.py %OutDir%\%Project%.elf %OutDir%\%Project%.elf
+    if errorlevel 1 goto EndOfFile
 )
 
 REM Hash
@@ -34,6 +34,8 @@
 #include "qurt_error.h"
 #include "qurt_thread.h"
 #include "qurt_signal.h"
+#include "qapi_firmware_upgrade.h"
+#include "qapi_firmware_upgrade_ext.h"
 
 #include "cpu_profiler_demo.h"
 
@@ -66,17 +68,19 @@ QCLI_Command_Status_t cpu_profiler_cli_handler_stop(uint32_t parameters_count, Q
 QCLI_Command_Status_t cpu_profiler_cli_handler_reset(uint32_t parameters_count, QCLI_Parameter_t * parameters);
 QCLI_Command_Status_t cpu_profiler_cli_send_results(uint32_t parameters_count, QCLI_Parameter_t * parameters);
 QCLI_Command_Status_t cpu_profiler_cli_print_results(uint32_t parameters_count, QCLI_Parameter_t * parameters);
+QCLI_Command_Status_t cpu_profiler_cli_dump_stacks(uint32_t parameters_count, QCLI_Parameter_t * parameters);
 
 const QCLI_Command_t cpu_profiler_cmd_list[] =
 {
-    {cpu_profiler_cli_handler_enable, false, "enable", "\n", "enable profiling\n"},
+    {cpu_profiler_cli_handler_enable, false, "enable", "\n", "enable profiling [server_ip server_port]\n"},
     {cpu_profiler_cli_handler_disable, false, "disable", "\n", "disable profiling\n"},
     {cpu_profiler_cli_handler_start, false, "start", "\n", "start profiling\n"},
     {cpu_profiler_cli_handler_stop, false, "stop", "\n", "stop profiling\n"},
     {cpu_profiler_cli_handler_reset, false, "reset", "\n", "reset profiling\n"},
 
-    {cpu_profiler_cli_send_results, false, "send_results", "\n", "send profiling results\n"},
+    {cpu_profiler_cli_send_results, false, "send_results", "\n", "send profiling results [uart|flash|flash_read]\n"},
     {cpu_profiler_cli_print_results, false, "print_results", "\n", "print profiling\n"},
+    {cpu_profiler_cli_dump_stacks, false, "dump_stacks", "\n", "dump and drain the call stack samples\n"},
 };
 
 const QCLI_Command_Group_t cpu_profiler_cmd_group =
@@ -93,6 +97,14 @@ uint32_t g_cpu_profiler_number_of_functions = 1;
 uint32_t * g_cpu_profiler_memory_block = 0;
 uint32_t g_cpu_profiler_memory_block_size = 0;
 
+// Filled in by cpuProfilerSymbols.py after the link. It is volatile so that the compiler
+// does not fold the placeholder values into the code.
+const volatile cpu_profiler_symbol_table_t g_cpu_profiler_symbol_table __attribute__((section(".cpu_profiler.symbols"), used)) = {
+    .magic = CPU_PROFILER_SYMBOL_TABLE_MAGIC,
+    .capacity = CPU_PROFILER_SYMBOL_TABLE_CAPACITY,
+    .count = 0,
+};
+
 
 /*****************************************************************************
  * This function is used to register the Fs Command Group with QCLI.
@@ -196,14 +208,35 @@ static int helper_send_data(int32_t sock, void * buffer, uint32_t bytes_to_send)
 }
 
 
+static void helper_clear_thread_samples(void)
+{
+    memset(g_cpu_profiler_ctxt.thread_info_list, 0, sizeof(g_cpu_profiler_ctxt.thread_info_list));
+    g_cpu_profiler_ctxt.threads_overflow_samples = 0;
+#if ENABLE_MOST_USED_FUNCTIONS_THREAD_ID_LOGGING
+    memset(g_cpu_profiler_ctxt.function_thread_list, 0, sizeof(g_cpu_profiler_ctxt.function_thread_list));
+    g_cpu_profiler_ctxt.pairs_overflow_samples = 0;
+#endif
+}
+
+
 int cpu_profiler_cleanup()
 {
-    memset(g_cpu_profiler_ctxt.function_info_list, 0, MAX_FUNCTION_INFO_LIST_LENGTH*sizeof(g_cpu_profiler_ctxt.function_info_list[0]));
-    g_cpu_profiler_ctxt.function_info_list_length = 0;
+    helper_clear_thread_samples();
     if ( g_cpu_profiler_ctxt.function_samples ) {
         free(g_cpu_profiler_ctxt.function_samples);
         g_cpu_profiler_ctxt.function_samples = 0;
     }
+    if ( g_cpu_profiler_ctxt.page_table ) {
+        free(g_cpu_profiler_ctxt.page_table);
+        g_cpu_profiler_ctxt.page_table = 0;
+    }
+    g_cpu_profiler_ctxt.regions_count = 0;
+    if ( g_cpu_profiler_ctxt.stack_samples ) {
+        free(g_cpu_profiler_ctxt.stack_samples);
+        g_cpu_profiler_ctxt.stack_samples = 0;
+    }
+    g_cpu_profiler_ctxt.stack_samples_count = 0;
+    g_cpu_profiler_ctxt.stack_depth = 0;
 #if 0
     if ( g_cpu_profiler_ctxt.function_addresses ) {
         free(g_cpu_profiler_ctxt.function_addresses);
@@ -214,6 +247,7 @@ int cpu_profiler_cleanup()
         qapi_socketclose(g_cpu_profiler_ctxt.sock);
         g_cpu_profiler_ctxt.sock = QAPI_ERROR;
     }
+    g_cpu_profiler_ctxt.offline = 0;
 
     return 0;
 }
@@ -239,15 +273,146 @@ extern uint32_t vectTable[255];
 extern void cpu_profiler_interrupt_irq_handler(void);
 
 int cpu_profiler_is_enabled() {
-    return ( QAPI_ERROR != g_cpu_profiler_ctxt.sock );
+    return ( (QAPI_ERROR != g_cpu_profiler_ctxt.sock) || g_cpu_profiler_ctxt.offline );
 }
 
 
-int cpu_profiler_start(uint32_t time_between_samples_in_us, uint32_t time_to_run_profiler_in_seconds)
+// Builds the PC to function lookup used by cpu_profiler_timer_isr() (see cpu_profiler_demo.h).
+// function_addresses are sorted, so each region is a run of functions without a large gap.
+static int helper_build_lookup_table(void)
+{
+    const uint32_t * addresses = g_cpu_profiler_ctxt.function_addresses;
+    uint32_t functions_count = g_cpu_profiler_ctxt.functions_count;
+    cpu_profiler_region_t * p_region;
+    uint32_t total_span = 0;
+    uint32_t total_pages = 0;
+    uint32_t page_shift;
+    uint32_t i;
+    uint32_t r;
+
+    if ( 0 == functions_count ) {
+        return -1;
+    }
+
+    // split the functions into regions
+    memset(g_cpu_profiler_ctxt.regions, 0, sizeof(g_cpu_profiler_ctxt.regions));
+    g_cpu_profiler_ctxt.regions_count = 1;
+    p_region = &g_cpu_profiler_ctxt.regions[0];
+    p_region->start_address = addresses[0];
+    p_region->first_index = 0;
+    for ( i = 1; i < functions_count; i++ ) {
+        if ( addresses[i] < addresses[i - 1] ) {
+            CPU_PROFILER_DEMO_PRINTF("Function addresses are not sorted at index %d\r\n", i);
+            return -1;
+        }
+        if ( ((addresses[i] - addresses[i - 1]) > CPU_PROFILER_REGION_GAP) &&
+             (g_cpu_profiler_ctxt.regions_count < CPU_PROFILER_MAX_REGIONS) )
+        {
+            p_region->last_index = i - 1;
+            p_region++;
+            p_region->start_address = addresses[i];
+            p_region->first_index = i;
+            g_cpu_profiler_ctxt.regions_count++;
+        }
+    }
+    p_region->last_index = functions_count - 1;
+
+    for ( r = 0; r < g_cpu_profiler_ctxt.regions_count; r++ ) {
+        p_region = &g_cpu_profiler_ctxt.regions[r];
+        total_span += addresses[p_region->last_index] - p_region->start_address + 1;
+    }
+
+    // smallest page size that keeps the table within CPU_PROFILER_MAX_PAGES
+    for ( page_shift = CPU_PROFILER_MIN_PAGE_SHIFT; page_shift < 31; page_shift++ ) {
+        total_pages = 0;
+        for ( r = 0; r < g_cpu_profiler_ctxt.regions_count; r++ ) {
+            p_region = &g_cpu_profiler_ctxt.regions[r];
+            uint32_t base_address = p_region->start_address & ~((1u << page_shift) - 1);
+            total_pages += ((addresses[p_region->last_index] - base_address) >> page_shift) + 1;
+        }
+        if ( total_pages <= CPU_PROFILER_MAX_PAGES ) {
+            break;
+        }
+    }
+
+    if ( g_cpu_profiler_ctxt.page_table ) {
+        free(g_cpu_profiler_ctxt.page_table);
+    }
+    g_cpu_profiler_ctxt.page_table = (uint32_t *) malloc(total_pages * sizeof(uint32_t));
+    if ( !g_cpu_profiler_ctxt.page_table ) {
+        CPU_PROFILER_DEMO_PRINTF("Failed to allocate page_table (%d pages)\r\n", total_pages);
+        return -1;
+    }
+    g_cpu_profiler_ctxt.page_shift = page_shift;
+
+    // fill each page with the function covering its start address
+    uint32_t page = 0;
+    for ( r = 0; r < g_cpu_profiler_ctxt.regions_count; r++ ) {
+        p_region = &g_cpu_profiler_ctxt.regions[r];
+        p_region->base_address = p_region->start_address & ~((1u << page_shift) - 1);
+        p_region->first_page = page;
+        p_region->pages_count = ((addresses[p_region->last_index] - p_region->base_address) >> page_shift) + 1;
+
+        uint32_t index = p_region->first_index;
+        for ( i = 0; i < p_region->pages_count; i++ ) {
+            uint32_t page_address = p_region->base_address + (i << page_shift);
+            while ( (index < p_region->last_index) && (addresses[index + 1] <= page_address) ) {
+                index++;
+            }
+            g_cpu_profiler_ctxt.page_table[page++] = index;
+        }
+    }
+
+    CPU_PROFILER_DEMO_PRINTF(
+        "Lookup table: %d functions, %d regions, %d pages of %d bytes (%d bytes of code)\r\n",
+        functions_count,
+        g_cpu_profiler_ctxt.regions_count,
+        total_pages,
+        1 << page_shift,
+        total_span
+        );
+
+    return 0;
+}
+
+
+int cpu_profiler_start(
+    uint32_t time_between_samples_in_us,
+    uint32_t time_to_run_profiler_in_seconds,
+    uint32_t stack_depth,
+    uint32_t stack_samples_count
+    )
 {
     // the APSS_TM runs at 32MHz => each us = 32 ticks
     uint32_t sampling_period = 32 * time_between_samples_in_us;
 
+    if ( !g_cpu_profiler_ctxt.page_table ) {
+        if ( 0 != helper_build_lookup_table() ) {
+            return -1;
+        }
+    }
+
+    // the stack ring is kept across runs until it is drained or its size changes
+    g_cpu_profiler_ctxt.stack_depth = 0;
+    if ( stack_depth ) {
+        if ( stack_samples_count != g_cpu_profiler_ctxt.stack_samples_count ) {
+            if ( g_cpu_profiler_ctxt.stack_samples ) {
+                free(g_cpu_profiler_ctxt.stack_samples);
+            }
+            g_cpu_profiler_ctxt.stack_samples_count = 0;
+            g_cpu_profiler_ctxt.stack_samples = (cpu_profiler_stack_sample_t *) malloc(stack_samples_count * sizeof(cpu_profiler_stack_sample_t));
+            if ( !g_cpu_profiler_ctxt.stack_samples ) {
+                CPU_PROFILER_DEMO_PRINTF("Failed to allocate %d stack samples\r\n", stack_samples_count);
+                return -1;
+            }
+            g_cpu_profiler_ctxt.stack_samples_count = stack_samples_count;
+            g_cpu_profiler_ctxt.stack_samples_head = 0;
+            g_cpu_profiler_ctxt.stack_samples_tail = 0;
+            g_cpu_profiler_ctxt.stack_samples_dropped = 0;
+        }
+        g_cpu_profiler_ctxt.stack_depth = stack_depth;
+    }
+
     g_cpu_profiler_ctxt.count_of_pcs_captured = 0;
     g_cpu_profiler_ctxt.count_of_pcs_to_capture = 1000 * 1000 * time_to_run_profiler_in_seconds / time_between_samples_in_us;
 
@@ -285,15 +450,6 @@ int cpu_profiler_stop()
 
     IRQ_Enable();
 
-
-    int i;
-    for ( i = 0; i < g_cpu_profiler_ctxt.function_info_list_length; i++ ) {
-        function_info_t * p_function_info = &g_cpu_profiler_ctxt.function_info_list[i];
-        p_function_info->count += g_cpu_profiler_ctxt.function_samples[p_function_info->index];
-        g_cpu_profiler_ctxt.function_samples[p_function_info->index] = 0;
-    }
-
-
     return 0;
 }
 
@@ -309,8 +465,11 @@ int cpu_profiler_reset()
     }
 
 
-    memset(g_cpu_profiler_ctxt.function_info_list, 0, MAX_FUNCTION_INFO_LIST_LENGTH*sizeof(g_cpu_profiler_ctxt.function_info_list[0]));
-    g_cpu_profiler_ctxt.function_info_list_length = 0;
+    helper_clear_thread_samples();
+
+    g_cpu_profiler_ctxt.stack_samples_head = 0;
+    g_cpu_profiler_ctxt.stack_samples_tail = 0;
+    g_cpu_profiler_ctxt.stack_samples_dropped = 0;
 
     g_cpu_profiler_ctxt.count_of_pcs_captured = 0;
 
@@ -392,7 +551,7 @@ int cpu_profiler_helper_connect_to_server_and_retrive_list_of_functions(uint32_t
     memset(g_cpu_profiler_ctxt.function_addresses, 0, type_length_header.length);
 
     uint32_t function_samples_size = g_cpu_profiler_ctxt.functions_count*sizeof(g_cpu_profiler_ctxt.function_samples[0]);
-    g_cpu_profiler_ctxt.function_samples = (uint16_t *) malloc(function_samples_size);
+    g_cpu_profiler_ctxt.function_samples = (uint32_t *) malloc(function_samples_size);
     if ( !g_cpu_profiler_ctxt.function_samples ) {
         CPU_PROFILER_DEMO_PRINTF("Failed to allocate function_samples\r\n");
         goto cpu_profiler_helper_connect_to_server_and_retrive_list_of_functions_on_error;
@@ -417,6 +576,35 @@ cpu_profiler_helper_connect_to_server_and_retrive_list_of_functions_on_error:
 
 
 
+int cpu_profiler_helper_use_embedded_symbol_table()
+{
+    uint32_t count = g_cpu_profiler_symbol_table.count;
+
+    if ( (CPU_PROFILER_SYMBOL_TABLE_MAGIC != g_cpu_profiler_symbol_table.magic) || (0 == count) ) {
+        CPU_PROFILER_DEMO_PRINTF("No embedded symbol table, run cpuProfilerSymbols.py on the ELF after the link\r\n");
+        return -1;
+    }
+    if ( count > g_cpu_profiler_symbol_table.capacity ) {
+        CPU_PROFILER_DEMO_PRINTF("Embedded symbol table is corrupted, count=%d\r\n", count);
+        return -1;
+    }
+
+    g_cpu_profiler_ctxt.functions_count = count;
+    g_cpu_profiler_ctxt.function_addresses = (uint32_t *) g_cpu_profiler_symbol_table.addresses;
+
+    uint32_t function_samples_size = count * sizeof(g_cpu_profiler_ctxt.function_samples[0]);
+    g_cpu_profiler_ctxt.function_samples = (uint32_t *) malloc(function_samples_size);
+    if ( !g_cpu_profiler_ctxt.function_samples ) {
+        CPU_PROFILER_DEMO_PRINTF("Failed to allocate function_samples\r\n");
+        return -1;
+    }
+    memset(g_cpu_profiler_ctxt.function_samples, 0, function_samples_size);
+
+    g_cpu_profiler_ctxt.offline = 1;
+    return 0;
+}
+
+
 QCLI_Command_Status_t cpu_profiler_cli_handler_enable(uint32_t parameters_count, QCLI_Parameter_t * parameters)
 {
     if ( cpu_profiler_is_enabled() )
@@ -430,9 +618,20 @@ QCLI_Command_Status_t cpu_profiler_cli_handler_enable(uint32_t parameters_count,
     uint32_t server_ip;
     uint32_t server_port;
 
+    // Without a server, use the symbol table embedded in flash
+    if ( 0 == parameters_count ) {
+        status = cpu_profiler_helper_use_embedded_symbol_table();
+        if ( 0 != status ) {
+            goto cpu_profiler_cli_handler_enable_on_error;
+        }
+        helper_clear_thread_samples();
+        CPU_PROFILER_DEMO_PRINTF("CpuProfiler enabled offline, %d functions\r\n", g_cpu_profiler_ctxt.functions_count);
+        return QCLI_STATUS_SUCCESS_E;
+    }
+
     // Extract log server IP address and port from the CLI parameters
     if ( 2 != parameters_count ) {
-        CPU_PROFILER_DEMO_PRINTF("Invalid number of arguments, must be exactly 2\r\n");
+        CPU_PROFILER_DEMO_PRINTF("Invalid number of arguments, must be 0 or 2\r\n");
         goto cpu_profiler_cli_handler_enable_on_error;
     }
 
@@ -454,14 +653,14 @@ QCLI_Command_Status_t cpu_profiler_cli_handler_enable(uint32_t parameters_count,
         goto cpu_profiler_cli_handler_enable_on_error;
     }
 
-    memset(g_cpu_profiler_ctxt.function_info_list, 0, MAX_FUNCTION_INFO_LIST_LENGTH*sizeof(g_cpu_profiler_ctxt.function_info_list[0]));
-    g_cpu_profiler_ctxt.function_info_list_length = 0;
+    helper_clear_thread_samples();
 
     return QCLI_STATUS_SUCCESS_E;
 
 cpu_profiler_cli_handler_enable_on_error:
     cpu_profiler_cleanup();
-    CPU_PROFILER_DEMO_PRINTF("Usage: enable server_ip server_port\r\n");
+    CPU_PROFILER_DEMO_PRINTF("Usage: enable [server_ip server_port]\r\n");
+    CPU_PROFILER_DEMO_PRINTF("\twithout a server the symbol table embedded in the image is used\r\n");
     return QCLI_STATUS_ERROR_E;
 }
 
@@ -504,9 +703,13 @@ QCLI_Command_Status_t cpu_profiler_cli_handler_start(uint32_t parameters_count,
     // list of parameters:
     // 1st: us_between_samples
     // 2nd: time in seconds to run the profiler
+    // 3rd: call stack depth to record, 0 to record no call stacks
+    // 4th: number of call stack samples the ring holds
 
     uint32_t time_between_samples_in_us = 50;
     uint32_t time_to_run_profiler_in_seconds = 5;
+    uint32_t stack_depth = 0;
+    uint32_t stack_samples_count = CPU_PROFILER_DEFAULT_STACK_SAMPLES;
 
     if ( parameters_count > 0 )
     {
@@ -528,7 +731,27 @@ QCLI_Command_Status_t cpu_profiler_cli_handler_start(uint32_t parameters_count,
         }
     }
 
-    status = cpu_profiler_start(time_between_samples_in_us, time_to_run_profiler_in_seconds);
+    if ( parameters_count > 2 )
+    {
+        if ( parameters[2].Integer_Is_Valid && (parameters[2].Integer_Value >= 0) && (parameters[2].Integer_Value <= CPU_PROFILER_MAX_STACK_DEPTH) ) {
+            stack_depth = parameters[2].Integer_Value;
+        }
+        else {
+            goto cpu_profiler_cli_handler_start_on_error;
+        }
+    }
+
+    if ( parameters_count > 3 )
+    {
+        if ( parameters[3].Integer_Is_Valid && (parameters[3].Integer_Value > 0) ) {
+            stack_samples_count = parameters[3].Integer_Value;
+        }
+        else {
+            goto cpu_profiler_cli_handler_start_on_error;
+        }
+    }
+
+    status = cpu_profiler_start(time_between_samples_in_us, time_to_run_profiler_in_seconds, stack_depth, stack_samples_count);
     if ( 0 != status ) {
         CPU_PROFILER_DEMO_PRINTF("Failed on a call to cpu_profiler_start(), status=%d\r\n", status);
     }
@@ -536,9 +759,11 @@ QCLI_Command_Status_t cpu_profiler_cli_handler_start(uint32_t parameters_count,
     return QCLI_STATUS_SUCCESS_E;
 
 cpu_profiler_cli_handler_start_on_error:
-    CPU_PROFILER_DEMO_PRINTF("Usage: start <time_between_samples_in_us> <time_to_run_profiler_in_seconds>\r\n");
+    CPU_PROFILER_DEMO_PRINTF("Usage: start <time_between_samples_in_us> <time_to_run_profiler_in_seconds> [<stack_depth> [<stack_samples>]]\r\n");
     CPU_PROFILER_DEMO_PRINTF("\t<time_between_samples_in_us>: time in us between each PC (default=50us),\r\n");
     CPU_PROFILER_DEMO_PRINTF("\t<profiling_duration>: time in seconds to run the profiler (defaults=5s),\r\n");
+    CPU_PROFILER_DEMO_PRINTF("\t<stack_depth>: call stack depth to record, 0 to %d (default=0, no call stacks),\r\n", CPU_PROFILER_MAX_STACK_DEPTH);
+    CPU_PROFILER_DEMO_PRINTF("\t<stack_samples>: call stack samples held until dump_stacks (default=%d),\r\n", CPU_PROFILER_DEFAULT_STACK_SAMPLES);
     return QCLI_STATUS_ERROR_E;
 }
 
@@ -569,14 +794,266 @@ QCLI_Command_Status_t cpu_profiler_cli_handler_reset(uint32_t parameters_count,
 }
 
 
+// Prints the non zero function counters and the thread counters over the console, the
+// format read by cpu_profiler_symbolize.py:
+//   results <functions_count> <total_samples>
+//   sample <function_address> <samples>
+//   thread <thread_id> <samples>
+//   results_end
+static void helper_print_results_header(uint32_t functions_count, uint32_t total_samples)
+{
+    CPU_PROFILER_DEMO_PRINTF("results %d %d\r\n", functions_count, total_samples);
+}
+
+
+static int helper_spool_results_to_uart(void)
+{
+    uint32_t total_samples = 0;
+    uint32_t i;
+
+    for ( i = 0; i < g_cpu_profiler_ctxt.functions_count; i++ ) {
+        total_samples += g_cpu_profiler_ctxt.function_samples[i];
+    }
+
+    helper_print_results_header(g_cpu_profiler_ctxt.functions_count, total_samples);
+    for ( i = 0; i < g_cpu_profiler_ctxt.functions_count; i++ ) {
+        if ( g_cpu_profiler_ctxt.function_samples[i] ) {
+            CPU_PROFILER_DEMO_PRINTF("sample %08x %d\r\n", g_cpu_profiler_ctxt.function_addresses[i], g_cpu_profiler_ctxt.function_samples[i]);
+        }
+    }
+    for ( i = 0; i < CPU_PROFILER_MAX_THREADS; i++ ) {
+        if ( g_cpu_profiler_ctxt.thread_info_list[i].count ) {
+            CPU_PROFILER_DEMO_PRINTF("thread %08x %d\r\n", g_cpu_profiler_ctxt.thread_info_list[i].thread_id, g_cpu_profiler_ctxt.thread_info_list[i].count);
+        }
+    }
+    CPU_PROFILER_DEMO_PRINTF("results_end\r\n");
+
+    return 0;
+}
+
+
+typedef struct flash_spool_s {
+    qapi_Part_Hdl_t partition;
+    uint32_t offset;
+    uint32_t words;
+    uint32_t buffer[MAX_COUNTERS_TO_SEND_AT_ONCE];
+} flash_spool_t;
+
+
+static int helper_flash_spool_flush(flash_spool_t * p_spool)
+{
+    if ( p_spool->words ) {
+        uint32_t bytes = p_spool->words * sizeof(uint32_t);
+        if ( QAPI_OK != qapi_Fw_Upgrade_Write_Partition(p_spool->partition, p_spool->offset, (char *) p_spool->buffer, bytes) ) {
+            CPU_PROFILER_DEMO_PRINTF("Failed to write the flash log partition at offset %d\r\n", p_spool->offset);
+            return -1;
+        }
+        p_spool->offset += bytes;
+        p_spool->words = 0;
+    }
+    return 0;
+}
+
+
+static int helper_flash_spool_pair(flash_spool_t * p_spool, uint32_t first, uint32_t second)
+{
+    p_spool->buffer[p_spool->words++] = first;
+    p_spool->buffer[p_spool->words++] = second;
+    if ( p_spool->words == MAX_COUNTERS_TO_SEND_AT_ONCE ) {
+        return helper_flash_spool_flush(p_spool);
+    }
+    return 0;
+}
+
+
+static int helper_open_flash_log_partition(qapi_Part_Hdl_t * p_partition, uint32_t * p_partition_size)
+{
+    if ( QAPI_OK != qapi_Fw_Upgrade_init() ) {
+        CPU_PROFILER_DEMO_PRINTF("Failed on a call to qapi_Fw_Upgrade_init()\r\n");
+        return -1;
+    }
+    if ( QAPI_OK != qapi_Fw_Upgrade_Find_Partition(qapi_Fw_Upgrade_Get_Active_FWD(NULL, NULL), CPU_PROFILER_FLASH_LOG_PARTITION_ID, p_partition) ) {
+        CPU_PROFILER_DEMO_PRINTF("No flash log partition in the active FWD\r\n");
+        return -1;
+    }
+    if ( QAPI_OK != qapi_Fw_Upgrade_Get_Partition_Size(*p_partition, p_partition_size) ) {
+        qapi_Fw_Upgrade_Close_Partition(*p_partition);
+        CPU_PROFILER_DEMO_PRINTF("Failed to get the flash log partition size\r\n");
+        return -1;
+    }
+    return 0;
+}
+
+
+static int helper_spool_results_to_flash(void)
+{
+    cpu_profiler_flash_record_t record;
+    uint32_t partition_size = 0;
+    uint32_t i;
+    int status = -1;
+
+    memset(&record, 0, sizeof(record));
+    record.magic = CPU_PROFILER_FLASH_RECORD_MAGIC;
+    record.functions_count = g_cpu_profiler_ctxt.functions_count;
+    for ( i = 0; i < g_cpu_profiler_ctxt.functions_count; i++ ) {
+        if ( g_cpu_profiler_ctxt.function_samples[i] ) {
+            record.function_entries++;
+            record.total_samples += g_cpu_profiler_ctxt.function_samples[i];
+        }
+    }
+    for ( i = 0; i < CPU_PROFILER_MAX_THREADS; i++ ) {
+        if ( g_cpu_profiler_ctxt.thread_info_list[i].count ) {
+            record.thread_entries++;
+        }
+    }
+
+    flash_spool_t * p_spool = (flash_spool_t *) malloc(sizeof(flash_spool_t));
+    if ( !p_spool ) {
+        CPU_PROFILER_DEMO_PRINTF("Failed to allocate p_spool\r\n");
+        return -1;
+    }
+    memset(p_spool, 0, sizeof(flash_spool_t));
+
+    if ( 0 != helper_open_flash_log_partition(&p_spool->partition, &partition_size) ) {
+        free(p_spool);
+        return -1;
+    }
+
+    uint32_t record_size = sizeof(record) + 2 * sizeof(uint32_t) * (record.function_entries + record.thread_entries);
+    if ( record_size > partition_size ) {
+        CPU_PROFILER_DEMO_PRINTF("Results (%d bytes) do not fit in the flash log partition (%d bytes)\r\n", record_size, partition_size);
+        goto helper_spool_results_to_flash_done;
+    }
+
+    if ( QAPI_OK != qapi_Fw_Upgrade_Erase_Partition(p_spool->partition, 0, partition_size) ) {
+        CPU_PROFILER_DEMO_PRINTF("Failed to erase the flash log partition\r\n");
+        goto helper_spool_results_to_flash_done;
+    }
+
+    // the header goes last, so an interrupted spool leaves no valid record
+    p_spool->offset = sizeof(record);
+    for ( i = 0; i < g_cpu_profiler_ctxt.functions_count; i++ ) {
+        if ( g_cpu_profiler_ctxt.function_samples[i] ) {
+            if ( 0 != helper_flash_spool_pair(p_spool, g_cpu_profiler_ctxt.function_addresses[i], g_cpu_profiler_ctxt.function_samples[i]) ) {
+                goto helper_spool_results_to_flash_done;
+            }
+        }
+    }
+    for ( i = 0; i < CPU_PROFILER_MAX_THREADS; i++ ) {
+        if ( g_cpu_profiler_ctxt.thread_info_list[i].count ) {
+            if ( 0 != helper_flash_spool_pair(p_spool, g_cpu_profiler_ctxt.thread_info_list[i].thread_id, g_cpu_profiler_ctxt.thread_info_list[i].count) ) {
+                goto helper_spool_results_to_flash_done;
+            }
+        }
+    }
+    if ( 0 != helper_flash_spool_flush(p_spool) ) {
+        goto helper_spool_results_to_flash_done;
+    }
+
+    if ( QAPI_OK != qapi_Fw_Upgrade_Write_Partition(p_spool->partition, 0, (char *) &record, sizeof(record)) ) {
+        CPU_PROFILER_DEMO_PRINTF("Failed to write the flash log record header\r\n");
+        goto helper_spool_results_to_flash_done;
+    }
+
+    CPU_PROFILER_DEMO_PRINTF("Results spooled to flash, %d bytes\r\n", record_size);
+    status = 0;
+
+helper_spool_results_to_flash_done:
+    qapi_Fw_Upgrade_Close_Partition(p_spool->partition);
+    free(p_spool);
+    return status;
+}
+
+
+// Prints the results spooled to flash, possibly by an earlier boot, in the same format
+// as helper_spool_results_to_uart()
+static int helper_print_flash_results(void)
+{
+    cpu_profiler_flash_record_t record;
+    qapi_Part_Hdl_t partition;
+    uint32_t partition_size = 0;
+    uint32_t buffer[MAX_COUNTERS_TO_SEND_AT_ONCE / 4];
+    uint32_t bytes_read;
+    uint32_t offset;
+    uint32_t entries;
+    uint32_t entry;
+    int status = -1;
+
+    if ( 0 != helper_open_flash_log_partition(&partition, &partition_size) ) {
+        return -1;
+    }
+
+    if ( (QAPI_OK != qapi_Fw_Upgrade_Read_Partition(partition, 0, (char *) &record, sizeof(record), &bytes_read)) ||
+         (sizeof(record) != bytes_read) ||
+         (CPU_PROFILER_FLASH_RECORD_MAGIC != record.magic) ||
+         ((sizeof(record) + 2 * sizeof(uint32_t) * (record.function_entries + record.thread_entries)) > partition_size) )
+    {
+        CPU_PROFILER_DEMO_PRINTF("No profiling results in the flash log partition\r\n");
+        goto helper_print_flash_results_done;
+    }
+
+    helper_print_results_header(record.functions_count, record.total_samples);
+
+    offset = sizeof(record);
+    entries = record.function_entries + record.thread_entries;
+    entry = 0;
+    while ( entry < entries ) {
+        uint32_t pairs = MIN((entries - entry), (sizeof(buffer) / (2 * sizeof(uint32_t))));
+        uint32_t j;
+        if ( (QAPI_OK != qapi_Fw_Upgrade_Read_Partition(partition, offset, (char *) buffer, pairs * 2 * sizeof(uint32_t), &bytes_read)) ||
+             (bytes_read != pairs * 2 * sizeof(uint32_t)) )
+        {
+            CPU_PROFILER_DEMO_PRINTF("Failed to read the flash log partition at offset %d\r\n", offset);
+            goto helper_print_flash_results_done;
+        }
+        for ( j = 0; j < pairs; j++, entry++ ) {
+            CPU_PROFILER_DEMO_PRINTF(
+                "%s %08x %d\r\n",
+                (entry < record.function_entries) ? "sample" : "thread",
+                buffer[2 * j],
+                buffer[2 * j + 1]
+                );
+        }
+        offset += bytes_read;
+    }
+    CPU_PROFILER_DEMO_PRINTF("results_end\r\n");
+    status = 0;
+
+helper_print_flash_results_done:
+    qapi_Fw_Upgrade_Close_Partition(partition);
+    return status;
+}
+
+
 QCLI_Command_Status_t cpu_profiler_cli_send_results(uint32_t parameters_count, QCLI_Parameter_t * parameters)
 {
+    int status;
+
+    // results spooled by an earlier boot can be read without enabling the profiler
+    if ( (parameters_count > 0) && (0 == strcmp(parameters[0].String_Value, "flash_read")) ) {
+        status = helper_print_flash_results();
+        return ( 0 == status ) ? QCLI_STATUS_SUCCESS_E : QCLI_STATUS_ERROR_E;
+    }
+
     if ( !cpu_profiler_is_enabled() ) {
         CPU_PROFILER_DEMO_PRINTF("Must enable the cpu_profiler first\r\n");
         return QCLI_STATUS_ERROR_E;
     }
 
-    int status;
+    // without a server the results go to the console unless the flash is asked for
+    if ( (parameters_count > 0) || (QAPI_ERROR == g_cpu_profiler_ctxt.sock) ) {
+        if ( (0 == parameters_count) || (0 == strcmp(parameters[0].String_Value, "uart")) ) {
+            status = helper_spool_results_to_uart();
+        }
+        else if ( 0 == strcmp(parameters[0].String_Value, "flash") ) {
+            status = helper_spool_results_to_flash();
+        }
+        else {
+            CPU_PROFILER_DEMO_PRINTF("Usage: send_results [uart|flash|flash_read]\r\n");
+            return QCLI_STATUS_ERROR_E;
+        }
+        return ( 0 == status ) ? QCLI_STATUS_SUCCESS_E : QCLI_STATUS_ERROR_E;
+    }
 
     // sends results to the server
     type_length_t type_length_header;
@@ -602,15 +1079,7 @@ QCLI_Command_Status_t cpu_profiler_cli_send_results(uint32_t parameters_count, Q
         uint32_t elements_to_send = MIN(max_buffer_elements_count, (g_cpu_profiler_ctxt.functions_count-i));
         uint32_t j;
         for ( j = 0; j < elements_to_send; j++ ) {
-            uint32_t sample_index = i + j;
-            p_buffer[j] = g_cpu_profiler_ctxt.function_samples[sample_index];
-            int k;
-            for ( k = 0; k < g_cpu_profiler_ctxt.function_info_list_length; k++ ) {
-                function_info_t * p_function_info = &g_cpu_profiler_ctxt.function_info_list[k];
-                if ( p_function_info->index == sample_index ) {
-                    p_buffer[j] += p_function_info->count;
-                }
-            }
+            p_buffer[j] = g_cpu_profiler_ctxt.function_samples[i + j];
         }
         status = helper_send_data(g_cpu_profiler_ctxt.sock, p_buffer, elements_to_send*sizeof(uint32_t));
         if ( 0 != status ) {
@@ -620,6 +1089,7 @@ QCLI_Command_Status_t cpu_profiler_cli_send_results(uint32_t parameters_count, Q
         i += elements_to_send;
     }
 
+    free(p_buffer);
     return QCLI_STATUS_SUCCESS_E;
 
 cpu_profiler_cli_send_results_error:
@@ -631,21 +1101,6 @@ cpu_profiler_cli_send_results_error:
 }
 
 
-static inline uint32_t helper_is_index_recorded_as_cpu_hogger(
-    uint32_t * cpu_hogger_indices_array,
-    uint32_t number_of_recorded_cpu_hoggers,
-    uint32_t index
-    )
-{
-    int ii;
-    for ( ii = 0; ii < number_of_recorded_cpu_hoggers; ii++ ) {
-        if ( cpu_hogger_indices_array[ii] == index ) {
-            return 1;
-        }
-    }
-    return 0;
-}
-
 static int helper_print_top_most_cpu_hoggers(const int cpu_hoggers_to_print)
 {
     uint32_t cpu_hogger_indices_size = cpu_hoggers_to_print*sizeof(uint32_t);
@@ -656,92 +1111,49 @@ static int helper_print_top_most_cpu_hoggers(const int cpu_hoggers_to_print)
     }
     memset(cpu_hogger_indices_array, 0, cpu_hogger_indices_size);
 
-    uint32_t number_of_recorded_cpu_hoggers;
+    // single pass over the functions, keeping the top ones sorted by samples; only
+    // functions that make it into the list cost more than a compare
+    uint32_t number_of_recorded_cpu_hoggers = 0;
+    const uint32_t * function_samples = g_cpu_profiler_ctxt.function_samples;
+    uint32_t i;
 
-    for ( number_of_recorded_cpu_hoggers = 0; number_of_recorded_cpu_hoggers < MIN(g_cpu_profiler_ctxt.function_info_list_length, cpu_hoggers_to_print); number_of_recorded_cpu_hoggers++ ) {
-        int i;
-        uint32_t cpu_hogger_index = 0;
-        uint32_t cpu_hogger_value = 0;
-        for ( i  = 0; i < g_cpu_profiler_ctxt.function_info_list_length; i++ ) {
-            function_info_t * p_function_info = &g_cpu_profiler_ctxt.function_info_list[i];
-            if (!helper_is_index_recorded_as_cpu_hogger(cpu_hogger_indices_array, number_of_recorded_cpu_hoggers, p_function_info->index))
-            {
-                cpu_hogger_index = p_function_info->index;
-                cpu_hogger_value = p_function_info->count;
-                break;
-            }
+    for ( i = 0; i < g_cpu_profiler_ctxt.functions_count; i++ ) {
+        uint32_t position = number_of_recorded_cpu_hoggers;
+        if ( (position == cpu_hoggers_to_print) &&
+             ((0 == position) || (function_samples[i] <= function_samples[cpu_hogger_indices_array[position - 1]])) )
+        {
+            continue;
         }
-        i++;
-        for ( ; i < g_cpu_profiler_ctxt.function_info_list_length; i++ ) {
-            function_info_t * p_function_info = &g_cpu_profiler_ctxt.function_info_list[i];
-            if ( 1 &&
-                (cpu_hogger_value <= p_function_info->count ) &&
-                (!helper_is_index_recorded_as_cpu_hogger(cpu_hogger_indices_array, number_of_recorded_cpu_hoggers, p_function_info->index))
-               )
-            {
-                cpu_hogger_index = p_function_info->index;
-                cpu_hogger_value = p_function_info->count;
-            }
+        if ( number_of_recorded_cpu_hoggers < cpu_hoggers_to_print ) {
+            number_of_recorded_cpu_hoggers++;
         }
-        cpu_hogger_indices_array[number_of_recorded_cpu_hoggers] = cpu_hogger_index;
-    }
-
-    for ( ; number_of_recorded_cpu_hoggers < cpu_hoggers_to_print; number_of_recorded_cpu_hoggers++ ) {
-        uint32_t cpu_hogger_index = 0;
-        uint32_t cpu_hogger_value = 0;
-        uint32_t i;
-        for ( i = 0; i < g_cpu_profiler_ctxt.functions_count; i++ ) {
-            if (!helper_is_index_recorded_as_cpu_hogger(cpu_hogger_indices_array, number_of_recorded_cpu_hoggers, i)) {
-                cpu_hogger_index = i;
-                cpu_hogger_value = g_cpu_profiler_ctxt.function_samples[i];
-                break;
-            }
+        else {
+            position--;
         }
-        i++;
-        for ( ; i < g_cpu_profiler_ctxt.functions_count; i++ ) {
-            if ( 1
-                && (cpu_hogger_value <= g_cpu_profiler_ctxt.function_samples[i])
-                && (!helper_is_index_recorded_as_cpu_hogger(cpu_hogger_indices_array, number_of_recorded_cpu_hoggers, i))
-                )
-            {
-                cpu_hogger_index = i;
-                cpu_hogger_value = g_cpu_profiler_ctxt.function_samples[i];
-            }
+        while ( (position > 0) && (function_samples[cpu_hogger_indices_array[position - 1]] < function_samples[i]) ) {
+            cpu_hogger_indices_array[position] = cpu_hogger_indices_array[position - 1];
+            position--;
         }
-        cpu_hogger_indices_array[number_of_recorded_cpu_hoggers] = cpu_hogger_index;
+        cpu_hogger_indices_array[position] = i;
     }
 
 
     // count total number of samples taken during profiling
-    uint32_t i;
     uint32_t total_samples = 0;
     for ( i = 0; i < g_cpu_profiler_ctxt.functions_count; i++ ) {
         total_samples += g_cpu_profiler_ctxt.function_samples[i];
     }
-    for ( i = 0; i < g_cpu_profiler_ctxt.function_info_list_length; i++ ) {
-        function_info_t * p_function_info = &g_cpu_profiler_ctxt.function_info_list[i];
-        total_samples += p_function_info->count;
-    }
 
 
     // print the CPU hoggers
     CPU_PROFILER_DEMO_PRINTF("The %d top most CPU hoggers are:\r\n", cpu_hoggers_to_print);
     CPU_PROFILER_DEMO_PRINTF("Function Address, CPU Utilization %% [Samples]:  thread_id [samples] ...\r\n");
     for ( i = 0; i < cpu_hoggers_to_print; i++ ) {
-        int cpu_hogger_index = cpu_hogger_indices_array[i];
+        uint32_t cpu_hogger_index = cpu_hogger_indices_array[i];
         uint32_t function_address = g_cpu_profiler_ctxt.function_addresses[cpu_hogger_index];
         uint32_t function_samples = g_cpu_profiler_ctxt.function_samples[cpu_hogger_index];
-        int j;
-        function_info_t * p_function_info = 0;
-        for ( j = 0; j < g_cpu_profiler_ctxt.function_info_list_length; j++ ) {
-            if ( g_cpu_profiler_ctxt.function_info_list[j].index == cpu_hogger_index ) {
-                p_function_info = &g_cpu_profiler_ctxt.function_info_list[j];
-                function_samples += p_function_info->count;
-                break;
-            }
-        }
 
-        uint32_t percent_cpu_utilization = (total_samples) ? (100 * function_samples / total_samples) : 0;
+        uint32_t percent_cpu_utilization = (total_samples) ? (100 * (uint64_t) function_samples / total_samples) : 0;
         CPU_PROFILER_DEMO_PRINTF(
             "%08x, %d [%d]",
             function_address,
@@ -750,11 +1162,17 @@ static int helper_print_top_most_cpu_hoggers(const int cpu_hoggers_to_print)
             );
 
 #if ENABLE_MOST_USED_FUNCTIONS_THREAD_ID_LOGGING
-        if ( p_function_info ) {
-            CPU_PROFILER_DEMO_PRINTF(":\t");
-            for ( j = 0; j < p_function_info->thread_info_list_length; j++ ) {
-                thread_info_t * p_thread_info = &p_function_info->thread_info_list[j];
-                CPU_PROFILER_DEMO_PRINTF("0x%08x [%d]\t", p_thread_info->thread_id, p_thread_info->count);
+        int j;
+        int threads_printed = 0;
+        for ( j = 0; j < CPU_PROFILER_MAX_PAIRS; j++ ) {
+            function_thread_info_t * p_pair = &g_cpu_profiler_ctxt.function_thread_list[j];
+            if ( (p_pair->in_use) && (p_pair->index == cpu_hogger_index) ) {
+                CPU_PROFILER_DEMO_PRINTF(
+                    "%s0x%08x [%d]\t",
+                    (threads_printed++) ? "" : ":\t",
+                    g_cpu_profiler_ctxt.thread_info_list[p_pair->thread_slot].thread_id,
+                    p_pair->count
+                    );
             }
         }
 #endif
@@ -763,6 +1181,29 @@ static int helper_print_top_most_cpu_hoggers(const int cpu_hoggers_to_print)
 
     }
 
+
+    // print the samples taken by each thread
+    CPU_PROFILER_DEMO_PRINTF("Thread ID, CPU Utilization %% [Samples]:\r\n");
+    for ( i = 0; i < CPU_PROFILER_MAX_THREADS; i++ ) {
+        thread_info_t * p_thread_info = &g_cpu_profiler_ctxt.thread_info_list[i];
+        if ( p_thread_info->count ) {
+            CPU_PROFILER_DEMO_PRINTF(
+                "0x%08x, %d [%d]\r\n",
+                p_thread_info->thread_id,
+                (total_samples) ? (uint32_t) (100 * (uint64_t) p_thread_info->count / total_samples) : 0,
+                p_thread_info->count
+                );
+        }
+    }
+    if ( g_cpu_profiler_ctxt.threads_overflow_samples ) {
+        CPU_PROFILER_DEMO_PRINTF("Other threads [%d]\r\n", g_cpu_profiler_ctxt.threads_overflow_samples);
+    }
+#if ENABLE_MOST_USED_FUNCTIONS_THREAD_ID_LOGGING
+    if ( g_cpu_profiler_ctxt.pairs_overflow_samples ) {
+        CPU_PROFILER_DEMO_PRINTF("Samples without a function/thread entry [%d]\r\n", g_cpu_profiler_ctxt.pairs_overflow_samples);
+    }
+#endif
+
     if ( cpu_hogger_indices_array ) {
         free(cpu_hogger_indices_array);
     }
@@ -815,3 +1256,42 @@ cpu_profiler_cli_print_results_on_error:
     CPU_PROFILER_DEMO_PRINTF("Usage: print_results number_of_top_cpu_hoggers_to_print\r\n");
     return QCLI_STATUS_ERROR_E;
 }
+
+
+// Prints and drains the call stack ring, one "stack <thread_id> <pc> <return address> ..."
+// line per sample with the innermost address first, for cpu_profiler_fold_stacks.py.
+QCLI_Command_Status_t cpu_profiler_cli_dump_stacks(uint32_t parameters_count, QCLI_Parameter_t * parameters)
+{
+    if ( !cpu_profiler_is_enabled() ) {
+        CPU_PROFILER_DEMO_PRINTF("Must enable the cpu_profiler first\r\n");
+        return QCLI_STATUS_ERROR_E;
+    }
+
+    if ( !g_cpu_profiler_ctxt.stack_samples ) {
+        CPU_PROFILER_DEMO_PRINTF("No call stacks recorded, start the profiler with a stack_depth\r\n");
+        return QCLI_STATUS_ERROR_E;
+    }
+
+    uint32_t head = g_cpu_profiler_ctxt.stack_samples_head;
+    uint32_t tail = g_cpu_profiler_ctxt.stack_samples_tail;
+
+    CPU_PROFILER_DEMO_PRINTF("stack_samples %d dropped %d\r\n", head - tail, g_cpu_profiler_ctxt.stack_samples_dropped);
+
+    for ( ; tail != head; tail++ ) {
+        const cpu_profiler_stack_sample_t * p_sample = &g_cpu_profiler_ctxt.stack_samples[tail % g_cpu_profiler_ctxt.stack_samples_count];
+        uint32_t j;
+        CPU_PROFILER_DEMO_PRINTF("stack %08x", p_sample->thread_id);
+        for ( j = 0; j < p_sample->depth; j++ ) {
+            CPU_PROFILER_DEMO_PRINTF(" %08x", p_sample->pcs[j]);
+        }
+        CPU_PROFILER_DEMO_PRINTF("\r\n");
+
+        // hand the slot back to the ISR
+        g_cpu_profiler_ctxt.stack_samples_tail = tail + 1;
+    }
+
+    CPU_PROFILER_DEMO_PRINTF("stack_end\r\n");
+    g_cpu_profiler_ctxt.stack_samples_dropped = 0;
+
+    return QCLI_STATUS_SUCCESS_E;
+}
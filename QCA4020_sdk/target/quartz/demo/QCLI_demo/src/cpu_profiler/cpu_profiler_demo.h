@@ -25,9 +25,53 @@
 
 #define ENABLE_MOST_USED_FUNCTIONS_THREAD_ID_LOGGING 1
 
-#define MAX_FUNCTION_INFO_LIST_LENGTH 10
 #define MAX_THREAD_IDS_TO_RECORD 5
 
+// The PC to function lookup splits the image into at most CPU_PROFILER_MAX_REGIONS
+// regions (a new region starts where two functions are more than CPU_PROFILER_REGION_GAP
+// bytes apart, e.g. XIP flash and RAM code), and each region into pages. The page table
+// holds the index of the function covering the start of each page, so the ISR only scans
+// the few functions starting inside the sampled page. The page size is the smallest
+// power of two that keeps the table within CPU_PROFILER_MAX_PAGES entries.
+#define CPU_PROFILER_MAX_REGIONS 4
+#define CPU_PROFILER_REGION_GAP (64 * 1024)
+#define CPU_PROFILER_MAX_PAGES 2048
+#define CPU_PROFILER_MIN_PAGE_SHIFT 6
+
+// Samples are attributed to the running QuRT thread through a small open addressed
+// table. Threads that do not fit are counted in threads_overflow_samples.
+#define CPU_PROFILER_MAX_THREADS 32
+#define CPU_PROFILER_THREAD_HASH_BITS 5
+
+// Per function/thread sample counts, used to show which threads run the top functions.
+// Pairs that do not fit within CPU_PROFILER_MAX_PROBES probes are counted in
+// pairs_overflow_samples.
+#define CPU_PROFILER_MAX_PAIRS 256
+#define CPU_PROFILER_PAIR_HASH_BITS 8
+#define CPU_PROFILER_MAX_PROBES 4
+
+// Call stack sampling. The ISR records the interrupted PC, the stacked LR and the return
+// addresses found by scanning at most CPU_PROFILER_MAX_STACK_SCAN_WORDS words of the
+// interrupted stack. A word is taken as a return address when it is a Thumb address inside
+// the profiled code and the instruction before it is a BL or BLX. Samples go to a ring that
+// is drained by the dump_stacks command, samples that do not fit are counted as dropped.
+#define CPU_PROFILER_MAX_STACK_DEPTH 8
+#define CPU_PROFILER_MAX_STACK_SCAN_WORDS 64
+#define CPU_PROFILER_DEFAULT_STACK_SAMPLES 256
+
+// Function start addresses embedded in flash by the cpuProfilerSymbols.py post-link step,
+// so the profiler can run without the symbol server ("enable" without parameters).
+// The count stays 0 when the post-link step has not run.
+#define CPU_PROFILER_SYMBOL_TABLE_MAGIC 0x50555043
+#ifndef CPU_PROFILER_SYMBOL_TABLE_CAPACITY
+#define CPU_PROFILER_SYMBOL_TABLE_CAPACITY 8192
+#endif
+
+// Results can be spooled to the flash log partition and read back later, they replace any
+// diag flash logs held there.
+#define CPU_PROFILER_FLASH_LOG_PARTITION_ID 100
+#define CPU_PROFILER_FLASH_RECORD_MAGIC 0x52555043
+
 
 typedef struct thread_info_s {
     uint32_t thread_id;
@@ -35,24 +79,78 @@ typedef struct thread_info_s {
 } thread_info_t;
 
 
-typedef struct function_info_s {
+typedef struct function_thread_info_s {
     uint32_t index;
+    uint16_t thread_slot;
+    uint16_t in_use;
     uint32_t count;
-#if ENABLE_MOST_USED_FUNCTIONS_THREAD_ID_LOGGING
-    thread_info_t thread_info_list[MAX_THREAD_IDS_TO_RECORD];
-    uint32_t      thread_info_list_length;
-#endif
-} function_info_t;
+} function_thread_info_t;
+
+
+typedef struct cpu_profiler_symbol_table_s {
+    uint32_t magic;
+    uint32_t capacity;
+    uint32_t count;
+    uint32_t addresses[CPU_PROFILER_SYMBOL_TABLE_CAPACITY];   // sorted
+} cpu_profiler_symbol_table_t;
+
+
+// header of the results spooled to flash, followed by function_entries (address, samples)
+// pairs and thread_entries (thread_id, samples) pairs
+typedef struct cpu_profiler_flash_record_s {
+    uint32_t magic;
+    uint32_t functions_count;
+    uint32_t total_samples;
+    uint32_t function_entries;
+    uint32_t thread_entries;
+} cpu_profiler_flash_record_t;
+
+
+typedef struct cpu_profiler_stack_sample_s {
+    uint32_t thread_id;
+    uint32_t depth;
+    uint32_t pcs[CPU_PROFILER_MAX_STACK_DEPTH];     // innermost first
+} cpu_profiler_stack_sample_t;
+
+
+typedef struct cpu_profiler_region_s {
+    uint32_t base_address;      // start of the first page of the region
+    uint32_t start_address;     // address of the first function of the region
+    uint32_t first_page;        // index in page_table of the first page
+    uint32_t pages_count;
+    uint32_t first_index;       // function index range of the region
+    uint32_t last_index;
+} cpu_profiler_region_t;
 
 
 typedef struct cpu_profiler_ctxt_s {
     int32_t sock;
+    uint32_t offline;           // using the embedded symbol table, no server connection
     uint32_t functions_count;
     uint32_t * function_addresses;
-    uint16_t * function_samples;
+    uint32_t * function_samples;
+
+    // PC to function lookup, built by cpu_profiler_start()
+    uint32_t * page_table;
+    uint32_t page_shift;
+    cpu_profiler_region_t regions[CPU_PROFILER_MAX_REGIONS];
+    uint32_t regions_count;
+
+    thread_info_t thread_info_list[CPU_PROFILER_MAX_THREADS];
+    uint32_t threads_overflow_samples;
+
+#if ENABLE_MOST_USED_FUNCTIONS_THREAD_ID_LOGGING
+    function_thread_info_t function_thread_list[CPU_PROFILER_MAX_PAIRS];
+    uint32_t pairs_overflow_samples;
+#endif
 
-    function_info_t function_info_list[MAX_FUNCTION_INFO_LIST_LENGTH];
-    uint32_t function_info_list_length;
+    // call stack ring, stack_depth of 0 disables stack sampling
+    uint32_t stack_depth;
+    cpu_profiler_stack_sample_t * stack_samples;
+    uint32_t stack_samples_count;
+    volatile uint32_t stack_samples_head;
+    volatile uint32_t stack_samples_tail;
+    uint32_t stack_samples_dropped;
 
     uint32_t count_of_pcs_to_capture;
     uint32_t count_of_pcs_captured;
@@ -63,3 +161,4 @@ typedef struct cpu_profiler_ctxt_s {
 
 
 void Initialize_CpuProfiler_Demo(void);
+int cpu_profiler_stop(void);
@@ -44,6 +44,19 @@ extern cpu_profiler_ctxt_t g_cpu_profiler_ctxt;
 #define CPU_PROFILER_TIMER_INTCLR    0x4400102c
 #define CPU_PROFILER_TIMER_BGLOAD    0x44001038
 
+// words pushed on the MSP by cpu_profiler_interrupt_irq_handler before it reads the MSP
+#define CPU_PROFILER_ISR_PUSHED_WORDS 5
+
+// exception frame layout
+#define EXCEPTION_FRAME_WORDS           8
+#define EXCEPTION_FRAME_FP_WORDS        26
+#define EXCEPTION_FRAME_LR              5
+#define EXCEPTION_FRAME_PC              6
+#define EXCEPTION_FRAME_XPSR            7
+#define EXC_RETURN_PROCESS_STACK        0x4
+#define EXC_RETURN_BASIC_FRAME          0x10
+#define XPSR_STACK_ALIGNED              (1 << 9)
+
 
 
 #define ASSERT_BREAK(x) \
@@ -73,95 +86,189 @@ static inline void __set_PRIMASK(uint32_t primask_val)
 }
 
 
-void cpu_profiler_timer_isr(
-    uint32_t ipsr_register_value,
-    uint32_t lr_register_value,
-    uint32_t msp_register_value,
-    uint32_t psp_register_value
-    )
+static inline uint32_t helper_find_function_index(uint32_t pc)
 {
-    if ( g_cpu_profiler_ctxt.count_of_pcs_captured >= g_cpu_profiler_ctxt.count_of_pcs_to_capture )
-    {
-        cpu_profiler_stop();
+    // pick the region (there are only a handful), PCs below the first function go to index 0
+    const cpu_profiler_region_t * p_region = &g_cpu_profiler_ctxt.regions[g_cpu_profiler_ctxt.regions_count - 1];
+    while ( (p_region != &g_cpu_profiler_ctxt.regions[0]) && (pc < p_region->start_address) ) {
+        p_region--;
     }
-
-    uint32_t value;
-    if ( (lr_register_value & 0xd) == 0xd ) {
-        value = ((uint32_t*) psp_register_value)[6];
+    if ( pc < p_region->base_address ) {
+        return p_region->first_index;
     }
-    else {
-        value = ((uint32_t*) msp_register_value)[6];
+
+    uint32_t page = (pc - p_region->base_address) >> g_cpu_profiler_ctxt.page_shift;
+    if ( page >= p_region->pages_count ) {
+        return p_region->last_index;
     }
 
+    // the page table gives the function covering the start of the page, only the
+    // functions starting inside the page are left to look at
+    uint32_t index = g_cpu_profiler_ctxt.page_table[p_region->first_page + page];
+    while ( (index < p_region->last_index) && (g_cpu_profiler_ctxt.function_addresses[index + 1] <= pc) ) {
+        index++;
+    }
+    return index;
+}
 
-    // binary search algorithm to find the index of the function PC belongs to
-    uint32_t low_index = 0;
-    uint32_t high_index = g_cpu_profiler_ctxt.functions_count;
-    uint32_t mid_index;
-    uint32_t mid_index_value;
 
-    while ( (high_index - low_index) > 1  ) {
-        mid_index = (low_index + high_index) / 2;
-        mid_index_value = g_cpu_profiler_ctxt.function_addresses[mid_index];
-        if ( value >= mid_index_value ) {
-            low_index = mid_index;
+static inline uint32_t helper_find_thread_slot(uint32_t thread_id)
+{
+    uint32_t slot = ((thread_id >> 2) * 2654435761u) >> (32 - CPU_PROFILER_THREAD_HASH_BITS);
+    uint32_t probes;
+    for ( probes = 0; probes < CPU_PROFILER_MAX_PROBES; probes++ ) {
+        thread_info_t * p_thread_info = &g_cpu_profiler_ctxt.thread_info_list[slot];
+        if ( p_thread_info->thread_id == thread_id ) {
+            return slot;
         }
-        else {
-            high_index = mid_index;
+        if ( 0 == p_thread_info->count ) {
+            p_thread_info->thread_id = thread_id;
+            return slot;
         }
+        slot = (slot + 1) & (CPU_PROFILER_MAX_THREADS - 1);
     }
+    return CPU_PROFILER_MAX_THREADS;
+}
 
-    ASSERT_BREAK( low_index < g_cpu_profiler_ctxt.functions_count );
-
-    g_cpu_profiler_ctxt.function_samples[low_index]++;
-
-    function_info_t * p_function_info = 0;
 
-    if ( 0 == g_cpu_profiler_ctxt.function_samples[low_index] ) {
-        int i;
-        for ( i = 0; i < g_cpu_profiler_ctxt.function_info_list_length; i++ ) {
-            if ( g_cpu_profiler_ctxt.function_info_list[i].index == low_index ) {
-                p_function_info = &g_cpu_profiler_ctxt.function_info_list[i];
-                p_function_info->count += 0xffff;
-                break;
+// Checks that a word is a Thumb return address inside the profiled code, i.e. that the
+// instruction before it is a BL <label> or a BLX <Rm>. The two halfwords before the address
+// are only read when they are inside a region of the lookup table.
+static inline uint32_t helper_is_return_address(uint32_t address)
+{
+    if ( !(address & 1) ) {
+        return 0;
+    }
+    address &= ~1u;
+
+    uint32_t r;
+    for ( r = 0; r < g_cpu_profiler_ctxt.regions_count; r++ ) {
+        const cpu_profiler_region_t * p_region = &g_cpu_profiler_ctxt.regions[r];
+        if ( (address >= p_region->start_address + 4) &&
+             (address < p_region->base_address + (p_region->pages_count << g_cpu_profiler_ctxt.page_shift)) )
+        {
+            const uint16_t * p_code = (const uint16_t *) address;
+            if ( ((p_code[-2] & 0xf800) == 0xf000) && ((p_code[-1] & 0xd000) == 0xd000) ) {
+                return 1;
             }
-        }
-        if ( (!p_function_info) && (g_cpu_profiler_ctxt.function_info_list_length < MAX_FUNCTION_INFO_LIST_LENGTH) ) {
-            p_function_info = &g_cpu_profiler_ctxt.function_info_list[g_cpu_profiler_ctxt.function_info_list_length];
-            p_function_info->index = low_index;
-            p_function_info->count = 0xffff;
-            g_cpu_profiler_ctxt.function_info_list_length++;
+            if ( (p_code[-1] & 0xff87) == 0x4780 ) {
+                return 1;
+            }
+            return 0;
         }
     }
+    return 0;
+}
 
 
-#if ENABLE_MOST_USED_FUNCTIONS_THREAD_ID_LOGGING
-    if ( !p_function_info ) {
-        int i;
-        for ( i = 0; i < g_cpu_profiler_ctxt.function_info_list_length; i++ ) {
-            if ( g_cpu_profiler_ctxt.function_info_list[i].index == low_index ) {
-                p_function_info = &g_cpu_profiler_ctxt.function_info_list[i];
-            }
+static inline void helper_record_stack(const uint32_t * p_frame, uint32_t frame_words, uint32_t thread_id)
+{
+    uint32_t head = g_cpu_profiler_ctxt.stack_samples_head;
+    if ( (head - g_cpu_profiler_ctxt.stack_samples_tail) >= g_cpu_profiler_ctxt.stack_samples_count ) {
+        g_cpu_profiler_ctxt.stack_samples_dropped++;
+        return;
+    }
+
+    cpu_profiler_stack_sample_t * p_sample = &g_cpu_profiler_ctxt.stack_samples[head % g_cpu_profiler_ctxt.stack_samples_count];
+    uint32_t max_depth = g_cpu_profiler_ctxt.stack_depth;
+    uint32_t depth = 0;
+
+    p_sample->pcs[depth++] = p_frame[EXCEPTION_FRAME_PC];
+
+    // a leaf function still has its return address in LR
+    uint32_t lr = p_frame[EXCEPTION_FRAME_LR];
+    if ( (depth < max_depth) && helper_is_return_address(lr) ) {
+        p_sample->pcs[depth++] = lr & ~1u;
+    }
+
+    // the callers' return addresses are on the stack above the exception frame
+    const uint32_t * p_word = p_frame + frame_words;
+    uint32_t words;
+    for ( words = 0; (words < CPU_PROFILER_MAX_STACK_SCAN_WORDS) && (depth < max_depth); words++ ) {
+        uint32_t word = p_word[words];
+        if ( helper_is_return_address(word) && ((word & ~1u) != p_sample->pcs[depth - 1]) ) {
+            p_sample->pcs[depth++] = word & ~1u;
         }
     }
 
-    if ( p_function_info ) {
-        uint32_t thread_id = qurt_thread_get_id();
-        int i;
-        thread_info_t * p_thread_info = 0;
-        for ( i = 0; i < p_function_info->thread_info_list_length; i++ ) {
-            if ( thread_id == p_function_info->thread_info_list[i].thread_id ) {
-                p_thread_info = &p_function_info->thread_info_list[i];
-                p_thread_info->count++;
-            }
+    p_sample->thread_id = thread_id;
+    p_sample->depth = depth;
+    g_cpu_profiler_ctxt.stack_samples_head = head + 1;
+}
+
+
+#if ENABLE_MOST_USED_FUNCTIONS_THREAD_ID_LOGGING
+static inline void helper_count_function_thread(uint32_t index, uint32_t thread_slot)
+{
+    uint32_t slot = ((index ^ (thread_slot << 16)) * 2654435761u) >> (32 - CPU_PROFILER_PAIR_HASH_BITS);
+    uint32_t probes;
+    for ( probes = 0; probes < CPU_PROFILER_MAX_PROBES; probes++ ) {
+        function_thread_info_t * p_pair = &g_cpu_profiler_ctxt.function_thread_list[slot];
+        if ( !p_pair->in_use ) {
+            p_pair->index = index;
+            p_pair->thread_slot = thread_slot;
+            p_pair->in_use = 1;
         }
-        if ( (!p_thread_info) && (p_function_info->thread_info_list_length < MAX_THREAD_IDS_TO_RECORD ) ) {
-            p_thread_info = &p_function_info->thread_info_list[p_function_info->thread_info_list_length];
-            p_thread_info->thread_id = thread_id;
-            p_function_info->thread_info_list_length++;
+        if ( (p_pair->index == index) && (p_pair->thread_slot == thread_slot) ) {
+            p_pair->count++;
+            return;
         }
+        slot = (slot + 1) & (CPU_PROFILER_MAX_PAIRS - 1);
+    }
+    g_cpu_profiler_ctxt.pairs_overflow_samples++;
+}
+#endif
+
+
+void cpu_profiler_timer_isr(
+    uint32_t ipsr_register_value,
+    uint32_t lr_register_value,
+    uint32_t msp_register_value,
+    uint32_t psp_register_value
+    )
+{
+    if ( g_cpu_profiler_ctxt.count_of_pcs_captured >= g_cpu_profiler_ctxt.count_of_pcs_to_capture )
+    {
+        cpu_profiler_stop();
+        return;
+    }
+
+    // the handler itself runs on the MSP, so when it pre-empted another handler the
+    // exception frame is above the registers it pushed
+    const uint32_t * p_frame;
+    if ( lr_register_value & EXC_RETURN_PROCESS_STACK ) {
+        p_frame = (const uint32_t *) psp_register_value;
     }
+    else {
+        p_frame = (const uint32_t *) msp_register_value + CPU_PROFILER_ISR_PUSHED_WORDS;
+    }
+    uint32_t value = p_frame[EXCEPTION_FRAME_PC];
+
+    uint32_t index = helper_find_function_index(value);
+
+    ASSERT_BREAK( index < g_cpu_profiler_ctxt.functions_count );
+
+    g_cpu_profiler_ctxt.function_samples[index]++;
+
+    uint32_t thread_id = (uint32_t) qurt_thread_get_id();
+    uint32_t thread_slot = helper_find_thread_slot(thread_id);
+    if ( thread_slot < CPU_PROFILER_MAX_THREADS ) {
+        g_cpu_profiler_ctxt.thread_info_list[thread_slot].count++;
+#if ENABLE_MOST_USED_FUNCTIONS_THREAD_ID_LOGGING
+        helper_count_function_thread(index, thread_slot);
 #endif
+    }
+    else {
+        g_cpu_profiler_ctxt.threads_overflow_samples++;
+    }
+
+    if ( g_cpu_profiler_ctxt.stack_depth ) {
+        uint32_t frame_words = (lr_register_value & EXC_RETURN_BASIC_FRAME) ? EXCEPTION_FRAME_WORDS : EXCEPTION_FRAME_FP_WORDS;
+        if ( p_frame[EXCEPTION_FRAME_XPSR] & XPSR_STACK_ALIGNED ) {
+            frame_words++;
+        }
+        helper_record_stack(p_frame, frame_words, thread_id);
+    }
 
     g_cpu_profiler_ctxt.count_of_pcs_captured++;
 
@@ -0,0 +1,2359 @@
+/*
+* Copyright (c) 2016 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*-------------------------------------------------------------------------
+ * Include Files
+ *-----------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "qapi_types.h"
+#include "qapi_ble.h"
+
+#include "host_demo.h"
+
+/*-------------------------------------------------------------------------
+ * Preprocessor Definitions and Constants
+ *-----------------------------------------------------------------------*/
+
+/**
+   The ID of the one Bluetooth stack.
+*/
+#define HOST_BLE_STACK_ID                                               (1)
+
+/**
+   The default number of fake bulbs and the default time (in milliseconds)
+   the controller takes to answer.
+*/
+#define HOST_BLE_DEFAULT_BULB_COUNT                                     (3)
+#define HOST_BLE_DEFAULT_LATENCY                                        (20)
+
+/**
+   The MTU the fake bulbs support.
+*/
+#define HOST_BLE_MTU                                                    (247)
+
+/**
+   The local name the fake bulbs advertise, the AD type it is sent with
+   and the handles of their one service.  The characteristic has the
+   16-bit UUID FFFB the MSCD demo looks for.
+*/
+#define HOST_BLE_BULB_NAME                                              "PIR-20-MSCD"
+#define HOST_BLE_AD_TYPE_LOCAL_NAME                                     (0x09)
+#define HOST_BLE_SERVICE_HANDLE                                         (0x0010)
+#define HOST_BLE_SERVICE_END_HANDLE                                     (0x0013)
+#define HOST_BLE_CHARACTERISTIC_HANDLE                                  (0x0012)
+
+/**
+   Matches an event of any Event_Data_Type in Host_BLE_Remove_Events().
+*/
+#define HOST_BLE_ANY_EVENT_DATA_TYPE                                    (0xFFFFFFFF)
+
+/*-------------------------------------------------------------------------
+ * Type Declarations
+ *-----------------------------------------------------------------------*/
+
+/**
+   This enumeration identifies the callback an event is given to.
+*/
+typedef enum
+{
+   HOST_BLE_EVENT_GAP_LE_E,          /**< A GAP LE event callback. */
+   HOST_BLE_EVENT_GATT_CONNECTION_E, /**< The GATT connection callback. */
+   HOST_BLE_EVENT_GATT_CLIENT_E,     /**< A GATT client request callback. */
+   HOST_BLE_EVENT_GATT_DISCOVERY_E,  /**< A GATT service discovery callback. */
+   HOST_BLE_EVENT_TIMER_E            /**< A BSC timer callback. */
+} Host_BLE_Event_Type_t;
+
+/**
+   This structure holds an advertising report with the data it points to.
+*/
+typedef struct Host_BLE_Advertising_Report_s
+{
+   qapi_BLE_GAP_LE_Advertising_Report_Data_t Report;
+   qapi_BLE_GAP_LE_Advertising_Data_Entry_t  Entry;
+   uint8_t                                   Name[sizeof(HOST_BLE_BULB_NAME) - 1];
+} Host_BLE_Advertising_Report_t;
+
+/**
+   This structure holds a service discovery indication with the data it
+   points to.
+*/
+typedef struct Host_BLE_Discovery_Indication_s
+{
+   qapi_BLE_GATT_Service_Discovery_Indication_Data_t Indication;
+   qapi_BLE_GATT_Characteristic_Information_t        Characteristic;
+} Host_BLE_Discovery_Indication_t;
+
+/**
+   This structure is an event waiting to be given to a callback.  The data
+   is copied into the event, the pointers of the event data structures are
+   set up when it is dispatched.
+*/
+typedef struct Host_BLE_Event_s
+{
+   struct Host_BLE_Event_s *Next;               /**< The next event in the list. */
+   struct timespec          Due;                /**< The time the event is dispatched. */
+   Host_BLE_Event_Type_t    Type;               /**< The callback the event is given to. */
+   uint32_t                 Event_Data_Type;    /**< The event type within the callback. */
+   uint32_t                 Key;                /**< The connection ID or timer ID of the event, zero for none. */
+   uint32_t                 Callback_Parameter; /**< The parameter of the callback. */
+   union
+   {
+      qapi_BLE_GAP_LE_Event_Callback_t                 GAP_LE;
+      qapi_BLE_GATT_Connection_Event_Callback_t        GATT_Connection;
+      qapi_BLE_GATT_Client_Event_Callback_t            GATT_Client;
+      qapi_BLE_GATT_Service_Discovery_Event_Callback_t GATT_Discovery;
+      qapi_BLE_BSC_Timer_Callback_t                    Timer;
+   } Callback;
+   union
+   {
+      qapi_BLE_GAP_LE_Connection_Complete_Event_Data_t    Connection_Complete;
+      qapi_BLE_GAP_LE_Disconnection_Complete_Event_Data_t Disconnection_Complete;
+      Host_BLE_Advertising_Report_t                       Advertising_Report;
+      qapi_BLE_GATT_Device_Connection_Data_t              Device_Connection;
+      qapi_BLE_GATT_Device_Disconnection_Data_t           Device_Disconnection;
+      qapi_BLE_GATT_Exchange_MTU_Response_Data_t          Exchange_MTU_Response;
+      qapi_BLE_GATT_Write_Response_Data_t                 Write_Response;
+      qapi_BLE_GATT_Request_Error_Data_t                  Request_Error;
+      Host_BLE_Discovery_Indication_t                     Discovery_Indication;
+      qapi_BLE_GATT_Service_Discovery_Complete_Data_t     Discovery_Complete;
+   } Data;
+} Host_BLE_Event_t;
+
+/**
+   This structure represents a fake bulb.
+*/
+typedef struct Host_BLE_Bulb_s
+{
+   qapi_BLE_BD_ADDR_t               BD_ADDR;          /**< The address of the bulb. */
+   qbool_t                          Connected;        /**< Indicates if the bulb is connected. */
+   uint32_t                         Connection_ID;    /**< The GATT connection ID while connected. */
+   qapi_BLE_GAP_LE_Event_Callback_t GAP_LE_Callback;  /**< The callback that gets the disconnection. */
+   uint32_t                         GAP_LE_Parameter; /**< The parameter of GAP_LE_Callback. */
+   uint32_t                         Writes;           /**< The write requests taken. */
+   uint32_t                         Failed_Writes;    /**< The write requests answered with an error. */
+   uint64_t                         Value;            /**< The last value written. */
+} Host_BLE_Bulb_t;
+
+/**
+   This structure contains the context information of the Bluetooth fake.
+   Callbacks are made from the dispatch thread, never from inside an API
+   call and never with the mutex held, as the stack does on the target.
+*/
+typedef struct Host_BLE_Context_s
+{
+   pthread_mutex_t                           Mutex;                          /**< Protects the context. */
+   pthread_cond_t                            Condition;                      /**< Signalled when the event list changes. */
+   qbool_t                                   Thread_Started;                 /**< Indicates if the dispatch thread was started. */
+   qbool_t                                   Initialized;                    /**< Indicates if the stack is open. */
+   Host_BLE_Event_t                         *Event_List;                     /**< The events waiting, soonest first. */
+   uint32_t                                  Latency;                        /**< The time (in milliseconds) the controller takes to answer. */
+   uint32_t                                  Fail_Percent;                   /**< The chance of a connection attempt or write failing. */
+   unsigned int                              Seed;                           /**< The random seed of the failures. */
+   uint32_t                                  Next_ID;                        /**< The next timer, connection or transaction ID. */
+   qapi_BLE_GATT_Connection_Event_Callback_t GATT_Callback;                  /**< The GATT connection callback. */
+   uint32_t                                  GATT_Parameter;                 /**< The parameter of GATT_Callback. */
+   qbool_t                                   Scan_Active;                    /**< Indicates if a scan is running. */
+   qbool_t                                   Connecting;                     /**< Indicates if a connection is being created. */
+   qapi_BLE_GAP_LE_Event_Callback_t          Connect_Callback;               /**< The callback of the connection being created. */
+   uint32_t                                  Connect_Parameter;              /**< The parameter of Connect_Callback. */
+   uint32_t                                  White_List_Count;               /**< The number of entries in the white list. */
+   qapi_BLE_BD_ADDR_t                        White_List[HOST_BLE_MAX_BULBS]; /**< The white list. */
+   uint32_t                                  Bulb_Count;                     /**< The number of bulbs in range. */
+   Host_BLE_Bulb_t                           Bulb[HOST_BLE_MAX_BULBS];       /**< The bulbs. */
+} Host_BLE_Context_t;
+
+static Host_BLE_Context_t Host_BLE_Context = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, false, false, NULL, HOST_BLE_DEFAULT_LATENCY, 0, 1, 1, NULL, 0, false, false, NULL, 0, 0, {{0}}, HOST_BLE_DEFAULT_BULB_COUNT};
+
+/*-------------------------------------------------------------------------
+ * Function Declarations
+ *-----------------------------------------------------------------------*/
+
+static void Host_BLE_Assign_Addresses(void);
+static uint32_t Host_BLE_New_ID(void);
+static qbool_t Host_BLE_Fails(void);
+static Host_BLE_Bulb_t *Host_BLE_Find_Bulb(const qapi_BLE_BD_ADDR_t *BD_ADDR);
+static Host_BLE_Bulb_t *Host_BLE_Find_Connection(uint32_t Connection_ID);
+static Host_BLE_Event_t *Host_BLE_New_Event(Host_BLE_Event_Type_t Type, uint32_t Event_Data_Type, uint32_t Key);
+static void Host_BLE_Queue_Event(Host_BLE_Event_t *Event, uint32_t Delay);
+static qbool_t Host_BLE_Remove_Events(Host_BLE_Event_Type_t Type, uint32_t Event_Data_Type, uint32_t Key);
+static void Host_BLE_Drop_Connection(Host_BLE_Bulb_t *Bulb, uint8_t Reason);
+static void Host_BLE_Dispatch(Host_BLE_Event_t *Event);
+static void *Host_BLE_Thread(void *Parameter);
+static qbool_t Host_BLE_Entry_Matches(qapi_BLE_BSC_Generic_List_Entry_Key_t Key, void *Key_Value, uint32_t Key_Offset, void *Entry);
+
+/*-------------------------------------------------------------------------
+ * Function Definitions
+ *-----------------------------------------------------------------------*/
+
+/**
+   @brief This function returns a new timer, connection or transaction ID.
+          The mutex must be held by the caller.
+
+   @return The ID, never zero.
+*/
+static uint32_t Host_BLE_New_ID(void)
+{
+   uint32_t Ret_Val;
+
+   Ret_Val = Host_BLE_Context.Next_ID ++;
+   if(Host_BLE_Context.Next_ID > 0x7FFFFFFF)
+   {
+      Host_BLE_Context.Next_ID = 1;
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function decides if a connection attempt or a write fails.
+          The mutex must be held by the caller.
+
+   @return true if the operation fails.
+*/
+static qbool_t Host_BLE_Fails(void)
+{
+   return((qbool_t)((Host_BLE_Context.Fail_Percent != 0) && ((uint32_t)(rand_r(&(Host_BLE_Context.Seed)) % 100) < Host_BLE_Context.Fail_Percent)));
+}
+
+/**
+   @brief This function finds a bulb in range by its address.  The mutex
+          must be held by the caller.
+
+   @param BD_ADDR is the address of the bulb.
+
+   @return The bulb or NULL if no bulb in range has the address.
+*/
+static Host_BLE_Bulb_t *Host_BLE_Find_Bulb(const qapi_BLE_BD_ADDR_t *BD_ADDR)
+{
+   Host_BLE_Bulb_t *Ret_Val;
+   uint32_t         Index;
+
+   Ret_Val = NULL;
+
+   for(Index = 0; (Index < Host_BLE_Context.Bulb_Count) && (Ret_Val == NULL); Index ++)
+   {
+      if(QAPI_BLE_COMPARE_BD_ADDR(Host_BLE_Context.Bulb[Index].BD_ADDR, *BD_ADDR))
+      {
+         Ret_Val = &(Host_BLE_Context.Bulb[Index]);
+      }
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function finds a connected bulb by its connection ID.  The
+          mutex must be held by the caller.
+
+   @param Connection_ID is the GATT connection ID.
+
+   @return The bulb or NULL if no bulb has the connection.
+*/
+static Host_BLE_Bulb_t *Host_BLE_Find_Connection(uint32_t Connection_ID)
+{
+   Host_BLE_Bulb_t *Ret_Val;
+   uint32_t         Index;
+
+   Ret_Val = NULL;
+
+   for(Index = 0; (Index < Host_BLE_Context.Bulb_Count) && (Ret_Val == NULL); Index ++)
+   {
+      if((Host_BLE_Context.Bulb[Index].Connected) && (Host_BLE_Context.Bulb[Index].Connection_ID == Connection_ID))
+      {
+         Ret_Val = &(Host_BLE_Context.Bulb[Index]);
+      }
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function allocates an event.
+
+   @param Type is the callback the event is given to.
+   @param Event_Data_Type is the event type within the callback.
+   @param Key is the connection ID or timer ID of the event.
+
+   @return The event or NULL if there was not enough memory.
+*/
+static Host_BLE_Event_t *Host_BLE_New_Event(Host_BLE_Event_Type_t Type, uint32_t Event_Data_Type, uint32_t Key)
+{
+   Host_BLE_Event_t *Ret_Val;
+
+   if((Ret_Val = (Host_BLE_Event_t *)calloc(1, sizeof(Host_BLE_Event_t))) != NULL)
+   {
+      Ret_Val->Type            = Type;
+      Ret_Val->Event_Data_Type = Event_Data_Type;
+      Ret_Val->Key             = Key;
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function adds an event to the list.  Events due at the same
+          time are dispatched in the order they were queued.  The mutex must
+          be held by the caller.
+
+   @param Event is the event to add.
+   @param Delay is the time (in milliseconds) until the event is due.
+*/
+static void Host_BLE_Queue_Event(Host_BLE_Event_t *Event, uint32_t Delay)
+{
+   Host_BLE_Event_t **Link;
+
+   clock_gettime(CLOCK_MONOTONIC, &(Event->Due));
+   Event->Due.tv_sec  += Delay / 1000;
+   Event->Due.tv_nsec += (long)(Delay % 1000) * 1000000L;
+   if(Event->Due.tv_nsec >= 1000000000L)
+   {
+      Event->Due.tv_sec  ++;
+      Event->Due.tv_nsec -= 1000000000L;
+   }
+
+   Link = &(Host_BLE_Context.Event_List);
+   while((*Link != NULL) && (((*Link)->Due.tv_sec < Event->Due.tv_sec) || (((*Link)->Due.tv_sec == Event->Due.tv_sec) && ((*Link)->Due.tv_nsec <= Event->Due.tv_nsec))))
+   {
+      Link = &((*Link)->Next);
+   }
+
+   Event->Next = *Link;
+   *Link       = Event;
+
+   pthread_cond_broadcast(&(Host_BLE_Context.Condition));
+}
+
+/**
+   @brief This function removes the events that have not been dispatched
+          yet for an operation that was cancelled.  The mutex must be held
+          by the caller.
+
+   @param Type is the callback of the events.
+   @param Event_Data_Type is the event type within the callback or
+          HOST_BLE_ANY_EVENT_DATA_TYPE.
+   @param Key is the connection ID or timer ID of the events.
+
+   @return true if an event was removed.
+*/
+static qbool_t Host_BLE_Remove_Events(Host_BLE_Event_Type_t Type, uint32_t Event_Data_Type, uint32_t Key)
+{
+   Host_BLE_Event_t **Link;
+   Host_BLE_Event_t  *Event;
+   qbool_t            Ret_Val;
+
+   Ret_Val = false;
+   Link    = &(Host_BLE_Context.Event_List);
+
+   while((Event = *Link) != NULL)
+   {
+      if((Event->Type == Type) && (Event->Key == Key) && ((Event_Data_Type == HOST_BLE_ANY_EVENT_DATA_TYPE) || (Event->Event_Data_Type == Event_Data_Type)))
+      {
+         *Link   = Event->Next;
+         Ret_Val = true;
+         free(Event);
+      }
+      else
+      {
+         Link = &(Event->Next);
+      }
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function ends the connection of a bulb.  The requests still
+          outstanding on the connection are dropped and the disconnection
+          is reported to GAP and GATT.  The mutex must be held by the
+          caller.
+
+   @param Bulb is the bulb.
+   @param Reason is the HCI reason of the disconnection.
+*/
+static void Host_BLE_Drop_Connection(Host_BLE_Bulb_t *Bulb, uint8_t Reason)
+{
+   Host_BLE_Event_t *Event;
+
+   Host_BLE_Remove_Events(HOST_BLE_EVENT_GATT_CLIENT_E, HOST_BLE_ANY_EVENT_DATA_TYPE, Bulb->Connection_ID);
+   Host_BLE_Remove_Events(HOST_BLE_EVENT_GATT_DISCOVERY_E, HOST_BLE_ANY_EVENT_DATA_TYPE, Bulb->Connection_ID);
+
+   if((Bulb->GAP_LE_Callback != NULL) && ((Event = Host_BLE_New_Event(HOST_BLE_EVENT_GAP_LE_E, QAPI_BLE_ET_LE_DISCONNECTION_COMPLETE_E, 0)) != NULL))
+   {
+      Event->Callback.GAP_LE                               = Bulb->GAP_LE_Callback;
+      Event->Callback_Parameter                            = Bulb->GAP_LE_Parameter;
+      Event->Data.Disconnection_Complete.Status            = QAPI_BLE_HCI_ERROR_CODE_NO_ERROR;
+      Event->Data.Disconnection_Complete.Reason            = Reason;
+      Event->Data.Disconnection_Complete.Peer_Address_Type = QAPI_BLE_LAT_PUBLIC_E;
+      Event->Data.Disconnection_Complete.Peer_Address      = Bulb->BD_ADDR;
+
+      Host_BLE_Queue_Event(Event, Host_BLE_Context.Latency);
+   }
+
+   if((Host_BLE_Context.GATT_Callback != NULL) && ((Event = Host_BLE_New_Event(HOST_BLE_EVENT_GATT_CONNECTION_E, QAPI_BLE_ET_GATT_CONNECTION_DEVICE_DISCONNECTION_E, 0)) != NULL))
+   {
+      Event->Callback.GATT_Connection                 = Host_BLE_Context.GATT_Callback;
+      Event->Callback_Parameter                       = Host_BLE_Context.GATT_Parameter;
+      Event->Data.Device_Disconnection.ConnectionID   = Bulb->Connection_ID;
+      Event->Data.Device_Disconnection.ConnectionType = QAPI_BLE_GCT_LE_E;
+      Event->Data.Device_Disconnection.RemoteDevice   = Bulb->BD_ADDR;
+
+      Host_BLE_Queue_Event(Event, Host_BLE_Context.Latency);
+   }
+
+   Bulb->Connected       = false;
+   Bulb->Connection_ID   = 0;
+   Bulb->GAP_LE_Callback = NULL;
+}
+
+/**
+   @brief This function gives an event to its callback.  The event data
+          structure is built on the stack and points into the event.
+
+   @param Event is the event.
+*/
+static void Host_BLE_Dispatch(Host_BLE_Event_t *Event)
+{
+   qapi_BLE_GAP_LE_Event_Data_t                    GAP_LE_Event_Data;
+   qapi_BLE_GAP_LE_Advertising_Report_Event_Data_t Advertising_Report_Event_Data;
+   qapi_BLE_GATT_Connection_Event_Data_t           GATT_Connection_Event_Data;
+   qapi_BLE_GATT_Client_Event_Data_t               GATT_Client_Event_Data;
+   qapi_BLE_GATT_Service_Discovery_Event_Data_t    GATT_Discovery_Event_Data;
+
+   switch(Event->Type)
+   {
+      case HOST_BLE_EVENT_GAP_LE_E:
+         memset(&GAP_LE_Event_Data, 0, sizeof(GAP_LE_Event_Data));
+         GAP_LE_Event_Data.Event_Data_Type = (qapi_BLE_GAP_LE_Event_Type_t)Event->Event_Data_Type;
+
+         if(Event->Event_Data_Type == QAPI_BLE_ET_LE_ADVERTISING_REPORT_E)
+         {
+            Event->Data.Advertising_Report.Report.Advertising_Data.Data_Entries = &(Event->Data.Advertising_Report.Entry);
+            Event->Data.Advertising_Report.Entry.AD_Data_Buffer                 = Event->Data.Advertising_Report.Name;
+
+            Advertising_Report_Event_Data.Number_Device_Entries = 1;
+            Advertising_Report_Event_Data.Advertising_Data      = &(Event->Data.Advertising_Report.Report);
+
+            GAP_LE_Event_Data.Event_Data_Size                                 = sizeof(Advertising_Report_Event_Data);
+            GAP_LE_Event_Data.Event_Data.GAP_LE_Advertising_Report_Event_Data = &Advertising_Report_Event_Data;
+         }
+         else if(Event->Event_Data_Type == QAPI_BLE_ET_LE_CONNECTION_COMPLETE_E)
+         {
+            GAP_LE_Event_Data.Event_Data_Size                                  = sizeof(Event->Data.Connection_Complete);
+            GAP_LE_Event_Data.Event_Data.GAP_LE_Connection_Complete_Event_Data = &(Event->Data.Connection_Complete);
+         }
+         else
+         {
+            GAP_LE_Event_Data.Event_Data_Size                                     = sizeof(Event->Data.Disconnection_Complete);
+            GAP_LE_Event_Data.Event_Data.GAP_LE_Disconnection_Complete_Event_Data = &(Event->Data.Disconnection_Complete);
+         }
+
+         (*(Event->Callback.GAP_LE))(HOST_BLE_STACK_ID, &GAP_LE_Event_Data, Event->Callback_Parameter);
+         break;
+
+      case HOST_BLE_EVENT_GATT_CONNECTION_E:
+         memset(&GATT_Connection_Event_Data, 0, sizeof(GATT_Connection_Event_Data));
+         GATT_Connection_Event_Data.Event_Data_Type = (qapi_BLE_GATT_Connection_Event_Type_t)Event->Event_Data_Type;
+
+         if(Event->Event_Data_Type == QAPI_BLE_ET_GATT_CONNECTION_DEVICE_CONNECTION_E)
+         {
+            GATT_Connection_Event_Data.Event_Data_Size                        = sizeof(Event->Data.Device_Connection);
+            GATT_Connection_Event_Data.Event_Data.GATT_Device_Connection_Data = &(Event->Data.Device_Connection);
+         }
+         else
+         {
+            GATT_Connection_Event_Data.Event_Data_Size                           = sizeof(Event->Data.Device_Disconnection);
+            GATT_Connection_Event_Data.Event_Data.GATT_Device_Disconnection_Data = &(Event->Data.Device_Disconnection);
+         }
+
+         (*(Event->Callback.GATT_Connection))(HOST_BLE_STACK_ID, &GATT_Connection_Event_Data, Event->Callback_Parameter);
+         break;
+
+      case HOST_BLE_EVENT_GATT_CLIENT_E:
+         memset(&GATT_Client_Event_Data, 0, sizeof(GATT_Client_Event_Data));
+         GATT_Client_Event_Data.Event_Data_Type = (qapi_BLE_GATT_Client_Event_Type_t)Event->Event_Data_Type;
+
+         if(Event->Event_Data_Type == QAPI_BLE_ET_GATT_CLIENT_EXCHANGE_MTU_RESPONSE_E)
+         {
+            GATT_Client_Event_Data.Event_Data_Size                            = sizeof(Event->Data.Exchange_MTU_Response);
+            GATT_Client_Event_Data.Event_Data.GATT_Exchange_MTU_Response_Data = &(Event->Data.Exchange_MTU_Response);
+         }
+         else if(Event->Event_Data_Type == QAPI_BLE_ET_GATT_CLIENT_WRITE_RESPONSE_E)
+         {
+            GATT_Client_Event_Data.Event_Data_Size                     = sizeof(Event->Data.Write_Response);
+            GATT_Client_Event_Data.Event_Data.GATT_Write_Response_Data = &(Event->Data.Write_Response);
+         }
+         else
+         {
+            GATT_Client_Event_Data.Event_Data_Size                    = sizeof(Event->Data.Request_Error);
+            GATT_Client_Event_Data.Event_Data.GATT_Request_Error_Data = &(Event->Data.Request_Error);
+         }
+
+         (*(Event->Callback.GATT_Client))(HOST_BLE_STACK_ID, &GATT_Client_Event_Data, Event->Callback_Parameter);
+         break;
+
+      case HOST_BLE_EVENT_GATT_DISCOVERY_E:
+         memset(&GATT_Discovery_Event_Data, 0, sizeof(GATT_Discovery_Event_Data));
+         GATT_Discovery_Event_Data.Event_Data_Type = (qapi_BLE_GATT_Service_Discovery_Event_Type_t)Event->Event_Data_Type;
+
+         if(Event->Event_Data_Type == QAPI_BLE_ET_GATT_SERVICE_DISCOVERY_INDICATION_E)
+         {
+            Event->Data.Discovery_Indication.Indication.CharacteristicInformationList = &(Event->Data.Discovery_Indication.Characteristic);
+
+            GATT_Discovery_Event_Data.Event_Data_Size                                   = sizeof(Event->Data.Discovery_Indication.Indication);
+            GATT_Discovery_Event_Data.Event_Data.GATT_Service_Discovery_Indication_Data = &(Event->Data.Discovery_Indication.Indication);
+         }
+         else
+         {
+            GATT_Discovery_Event_Data.Event_Data_Size                                 = sizeof(Event->Data.Discovery_Complete);
+            GATT_Discovery_Event_Data.Event_Data.GATT_Service_Discovery_Complete_Data = &(Event->Data.Discovery_Complete);
+         }
+
+         (*(Event->Callback.GATT_Discovery))(HOST_BLE_STACK_ID, &GATT_Discovery_Event_Data, Event->Callback_Parameter);
+         break;
+
+      case HOST_BLE_EVENT_TIMER_E:
+      default:
+         (*(Event->Callback.Timer))(HOST_BLE_STACK_ID, Event->Key, Event->Callback_Parameter);
+         break;
+   }
+}
+
+/**
+   @brief This function is the thread which dispatches the events, it
+          stands in for the Bluetooth stack thread on the target.
+
+   @param Parameter is not used.
+
+   @return NULL, the thread never ends.
+*/
+static void *Host_BLE_Thread(void *Parameter)
+{
+   Host_BLE_Event_t *Event;
+   struct timespec   Now;
+   struct timespec   Due;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   while(true)
+   {
+      if((Event = Host_BLE_Context.Event_List) == NULL)
+      {
+         pthread_cond_wait(&(Host_BLE_Context.Condition), &(Host_BLE_Context.Mutex));
+      }
+      else
+      {
+         clock_gettime(CLOCK_MONOTONIC, &Now);
+
+         if((Now.tv_sec > Event->Due.tv_sec) || ((Now.tv_sec == Event->Due.tv_sec) && (Now.tv_nsec >= Event->Due.tv_nsec)))
+         {
+            Host_BLE_Context.Event_List = Event->Next;
+
+            pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+            Host_BLE_Dispatch(Event);
+            free(Event);
+
+            pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+         }
+         else
+         {
+            /* The event may be removed while waiting. */
+            Due = Event->Due;
+            pthread_cond_timedwait(&(Host_BLE_Context.Condition), &(Host_BLE_Context.Mutex), &Due);
+         }
+      }
+   }
+
+   return(NULL);
+}
+
+/**
+   @brief This function compares the key of a generic list entry.
+
+   @param Key is the type of the key.
+   @param Key_Value points to the key value searched for.
+   @param Key_Offset is the offset of the key in the entry.
+   @param Entry is the entry.
+
+   @return true if the key of the entry matches.
+*/
+static qbool_t Host_BLE_Entry_Matches(qapi_BLE_BSC_Generic_List_Entry_Key_t Key, void *Key_Value, uint32_t Key_Offset, void *Entry)
+{
+   uint8_t *Entry_Key;
+   qbool_t  Ret_Val;
+
+   Entry_Key = ((uint8_t *)Entry) + Key_Offset;
+
+   switch(Key)
+   {
+      case QAPI_BLE_EK_BOOLEAN_T_E:
+         Ret_Val = (qbool_t)(memcmp(Entry_Key, Key_Value, sizeof(boolean_t)) == 0);
+         break;
+
+      case QAPI_BLE_EK_BYTE_T_E:
+         Ret_Val = (qbool_t)(memcmp(Entry_Key, Key_Value, sizeof(uint8_t)) == 0);
+         break;
+
+      case QAPI_BLE_EK_WORD_T_E:
+         Ret_Val = (qbool_t)(memcmp(Entry_Key, Key_Value, sizeof(uint16_t)) == 0);
+         break;
+
+      case QAPI_BLE_EK_DWORD_T_E:
+         Ret_Val = (qbool_t)(memcmp(Entry_Key, Key_Value, sizeof(uint32_t)) == 0);
+         break;
+
+      case QAPI_BLE_EK_BD_ADDR_T_E:
+         Ret_Val = (qbool_t)(memcmp(Entry_Key, Key_Value, sizeof(qapi_BLE_BD_ADDR_t)) == 0);
+         break;
+
+      case QAPI_BLE_EK_ENTRY_POINTER_E:
+         Ret_Val = (qbool_t)(Entry == Key_Value);
+         break;
+
+      case QAPI_BLE_EK_UNSIGNED_INTEGER_E:
+         Ret_Val = (qbool_t)(memcmp(Entry_Key, Key_Value, sizeof(unsigned int)) == 0);
+         break;
+
+      default:
+         Ret_Val = false;
+         break;
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function gives the fake bulbs their addresses.  The mutex
+          must be held by the caller.
+*/
+static void Host_BLE_Assign_Addresses(void)
+{
+   uint32_t Index;
+
+   for(Index = 0; Index < HOST_BLE_MAX_BULBS; Index ++)
+   {
+      QAPI_BLE_ASSIGN_BD_ADDR(Host_BLE_Context.Bulb[Index].BD_ADDR, 0xC0, 0xFF, 0xEE, 0x00, (uint8_t)(Index >> 8), (uint8_t)Index);
+   }
+}
+
+/**
+   @brief This function sets the bulbs in range of the fake.  Bulbs taken
+          out of range lose their connection with a supervision timeout.
+
+   @param Count is the number of bulbs in range.
+   @param Fail_Percent is the chance (0 to 100) of a connection attempt or
+          a write to a bulb failing.
+   @param Latency is the time (in milliseconds) the controller takes to
+          answer a request.
+
+   @return true if the bulbs were set or false if a parameter was invalid.
+*/
+qbool_t Host_BLE_Set_Bulbs(uint32_t Count, uint32_t Fail_Percent, uint32_t Latency)
+{
+   qbool_t  Ret_Val;
+   uint32_t Index;
+
+   if((Count <= HOST_BLE_MAX_BULBS) && (Fail_Percent <= 100))
+   {
+      pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+      Host_BLE_Assign_Addresses();
+
+      for(Index = Count; Index < Host_BLE_Context.Bulb_Count; Index ++)
+      {
+         if(Host_BLE_Context.Bulb[Index].Connected)
+         {
+            Host_BLE_Drop_Connection(&(Host_BLE_Context.Bulb[Index]), QAPI_BLE_HCI_ERROR_CODE_CONNECTION_TIMEOUT);
+         }
+
+         Host_BLE_Context.Bulb[Index].Writes        = 0;
+         Host_BLE_Context.Bulb[Index].Failed_Writes = 0;
+         Host_BLE_Context.Bulb[Index].Value         = 0;
+      }
+
+      Host_BLE_Context.Bulb_Count   = Count;
+      Host_BLE_Context.Fail_Percent = Fail_Percent;
+      Host_BLE_Context.Latency      = Latency;
+
+      pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+      Ret_Val = true;
+   }
+   else
+   {
+      Ret_Val = false;
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function gets the settings of the fake.
+
+   @param Count is where the number of bulbs in range is returned.
+   @param Fail_Percent is where the failure chance is returned.
+   @param Latency is where the controller latency is returned.
+*/
+void Host_BLE_Get_Bulbs(uint32_t *Count, uint32_t *Fail_Percent, uint32_t *Latency)
+{
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   *Count        = Host_BLE_Context.Bulb_Count;
+   *Fail_Percent = Host_BLE_Context.Fail_Percent;
+   *Latency      = Host_BLE_Context.Latency;
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+}
+
+/**
+   @brief This function gets the state of a bulb.
+
+   @param Index is the index of the bulb.
+   @param Info is where the state is returned.
+
+   @return true if the state was returned or false if the bulb is not in
+           range.
+*/
+qbool_t Host_BLE_Get_Bulb(uint32_t Index, Host_BLE_Bulb_Info_t *Info)
+{
+   qbool_t Ret_Val;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   if(Index < Host_BLE_Context.Bulb_Count)
+   {
+      Info->Connected     = Host_BLE_Context.Bulb[Index].Connected;
+      Info->Connection_ID = Host_BLE_Context.Bulb[Index].Connection_ID;
+      Info->Writes        = Host_BLE_Context.Bulb[Index].Writes;
+      Info->Failed_Writes = Host_BLE_Context.Bulb[Index].Failed_Writes;
+      Info->Value         = Host_BLE_Context.Bulb[Index].Value;
+
+      Ret_Val = true;
+   }
+   else
+   {
+      Ret_Val = false;
+   }
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+   return(Ret_Val);
+}
+
+/*-------------------------------------------------------------------------
+ * Bluetooth Stack Control
+ *-----------------------------------------------------------------------*/
+
+int qapi_BLE_BSC_Initialize(qapi_BLE_HCI_DriverInformation_t *HCI_DriverInformation, uint32_t Flags)
+{
+   pthread_condattr_t Condition_Attr;
+   pthread_t          Thread;
+   int                Ret_Val;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   if(Host_BLE_Context.Initialized)
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_PARAMETER;
+   }
+   else
+   {
+      Ret_Val = HOST_BLE_STACK_ID;
+
+      if(!Host_BLE_Context.Thread_Started)
+      {
+         /* The event times are taken from the monotonic clock. */
+         pthread_condattr_init(&Condition_Attr);
+         pthread_condattr_setclock(&Condition_Attr, CLOCK_MONOTONIC);
+         pthread_cond_destroy(&(Host_BLE_Context.Condition));
+         pthread_cond_init(&(Host_BLE_Context.Condition), &Condition_Attr);
+         pthread_condattr_destroy(&Condition_Attr);
+
+         if(pthread_create(&Thread, NULL, Host_BLE_Thread, NULL) == 0)
+         {
+            pthread_detach(Thread);
+            Host_BLE_Context.Thread_Started = true;
+         }
+         else
+         {
+            Ret_Val = QAPI_BLE_BTPS_ERROR_INSUFFICIENT_RESOURCES;
+         }
+      }
+
+      if(Ret_Val > 0)
+      {
+         Host_BLE_Assign_Addresses();
+         Host_BLE_Context.Initialized = true;
+      }
+   }
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+   return(Ret_Val);
+}
+
+void qapi_BLE_BSC_Shutdown(uint32_t BluetoothStackID)
+{
+   Host_BLE_Event_t *Event;
+   uint32_t          Index;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   if((BluetoothStackID == HOST_BLE_STACK_ID) && (Host_BLE_Context.Initialized))
+   {
+      while((Event = Host_BLE_Context.Event_List) != NULL)
+      {
+         Host_BLE_Context.Event_List = Event->Next;
+         free(Event);
+      }
+
+      for(Index = 0; Index < HOST_BLE_MAX_BULBS; Index ++)
+      {
+         Host_BLE_Context.Bulb[Index].Connected       = false;
+         Host_BLE_Context.Bulb[Index].Connection_ID   = 0;
+         Host_BLE_Context.Bulb[Index].GAP_LE_Callback = NULL;
+      }
+
+      Host_BLE_Context.Initialized      = false;
+      Host_BLE_Context.GATT_Callback    = NULL;
+      Host_BLE_Context.Scan_Active      = false;
+      Host_BLE_Context.Connecting       = false;
+      Host_BLE_Context.White_List_Count = 0;
+   }
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+}
+
+char *qapi_BLE_BSC_Query_Host_Version(void)
+{
+   return("Host");
+}
+
+/* Callbacks are never made with the context mutex held, so the stack lock
+   has nothing to protect on the host. */
+int qapi_BLE_BSC_LockBluetoothStack(uint32_t BluetoothStackID)
+{
+   return((BluetoothStackID == HOST_BLE_STACK_ID) ? 0 : QAPI_BLE_BTPS_ERROR_INVALID_BLUETOOTH_STACK_ID);
+}
+
+void qapi_BLE_BSC_UnLockBluetoothStack(uint32_t BluetoothStackID)
+{
+}
+
+int qapi_BLE_BSC_StartTimer(uint32_t BluetoothStackID, uint32_t Timeout, qapi_BLE_BSC_Timer_Callback_t TimerCallback, uint32_t CallbackParameter)
+{
+   Host_BLE_Event_t *Event;
+   int               Ret_Val;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   if((BluetoothStackID != HOST_BLE_STACK_ID) || (!Host_BLE_Context.Initialized))
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_BLUETOOTH_STACK_ID;
+   }
+   else if(TimerCallback == NULL)
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_PARAMETER;
+   }
+   else if((Event = Host_BLE_New_Event(HOST_BLE_EVENT_TIMER_E, 0, Host_BLE_New_ID())) == NULL)
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INSUFFICIENT_RESOURCES;
+   }
+   else
+   {
+      Event->Callback.Timer     = TimerCallback;
+      Event->Callback_Parameter = CallbackParameter;
+      Ret_Val                   = (int)Event->Key;
+
+      Host_BLE_Queue_Event(Event, Timeout);
+   }
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+   return(Ret_Val);
+}
+
+int qapi_BLE_BSC_StopTimer(uint32_t BluetoothStackID, uint32_t TimerID)
+{
+   int Ret_Val;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   if((BluetoothStackID != HOST_BLE_STACK_ID) || (!Host_BLE_Context.Initialized))
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_BLUETOOTH_STACK_ID;
+   }
+   else if(!Host_BLE_Remove_Events(HOST_BLE_EVENT_TIMER_E, 0, TimerID))
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_PARAMETER;
+   }
+   else
+   {
+      Ret_Val = 0;
+   }
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+   return(Ret_Val);
+}
+
+int qapi_BLE_BSC_GetTxPower(uint32_t BluetoothStackID, boolean_t Connection, int8_t *TxPower)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+boolean_t qapi_BLE_BSC_AddGenericListEntry_Actual(qapi_BLE_BSC_Generic_List_Entry_Key_t GenericListEntryKey, uint32_t ListEntryKeyOffset, uint32_t ListEntryNextPointerOffset, void **ListHead, void *ListEntryToAdd)
+{
+   boolean_t   Ret_Val;
+   void      **Link;
+
+   Ret_Val = FALSE;
+
+   if((ListHead != NULL) && (ListEntryToAdd != NULL))
+   {
+      Ret_Val = TRUE;
+      Link    = ListHead;
+
+      /* Entries are appended, an entry with the same key is not added. */
+      while((*Link != NULL) && (Ret_Val))
+      {
+         if((GenericListEntryKey != QAPI_BLE_EK_NONE_E) && (Host_BLE_Entry_Matches(GenericListEntryKey, ((uint8_t *)ListEntryToAdd) + ListEntryKeyOffset, ListEntryKeyOffset, *Link)))
+         {
+            Ret_Val = FALSE;
+         }
+         else
+         {
+            Link = (void **)(((uint8_t *)*Link) + ListEntryNextPointerOffset);
+         }
+      }
+
+      if(Ret_Val)
+      {
+         *((void **)(((uint8_t *)ListEntryToAdd) + ListEntryNextPointerOffset)) = NULL;
+         *Link                                                                 = ListEntryToAdd;
+      }
+   }
+
+   return(Ret_Val);
+}
+
+void *qapi_BLE_BSC_SearchGenericListEntry(qapi_BLE_BSC_Generic_List_Entry_Key_t GenericListEntryKey, void *GenericListEntryKeyValue, uint32_t ListEntryKeyOffset, uint32_t ListEntryNextPointerOffset, void **ListHead)
+{
+   void *Ret_Val;
+   void *Entry;
+
+   Ret_Val = NULL;
+
+   if((ListHead != NULL) && (GenericListEntryKeyValue != NULL) && (GenericListEntryKey != QAPI_BLE_EK_NONE_E))
+   {
+      Entry = *ListHead;
+
+      while((Entry != NULL) && (Ret_Val == NULL))
+      {
+         if(Host_BLE_Entry_Matches(GenericListEntryKey, GenericListEntryKeyValue, ListEntryKeyOffset, Entry))
+         {
+            Ret_Val = Entry;
+         }
+         else
+         {
+            Entry = *((void **)(((uint8_t *)Entry) + ListEntryNextPointerOffset));
+         }
+      }
+   }
+
+   return(Ret_Val);
+}
+
+void *qapi_BLE_BSC_DeleteGenericListEntry(qapi_BLE_BSC_Generic_List_Entry_Key_t GenericListEntryKey, void *GenericListEntryKeyValue, uint32_t ListEntryKeyOffset, uint32_t ListEntryNextPointerOffset, void **ListHead)
+{
+   void  *Ret_Val;
+   void **Link;
+
+   Ret_Val = NULL;
+
+   if((ListHead != NULL) && (GenericListEntryKeyValue != NULL) && (GenericListEntryKey != QAPI_BLE_EK_NONE_E))
+   {
+      Link = ListHead;
+
+      while((*Link != NULL) && (Ret_Val == NULL))
+      {
+         if(Host_BLE_Entry_Matches(GenericListEntryKey, GenericListEntryKeyValue, ListEntryKeyOffset, *Link))
+         {
+            /* The entry is unlinked, freeing it is up to the caller. */
+            Ret_Val = *Link;
+            *Link   = *((void **)(((uint8_t *)Ret_Val) + ListEntryNextPointerOffset));
+            *((void **)(((uint8_t *)Ret_Val) + ListEntryNextPointerOffset)) = NULL;
+         }
+         else
+         {
+            Link = (void **)(((uint8_t *)*Link) + ListEntryNextPointerOffset);
+         }
+      }
+   }
+
+   return(Ret_Val);
+}
+
+void qapi_BLE_BSC_FreeGenericListEntryMemory(void *EntryToFree)
+{
+   free(EntryToFree);
+}
+
+void qapi_BLE_BSC_FreeGenericListEntryList(void **ListHead, uint32_t ListEntryNextPointerOffset)
+{
+   void *Entry;
+
+   if(ListHead != NULL)
+   {
+      while((Entry = *ListHead) != NULL)
+      {
+         *ListHead = *((void **)(((uint8_t *)Entry) + ListEntryNextPointerOffset));
+         free(Entry);
+      }
+   }
+}
+
+/*-------------------------------------------------------------------------
+ * HCI
+ *-----------------------------------------------------------------------*/
+
+int qapi_BLE_HCI_Version_Supported(uint32_t BluetoothStackID, qapi_BLE_HCI_Version_t *HCI_Version)
+{
+   int Ret_Val;
+
+   if(HCI_Version != NULL)
+   {
+      *HCI_Version = QAPI_BLE_HV_SPECIFICATION_5_0_E;
+      Ret_Val = 0;
+   }
+   else
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_PARAMETER;
+   }
+
+   return(Ret_Val);
+}
+
+int qapi_BLE_HCI_LE_Read_Buffer_Size(uint32_t BluetoothStackID, uint8_t *StatusResult, uint16_t *HC_LE_ACL_Data_Packet_Length, uint8_t *HC_Total_Num_LE_ACL_Data_Packets)
+{
+   int Ret_Val;
+
+   if((StatusResult != NULL) && (HC_LE_ACL_Data_Packet_Length != NULL) && (HC_Total_Num_LE_ACL_Data_Packets != NULL))
+   {
+      *StatusResult                     = QAPI_BLE_HCI_ERROR_CODE_NO_ERROR;
+      *HC_LE_ACL_Data_Packet_Length     = 251;
+      *HC_Total_Num_LE_ACL_Data_Packets = 8;
+      Ret_Val = 0;
+   }
+   else
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_PARAMETER;
+   }
+
+   return(Ret_Val);
+}
+
+int qapi_BLE_HCI_LE_Rand(uint32_t BluetoothStackID, uint8_t *StatusResult, qapi_BLE_Random_Number_t *Random_NumberResult)
+{
+   int      Ret_Val;
+   uint32_t Index;
+
+   if((StatusResult != NULL) && (Random_NumberResult != NULL))
+   {
+      pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+      for(Index = 0; Index < sizeof(qapi_BLE_Random_Number_t); Index ++)
+      {
+         ((uint8_t *)Random_NumberResult)[Index] = (uint8_t)rand_r(&(Host_BLE_Context.Seed));
+      }
+
+      pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+      *StatusResult = QAPI_BLE_HCI_ERROR_CODE_NO_ERROR;
+      Ret_Val = 0;
+   }
+   else
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_PARAMETER;
+   }
+
+   return(Ret_Val);
+}
+
+int HCI_VS_GetPatchVersion(unsigned int BluetoothStackID, uint32_t *ProductID, uint32_t *BuildVersion)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int HCI_VS_EnableBBIF(unsigned int BluetoothStackID, boolean_t Enable)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int HCI_VS_SetRadio(unsigned int BluetoothStackID, unsigned int RadioNumber)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+/*-------------------------------------------------------------------------
+ * GAP
+ *-----------------------------------------------------------------------*/
+
+int qapi_BLE_GAP_Query_Local_BD_ADDR(uint32_t BluetoothStackID, qapi_BLE_BD_ADDR_t *BD_ADDR)
+{
+   int Ret_Val;
+
+   if(BD_ADDR != NULL)
+   {
+      QAPI_BLE_ASSIGN_BD_ADDR(*BD_ADDR, 0xC0, 0xFF, 0xEE, 0xFF, 0xFF, 0xFF);
+      Ret_Val = 0;
+   }
+   else
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_PARAMETER;
+   }
+
+   return(Ret_Val);
+}
+
+/* Not the AES based function of the specification, it only needs to give
+   a stable result for the same input. */
+int qapi_BLE_GAP_LE_Diversify_Function(uint32_t BluetoothStackID, qapi_BLE_Encryption_Key_t *Key, uint16_t DIn, uint16_t RIn, qapi_BLE_Encryption_Key_t *Result)
+{
+   int Ret_Val;
+
+   if((Key != NULL) && (Result != NULL))
+   {
+      memcpy(Result, Key, sizeof(qapi_BLE_Encryption_Key_t));
+      ((uint8_t *)Result)[0] ^= (uint8_t)DIn;
+      ((uint8_t *)Result)[1] ^= (uint8_t)(DIn >> 8);
+      ((uint8_t *)Result)[2] ^= (uint8_t)RIn;
+      ((uint8_t *)Result)[3] ^= (uint8_t)(RIn >> 8);
+      Ret_Val = 0;
+   }
+   else
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_PARAMETER;
+   }
+
+   return(Ret_Val);
+}
+
+int qapi_BLE_GAP_LE_Set_Pairability_Mode(uint32_t BluetoothStackID, qapi_BLE_GAP_LE_Pairability_Mode_t PairableMode)
+{
+   return(0);
+}
+
+int qapi_BLE_GAP_LE_Register_Remote_Authentication(uint32_t BluetoothStackID, qapi_BLE_GAP_LE_Event_Callback_t GAP_LE_Event_Callback, uint32_t CallbackParameter)
+{
+   return(0);
+}
+
+int qapi_BLE_GAP_LE_Set_Address_Resolution_Enable(uint32_t BluetoothStackID, boolean_t EnableAddressResolution)
+{
+   return(0);
+}
+
+int qapi_BLE_GAP_LE_Set_Resolvable_Private_Address_Timeout(uint32_t BluetoothStackID, uint32_t RPA_Timeout)
+{
+   return(0);
+}
+
+int qapi_BLE_GAP_LE_Perform_Scan(uint32_t BluetoothStackID, qapi_BLE_GAP_LE_Scan_Type_t ScanType, uint32_t ScanInterval, uint32_t ScanWindow, qapi_BLE_GAP_LE_Address_Type_t LocalAddressType, qapi_BLE_GAP_LE_Filter_Policy_t FilterPolicy, boolean_t FilterDuplicates, qapi_BLE_GAP_LE_Event_Callback_t GAP_LE_Event_Callback, uint32_t CallbackParameter)
+{
+   Host_BLE_Event_t *Event;
+   int               Ret_Val;
+   uint32_t          Index;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   if((BluetoothStackID != HOST_BLE_STACK_ID) || (!Host_BLE_Context.Initialized))
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_BLUETOOTH_STACK_ID;
+   }
+   else if(GAP_LE_Event_Callback == NULL)
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_PARAMETER;
+   }
+   else if(Host_BLE_Context.Scan_Active)
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_SCAN_ACTIVE;
+   }
+   else
+   {
+      Host_BLE_Context.Scan_Active = true;
+      Ret_Val                      = 0;
+
+      /* Every bulb that is not connected advertises once per scan. */
+      for(Index = 0; Index < Host_BLE_Context.Bulb_Count; Index ++)
+      {
+         if((!Host_BLE_Context.Bulb[Index].Connected) && ((Event = Host_BLE_New_Event(HOST_BLE_EVENT_GAP_LE_E, QAPI_BLE_ET_LE_ADVERTISING_REPORT_E, 0)) != NULL))
+         {
+            Event->Callback.GAP_LE                                                     = GAP_LE_Event_Callback;
+            Event->Callback_Parameter                                                  = CallbackParameter;
+            Event->Data.Advertising_Report.Report.Advertising_Report_Type              = QAPI_BLE_RT_CONNECTABLE_UNDIRECTED_E;
+            Event->Data.Advertising_Report.Report.Address_Type                         = QAPI_BLE_LAT_PUBLIC_E;
+            Event->Data.Advertising_Report.Report.BD_ADDR                              = Host_BLE_Context.Bulb[Index].BD_ADDR;
+            Event->Data.Advertising_Report.Report.RSSI                                 = (int8_t)(-40 - (int)(Index % 50));
+            Event->Data.Advertising_Report.Report.Advertising_Data.Number_Data_Entries = 1;
+            Event->Data.Advertising_Report.Entry.AD_Type                               = HOST_BLE_AD_TYPE_LOCAL_NAME;
+            Event->Data.Advertising_Report.Entry.AD_Data_Length                        = (uint8_t)sizeof(Event->Data.Advertising_Report.Name);
+            memcpy(Event->Data.Advertising_Report.Name, HOST_BLE_BULB_NAME, sizeof(Event->Data.Advertising_Report.Name));
+
+            Host_BLE_Queue_Event(Event, Host_BLE_Context.Latency);
+         }
+      }
+   }
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+   return(Ret_Val);
+}
+
+int qapi_BLE_GAP_LE_Cancel_Scan(uint32_t BluetoothStackID)
+{
+   int Ret_Val;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   if((BluetoothStackID != HOST_BLE_STACK_ID) || (!Host_BLE_Context.Initialized))
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_BLUETOOTH_STACK_ID;
+   }
+   else
+   {
+      Host_BLE_Remove_Events(HOST_BLE_EVENT_GAP_LE_E, QAPI_BLE_ET_LE_ADVERTISING_REPORT_E, 0);
+
+      Host_BLE_Context.Scan_Active = false;
+      Ret_Val                      = 0;
+   }
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+   return(Ret_Val);
+}
+
+int qapi_BLE_GAP_LE_Add_Device_To_White_List(uint32_t BluetoothStackID, uint32_t DeviceCount, qapi_BLE_GAP_LE_White_List_Entry_t *WhiteListEntries, uint32_t *AddedDeviceCount)
+{
+   int      Ret_Val;
+   uint32_t Index;
+   uint32_t Entry;
+   qbool_t  Found;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   if((BluetoothStackID != HOST_BLE_STACK_ID) || (!Host_BLE_Context.Initialized))
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_BLUETOOTH_STACK_ID;
+   }
+   else if((DeviceCount == 0) || (WhiteListEntries == NULL) || (AddedDeviceCount == NULL))
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_PARAMETER;
+   }
+   else
+   {
+      *AddedDeviceCount = 0;
+      Ret_Val = 0;
+
+      for(Index = 0; Index < DeviceCount; Index ++)
+      {
+         Found = false;
+         for(Entry = 0; (Entry < Host_BLE_Context.White_List_Count) && (!Found); Entry ++)
+         {
+            Found = (qbool_t)QAPI_BLE_COMPARE_BD_ADDR(Host_BLE_Context.White_List[Entry], WhiteListEntries[Index].Address);
+         }
+
+         if(!Found)
+         {
+            if(Host_BLE_Context.White_List_Count < HOST_BLE_MAX_BULBS)
+            {
+               Host_BLE_Context.White_List[Host_BLE_Context.White_List_Count ++] = WhiteListEntries[Index].Address;
+               (*AddedDeviceCount) ++;
+            }
+            else
+            {
+               Ret_Val = QAPI_BLE_BTPS_ERROR_INSUFFICIENT_RESOURCES;
+            }
+         }
+      }
+   }
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+   return(Ret_Val);
+}
+
+int qapi_BLE_GAP_LE_Remove_Device_From_White_List(uint32_t BluetoothStackID, uint32_t DeviceCount, qapi_BLE_GAP_LE_White_List_Entry_t *WhiteListEntries, uint32_t *RemovedDeviceCount)
+{
+   int      Ret_Val;
+   uint32_t Index;
+   uint32_t Entry;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   if((BluetoothStackID != HOST_BLE_STACK_ID) || (!Host_BLE_Context.Initialized))
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_BLUETOOTH_STACK_ID;
+   }
+   else if((DeviceCount == 0) || (WhiteListEntries == NULL) || (RemovedDeviceCount == NULL))
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_PARAMETER;
+   }
+   else
+   {
+      *RemovedDeviceCount = 0;
+      Ret_Val = 0;
+
+      for(Index = 0; Index < DeviceCount; Index ++)
+      {
+         for(Entry = 0; Entry < Host_BLE_Context.White_List_Count; Entry ++)
+         {
+            if(QAPI_BLE_COMPARE_BD_ADDR(Host_BLE_Context.White_List[Entry], WhiteListEntries[Index].Address))
+            {
+               Host_BLE_Context.White_List[Entry] = Host_BLE_Context.White_List[-- Host_BLE_Context.White_List_Count];
+               (*RemovedDeviceCount) ++;
+               break;
+            }
+         }
+      }
+   }
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+   return(Ret_Val);
+}
+
+int qapi_BLE_GAP_LE_Create_Connection(uint32_t BluetoothStackID, uint32_t ScanInterval, uint32_t ScanWindow, qapi_BLE_GAP_LE_Filter_Policy_t InitatorFilterPolicy, qapi_BLE_GAP_LE_Address_Type_t RemoteAddressType, qapi_BLE_BD_ADDR_t *RemoteDevice, qapi_BLE_GAP_LE_Address_Type_t LocalAddressType, qapi_BLE_GAP_LE_Connection_Parameters_t *ConnectionParameters, qapi_BLE_GAP_LE_Event_Callback_t GAP_LE_Event_Callback, uint32_t CallbackParameter)
+{
+   Host_BLE_Event_t *Event;
+   Host_BLE_Bulb_t  *Bulb;
+   int               Ret_Val;
+   uint32_t          Entry;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   if((BluetoothStackID != HOST_BLE_STACK_ID) || (!Host_BLE_Context.Initialized))
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_BLUETOOTH_STACK_ID;
+   }
+   else if((ConnectionParameters == NULL) || (GAP_LE_Event_Callback == NULL) || ((InitatorFilterPolicy != QAPI_BLE_FP_WHITE_LIST_E) && (RemoteDevice == NULL)))
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_PARAMETER;
+   }
+   else if(Host_BLE_Context.Connecting)
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_CREATE_CONNECTION_OUTSTANDING;
+   }
+   else
+   {
+      Host_BLE_Context.Connecting        = true;
+      Host_BLE_Context.Connect_Callback  = GAP_LE_Event_Callback;
+      Host_BLE_Context.Connect_Parameter = CallbackParameter;
+      Ret_Val                            = 0;
+
+      /* Find the bulb that answers.  With the white list it is the first
+         listed bulb in range that is not connected yet.  A bulb that
+         does not answer leaves the connection pending until it is
+         cancelled. */
+      Bulb = NULL;
+      if(InitatorFilterPolicy == QAPI_BLE_FP_WHITE_LIST_E)
+      {
+         for(Entry = 0; (Entry < Host_BLE_Context.White_List_Count) && (Bulb == NULL); Entry ++)
+         {
+            Bulb = Host_BLE_Find_Bulb(&(Host_BLE_Context.White_List[Entry]));
+            if((Bulb != NULL) && ((Bulb->Connected) || (Host_BLE_Fails())))
+            {
+               Bulb = NULL;
+            }
+         }
+      }
+      else
+      {
+         Bulb = Host_BLE_Find_Bulb(RemoteDevice);
+         if((Bulb != NULL) && ((Bulb->Connected) || (Host_BLE_Fails())))
+         {
+            Bulb = NULL;
+         }
+      }
+
+      if(Bulb != NULL)
+      {
+         Bulb->Connected        = true;
+         Bulb->Connection_ID    = Host_BLE_New_ID();
+         Bulb->GAP_LE_Callback  = GAP_LE_Event_Callback;
+         Bulb->GAP_LE_Parameter = CallbackParameter;
+
+         Host_BLE_Context.Connecting = false;
+
+         if((Event = Host_BLE_New_Event(HOST_BLE_EVENT_GAP_LE_E, QAPI_BLE_ET_LE_CONNECTION_COMPLETE_E, 0)) != NULL)
+         {
+            Event->Callback.GAP_LE                                                            = GAP_LE_Event_Callback;
+            Event->Callback_Parameter                                                         = CallbackParameter;
+            Event->Data.Connection_Complete.Status                                            = QAPI_BLE_HCI_ERROR_CODE_NO_ERROR;
+            Event->Data.Connection_Complete.Master                                            = TRUE;
+            Event->Data.Connection_Complete.Peer_Address_Type                                 = QAPI_BLE_LAT_PUBLIC_E;
+            Event->Data.Connection_Complete.Peer_Address                                      = Bulb->BD_ADDR;
+            Event->Data.Connection_Complete.Current_Connection_Parameters.Connection_Interval = ConnectionParameters->Connection_Interval_Max;
+            Event->Data.Connection_Complete.Current_Connection_Parameters.Slave_Latency       = ConnectionParameters->Slave_Latency;
+            Event->Data.Connection_Complete.Current_Connection_Parameters.Supervision_Timeout = ConnectionParameters->Supervision_Timeout;
+
+            Host_BLE_Queue_Event(Event, Host_BLE_Context.Latency);
+         }
+
+         if((Host_BLE_Context.GATT_Callback != NULL) && ((Event = Host_BLE_New_Event(HOST_BLE_EVENT_GATT_CONNECTION_E, QAPI_BLE_ET_GATT_CONNECTION_DEVICE_CONNECTION_E, 0)) != NULL))
+         {
+            Event->Callback.GATT_Connection              = Host_BLE_Context.GATT_Callback;
+            Event->Callback_Parameter                    = Host_BLE_Context.GATT_Parameter;
+            Event->Data.Device_Connection.ConnectionID   = Bulb->Connection_ID;
+            Event->Data.Device_Connection.ConnectionType = QAPI_BLE_GCT_LE_E;
+            Event->Data.Device_Connection.RemoteDevice   = Bulb->BD_ADDR;
+            Event->Data.Device_Connection.MTU            = 23;
+
+            Host_BLE_Queue_Event(Event, Host_BLE_Context.Latency);
+         }
+      }
+   }
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+   return(Ret_Val);
+}
+
+int qapi_BLE_GAP_LE_Cancel_Create_Connection(uint32_t BluetoothStackID)
+{
+   Host_BLE_Event_t *Event;
+   int               Ret_Val;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   if((BluetoothStackID != HOST_BLE_STACK_ID) || (!Host_BLE_Context.Initialized))
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_BLUETOOTH_STACK_ID;
+   }
+   else if(!Host_BLE_Context.Connecting)
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_CONNECTION_STATE;
+   }
+   else
+   {
+      Host_BLE_Context.Connecting = false;
+      Ret_Val                     = 0;
+
+      /* The controller ends the pending connection as the target does. */
+      if((Event = Host_BLE_New_Event(HOST_BLE_EVENT_GAP_LE_E, QAPI_BLE_ET_LE_CONNECTION_COMPLETE_E, 0)) != NULL)
+      {
+         Event->Callback.GAP_LE                 = Host_BLE_Context.Connect_Callback;
+         Event->Callback_Parameter              = Host_BLE_Context.Connect_Parameter;
+         Event->Data.Connection_Complete.Status = QAPI_BLE_HCI_ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER;
+         Event->Data.Connection_Complete.Master = TRUE;
+
+         Host_BLE_Queue_Event(Event, Host_BLE_Context.Latency);
+      }
+   }
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+   return(Ret_Val);
+}
+
+int qapi_BLE_GAP_LE_Disconnect(uint32_t BluetoothStackID, qapi_BLE_BD_ADDR_t BD_ADDR)
+{
+   Host_BLE_Bulb_t *Bulb;
+   int              Ret_Val;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   if((BluetoothStackID != HOST_BLE_STACK_ID) || (!Host_BLE_Context.Initialized))
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_BLUETOOTH_STACK_ID;
+   }
+   else if(((Bulb = Host_BLE_Find_Bulb(&BD_ADDR)) == NULL) || (!Bulb->Connected))
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_DEVICE_NOT_CONNECTED;
+   }
+   else
+   {
+      Host_BLE_Drop_Connection(Bulb, QAPI_BLE_HCI_ERROR_CODE_CONNECTION_TERMINATED_BY_LOCAL_HOST);
+      Ret_Val = 0;
+   }
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+   return(Ret_Val);
+}
+
+/*-------------------------------------------------------------------------
+ * GATT
+ *-----------------------------------------------------------------------*/
+
+int qapi_BLE_GATT_Initialize(uint32_t BluetoothStackID, uint32_t Flags, qapi_BLE_GATT_Connection_Event_Callback_t ConnectionEventCallback, uint32_t CallbackParameter)
+{
+   int Ret_Val;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   if((BluetoothStackID != HOST_BLE_STACK_ID) || (!Host_BLE_Context.Initialized))
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INVALID_BLUETOOTH_STACK_ID;
+   }
+   else
+   {
+      Host_BLE_Context.GATT_Callback  = ConnectionEventCallback;
+      Host_BLE_Context.GATT_Parameter = CallbackParameter;
+      Ret_Val                         = 0;
+   }
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+   return(Ret_Val);
+}
+
+int qapi_BLE_GATT_Cleanup(uint32_t BluetoothStackID)
+{
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   Host_BLE_Context.GATT_Callback = NULL;
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+   return(0);
+}
+
+int qapi_BLE_GATT_Query_Maximum_Supported_MTU(uint32_t BluetoothStackID, uint16_t *MTU)
+{
+   int Ret_Val;
+
+   if(MTU != NULL)
+   {
+      *MTU    = HOST_BLE_MTU;
+      Ret_Val = 0;
+   }
+   else
+   {
+      Ret_Val = QAPI_BLE_GATT_ERROR_INVALID_PARAMETER;
+   }
+
+   return(Ret_Val);
+}
+
+int qapi_BLE_GATT_Exchange_MTU_Request(uint32_t BluetoothStackID, uint32_t ConnectionID, uint16_t RequestedMTU, qapi_BLE_GATT_Client_Event_Callback_t ClientEventCallback, uint32_t CallbackParameter)
+{
+   Host_BLE_Event_t *Event;
+   Host_BLE_Bulb_t  *Bulb;
+   int               Ret_Val;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   if((BluetoothStackID != HOST_BLE_STACK_ID) || (!Host_BLE_Context.Initialized))
+   {
+      Ret_Val = QAPI_BLE_GATT_ERROR_NOT_INITIALIZED;
+   }
+   else if(ClientEventCallback == NULL)
+   {
+      Ret_Val = QAPI_BLE_GATT_ERROR_INVALID_PARAMETER;
+   }
+   else if((Bulb = Host_BLE_Find_Connection(ConnectionID)) == NULL)
+   {
+      Ret_Val = QAPI_BLE_GATT_ERROR_INVALID_CONNECTION_ID;
+   }
+   else if((Event = Host_BLE_New_Event(HOST_BLE_EVENT_GATT_CLIENT_E, QAPI_BLE_ET_GATT_CLIENT_EXCHANGE_MTU_RESPONSE_E, ConnectionID)) == NULL)
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INSUFFICIENT_RESOURCES;
+   }
+   else
+   {
+      Ret_Val = (int)Host_BLE_New_ID();
+
+      Event->Callback.GATT_Client                      = ClientEventCallback;
+      Event->Callback_Parameter                        = CallbackParameter;
+      Event->Data.Exchange_MTU_Response.ConnectionID   = ConnectionID;
+      Event->Data.Exchange_MTU_Response.TransactionID  = (uint32_t)Ret_Val;
+      Event->Data.Exchange_MTU_Response.ConnectionType = QAPI_BLE_GCT_LE_E;
+      Event->Data.Exchange_MTU_Response.RemoteDevice   = Bulb->BD_ADDR;
+      Event->Data.Exchange_MTU_Response.ServerMTU      = (RequestedMTU < HOST_BLE_MTU) ? RequestedMTU : HOST_BLE_MTU;
+
+      Host_BLE_Queue_Event(Event, Host_BLE_Context.Latency);
+   }
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+   return(Ret_Val);
+}
+
+int qapi_BLE_GATT_Start_Service_Discovery(uint32_t BluetoothStackID, uint32_t ConnectionID, uint32_t NumberOfUUID, qapi_BLE_GATT_UUID_t *UUIDList, qapi_BLE_GATT_Service_Discovery_Event_Callback_t ServiceDiscoveryCallback, uint32_t CallbackParameter)
+{
+   Host_BLE_Event_t                *Event;
+   Host_BLE_Event_t                *Complete;
+   Host_BLE_Discovery_Indication_t *Indication;
+   int                              Ret_Val;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   if((BluetoothStackID != HOST_BLE_STACK_ID) || (!Host_BLE_Context.Initialized))
+   {
+      Ret_Val = QAPI_BLE_GATT_ERROR_NOT_INITIALIZED;
+   }
+   else if(ServiceDiscoveryCallback == NULL)
+   {
+      Ret_Val = QAPI_BLE_GATT_ERROR_INVALID_PARAMETER;
+   }
+   else if(Host_BLE_Find_Connection(ConnectionID) == NULL)
+   {
+      Ret_Val = QAPI_BLE_GATT_ERROR_INVALID_CONNECTION_ID;
+   }
+   else if((Event = Host_BLE_New_Event(HOST_BLE_EVENT_GATT_DISCOVERY_E, QAPI_BLE_ET_GATT_SERVICE_DISCOVERY_INDICATION_E, ConnectionID)) == NULL)
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INSUFFICIENT_RESOURCES;
+   }
+   else if((Complete = Host_BLE_New_Event(HOST_BLE_EVENT_GATT_DISCOVERY_E, QAPI_BLE_ET_GATT_SERVICE_DISCOVERY_COMPLETE_E, ConnectionID)) == NULL)
+   {
+      free(Event);
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INSUFFICIENT_RESOURCES;
+   }
+   else
+   {
+      /* Each bulb has one service with the one characteristic the demo
+         writes the light value to. */
+      Indication = &(Event->Data.Discovery_Indication);
+
+      Event->Callback.GATT_Discovery                             = ServiceDiscoveryCallback;
+      Event->Callback_Parameter                                  = CallbackParameter;
+      Indication->Indication.ConnectionID                        = ConnectionID;
+      Indication->Indication.ServiceInformation.Service_Handle   = HOST_BLE_SERVICE_HANDLE;
+      Indication->Indication.ServiceInformation.End_Group_Handle = HOST_BLE_SERVICE_END_HANDLE;
+      Indication->Indication.ServiceInformation.UUID.UUID_Type   = QAPI_BLE_GU_UUID_16_E;
+      Indication->Indication.NumberOfCharacteristics             = 1;
+      Indication->Characteristic.Characteristic_UUID.UUID_Type   = QAPI_BLE_GU_UUID_16_E;
+      Indication->Characteristic.Characteristic_Handle           = HOST_BLE_CHARACTERISTIC_HANDLE;
+      Indication->Characteristic.Characteristic_Properties       = QAPI_BLE_GATT_CHARACTERISTIC_PROPERTIES_READ | QAPI_BLE_GATT_CHARACTERISTIC_PROPERTIES_WRITE_WITHOUT_RESPONSE | QAPI_BLE_GATT_CHARACTERISTIC_PROPERTIES_WRITE;
+      QAPI_BLE_ASSIGN_BLUETOOTH_UUID_16(Indication->Indication.ServiceInformation.UUID.UUID.UUID_16, 0xFF, 0xFA);
+      QAPI_BLE_ASSIGN_BLUETOOTH_UUID_16(Indication->Characteristic.Characteristic_UUID.UUID.UUID_16, 0xFF, 0xFB);
+
+      Complete->Callback.GATT_Discovery              = ServiceDiscoveryCallback;
+      Complete->Callback_Parameter                   = CallbackParameter;
+      Complete->Data.Discovery_Complete.ConnectionID = ConnectionID;
+      Complete->Data.Discovery_Complete.Status       = 0;
+
+      Host_BLE_Queue_Event(Event, Host_BLE_Context.Latency);
+      Host_BLE_Queue_Event(Complete, Host_BLE_Context.Latency);
+
+      Ret_Val = 0;
+   }
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+   return(Ret_Val);
+}
+
+int qapi_BLE_GATT_Write_Request(uint32_t BluetoothStackID, uint32_t ConnectionID, uint16_t AttributeHandle, uint16_t AttributeLength, void *AttributeValue, qapi_BLE_GATT_Client_Event_Callback_t ClientEventCallback, uint32_t CallbackParameter)
+{
+   Host_BLE_Event_t *Event;
+   Host_BLE_Bulb_t  *Bulb;
+   int               Ret_Val;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   if((BluetoothStackID != HOST_BLE_STACK_ID) || (!Host_BLE_Context.Initialized))
+   {
+      Ret_Val = QAPI_BLE_GATT_ERROR_NOT_INITIALIZED;
+   }
+   else if((AttributeLength == 0) || (AttributeValue == NULL) || (ClientEventCallback == NULL))
+   {
+      Ret_Val = QAPI_BLE_GATT_ERROR_INVALID_PARAMETER;
+   }
+   else if((Bulb = Host_BLE_Find_Connection(ConnectionID)) == NULL)
+   {
+      Ret_Val = QAPI_BLE_GATT_ERROR_INVALID_CONNECTION_ID;
+   }
+   else if((Event = Host_BLE_New_Event(HOST_BLE_EVENT_GATT_CLIENT_E, QAPI_BLE_ET_GATT_CLIENT_WRITE_RESPONSE_E, ConnectionID)) == NULL)
+   {
+      Ret_Val = QAPI_BLE_BTPS_ERROR_INSUFFICIENT_RESOURCES;
+   }
+   else
+   {
+      Ret_Val = (int)Host_BLE_New_ID();
+
+      Event->Callback.GATT_Client = ClientEventCallback;
+      Event->Callback_Parameter   = CallbackParameter;
+
+      Bulb->Writes ++;
+
+      if((AttributeHandle != HOST_BLE_CHARACTERISTIC_HANDLE) || (Host_BLE_Fails()))
+      {
+         Bulb->Failed_Writes ++;
+
+         Event->Event_Data_Type                   = QAPI_BLE_ET_GATT_CLIENT_ERROR_RESPONSE_E;
+         Event->Data.Request_Error.ConnectionID   = ConnectionID;
+         Event->Data.Request_Error.TransactionID  = (uint32_t)Ret_Val;
+         Event->Data.Request_Error.ConnectionType = QAPI_BLE_GCT_LE_E;
+         Event->Data.Request_Error.RemoteDevice   = Bulb->BD_ADDR;
+         Event->Data.Request_Error.ErrorType      = QAPI_BLE_RET_ERROR_RESPONSE_E;
+         Event->Data.Request_Error.RequestOpCode  = QAPI_BLE_ATT_PROTOCOL_CODE_WRITE_REQUEST;
+         Event->Data.Request_Error.RequestHandle  = AttributeHandle;
+         Event->Data.Request_Error.ErrorCode      = QAPI_BLE_ATT_PROTOCOL_ERROR_CODE_UNLIKELY_ERROR;
+      }
+      else
+      {
+         Bulb->Value = 0;
+         memcpy(&(Bulb->Value), AttributeValue, (AttributeLength < sizeof(Bulb->Value)) ? AttributeLength : sizeof(Bulb->Value));
+
+         Event->Data.Write_Response.ConnectionID   = ConnectionID;
+         Event->Data.Write_Response.TransactionID  = (uint32_t)Ret_Val;
+         Event->Data.Write_Response.ConnectionType = QAPI_BLE_GCT_LE_E;
+         Event->Data.Write_Response.RemoteDevice   = Bulb->BD_ADDR;
+         Event->Data.Write_Response.BytesWritten   = AttributeLength;
+      }
+
+      Host_BLE_Queue_Event(Event, Host_BLE_Context.Latency);
+   }
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+   return(Ret_Val);
+}
+
+int qapi_BLE_GATT_Write_Without_Response_Request(uint32_t BluetoothStackID, uint32_t ConnectionID, uint16_t AttributeHandle, uint16_t AttributeLength, void *AttributeValue)
+{
+   Host_BLE_Bulb_t *Bulb;
+   int              Ret_Val;
+
+   pthread_mutex_lock(&(Host_BLE_Context.Mutex));
+
+   if((BluetoothStackID != HOST_BLE_STACK_ID) || (!Host_BLE_Context.Initialized))
+   {
+      Ret_Val = QAPI_BLE_GATT_ERROR_NOT_INITIALIZED;
+   }
+   else if((AttributeLength == 0) || (AttributeValue == NULL))
+   {
+      Ret_Val = QAPI_BLE_GATT_ERROR_INVALID_PARAMETER;
+   }
+   else if((Bulb = Host_BLE_Find_Connection(ConnectionID)) == NULL)
+   {
+      Ret_Val = QAPI_BLE_GATT_ERROR_INVALID_CONNECTION_ID;
+   }
+   else
+   {
+      /* Nothing is sent back, a failed write is simply lost. */
+      Bulb->Writes ++;
+
+      if((AttributeHandle != HOST_BLE_CHARACTERISTIC_HANDLE) || (Host_BLE_Fails()))
+      {
+         Bulb->Failed_Writes ++;
+      }
+      else
+      {
+         Bulb->Value = 0;
+         memcpy(&(Bulb->Value), AttributeValue, (AttributeLength < sizeof(Bulb->Value)) ? AttributeLength : sizeof(Bulb->Value));
+      }
+
+      Ret_Val = AttributeLength;
+   }
+
+   pthread_mutex_unlock(&(Host_BLE_Context.Mutex));
+
+   return(Ret_Val);
+}
+
+/*-------------------------------------------------------------------------
+ * Services
+ *-----------------------------------------------------------------------*/
+
+int qapi_BLE_DIS_Initialize_Service(uint32_t BluetoothStackID, uint32_t *ServiceID)
+{
+   *ServiceID = 1;
+
+   return(1);
+}
+
+int qapi_BLE_DIS_Cleanup_Service(uint32_t BluetoothStackID, uint32_t InstanceID)
+{
+   return(0);
+}
+
+int qapi_BLE_GAPS_Initialize_Service(uint32_t BluetoothStackID, uint32_t *ServiceID)
+{
+   *ServiceID = 1;
+
+   return(1);
+}
+
+int qapi_BLE_GAPS_Cleanup_Service(uint32_t BluetoothStackID, uint32_t InstanceID)
+{
+   return(0);
+}
+
+int qapi_BLE_TPS_Initialize_Service(uint32_t BluetoothStackID, uint32_t *ServiceID)
+{
+   *ServiceID = 1;
+
+   return(1);
+}
+
+int qapi_BLE_TPS_Cleanup_Service(uint32_t BluetoothStackID, uint32_t InstanceID)
+{
+   return(0);
+}
+
+int qapi_BLE_SLoWP_Initialize(uint32_t BluetoothStackID)
+{
+   return(0);
+}
+
+int qapi_BLE_SLoWP_Cleanup(uint32_t BluetoothStackID)
+{
+   return(0);
+}
+
+int qapi_BLE_SLoWP_Cleanup_Node(uint32_t BluetoothStackID)
+{
+   return(0);
+}
+
+/*-------------------------------------------------------------------------
+ * Not Supported on the Host
+ *-----------------------------------------------------------------------*/
+
+/* The rest of the stack fails as if the feature was left out of it. */
+
+int qapi_BLE_AIOS_Cleanup_Service(uint32_t BluetoothStackID, uint32_t InstanceID)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_AIOS_Decode_Presentation_Format(uint32_t ValueLength, uint8_t *Value, qapi_BLE_AIOS_Presentation_Format_Data_t *PresentationFormatData)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_AIOS_Initialize_Service(uint32_t BluetoothStackID, uint32_t Service_Flags, qapi_BLE_AIOS_Initialize_Data_t *InitializeData, qapi_BLE_AIOS_Event_Callback_t EventCallback, uint32_t CallbackParameter, uint32_t *ServiceID)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_AIOS_Notify_Characteristic(uint32_t BluetoothStackID, uint32_t InstanceID, uint32_t ConnectionID, qapi_BLE_AIOS_Characteristic_Info_t *CharacteristicInfo, qapi_BLE_AIOS_Characteristic_Data_t *CharacteristicData)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_AIOS_Read_CCCD_Request_Response(uint32_t BluetoothStackID, uint32_t InstanceID, uint32_t TransactionID, uint8_t ErrorCode, qapi_BLE_AIOS_Characteristic_Info_t *CharacteristicInfo, uint16_t ClientConfiguration)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_AIOS_Read_Characteristic_Request_Response(uint32_t BluetoothStackID, uint32_t InstanceID, uint32_t ConnectionID, uint32_t TransactionID, uint8_t ErrorCode, qapi_BLE_AIOS_Characteristic_Info_t *CharacteristicInfo, qapi_BLE_AIOS_Characteristic_Data_t *CharacteristicData)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_AIOS_Read_Number_Of_Digitals_Request_Response(uint32_t BluetoothStackID, uint32_t InstanceID, uint32_t TransactionID, uint8_t ErrorCode, qapi_BLE_AIOS_Characteristic_Info_t *CharacteristicInfo, uint8_t NumberOfDigitals)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_AIOS_Read_Presentation_Format_Request_Response(uint32_t BluetoothStackID, uint32_t InstanceID, uint32_t TransactionID, uint8_t ErrorCode, qapi_BLE_AIOS_Characteristic_Info_t *CharacteristicInfo, qapi_BLE_AIOS_Presentation_Format_Data_t *PresentationFormatData)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_AIOS_Write_CCCD_Request_Response(uint32_t BluetoothStackID, uint32_t InstanceID, uint32_t TransactionID, uint8_t ErrorCode, qapi_BLE_AIOS_Characteristic_Info_t *CharacteristicInfo)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_AIOS_Write_Characteristic_Request_Response(uint32_t BluetoothStackID, uint32_t InstanceID, uint32_t TransactionID, uint8_t ErrorCode, qapi_BLE_AIOS_Characteristic_Info_t *CharacteristicInfo)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_BAS_Battery_Level_Read_Request_Response(uint32_t BluetoothStackID, uint32_t TransactionID, uint8_t BatteryLevel)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_BAS_Cleanup_Service(uint32_t BluetoothStackID, uint32_t InstanceID)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_BAS_Decode_Characteristic_Presentation_Format(uint32_t ValueLength, uint8_t *Value, qapi_BLE_BAS_Presentation_Format_Data_t *CharacteristicPresentationFormat)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_BAS_Initialize_Service(uint32_t BluetoothStackID, qapi_BLE_BAS_Event_Callback_t EventCallback, uint32_t CallbackParameter, uint32_t *ServiceID)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_BAS_Notify_Battery_Level(uint32_t BluetoothStackID, uint32_t InstanceID, uint32_t ConnectionID, uint8_t BatteryLevel)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_BAS_Query_Characteristic_Presentation_Format(uint32_t BluetoothStackID, uint32_t InstanceID, qapi_BLE_BAS_Presentation_Format_Data_t *CharacteristicPresentationFormat)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_BAS_Read_Client_Configuration_Response(uint32_t BluetoothStackID, uint32_t InstanceID, uint32_t TransactionID, uint16_t Client_Configuration)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_BAS_Set_Characteristic_Presentation_Format(uint32_t BluetoothStackID, uint32_t InstanceID, qapi_BLE_BAS_Presentation_Format_Data_t *CharacteristicPresentationFormat)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_BSC_SetTxPower(uint32_t BluetoothStackID, boolean_t Connection, int8_t TxPower)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_BSC_Set_FEM_Control_Override(uint32_t BluetoothStackID, boolean_t Enable, uint16_t FEM_Ctrl_0_1, uint16_t FEM_Ctrl_2_3)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_DIS_Set_Firmware_Revision(uint32_t BluetoothStackID, uint32_t InstanceID, char *FirmwareRevision)
+{
+   return(0);
+}
+
+int qapi_BLE_DIS_Set_Hardware_Revision(uint32_t BluetoothStackID, uint32_t InstanceID, char *Hardware_Revision)
+{
+   return(0);
+}
+
+int qapi_BLE_DIS_Set_Manufacturer_Name(uint32_t BluetoothStackID, uint32_t InstanceID, char *ManufacturerName)
+{
+   return(0);
+}
+
+int qapi_BLE_DIS_Set_Model_Number(uint32_t BluetoothStackID, uint32_t InstanceID, char *ModelNumber)
+{
+   return(0);
+}
+
+int qapi_BLE_DIS_Set_Software_Revision(uint32_t BluetoothStackID, uint32_t InstanceID, char *SoftwareRevision)
+{
+   return(0);
+}
+
+int qapi_BLE_GAPS_Query_Device_Appearance(uint32_t BluetoothStackID, uint32_t InstanceID, uint16_t *DeviceAppearance)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAPS_Query_Device_Name(uint32_t BluetoothStackID, uint32_t InstanceID, char *NameBuffer)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAPS_Set_Central_Address_Resolution(uint32_t BluetoothStackID, uint32_t InstanceID, qapi_BLE_GAP_Central_Address_Resolution_t CentralAddressResolution)
+{
+   return(0);
+}
+
+int qapi_BLE_GAPS_Set_Device_Appearance(uint32_t BluetoothStackID, uint32_t InstanceID, uint16_t DeviceAppearance)
+{
+   return(0);
+}
+
+int qapi_BLE_GAPS_Set_Device_Name(uint32_t BluetoothStackID, uint32_t InstanceID, char *DeviceName)
+{
+   return(0);
+}
+
+int qapi_BLE_GAP_LE_Add_Device_To_Resolving_List(uint32_t BluetoothStackID, uint32_t DeviceCount, qapi_BLE_GAP_LE_Resolving_List_Entry_t *ResolvingListEntries, uint32_t *AddedDeviceCount)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Advertising_Disable(uint32_t BluetoothStackID)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Advertising_Enable(uint32_t BluetoothStackID, boolean_t EnableScanResponse, qapi_BLE_GAP_LE_Advertising_Parameters_t *GAP_LE_Advertising_Parameters, qapi_BLE_GAP_LE_Connectability_Parameters_t *GAP_LE_Connectability_Parameters, qapi_BLE_GAP_LE_Event_Callback_t GAP_LE_Event_Callback, uint32_t CallbackParameter)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Authentication_Response(uint32_t BluetoothStackID, qapi_BLE_BD_ADDR_t BD_ADDR, qapi_BLE_GAP_LE_Authentication_Response_Information_t *GAP_LE_Authentication_Information)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Connection_Parameter_Update_Response(uint32_t BluetoothStackID, qapi_BLE_BD_ADDR_t BD_ADDR, boolean_t Accept, qapi_BLE_GAP_LE_Connection_Parameters_t *ConnectionParameters)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Enable_Extended_Advertising(uint32_t BluetoothStackID, boolean_t Enable, uint8_t NumberOfSets, uint8_t *AdvertisingHandleList, uint32_t *DurationList, uint8_t *MaxExtendedAdvertisingEventList, qapi_BLE_GAP_LE_Event_Callback_t GAP_LE_Event_Callback, uint32_t CallbackParameter)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Enable_Extended_Scan(uint32_t BluetoothStackID, boolean_t Enable, qapi_BLE_GAP_LE_Extended_Scan_Filter_Duplicates_Type_t FilterDuplicates, uint32_t Duration, uint32_t Period, qapi_BLE_GAP_LE_Event_Callback_t GAP_LE_Event_Callback, uint32_t CallbackParameter)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Extended_Create_Connection(uint32_t BluetoothStackID, qapi_BLE_GAP_LE_Filter_Policy_t InitatorFilterPolicy, qapi_BLE_GAP_LE_Address_Type_t RemoteAddressType, qapi_BLE_BD_ADDR_t *RemoteDevice, qapi_BLE_GAP_LE_Address_Type_t LocalAddressType, uint32_t NumberOfConnectionParameters, qapi_BLE_GAP_LE_Extended_Connection_Parameters_t *ConnectionParameterList, qapi_BLE_GAP_LE_Event_Callback_t GAP_LE_Event_Callback, uint32_t CallbackParameter)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Extended_Pair_Remote_Device(uint32_t BluetoothStackID, qapi_BLE_BD_ADDR_t BD_ADDR, qapi_BLE_GAP_LE_Extended_Pairing_Capabilities_t *Extended_Capabilities, qapi_BLE_GAP_LE_Event_Callback_t GAP_LE_Event_Callback, uint32_t CallbackParameter)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Extended_Request_Security(uint32_t BluetoothStackID, qapi_BLE_BD_ADDR_t BD_ADDR, qapi_BLE_GAP_LE_Extended_Pairing_Capabilities_t *ExtendedCapabilities, qapi_BLE_GAP_LE_Event_Callback_t GAP_LE_Event_Callback, uint32_t CallbackParameter)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Generate_Long_Term_Key(uint32_t BluetoothStackID, qapi_BLE_Encryption_Key_t *DHK, qapi_BLE_Encryption_Key_t *ER, qapi_BLE_Long_Term_Key_t *LTK_Result, uint16_t *DIV_Result, uint16_t *EDIV_Result, qapi_BLE_Random_Number_t *Rand_Result)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Query_Connection_Handle(uint32_t BluetoothStackID, qapi_BLE_BD_ADDR_t BD_ADDR, uint16_t *Connection_Handle)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Query_Connection_PHY(uint32_t BluetoothStackID, qapi_BLE_BD_ADDR_t BD_ADDR, qapi_BLE_GAP_LE_PHY_Type_t *TxPHY, qapi_BLE_GAP_LE_PHY_Type_t *RxPHY)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Query_Encryption_Mode(uint32_t BluetoothStackID, qapi_BLE_BD_ADDR_t BD_ADDR, qapi_BLE_GAP_Encryption_Mode_t *GAP_Encryption_Mode)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Query_Local_Secure_Connections_OOB_Data(uint32_t BluetoothStackID, qapi_BLE_Secure_Connections_Randomizer_t *Randomizer, qapi_BLE_Secure_Connections_Confirmation_t *Confirmation)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Reestablish_Security(uint32_t BluetoothStackID, qapi_BLE_BD_ADDR_t BD_ADDR, qapi_BLE_GAP_LE_Security_Information_t *SecurityInformation, qapi_BLE_GAP_LE_Event_Callback_t GAP_LE_Event_Callback, uint32_t CallbackParameter)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Regenerate_Long_Term_Key(uint32_t BluetoothStackID, qapi_BLE_Encryption_Key_t *DHK, qapi_BLE_Encryption_Key_t *ER, uint16_t EDIV, qapi_BLE_Random_Number_t *Rand, qapi_BLE_Long_Term_Key_t *LTK_Result)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Remove_Device_From_Resolving_List(uint32_t BluetoothStackID, uint32_t DeviceCount, qapi_BLE_GAP_LE_Resolving_List_Entry_t *ResolvingListEntries, uint32_t *RemovedDeviceCount)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+boolean_t qapi_BLE_GAP_LE_Resolve_Address(uint32_t BluetoothStackID, qapi_BLE_Encryption_Key_t *IRK, qapi_BLE_BD_ADDR_t ResolvableAddress)
+{
+   return(FALSE);
+}
+
+int qapi_BLE_GAP_LE_Set_Advertising_Data(uint32_t BluetoothStackID, uint32_t Length, qapi_BLE_Advertising_Data_t *Advertising_Data)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Set_Authenticated_Payload_Timeout(uint32_t BluetoothStackID, qapi_BLE_BD_ADDR_t BD_ADDR, uint16_t AuthenticatedPayloadTimeout)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Set_Connection_PHY(uint32_t BluetoothStackID, qapi_BLE_BD_ADDR_t BD_ADDR, uint32_t TxPHYSPreference, uint32_t RxPHYSPreference)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Set_Data_Length(uint32_t BluetoothStackID, qapi_BLE_BD_ADDR_t BD_ADDR, uint16_t SuggestedTxPacketSize, uint16_t SuggestedTxPacketTime)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Set_Extended_Advertising_Parameters(uint32_t BluetoothStackID, uint8_t AdvertisingHandle, qapi_BLE_GAP_LE_Extended_Advertising_Parameters_t *AdvertisingParameters, int8_t *SelectedTxPower)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Set_Extended_Scan_Parameters(uint32_t BluetoothStackID, qapi_BLE_GAP_LE_Address_Type_t LocalAddressType, qapi_BLE_GAP_LE_Filter_Policy_t FilterPolicy, uint32_t NumberScanningPHYs, qapi_BLE_GAP_LE_Extended_Scanning_PHY_Parameters_t *ScanningParameterList)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Set_Fixed_Passkey(uint32_t BluetoothStackID, uint32_t *Fixed_Display_Passkey)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GAP_LE_Set_Scan_Response_Data(uint32_t BluetoothStackID, uint32_t Length, qapi_BLE_Scan_Response_Data_t *Scan_Response_Data)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GATT_Change_Maximum_Supported_MTU(uint32_t BluetoothStackID, uint16_t MTU)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GATT_Error_Response(uint32_t BluetoothStackID, uint32_t TransactionID, uint16_t AttributeOffset, uint8_t ErrorCode)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GATT_Handle_Value_Confirmation(uint32_t BluetoothStackID, uint32_t ConnectionID, uint32_t TransactionID)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GATT_Handle_Value_Indication(uint32_t BluetoothStackID, uint32_t ServiceID, uint32_t ConnectionID, uint16_t AttributeOffset, uint16_t AttributeValueLength, uint8_t *AttributeValue)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GATT_Handle_Value_Notification(uint32_t BluetoothStackID, uint32_t ServiceID, uint32_t ConnectionID, uint16_t AttributeOffset, uint16_t AttributeValueLength, uint8_t *AttributeValue)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GATT_Query_Connection_MTU(uint32_t BluetoothStackID, uint32_t ConnectionID, uint16_t *MTU)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GATT_Read_Long_Value_Request(uint32_t BluetoothStackID, uint32_t ConnectionID, uint16_t AttributeHandle, uint16_t AttributeOffset, qapi_BLE_GATT_Client_Event_Callback_t ClientEventCallback, uint32_t CallbackParameter)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GATT_Read_Response(uint32_t BluetoothStackID, uint32_t TransactionID, uint32_t DataLength, uint8_t *Data)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GATT_Read_Value_Request(uint32_t BluetoothStackID, uint32_t ConnectionID, uint16_t AttributeHandle, qapi_BLE_GATT_Client_Event_Callback_t ClientEventCallback, uint32_t CallbackParameter)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GATT_Register_Connection_Events(uint32_t BluetoothStackID, qapi_BLE_GATT_Connection_Event_Callback_t ConnectionEventCallback, uint32_t CallbackParameter)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GATT_Register_Service(uint32_t BluetoothStackID, uint8_t ServiceFlags, uint32_t NumberOfServiceAttributeEntries, qapi_BLE_GATT_Service_Attribute_Entry_t *ServiceTable, qapi_BLE_GATT_Attribute_Handle_Group_t *ServiceHandleGroupResult, qapi_BLE_GATT_Server_Event_Callback_t ServerEventCallback, uint32_t CallbackParameter)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GATT_Start_Service_Discovery_Handle_Range(uint32_t BluetoothStackID, uint32_t ConnectionID, qapi_BLE_GATT_Attribute_Handle_Group_t *DiscoveryHandleRange, uint32_t NumberOfUUID, qapi_BLE_GATT_UUID_t *UUIDList, qapi_BLE_GATT_Service_Discovery_Event_Callback_t ServiceDiscoveryCallback, uint32_t CallbackParameter)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_GATT_Un_Register_Connection_Events(uint32_t BluetoothStackID, uint32_t EventCallbackID)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+void qapi_BLE_GATT_Un_Register_Service(uint32_t BluetoothStackID, uint32_t ServiceID)
+{
+}
+
+int qapi_BLE_GATT_Write_Response(uint32_t BluetoothStackID, uint32_t TransactionID)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HCI_LE_Read_Local_Resolvable_Address(uint32_t BluetoothStackID, uint8_t Peer_Identity_Address_Type, qapi_BLE_BD_ADDR_t Peer_Identity_Address, uint8_t *StatusResult, qapi_BLE_BD_ADDR_t *Local_Resolvable_AddressResult)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HCI_Read_Buffer_Size(uint32_t BluetoothStackID, uint8_t *StatusResult, uint16_t *HC_ACL_Data_Packet_Length, uint8_t *HC_SCO_Data_Packet_Length, uint16_t *HC_Total_Num_ACL_Data_Packets, uint16_t *HC_Total_Num_SCO_Data_Packets)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HCI_Read_Local_Version_Information(uint32_t BluetoothStackID, uint8_t *StatusResult, uint8_t *HCI_VersionResult, uint16_t *HCI_RevisionResult, uint8_t *LMP_VersionResult, uint16_t *Manufacturer_NameResult, uint16_t *LMP_SubversionResult)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HCI_Register_ACL_Data_Callback(uint32_t BluetoothStackID, qapi_BLE_HCI_ACL_Data_Callback_t HCI_ACLDataCallback, uint32_t CallbackParameter)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HCI_Register_Event_Callback(uint32_t BluetoothStackID, qapi_BLE_HCI_Event_Callback_t HCI_EventCallback, uint32_t CallbackParameter)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HCI_Send_ACL_Data(uint32_t BluetoothStackID, uint16_t Connection_Handle, uint16_t Flags, uint16_t ACLDataLength, uint8_t *ACLData)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HIDS_Cleanup_Service(uint32_t BluetoothStackID, uint32_t InstanceID)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HIDS_Decode_External_Report_Reference(uint32_t ValueLength, uint8_t *Value, qapi_BLE_GATT_UUID_t *ExternalReportReferenceUUID)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HIDS_Decode_HID_Information(uint32_t ValueLength, uint8_t *Value, qapi_BLE_HIDS_HID_Information_Data_t *HIDSHIDInformation)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HIDS_Decode_Report_Reference(uint32_t ValueLength, uint8_t *Value, qapi_BLE_HIDS_Report_Reference_Data_t *ReportReferenceData)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HIDS_Format_Control_Point_Command(qapi_BLE_HIDS_Control_Point_Command_t Command, uint32_t BufferLength, uint8_t *Buffer)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HIDS_Format_Protocol_Mode(qapi_BLE_HIDS_Protocol_Mode_t ProtocolMode, uint32_t BufferLength, uint8_t *Buffer)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HIDS_Get_Protocol_Mode_Response(uint32_t BluetoothStackID, uint32_t InstanceID, uint32_t TransactionID, uint8_t ErrorCode, qapi_BLE_HIDS_Protocol_Mode_t CurrentProtocolMode)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HIDS_Get_Report_Map_Response(uint32_t BluetoothStackID, uint32_t InstanceID, uint32_t TransactionID, uint8_t ErrorCode, uint32_t ReportMapLength, uint8_t *ReportMap)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HIDS_Get_Report_Response(uint32_t BluetoothStackID, uint32_t InstanceID, uint32_t TransactionID, qapi_BLE_HIDS_Report_Type_t ReportType, qapi_BLE_HIDS_Report_Reference_Data_t *ReportReferenceData, uint8_t ErrorCode, uint32_t ReportLength, uint8_t *Report)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HIDS_Initialize_Service(uint32_t BluetoothStackID, uint8_t Flags, qapi_BLE_HIDS_HID_Information_Data_t *HIDInformation, uint32_t NumIncludedServices, uint32_t *ServiceIDList, uint32_t NumExternalReportReferences, qapi_BLE_GATT_UUID_t *ReferenceUUID, uint32_t NumReports, qapi_BLE_HIDS_Report_Reference_Data_t *ReportReference, qapi_BLE_HIDS_Event_Callback_t EventCallback, uint32_t CallbackParameter, uint32_t *ServiceID)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HIDS_Notify_Input_Report(uint32_t BluetoothStackID, uint32_t InstanceID, uint32_t ConnectionID, qapi_BLE_HIDS_Report_Type_t ReportType, qapi_BLE_HIDS_Report_Reference_Data_t *ReportReferenceData, uint16_t InputReportLength, uint8_t *InputReportData)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HIDS_Read_Client_Configuration_Response(uint32_t BluetoothStackID, uint32_t InstanceID, uint32_t TransactionID, uint16_t Client_Configuration)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HIDS_Set_Report_Response(uint32_t BluetoothStackID, uint32_t InstanceID, uint32_t TransactionID, qapi_BLE_HIDS_Report_Type_t ReportType, qapi_BLE_HIDS_Report_Reference_Data_t *ReportReferenceData, uint8_t ErrorCode)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_HRS_Decode_Heart_Rate_Measurement(uint32_t ValueLength, uint8_t *Value, qapi_BLE_HRS_Heart_Rate_Measurement_Data_t *HeartRateMeasurement)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_SCPS_Cleanup_Service(uint32_t BluetoothStackID, uint32_t InstanceID)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_SCPS_Format_Scan_Interval_Window(qapi_BLE_SCPS_Scan_Interval_Window_Data_t *Scan_Interval_Window, uint32_t BufferLength, uint8_t *Buffer)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_SCPS_Initialize_Service(uint32_t BluetoothStackID, qapi_BLE_SCPS_Event_Callback_t EventCallback, uint32_t CallbackParameter, uint32_t *ServiceID)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_SCPS_Notify_Scan_Refresh(uint32_t BluetoothStackID, uint32_t InstanceID, uint32_t ConnectionID, uint8_t ScanRefreshValue)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_SCPS_Read_Client_Configuration_Response(uint32_t BluetoothStackID, uint32_t InstanceID, uint32_t TransactionID, uint16_t Client_Configuration)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_SLoWP_Close_Connection(uint32_t BluetoothStackID, qapi_BLE_BD_ADDR_t BD_ADDR)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_SLoWP_Connect_Remote_Node(uint32_t BluetoothStackID, qapi_BLE_BD_ADDR_t BD_ADDR, qapi_BLE_L2CA_LE_Channel_Parameters_t *ChannelParameters, qapi_BLE_L2CA_Queueing_Parameters_t *QueueingParameters, qapi_BLE_SLoWP_Event_Callback_t EventCallback, uint32_t CallbackParameter)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_SLoWP_Get_Node_Connection_Mode(uint32_t BluetoothStackID, qapi_BLE_IPSP_Node_Connection_Mode_t *ConnectionMode)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_SLoWP_Initialize_Node(uint32_t BluetoothStackID, qapi_BLE_L2CA_LE_Channel_Parameters_t *ChannelParameters, qapi_BLE_L2CA_Queueing_Parameters_t *QueueingParameters, qapi_BLE_SLoWP_Event_Callback_t EventCallback, uint32_t CallbackParameter, qapi_BLE_GATT_Attribute_Handle_Group_t *ServiceHandleRange)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_SLoWP_Open_Connection_Request_Response(uint32_t BluetoothStackID, qapi_BLE_BD_ADDR_t BD_ADDR, boolean_t AcceptConnection)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_SLoWP_Set_Node_Connection_Mode(uint32_t BluetoothStackID, qapi_BLE_IPSP_Node_Connection_Mode_t ConnectionMode)
+{
+   return(QAPI_BLE_BTPS_ERROR_FEATURE_NOT_AVAILABLE);
+}
+
+int qapi_BLE_TPS_Set_Tx_Power_Level(uint32_t BluetoothStackID, uint32_t InstanceID, int8_t Tx_Power_Level)
+{
+   return(0);
+}
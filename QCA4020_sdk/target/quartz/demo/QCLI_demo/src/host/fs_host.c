@@ -0,0 +1,339 @@
+/*
+* Copyright (c) 2016 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*-------------------------------------------------------------------------
+ * Include Files
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "qapi_types.h"
+#include "qapi/qapi_status.h"
+#include "qapi_fs.h"
+#include "qapi_persist.h"
+#include "qapi_otp_tlv.h"
+
+/*-------------------------------------------------------------------------
+ * Preprocessor Definitions and Constants
+ *-----------------------------------------------------------------------*/
+
+/**
+   The directory, relative to the working directory, that stands in for
+   the flash file system.  "/spinor/x.bin" is kept as
+   "host_fs/spinor/x.bin".
+*/
+#define HOST_FS_ROOT                                                    "host_fs"
+
+/**
+   The longest path on the host.
+*/
+#define HOST_FS_PATH_LENGTH                                             (256)
+
+/*-------------------------------------------------------------------------
+ * Function Declarations
+ *-----------------------------------------------------------------------*/
+
+static qbool_t Host_Fs_Path(const char *Path, char *Host_Path);
+static void Host_Fs_Make_Parents(char *Host_Path);
+static qapi_Status_t Host_Fs_Status(void);
+
+/*-------------------------------------------------------------------------
+ * Function Definitions
+ *-----------------------------------------------------------------------*/
+
+/**
+   @brief This function maps a path on the device to the host.
+
+   @param Path is the path on the device.
+   @param Host_Path is where the host path is returned, it must hold
+          HOST_FS_PATH_LENGTH characters.
+
+   @return true if the path was mapped, false if it is too long or leaves
+           the root.
+*/
+static qbool_t Host_Fs_Path(const char *Path, char *Host_Path)
+{
+   int     Length;
+   qbool_t Ret_Val;
+
+   if((Path == NULL) || (strstr(Path, "..") != NULL))
+   {
+      Ret_Val = false;
+   }
+   else
+   {
+      Length  = snprintf(Host_Path, HOST_FS_PATH_LENGTH, "%s%s%s", HOST_FS_ROOT, (Path[0] == '/') ? "" : "/", Path);
+      Ret_Val = (qbool_t)((Length > 0) && (Length < HOST_FS_PATH_LENGTH));
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function creates the directories leading to a host path.
+          Errors are left for the open of the file to report.
+
+   @param Host_Path is the host path.  It is changed while the directories
+          are created and restored afterwards.
+*/
+static void Host_Fs_Make_Parents(char *Host_Path)
+{
+   char *Separator;
+
+   for(Separator = strchr(Host_Path, '/'); Separator != NULL; Separator = strchr(Separator + 1, '/'))
+   {
+      *Separator = '\0';
+      mkdir(Host_Path, 0777);
+      *Separator = '/';
+   }
+}
+
+/**
+   @brief This function maps errno after a failed host call to a QAPI
+          status.
+
+   @return The QAPI status.
+*/
+static qapi_Status_t Host_Fs_Status(void)
+{
+   qapi_Status_t Ret_Val;
+
+   switch(errno)
+   {
+      case ENOENT:
+      case EBADF:
+      case EINVAL:
+         Ret_Val = QAPI_ERR_INVALID_PARAM;
+         break;
+
+      case ENOMEM:
+      case ENOSPC:
+         Ret_Val = QAPI_ERR_NO_MEMORY;
+         break;
+
+      case EEXIST:
+         Ret_Val = QAPI_ERR_EXISTS;
+         break;
+
+      default:
+         Ret_Val = QAPI_ERROR;
+         break;
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_Fs_Open(const char *path, int oflag, int *fd_ptr)
+{
+   char          Host_Path[HOST_FS_PATH_LENGTH];
+   int           Flags;
+   int           Fd;
+   qapi_Status_t Ret_Val;
+
+   if((fd_ptr == NULL) || (!Host_Fs_Path(path, Host_Path)))
+   {
+      Ret_Val = QAPI_ERR_INVALID_PARAM;
+   }
+   else
+   {
+      switch(oflag & QAPI_FS_O_ACCMODE)
+      {
+         case QAPI_FS_O_WRONLY:
+            Flags = O_WRONLY;
+            break;
+
+         case QAPI_FS_O_RDWR:
+            Flags = O_RDWR;
+            break;
+
+         default:
+            Flags = O_RDONLY;
+            break;
+      }
+
+      Flags |= (oflag & QAPI_FS_O_CREAT)  ? O_CREAT  : 0;
+      Flags |= (oflag & QAPI_FS_O_EXCL)   ? O_EXCL   : 0;
+      Flags |= (oflag & QAPI_FS_O_TRUNC)  ? O_TRUNC  : 0;
+      Flags |= (oflag & QAPI_FS_O_APPEND) ? O_APPEND : 0;
+
+      if(Flags & O_CREAT)
+      {
+         Host_Fs_Make_Parents(Host_Path);
+      }
+
+      if((Fd = open(Host_Path, Flags, 0666)) >= 0)
+      {
+         *fd_ptr = Fd;
+         Ret_Val = QAPI_OK;
+      }
+      else
+      {
+         Ret_Val = Host_Fs_Status();
+      }
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_Fs_Read(int fd, uint8_t *buf, uint32_t count, uint32_t *bytes_read)
+{
+   ssize_t       Length;
+   qapi_Status_t Ret_Val;
+
+   if((buf == NULL) || (bytes_read == NULL))
+   {
+      Ret_Val = QAPI_ERR_INVALID_PARAM;
+   }
+   else if((Length = read(fd, buf, count)) >= 0)
+   {
+      *bytes_read = (uint32_t)Length;
+      Ret_Val     = QAPI_OK;
+   }
+   else
+   {
+      Ret_Val = Host_Fs_Status();
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_Fs_Write(int fd, uint8_t *buf, uint32_t count, uint32_t *bytes_written)
+{
+   ssize_t       Length;
+   qapi_Status_t Ret_Val;
+
+   if((buf == NULL) || (bytes_written == NULL))
+   {
+      Ret_Val = QAPI_ERR_INVALID_PARAM;
+   }
+   else if((Length = write(fd, buf, count)) >= 0)
+   {
+      *bytes_written = (uint32_t)Length;
+      Ret_Val        = QAPI_OK;
+   }
+   else
+   {
+      Ret_Val = Host_Fs_Status();
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_Fs_Lseek(int fd, int32_t offset, int whence, int32_t *actual_offset)
+{
+   off_t         Offset;
+   qapi_Status_t Ret_Val;
+
+   if((actual_offset == NULL) || ((whence != QAPI_FS_SEEK_SET) && (whence != QAPI_FS_SEEK_CUR) && (whence != QAPI_FS_SEEK_END)))
+   {
+      Ret_Val = QAPI_ERR_INVALID_PARAM;
+   }
+   else if((Offset = lseek(fd, (off_t)offset, (whence == QAPI_FS_SEEK_SET) ? SEEK_SET : ((whence == QAPI_FS_SEEK_CUR) ? SEEK_CUR : SEEK_END))) >= 0)
+   {
+      *actual_offset = (int32_t)Offset;
+      Ret_Val        = QAPI_OK;
+   }
+   else
+   {
+      Ret_Val = Host_Fs_Status();
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_Fs_Close(int fd)
+{
+   return((close(fd) == 0) ? QAPI_OK : Host_Fs_Status());
+}
+
+qapi_Status_t qapi_Fs_Stat(const char *path, struct qapi_fs_stat_type *sbuf)
+{
+   char          Host_Path[HOST_FS_PATH_LENGTH];
+   struct stat   Host_Stat;
+   qapi_Status_t Ret_Val;
+
+   if((sbuf == NULL) || (!Host_Fs_Path(path, Host_Path)))
+   {
+      Ret_Val = QAPI_ERR_INVALID_PARAM;
+   }
+   else if(stat(Host_Path, &Host_Stat) == 0)
+   {
+      memset(sbuf, 0, sizeof(struct qapi_fs_stat_type));
+      sbuf->st_dev     = (uint32_t)Host_Stat.st_dev;
+      sbuf->st_ino     = (uint32_t)Host_Stat.st_ino;
+      sbuf->st_size    = (uint32_t)Host_Stat.st_size;
+      sbuf->st_blksize = (uint32_t)Host_Stat.st_blksize;
+      sbuf->st_blocks  = (uint32_t)Host_Stat.st_blocks;
+      Ret_Val          = QAPI_OK;
+   }
+   else
+   {
+      Ret_Val = Host_Fs_Status();
+   }
+
+   return(Ret_Val);
+}
+
+/* Nothing is kept between runs on the host, the demos go on without
+   persistent storage. */
+qapi_Status_t qapi_Persist_Initialize(qapi_Persist_Handle_t *Handle, char *Directory, char *NamePrefix, char *NameSuffix, uint8_t *Password, uint32_t PasswordSize)
+{
+   return(QAPI_ERR_NOT_SUPPORTED);
+}
+
+void qapi_Persist_Cleanup(qapi_Persist_Handle_t Handle)
+{
+}
+
+qapi_Status_t qapi_Persist_Put(qapi_Persist_Handle_t Handle, uint32_t DataLength, uint8_t *Data)
+{
+   return(QAPI_ERR_NOT_SUPPORTED);
+}
+
+qapi_Status_t qapi_Persist_Get(qapi_Persist_Handle_t Handle, uint32_t *DataLength, uint8_t **Data)
+{
+   return(QAPI_ERR_NOT_SUPPORTED);
+}
+
+void qapi_Persist_Free(qapi_Persist_Handle_t Handle, uint8_t *Data)
+{
+}
+
+void qapi_Persist_Delete(qapi_Persist_Handle_t Handle)
+{
+}
+
+/* The host has no OTP, no TLV is ever found. */
+qapi_Status_t qapi_OTP_TLV_Read(unsigned int tag, uint8_t *buffer, unsigned int max_length, unsigned int *actual_length)
+{
+   return(QAPI_ERR_NOT_SUPPORTED);
+}
+
+qapi_Status_t qapi_OTP_TLV_Write(unsigned int tag, uint8_t *buffer, unsigned int length)
+{
+   return(QAPI_ERR_NOT_SUPPORTED);
+}
@@ -0,0 +1,309 @@
+/*
+* Copyright (c) 2016 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*-------------------------------------------------------------------------
+ * Include Files
+ *-----------------------------------------------------------------------*/
+
+#include "qapi_types.h"
+
+#include "qcli.h"
+#include "qcli_api.h"
+
+#include "qurt_thread.h"
+#include "qurt_timer.h"
+
+#include "host_demo.h"
+
+/*-------------------------------------------------------------------------
+ * Function Declarations
+ *-----------------------------------------------------------------------*/
+
+static QCLI_Command_Status_t Command_I2C(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+static QCLI_Command_Status_t Command_GPIO(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+static QCLI_Command_Status_t Command_Sleep(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+
+#ifdef CONFIG_HOST_MSCD_DEMO
+static QCLI_Command_Status_t Command_Bulbs(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+#endif
+
+/*-------------------------------------------------------------------------
+ * Static & Global Variable Declarations
+ *-----------------------------------------------------------------------*/
+
+static QCLI_Group_Handle_t Host_Group;
+
+static const QCLI_Command_t Host_Command_List[] =
+{
+   /* Command_Function, Start_Thread, Command_String, Usage_String,                          Description */
+   {Command_I2C,        false,        "I2C",          "<Address> <Register> [Value [Value]...]", "Shows or sets registers of a fake I2C slave."},
+   {Command_GPIO,       false,        "GPIO",         "<Pin> [Level]",                         "Shows or drives the level of a fake GPIO pin."},
+#ifdef CONFIG_HOST_MSCD_DEMO
+   {Command_Bulbs,      false,        "Bulbs",        "[Count [Fail_Percent [Latency_ms]]]",   "Shows or sets the fake Bluetooth bulbs in range."},
+#endif
+   {Command_Sleep,      false,        "Sleep",        "<Milliseconds>",                        "Waits before the next command is read."}
+};
+
+static const QCLI_Command_Group_t Host_Command_Group = {"Host", sizeof(Host_Command_List) / sizeof(QCLI_Command_t), Host_Command_List};
+
+/*-------------------------------------------------------------------------
+ * Function Definitions
+ *-----------------------------------------------------------------------*/
+
+/**
+   @brief This function processes the "I2C" command from the CLI.
+
+   The parameters specified by this command are:
+      Parameter_List[0] is the 7-bit address of the slave.
+      Parameter_List[1] is the first register.
+      Parameter_List[2..] (optional) are the values written from the first
+                          register on.  Without values the register is
+                          shown.
+
+   @param Parameter_Count is number of elements in Parameter_List.
+   @param Parameter_List is list of parsed arguments associate with this
+          command.
+
+   @return
+    - QCLI_STATUS_SUCCESS_E if the command executed successfully.
+    - QCLI_STATUS_ERROR_E if the command encountered a general error.
+    - QCLI_STATUS_USAGE_E if the parameters passed to the command were
+      invalid.
+*/
+static QCLI_Command_Status_t Command_I2C(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+   QCLI_Command_Status_t Ret_Val;
+   uint32_t              Index;
+   uint8_t               Value;
+
+   if((Parameter_Count >= 2) && (Parameter_List[0].Integer_Is_Valid) && (Parameter_List[1].Integer_Is_Valid) &&
+      (Parameter_List[1].Integer_Value >= 0) && (Parameter_List[1].Integer_Value + Parameter_Count - 2 <= 0x100))
+   {
+      Ret_Val = QCLI_STATUS_SUCCESS_E;
+
+      for(Index = 2; (Index < Parameter_Count) && (Ret_Val == QCLI_STATUS_SUCCESS_E); Index ++)
+      {
+         if((!Parameter_List[Index].Integer_Is_Valid) || (!Host_I2C_Set_Register((uint32_t)Parameter_List[0].Integer_Value, (uint8_t)(Parameter_List[1].Integer_Value + Index - 2), (uint8_t)Parameter_List[Index].Integer_Value)))
+         {
+            Ret_Val = QCLI_STATUS_USAGE_E;
+         }
+      }
+
+      if((Ret_Val == QCLI_STATUS_SUCCESS_E) && (Parameter_Count == 2))
+      {
+         if(Host_I2C_Get_Register((uint32_t)Parameter_List[0].Integer_Value, (uint8_t)Parameter_List[1].Integer_Value, &Value))
+         {
+            QCLI_Printf(Host_Group, "Slave 0x%02X register 0x%02X: 0x%02X (%u transfers made)\n", Parameter_List[0].Integer_Value, Parameter_List[1].Integer_Value, Value, Host_I2C_Get_Transfer_Count());
+         }
+         else
+         {
+            QCLI_Printf(Host_Group, "No slave at 0x%02X.\n", Parameter_List[0].Integer_Value);
+            Ret_Val = QCLI_STATUS_ERROR_E;
+         }
+      }
+   }
+   else
+   {
+      Ret_Val = QCLI_STATUS_USAGE_E;
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function processes the "GPIO" command from the CLI.
+
+   The parameters specified by this command are:
+      Parameter_List[0] is the pin.
+      Parameter_List[1] (optional) is the level the pin is set to.  An
+                        interrupt registered on the pin is called if the
+                        change matches its trigger.
+
+   @param Parameter_Count is number of elements in Parameter_List.
+   @param Parameter_List is list of parsed arguments associate with this
+          command.
+
+   @return
+    - QCLI_STATUS_SUCCESS_E if the command executed successfully.
+    - QCLI_STATUS_ERROR_E if the command encountered a general error.
+    - QCLI_STATUS_USAGE_E if the parameters passed to the command were
+      invalid.
+*/
+static QCLI_Command_Status_t Command_GPIO(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+   QCLI_Command_Status_t Ret_Val;
+   uint32_t              Level;
+   qbool_t               Output;
+
+   if((Parameter_Count >= 1) && (Parameter_List[0].Integer_Is_Valid) && (Parameter_List[0].Integer_Value >= 0) &&
+      (Parameter_List[0].Integer_Value < HOST_GPIO_PIN_COUNT) && ((Parameter_Count == 1) || (Parameter_List[1].Integer_Is_Valid)))
+   {
+      if(Parameter_Count >= 2)
+      {
+         Host_GPIO_Set_Level((uint32_t)Parameter_List[0].Integer_Value, (uint32_t)Parameter_List[1].Integer_Value);
+      }
+
+      Host_GPIO_Get_Level((uint32_t)Parameter_List[0].Integer_Value, &Level, &Output);
+      QCLI_Printf(Host_Group, "Pin %d (%s): %s\n", Parameter_List[0].Integer_Value, Output ? "output" : "input", Level ? "high" : "low");
+
+      Ret_Val = QCLI_STATUS_SUCCESS_E;
+   }
+   else
+   {
+      Ret_Val = QCLI_STATUS_USAGE_E;
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function processes the "Sleep" command from the CLI.  It lets
+          a script wait for command workers and demo threads.
+
+   The parameters specified by this command are:
+      Parameter_List[0] is the time to wait in milliseconds.
+
+   @param Parameter_Count is number of elements in Parameter_List.
+   @param Parameter_List is list of parsed arguments associate with this
+          command.
+
+   @return
+    - QCLI_STATUS_SUCCESS_E if the command executed successfully.
+    - QCLI_STATUS_USAGE_E if the parameters passed to the command were
+      invalid.
+*/
+static QCLI_Command_Status_t Command_Sleep(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+   QCLI_Command_Status_t Ret_Val;
+
+   if((Parameter_Count >= 1) && (Parameter_List[0].Integer_Is_Valid) && (Parameter_List[0].Integer_Value >= 0))
+   {
+      qurt_thread_sleep(qurt_timer_convert_time_to_ticks((qurt_time_t)Parameter_List[0].Integer_Value, QURT_TIME_MSEC));
+
+      Ret_Val = QCLI_STATUS_SUCCESS_E;
+   }
+   else
+   {
+      Ret_Val = QCLI_STATUS_USAGE_E;
+   }
+
+   return(Ret_Val);
+}
+
+#ifdef CONFIG_HOST_MSCD_DEMO
+
+/**
+   @brief This function processes the "Bulbs" command from the CLI.  It
+          sets up the fake Bluetooth bulbs the MSCD demo connects to and
+          shows their state.
+
+   The parameters specified by this command are:
+      Parameter_List[0] (optional) is the number of bulbs in range.
+      Parameter_List[1] (optional) is the chance (0 to 100) of a connection
+                        attempt or a write failing.
+      Parameter_List[2] (optional) is the time in milliseconds the
+                        controller takes to answer.
+
+   @param Parameter_Count is number of elements in Parameter_List.
+   @param Parameter_List is list of parsed arguments associate with this
+          command.
+
+   @return
+    - QCLI_STATUS_SUCCESS_E if the command executed successfully.
+    - QCLI_STATUS_USAGE_E if the parameters passed to the command were
+      invalid.
+*/
+static QCLI_Command_Status_t Command_Bulbs(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+   QCLI_Command_Status_t Ret_Val;
+   Host_BLE_Bulb_Info_t  Info;
+   uint32_t              Count;
+   uint32_t              Fail_Percent;
+   uint32_t              Latency;
+   uint32_t              Index;
+
+   Host_BLE_Get_Bulbs(&Count, &Fail_Percent, &Latency);
+
+   Ret_Val = QCLI_STATUS_SUCCESS_E;
+   for(Index = 0; (Index < Parameter_Count) && (Index < 3) && (Ret_Val == QCLI_STATUS_SUCCESS_E); Index ++)
+   {
+      if((!Parameter_List[Index].Integer_Is_Valid) || (Parameter_List[Index].Integer_Value < 0))
+      {
+         Ret_Val = QCLI_STATUS_USAGE_E;
+      }
+   }
+
+   if(Ret_Val == QCLI_STATUS_SUCCESS_E)
+   {
+      if(Parameter_Count >= 1)
+      {
+         Count = (uint32_t)Parameter_List[0].Integer_Value;
+      }
+
+      if(Parameter_Count >= 2)
+      {
+         Fail_Percent = (uint32_t)Parameter_List[1].Integer_Value;
+      }
+
+      if(Parameter_Count >= 3)
+      {
+         Latency = (uint32_t)Parameter_List[2].Integer_Value;
+      }
+
+      if((Parameter_Count == 0) || (Host_BLE_Set_Bulbs(Count, Fail_Percent, Latency)))
+      {
+         QCLI_Printf(Host_Group, "%u bulbs, %u%% failures, %u ms latency\n", Count, Fail_Percent, Latency);
+
+         for(Index = 0; Host_BLE_Get_Bulb(Index, &Info); Index ++)
+         {
+            if(Info.Connected)
+            {
+               QCLI_Printf(Host_Group, "Bulb %u: connection %u, %u writes, %u failed, value 0x%016llX\n", Index, Info.Connection_ID, Info.Writes, Info.Failed_Writes, (unsigned long long)Info.Value);
+            }
+            else
+            {
+               QCLI_Printf(Host_Group, "Bulb %u: not connected, %u writes, %u failed, value 0x%016llX\n", Index, Info.Writes, Info.Failed_Writes, (unsigned long long)Info.Value);
+            }
+         }
+      }
+      else
+      {
+         Ret_Val = QCLI_STATUS_USAGE_E;
+      }
+   }
+
+   return(Ret_Val);
+}
+
+#endif
+
+/**
+   @brief This function registers the Host demo commands with QCLI.
+*/
+void Initialize_Host_Demo(void)
+{
+   Host_Group = QCLI_Register_Command_Group(NULL, &Host_Command_Group);
+   if(Host_Group != NULL)
+   {
+      QCLI_Printf(Host_Group, "Host Registered\n");
+   }
+}
@@ -0,0 +1,175 @@
+/*
+* Copyright (c) 2016 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef __HOST_DEMO_H__
+#define __HOST_DEMO_H__
+
+/*-------------------------------------------------------------------------
+ * Include Files
+ *-----------------------------------------------------------------------*/
+
+#include "qapi_types.h"
+
+/*-------------------------------------------------------------------------
+ * Preprocessor Definitions and Constants
+ *-----------------------------------------------------------------------*/
+
+/**
+   The number of fake GPIO pins.
+*/
+#define HOST_GPIO_PIN_COUNT                                 (64)
+
+/**
+   The number of fake Bluetooth bulbs.
+*/
+#define HOST_BLE_MAX_BULBS                                  (64)
+
+/*-------------------------------------------------------------------------
+ * Type Declarations
+ *-----------------------------------------------------------------------*/
+
+/**
+   This structure represents the state of a fake Bluetooth bulb.
+*/
+typedef struct Host_BLE_Bulb_Info_s
+{
+   qbool_t  Connected;     /**< Indicates if the bulb is connected. */
+   uint32_t Connection_ID; /**< The GATT connection ID while connected. */
+   uint32_t Writes;        /**< The write requests taken. */
+   uint32_t Failed_Writes; /**< The write requests that failed. */
+   uint64_t Value;         /**< The last value written. */
+} Host_BLE_Bulb_Info_t;
+
+/*-------------------------------------------------------------------------
+ * Function Declarations and Documentation
+ *-----------------------------------------------------------------------*/
+
+/**
+   @brief This function registers the Host demo commands with QCLI.
+*/
+void Initialize_Host_Demo(void);
+
+/**
+   @brief This function registers the Onboard group of the host build and
+          loads the sensors and thermostat values.
+*/
+void Initialize_Onboard_Host_Demo(void);
+
+/**
+   @brief This function turns the console output on or off.  Output is
+          turned off while a command is benchmarked.
+
+   @param Mute is true to turn the output off.
+*/
+void PAL_Host_Set_Mute(qbool_t Mute);
+
+/**
+   @brief This function sets the value of a register of a fake I2C slave.
+          The slave acknowledges its address from then on.
+
+   @param Address is the 7-bit address of the slave.
+   @param Register is the register to set.
+   @param Value is the value of the register.
+
+   @return true if the register was set, false if the address is invalid.
+*/
+qbool_t Host_I2C_Set_Register(uint32_t Address, uint8_t Register, uint8_t Value);
+
+/**
+   @brief This function gets the value of a register of a fake I2C slave.
+
+   @param Address is the 7-bit address of the slave.
+   @param Register is the register to get.
+   @param Value is where the value of the register is returned.
+
+   @return true if the register was read, false if the address is invalid or
+           no slave is present at the address.
+*/
+qbool_t Host_I2C_Get_Register(uint32_t Address, uint8_t Register, uint8_t *Value);
+
+/**
+   @brief This function returns the number of I2C transfers made.
+
+   @return The number of transfers.
+*/
+uint32_t Host_I2C_Get_Transfer_Count(void);
+
+/**
+   @brief This function sets the level of a fake GPIO pin, as if it was
+          driven from outside.  A registered interrupt is called if the
+          edge matches its trigger.
+
+   @param Pin is the pin to set.
+   @param Level is the new level of the pin, zero for low.
+
+   @return true if the level was set, false if the pin is invalid.
+*/
+qbool_t Host_GPIO_Set_Level(uint32_t Pin, uint32_t Level);
+
+/**
+   @brief This function gets the level of a fake GPIO pin.
+
+   @param Pin is the pin to get.
+   @param Level is where the level of the pin is returned.
+   @param Output is where it is returned if the pin is configured as an
+          output.
+
+   @return true if the level was read, false if the pin is invalid.
+*/
+qbool_t Host_GPIO_Get_Level(uint32_t Pin, uint32_t *Level, qbool_t *Output);
+
+/**
+   @brief This function sets the bulbs in range of the Bluetooth fake.
+          Bulbs taken out of range lose their connection with a
+          supervision timeout.
+
+   @param Count is the number of bulbs in range.
+   @param Fail_Percent is the chance (0 to 100) of a connection attempt or
+          a write to a bulb failing.
+   @param Latency is the time (in milliseconds) the controller takes to
+          answer a request.
+
+   @return true if the bulbs were set or false if a parameter was invalid.
+*/
+qbool_t Host_BLE_Set_Bulbs(uint32_t Count, uint32_t Fail_Percent, uint32_t Latency);
+
+/**
+   @brief This function gets the settings of the Bluetooth fake.
+
+   @param Count is where the number of bulbs in range is returned.
+   @param Fail_Percent is where the failure chance is returned.
+   @param Latency is where the controller latency is returned.
+*/
+void Host_BLE_Get_Bulbs(uint32_t *Count, uint32_t *Fail_Percent, uint32_t *Latency);
+
+/**
+   @brief This function gets the state of a fake Bluetooth bulb.
+
+   @param Index is the index of the bulb.
+   @param Info is where the state is returned.
+
+   @return true if the state was returned or false if the bulb is not in
+           range.
+*/
+qbool_t Host_BLE_Get_Bulb(uint32_t Index, Host_BLE_Bulb_Info_t *Info);
+
+#endif
@@ -0,0 +1,109 @@
+/*
+* Copyright (c) 2016 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*-------------------------------------------------------------------------
+ * Include Files
+ *-----------------------------------------------------------------------*/
+
+#include "qapi_types.h"
+
+#include "qcli.h"
+#include "qcli_api.h"
+
+#include "bench.h"
+#include "iperf.h"
+#include "net_demo.h"
+
+/*-------------------------------------------------------------------------
+ * Static & Global Variable Declarations
+ *-----------------------------------------------------------------------*/
+
+/**
+   The Net group of the host build.  It holds the benchmarking commands of
+   netcmd.c, with the same strings, which run over the socket fake of
+   socket_host.c.  The other commands of netcmd.c need the target network
+   stack.
+
+   A UDP benchtx binds its socket to the destination port to receive the
+   end mark acknowledgement, so with both ends on one host the
+   acknowledgement goes back to the transmitter itself.  The receiver still
+   reports its results, the transmitter reports the missing acknowledgement.
+*/
+QCLI_Group_Handle_t qcli_net_handle; /* Handle for Net Command Group. */
+
+static const QCLI_Command_t Net_Command_List[] =
+{
+    {bench_common_rx4,
+                true,   "benchrx",  "\n\nType \"benchrx\" to get more info on usage\n",
+                                    "\nPerform IPv4 receive (RX) benchmarking test"},
+    {bench_common_tx4,
+                true,   "benchtx",  "\n\nType \"benchtx\" to get more info on usage\n",
+                                    "\nPerform IPv4 transmit (TX) benchmarking test"},
+    {benchquit, false,  "benchquit", "\n\nbenchquit [rx|tx] <sessionid_for_tcprx>\n",
+                                    "\nTerminate some or all ongoing benchmarking tests"},
+    {bench_common_rx6,
+                true,   "benchrx6", "\n\nType \"benchrx6\" to get more info on usage\n",
+                                    "\nPerform IPv6 receive (RX) benchmarking test"},
+    {bench_common_tx6,
+                true,   "benchtx6", "\n\nType \"benchtx6\" to get more info on usage\n",
+                                    "\nPerform IPv6 transmit (TX) benchmarking test"},
+    {iperf,     true,   "iperf",    "\n\nType \"iperf\" to get more info on usage\n",
+                                        "\niperf: Perform network throughput tests"},
+	{bench_common_set_pattern,
+	            false,  "pattern",  "\n\npattern set <pattern_type> <pattern>\n"
+	                                   "Where pattern_type is:\n0: default (continuous pattern)\n"
+									   "1: static pattern, specify a byte like 0xAA for <pattern>\n"
+									   "2: ASCII characters\n",
+									   "\nConfigure the payload data pattern to be used benchmarking transmission tests"},
+    {queuecfg,
+                true,   "queuecfg", "\n\nqueuecfg [tx|rx] <size_in_bytes>\n",
+                                    "\nConfigure socket transmission or reception queue size, in bytes"},
+    {benchstats,
+                false,  "benchstats", "\n\nbenchstats [on [<interval_ms>]|off|show|csv]\n",
+                                    "\nRecord throughput per interval and packet timing histograms of benchtx/rx tests, show or export them as CSV"},
+    {benchrr,
+                true,   "benchrr",  "\n\nType \"benchrr\" to get more info on usage\n",
+                                    "\nMeasure request/response transactions per second and latency (TCP_RR, TCP_CRR, UDP_RR)"},
+    {benchmulti,
+                true,   "benchmulti", "\n\nType \"benchmulti\" to get more info on usage\n",
+                                    "\nRun parallel TX streams started together, report per-stream and aggregate throughput, fairness and CPU load"},
+};
+
+static const QCLI_Command_Group_t Net_Command_Group =
+{
+    "Net",              /* Group_String: will display cmd prompt as "Net> " */
+    sizeof(Net_Command_List)/sizeof(Net_Command_List[0]),   /* Command_Count */
+    Net_Command_List    /* Command_List */
+};
+
+/*-------------------------------------------------------------------------
+ * Function Definitions
+ *-----------------------------------------------------------------------*/
+
+void Initialize_Net_Demo(void)
+{
+    qcli_net_handle = QCLI_Register_Command_Group(NULL, &Net_Command_Group);
+    if (qcli_net_handle)
+    {
+        QCLI_Printf(qcli_net_handle, "Net Registered\n");
+    }
+}
@@ -0,0 +1,349 @@
+/*
+* Copyright (c) 2016 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*-------------------------------------------------------------------------
+ * Include Files
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "qapi_types.h"
+#include "qapi_status.h"
+
+#include "qcli.h"
+#include "qcli_api.h"
+
+#include "qurt_types.h"
+#include "aws_util.h"
+#include "util.h"
+#include "log_util.h"
+#include "led_utils.h"
+#include "onboard.h"
+#include "sensors_demo.h"
+#include "sensor_json.h"
+
+#include "host_demo.h"
+
+/*-------------------------------------------------------------------------
+ * Preprocessor Definitions and Constants
+ *-----------------------------------------------------------------------*/
+
+#define ONBOARD_HOST_DEVICE_NAME                         "QCA4020_HOST"
+#define ONBOARD_HOST_PARSE_BUFFER_SIZE                   (512)
+#define ONBOARD_HOST_LED_COUNT                           (8)
+
+/*-------------------------------------------------------------------------
+ * Static & Global Variable Declarations
+ *-----------------------------------------------------------------------*/
+
+/**
+   The Onboard group of the host build.  It holds the JSON builders and the
+   parser of sensor_json.c that the Onboard demo shares with AWS and the
+   Thread joiners.  AWS, Zigbee and Thread are not onboarded on the host, so
+   the shadow update carries the onboard sensors and the thermostat only,
+   and the LEDs are recorded instead of driven.
+*/
+QCLI_Group_Handle_t qcli_onboard;  /* Handle for Onboard Command Group. */
+
+int notify_thermo_breach;
+
+static int32_t Onboard_Host_LED_Duty[ONBOARD_HOST_LED_COUNT];
+
+static QCLI_Command_Status_t cmd_Onboard_Json(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+static QCLI_Command_Status_t cmd_Onboard_Parse(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+static QCLI_Command_Status_t cmd_Onboard_Breach(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+static QCLI_Command_Status_t cmd_Onboard_Thermostat(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+static QCLI_Command_Status_t cmd_Onboard_LED(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+
+static const QCLI_Command_t Onboard_Command_List[] =
+{
+   /* cmd_function            thread  cmd_string    usage_string                          description */
+   {cmd_Onboard_Json,         false,  "Json",       "",                                   "Build and display the shadow update of the onboard sensors."},
+   {cmd_Onboard_Parse,        false,  "Parse",      "<Json>",                             "Parse the data a coordinator sends to a Thread joiner."},
+   {cmd_Onboard_Breach,       false,  "Breach",     "<Message>",                          "Build and display a breach notification."},
+   {cmd_Onboard_Thermostat,   false,  "Thermostat", "<desired|threshold|op_mode> <Value>", "Set a thermostat value as the shadow delta does."},
+   {cmd_Onboard_LED,          false,  "LED",        "",                                   "Display the duty cycles the demo set on the LEDs."},
+};
+
+static const QCLI_Command_Group_t Onboard_Command_Group =
+{
+   "Onboard",
+   (sizeof(Onboard_Command_List) / sizeof(QCLI_Command_t)),
+   Onboard_Command_List
+};
+
+/*-------------------------------------------------------------------------
+ * Function Definitions
+ *-----------------------------------------------------------------------*/
+
+/**
+   @brief This function displays the JSON document a builder of
+          sensor_json.c produced.
+
+   @param Result is the result of the builder.
+   @param Buffer is the document the builder filled in.
+
+   @return QCLI_STATUS_SUCCESS_E if the document was built or
+           QCLI_STATUS_ERROR_E otherwise.
+*/
+static QCLI_Command_Status_t Onboard_Host_Display(int32_t Result, const char *Buffer)
+{
+   QCLI_Command_Status_t Ret_Val;
+
+   if(Result == SUCCESS)
+   {
+      QCLI_Printf(qcli_onboard, "%s\n", Buffer);
+      QCLI_Printf(qcli_onboard, "%u bytes\n", (unsigned int)strlen(Buffer));
+
+      Ret_Val = QCLI_STATUS_SUCCESS_E;
+   }
+   else
+   {
+      QCLI_Printf(qcli_onboard, "The document does not fit.\n");
+
+      Ret_Val = QCLI_STATUS_ERROR_E;
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function joins the parameters of a command back into one
+          string, since QCLI splits a JSON document at its spaces.
+
+   @param Parameter_Count is the number of parameters to join.
+   @param Parameter_List is the list of parameters to join.
+   @param Buffer is the buffer the string is written to.
+   @param Size is the size of the buffer.
+
+   @return true if all the parameters fit in the buffer.
+*/
+static qbool_t Onboard_Host_Join(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List, char *Buffer, uint32_t Size)
+{
+   qbool_t  Ret_Val;
+   uint32_t Index;
+   uint32_t Length;
+   int      Result;
+
+   Ret_Val   = true;
+   Length    = 0;
+   Buffer[0] = '\0';
+
+   for(Index = 0; (Index < Parameter_Count) && (Ret_Val); Index ++)
+   {
+      Result = snprintf(&(Buffer[Length]), Size - Length, "%s%s", (Index == 0) ? "" : " ", Parameter_List[Index].String_Value);
+      if((Result >= 0) && ((uint32_t)Result < (Size - Length)))
+      {
+         Length += (uint32_t)Result;
+      }
+      else
+      {
+         Ret_Val = false;
+      }
+   }
+
+   return(Ret_Val);
+}
+
+static QCLI_Command_Status_t cmd_Onboard_Json(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+   char Buffer[MAX_LENGTH_OF_UPDATE_JSON_BUFFER];
+
+   Buffer[0] = '\0';
+
+   return(Onboard_Host_Display(Update_json(Buffer, sizeof(Buffer)), Buffer));
+}
+
+static QCLI_Command_Status_t cmd_Onboard_Parse(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+   QCLI_Command_Status_t Ret_Val;
+   char                  Buffer[ONBOARD_HOST_PARSE_BUFFER_SIZE];
+
+   if(Parameter_Count == 0)
+   {
+      Ret_Val = QCLI_STATUS_USAGE_E;
+   }
+   else
+   {
+      if(!Onboard_Host_Join(Parameter_Count, Parameter_List, Buffer, sizeof(Buffer)))
+      {
+         QCLI_Printf(qcli_onboard, "The document is longer than %u bytes.\n", (unsigned int)(sizeof(Buffer) - 1));
+
+         Ret_Val = QCLI_STATUS_ERROR_E;
+      }
+      else
+      {
+         Ret_Val = (parse_recived_data(Buffer) == SUCCESS) ? QCLI_STATUS_SUCCESS_E : QCLI_STATUS_ERROR_E;
+      }
+   }
+
+   return(Ret_Val);
+}
+
+static QCLI_Command_Status_t cmd_Onboard_Breach(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+   QCLI_Command_Status_t Ret_Val;
+   char                  Message[ONBOARD_HOST_PARSE_BUFFER_SIZE];
+   char                  Buffer[MAX_LENGTH_OF_UPDATE_JSON_BUFFER];
+
+   if(Parameter_Count == 0)
+   {
+      Ret_Val = QCLI_STATUS_USAGE_E;
+   }
+   else
+   {
+      if(!Onboard_Host_Join(Parameter_Count, Parameter_List, Message, sizeof(Message)))
+      {
+         QCLI_Printf(qcli_onboard, "The message is longer than %u bytes.\n", (unsigned int)(sizeof(Message) - 1));
+
+         Ret_Val = QCLI_STATUS_ERROR_E;
+      }
+      else
+      {
+         /* Same prefix as notify_thermostat_breach() of aws_run.c. */
+         snprintf(Buffer, sizeof(Buffer), "{\"%s\":{", THING_NAME);
+
+         Ret_Val = Onboard_Host_Display(fill_breach_message(Buffer, Message, sizeof(Buffer)), Buffer);
+      }
+   }
+
+   return(Ret_Val);
+}
+
+static QCLI_Command_Status_t cmd_Onboard_Thermostat(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+   QCLI_Command_Status_t Ret_Val;
+
+   if((Parameter_Count != 2) || ((strcmp(Parameter_List[0].String_Value, "desired") != 0) && (strcmp(Parameter_List[0].String_Value, "threshold") != 0) && (strcmp(Parameter_List[0].String_Value, "op_mode") != 0)))
+   {
+      Ret_Val = QCLI_STATUS_USAGE_E;
+   }
+   else
+   {
+      Get_thermostat_threshhold_values(Parameter_List[0].String_Value, Parameter_List[1].String_Value);
+
+      Ret_Val = QCLI_STATUS_SUCCESS_E;
+   }
+
+   return(Ret_Val);
+}
+
+static QCLI_Command_Status_t cmd_Onboard_LED(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+   uint32_t Index;
+
+   for(Index = 0; Index < ONBOARD_HOST_LED_COUNT; Index ++)
+   {
+      QCLI_Printf(qcli_onboard, "LED %u: %d%%\n", (unsigned int)Index, (int)Onboard_Host_LED_Duty[Index]);
+   }
+
+   return(QCLI_STATUS_SUCCESS_E);
+}
+
+void Initialize_Onboard_Host_Demo(void)
+{
+   qcli_onboard = QCLI_Register_Command_Group(NULL, &Onboard_Command_Group);
+   if(qcli_onboard != NULL)
+   {
+      if(Initialize_sensors_handle() == FAILURE)
+      {
+         QCLI_Printf(qcli_onboard, "Sensors initialization failed.\n");
+      }
+
+      if(Intial_sensor_values() == FAILURE)
+      {
+         QCLI_Printf(qcli_onboard, "Thermostat values initialization failed.\n");
+      }
+   }
+}
+
+/*-------------------------------------------------------------------------
+ * Onboard demo hooks
+ *-----------------------------------------------------------------------*/
+
+boolean is_aws_running(void)
+{
+   return(false);
+}
+
+boolean is_zigbee_onboarded(void)
+{
+   return(false);
+}
+
+boolean is_thread_onboarded(void)
+{
+   return(false);
+}
+
+char zigbee_mode()
+{
+   return('\0');
+}
+
+char thread_mode()
+{
+   return('\0');
+}
+
+/* The device name has no MAC address on the host. */
+int32_t get_localdevice_name(char *buf, int32_t buf_size)
+{
+   int32_t Ret_Val;
+   int     Result;
+
+   Result = snprintf(buf + strlen(buf), buf_size, "\"%s_000000\"", ONBOARD_HOST_DEVICE_NAME);
+
+   Ret_Val = ((Result >= 0) && (Result < buf_size)) ? SUCCESS : FAILURE;
+
+   return(Ret_Val);
+}
+
+int32_t led_config(int32_t led_chan, int32_t freq_hz, int32_t duty_percent)
+{
+   int32_t Ret_Val;
+
+   if((led_chan >= 0) && (led_chan < (int32_t)ONBOARD_HOST_LED_COUNT))
+   {
+      Onboard_Host_LED_Duty[led_chan] = duty_percent;
+
+      Ret_Val = SUCCESS;
+   }
+   else
+   {
+      Ret_Val = FAILURE;
+   }
+
+   return(Ret_Val);
+}
+
+/* Only called while AWS runs, which it never does on the host. */
+int32_t Notify_breach_update_from_remote_device(char *buf)
+{
+   return(FAILURE);
+}
+
+int32_t Notify_sensors_update_from_remote_device(char *buf)
+{
+   return(FAILURE);
+}
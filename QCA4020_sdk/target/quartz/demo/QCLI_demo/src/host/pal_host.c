@@ -0,0 +1,458 @@
+/*
+* Copyright (c) 2016 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*-------------------------------------------------------------------------
+ * Include Files
+ *-----------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "qapi_types.h"
+
+#include "pal.h"
+#include "qcli.h"
+#include "qcli_api.h"
+
+#include "qurt_thread.h"
+
+#include "sensors_demo.h"
+#include "host_demo.h"
+
+#ifdef CONFIG_NET_TXRX_DEMO
+#include "net_demo.h"
+#endif
+
+#ifdef CONFIG_HOST_MSCD_DEMO
+#include "spple_demo.h"
+#endif
+
+/*-------------------------------------------------------------------------
+ * Preprocessor Definitions and Constants
+ *-----------------------------------------------------------------------*/
+
+#define PAL_RECIEVE_BUFFER_SIZE                         (128)
+
+/* The following is a simple macro to facilitate printing strings directly
+   to the console. As it uses the sizeof operator on the size of the string
+   provided, it is intended to be used with string literals and will not
+   work correctly with pointers.
+*/
+#define PAL_CONSOLE_WRITE_STRING_LITERAL(__String__)    do { PAL_Console_Write(sizeof(__String__) - 1, (__String__)); } while(0)
+
+/*-------------------------------------------------------------------------
+ * Type Declarations
+ *-----------------------------------------------------------------------*/
+
+typedef struct PAL_Context_s
+{
+   qbool_t             Initialized;
+   qbool_t             Uart_Enabled;
+   volatile qbool_t    Mute;
+   pthread_mutex_t     Console_Mutex;
+   char                Rx_Buffer[PAL_RECIEVE_BUFFER_SIZE];
+#ifdef CONFIG_HOST_MSCD_DEMO
+   PAL_Tx_Policy_t     Tx_Policy;
+   PAL_Console_Stats_t Stats;
+#endif
+} PAL_Context_t;
+
+/*-------------------------------------------------------------------------
+ * Static & global Variable Declarations
+ *-----------------------------------------------------------------------*/
+
+static PAL_Context_t PAL_Context;
+
+/* The sensors demo registers under the Peripherals group, the rest of the
+   peripherals demos need the board. */
+QCLI_Group_Handle_t qcli_peripherals_group;
+
+#if !defined(CONFIG_HOST_MSCD_DEMO) && !defined(CONFIG_HOST_ONBOARD_DEMO)
+static const QCLI_Command_Group_t Peripherals_Command_Group = {"Peripherals", 0, NULL};
+#endif
+
+/*-------------------------------------------------------------------------
+ * Function Declarations
+ *-----------------------------------------------------------------------*/
+
+static void Initialize_Samples(void);
+static void QCLI_Thread(void);
+static int Benchmark_Command(uint32_t Iterations, const char *Command);
+static qbool_t PAL_Initialize(void);
+
+/*-------------------------------------------------------------------------
+ * Function Definitions
+ *-----------------------------------------------------------------------*/
+
+/**
+   @brief This function is responsible for initializing the sample
+          applications that can run on the host.
+*/
+static void Initialize_Samples(void)
+{
+#if defined(CONFIG_HOST_MSCD_DEMO)
+   Initialize_SPPLE_Demo();
+   Initialize_Sensors_Demo();
+#elif defined(CONFIG_HOST_ONBOARD_DEMO)
+   Initialize_Onboard_Host_Demo();
+#else
+   qcli_peripherals_group = QCLI_Register_Command_Group(NULL, &Peripherals_Command_Group);
+   if(qcli_peripherals_group != NULL)
+   {
+      Initialize_Sensors_Demo();
+   }
+#endif
+
+#ifdef CONFIG_NET_TXRX_DEMO
+   Initialize_Net_Demo();
+#endif
+
+   Initialize_Host_Demo();
+}
+
+/**
+   @brief This function reads the console from the standard input until it
+          ends.  Line feeds are passed to QCLI as the end of line character
+          and carriage returns are dropped, so both Unix and DOS scripts
+          can be fed in.
+*/
+static void QCLI_Thread(void)
+{
+   ssize_t  Length;
+   ssize_t  Index;
+   uint32_t Out_Length;
+
+   /* Display the initialize command list. */
+   QCLI_Display_Command_List();
+
+   while((Length = read(STDIN_FILENO, PAL_Context.Rx_Buffer, sizeof(PAL_Context.Rx_Buffer))) > 0)
+   {
+      Out_Length = 0;
+
+      for(Index = 0; Index < Length; Index ++)
+      {
+         if(PAL_Context.Rx_Buffer[Index] == '\n')
+         {
+            PAL_Context.Rx_Buffer[Out_Length ++] = PAL_INPUT_END_OF_LINE_CHARACTER;
+         }
+         else if(PAL_Context.Rx_Buffer[Index] != '\r')
+         {
+            PAL_Context.Rx_Buffer[Out_Length ++] = PAL_Context.Rx_Buffer[Index];
+         }
+      }
+
+      QCLI_Process_Input_Data(Out_Length, PAL_Context.Rx_Buffer);
+   }
+
+   PAL_CONSOLE_WRITE_STRING_LITERAL(PAL_OUTPUT_END_OF_LINE_STRING);
+}
+
+/**
+   @brief This function runs a command line through QCLI a number of times
+          with the console muted and displays how long it took.  The line
+          is run once with output first so the result can be checked.
+
+          Commands that start a thread are timed up to the point they are
+          queued for a command worker, a worker that is still busy causes
+          the following runs to be rejected.
+
+   @param Iterations is the number of times the command is run.
+   @param Command is the command line.
+
+   @return The exit status of the application.
+*/
+static int Benchmark_Command(uint32_t Iterations, const char *Command)
+{
+   struct timespec  Start_Time;
+   struct timespec  End_Time;
+   char            *Line;
+   uint32_t         Length;
+   uint32_t         Index;
+   double           Elapsed;
+   int              Ret_Val;
+
+   Length = strlen(Command);
+
+   if((Line = (char *)malloc(Length + 1)) != NULL)
+   {
+      memcpy(Line, Command, Length);
+      Line[Length] = PAL_INPUT_END_OF_LINE_CHARACTER;
+
+      /* QCLI_Process_Input_Data() does not change the buffer, so the same
+         line is fed in each time. */
+      QCLI_Process_Input_Data(Length + 1, Line);
+
+      PAL_Host_Set_Mute(true);
+
+      clock_gettime(CLOCK_MONOTONIC, &Start_Time);
+
+      for(Index = 0; Index < Iterations; Index ++)
+      {
+         QCLI_Process_Input_Data(Length + 1, Line);
+      }
+
+      clock_gettime(CLOCK_MONOTONIC, &End_Time);
+
+      PAL_Host_Set_Mute(false);
+
+      Elapsed = (double)(End_Time.tv_sec - Start_Time.tv_sec) + ((double)(End_Time.tv_nsec - Start_Time.tv_nsec) / 1e9);
+
+      printf("\n\"%s\": %u iterations in %.3f s, %.0f iterations/s, %.0f ns per iteration\n", Command, Iterations, Elapsed,
+             (Elapsed > 0) ? ((double)Iterations / Elapsed) : 0.0, (Iterations != 0) ? ((Elapsed * 1e9) / (double)Iterations) : 0.0);
+
+      free(Line);
+
+      Ret_Val = EXIT_SUCCESS;
+   }
+   else
+   {
+      Ret_Val = EXIT_FAILURE;
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function is used to initialize the Platform, predominately
+          the console.
+
+   @return
+    - true if the platform was initialized successfully.
+    - false if initialization failed.
+*/
+static qbool_t PAL_Initialize(void)
+{
+   memset(&PAL_Context, 0, sizeof(PAL_Context));
+   pthread_mutex_init(&(PAL_Context.Console_Mutex), NULL);
+
+   return(PAL_Uart_Init());
+}
+
+/**
+   @brief Main entry point of the host application.
+
+   Usage: qcli_host [-b <Iterations> "<Command Line>"]
+
+   Without options the console is read from the standard input.  With -b
+   the command line is benchmarked instead.
+*/
+int main(int argc, char *argv[])
+{
+   int Ret_Val;
+
+   if((argc != 1) && ((argc != 4) || (strcmp(argv[1], "-b") != 0) || (atoi(argv[2]) <= 0)))
+   {
+      fprintf(stderr, "Usage: %s [-b <Iterations> \"<Command Line>\"]\n", argv[0]);
+      Ret_Val = EXIT_FAILURE;
+   }
+   else if((!PAL_Initialize()) || (!QCLI_Initialize()))
+   {
+      fprintf(stderr, "QCLI initialization failed\n");
+      Ret_Val = EXIT_FAILURE;
+   }
+   else
+   {
+      /* Initialize the samples. */
+      Initialize_Samples();
+
+      PAL_Context.Initialized = true;
+
+      if(argc == 4)
+      {
+         Ret_Val = Benchmark_Command((uint32_t)atoi(argv[2]), argv[3]);
+      }
+      else
+      {
+         QCLI_Thread();
+         Ret_Val = EXIT_SUCCESS;
+      }
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief Initialize the console used by the demo.
+
+   @return true if the console was initailized successfully or false if
+           there was an error.
+*/
+qbool_t PAL_Uart_Init(void)
+{
+   PAL_Context.Uart_Enabled = true;
+
+   return(true);
+}
+
+/**
+   @brief Turns off the console used by the demo.
+
+   @return true if the console was deinitailized successfully or false if
+           there was an error.
+*/
+qbool_t PAL_Uart_Deinit(void)
+{
+   PAL_Context.Uart_Enabled = false;
+
+   return(true);
+}
+
+/**
+   @brief This function is used to write a buffer to the console.  Carriage
+          returns are dropped so the output reads as Unix text.
+
+   @param Length is the length of the data to be written.
+   @param Buffer is a pointer to the buffer to be written to the console.
+*/
+void PAL_Console_Write(uint32_t Length, const char *Buffer)
+{
+   uint32_t Index;
+
+   if((Length != 0) && (Buffer != NULL) && (PAL_Context.Uart_Enabled) && (!PAL_Context.Mute))
+   {
+      pthread_mutex_lock(&(PAL_Context.Console_Mutex));
+
+      for(Index = 0; Index < Length; Index ++)
+      {
+         if((Buffer[Index] != '\r') && (Buffer[Index] != '\0'))
+         {
+            putchar(Buffer[Index]);
+         }
+      }
+
+      fflush(stdout);
+
+#ifdef CONFIG_HOST_MSCD_DEMO
+      PAL_Context.Stats.Bytes_Written += Length;
+      PAL_Context.Stats.Transmits ++;
+#endif
+
+      pthread_mutex_unlock(&(PAL_Context.Console_Mutex));
+   }
+}
+
+#ifdef CONFIG_HOST_MSCD_DEMO
+
+/**
+   @brief This function sets what happens to a console write that does not
+          fit in the transmit buffer.  The host writes straight to the
+          standard output so the policy is only kept.
+
+   @param Policy is the new overflow policy.
+*/
+void PAL_Console_Set_Policy(PAL_Tx_Policy_t Policy)
+{
+   PAL_Context.Tx_Policy = Policy;
+}
+
+/**
+   @brief This function returns the current overflow policy.
+*/
+PAL_Tx_Policy_t PAL_Console_Get_Policy(void)
+{
+   return(PAL_Context.Tx_Policy);
+}
+
+/**
+   @brief This function reads the console transmit counters.  Nothing is
+          ever dropped or blocked on the host.
+
+   @param Stats is where the counters are copied.
+   @param Reset clears the counters after they are read if true.
+*/
+void PAL_Console_Get_Stats(PAL_Console_Stats_t *Stats, qbool_t Reset)
+{
+   if(Stats != NULL)
+   {
+      pthread_mutex_lock(&(PAL_Context.Console_Mutex));
+
+      *Stats = PAL_Context.Stats;
+
+      if(Reset)
+      {
+         memset(&(PAL_Context.Stats), 0, sizeof(PAL_Context.Stats));
+      }
+
+      pthread_mutex_unlock(&(PAL_Context.Console_Mutex));
+   }
+}
+
+/**
+   @brief This function waits until everything written has been sent.
+*/
+void PAL_Console_Flush(void)
+{
+   fflush(stdout);
+}
+
+/**
+   @brief This function returns a microsecond count in place of the DWT
+          cycle counter the latency trace reads on the target.
+*/
+uint32_t lat_trace_cycles(void)
+{
+   struct timespec Now;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+
+   return((uint32_t)(((uint64_t)Now.tv_sec * 1000000ULL) + ((uint64_t)Now.tv_nsec / 1000ULL)));
+}
+
+#endif
+
+/**
+   @brief This function turns the console output on or off.
+
+   @param Mute is true to turn the output off.
+*/
+void PAL_Host_Set_Mute(qbool_t Mute)
+{
+   PAL_Context.Mute = Mute;
+}
+
+/**
+   @brief This function indicates to the PAL layer that the application
+          should exit.
+*/
+void PAL_Exit(void)
+{
+   PAL_CONSOLE_WRITE_STRING_LITERAL("Exiting...");
+   PAL_CONSOLE_WRITE_STRING_LITERAL(PAL_OUTPUT_END_OF_LINE_STRING);
+
+   exit(EXIT_SUCCESS);
+}
+
+/**
+   @brief This function indicates to the PAL layer that the application
+          should reset.  On the host the application exits.
+*/
+void PAL_Reset(void)
+{
+   PAL_CONSOLE_WRITE_STRING_LITERAL("Resetting...");
+   PAL_CONSOLE_WRITE_STRING_LITERAL(PAL_OUTPUT_END_OF_LINE_STRING);
+
+   exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,838 @@
+/*
+* Copyright (c) 2016 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*-------------------------------------------------------------------------
+ * Include Files
+ *-----------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "qapi_types.h"
+#include "qapi/qapi_status.h"
+#include "qapi/qapi_ver.h"
+#include "qapi/qapi_reset.h"
+#include "qapi_delay.h"
+#include "qapi_i2c_master.h"
+#include "qapi_tlmm.h"
+#include "qapi_gpioint.h"
+#include "qapi_timer.h"
+#include "stringl.h"
+#include "qurt_error.h"
+#include "qurt_thread.h"
+#include "qurt_signal.h"
+#include "qurt_timer.h"
+
+#include "host_demo.h"
+
+/*-------------------------------------------------------------------------
+ * Preprocessor Definitions and Constants
+ *-----------------------------------------------------------------------*/
+
+/**
+   The number of 7-bit I2C slave addresses.
+*/
+#define HOST_I2C_ADDRESS_COUNT                                          (128)
+
+/**
+   The number of registers of each I2C slave.
+*/
+#define HOST_I2C_REGISTER_COUNT                                         (256)
+
+/**
+   The version reported by qapi_Get_FW_Info().
+*/
+#define HOST_QAPI_VERSION                                               __QAPI_ENCODE_VERSION(QAPI_VERSION_MAJOR, QAPI_VERSION_MINOR, QAPI_VERSION_NIT)
+
+/**
+   The number of timers that can be defined with qapi_Timer_Def() at once.
+*/
+#define HOST_TIMER_COUNT                                                (32)
+
+/*-------------------------------------------------------------------------
+ * Type Declarations
+ *-----------------------------------------------------------------------*/
+
+/**
+   This structure represents a fake I2C slave.  The first byte written in
+   a transfer sets the register pointer, the following bytes are written
+   from there on and reads continue from the register pointer.
+*/
+typedef struct Host_I2C_Slave_s
+{
+   qbool_t Present;                             /**< Indicates if the slave acknowledges its address. */
+   uint8_t Register_Pointer;                    /**< The register the next access is made to. */
+   uint8_t Register[HOST_I2C_REGISTER_COUNT];   /**< The registers of the slave. */
+} Host_I2C_Slave_t;
+
+/**
+   This structure represents a fake GPIO pin.
+*/
+typedef struct Host_GPIO_Pin_s
+{
+   qbool_t                       In_Use;        /**< Indicates if an ID was given out for the pin. */
+   qapi_TLMM_Config_t            Config;        /**< The configuration of the pin. */
+   uint32_t                      Level;         /**< The level of the pin. */
+   qapi_GPIOINT_CB_t             Callback;      /**< The interrupt callback of the pin. */
+   qapi_GPIOINT_Callback_Data_t  Callback_Data; /**< The parameter of the interrupt callback. */
+   qapi_GPIOINT_Trigger_e        Trigger;       /**< The interrupt trigger of the pin. */
+} Host_GPIO_Pin_t;
+
+/**
+   This structure represents a timer defined with qapi_Timer_Def().  Each
+   qapi_Timer_Set() runs it on a new QuRT timer.  The slots are never
+   freed, so a callback that races qapi_Timer_Undef() finds an unused slot
+   rather than freed memory.
+*/
+typedef struct Host_Timer_Slot_s
+{
+   qbool_t                   In_Use;            /**< Indicates if the slot was given out. */
+   qapi_TIMER_define_attr_t  Attr;              /**< How the timer notifies its expiry. */
+   qurt_timer_t              Timer;             /**< The QuRT timer while the timer is set. */
+   qbool_t                   Timer_Valid;       /**< Indicates if Timer is valid. */
+} Host_Timer_Slot_t;
+
+/**
+   This structure contains the context information of the QAPI fakes.
+*/
+typedef struct Host_QAPI_Context_s
+{
+   pthread_mutex_t   Mutex;                              /**< Protects the fakes. */
+   Host_I2C_Slave_t  I2C_Slave[HOST_I2C_ADDRESS_COUNT];  /**< The I2C slaves. */
+   uint32_t          I2C_Transfers;                      /**< The number of I2C transfers made. */
+   Host_GPIO_Pin_t   GPIO_Pin[HOST_GPIO_PIN_COUNT];      /**< The GPIO pins. */
+   Host_Timer_Slot_t Timer[HOST_TIMER_COUNT];            /**< The timers. */
+} Host_QAPI_Context_t;
+
+static Host_QAPI_Context_t Host_QAPI_Context = {PTHREAD_MUTEX_INITIALIZER};
+
+/*-------------------------------------------------------------------------
+ * Function Declarations
+ *-----------------------------------------------------------------------*/
+
+static void Host_Timer_Callback(void *Context);
+static void Host_Timer_Release(Host_Timer_Slot_t *Slot);
+
+/*-------------------------------------------------------------------------
+ * Function Definitions
+ *-----------------------------------------------------------------------*/
+
+/**
+   @brief This function is called from the QuRT timer thread when a timer
+          set with qapi_Timer_Set() expires.  It notifies the owner the
+          way the timer was defined.
+
+   @param Context is the slot of the timer.
+*/
+static void Host_Timer_Callback(void *Context)
+{
+   Host_Timer_Slot_t        *Slot;
+   qapi_TIMER_define_attr_t  Attr;
+   qbool_t                   Notify;
+
+   Slot = (Host_Timer_Slot_t *)Context;
+
+   pthread_mutex_lock(&(Host_QAPI_Context.Mutex));
+   Notify = (qbool_t)((Slot->In_Use) && (Slot->Timer_Valid));
+   Attr   = Slot->Attr;
+   pthread_mutex_unlock(&(Host_QAPI_Context.Mutex));
+
+   if((Notify) && (Attr.sigs_func_ptr != NULL))
+   {
+      if(Attr.cb_type == QAPI_TIMER_FUNC1_CB_TYPE)
+      {
+         (*((qapi_TIMER_cb_t)Attr.sigs_func_ptr))(Attr.sigs_mask_data);
+      }
+      else if(Attr.cb_type == QAPI_TIMER_NATIVE_OS_SIGNAL_TYPE)
+      {
+         qurt_signal_set((qurt_signal_t *)Attr.sigs_func_ptr, Attr.sigs_mask_data);
+      }
+   }
+}
+
+/**
+   @brief This function deletes the QuRT timer of a slot, if it has one.
+          The QAPI mutex must be held by the caller.
+
+   @param Slot is the slot of the timer.
+*/
+static void Host_Timer_Release(Host_Timer_Slot_t *Slot)
+{
+   if(Slot->Timer_Valid)
+   {
+      qurt_timer_delete(Slot->Timer);
+      Slot->Timer_Valid = false;
+   }
+}
+
+/**
+   @brief This function sets the value of a register of a fake I2C slave.
+          The slave acknowledges its address from then on.
+
+   @param Address is the 7-bit address of the slave.
+   @param Register is the register to set.
+   @param Value is the value of the register.
+
+   @return true if the register was set, false if the address is invalid.
+*/
+qbool_t Host_I2C_Set_Register(uint32_t Address, uint8_t Register, uint8_t Value)
+{
+   qbool_t Ret_Val;
+
+   if(Address < HOST_I2C_ADDRESS_COUNT)
+   {
+      pthread_mutex_lock(&(Host_QAPI_Context.Mutex));
+
+      Host_QAPI_Context.I2C_Slave[Address].Present            = true;
+      Host_QAPI_Context.I2C_Slave[Address].Register[Register] = Value;
+
+      pthread_mutex_unlock(&(Host_QAPI_Context.Mutex));
+
+      Ret_Val = true;
+   }
+   else
+   {
+      Ret_Val = false;
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function gets the value of a register of a fake I2C slave.
+
+   @param Address is the 7-bit address of the slave.
+   @param Register is the register to get.
+   @param Value is where the value of the register is returned.
+
+   @return true if the register was read, false if the address is invalid or
+           no slave is present at the address.
+*/
+qbool_t Host_I2C_Get_Register(uint32_t Address, uint8_t Register, uint8_t *Value)
+{
+   qbool_t Ret_Val;
+
+   Ret_Val = false;
+
+   if(Address < HOST_I2C_ADDRESS_COUNT)
+   {
+      pthread_mutex_lock(&(Host_QAPI_Context.Mutex));
+
+      if(Host_QAPI_Context.I2C_Slave[Address].Present)
+      {
+         *Value  = Host_QAPI_Context.I2C_Slave[Address].Register[Register];
+         Ret_Val = true;
+      }
+
+      pthread_mutex_unlock(&(Host_QAPI_Context.Mutex));
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function returns the number of I2C transfers made.
+
+   @return The number of transfers.
+*/
+uint32_t Host_I2C_Get_Transfer_Count(void)
+{
+   return(Host_QAPI_Context.I2C_Transfers);
+}
+
+/**
+   @brief This function sets the level of a fake GPIO pin, as if it was
+          driven from outside.  A registered interrupt is called if the
+          edge matches its trigger.
+
+   @param Pin is the pin to set.
+   @param Level is the new level of the pin, zero for low.
+
+   @return true if the level was set, false if the pin is invalid.
+*/
+qbool_t Host_GPIO_Set_Level(uint32_t Pin, uint32_t Level)
+{
+   qapi_GPIOINT_CB_t             Callback;
+   qapi_GPIOINT_Callback_Data_t  Callback_Data;
+   Host_GPIO_Pin_t              *GPIO_Pin;
+   qbool_t                       Fire;
+   qbool_t                       Ret_Val;
+
+   if(Pin < HOST_GPIO_PIN_COUNT)
+   {
+      Level    = (Level != 0);
+      GPIO_Pin = &(Host_QAPI_Context.GPIO_Pin[Pin]);
+      Fire     = false;
+
+      pthread_mutex_lock(&(Host_QAPI_Context.Mutex));
+
+      if((GPIO_Pin->Callback != NULL) && (GPIO_Pin->Level != Level))
+      {
+         switch(GPIO_Pin->Trigger)
+         {
+            case QAPI_GPIOINT_TRIGGER_EDGE_RISING_E:
+            case QAPI_GPIOINT_TRIGGER_LEVEL_HIGH_E:
+               Fire = (qbool_t)(Level != 0);
+               break;
+
+            case QAPI_GPIOINT_TRIGGER_EDGE_FALLING_E:
+            case QAPI_GPIOINT_TRIGGER_LEVEL_LOW_E:
+               Fire = (qbool_t)(Level == 0);
+               break;
+
+            default:
+               Fire = true;
+               break;
+         }
+      }
+
+      GPIO_Pin->Level = Level;
+      Callback        = GPIO_Pin->Callback;
+      Callback_Data   = GPIO_Pin->Callback_Data;
+
+      pthread_mutex_unlock(&(Host_QAPI_Context.Mutex));
+
+      /* The callback is called from the thread setting the level, which
+         stands in for the interrupt context. */
+      if(Fire)
+      {
+         (*Callback)(Callback_Data);
+      }
+
+      Ret_Val = true;
+   }
+   else
+   {
+      Ret_Val = false;
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function gets the level of a fake GPIO pin.
+
+   @param Pin is the pin to get.
+   @param Level is where the level of the pin is returned.
+   @param Output is where it is returned if the pin is configured as an
+          output.
+
+   @return true if the level was read, false if the pin is invalid.
+*/
+qbool_t Host_GPIO_Get_Level(uint32_t Pin, uint32_t *Level, qbool_t *Output)
+{
+   qbool_t Ret_Val;
+
+   if(Pin < HOST_GPIO_PIN_COUNT)
+   {
+      pthread_mutex_lock(&(Host_QAPI_Context.Mutex));
+
+      *Level  = Host_QAPI_Context.GPIO_Pin[Pin].Level;
+      *Output = (qbool_t)((Host_QAPI_Context.GPIO_Pin[Pin].In_Use) && (Host_QAPI_Context.GPIO_Pin[Pin].Config.dir == QAPI_GPIO_OUTPUT_E));
+
+      pthread_mutex_unlock(&(Host_QAPI_Context.Mutex));
+
+      Ret_Val = true;
+   }
+   else
+   {
+      Ret_Val = false;
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_I2CM_Open(qapi_I2CM_Instance_t instance, void **i2c_Handle)
+{
+   qapi_Status_t Ret_Val;
+
+   if((instance >= QAPI_I2CM_INSTANCE_001_E) && (instance < QAPI_I2CM_INSTANCE_MAX_E) && (i2c_Handle != NULL))
+   {
+      /* All instances share the one bus of fake slaves. */
+      *i2c_Handle = (void *)&(Host_QAPI_Context.I2C_Slave);
+      Ret_Val     = QAPI_OK;
+   }
+   else
+   {
+      Ret_Val = QAPI_I2CM_ERR_INVALID_PARAMETER;
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_I2CM_Close(void *i2c_Handle)
+{
+   return((i2c_Handle != NULL) ? QAPI_OK : QAPI_I2CM_ERR_INVALID_PARAMETER);
+}
+
+/* The transfer completes before the function returns and the callback is
+   called from the calling thread. */
+qapi_Status_t qapi_I2CM_Transfer(void *i2c_Handle, qapi_I2CM_Config_t *config, qapi_I2CM_Descriptor_t *desc, uint16_t num_Descriptors, qapi_I2CM_Transfer_CB_t CB_Function, void *CB_Parameter)
+{
+   Host_I2C_Slave_t *Slave;
+   qapi_Status_t     Ret_Val;
+   uint32_t          Status;
+   uint32_t          Index;
+   uint32_t          Offset;
+   qbool_t           Pointer_Set;
+
+   if((i2c_Handle == NULL) || (config == NULL) || (desc == NULL) || (num_Descriptors == 0) || (config->slave_Address >= HOST_I2C_ADDRESS_COUNT))
+   {
+      Ret_Val = QAPI_I2CM_ERR_INVALID_PARAMETER;
+   }
+   else
+   {
+      Slave  = &(Host_QAPI_Context.I2C_Slave[config->slave_Address]);
+      Status = QAPI_OK;
+
+      pthread_mutex_lock(&(Host_QAPI_Context.Mutex));
+
+      Host_QAPI_Context.I2C_Transfers ++;
+
+      for(Index = 0; Index < num_Descriptors; Index ++)
+      {
+         desc[Index].transferred = 0;
+      }
+
+      if(Slave->Present)
+      {
+         for(Index = 0; Index < num_Descriptors; Index ++)
+         {
+            Pointer_Set = false;
+
+            for(Offset = 0; Offset < desc[Index].length; Offset ++)
+            {
+               if(desc[Index].flags & QAPI_I2C_FLAG_READ)
+               {
+                  desc[Index].buffer[Offset] = Slave->Register[Slave->Register_Pointer ++];
+               }
+               else if((!Pointer_Set) && (desc[Index].flags & QAPI_I2C_FLAG_START))
+               {
+                  Slave->Register_Pointer = desc[Index].buffer[Offset];
+                  Pointer_Set             = true;
+               }
+               else
+               {
+                  Slave->Register[Slave->Register_Pointer ++] = desc[Index].buffer[Offset];
+               }
+            }
+
+            desc[Index].transferred = desc[Index].length;
+         }
+      }
+      else
+      {
+         Status = QAPI_I2CM_ERR_ADDR_NACK;
+      }
+
+      pthread_mutex_unlock(&(Host_QAPI_Context.Mutex));
+
+      if(CB_Function != NULL)
+      {
+         (*CB_Function)(Status, CB_Parameter);
+      }
+
+      Ret_Val = QAPI_OK;
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_TLMM_Get_Gpio_ID(qapi_TLMM_Config_t *qapi_TLMM_Config, qapi_GPIO_ID_t *qapi_GPIO_ID)
+{
+   qapi_Status_t Ret_Val;
+
+   if((qapi_TLMM_Config == NULL) || (qapi_GPIO_ID == NULL) || (qapi_TLMM_Config->pin >= HOST_GPIO_PIN_COUNT))
+   {
+      Ret_Val = QAPI_ERR_INVALID_PARAM;
+   }
+   else
+   {
+      pthread_mutex_lock(&(Host_QAPI_Context.Mutex));
+
+      if(Host_QAPI_Context.GPIO_Pin[qapi_TLMM_Config->pin].In_Use)
+      {
+         Ret_Val = QAPI_ERR_BUSY;
+      }
+      else
+      {
+         Host_QAPI_Context.GPIO_Pin[qapi_TLMM_Config->pin].In_Use = true;
+         Host_QAPI_Context.GPIO_Pin[qapi_TLMM_Config->pin].Config = *qapi_TLMM_Config;
+
+         /* The ID is the pin number. */
+         *qapi_GPIO_ID = (qapi_GPIO_ID_t)qapi_TLMM_Config->pin;
+         Ret_Val       = QAPI_OK;
+      }
+
+      pthread_mutex_unlock(&(Host_QAPI_Context.Mutex));
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_TLMM_Release_Gpio_ID(qapi_TLMM_Config_t *qapi_TLMM_Config, qapi_GPIO_ID_t qapi_GPIO_ID)
+{
+   qapi_Status_t Ret_Val;
+
+   if((qapi_GPIO_ID < HOST_GPIO_PIN_COUNT) && (Host_QAPI_Context.GPIO_Pin[qapi_GPIO_ID].In_Use))
+   {
+      Host_QAPI_Context.GPIO_Pin[qapi_GPIO_ID].In_Use = false;
+      Ret_Val = QAPI_OK;
+   }
+   else
+   {
+      Ret_Val = QAPI_ERR_INVALID_PARAM;
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_TLMM_Config_Gpio(qapi_GPIO_ID_t qapi_GPIO_ID, qapi_TLMM_Config_t *qapi_TLMM_Config)
+{
+   qapi_Status_t Ret_Val;
+
+   if((qapi_GPIO_ID < HOST_GPIO_PIN_COUNT) && (qapi_TLMM_Config != NULL) && (Host_QAPI_Context.GPIO_Pin[qapi_GPIO_ID].In_Use))
+   {
+      pthread_mutex_lock(&(Host_QAPI_Context.Mutex));
+
+      Host_QAPI_Context.GPIO_Pin[qapi_GPIO_ID].Config = *qapi_TLMM_Config;
+
+      /* An input settles at the level of its pull. */
+      if(qapi_TLMM_Config->dir == QAPI_GPIO_INPUT_E)
+      {
+         if(qapi_TLMM_Config->pull == QAPI_GPIO_PULL_UP_E)
+         {
+            Host_QAPI_Context.GPIO_Pin[qapi_GPIO_ID].Level = 1;
+         }
+         else if(qapi_TLMM_Config->pull == QAPI_GPIO_PULL_DOWN_E)
+         {
+            Host_QAPI_Context.GPIO_Pin[qapi_GPIO_ID].Level = 0;
+         }
+      }
+
+      pthread_mutex_unlock(&(Host_QAPI_Context.Mutex));
+
+      Ret_Val = QAPI_OK;
+   }
+   else
+   {
+      Ret_Val = QAPI_ERR_INVALID_PARAM;
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_TLMM_Drive_Gpio(qapi_GPIO_ID_t qapi_GPIO_ID, uint32_t pin, qapi_GPIO_Value_t value)
+{
+   qapi_Status_t Ret_Val;
+
+   if((qapi_GPIO_ID < HOST_GPIO_PIN_COUNT) && (Host_QAPI_Context.GPIO_Pin[qapi_GPIO_ID].In_Use))
+   {
+      Host_GPIO_Set_Level(qapi_GPIO_ID, (value == QAPI_GPIO_HIGH_VALUE_E));
+      Ret_Val = QAPI_OK;
+   }
+   else
+   {
+      Ret_Val = QAPI_ERR_INVALID_PARAM;
+   }
+
+   return(Ret_Val);
+}
+
+qapi_GPIO_Value_t qapi_TLMM_Read_Gpio(qapi_GPIO_ID_t qapi_GPIO_ID, uint32_t pin)
+{
+   qapi_GPIO_Value_t Ret_Val;
+
+   Ret_Val = QAPI_GPIO_LOW_VALUE_E;
+
+   if((pin < HOST_GPIO_PIN_COUNT) && (Host_QAPI_Context.GPIO_Pin[pin].Level))
+   {
+      Ret_Val = QAPI_GPIO_HIGH_VALUE_E;
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_GPIOINT_Register_Interrupt(qapi_Instance_Handle_t *pH, uint32_t nGpio, qapi_GPIOINT_CB_t pfnCallback, qapi_GPIOINT_Callback_Data_t nData, qapi_GPIOINT_Trigger_e eTrigger, qapi_GPIOINT_Priority_e ePriority, qbool_t bNmi)
+{
+   qapi_Status_t Ret_Val;
+
+   if((pH == NULL) || (nGpio >= HOST_GPIO_PIN_COUNT) || (pfnCallback == NULL) || (eTrigger >= QAPI_GPIOINT_TRIGGER_MAX_E))
+   {
+      Ret_Val = QAPI_ERR_INVALID_PARAM;
+   }
+   else
+   {
+      pthread_mutex_lock(&(Host_QAPI_Context.Mutex));
+
+      if(Host_QAPI_Context.GPIO_Pin[nGpio].Callback != NULL)
+      {
+         Ret_Val = QAPI_ERR_BUSY;
+      }
+      else
+      {
+         Host_QAPI_Context.GPIO_Pin[nGpio].Callback      = pfnCallback;
+         Host_QAPI_Context.GPIO_Pin[nGpio].Callback_Data = nData;
+         Host_QAPI_Context.GPIO_Pin[nGpio].Trigger       = eTrigger;
+
+         *pH     = (qapi_Instance_Handle_t)&(Host_QAPI_Context.GPIO_Pin[nGpio]);
+         Ret_Val = QAPI_OK;
+      }
+
+      pthread_mutex_unlock(&(Host_QAPI_Context.Mutex));
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_GPIOINT_Deregister_Interrupt(qapi_Instance_Handle_t *pH, uint32_t nGpio)
+{
+   qapi_Status_t Ret_Val;
+
+   if((pH == NULL) || (nGpio >= HOST_GPIO_PIN_COUNT))
+   {
+      Ret_Val = QAPI_ERR_INVALID_PARAM;
+   }
+   else
+   {
+      pthread_mutex_lock(&(Host_QAPI_Context.Mutex));
+      Host_QAPI_Context.GPIO_Pin[nGpio].Callback = NULL;
+      pthread_mutex_unlock(&(Host_QAPI_Context.Mutex));
+
+      Ret_Val = QAPI_OK;
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_Get_FW_Info(qapi_FW_Info_t *info)
+{
+   qapi_Status_t Ret_Val;
+
+   if(info != NULL)
+   {
+      info->qapi_Version_Number = HOST_QAPI_VERSION;
+      info->crm_Build_Number    = 0;
+      Ret_Val                   = QAPI_OK;
+   }
+   else
+   {
+      Ret_Val = QAPI_ERR_INVALID_PARAM;
+   }
+
+   return(Ret_Val);
+}
+
+void qapi_System_Reset(void)
+{
+   exit(0);
+}
+
+qapi_Status_t qapi_Timer_Def(qapi_TIMER_handle_t *timer_handle, qapi_TIMER_define_attr_t *timer_attr)
+{
+   qapi_Status_t Ret_Val;
+   uint32_t      Index;
+
+   if((timer_handle == NULL) || (timer_attr == NULL) || (timer_attr->cb_type >= QAPI_TIMER_INVALID_NOTIFY_TYPE))
+   {
+      Ret_Val = QAPI_ERR_INVALID_PARAM;
+   }
+   else
+   {
+      Ret_Val = QAPI_ERR_NO_RESOURCE;
+
+      pthread_mutex_lock(&(Host_QAPI_Context.Mutex));
+
+      for(Index = 0; (Index < HOST_TIMER_COUNT) && (Ret_Val != QAPI_OK); Index ++)
+      {
+         if(!Host_QAPI_Context.Timer[Index].In_Use)
+         {
+            Host_QAPI_Context.Timer[Index].In_Use      = true;
+            Host_QAPI_Context.Timer[Index].Attr        = *timer_attr;
+            Host_QAPI_Context.Timer[Index].Timer_Valid = false;
+
+            *timer_handle = (qapi_TIMER_handle_t)&(Host_QAPI_Context.Timer[Index]);
+            Ret_Val       = QAPI_OK;
+         }
+      }
+
+      pthread_mutex_unlock(&(Host_QAPI_Context.Mutex));
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_Timer_Set(qapi_TIMER_handle_t timer_handle, qapi_TIMER_set_attr_t *timer_attr)
+{
+   Host_Timer_Slot_t *Slot;
+   qurt_timer_attr_t  Attr;
+   uint64_t           Duration;
+   qapi_Status_t      Ret_Val;
+
+   Slot = (Host_Timer_Slot_t *)timer_handle;
+
+   if((Slot == NULL) || (timer_attr == NULL) || (timer_attr->unit >= QAPI_TIMER_UNIT_MAX))
+   {
+      Ret_Val = QAPI_ERR_INVALID_PARAM;
+   }
+   else
+   {
+      /* One tick is a millisecond on the host. */
+      switch(timer_attr->unit)
+      {
+         case QAPI_TIMER_UNIT_USEC:
+            Duration = timer_attr->time / 1000;
+            break;
+
+         case QAPI_TIMER_UNIT_SEC:
+            Duration = timer_attr->time * 1000;
+            break;
+
+         case QAPI_TIMER_UNIT_MIN:
+            Duration = timer_attr->time * 60 * 1000;
+            break;
+
+         case QAPI_TIMER_UNIT_HOUR:
+            Duration = timer_attr->time * 60 * 60 * 1000;
+            break;
+
+         default:
+            Duration = timer_attr->time;
+            break;
+      }
+
+      if(Duration == 0)
+      {
+         Duration = 1;
+      }
+
+      qurt_timer_attr_init(&Attr);
+      qurt_timer_attr_set_duration(&Attr, (qurt_time_t)Duration);
+      qurt_timer_attr_set_callback(&Attr, Host_Timer_Callback, (void *)Slot);
+
+      if(timer_attr->reload)
+      {
+         qurt_timer_attr_set_option(&Attr, QURT_TIMER_PERIODIC | QURT_TIMER_AUTO_START);
+         qurt_timer_attr_set_reload(&Attr, (qurt_time_t)Duration);
+      }
+
+      pthread_mutex_lock(&(Host_QAPI_Context.Mutex));
+
+      if(!Slot->In_Use)
+      {
+         Ret_Val = QAPI_ERR_INVALID_PARAM;
+      }
+      else
+      {
+         /* Setting a running timer starts it again. */
+         Host_Timer_Release(Slot);
+
+         if(qurt_timer_create(&(Slot->Timer), &Attr) == QURT_EOK)
+         {
+            Slot->Timer_Valid = true;
+            Ret_Val           = QAPI_OK;
+         }
+         else
+         {
+            Ret_Val = QAPI_ERR_NO_MEMORY;
+         }
+      }
+
+      pthread_mutex_unlock(&(Host_QAPI_Context.Mutex));
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_Timer_Stop(qapi_TIMER_handle_t timer_handle)
+{
+   Host_Timer_Slot_t *Slot;
+   qapi_Status_t      Ret_Val;
+
+   Slot = (Host_Timer_Slot_t *)timer_handle;
+
+   if(Slot == NULL)
+   {
+      Ret_Val = QAPI_ERR_INVALID_PARAM;
+   }
+   else
+   {
+      pthread_mutex_lock(&(Host_QAPI_Context.Mutex));
+      Host_Timer_Release(Slot);
+      pthread_mutex_unlock(&(Host_QAPI_Context.Mutex));
+
+      Ret_Val = QAPI_OK;
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_Timer_Undef(qapi_TIMER_handle_t timer_handle)
+{
+   Host_Timer_Slot_t *Slot;
+   qapi_Status_t      Ret_Val;
+
+   Slot = (Host_Timer_Slot_t *)timer_handle;
+
+   if(Slot == NULL)
+   {
+      Ret_Val = QAPI_ERR_INVALID_PARAM;
+   }
+   else
+   {
+      pthread_mutex_lock(&(Host_QAPI_Context.Mutex));
+      Host_Timer_Release(Slot);
+      Slot->In_Use = false;
+      pthread_mutex_unlock(&(Host_QAPI_Context.Mutex));
+
+      Ret_Val = QAPI_OK;
+   }
+
+   return(Ret_Val);
+}
+
+void qapi_Task_Delay(uint32_t time_us)
+{
+   /* Rounded up to the tick so that short delays still yield. */
+   qurt_thread_sleep((qurt_time_t)((time_us + 999) / 1000));
+}
+
+size_t memscpy(void *dst, size_t dst_size, const void *src, size_t src_size)
+{
+   size_t Length;
+
+   Length = (dst_size < src_size) ? dst_size : src_size;
+   memcpy(dst, src, Length);
+
+   return(Length);
+}
+
+size_t memsmove(void *dst, size_t dst_size, const void *src, size_t src_size)
+{
+   size_t Length;
+
+   Length = (dst_size < src_size) ? dst_size : src_size;
+   memmove(dst, src, Length);
+
+   return(Length);
+}
@@ -0,0 +1,1177 @@
+/*
+* Copyright (c) 2016 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*-------------------------------------------------------------------------
+ * Include Files
+ *-----------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "qapi_types.h"
+#include "qurt_error.h"
+#include "qurt_types.h"
+#include "qurt_mutex.h"
+#include "qurt_signal.h"
+#include "qurt_pipe.h"
+#include "qurt_thread.h"
+#include "qurt_timer.h"
+
+/*-------------------------------------------------------------------------
+ * Preprocessor Definitions and Constants
+ *-----------------------------------------------------------------------*/
+
+/**
+   This definition determines the number of mutexes and the number of
+   signal objects that can exist at a time.  QuRT mutexes and signals are
+   32-bit values, so on the host they hold an index into a table instead
+   of a pointer.
+*/
+#define HOST_QURT_MAX_OBJECTS                                           (1024)
+
+/**
+   The number of QuRT ticks in a second.  The QCA402x tick is 1ms.
+*/
+#define HOST_TICKS_PER_SECOND                                           (1000)
+
+/*-------------------------------------------------------------------------
+ * Type Declarations
+ *-----------------------------------------------------------------------*/
+
+/**
+   This structure is a QuRT signal object.
+*/
+typedef struct Host_Signal_s
+{
+   pthread_mutex_t Mutex;     /**< Protects the signals. */
+   pthread_cond_t  Condition; /**< Broadcast when signals are set. */
+   uint32          Signals;   /**< The signals that are currently set. */
+} Host_Signal_t;
+
+/**
+   This structure is a QuRT pipe.
+*/
+typedef struct Host_Pipe_s
+{
+   pthread_mutex_t  Mutex;        /**< Protects the pipe. */
+   pthread_cond_t   Not_Empty;    /**< Broadcast when an element is sent. */
+   pthread_cond_t   Not_Full;     /**< Broadcast when an element is received. */
+   uint32           Element_Size; /**< The size of an element. */
+   uint32           Elements;     /**< The number of elements the pipe holds. */
+   uint32           Head;         /**< The index of the oldest element. */
+   uint32           Count;        /**< The number of elements in the pipe. */
+   uint8           *Buffer;       /**< The elements. */
+} Host_Pipe_t;
+
+/**
+   This structure is kept in a qurt_pipe_attr_t.
+*/
+typedef struct Host_Pipe_Attr_s
+{
+   uint32 Elements;
+   uint32 Element_Size;
+} Host_Pipe_Attr_t;
+
+/**
+   This structure is kept in a qurt_thread_attr_t.
+*/
+typedef struct Host_Thread_Attr_s
+{
+   uint32 Stack_Size;
+   uint16 Priority;
+} Host_Thread_Attr_t;
+
+/**
+   This structure holds the entry point of a thread until it starts.
+*/
+typedef struct Host_Thread_Start_s
+{
+   void  (*Entry_Point)(void *);
+   void   *Argument;
+} Host_Thread_Start_t;
+
+/**
+   This structure is kept in a qurt_timer_attr_t.
+*/
+typedef struct Host_Timer_Attr_s
+{
+   qurt_time_t                 Duration;
+   qurt_time_t                 Reload;
+   uint32                      Option;
+   qurt_timer_callback_func_t  Callback;
+   void                       *Callback_Context;
+   qurt_signal_t              *Signal;
+   uint32                      Signal_Mask;
+} Host_Timer_Attr_t;
+
+/**
+   This structure is a QuRT timer.  Timers that are running are kept in a
+   list sorted by expiry time, which the timer thread works through.
+*/
+typedef struct Host_Timer_s
+{
+   Host_Timer_Attr_t     Attr;    /**< The attributes of the timer. */
+   qbool_t               Running; /**< Indicates if the timer is in the running list. */
+   struct timespec       Expiry;  /**< The time the timer expires. */
+   struct Host_Timer_s  *Next;    /**< The next timer in the running list. */
+} Host_Timer_t;
+
+/**
+   This structure contains the context information of the QuRT shim.
+*/
+typedef struct Host_QuRT_Context_s
+{
+   pthread_mutex_t  Table_Mutex;                          /**< Protects the object tables. */
+   pthread_mutex_t *Mutex_Table[HOST_QURT_MAX_OBJECTS];   /**< The mutexes that have been created. */
+   Host_Signal_t   *Signal_Table[HOST_QURT_MAX_OBJECTS];  /**< The signal objects that have been created. */
+   struct timespec  Start_Time;                           /**< The time tick zero refers to. */
+
+   pthread_mutex_t  Timer_Mutex;                          /**< Protects the timers. */
+   pthread_cond_t   Timer_Condition;                      /**< Signalled when the running list changes. */
+   pthread_t        Timer_Thread;                         /**< The thread that expires timers. */
+   qbool_t          Timer_Thread_Started;                 /**< Indicates if the timer thread was started. */
+   Host_Timer_t    *Timer_List;                           /**< The running timers, soonest first. */
+} Host_QuRT_Context_t;
+
+static Host_QuRT_Context_t Host_QuRT_Context = {PTHREAD_MUTEX_INITIALIZER, {NULL}, {NULL}, {0, 0}, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER};
+
+/*-------------------------------------------------------------------------
+ * Function Declarations
+ *-----------------------------------------------------------------------*/
+
+static void Get_Deadline(qurt_time_t Timeout, struct timespec *Deadline);
+static pthread_mutex_t *Get_Mutex(qurt_mutex_t *Lock);
+static Host_Signal_t *Get_Signal(qurt_signal_t *Signal);
+static qbool_t Signals_Satisfied(uint32 Signals, uint32 Mask, uint32 Attribute);
+static void *Thread_Start(void *Parameter);
+static void Insert_Timer(Host_Timer_t *Timer, qurt_time_t Duration);
+static void Remove_Timer(Host_Timer_t *Timer);
+static void *Timer_Thread(void *Parameter);
+
+/*-------------------------------------------------------------------------
+ * Function Definitions
+ *-----------------------------------------------------------------------*/
+
+/**
+   @brief This function converts a timeout in ticks to an absolute
+          CLOCK_MONOTONIC time.
+
+   @param Timeout is the timeout in ticks.
+   @param Deadline is where the time is returned.
+*/
+static void Get_Deadline(qurt_time_t Timeout, struct timespec *Deadline)
+{
+   clock_gettime(CLOCK_MONOTONIC, Deadline);
+
+   Deadline->tv_sec  += Timeout / HOST_TICKS_PER_SECOND;
+   Deadline->tv_nsec += (long)(Timeout % HOST_TICKS_PER_SECOND) * (1000000000L / HOST_TICKS_PER_SECOND);
+
+   if(Deadline->tv_nsec >= 1000000000L)
+   {
+      Deadline->tv_sec  ++;
+      Deadline->tv_nsec -= 1000000000L;
+   }
+}
+
+/**
+   @brief This function returns the host mutex of a QuRT mutex.  A mutex
+          that was never created is created now.
+
+   @param Lock is the QuRT mutex.
+
+   @return The host mutex or NULL if there are too many mutexes.
+*/
+static pthread_mutex_t *Get_Mutex(qurt_mutex_t *Lock)
+{
+   if((*Lock == 0) || (*Lock > HOST_QURT_MAX_OBJECTS) || (Host_QuRT_Context.Mutex_Table[*Lock - 1] == NULL))
+   {
+      qurt_mutex_create(Lock);
+   }
+
+   return(((*Lock != 0) && (*Lock <= HOST_QURT_MAX_OBJECTS)) ? Host_QuRT_Context.Mutex_Table[*Lock - 1] : NULL);
+}
+
+/**
+   @brief This function returns the host object of a QuRT signal.  A
+          signal that was never created is created now.
+
+   @param Signal is the QuRT signal.
+
+   @return The host object or NULL if there are too many signals.
+*/
+static Host_Signal_t *Get_Signal(qurt_signal_t *Signal)
+{
+   if((*Signal == 0) || (*Signal > HOST_QURT_MAX_OBJECTS) || (Host_QuRT_Context.Signal_Table[*Signal - 1] == NULL))
+   {
+      qurt_signal_create(Signal);
+   }
+
+   return(((*Signal != 0) && (*Signal <= HOST_QURT_MAX_OBJECTS)) ? Host_QuRT_Context.Signal_Table[*Signal - 1] : NULL);
+}
+
+/**
+   @brief This function checks if the signals that are set satisfy a wait.
+
+   @param Signals is the signals that are set.
+   @param Mask is the signals that are waited for.
+   @param Attribute is the wait attribute.
+
+   @return true if the wait is satisfied.
+*/
+static qbool_t Signals_Satisfied(uint32 Signals, uint32 Mask, uint32 Attribute)
+{
+   qbool_t Ret_Val;
+
+   if(Attribute & QURT_SIGNAL_ATTR_WAIT_ALL)
+   {
+      Ret_Val = (qbool_t)((Signals & Mask) == Mask);
+   }
+   else
+   {
+      Ret_Val = (qbool_t)((Signals & Mask) != 0);
+   }
+
+   return(Ret_Val);
+}
+
+int qurt_mutex_create(qurt_mutex_t *lock)
+{
+   pthread_mutexattr_t  Attribute;
+   pthread_mutex_t     *Mutex;
+   uint32               Index;
+   int                  Ret_Val;
+
+   Ret_Val = QURT_EMEM;
+
+   if((Mutex = (pthread_mutex_t *)malloc(sizeof(pthread_mutex_t))) != NULL)
+   {
+      /* QuRT mutexes are recursive. */
+      pthread_mutexattr_init(&Attribute);
+      pthread_mutexattr_settype(&Attribute, PTHREAD_MUTEX_RECURSIVE);
+      pthread_mutex_init(Mutex, &Attribute);
+      pthread_mutexattr_destroy(&Attribute);
+
+      pthread_mutex_lock(&(Host_QuRT_Context.Table_Mutex));
+
+      for(Index = 0; Index < HOST_QURT_MAX_OBJECTS; Index ++)
+      {
+         if(Host_QuRT_Context.Mutex_Table[Index] == NULL)
+         {
+            Host_QuRT_Context.Mutex_Table[Index] = Mutex;
+            *lock   = Index + 1;
+            Ret_Val = QURT_EOK;
+            break;
+         }
+      }
+
+      pthread_mutex_unlock(&(Host_QuRT_Context.Table_Mutex));
+
+      if(Ret_Val != QURT_EOK)
+      {
+         pthread_mutex_destroy(Mutex);
+         free(Mutex);
+      }
+   }
+
+   return(Ret_Val);
+}
+
+void qurt_mutex_delete(qurt_mutex_t *lock)
+{
+   pthread_mutex_t *Mutex;
+
+   if((*lock != 0) && (*lock <= HOST_QURT_MAX_OBJECTS))
+   {
+      pthread_mutex_lock(&(Host_QuRT_Context.Table_Mutex));
+
+      Mutex = Host_QuRT_Context.Mutex_Table[*lock - 1];
+      Host_QuRT_Context.Mutex_Table[*lock - 1] = NULL;
+
+      pthread_mutex_unlock(&(Host_QuRT_Context.Table_Mutex));
+
+      if(Mutex != NULL)
+      {
+         pthread_mutex_destroy(Mutex);
+         free(Mutex);
+      }
+
+      *lock = 0;
+   }
+}
+
+void qurt_mutex_lock(qurt_mutex_t *lock)
+{
+   pthread_mutex_t *Mutex;
+
+   if((Mutex = Get_Mutex(lock)) != NULL)
+   {
+      pthread_mutex_lock(Mutex);
+   }
+}
+
+int qurt_mutex_lock_timed(qurt_mutex_t *lock, qurt_time_t timeout)
+{
+   pthread_mutex_t *Mutex;
+   struct timespec  Deadline;
+   int              Ret_Val;
+
+   if((Mutex = Get_Mutex(lock)) != NULL)
+   {
+      if(timeout == QURT_TIME_WAIT_FOREVER)
+      {
+         Ret_Val = pthread_mutex_lock(Mutex);
+      }
+      else if(timeout == QURT_TIME_NO_WAIT)
+      {
+         Ret_Val = pthread_mutex_trylock(Mutex);
+      }
+      else
+      {
+         /* pthread_mutex_timedlock() takes a CLOCK_REALTIME deadline. */
+         clock_gettime(CLOCK_REALTIME, &Deadline);
+         Deadline.tv_sec  += timeout / HOST_TICKS_PER_SECOND;
+         Deadline.tv_nsec += (long)(timeout % HOST_TICKS_PER_SECOND) * (1000000000L / HOST_TICKS_PER_SECOND);
+         if(Deadline.tv_nsec >= 1000000000L)
+         {
+            Deadline.tv_sec  ++;
+            Deadline.tv_nsec -= 1000000000L;
+         }
+
+         Ret_Val = pthread_mutex_timedlock(Mutex, &Deadline);
+      }
+
+      Ret_Val = (Ret_Val == 0) ? QURT_EOK : QURT_EFAILED_TIMEOUT;
+   }
+   else
+   {
+      Ret_Val = QURT_EFAILED;
+   }
+
+   return(Ret_Val);
+}
+
+void qurt_mutex_unlock(qurt_mutex_t *lock)
+{
+   pthread_mutex_t *Mutex;
+
+   if((Mutex = Get_Mutex(lock)) != NULL)
+   {
+      pthread_mutex_unlock(Mutex);
+   }
+}
+
+int qurt_mutex_try_lock(qurt_mutex_t *lock)
+{
+   return(qurt_mutex_lock_timed(lock, QURT_TIME_NO_WAIT));
+}
+
+int qurt_signal_create(qurt_signal_t *signal)
+{
+   pthread_condattr_t  Attribute;
+   Host_Signal_t      *Host_Signal;
+   uint32              Index;
+   int                 Ret_Val;
+
+   Ret_Val = QURT_EMEM;
+
+   if((Host_Signal = (Host_Signal_t *)malloc(sizeof(Host_Signal_t))) != NULL)
+   {
+      pthread_mutex_init(&(Host_Signal->Mutex), NULL);
+      pthread_condattr_init(&Attribute);
+      pthread_condattr_setclock(&Attribute, CLOCK_MONOTONIC);
+      pthread_cond_init(&(Host_Signal->Condition), &Attribute);
+      pthread_condattr_destroy(&Attribute);
+      Host_Signal->Signals = 0;
+
+      pthread_mutex_lock(&(Host_QuRT_Context.Table_Mutex));
+
+      for(Index = 0; Index < HOST_QURT_MAX_OBJECTS; Index ++)
+      {
+         if(Host_QuRT_Context.Signal_Table[Index] == NULL)
+         {
+            Host_QuRT_Context.Signal_Table[Index] = Host_Signal;
+            *signal = Index + 1;
+            Ret_Val = QURT_EOK;
+            break;
+         }
+      }
+
+      pthread_mutex_unlock(&(Host_QuRT_Context.Table_Mutex));
+
+      if(Ret_Val != QURT_EOK)
+      {
+         pthread_cond_destroy(&(Host_Signal->Condition));
+         pthread_mutex_destroy(&(Host_Signal->Mutex));
+         free(Host_Signal);
+      }
+   }
+
+   return(Ret_Val);
+}
+
+void qurt_signal_delete(qurt_signal_t *signal)
+{
+   Host_Signal_t *Host_Signal;
+
+   if((*signal != 0) && (*signal <= HOST_QURT_MAX_OBJECTS))
+   {
+      pthread_mutex_lock(&(Host_QuRT_Context.Table_Mutex));
+
+      Host_Signal = Host_QuRT_Context.Signal_Table[*signal - 1];
+      Host_QuRT_Context.Signal_Table[*signal - 1] = NULL;
+
+      pthread_mutex_unlock(&(Host_QuRT_Context.Table_Mutex));
+
+      if(Host_Signal != NULL)
+      {
+         pthread_cond_destroy(&(Host_Signal->Condition));
+         pthread_mutex_destroy(&(Host_Signal->Mutex));
+         free(Host_Signal);
+      }
+
+      *signal = 0;
+   }
+}
+
+int qurt_signal_wait_timed(qurt_signal_t *signal, uint32 mask, uint32 attribute, uint32 *curr_signals, qurt_time_t timeout)
+{
+   Host_Signal_t   *Host_Signal;
+   struct timespec  Deadline;
+   int              Ret_Val;
+
+   if((Host_Signal = Get_Signal(signal)) != NULL)
+   {
+      if((timeout != QURT_TIME_WAIT_FOREVER) && (timeout != QURT_TIME_NO_WAIT))
+      {
+         Get_Deadline(timeout, &Deadline);
+      }
+
+      Ret_Val = QURT_EOK;
+
+      pthread_mutex_lock(&(Host_Signal->Mutex));
+
+      while((Ret_Val == QURT_EOK) && (!Signals_Satisfied(Host_Signal->Signals, mask, attribute)))
+      {
+         if(timeout == QURT_TIME_WAIT_FOREVER)
+         {
+            pthread_cond_wait(&(Host_Signal->Condition), &(Host_Signal->Mutex));
+         }
+         else if((timeout == QURT_TIME_NO_WAIT) || (pthread_cond_timedwait(&(Host_Signal->Condition), &(Host_Signal->Mutex), &Deadline) == ETIMEDOUT))
+         {
+            Ret_Val = QURT_EFAILED_TIMEOUT;
+         }
+      }
+
+      if(curr_signals != NULL)
+      {
+         *curr_signals = Host_Signal->Signals & mask;
+      }
+
+      if((Ret_Val == QURT_EOK) && (attribute & QURT_SIGNAL_ATTR_CLEAR_MASK))
+      {
+         Host_Signal->Signals &= ~mask;
+      }
+
+      pthread_mutex_unlock(&(Host_Signal->Mutex));
+   }
+   else
+   {
+      Ret_Val = QURT_EFAILED;
+   }
+
+   return(Ret_Val);
+}
+
+uint32 qurt_signal_wait(qurt_signal_t *signal, uint32 mask, uint32 attribute)
+{
+   uint32 Signals;
+
+   Signals = 0;
+   qurt_signal_wait_timed(signal, mask, attribute, &Signals, QURT_TIME_WAIT_FOREVER);
+
+   return(Signals);
+}
+
+void qurt_signal_set(qurt_signal_t *signal, uint32 mask)
+{
+   Host_Signal_t *Host_Signal;
+
+   if((Host_Signal = Get_Signal(signal)) != NULL)
+   {
+      pthread_mutex_lock(&(Host_Signal->Mutex));
+      Host_Signal->Signals |= mask;
+      pthread_cond_broadcast(&(Host_Signal->Condition));
+      pthread_mutex_unlock(&(Host_Signal->Mutex));
+   }
+}
+
+void qurt_signal_clear(qurt_signal_t *signal, uint32 mask)
+{
+   Host_Signal_t *Host_Signal;
+
+   if((Host_Signal = Get_Signal(signal)) != NULL)
+   {
+      pthread_mutex_lock(&(Host_Signal->Mutex));
+      Host_Signal->Signals &= ~mask;
+      pthread_mutex_unlock(&(Host_Signal->Mutex));
+   }
+}
+
+uint32 qurt_signal_get(qurt_signal_t *signal)
+{
+   Host_Signal_t *Host_Signal;
+   uint32         Ret_Val;
+
+   Ret_Val = 0;
+
+   if((Host_Signal = Get_Signal(signal)) != NULL)
+   {
+      pthread_mutex_lock(&(Host_Signal->Mutex));
+      Ret_Val = Host_Signal->Signals;
+      pthread_mutex_unlock(&(Host_Signal->Mutex));
+   }
+
+   return(Ret_Val);
+}
+
+void qurt_pipe_attr_init(qurt_pipe_attr_t *attr)
+{
+   memset(attr, 0, sizeof(qurt_pipe_attr_t));
+}
+
+void qurt_pipe_attr_set_elements(qurt_pipe_attr_t *attr, uint32 elements)
+{
+   ((Host_Pipe_Attr_t *)attr)->Elements = elements;
+}
+
+void qurt_pipe_attr_set_element_size(qurt_pipe_attr_t *attr, uint32 element_size)
+{
+   ((Host_Pipe_Attr_t *)attr)->Element_Size = element_size;
+}
+
+int qurt_pipe_create(qurt_pipe_t *pipe, qurt_pipe_attr_t *attr)
+{
+   pthread_condattr_t  Attribute;
+   Host_Pipe_Attr_t   *Pipe_Attr;
+   Host_Pipe_t        *Host_Pipe;
+   int                 Ret_Val;
+
+   Pipe_Attr = (Host_Pipe_Attr_t *)attr;
+
+   if((Pipe_Attr->Elements == 0) || (Pipe_Attr->Element_Size == 0))
+   {
+      Ret_Val = QURT_EINVALID;
+   }
+   else if((Host_Pipe = (Host_Pipe_t *)malloc(sizeof(Host_Pipe_t) + (Pipe_Attr->Elements * Pipe_Attr->Element_Size))) == NULL)
+   {
+      Ret_Val = QURT_EMEM;
+   }
+   else
+   {
+      pthread_mutex_init(&(Host_Pipe->Mutex), NULL);
+      pthread_condattr_init(&Attribute);
+      pthread_condattr_setclock(&Attribute, CLOCK_MONOTONIC);
+      pthread_cond_init(&(Host_Pipe->Not_Empty), &Attribute);
+      pthread_cond_init(&(Host_Pipe->Not_Full), &Attribute);
+      pthread_condattr_destroy(&Attribute);
+
+      Host_Pipe->Element_Size = Pipe_Attr->Element_Size;
+      Host_Pipe->Elements     = Pipe_Attr->Elements;
+      Host_Pipe->Head         = 0;
+      Host_Pipe->Count        = 0;
+      Host_Pipe->Buffer       = (uint8 *)(Host_Pipe + 1);
+
+      *pipe   = (qurt_pipe_t)Host_Pipe;
+      Ret_Val = QURT_EOK;
+   }
+
+   return(Ret_Val);
+}
+
+void qurt_pipe_delete(qurt_pipe_t pipe)
+{
+   Host_Pipe_t *Host_Pipe;
+
+   if((Host_Pipe = (Host_Pipe_t *)pipe) != NULL)
+   {
+      pthread_cond_destroy(&(Host_Pipe->Not_Full));
+      pthread_cond_destroy(&(Host_Pipe->Not_Empty));
+      pthread_mutex_destroy(&(Host_Pipe->Mutex));
+      free(Host_Pipe);
+   }
+}
+
+int qurt_pipe_send_timed(qurt_pipe_t pipe, void *data, qurt_time_t timeout)
+{
+   Host_Pipe_t     *Host_Pipe;
+   struct timespec  Deadline;
+   uint32           Index;
+   int              Ret_Val;
+
+   Host_Pipe = (Host_Pipe_t *)pipe;
+   Ret_Val   = QURT_EOK;
+
+   if((timeout != QURT_TIME_WAIT_FOREVER) && (timeout != QURT_TIME_NO_WAIT))
+   {
+      Get_Deadline(timeout, &Deadline);
+   }
+
+   pthread_mutex_lock(&(Host_Pipe->Mutex));
+
+   while((Ret_Val == QURT_EOK) && (Host_Pipe->Count == Host_Pipe->Elements))
+   {
+      if(timeout == QURT_TIME_WAIT_FOREVER)
+      {
+         pthread_cond_wait(&(Host_Pipe->Not_Full), &(Host_Pipe->Mutex));
+      }
+      else if((timeout == QURT_TIME_NO_WAIT) || (pthread_cond_timedwait(&(Host_Pipe->Not_Full), &(Host_Pipe->Mutex), &Deadline) == ETIMEDOUT))
+      {
+         Ret_Val = QURT_EFAILED_TIMEOUT;
+      }
+   }
+
+   if(Ret_Val == QURT_EOK)
+   {
+      Index = (Host_Pipe->Head + Host_Pipe->Count) % Host_Pipe->Elements;
+      memcpy(&(Host_Pipe->Buffer[Index * Host_Pipe->Element_Size]), data, Host_Pipe->Element_Size);
+      Host_Pipe->Count ++;
+
+      pthread_cond_broadcast(&(Host_Pipe->Not_Empty));
+   }
+
+   pthread_mutex_unlock(&(Host_Pipe->Mutex));
+
+   return(Ret_Val);
+}
+
+int qurt_pipe_receive_timed(qurt_pipe_t pipe, void *data, qurt_time_t timeout)
+{
+   Host_Pipe_t     *Host_Pipe;
+   struct timespec  Deadline;
+   int              Ret_Val;
+
+   Host_Pipe = (Host_Pipe_t *)pipe;
+   Ret_Val   = QURT_EOK;
+
+   if((timeout != QURT_TIME_WAIT_FOREVER) && (timeout != QURT_TIME_NO_WAIT))
+   {
+      Get_Deadline(timeout, &Deadline);
+   }
+
+   pthread_mutex_lock(&(Host_Pipe->Mutex));
+
+   while((Ret_Val == QURT_EOK) && (Host_Pipe->Count == 0))
+   {
+      if(timeout == QURT_TIME_WAIT_FOREVER)
+      {
+         pthread_cond_wait(&(Host_Pipe->Not_Empty), &(Host_Pipe->Mutex));
+      }
+      else if((timeout == QURT_TIME_NO_WAIT) || (pthread_cond_timedwait(&(Host_Pipe->Not_Empty), &(Host_Pipe->Mutex), &Deadline) == ETIMEDOUT))
+      {
+         Ret_Val = QURT_ENOMSGS;
+      }
+   }
+
+   if(Ret_Val == QURT_EOK)
+   {
+      memcpy(data, &(Host_Pipe->Buffer[Host_Pipe->Head * Host_Pipe->Element_Size]), Host_Pipe->Element_Size);
+      Host_Pipe->Head = (Host_Pipe->Head + 1) % Host_Pipe->Elements;
+      Host_Pipe->Count --;
+
+      pthread_cond_broadcast(&(Host_Pipe->Not_Full));
+   }
+
+   pthread_mutex_unlock(&(Host_Pipe->Mutex));
+
+   return(Ret_Val);
+}
+
+void qurt_pipe_send(qurt_pipe_t pipe, void *data)
+{
+   qurt_pipe_send_timed(pipe, data, QURT_TIME_WAIT_FOREVER);
+}
+
+void qurt_pipe_receive(qurt_pipe_t pipe, void *data)
+{
+   qurt_pipe_receive_timed(pipe, data, QURT_TIME_WAIT_FOREVER);
+}
+
+int qurt_pipe_try_send(qurt_pipe_t pipe, void *data)
+{
+   return(qurt_pipe_send_timed(pipe, data, QURT_TIME_NO_WAIT));
+}
+
+int qurt_pipe_try_receive(qurt_pipe_t pipe, void *data)
+{
+   return(qurt_pipe_receive_timed(pipe, data, QURT_TIME_NO_WAIT));
+}
+
+int qurt_pipe_flush(qurt_pipe_t pipe)
+{
+   Host_Pipe_t *Host_Pipe;
+
+   Host_Pipe = (Host_Pipe_t *)pipe;
+
+   pthread_mutex_lock(&(Host_Pipe->Mutex));
+   Host_Pipe->Count = 0;
+   pthread_cond_broadcast(&(Host_Pipe->Not_Full));
+   pthread_mutex_unlock(&(Host_Pipe->Mutex));
+
+   return(QURT_EOK);
+}
+
+void qurt_thread_attr_init(qurt_thread_attr_t *attr)
+{
+   memset(attr, 0, sizeof(qurt_thread_attr_t));
+   ((Host_Thread_Attr_t *)attr)->Priority = QURT_THREAD_ATTR_PRIORITY_DEFAULT;
+}
+
+void qurt_thread_attr_set_name(qurt_thread_attr_t *attr, const char *name)
+{
+}
+
+void qurt_thread_attr_set_priority(qurt_thread_attr_t *attr, uint16 priority)
+{
+   ((Host_Thread_Attr_t *)attr)->Priority = priority;
+}
+
+void qurt_thread_attr_set_stack_size(qurt_thread_attr_t *attr, uint32 stack_size)
+{
+   ((Host_Thread_Attr_t *)attr)->Stack_Size = stack_size;
+}
+
+/**
+   @brief This function is the host thread of a QuRT thread.
+
+   @param Parameter is the Host_Thread_Start_t of the thread.
+
+   @return NULL.
+*/
+static void *Thread_Start(void *Parameter)
+{
+   Host_Thread_Start_t Start;
+
+   Start = *((Host_Thread_Start_t *)Parameter);
+   free(Parameter);
+
+   (*(Start.Entry_Point))(Start.Argument);
+
+   return(NULL);
+}
+
+/* Priorities are not applied to the host threads, the host scheduler
+   decides which runs.  The stack size is not applied either, host stacks
+   are much larger than the QuRT ones. */
+int qurt_thread_create(qurt_thread_t *thread_id, qurt_thread_attr_t *attr, void (*entrypoint)(void *), void *arg)
+{
+   Host_Thread_Start_t *Start;
+   pthread_attr_t       Attribute;
+   pthread_t            Thread;
+   int                  Ret_Val;
+
+   if((Start = (Host_Thread_Start_t *)malloc(sizeof(Host_Thread_Start_t))) != NULL)
+   {
+      Start->Entry_Point = entrypoint;
+      Start->Argument    = arg;
+
+      pthread_attr_init(&Attribute);
+      pthread_attr_setdetachstate(&Attribute, PTHREAD_CREATE_DETACHED);
+
+      if(pthread_create(&Thread, &Attribute, Thread_Start, Start) == 0)
+      {
+         if(thread_id != NULL)
+         {
+            *thread_id = (qurt_thread_t)Thread;
+         }
+
+         Ret_Val = QURT_EOK;
+      }
+      else
+      {
+         free(Start);
+         Ret_Val = QURT_EFAILED;
+      }
+
+      pthread_attr_destroy(&Attribute);
+   }
+   else
+   {
+      Ret_Val = QURT_EMEM;
+   }
+
+   return(Ret_Val);
+}
+
+void qurt_thread_stop(void)
+{
+   pthread_exit(NULL);
+}
+
+void qurt_thread_yield(void)
+{
+   sched_yield();
+}
+
+qurt_thread_t qurt_thread_get_id(void)
+{
+   return((qurt_thread_t)pthread_self());
+}
+
+int qurt_thread_get_priority(qurt_thread_t thread_id)
+{
+   return(QURT_THREAD_ATTR_PRIORITY_DEFAULT);
+}
+
+int qurt_thread_set_priority(qurt_thread_t thread_id, uint16 newprio)
+{
+   return(QURT_EOK);
+}
+
+void qurt_thread_sleep(qurt_time_t duration)
+{
+   struct timespec Duration;
+
+   Duration.tv_sec  = duration / HOST_TICKS_PER_SECOND;
+   Duration.tv_nsec = (long)(duration % HOST_TICKS_PER_SECOND) * (1000000000L / HOST_TICKS_PER_SECOND);
+
+   while(nanosleep(&Duration, &Duration) != 0)
+   {
+   }
+}
+
+qurt_time_t qurt_timer_get_ticks(void)
+{
+   struct timespec Now;
+   struct timespec Start;
+
+   clock_gettime(CLOCK_MONOTONIC, &Now);
+
+   pthread_mutex_lock(&(Host_QuRT_Context.Table_Mutex));
+
+   /* Tick zero is the first time the ticks are read. */
+   if((Host_QuRT_Context.Start_Time.tv_sec == 0) && (Host_QuRT_Context.Start_Time.tv_nsec == 0))
+   {
+      Host_QuRT_Context.Start_Time = Now;
+   }
+
+   Start = Host_QuRT_Context.Start_Time;
+
+   pthread_mutex_unlock(&(Host_QuRT_Context.Table_Mutex));
+
+   return((qurt_time_t)(((Now.tv_sec - Start.tv_sec) * HOST_TICKS_PER_SECOND) + ((Now.tv_nsec - Start.tv_nsec) / (1000000000L / HOST_TICKS_PER_SECOND))));
+}
+
+qurt_time_t qurt_timer_convert_time_to_ticks(qurt_time_t time, qurt_time_unit_t time_unit)
+{
+   return(time);
+}
+
+qurt_time_t qurt_timer_convert_ticks_to_time(qurt_time_t ticks, qurt_time_unit_t time_unit)
+{
+   return(ticks);
+}
+
+void qurt_timer_attr_init(qurt_timer_attr_t *attr)
+{
+   memset(attr, 0, sizeof(qurt_timer_attr_t));
+   ((Host_Timer_Attr_t *)attr)->Option = QURT_TIMER_ONESHOT | QURT_TIMER_AUTO_START;
+}
+
+void qurt_timer_attr_set_duration(qurt_timer_attr_t *attr, qurt_time_t duration)
+{
+   ((Host_Timer_Attr_t *)attr)->Duration = duration;
+}
+
+void qurt_timer_attr_set_callback(qurt_timer_attr_t *attr, qurt_timer_callback_func_t cbfunc, void *cbctxt)
+{
+   ((Host_Timer_Attr_t *)attr)->Callback         = cbfunc;
+   ((Host_Timer_Attr_t *)attr)->Callback_Context = cbctxt;
+}
+
+void qurt_timer_attr_set_signal(qurt_timer_attr_t *attr, qurt_signal_t *signal, uint32 mask)
+{
+   ((Host_Timer_Attr_t *)attr)->Signal      = signal;
+   ((Host_Timer_Attr_t *)attr)->Signal_Mask = mask;
+}
+
+void qurt_timer_attr_set_reload(qurt_timer_attr_t *attr, qurt_time_t reload_time)
+{
+   ((Host_Timer_Attr_t *)attr)->Reload = reload_time;
+}
+
+void qurt_timer_attr_set_option(qurt_timer_attr_t *attr, uint32 option)
+{
+   ((Host_Timer_Attr_t *)attr)->Option = option;
+}
+
+/**
+   @brief This function adds a timer to the running list.  The timer mutex
+          must be held.
+
+   @param Timer is the timer to add.
+   @param Duration is the time (in ticks) until the timer expires.
+*/
+static void Insert_Timer(Host_Timer_t *Timer, qurt_time_t Duration)
+{
+   Host_Timer_t **Link;
+
+   Remove_Timer(Timer);
+   Get_Deadline(Duration, &(Timer->Expiry));
+
+   Link = &(Host_QuRT_Context.Timer_List);
+   while((*Link != NULL) && (((*Link)->Expiry.tv_sec < Timer->Expiry.tv_sec) || (((*Link)->Expiry.tv_sec == Timer->Expiry.tv_sec) && ((*Link)->Expiry.tv_nsec <= Timer->Expiry.tv_nsec))))
+   {
+      Link = &((*Link)->Next);
+   }
+
+   Timer->Next    = *Link;
+   Timer->Running = true;
+   *Link          = Timer;
+
+   pthread_cond_broadcast(&(Host_QuRT_Context.Timer_Condition));
+}
+
+/**
+   @brief This function removes a timer from the running list.  The timer
+          mutex must be held.
+
+   @param Timer is the timer to remove.
+*/
+static void Remove_Timer(Host_Timer_t *Timer)
+{
+   Host_Timer_t **Link;
+
+   if(Timer->Running)
+   {
+      Link = &(Host_QuRT_Context.Timer_List);
+      while((*Link != NULL) && (*Link != Timer))
+      {
+         Link = &((*Link)->Next);
+      }
+
+      if(*Link != NULL)
+      {
+         *Link = Timer->Next;
+      }
+
+      Timer->Running = false;
+   }
+}
+
+/**
+   @brief This function is the thread which expires the timers.  Callbacks
+          are called from this thread, much as they are called from the
+          timer task on the target.
+
+   @param Parameter is not used.
+
+   @return NULL.
+*/
+static void *Timer_Thread(void *Parameter)
+{
+   Host_Timer_t    *Timer;
+   Host_Timer_Attr_t Attr;
+   struct timespec  Now;
+
+   pthread_mutex_lock(&(Host_QuRT_Context.Timer_Mutex));
+
+   while(true)
+   {
+      if((Timer = Host_QuRT_Context.Timer_List) == NULL)
+      {
+         pthread_cond_wait(&(Host_QuRT_Context.Timer_Condition), &(Host_QuRT_Context.Timer_Mutex));
+      }
+      else
+      {
+         clock_gettime(CLOCK_MONOTONIC, &Now);
+
+         if((Now.tv_sec > Timer->Expiry.tv_sec) || ((Now.tv_sec == Timer->Expiry.tv_sec) && (Now.tv_nsec >= Timer->Expiry.tv_nsec)))
+         {
+            Remove_Timer(Timer);
+
+            if((Timer->Attr.Option & QURT_TIMER_PERIODIC) && (Timer->Attr.Reload != 0))
+            {
+               Insert_Timer(Timer, Timer->Attr.Reload);
+            }
+            else if(Timer->Attr.Option & QURT_TIMER_PERIODIC)
+            {
+               Insert_Timer(Timer, Timer->Attr.Duration);
+            }
+
+            /* Call the callback without the mutex so it can use the timer
+               API. */
+            Attr = Timer->Attr;
+            pthread_mutex_unlock(&(Host_QuRT_Context.Timer_Mutex));
+
+            if(Attr.Callback != NULL)
+            {
+               (*(Attr.Callback))(Attr.Callback_Context);
+            }
+
+            if(Attr.Signal != NULL)
+            {
+               qurt_signal_set(Attr.Signal, Attr.Signal_Mask);
+            }
+
+            pthread_mutex_lock(&(Host_QuRT_Context.Timer_Mutex));
+         }
+         else
+         {
+            pthread_cond_timedwait(&(Host_QuRT_Context.Timer_Condition), &(Host_QuRT_Context.Timer_Mutex), &(Timer->Expiry));
+         }
+      }
+   }
+
+   return(NULL);
+}
+
+int qurt_timer_create(qurt_timer_t *timer, const qurt_timer_attr_t *attr)
+{
+   pthread_condattr_t  Attribute;
+   Host_Timer_t       *Host_Timer;
+   int                 Ret_Val;
+
+   pthread_mutex_lock(&(Host_QuRT_Context.Timer_Mutex));
+
+   /* Start the timer thread with the first timer. */
+   if(!Host_QuRT_Context.Timer_Thread_Started)
+   {
+      pthread_condattr_init(&Attribute);
+      pthread_condattr_setclock(&Attribute, CLOCK_MONOTONIC);
+      pthread_cond_destroy(&(Host_QuRT_Context.Timer_Condition));
+      pthread_cond_init(&(Host_QuRT_Context.Timer_Condition), &Attribute);
+      pthread_condattr_destroy(&Attribute);
+
+      if(pthread_create(&(Host_QuRT_Context.Timer_Thread), NULL, Timer_Thread, NULL) == 0)
+      {
+         pthread_detach(Host_QuRT_Context.Timer_Thread);
+         Host_QuRT_Context.Timer_Thread_Started = true;
+      }
+   }
+
+   if(!Host_QuRT_Context.Timer_Thread_Started)
+   {
+      Ret_Val = QURT_EFAILED;
+   }
+   else if((Host_Timer = (Host_Timer_t *)calloc(1, sizeof(Host_Timer_t))) == NULL)
+   {
+      Ret_Val = QURT_EMEM;
+   }
+   else
+   {
+      Host_Timer->Attr = *((const Host_Timer_Attr_t *)attr);
+
+      if(!(Host_Timer->Attr.Option & QURT_TIMER_NO_AUTO_START))
+      {
+         Insert_Timer(Host_Timer, Host_Timer->Attr.Duration);
+      }
+
+      *timer  = (qurt_timer_t)Host_Timer;
+      Ret_Val = QURT_EOK;
+   }
+
+   pthread_mutex_unlock(&(Host_QuRT_Context.Timer_Mutex));
+
+   return(Ret_Val);
+}
+
+int qurt_timer_start(qurt_timer_t timer)
+{
+   Host_Timer_t *Host_Timer;
+
+   Host_Timer = (Host_Timer_t *)timer;
+
+   pthread_mutex_lock(&(Host_QuRT_Context.Timer_Mutex));
+   Insert_Timer(Host_Timer, Host_Timer->Attr.Duration);
+   pthread_mutex_unlock(&(Host_QuRT_Context.Timer_Mutex));
+
+   return(QURT_EOK);
+}
+
+int qurt_timer_restart(qurt_timer_t timer, qurt_time_t duration)
+{
+   Host_Timer_t *Host_Timer;
+
+   Host_Timer = (Host_Timer_t *)timer;
+
+   pthread_mutex_lock(&(Host_QuRT_Context.Timer_Mutex));
+   Host_Timer->Attr.Duration = duration;
+   Insert_Timer(Host_Timer, duration);
+   pthread_mutex_unlock(&(Host_QuRT_Context.Timer_Mutex));
+
+   return(QURT_EOK);
+}
+
+int qurt_timer_stop(qurt_timer_t timer)
+{
+   pthread_mutex_lock(&(Host_QuRT_Context.Timer_Mutex));
+   Remove_Timer((Host_Timer_t *)timer);
+   pthread_mutex_unlock(&(Host_QuRT_Context.Timer_Mutex));
+
+   return(QURT_EOK);
+}
+
+int qurt_timer_delete(qurt_timer_t timer)
+{
+   pthread_mutex_lock(&(Host_QuRT_Context.Timer_Mutex));
+   Remove_Timer((Host_Timer_t *)timer);
+   pthread_mutex_unlock(&(Host_QuRT_Context.Timer_Mutex));
+
+   free((Host_Timer_t *)timer);
+
+   return(QURT_EOK);
+}
+
+int qurt_timer_get_attr(qurt_timer_t timer, qurt_timer_attr_t *attr)
+{
+   pthread_mutex_lock(&(Host_QuRT_Context.Timer_Mutex));
+   memset(attr, 0, sizeof(qurt_timer_attr_t));
+   *((Host_Timer_Attr_t *)attr) = ((Host_Timer_t *)timer)->Attr;
+   pthread_mutex_unlock(&(Host_QuRT_Context.Timer_Mutex));
+
+   return(QURT_EOK);
+}
+
+int qurt_timer_attr_get_duration(qurt_timer_attr_t *attr, qurt_time_t *duration)
+{
+   *duration = ((Host_Timer_Attr_t *)attr)->Duration;
+
+   return(QURT_EOK);
+}
+
+int qurt_timer_attr_get_option(qurt_timer_attr_t *attr, uint32 *option)
+{
+   *option = ((Host_Timer_Attr_t *)attr)->Option;
+
+   return(QURT_EOK);
+}
+
+int qurt_timer_attr_get_reload(qurt_timer_attr_t *attr, qurt_time_t *reload_time)
+{
+   *reload_time = ((Host_Timer_Attr_t *)attr)->Reload;
+
+   return(QURT_EOK);
+}
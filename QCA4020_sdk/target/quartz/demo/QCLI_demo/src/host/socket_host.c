@@ -0,0 +1,856 @@
+/*
+* Copyright (c) 2016 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*-------------------------------------------------------------------------
+ * Include Files
+ *-----------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "qapi_types.h"
+#include "qapi/qapi_status.h"
+#include "qapi_socket.h"
+#include "qapi_netbuf.h"
+#include "qapi_ns_utils.h"
+#include "qapi_ns_gen_v4.h"
+#include "qapi_ns_gen_v6.h"
+
+#include "socket_host.h"
+
+/*-------------------------------------------------------------------------
+ * Preprocessor Definitions and Constants
+ *-----------------------------------------------------------------------*/
+
+/**
+   The IPv4 configuration reported for the fake interfaces, in host order.
+   Traffic to the interface address stays on the host loopback.
+*/
+#define HOST_NET_IPV4_ADDRESS                               (0x7F000001)
+#define HOST_NET_IPV4_SUBNET_MASK                           (0xFF000000)
+
+/*-------------------------------------------------------------------------
+ * Type Declarations
+ *-----------------------------------------------------------------------*/
+
+/**
+   This structure contains the context information of the socket fake.
+*/
+typedef struct Host_Socket_Context_s
+{
+   pthread_mutex_t Mutex;                                /**< Protects the context. */
+   int32_t         Last_Error;                           /**< The error of the last call that had no valid handle. */
+   int32_t         Error[HOST_SOCKET_MAX_HANDLE];        /**< The error of the last call on each handle. */
+} Host_Socket_Context_t;
+
+static Host_Socket_Context_t Host_Socket_Context = {PTHREAD_MUTEX_INITIALIZER};
+
+/*-------------------------------------------------------------------------
+ * Function Declarations
+ *-----------------------------------------------------------------------*/
+
+static qbool_t Valid_Handle(int32_t Handle);
+static int32_t Set_Error(int32_t Handle, Host_Socket_Error_t Error);
+static qbool_t To_Host_Address(const struct sockaddr *Address, int32_t Length, Host_Socket_Address_t *Host_Address);
+static void From_Host_Address(const Host_Socket_Address_t *Host_Address, struct sockaddr *Address, int32_t *Length);
+static qbool_t Known_Interface(const char *Interface_Name);
+
+/*-------------------------------------------------------------------------
+ * Function Definitions
+ *-----------------------------------------------------------------------*/
+
+/**
+   @brief This function checks if a handle can refer to a socket of the
+          fake.
+
+   @param Handle is the handle to check.
+
+   @return true if the handle is in range, false otherwise.
+*/
+static qbool_t Valid_Handle(int32_t Handle)
+{
+   return((qbool_t)((Handle >= 0) && (Handle < HOST_SOCKET_MAX_HANDLE)));
+}
+
+/**
+   @brief This function records the error of a call so that qapi_errno()
+          can return it.
+
+   @param Handle is the socket of the call, or -1 if there was none.
+   @param Error is the error of the call.
+
+   @return -1 so that the caller can return it.
+*/
+static int32_t Set_Error(int32_t Handle, Host_Socket_Error_t Error)
+{
+   static const int32_t Error_Map[] =
+   {
+      0,             /* HOST_SOCKET_ERROR_NONE_E          */
+      EWOULDBLOCK,   /* HOST_SOCKET_ERROR_WOULD_BLOCK_E   */
+      EINVAL,        /* HOST_SOCKET_ERROR_INVALID_E       */
+      ENOBUFS,       /* HOST_SOCKET_ERROR_NO_MEMORY_E     */
+      EADDRINUSE,    /* HOST_SOCKET_ERROR_IN_USE_E        */
+      EADDRNOTAVAIL, /* HOST_SOCKET_ERROR_NOT_AVAILABLE_E */
+      ECONNREFUSED,  /* HOST_SOCKET_ERROR_REFUSED_E       */
+      ECONNRESET,    /* HOST_SOCKET_ERROR_RESET_E         */
+      ENOTCONN,      /* HOST_SOCKET_ERROR_NOT_CONNECTED_E */
+      EINPROGRESS,   /* HOST_SOCKET_ERROR_IN_PROGRESS_E   */
+      ETIMEDOUT,     /* HOST_SOCKET_ERROR_TIMED_OUT_E     */
+      EPIPE,         /* HOST_SOCKET_ERROR_PIPE_E          */
+      EOPNOTSUPP,    /* HOST_SOCKET_ERROR_NOT_SUPPORTED_E */
+      EIEIO          /* HOST_SOCKET_ERROR_GENERAL_E       */
+   };
+
+   int32_t QAPI_Error;
+
+   QAPI_Error = ((uint32_t)Error < sizeof(Error_Map) / sizeof(Error_Map[0])) ? Error_Map[Error] : EIEIO;
+
+   pthread_mutex_lock(&(Host_Socket_Context.Mutex));
+
+   if(Valid_Handle(Handle))
+   {
+      Host_Socket_Context.Error[Handle] = QAPI_Error;
+   }
+   else
+   {
+      Host_Socket_Context.Last_Error = QAPI_Error;
+   }
+
+   pthread_mutex_unlock(&(Host_Socket_Context.Mutex));
+
+   return(-1);
+}
+
+/**
+   @brief This function converts a QAPI socket address to a
+          Host_Socket_Address_t.
+
+   @param Address is the address to convert.
+   @param Length is the length of the address.
+   @param Host_Address is where the converted address is returned.
+
+   @return true if the address was converted, false if it is invalid.
+*/
+static qbool_t To_Host_Address(const struct sockaddr *Address, int32_t Length, Host_Socket_Address_t *Host_Address)
+{
+   qbool_t Ret_Val;
+
+   memset(Host_Address, 0, sizeof(Host_Socket_Address_t));
+
+   if((Address != NULL) && (Address->sa_family == AF_INET) && (Length >= (int32_t)sizeof(struct sockaddr_in)))
+   {
+      Host_Address->Family = 4;
+      Host_Address->Port   = ((const struct sockaddr_in *)Address)->sin_port;
+      memcpy(Host_Address->Address, &(((const struct sockaddr_in *)Address)->sin_addr.s_addr), 4);
+
+      Ret_Val = true;
+   }
+   else if((Address != NULL) && (Address->sa_family == AF_INET6) && (Length >= (int32_t)sizeof(struct sockaddr_in6)))
+   {
+      Host_Address->Family   = 6;
+      Host_Address->Port     = ((const struct sockaddr_in6 *)Address)->sin_port;
+      Host_Address->Scope_ID = (uint32_t)((const struct sockaddr_in6 *)Address)->sin_scope_id;
+      memcpy(Host_Address->Address, ((const struct sockaddr_in6 *)Address)->sin_addr.s_addr, 16);
+
+      Ret_Val = true;
+   }
+   else
+   {
+      Ret_Val = false;
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function converts a Host_Socket_Address_t to a QAPI socket
+          address.  Nothing is returned if the buffer is too small.
+
+   @param Host_Address is the address to convert.
+   @param Address is where the converted address is returned, may be NULL.
+   @param Length is the size of the address buffer on input and the length
+          of the address on output.
+*/
+static void From_Host_Address(const Host_Socket_Address_t *Host_Address, struct sockaddr *Address, int32_t *Length)
+{
+   struct sockaddr_in  *Address4;
+   struct sockaddr_in6 *Address6;
+
+   if((Address != NULL) && (Length != NULL))
+   {
+      if((Host_Address->Family == 4) && (*Length >= (int32_t)sizeof(struct sockaddr_in)))
+      {
+         Address4 = (struct sockaddr_in *)Address;
+         memset(Address4, 0, sizeof(struct sockaddr_in));
+
+         Address4->sin_family = AF_INET;
+         Address4->sin_port   = Host_Address->Port;
+         memcpy(&(Address4->sin_addr.s_addr), Host_Address->Address, 4);
+
+         *Length = sizeof(struct sockaddr_in);
+      }
+      else if((Host_Address->Family == 6) && (*Length >= (int32_t)sizeof(struct sockaddr_in6)))
+      {
+         Address6 = (struct sockaddr_in6 *)Address;
+         memset(Address6, 0, sizeof(struct sockaddr_in6));
+
+         Address6->sin_family   = AF_INET6;
+         Address6->sin_port     = Host_Address->Port;
+         Address6->sin_scope_id = (int32_t)Host_Address->Scope_ID;
+         memcpy(Address6->sin_addr.s_addr, Host_Address->Address, 16);
+
+         *Length = sizeof(struct sockaddr_in6);
+      }
+   }
+}
+
+/**
+   @brief This function checks if an interface name is one of the fake
+          interfaces.
+
+   @param Interface_Name is the name to check.
+
+   @return true if the interface exists, false otherwise.
+*/
+static qbool_t Known_Interface(const char *Interface_Name)
+{
+   return((qbool_t)((Interface_Name != NULL) && ((strcmp(Interface_Name, "wlan0") == 0) || (strcmp(Interface_Name, "wlan1") == 0))));
+}
+
+int32_t qapi_socket(int32_t family, int32_t type, int32_t protocol)
+{
+   Host_Socket_Error_t Error;
+   int32_t             Ret_Val;
+
+   /* Raw sockets and the dual stack family need the target stack. */
+   if(((family == AF_INET) || (family == AF_INET6)) && ((type == SOCK_STREAM) || (type == SOCK_DGRAM)))
+   {
+      if((Ret_Val = Host_Socket_Open((family == AF_INET) ? 4 : 6, (type == SOCK_STREAM), &Error)) >= 0)
+      {
+         Set_Error(Ret_Val, HOST_SOCKET_ERROR_NONE_E);
+      }
+      else
+      {
+         Set_Error(-1, Error);
+      }
+   }
+   else
+   {
+      Ret_Val = Set_Error(-1, HOST_SOCKET_ERROR_NOT_SUPPORTED_E);
+   }
+
+   return(Ret_Val);
+}
+
+int32_t qapi_bind(int32_t handle, struct sockaddr *addr, int32_t addrlen)
+{
+   Host_Socket_Address_t Address;
+   Host_Socket_Error_t   Error;
+   int32_t               Ret_Val;
+
+   if(!Valid_Handle(handle))
+   {
+      Ret_Val = Set_Error(-1, HOST_SOCKET_ERROR_INVALID_E);
+   }
+   else if(!To_Host_Address(addr, addrlen, &Address))
+   {
+      Ret_Val = Set_Error(handle, HOST_SOCKET_ERROR_INVALID_E);
+   }
+   else if((Ret_Val = Host_Socket_Bind(handle, &Address, &Error)) != 0)
+   {
+      Ret_Val = Set_Error(handle, Error);
+   }
+
+   return(Ret_Val);
+}
+
+int32_t qapi_listen(int32_t handle, int32_t backlog)
+{
+   Host_Socket_Error_t Error;
+   int32_t             Ret_Val;
+
+   if(!Valid_Handle(handle))
+   {
+      Ret_Val = Set_Error(-1, HOST_SOCKET_ERROR_INVALID_E);
+   }
+   else if((Ret_Val = Host_Socket_Listen(handle, backlog, &Error)) != 0)
+   {
+      Ret_Val = Set_Error(handle, Error);
+   }
+
+   return(Ret_Val);
+}
+
+int32_t qapi_accept(int32_t handle, struct sockaddr *cliaddr, int32_t *addrlen)
+{
+   Host_Socket_Address_t Address;
+   Host_Socket_Error_t   Error;
+   int32_t               Ret_Val;
+
+   if(!Valid_Handle(handle))
+   {
+      Ret_Val = Set_Error(-1, HOST_SOCKET_ERROR_INVALID_E);
+   }
+   else if((Ret_Val = Host_Socket_Accept(handle, &Address, &Error)) >= 0)
+   {
+      Set_Error(Ret_Val, HOST_SOCKET_ERROR_NONE_E);
+      From_Host_Address(&Address, cliaddr, addrlen);
+   }
+   else
+   {
+      Ret_Val = Set_Error(handle, Error);
+   }
+
+   return(Ret_Val);
+}
+
+int32_t qapi_connect(int32_t handle, struct sockaddr *srvaddr, int32_t addrlen)
+{
+   Host_Socket_Address_t Address;
+   Host_Socket_Error_t   Error;
+   int32_t               Ret_Val;
+
+   if(!Valid_Handle(handle))
+   {
+      Ret_Val = Set_Error(-1, HOST_SOCKET_ERROR_INVALID_E);
+   }
+   else if(!To_Host_Address(srvaddr, addrlen, &Address))
+   {
+      Ret_Val = Set_Error(handle, HOST_SOCKET_ERROR_INVALID_E);
+   }
+   else if((Ret_Val = Host_Socket_Connect(handle, &Address, &Error)) != 0)
+   {
+      Ret_Val = Set_Error(handle, Error);
+   }
+
+   return(Ret_Val);
+}
+
+int32_t qapi_setsockopt(int32_t handle, int32_t level, int32_t optname, void *optval, int32_t optlen)
+{
+   Host_Socket_Option_t Option;
+   Host_Socket_Error_t  Error;
+   int32_t              Value;
+   int32_t              Ret_Val;
+
+   Ret_Val = 0;
+   Option  = HOST_SOCKET_OPTION_NON_BLOCKING_E;
+   Value   = 0;
+
+   if(!Valid_Handle(handle))
+   {
+      Ret_Val = Set_Error(-1, HOST_SOCKET_ERROR_INVALID_E);
+   }
+   else if((level == SOL_SOCKET) && ((optname == SO_NBIO) || (optname == SO_BIO)))
+   {
+      Value = (optname == SO_NBIO);
+   }
+   else if((level == SOL_SOCKET) && (optval != NULL) && (optlen >= (int32_t)sizeof(int32_t)))
+   {
+      Value = *(int32_t *)optval;
+
+      switch(optname)
+      {
+         case SO_NONBLOCK:
+            Option = HOST_SOCKET_OPTION_NON_BLOCKING_E;
+            break;
+         case SO_REUSEADDR:
+            Option = HOST_SOCKET_OPTION_REUSE_ADDRESS_E;
+            break;
+         case SO_KEEPALIVE:
+            Option = HOST_SOCKET_OPTION_KEEP_ALIVE_E;
+            break;
+         case SO_SNDBUF:
+            Option = HOST_SOCKET_OPTION_SEND_BUFFER_E;
+            break;
+         case SO_RCVBUF:
+            Option = HOST_SOCKET_OPTION_RECEIVE_BUFFER_E;
+            break;
+         case SO_SNDTIMEO:
+            Option = HOST_SOCKET_OPTION_SEND_TIMEOUT_E;
+            break;
+         case SO_RCVTIMEO:
+            Option = HOST_SOCKET_OPTION_RECEIVE_TIMEOUT_E;
+            break;
+         default:
+            Ret_Val = Set_Error(handle, HOST_SOCKET_ERROR_NOT_SUPPORTED_E);
+            break;
+      }
+   }
+   else
+   {
+      /* Zero-copy callbacks, multicast and the IP header options need the
+         target stack. */
+      Ret_Val = Set_Error(handle, HOST_SOCKET_ERROR_NOT_SUPPORTED_E);
+   }
+
+   if((Ret_Val == 0) && (Host_Socket_Set_Option(handle, Option, Value, &Error) != 0))
+   {
+      Ret_Val = Set_Error(handle, Error);
+   }
+
+   return(Ret_Val);
+}
+
+int32_t qapi_getsockopt(int32_t handle, int32_t level, int32_t optname, void *optval, int32_t *optlen)
+{
+   Host_Socket_Option_t Option;
+   Host_Socket_Error_t  Error;
+   int32_t              Value;
+   int32_t              Ret_Val;
+
+   /* The demos pass the size of the option cast to a pointer as optlen, so
+      it is not used and every supported option is an int32_t. */
+   Ret_Val = 0;
+
+   if(!Valid_Handle(handle))
+   {
+      Ret_Val = Set_Error(-1, HOST_SOCKET_ERROR_INVALID_E);
+   }
+   else if((level == SOL_SOCKET) && (optval != NULL) && ((optname == SO_SNDBUF) || (optname == SO_RCVBUF) || (optname == SO_ERROR)))
+   {
+      Option = (optname == SO_SNDBUF) ? HOST_SOCKET_OPTION_SEND_BUFFER_E : ((optname == SO_RCVBUF) ? HOST_SOCKET_OPTION_RECEIVE_BUFFER_E : HOST_SOCKET_OPTION_ERROR_E);
+
+      if(Host_Socket_Get_Option(handle, Option, &Value, &Error) == 0)
+      {
+         if(Option == HOST_SOCKET_OPTION_ERROR_E)
+         {
+            /* Map the pending error the same way as the call errors. */
+            Set_Error(handle, (Host_Socket_Error_t)Value);
+            Value = qapi_errno(handle);
+         }
+
+         *(int32_t *)optval = Value;
+      }
+      else
+      {
+         Ret_Val = Set_Error(handle, Error);
+      }
+   }
+   else
+   {
+      Ret_Val = Set_Error(handle, HOST_SOCKET_ERROR_NOT_SUPPORTED_E);
+   }
+
+   return(Ret_Val);
+}
+
+int32_t qapi_getpeername(int32_t handle, struct sockaddr *addr, int32_t *addrlen)
+{
+   return(Set_Error(handle, HOST_SOCKET_ERROR_NOT_SUPPORTED_E));
+}
+
+int32_t qapi_getsockname(int32_t handle, struct sockaddr *addr, int32_t *addrlen)
+{
+   return(Set_Error(handle, HOST_SOCKET_ERROR_NOT_SUPPORTED_E));
+}
+
+int32_t qapi_socketclose(int32_t handle)
+{
+   int32_t Ret_Val;
+
+   if((!Valid_Handle(handle)) || (Host_Socket_Close(handle) != 0))
+   {
+      Ret_Val = Set_Error(-1, HOST_SOCKET_ERROR_INVALID_E);
+   }
+   else
+   {
+      Set_Error(handle, HOST_SOCKET_ERROR_NONE_E);
+
+      Ret_Val = 0;
+   }
+
+   return(Ret_Val);
+}
+
+int32_t qapi_errno(int32_t handle)
+{
+   int32_t Ret_Val;
+
+   pthread_mutex_lock(&(Host_Socket_Context.Mutex));
+
+   Ret_Val = Valid_Handle(handle) ? Host_Socket_Context.Error[handle] : Host_Socket_Context.Last_Error;
+
+   pthread_mutex_unlock(&(Host_Socket_Context.Mutex));
+
+   return(Ret_Val);
+}
+
+int32_t qapi_recvfrom(int32_t handle, char *buf, int32_t len, int32_t flags, struct sockaddr *from, int32_t *fromlen)
+{
+   Host_Socket_Address_t Address;
+   Host_Socket_Error_t   Error;
+   uint32_t              Host_Flags;
+   int32_t               Ret_Val;
+
+   Host_Flags = ((flags & MSG_DONTWAIT) ? HOST_SOCKET_FLAG_DONT_WAIT : 0) | ((flags & MSG_PEEK) ? HOST_SOCKET_FLAG_PEEK : 0);
+
+   if(!Valid_Handle(handle))
+   {
+      Ret_Val = Set_Error(-1, HOST_SOCKET_ERROR_INVALID_E);
+   }
+   else if((Ret_Val = Host_Socket_Receive(handle, buf, len, Host_Flags, &Address, &Error)) >= 0)
+   {
+      From_Host_Address(&Address, from, fromlen);
+   }
+   else
+   {
+      Ret_Val = Set_Error(handle, Error);
+   }
+
+   return(Ret_Val);
+}
+
+int32_t qapi_recv(int32_t handle, char *buf, int32_t len, int32_t flags)
+{
+   return(qapi_recvfrom(handle, buf, len, flags, NULL, NULL));
+}
+
+/* A zero-copy send passes a buffer from qapi_Net_Buf_Alloc(), which is
+   freed once it has been sent. */
+int32_t qapi_sendto(int32_t handle, char *buf, int32_t len, int32_t flags, struct sockaddr *to, int32_t tolen)
+{
+   Host_Socket_Address_t  Address;
+   Host_Socket_Error_t    Error;
+   qapi_Net_Buf_t        *Net_Buf;
+   char                  *Data;
+   int32_t                Ret_Val;
+
+   Data = buf;
+   if(flags & MSG_ZEROCOPYSEND)
+   {
+      Net_Buf = (qapi_Net_Buf_t *)buf;
+      Data    = Net_Buf->nb_Prot;
+      len     = ((uint32_t)len < Net_Buf->nb_Plen) ? len : (int32_t)Net_Buf->nb_Plen;
+   }
+
+   if(!Valid_Handle(handle))
+   {
+      Ret_Val = Set_Error(-1, HOST_SOCKET_ERROR_INVALID_E);
+   }
+   else if((to != NULL) && (!To_Host_Address(to, tolen, &Address)))
+   {
+      Ret_Val = Set_Error(handle, HOST_SOCKET_ERROR_INVALID_E);
+   }
+   else if((Ret_Val = Host_Socket_Send(handle, Data, len, (flags & MSG_DONTWAIT) ? HOST_SOCKET_FLAG_DONT_WAIT : 0, (to != NULL) ? &Address : NULL, &Error)) < 0)
+   {
+      Ret_Val = Set_Error(handle, Error);
+   }
+
+   if((Ret_Val >= 0) && (flags & MSG_ZEROCOPYSEND))
+   {
+      qapi_Net_Buf_Free(buf, QAPI_NETBUF_SYS);
+   }
+
+   return(Ret_Val);
+}
+
+int32_t qapi_send(int32_t handle, char *buf, int32_t len, int32_t flags)
+{
+   return(qapi_sendto(handle, buf, len, flags, NULL, 0));
+}
+
+/* Only the read set is supported, as on the target. */
+int32_t qapi_select(qapi_fd_set_t *rd, qapi_fd_set_t *wr, qapi_fd_set_t *ex, int32_t timeout_ms)
+{
+   Host_Socket_Poll_t Poll_List[FD_SETSIZE];
+   uint32_t           Index;
+   uint32_t           Count;
+   int32_t            Ret_Val;
+
+   if((rd != NULL) && (rd->fd_count <= FD_SETSIZE) && (wr == NULL) && (ex == NULL))
+   {
+      Count = rd->fd_count;
+
+      for(Index = 0; Index < Count; Index ++)
+      {
+         Poll_List[Index].Handle = (int32_t)rd->fd_array[Index];
+         Poll_List[Index].Events = HOST_SOCKET_POLL_READ;
+      }
+
+      if((Ret_Val = Host_Socket_Poll(Poll_List, Count, (timeout_ms == (int32_t)QAPI_NET_WAIT_FOREVER) ? -1 : timeout_ms)) >= 0)
+      {
+         /* Leave only the ready sockets in the set. */
+         rd->fd_count = 0;
+
+         for(Index = 0; Index < Count; Index ++)
+         {
+            if(Poll_List[Index].Ready)
+            {
+               rd->fd_array[rd->fd_count ++] = (uint32_t)Poll_List[Index].Handle;
+            }
+         }
+      }
+   }
+   else
+   {
+      Ret_Val = Set_Error(-1, HOST_SOCKET_ERROR_INVALID_E);
+   }
+
+   return(Ret_Val);
+}
+
+int32_t qapi_fd_zero(qapi_fd_set_t *set)
+{
+   set->fd_count = 0;
+
+   return(0);
+}
+
+int32_t qapi_fd_clr(int32_t handle, qapi_fd_set_t *set)
+{
+   uint32_t Index;
+   int32_t  Ret_Val;
+
+   Ret_Val = -1;
+
+   for(Index = 0; Index < set->fd_count; Index ++)
+   {
+      if(set->fd_array[Index] == (uint32_t)handle)
+      {
+         set->fd_array[Index] = set->fd_array[-- set->fd_count];
+
+         Ret_Val = 0;
+         break;
+      }
+   }
+
+   return(Ret_Val);
+}
+
+int32_t qapi_fd_set(int32_t handle, qapi_fd_set_t *set)
+{
+   int32_t Ret_Val;
+
+   if(qapi_fd_isset(handle, set))
+   {
+      Ret_Val = 0;
+   }
+   else if(set->fd_count < FD_SETSIZE)
+   {
+      set->fd_array[set->fd_count ++] = (uint32_t)handle;
+
+      Ret_Val = 0;
+   }
+   else
+   {
+      Ret_Val = -1;
+   }
+
+   return(Ret_Val);
+}
+
+int32_t qapi_fd_isset(int32_t handle, qapi_fd_set_t *set)
+{
+   uint32_t Index;
+   int32_t  Ret_Val;
+
+   Ret_Val = 0;
+
+   for(Index = 0; (Index < set->fd_count) && (Ret_Val == 0); Index ++)
+   {
+      if(set->fd_array[Index] == (uint32_t)handle)
+      {
+         Ret_Val = 1;
+      }
+   }
+
+   return(Ret_Val);
+}
+
+/* System buffers are a single qapi_Net_Buf_t followed by the data, so
+   the QAPI_NET_BUF_UPDATE_* macros work on them. */
+void *qapi_Net_Buf_Alloc(uint32_t size, uint32_t id)
+{
+   qapi_Net_Buf_t *Net_Buf;
+   void           *Ret_Val;
+
+   if(id & QAPI_NETBUF_SYS)
+   {
+      if((Net_Buf = (qapi_Net_Buf_t *)malloc(sizeof(qapi_Net_Buf_t) + size)) != NULL)
+      {
+         memset(Net_Buf, 0, sizeof(qapi_Net_Buf_t));
+
+         Net_Buf->nb_Buff = (char *)(Net_Buf + 1);
+         Net_Buf->nb_Blen = size;
+         Net_Buf->nb_Prot = Net_Buf->nb_Buff;
+         Net_Buf->nb_Tlen = size;
+         Net_Buf->nb_Plen = size;
+      }
+
+      Ret_Val = Net_Buf;
+   }
+   else
+   {
+      Ret_Val = malloc(size);
+   }
+
+   return(Ret_Val);
+}
+
+int32_t qapi_Net_Buf_Free(void *buf, uint32_t id)
+{
+   free(buf);
+
+   return(0);
+}
+
+int32_t qapi_Net_Buf_Update(void *netbuf, uint32_t offset, void *srcbuf, uint32_t len, uint32_t id)
+{
+   qapi_Net_Buf_t *Net_Buf;
+   int32_t         Ret_Val;
+
+   if(id & QAPI_NETBUF_SYS)
+   {
+      Net_Buf = (qapi_Net_Buf_t *)netbuf;
+
+      if((offset <= Net_Buf->nb_Plen) && (len <= Net_Buf->nb_Plen - offset))
+      {
+         memcpy(Net_Buf->nb_Prot + offset, srcbuf, len);
+
+         Ret_Val = 0;
+      }
+      else
+      {
+         Ret_Val = -1;
+      }
+   }
+   else
+   {
+      memcpy((char *)netbuf + offset, srcbuf, len);
+
+      Ret_Val = 0;
+   }
+
+   return(Ret_Val);
+}
+
+int32_t inet_pton(int32_t af, const char *src, void *dst)
+{
+   int32_t Ret_Val;
+
+   if((af == AF_INET) || (af == AF_INET6))
+   {
+      Ret_Val = (Host_Socket_Parse_Address((af == AF_INET) ? 4 : 6, src, (uint8_t *)dst) == 0) ? 0 : 1;
+   }
+   else
+   {
+      Ret_Val = -1;
+   }
+
+   return(Ret_Val);
+}
+
+const char *inet_ntop(int32_t af, const void *src, char *dst, size_t size)
+{
+   const char *Ret_Val;
+
+   if(((af == AF_INET) || (af == AF_INET6)) && (Host_Socket_Format_Address((af == AF_INET) ? 4 : 6, (const uint8_t *)src, dst, (uint32_t)size) == 0))
+   {
+      Ret_Val = dst;
+   }
+   else
+   {
+      Ret_Val = NULL;
+   }
+
+   return(Ret_Val);
+}
+
+uint32_t qapi_Net_Htonl(uint32_t hostlong)
+{
+   uint8_t  Bytes[4];
+   uint32_t Ret_Val;
+
+   Bytes[0] = (uint8_t)(hostlong >> 24);
+   Bytes[1] = (uint8_t)(hostlong >> 16);
+   Bytes[2] = (uint8_t)(hostlong >> 8);
+   Bytes[3] = (uint8_t)hostlong;
+
+   memcpy(&Ret_Val, Bytes, sizeof(Ret_Val));
+
+   return(Ret_Val);
+}
+
+uint16_t qapi_Net_Htons(uint16_t hostshort)
+{
+   uint8_t  Bytes[2];
+   uint16_t Ret_Val;
+
+   Bytes[0] = (uint8_t)(hostshort >> 8);
+   Bytes[1] = (uint8_t)hostshort;
+
+   memcpy(&Ret_Val, Bytes, sizeof(Ret_Val));
+
+   return(Ret_Val);
+}
+
+/* Only queries are supported, the fake interfaces cannot be configured. */
+qapi_Status_t qapi_Net_IPv4_Config(const char *interface_Name, qapi_Net_IPv4cfg_Command_t cmd, uint32_t *ipv4_Addr, uint32_t *subnet_Mask, uint32_t *gateway)
+{
+   qapi_Status_t Ret_Val;
+
+   if((Known_Interface(interface_Name)) && (cmd == QAPI_NET_IPV4CFG_QUERY_E))
+   {
+      if(ipv4_Addr != NULL)
+      {
+         *ipv4_Addr = qapi_Net_Htonl(HOST_NET_IPV4_ADDRESS);
+      }
+
+      if(subnet_Mask != NULL)
+      {
+         *subnet_Mask = qapi_Net_Htonl(HOST_NET_IPV4_SUBNET_MASK);
+      }
+
+      if(gateway != NULL)
+      {
+         *gateway = 0;
+      }
+
+      Ret_Val = QAPI_OK;
+   }
+   else
+   {
+      Ret_Val = QAPI_ERROR;
+   }
+
+   return(Ret_Val);
+}
+
+qapi_Status_t qapi_Net_IPv6_Get_Scope_ID(const char *interface_Name, int32_t *scope_ID)
+{
+   qapi_Status_t Ret_Val;
+
+   if(Known_Interface(interface_Name))
+   {
+      *scope_ID = 0;
+
+      Ret_Val = QAPI_OK;
+   }
+   else
+   {
+      Ret_Val = QAPI_ERROR;
+   }
+
+   return(Ret_Val);
+}
@@ -0,0 +1,286 @@
+/*
+* Copyright (c) 2016 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef __SOCKET_HOST_H__
+#define __SOCKET_HOST_H__
+
+/*-------------------------------------------------------------------------
+ * Include Files
+ *-----------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*-------------------------------------------------------------------------
+ * Preprocessor Definitions and Constants
+ *-----------------------------------------------------------------------*/
+
+/**
+   The socket fake is split in two files because qapi_socket.h redefines
+   the BSD socket names and error codes.  socket_host.c implements the
+   QAPI on top of the functions below and socket_host_posix.c implements
+   these on top of the host sockets.  Only the types in this file are
+   shared between the two.
+*/
+
+/**
+   The highest host descriptor that can be used as a QAPI socket handle.
+*/
+#define HOST_SOCKET_MAX_HANDLE                              (1024)
+
+/**
+   The events that can be polled for with Host_Socket_Poll().
+*/
+#define HOST_SOCKET_POLL_READ                               (0x01)
+#define HOST_SOCKET_POLL_WRITE                              (0x02)
+#define HOST_SOCKET_POLL_ERROR                              (0x04)
+
+/**
+   The flags of Host_Socket_Send() and Host_Socket_Receive().
+*/
+#define HOST_SOCKET_FLAG_DONT_WAIT                          (0x01)
+#define HOST_SOCKET_FLAG_PEEK                               (0x02)
+
+/*-------------------------------------------------------------------------
+ * Type Declarations
+ *-----------------------------------------------------------------------*/
+
+/**
+   The errors reported by the host side.  socket_host.c maps them onto the
+   QAPI error codes.
+*/
+typedef enum
+{
+   HOST_SOCKET_ERROR_NONE_E,
+   HOST_SOCKET_ERROR_WOULD_BLOCK_E,
+   HOST_SOCKET_ERROR_INVALID_E,
+   HOST_SOCKET_ERROR_NO_MEMORY_E,
+   HOST_SOCKET_ERROR_IN_USE_E,
+   HOST_SOCKET_ERROR_NOT_AVAILABLE_E,
+   HOST_SOCKET_ERROR_REFUSED_E,
+   HOST_SOCKET_ERROR_RESET_E,
+   HOST_SOCKET_ERROR_NOT_CONNECTED_E,
+   HOST_SOCKET_ERROR_IN_PROGRESS_E,
+   HOST_SOCKET_ERROR_TIMED_OUT_E,
+   HOST_SOCKET_ERROR_PIPE_E,
+   HOST_SOCKET_ERROR_NOT_SUPPORTED_E,
+   HOST_SOCKET_ERROR_GENERAL_E
+} Host_Socket_Error_t;
+
+/**
+   The socket options that can be set with Host_Socket_Set_Option().
+*/
+typedef enum
+{
+   HOST_SOCKET_OPTION_REUSE_ADDRESS_E,
+   HOST_SOCKET_OPTION_KEEP_ALIVE_E,
+   HOST_SOCKET_OPTION_SEND_BUFFER_E,
+   HOST_SOCKET_OPTION_RECEIVE_BUFFER_E,
+   HOST_SOCKET_OPTION_SEND_TIMEOUT_E,
+   HOST_SOCKET_OPTION_RECEIVE_TIMEOUT_E,
+   HOST_SOCKET_OPTION_NON_BLOCKING_E,
+   HOST_SOCKET_OPTION_ERROR_E
+} Host_Socket_Option_t;
+
+/**
+   A socket address.  Family is 4 or 6, Port and Address are in network
+   order.
+*/
+typedef struct Host_Socket_Address_s
+{
+   uint8_t  Family;        /**< 4 for IPv4, 6 for IPv6. */
+   uint16_t Port;          /**< The port in network order. */
+   uint8_t  Address[16];   /**< The address in network order, IPv4 uses the first 4 bytes. */
+   uint32_t Scope_ID;      /**< The IPv6 scope ID. */
+} Host_Socket_Address_t;
+
+/**
+   An entry of the list passed to Host_Socket_Poll().
+*/
+typedef struct Host_Socket_Poll_s
+{
+   int32_t Handle;         /**< The socket to poll. */
+   uint8_t Events;         /**< The HOST_SOCKET_POLL_* events to wait for. */
+   uint8_t Ready;          /**< The HOST_SOCKET_POLL_* events that occurred. */
+} Host_Socket_Poll_t;
+
+/*-------------------------------------------------------------------------
+ * Function Declarations and Documentation
+ *-----------------------------------------------------------------------*/
+
+/**
+   @brief This function opens a host socket.
+
+   @param Family is 4 or 6.
+   @param Stream is non-zero for a TCP socket, zero for UDP.
+   @param Error is where the error is returned on failure.
+
+   @return The handle of the socket, or -1 on failure.
+*/
+int32_t Host_Socket_Open(uint8_t Family, int32_t Stream, Host_Socket_Error_t *Error);
+
+/**
+   @brief This function closes a host socket.
+
+   @param Handle is the socket to close.
+
+   @return 0 on success, -1 on failure.
+*/
+int32_t Host_Socket_Close(int32_t Handle);
+
+/**
+   @brief This function binds a host socket to a local address.
+
+   @param Handle is the socket.
+   @param Address is the local address.
+   @param Error is where the error is returned on failure.
+
+   @return 0 on success, -1 on failure.
+*/
+int32_t Host_Socket_Bind(int32_t Handle, const Host_Socket_Address_t *Address, Host_Socket_Error_t *Error);
+
+/**
+   @brief This function makes a host socket listen for connections.
+
+   @param Handle is the socket.
+   @param Backlog is the number of pending connections.
+   @param Error is where the error is returned on failure.
+
+   @return 0 on success, -1 on failure.
+*/
+int32_t Host_Socket_Listen(int32_t Handle, int32_t Backlog, Host_Socket_Error_t *Error);
+
+/**
+   @brief This function accepts a connection on a listening host socket.
+
+   @param Handle is the listening socket.
+   @param Address is where the address of the peer is returned, may be
+          NULL.
+   @param Error is where the error is returned on failure.
+
+   @return The handle of the new socket, or -1 on failure.
+*/
+int32_t Host_Socket_Accept(int32_t Handle, Host_Socket_Address_t *Address, Host_Socket_Error_t *Error);
+
+/**
+   @brief This function connects a host socket to a peer.
+
+   @param Handle is the socket.
+   @param Address is the address of the peer.
+   @param Error is where the error is returned on failure.
+
+   @return 0 on success, -1 on failure.
+*/
+int32_t Host_Socket_Connect(int32_t Handle, const Host_Socket_Address_t *Address, Host_Socket_Error_t *Error);
+
+/**
+   @brief This function sends data on a host socket.
+
+   @param Handle is the socket.
+   @param Buffer is the data to send.
+   @param Length is the number of bytes to send.
+   @param Flags are HOST_SOCKET_FLAG_* flags.
+   @param Address is the destination, NULL on a connected socket.
+   @param Error is where the error is returned on failure.
+
+   @return The number of bytes sent, or -1 on failure.
+*/
+int32_t Host_Socket_Send(int32_t Handle, const void *Buffer, int32_t Length, uint32_t Flags, const Host_Socket_Address_t *Address, Host_Socket_Error_t *Error);
+
+/**
+   @brief This function receives data from a host socket.
+
+   @param Handle is the socket.
+   @param Buffer is where the data is returned.
+   @param Length is the size of the buffer.
+   @param Flags are HOST_SOCKET_FLAG_* flags.
+   @param Address is where the source is returned, may be NULL.
+   @param Error is where the error is returned on failure.
+
+   @return The number of bytes received, 0 if the peer closed the
+           connection, or -1 on failure.
+*/
+int32_t Host_Socket_Receive(int32_t Handle, void *Buffer, int32_t Length, uint32_t Flags, Host_Socket_Address_t *Address, Host_Socket_Error_t *Error);
+
+/**
+   @brief This function sets an option of a host socket.  Timeouts are in
+          milliseconds.
+
+   @param Handle is the socket.
+   @param Option is the option to set.
+   @param Value is the new value of the option.
+   @param Error is where the error is returned on failure.
+
+   @return 0 on success, -1 on failure.
+*/
+int32_t Host_Socket_Set_Option(int32_t Handle, Host_Socket_Option_t Option, int32_t Value, Host_Socket_Error_t *Error);
+
+/**
+   @brief This function gets an option of a host socket.  The pending
+          error is returned as a Host_Socket_Error_t.
+
+   @param Handle is the socket.
+   @param Option is the option to get.
+   @param Value is where the value of the option is returned.
+   @param Error is where the error is returned on failure.
+
+   @return 0 on success, -1 on failure.
+*/
+int32_t Host_Socket_Get_Option(int32_t Handle, Host_Socket_Option_t Option, int32_t *Value, Host_Socket_Error_t *Error);
+
+/**
+   @brief This function waits for events on a list of host sockets.
+
+   @param List is the list of sockets and events.  The Ready field of each
+          entry is updated.
+   @param Count is the number of entries in the list.
+   @param Timeout is the time to wait in milliseconds, negative to wait
+          forever.
+
+   @return The number of entries with events, 0 on a timeout or -1 on
+           failure.
+*/
+int32_t Host_Socket_Poll(Host_Socket_Poll_t *List, uint32_t Count, int32_t Timeout);
+
+/**
+   @brief This function parses a numeric address string.
+
+   @param Family is 4 or 6.
+   @param String is the string to parse.
+   @param Address is where the address is returned, 4 or 16 bytes.
+
+   @return 0 on success, -1 on failure.
+*/
+int32_t Host_Socket_Parse_Address(uint8_t Family, const char *String, uint8_t *Address);
+
+/**
+   @brief This function formats an address as a numeric string.
+
+   @param Family is 4 or 6.
+   @param Address is the address, 4 or 16 bytes.
+   @param String is where the string is returned.
+   @param Size is the size of the string buffer.
+
+   @return 0 on success, -1 on failure.
+*/
+int32_t Host_Socket_Format_Address(uint8_t Family, const uint8_t *Address, char *String, uint32_t Size);
+
+#endif
@@ -0,0 +1,610 @@
+/*
+* Copyright (c) 2016 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*-------------------------------------------------------------------------
+ * Include Files
+ *-----------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "socket_host.h"
+
+/*-------------------------------------------------------------------------
+ * Preprocessor Definitions and Constants
+ *-----------------------------------------------------------------------*/
+
+/**
+   The number of sockets Host_Socket_Poll() can wait for at once.
+*/
+#define HOST_SOCKET_MAX_POLL                                (32)
+
+/*-------------------------------------------------------------------------
+ * Function Declarations
+ *-----------------------------------------------------------------------*/
+
+static Host_Socket_Error_t Map_Error(int Error);
+static socklen_t To_Host_Address(const Host_Socket_Address_t *Address, struct sockaddr_storage *Host_Address);
+static void From_Host_Address(const struct sockaddr_storage *Host_Address, Host_Socket_Address_t *Address);
+static int32_t Check_Result(int Result, Host_Socket_Error_t *Error);
+
+/*-------------------------------------------------------------------------
+ * Function Definitions
+ *-----------------------------------------------------------------------*/
+
+/**
+   @brief This function maps a host errno value onto a Host_Socket_Error_t.
+
+   @param Error is the errno value.
+
+   @return The mapped error.
+*/
+static Host_Socket_Error_t Map_Error(int Error)
+{
+   Host_Socket_Error_t Ret_Val;
+
+   switch(Error)
+   {
+      case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+      case EWOULDBLOCK:
+#endif
+         Ret_Val = HOST_SOCKET_ERROR_WOULD_BLOCK_E;
+         break;
+      case EINVAL:
+      case EBADF:
+      case EFAULT:
+      case EAFNOSUPPORT:
+         Ret_Val = HOST_SOCKET_ERROR_INVALID_E;
+         break;
+      case ENOMEM:
+      case ENOBUFS:
+      case EMFILE:
+      case ENFILE:
+         Ret_Val = HOST_SOCKET_ERROR_NO_MEMORY_E;
+         break;
+      case EADDRINUSE:
+         Ret_Val = HOST_SOCKET_ERROR_IN_USE_E;
+         break;
+      case EADDRNOTAVAIL:
+         Ret_Val = HOST_SOCKET_ERROR_NOT_AVAILABLE_E;
+         break;
+      case ECONNREFUSED:
+         Ret_Val = HOST_SOCKET_ERROR_REFUSED_E;
+         break;
+      case ECONNRESET:
+      case ECONNABORTED:
+         Ret_Val = HOST_SOCKET_ERROR_RESET_E;
+         break;
+      case ENOTCONN:
+         Ret_Val = HOST_SOCKET_ERROR_NOT_CONNECTED_E;
+         break;
+      case EINPROGRESS:
+      case EALREADY:
+         Ret_Val = HOST_SOCKET_ERROR_IN_PROGRESS_E;
+         break;
+      case ETIMEDOUT:
+         Ret_Val = HOST_SOCKET_ERROR_TIMED_OUT_E;
+         break;
+      case EPIPE:
+         Ret_Val = HOST_SOCKET_ERROR_PIPE_E;
+         break;
+      case EOPNOTSUPP:
+      case ENOPROTOOPT:
+         Ret_Val = HOST_SOCKET_ERROR_NOT_SUPPORTED_E;
+         break;
+      default:
+         Ret_Val = HOST_SOCKET_ERROR_GENERAL_E;
+         break;
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function converts a Host_Socket_Address_t to a host socket
+          address.
+
+   @param Address is the address to convert.
+   @param Host_Address is where the host address is returned.
+
+   @return The length of the host address, 0 if the family is invalid.
+*/
+static socklen_t To_Host_Address(const Host_Socket_Address_t *Address, struct sockaddr_storage *Host_Address)
+{
+   struct sockaddr_in  *Address4;
+   struct sockaddr_in6 *Address6;
+   socklen_t            Ret_Val;
+
+   memset(Host_Address, 0, sizeof(struct sockaddr_storage));
+
+   if(Address->Family == 4)
+   {
+      Address4             = (struct sockaddr_in *)Host_Address;
+      Address4->sin_family = AF_INET;
+      Address4->sin_port   = Address->Port;
+      memcpy(&(Address4->sin_addr), Address->Address, 4);
+
+      Ret_Val = sizeof(struct sockaddr_in);
+   }
+   else if(Address->Family == 6)
+   {
+      Address6                = (struct sockaddr_in6 *)Host_Address;
+      Address6->sin6_family   = AF_INET6;
+      Address6->sin6_port     = Address->Port;
+      Address6->sin6_scope_id = Address->Scope_ID;
+      memcpy(&(Address6->sin6_addr), Address->Address, 16);
+
+      Ret_Val = sizeof(struct sockaddr_in6);
+   }
+   else
+   {
+      Ret_Val = 0;
+   }
+
+   return(Ret_Val);
+}
+
+/**
+   @brief This function converts a host socket address to a
+          Host_Socket_Address_t.
+
+   @param Host_Address is the address to convert.
+   @param Address is where the address is returned.
+*/
+static void From_Host_Address(const struct sockaddr_storage *Host_Address, Host_Socket_Address_t *Address)
+{
+   const struct sockaddr_in  *Address4;
+   const struct sockaddr_in6 *Address6;
+
+   memset(Address, 0, sizeof(Host_Socket_Address_t));
+
+   if(Host_Address->ss_family == AF_INET)
+   {
+      Address4         = (const struct sockaddr_in *)Host_Address;
+      Address->Family  = 4;
+      Address->Port    = Address4->sin_port;
+      memcpy(Address->Address, &(Address4->sin_addr), 4);
+   }
+   else if(Host_Address->ss_family == AF_INET6)
+   {
+      Address6           = (const struct sockaddr_in6 *)Host_Address;
+      Address->Family    = 6;
+      Address->Port      = Address6->sin6_port;
+      Address->Scope_ID  = Address6->sin6_scope_id;
+      memcpy(Address->Address, &(Address6->sin6_addr), 16);
+   }
+}
+
+/**
+   @brief This function returns the result of a host call, setting the
+          error if it failed.
+
+   @param Result is the result of the host call.
+   @param Error is where the error is returned on failure.
+
+   @return Result, or -1 on failure.
+*/
+static int32_t Check_Result(int Result, Host_Socket_Error_t *Error)
+{
+   int32_t Ret_Val;
+
+   if(Result < 0)
+   {
+      *Error  = Map_Error(errno);
+      Ret_Val = -1;
+   }
+   else
+   {
+      Ret_Val = (int32_t)Result;
+   }
+
+   return(Ret_Val);
+}
+
+int32_t Host_Socket_Open(uint8_t Family, int32_t Stream, Host_Socket_Error_t *Error)
+{
+   int32_t Ret_Val;
+   int     Option;
+
+   if((Family == 4) || (Family == 6))
+   {
+      Ret_Val = Check_Result(socket((Family == 4) ? AF_INET : AF_INET6, Stream ? SOCK_STREAM : SOCK_DGRAM, 0), Error);
+
+      if(Ret_Val >= HOST_SOCKET_MAX_HANDLE)
+      {
+         close(Ret_Val);
+
+         *Error  = HOST_SOCKET_ERROR_NO_MEMORY_E;
+         Ret_Val = -1;
+      }
+      else if(Ret_Val >= 0)
+      {
+         /* The demo restarts servers on the same port right away. */
+         Option = 1;
+         setsockopt(Ret_Val, SOL_SOCKET, SO_REUSEADDR, &Option, sizeof(Option));
+
+         if(Stream)
+         {
+            setsockopt(Ret_Val, IPPROTO_TCP, TCP_NODELAY, &Option, sizeof(Option));
+         }
+      }
+   }
+   else
+   {
+      *Error  = HOST_SOCKET_ERROR_INVALID_E;
+      Ret_Val = -1;
+   }
+
+   return(Ret_Val);
+}
+
+int32_t Host_Socket_Close(int32_t Handle)
+{
+   return((close(Handle) == 0) ? 0 : -1);
+}
+
+int32_t Host_Socket_Bind(int32_t Handle, const Host_Socket_Address_t *Address, Host_Socket_Error_t *Error)
+{
+   struct sockaddr_storage Host_Address;
+   socklen_t               Length;
+   int32_t                 Ret_Val;
+
+   if((Length = To_Host_Address(Address, &Host_Address)) != 0)
+   {
+      Ret_Val = Check_Result(bind(Handle, (struct sockaddr *)&Host_Address, Length), Error);
+   }
+   else
+   {
+      *Error  = HOST_SOCKET_ERROR_INVALID_E;
+      Ret_Val = -1;
+   }
+
+   return(Ret_Val);
+}
+
+int32_t Host_Socket_Listen(int32_t Handle, int32_t Backlog, Host_Socket_Error_t *Error)
+{
+   return(Check_Result(listen(Handle, Backlog), Error));
+}
+
+int32_t Host_Socket_Accept(int32_t Handle, Host_Socket_Address_t *Address, Host_Socket_Error_t *Error)
+{
+   struct sockaddr_storage Host_Address;
+   socklen_t               Length;
+   int32_t                 Ret_Val;
+
+   Length  = sizeof(Host_Address);
+   Ret_Val = Check_Result(accept(Handle, (struct sockaddr *)&Host_Address, &Length), Error);
+
+   if(Ret_Val >= HOST_SOCKET_MAX_HANDLE)
+   {
+      close(Ret_Val);
+
+      *Error  = HOST_SOCKET_ERROR_NO_MEMORY_E;
+      Ret_Val = -1;
+   }
+   else if((Ret_Val >= 0) && (Address != NULL))
+   {
+      From_Host_Address(&Host_Address, Address);
+   }
+
+   return(Ret_Val);
+}
+
+int32_t Host_Socket_Connect(int32_t Handle, const Host_Socket_Address_t *Address, Host_Socket_Error_t *Error)
+{
+   struct sockaddr_storage Host_Address;
+   socklen_t               Length;
+   int32_t                 Ret_Val;
+
+   if((Length = To_Host_Address(Address, &Host_Address)) != 0)
+   {
+      Ret_Val = Check_Result(connect(Handle, (struct sockaddr *)&Host_Address, Length), Error);
+   }
+   else
+   {
+      *Error  = HOST_SOCKET_ERROR_INVALID_E;
+      Ret_Val = -1;
+   }
+
+   return(Ret_Val);
+}
+
+int32_t Host_Socket_Send(int32_t Handle, const void *Buffer, int32_t Length, uint32_t Flags, const Host_Socket_Address_t *Address, Host_Socket_Error_t *Error)
+{
+   struct sockaddr_storage Host_Address;
+   socklen_t               Address_Length;
+   int                     Host_Flags;
+   int32_t                 Ret_Val;
+
+   /* A closed peer is reported as an error rather than with SIGPIPE. */
+   Host_Flags = MSG_NOSIGNAL;
+   if(Flags & HOST_SOCKET_FLAG_DONT_WAIT)
+   {
+      Host_Flags |= MSG_DONTWAIT;
+   }
+
+   if(Address == NULL)
+   {
+      Ret_Val = Check_Result(send(Handle, Buffer, (size_t)Length, Host_Flags), Error);
+   }
+   else if((Address_Length = To_Host_Address(Address, &Host_Address)) != 0)
+   {
+      Ret_Val = Check_Result(sendto(Handle, Buffer, (size_t)Length, Host_Flags, (struct sockaddr *)&Host_Address, Address_Length), Error);
+   }
+   else
+   {
+      *Error  = HOST_SOCKET_ERROR_INVALID_E;
+      Ret_Val = -1;
+   }
+
+   return(Ret_Val);
+}
+
+int32_t Host_Socket_Receive(int32_t Handle, void *Buffer, int32_t Length, uint32_t Flags, Host_Socket_Address_t *Address, Host_Socket_Error_t *Error)
+{
+   struct sockaddr_storage Host_Address;
+   socklen_t               Address_Length;
+   int                     Host_Flags;
+   int32_t                 Ret_Val;
+
+   Host_Flags = 0;
+   if(Flags & HOST_SOCKET_FLAG_DONT_WAIT)
+   {
+      Host_Flags |= MSG_DONTWAIT;
+   }
+
+   if(Flags & HOST_SOCKET_FLAG_PEEK)
+   {
+      Host_Flags |= MSG_PEEK;
+   }
+
+   memset(&Host_Address, 0, sizeof(Host_Address));
+   Address_Length = sizeof(Host_Address);
+
+   Ret_Val = Check_Result(recvfrom(Handle, Buffer, (size_t)Length, Host_Flags, (struct sockaddr *)&Host_Address, &Address_Length), Error);
+
+   if((Ret_Val >= 0) && (Address != NULL))
+   {
+      From_Host_Address(&Host_Address, Address);
+   }
+
+   return(Ret_Val);
+}
+
+int32_t Host_Socket_Set_Option(int32_t Handle, Host_Socket_Option_t Option, int32_t Value, Host_Socket_Error_t *Error)
+{
+   struct timeval Timeout;
+   int            Host_Value;
+   int            Result;
+
+   Host_Value = (int)Value;
+
+   switch(Option)
+   {
+      case HOST_SOCKET_OPTION_REUSE_ADDRESS_E:
+         Result = setsockopt(Handle, SOL_SOCKET, SO_REUSEADDR, &Host_Value, sizeof(Host_Value));
+         break;
+      case HOST_SOCKET_OPTION_KEEP_ALIVE_E:
+         Result = setsockopt(Handle, SOL_SOCKET, SO_KEEPALIVE, &Host_Value, sizeof(Host_Value));
+         break;
+      case HOST_SOCKET_OPTION_SEND_BUFFER_E:
+         Result = setsockopt(Handle, SOL_SOCKET, SO_SNDBUF, &Host_Value, sizeof(Host_Value));
+         break;
+      case HOST_SOCKET_OPTION_RECEIVE_BUFFER_E:
+         Result = setsockopt(Handle, SOL_SOCKET, SO_RCVBUF, &Host_Value, sizeof(Host_Value));
+         break;
+      case HOST_SOCKET_OPTION_SEND_TIMEOUT_E:
+      case HOST_SOCKET_OPTION_RECEIVE_TIMEOUT_E:
+         Timeout.tv_sec  = Value / 1000;
+         Timeout.tv_usec = (Value % 1000) * 1000;
+         Result = setsockopt(Handle, SOL_SOCKET, (Option == HOST_SOCKET_OPTION_SEND_TIMEOUT_E) ? SO_SNDTIMEO : SO_RCVTIMEO, &Timeout, sizeof(Timeout));
+         break;
+      case HOST_SOCKET_OPTION_NON_BLOCKING_E:
+         if((Result = fcntl(Handle, F_GETFL)) >= 0)
+         {
+            Result = fcntl(Handle, F_SETFL, Value ? (Result | O_NONBLOCK) : (Result & ~O_NONBLOCK));
+         }
+         break;
+      default:
+         errno  = ENOPROTOOPT;
+         Result = -1;
+         break;
+   }
+
+   return(Check_Result(Result, Error));
+}
+
+int32_t Host_Socket_Get_Option(int32_t Handle, Host_Socket_Option_t Option, int32_t *Value, Host_Socket_Error_t *Error)
+{
+   socklen_t Length;
+   int       Host_Value;
+   int       Result;
+
+   Host_Value = 0;
+   Length     = sizeof(Host_Value);
+
+   switch(Option)
+   {
+      case HOST_SOCKET_OPTION_SEND_BUFFER_E:
+         Result = getsockopt(Handle, SOL_SOCKET, SO_SNDBUF, &Host_Value, &Length);
+         break;
+      case HOST_SOCKET_OPTION_RECEIVE_BUFFER_E:
+         Result = getsockopt(Handle, SOL_SOCKET, SO_RCVBUF, &Host_Value, &Length);
+         break;
+      case HOST_SOCKET_OPTION_ERROR_E:
+         if((Result = getsockopt(Handle, SOL_SOCKET, SO_ERROR, &Host_Value, &Length)) == 0)
+         {
+            Host_Value = (Host_Value != 0) ? (int)Map_Error(Host_Value) : (int)HOST_SOCKET_ERROR_NONE_E;
+         }
+         break;
+      default:
+         errno  = ENOPROTOOPT;
+         Result = -1;
+         break;
+   }
+
+   if(Result == 0)
+   {
+      *Value = (int32_t)Host_Value;
+   }
+
+   return(Check_Result(Result, Error));
+}
+
+int32_t Host_Socket_Poll(Host_Socket_Poll_t *List, uint32_t Count, int32_t Timeout)
+{
+   struct pollfd Poll_List[HOST_SOCKET_MAX_POLL];
+   uint32_t      Index;
+   int32_t       Ret_Val;
+
+   if(Count <= HOST_SOCKET_MAX_POLL)
+   {
+      for(Index = 0; Index < Count; Index ++)
+      {
+         Poll_List[Index].fd      = List[Index].Handle;
+         Poll_List[Index].events  = ((List[Index].Events & HOST_SOCKET_POLL_READ) ? POLLIN : 0) | ((List[Index].Events & HOST_SOCKET_POLL_WRITE) ? POLLOUT : 0);
+         Poll_List[Index].revents = 0;
+      }
+
+      do
+      {
+         Ret_Val = poll(Poll_List, Count, (Timeout < 0) ? -1 : Timeout);
+      } while((Ret_Val < 0) && (errno == EINTR));
+
+      if(Ret_Val > 0)
+      {
+         Ret_Val = 0;
+
+         for(Index = 0; Index < Count; Index ++)
+         {
+            /* A hang up or error makes the socket readable, as with
+               select(), so that the following receive reports it. */
+            List[Index].Ready = 0;
+            if(Poll_List[Index].revents & (POLLIN | POLLHUP | POLLERR))
+            {
+               List[Index].Ready |= (List[Index].Events & HOST_SOCKET_POLL_READ);
+            }
+
+            if(Poll_List[Index].revents & (POLLOUT | POLLERR))
+            {
+               List[Index].Ready |= (List[Index].Events & HOST_SOCKET_POLL_WRITE);
+            }
+
+            if(Poll_List[Index].revents & (POLLERR | POLLNVAL))
+            {
+               List[Index].Ready |= (List[Index].Events & HOST_SOCKET_POLL_ERROR);
+            }
+
+            if(List[Index].Ready != 0)
+            {
+               Ret_Val ++;
+            }
+         }
+      }
+      else if(Ret_Val == 0)
+      {
+         for(Index = 0; Index < Count; Index ++)
+         {
+            List[Index].Ready = 0;
+         }
+      }
+      else
+      {
+         Ret_Val = -1;
+      }
+   }
+   else
+   {
+      Ret_Val = -1;
+   }
+
+   return(Ret_Val);
+}
+
+/* Numeric lookups are used here because socket_host.c defines inet_pton()
+   and inet_ntop() with the QAPI semantics, which hide the C library ones. */
+int32_t Host_Socket_Parse_Address(uint8_t Family, const char *String, uint8_t *Address)
+{
+   struct addrinfo  Hints;
+   struct addrinfo *Result;
+   int32_t          Ret_Val;
+
+   memset(&Hints, 0, sizeof(Hints));
+   Hints.ai_family = (Family == 4) ? AF_INET : AF_INET6;
+   Hints.ai_flags  = AI_NUMERICHOST;
+
+   Ret_Val = -1;
+
+   if(((Family == 4) || (Family == 6)) && (getaddrinfo(String, NULL, &Hints, &Result) == 0))
+   {
+      if(Result->ai_family == AF_INET)
+      {
+         memcpy(Address, &(((struct sockaddr_in *)Result->ai_addr)->sin_addr), 4);
+         Ret_Val = 0;
+      }
+      else if(Result->ai_family == AF_INET6)
+      {
+         memcpy(Address, &(((struct sockaddr_in6 *)Result->ai_addr)->sin6_addr), 16);
+         Ret_Val = 0;
+      }
+
+      freeaddrinfo(Result);
+   }
+
+   return(Ret_Val);
+}
+
+int32_t Host_Socket_Format_Address(uint8_t Family, const uint8_t *Address, char *String, uint32_t Size)
+{
+   struct sockaddr_storage Host_Address;
+   Host_Socket_Address_t   Socket_Address;
+   socklen_t               Length;
+   int32_t                 Ret_Val;
+
+   Ret_Val = -1;
+
+   if((Family == 4) || (Family == 6))
+   {
+      memset(&Socket_Address, 0, sizeof(Socket_Address));
+      Socket_Address.Family = Family;
+      memcpy(Socket_Address.Address, Address, (Family == 4) ? 4 : 16);
+
+      Length = To_Host_Address(&Socket_Address, &Host_Address);
+
+      if(getnameinfo((struct sockaddr *)&Host_Address, Length, String, Size, NULL, 0, NI_NUMERICHOST) == 0)
+      {
+         Ret_Val = 0;
+      }
+   }
+
+   return(Ret_Val);
+}
@@ -45,6 +45,7 @@
 #include "qapi_tlmm.h"
 #include "qapi_securefs.h"
 #include "qapi_slp.h"
+#include "qapi_ver.h"
 #include "plugins/ftp/ota_ftp.h"
 #include "plugins/http/ota_http.h"
 #include "plugins/zigbee/ota_zigbee.h"
@@ -69,6 +70,7 @@ QCLI_Command_Status_t wlan_device_discovery_simulate_new_device(uint32_t Paramet
 QCLI_Command_Status_t wlan_device_discovery_simulate_smartphone(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 QCLI_Command_Status_t kpi_demo_fw_update(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 QCLI_Command_Status_t kpi_demo_securefs(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+QCLI_Command_Status_t kpi_run(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 QCLI_Group_Handle_t qcli_kpi_handle; /* Handle for kpi demo Command Group. */
 
 extern uint32_t Custom_Platform_Get_32Khz_Ticks(void);
@@ -89,6 +91,7 @@ const QCLI_Command_t kpi_cmd_list[] =
     {kpi_demo_fw_update, true, "kpi_demo_firmware_update", "Usage: plugin_type interface server_address filename param(optional)" , "Command to do fw upgrade time measurement"},
     {kpi_demo_cleanup, true, "kpi_demo_cleanup", "Usage: kpi_demo_cleanup (no options) \n", "Cleanup assigned memory for kpi demo"},
     {kpi_demo_securefs, true, "kpi_securefs", "Usage: kpi_securefs test_type password(optional) \n", "Secure FS KPI tests"},
+    {kpi_run, QCLI_THREAD_LARGE_STACK, "kpi_run", "Usage: kpi_run scenario runs [json|csv] scenario_options \n", "Repeat a KPI test and print min/mean/p95/max per phase"},
     {dummy_cmd_2,false,"dummy",NULL,NULL},
 };
 
@@ -562,21 +565,25 @@ QCLI_Command_Status_t kpi_demo_securefs(uint32_t Parameter_Count, QCLI_Parameter
     if(test_type == KPI_SECUREFS_ALL || test_type == KPI_SECUREFS_CREATE_FILE) {
          QCLI_Printf(qcli_kpi_handle,"Securefs file open time = %d ms \n", 
               ((t2 - t1)*multiplier)/divider);
+         kpi_record_phase("open", ((t2 - t1)*multiplier)/divider);
     }
 
     if(test_type == KPI_SECUREFS_ALL || test_type == KPI_SECUREFS_WRITE_FILE) {
          QCLI_Printf(qcli_kpi_handle,"Securefs time to write input data = %d ms \n", 
               ((t3 - t2)*multiplier)/divider);
+         kpi_record_phase("write", ((t3 - t2)*multiplier)/divider);
     }
 
     if(test_type == KPI_SECUREFS_ALL || test_type == KPI_SECUREFS_READ_FILE) {
          QCLI_Printf(qcli_kpi_handle,"Securefs time to read given data size = %d ms \n",
              ((t4 - t3)*multiplier)/divider);
+         kpi_record_phase("read", ((t4 - t3)*multiplier)/divider);
     }
 
    if(test_type == KPI_SECUREFS_ALL) {
          QCLI_Printf(qcli_kpi_handle,"Total time test = %d ms \n",
              ((t4 - t1)*multiplier)/divider);
+         kpi_record_phase("total", ((t4 - t1)*multiplier)/divider);
    }
 
    if(data != NULL)
@@ -663,6 +670,7 @@ QCLI_Command_Status_t wlan_boot_time(uint32_t Parameter_Count, QCLI_Parameter_t
     time_elapsed = (duration * multiplier)/divider;
 
     QCLI_Printf(qcli_kpi_handle,"Boot Time: time to power up wlan chip %d ms \n", time_elapsed);
+    kpi_record_phase("power_on", time_elapsed);
 
     temp1 = g_boot_time_measure[WLAN_BOOT_KF_POWER_ON_INDEX];
     temp2 = g_boot_time_measure[WLAN_BOOT_KF_FW_DOWNLOAD_INDEX];
@@ -680,6 +688,7 @@ QCLI_Command_Status_t wlan_boot_time(uint32_t Parameter_Count, QCLI_Parameter_t
     time_elapsed = (duration * multiplier)/divider;
 
     QCLI_Printf(qcli_kpi_handle,"Boot Time: time to download wlan firmware %d ms \n", time_elapsed);
+    kpi_record_phase("fw_download", time_elapsed);
 
     temp1 = g_boot_time_measure[WLAN_BOOT_KF_FW_DOWNLOAD_INDEX];
     temp2 = g_boot_time_measure[WLAN_BOOT_KF_WMI_READY_TIME];
@@ -697,6 +706,7 @@ QCLI_Command_Status_t wlan_boot_time(uint32_t Parameter_Count, QCLI_Parameter_t
     time_elapsed = (duration * multiplier)/divider;
 
     QCLI_Printf(qcli_kpi_handle,"Boot Time: time between firmware download & wmi_ready, KF Boot Time %d ms \n", time_elapsed);
+    kpi_record_phase("wmi_ready", time_elapsed);
 
     temp1 = g_boot_time_measure[WLAN_BOOT_KF_INIT_INDEX];
     temp2 = g_boot_time_measure[WLAN_BOOT_KF_WMI_READY_TIME];
@@ -714,6 +724,7 @@ QCLI_Command_Status_t wlan_boot_time(uint32_t Parameter_Count, QCLI_Parameter_t
     time_elapsed = (duration * multiplier)/divider;
 
     QCLI_Printf(qcli_kpi_handle,"Boot Time: Total Boot time %d ms \n", time_elapsed);
+    kpi_record_phase("total", time_elapsed);
 
     if(0 == qapi_WLAN_Enable(QAPI_WLAN_DISABLE_E))
     {
@@ -1122,6 +1133,7 @@ QCLI_Command_Status_t wlan_storerecall_test(uint32_t Parameter_Count, QCLI_Param
     time_elapsed = (duration * multiplier)/divider;
 
     QCLI_Printf(qcli_kpi_handle,"storerecall Time: time to power up wlan chip %d ms \n", time_elapsed);
+    kpi_record_phase("power_on", time_elapsed);
 
     temp1 = g_wlan_strrcl_time_measure[WLAN_STORERECALL_KF_POWER_ON_INDEX];
     temp2 = g_wlan_strrcl_time_measure[WLAN_STORERECALL_KF_FW_DOWNLOAD_INDEX];
@@ -1139,6 +1151,7 @@ QCLI_Command_Status_t wlan_storerecall_test(uint32_t Parameter_Count, QCLI_Param
     time_elapsed = (duration * multiplier)/divider;
 
     QCLI_Printf(qcli_kpi_handle,"storerecall Time: time to download wlan firmware %d ms \n", time_elapsed);
+    kpi_record_phase("fw_download", time_elapsed);
 
     temp1 = g_wlan_strrcl_time_measure[WLAN_STORERECALL_KF_FW_DOWNLOAD_INDEX];
     temp2 = g_wlan_strrcl_time_measure[WLAN_STORERECALL_KF_DONE_TIME];
@@ -1156,6 +1169,7 @@ QCLI_Command_Status_t wlan_storerecall_test(uint32_t Parameter_Count, QCLI_Param
     time_elapsed = (duration * multiplier)/divider;
 
     QCLI_Printf(qcli_kpi_handle,"storerecall Time: time between firmware download & storerecall completion %d ms \n", time_elapsed);
+    kpi_record_phase("recall", time_elapsed);
 
     temp1 = g_wlan_strrcl_time_measure[WLAN_STORERECALL_KF_INIT_INDEX];
     temp2 = g_wlan_strrcl_time_measure[WLAN_STORERECALL_KF_DONE_TIME];
@@ -1173,16 +1187,19 @@ QCLI_Command_Status_t wlan_storerecall_test(uint32_t Parameter_Count, QCLI_Param
     time_elapsed = (duration * multiplier)/divider;
 
     QCLI_Printf(qcli_kpi_handle,"storerecall Time: Total Boot time %d ms \n", time_elapsed);
+    kpi_record_phase("total", time_elapsed);
 
     /* print total breakdown of the time taken */
     if(test_type >= STORERECALL_TEST_CONNECT_TIME) {
          QCLI_Printf(qcli_kpi_handle,"Wlan connect time after storerecall operation  = %d ms \n", 
               ((t2 - t1)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
+         kpi_record_phase("connect", ((t2 - t1)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
     }
 
     if(test_type == STORERECALL_TEST_IP_PACKET) {
          QCLI_Printf(qcli_kpi_handle,"Wlan send IP packet time after storerecall operation = %d ms \n",
              ((t4 - t3)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
+         kpi_record_phase("ip_packet", ((t4 - t3)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
     }
 
 
@@ -1322,12 +1339,16 @@ QCLI_Command_Status_t wlan_connection_time_packet_test(uint32_t Parameter_Count,
         /* print total breakdown of the time taken */
         QCLI_Printf(qcli_kpi_handle,"Setup time = %d ms \n", 
             ((t2 -  t1)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
+        kpi_record_phase("setup", ((t2 -  t1)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
         QCLI_Printf(qcli_kpi_handle,"Server connection time = %d ms \n", 
             ((t3 -  t2)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
+        kpi_record_phase("server_connect", ((t3 -  t2)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
         QCLI_Printf(qcli_kpi_handle,"Time to send out IP packet time = %d ms \n",
             ((t4 -  t3)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
+        kpi_record_phase("ip_packet", ((t4 -  t3)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
         QCLI_Printf(qcli_kpi_handle,"Total time for the test = %d ms \n",
             ((t4 -  t1)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
+        kpi_record_phase("total", ((t4 -  t1)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
 
     }
 
@@ -1457,13 +1478,17 @@ QCLI_Command_Status_t wlan_connection_time_test(uint32_t Parameter_Count, QCLI_P
     /* print total breakdown of the time taken */
     QCLI_Printf(qcli_kpi_handle,"Wlan enable to EAP completion time = %d ms \n", 
             ((t2 -  t1)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
+    kpi_record_phase("eap", ((t2 -  t1)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
     QCLI_Printf(qcli_kpi_handle,"DHCP IP acquire time = %d ms \n", 
             ((t3 -  t2)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
+    kpi_record_phase("dhcp", ((t3 -  t2)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
     /* todo, get the info from driver, reg address will be updated */
     QCLI_Printf(qcli_kpi_handle,"Assocation time = %d ms \n",
             ((kpi_ctx->assoc_time_stamp -  t4)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC))    );
+    kpi_record_phase("assoc", ((kpi_ctx->assoc_time_stamp -  t4)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
     QCLI_Printf(qcli_kpi_handle, "4 Way handshake time = %d ms \n",
             ((t2 - kpi_ctx->assoc_time_stamp)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
+    kpi_record_phase("4way", ((t2 - kpi_ctx->assoc_time_stamp)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
 
 time_test_error:
 
@@ -1738,6 +1763,7 @@ QCLI_Command_Status_t kpi_demo_fw_update(uint32_t Parameter_Count, QCLI_Paramete
     } else {
         QCLI_Printf(qcli_kpi_handle, "Firmware Upgrade Image Download Completed successfully\r\n");
         QCLI_Printf(qcli_kpi_handle, "Total time to upgrade the firwamre = %d ms \r\n", ((t2 - t1)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
+        kpi_record_phase("download", ((t2 - t1)*qurt_timer_convert_ticks_to_time(1, QURT_TIME_MSEC)));
     }
 
     kpi_gpio_release();
@@ -3050,3 +3076,293 @@ ERROR_1:
     return;
 }
 
+/*
+ * Scenarios kpi_run can repeat. Each one is one of the KPI commands
+ * above, which report their timings with kpi_record_phase().
+ * m4_boot_time resets the SoC and suspend time is part of the long
+ * cumulative throughput test, so neither is in the list.
+ */
+typedef struct kpi_scenario
+{
+    const char *name;
+    QCLI_Command_Function_t handler;
+    qbool_t needs_setup;            /* wlan_test_setup has to be run first */
+    const char *options;            /* options passed on to the handler */
+} kpi_scenario_t;
+
+static const kpi_scenario_t kpi_scenarios[] =
+{
+    {"wlan_boot",      wlan_boot_time,                   FALSE, "(no options)"},
+    {"connect",        wlan_connection_time_test,        TRUE,  "security_type"},
+    {"connect_packet", wlan_connection_time_packet_test, TRUE,  "ip_address port security_type ip_type packet_count"},
+    {"storerecall",    wlan_storerecall_test,            TRUE,  "security_type long_test_time test_type port dest_ip"},
+    {"fw_update",      kpi_demo_fw_update,               FALSE, "plugin_type interface server_address filename param"},
+    {"securefs",       kpi_demo_securefs,                FALSE, "test_type password(optional)"},
+};
+
+#define KPI_RUN_SCENARIO_COUNT (sizeof(kpi_scenarios)/sizeof(kpi_scenarios[0]))
+
+/* results of the kpi_run in progress, NULL when no kpi_run is running */
+static kpi_run_results_t *kpi_run_ctx;
+
+/*
+ * kpi_record_phase - Adds the time of one phase of a KPI test to the
+ * results of kpi_run. Does nothing when the test is run on its own.
+ */
+void kpi_record_phase(const char *name, uint32_t time_ms)
+{
+    kpi_run_results_t *res = kpi_run_ctx;
+    kpi_phase_t *phase = NULL;
+    uint32_t i;
+
+    if(res == NULL)
+        return;
+
+    for(i = 0; i < res->phase_count; i++)
+    {
+        if(strcmp(res->phase[i].name, name) == 0)
+        {
+            phase = &res->phase[i];
+            break;
+        }
+    }
+
+    if(phase == NULL)
+    {
+        if(res->phase_count == KPI_RUN_MAX_PHASES)
+            return;
+
+        phase = &res->phase[res->phase_count++];
+        phase->name = name;
+        phase->count = 0;
+    }
+
+    if(phase->count < KPI_RUN_MAX_RUNS)
+        phase->samples[phase->count++] = time_ms;
+
+    res->run_phases++;
+}
+
+/*
+ * kpi_phase_stats - min, mean (in tenths of ms), 95th percentile
+ * (nearest rank) and max of the samples of a phase.
+ */
+static void kpi_phase_stats(const kpi_phase_t *phase, uint32_t *min, uint32_t *mean_x10, uint32_t *p95, uint32_t *max)
+{
+    uint32_t sorted[KPI_RUN_MAX_RUNS];
+    uint32_t i, j, value;
+    uint64_t sum = 0;
+
+    /* insertion sort, there are at most KPI_RUN_MAX_RUNS samples */
+    for(i = 0; i < phase->count; i++)
+    {
+        value = phase->samples[i];
+        for(j = i; (j > 0) && (sorted[j - 1] > value); j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = value;
+        sum += value;
+    }
+
+    *min = sorted[0];
+    *max = sorted[phase->count - 1];
+    *mean_x10 = (uint32_t)((sum * 10 + phase->count / 2) / phase->count);
+    *p95 = sorted[(phase->count * 95 + 99) / 100 - 1];
+}
+
+/*
+ * kpi_run_print_json - Prints the results as a single line starting
+ * with "KPI_JSON ". The line is printed in pieces to stay within the
+ * QCLI print buffer.
+ */
+static void kpi_run_print_json(const kpi_run_results_t *res, const char *firmware)
+{
+    const kpi_phase_t *phase;
+    uint32_t min, mean_x10, p95, max;
+    uint32_t i, j;
+
+    QCLI_Printf(qcli_kpi_handle, "KPI_JSON {\"schema\":\"%s\",\"firmware\":\"%s\",\"build\":\"%s\",\"scenario\":\"%s\",\"runs\":%u,\"failures\":%u,\"phases\":[",
+            KPI_RUN_SCHEMA, firmware, __DATE__ " " __TIME__, res->scenario, res->runs, res->failures);
+
+    for(i = 0; i < res->phase_count; i++)
+    {
+        phase = &res->phase[i];
+        kpi_phase_stats(phase, &min, &mean_x10, &p95, &max);
+
+        QCLI_Printf(qcli_kpi_handle, "%s{\"name\":\"%s\",\"unit\":\"ms\",\"count\":%u,\"min\":%u,\"mean\":%u.%u,\"p95\":%u,\"max\":%u,\"samples\":[",
+                (i == 0) ? "" : ",", phase->name, phase->count, min, mean_x10 / 10, mean_x10 % 10, p95, max);
+
+        for(j = 0; j < phase->count; j++)
+        {
+            QCLI_Printf(qcli_kpi_handle, "%s%u", (j == 0) ? "" : ",", phase->samples[j]);
+        }
+
+        QCLI_Printf(qcli_kpi_handle, "]}");
+    }
+
+    QCLI_Printf(qcli_kpi_handle, "]}\n");
+}
+
+/*
+ * kpi_run_print_csv - Prints the results as a header line and one line
+ * per phase, each starting with "KPI_CSV ".
+ */
+static void kpi_run_print_csv(const kpi_run_results_t *res, const char *firmware)
+{
+    const kpi_phase_t *phase;
+    uint32_t min, mean_x10, p95, max;
+    uint32_t i;
+
+    QCLI_Printf(qcli_kpi_handle, "KPI_CSV schema,firmware,build,scenario,runs,failures,phase,unit,count,min,mean,p95,max\n");
+
+    for(i = 0; i < res->phase_count; i++)
+    {
+        phase = &res->phase[i];
+        kpi_phase_stats(phase, &min, &mean_x10, &p95, &max);
+
+        QCLI_Printf(qcli_kpi_handle, "KPI_CSV %s,%s,%s,%s,%u,%u,%s,ms,%u,%u,%u.%u,%u,%u\n",
+                KPI_RUN_SCHEMA, firmware, __DATE__ " " __TIME__, res->scenario, res->runs, res->failures,
+                phase->name, phase->count, min, mean_x10 / 10, mean_x10 % 10, p95, max);
+    }
+}
+
+static void kpi_run_usage(void)
+{
+    uint32_t i;
+
+    QCLI_Printf(qcli_kpi_handle, "Usage: kpi_run scenario runs [json|csv] scenario_options \n");
+    QCLI_Printf(qcli_kpi_handle, "runs: 1 to %d, results are printed as json by default \n", KPI_RUN_MAX_RUNS);
+    QCLI_Printf(qcli_kpi_handle, "scenarios: \n");
+
+    for(i = 0; i < KPI_RUN_SCENARIO_COUNT; i++)
+    {
+        QCLI_Printf(qcli_kpi_handle, "  %-15s %s \n", kpi_scenarios[i].name, kpi_scenarios[i].options);
+    }
+}
+
+/*
+ * kpi_run - Runs a KPI scenario a number of times and prints the
+ * min/mean/p95/max of each of its phases in a fixed JSON or CSV
+ * format, so that the console logs of two firmware builds can be
+ * compared with tools/kpi/kpi_diff.py.
+ */
+QCLI_Command_Status_t kpi_run(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+    const kpi_scenario_t *scenario = NULL;
+    kpi_run_results_t *res;
+    qapi_FW_Info_t info;
+    char firmware[32];
+    uint32_t runs, i;
+    uint32_t format = KPI_RUN_FORMAT_JSON;
+    uint32_t first_option = 2;
+    QCLI_Command_Status_t status;
+
+    if((Parameter_Count < 2) || (Parameter_List[1].Integer_Is_Valid == 0))
+    {
+        kpi_run_usage();
+        return QCLI_STATUS_USAGE_E;
+    }
+
+    for(i = 0; i < KPI_RUN_SCENARIO_COUNT; i++)
+    {
+        if(strcmp(Parameter_List[0].String_Value, kpi_scenarios[i].name) == 0)
+        {
+            scenario = &kpi_scenarios[i];
+            break;
+        }
+    }
+
+    runs = Parameter_List[1].Integer_Value;
+
+    if((scenario == NULL) || (runs == 0) || (runs > KPI_RUN_MAX_RUNS))
+    {
+        kpi_run_usage();
+        return QCLI_STATUS_USAGE_E;
+    }
+
+    if(Parameter_Count > 2)
+    {
+        if(strcmp(Parameter_List[2].String_Value, "json") == 0)
+        {
+            first_option = 3;
+        }
+        else if(strcmp(Parameter_List[2].String_Value, "csv") == 0)
+        {
+            format = KPI_RUN_FORMAT_CSV;
+            first_option = 3;
+        }
+    }
+
+    if(scenario->needs_setup && (kpi_ctx == NULL))
+    {
+        QCLI_Printf(qcli_kpi_handle, "Please run wlan_test_setup command before running this scenario \n");
+        return QCLI_STATUS_ERROR_E;
+    }
+
+    if(kpi_run_ctx != NULL)
+    {
+        QCLI_Printf(qcli_kpi_handle, "kpi_run is already running \n");
+        return QCLI_STATUS_ERROR_E;
+    }
+
+    res = malloc(sizeof(kpi_run_results_t));
+    if(res == NULL)
+    {
+        QCLI_Printf(qcli_kpi_handle, "Not enough memory for the results \n");
+        return QCLI_STATUS_ERROR_E;
+    }
+
+    memset(res, 0, sizeof(kpi_run_results_t));
+    res->scenario = scenario->name;
+    kpi_run_ctx = res;
+
+    for(i = 0; i < runs; i++)
+    {
+        QCLI_Printf(qcli_kpi_handle, "kpi_run %s: run %d of %d \n", scenario->name, i + 1, runs);
+
+        res->run_phases = 0;
+        status = scenario->handler(Parameter_Count - first_option, &Parameter_List[first_option]);
+        res->runs++;
+
+        if((status != QCLI_STATUS_SUCCESS_E) || (res->run_phases == 0))
+        {
+            res->failures++;
+
+            /* nothing at all was measured, most likely wrong options */
+            if(res->phase_count == 0)
+            {
+                QCLI_Printf(qcli_kpi_handle, "kpi_run %s: no time recorded, check the scenario options \n", scenario->name);
+                kpi_run_ctx = NULL;
+                free(res);
+                return QCLI_STATUS_ERROR_E;
+            }
+        }
+
+        /* let the device settle before the next run */
+        if(i + 1 < runs)
+            qapi_Task_Delay(ONE_SECOND_DELAY);
+    }
+
+    kpi_run_ctx = NULL;
+
+    if(qapi_Get_FW_Info(&info) == QAPI_OK)
+    {
+        snprintf(firmware, sizeof(firmware), "%d.%d.%d-%d",
+                (int)((info.qapi_Version_Number&__QAPI_VERSION_MAJOR_MASK)>>__QAPI_VERSION_MAJOR_SHIFT),
+                (int)((info.qapi_Version_Number&__QAPI_VERSION_MINOR_MASK)>>__QAPI_VERSION_MINOR_SHIFT),
+                (int)((info.qapi_Version_Number&__QAPI_VERSION_NIT_MASK)>>__QAPI_VERSION_NIT_SHIFT),
+                (int)info.crm_Build_Number);
+    }
+    else
+    {
+        strcpy(firmware, "unknown");
+    }
+
+    if(format == KPI_RUN_FORMAT_CSV)
+        kpi_run_print_csv(res, firmware);
+    else
+        kpi_run_print_json(res, firmware);
+
+    free(res);
+
+    return QCLI_STATUS_SUCCESS_E;
+}
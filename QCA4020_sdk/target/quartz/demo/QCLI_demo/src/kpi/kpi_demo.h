@@ -84,6 +84,13 @@
 
 #define KPI_ERROR -1
 
+/* kpi_run limits and result format */
+#define KPI_RUN_MAX_RUNS    50
+#define KPI_RUN_MAX_PHASES  8
+#define KPI_RUN_SCHEMA      "qca402x-kpi/1"
+#define KPI_RUN_FORMAT_JSON 0
+#define KPI_RUN_FORMAT_CSV  1
+
 enum Test_Mode
 {
     TIME_TEST,
@@ -231,6 +238,26 @@ typedef struct kpi_demo_ctx
 
 }kpi_demo_ctx;
 
+/*
+ * samples of one phase of a KPI test, collected by kpi_run
+ */
+typedef struct kpi_phase
+{
+    const char *name;                   /* phase name, a string literal */
+    uint32_t count;                     /* number of samples */
+    uint32_t samples[KPI_RUN_MAX_RUNS]; /* phase time of each run in ms */
+} kpi_phase_t;
+
+typedef struct kpi_run_results
+{
+    const char *scenario;
+    uint32_t runs;
+    uint32_t failures;                  /* runs that failed or reported no time */
+    uint32_t run_phases;                /* phases recorded by the current run */
+    uint32_t phase_count;
+    kpi_phase_t phase[KPI_RUN_MAX_PHASES];
+} kpi_run_results_t;
+
 typedef struct kpi_end_of_test {
     int code;
     int packet_count;
@@ -241,5 +268,6 @@ void kpi_udp_cumulative_tx();
 uint32_t kpi_demo_socket_connect(uint8_t type);
 int32_t kpi_demo_send_packet_test(uint32_t packet_size, uint32_t packet_count);
 int32_t wlan_connect(char *conn_ssid, char *passphrase);
+void kpi_record_phase(const char *name, uint32_t time_ms);
 void Initialize_KPI_Demo(); 
 
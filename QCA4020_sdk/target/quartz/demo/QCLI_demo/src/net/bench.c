@@ -178,6 +178,269 @@ void bench_common_add_pattern(char *p, int len)
     }
 }
 
+/************************************************************************
+ * Throughput over time and per-packet timing.
+ *
+ * The benchmark loops report every packet with bench_common_timeline_update().
+ * The bytes are summed per interval of bench_timeline_interval_ms, counting
+ * from the first packet, so a stall shows up as one or more intervals with
+ * a low or zero rate instead of disappearing in the average.  The gap between
+ * consecutive packets and the change of that gap from one packet to the next
+ * (jitter) go into log2 histograms, as do the endmark/ACK round trips of
+ * send_ack() and bench_common_wait_for_response().
+ *
+ * When the results are printed the timeline is copied to bench_last_timeline
+ * and freed, "benchstats csv" dumps the copy.
+ ************************************************************************/
+uint32_t bench_timeline_interval_ms = BENCH_TIMELINE_INTERVAL_MS;   /* 0 = off */
+static BENCH_TIMELINE bench_last_timeline;
+
+static uint32_t bench_hist_bucket(uint32_t value)
+{
+    uint32_t n = 0;
+
+    while (value && n < BENCH_HIST_BUCKETS - 1)
+    {
+        value >>= 1;
+        n++;
+    }
+
+    return n;
+}
+
+static void bench_hist_add(BENCH_HIST *hist, uint32_t value)
+{
+    hist->count++;
+    hist->sum += value;
+    if (value > hist->max)
+        hist->max = value;
+    hist->bucket[bench_hist_bucket(value)]++;
+}
+
+/* Upper bound, in ms, of the bucket holding the given percentile */
+static uint32_t bench_hist_percentile(const BENCH_HIST *hist, uint32_t percent)
+{
+    uint32_t n, seen = 0;
+    uint32_t target = (uint32_t)(((unsigned long long)hist->count * percent + 99) / 100);
+
+    if (hist->count == 0)
+        return 0;
+
+    for (n = 0; n < BENCH_HIST_BUCKETS - 1; n++)
+    {
+        seen += hist->bucket[n];
+        if (seen >= target)
+            return min((1u << n) - 1, hist->max);
+    }
+
+    return hist->max;
+}
+
+static const char *bench_common_protocol_name(uint32_t protocol)
+{
+    switch (protocol)
+    {
+        case TCP:           return "TCP";
+        case UDP:           return "UDP";
+        case SSL:           return "SSL";
+        case IP_RAW:        return "RAW";
+        case IP_RAW_HDR:    return "RAWH";
+        default:            return "?";
+    }
+}
+
+static uint32_t bench_timeline_now(BENCH_TIMELINE *tl)
+{
+    uint32_t ticks = (uint32_t)qurt_timer_get_ticks() - tl->start_tick;
+
+    return (uint32_t)qurt_timer_convert_ticks_to_time(ticks, QURT_TIME_MSEC);
+}
+
+static void bench_timeline_add_sample(BENCH_TIMELINE *tl, unsigned long long bytes, uint32_t ms)
+{
+    if (bytes == 0)
+        tl->stalls++;
+
+    if (tl->samples_count < BENCH_TIMELINE_MAX_SAMPLES)
+    {
+        /* 1 byte/ms = 8 Kbits/sec */
+        tl->kbps[tl->samples_count++] = (uint32_t)(bytes * 8 / ms);
+        tl->last_sample_ms = ms;
+    }
+    else
+    {
+        tl->samples_dropped++;
+    }
+}
+
+/************************************************************************
+* NAME: bench_common_timeline_start
+*
+* DESCRIPTION: Prepares the timeline of a new test. An existing timeline
+* is reused. Nothing is recorded for iperf tests or if benchstats is off.
+************************************************************************/
+void bench_common_timeline_start(THROUGHPUT_CXT *p_tCxt, STATS *pktStats)
+{
+    if (p_tCxt->is_iperf || bench_timeline_interval_ms == 0)
+    {
+        bench_common_timeline_free(pktStats);
+        return;
+    }
+
+    if (pktStats->timeline == NULL)
+    {
+        pktStats->timeline = (BENCH_TIMELINE *)malloc(sizeof(BENCH_TIMELINE));
+        if (pktStats->timeline == NULL)
+        {
+            QCLI_Printf(qcli_net_handle, "No memory for benchstats\n");
+            return;
+        }
+    }
+
+    memset(pktStats->timeline, 0, sizeof(BENCH_TIMELINE));
+    pktStats->timeline->interval_ms = bench_timeline_interval_ms;
+    pktStats->timeline->protocol    = (uint8_t)p_tCxt->protocol;
+    pktStats->timeline->test_type   = p_tCxt->test_type;
+}
+
+/************************************************************************
+* NAME: bench_common_timeline_update
+*
+* DESCRIPTION: Records a packet of the given size, sent or received now.
+************************************************************************/
+void bench_common_timeline_update(STATS *pktStats, uint32_t bytes)
+{
+    BENCH_TIMELINE *tl = pktStats->timeline;
+    uint32_t now, gap;
+
+    if (tl == NULL)
+        return;
+
+    if (!tl->started)
+    {
+        /* Intervals are counted from the first packet */
+        tl->start_tick     = (uint32_t)qurt_timer_get_ticks();
+        tl->interval_end   = tl->interval_ms;
+        tl->interval_bytes = bytes;
+        tl->started        = 1;
+        return;
+    }
+
+    now = bench_timeline_now(tl);
+
+    /* Close the intervals that ended before this packet, empty ones included */
+    while (now >= tl->interval_end)
+    {
+        bench_timeline_add_sample(tl, tl->interval_bytes, tl->interval_ms);
+        tl->interval_bytes = 0;
+        tl->interval_end  += tl->interval_ms;
+    }
+    tl->interval_bytes += bytes;
+
+    gap = now - tl->last_ms;
+    bench_hist_add(&tl->latency, gap);
+    if (tl->latency.count > 1)
+    {
+        bench_hist_add(&tl->jitter, (gap > tl->last_gap) ? gap - tl->last_gap : tl->last_gap - gap);
+    }
+    tl->last_gap = gap;
+    tl->last_ms  = now;
+}
+
+/************************************************************************
+ ************************************************************************/
+void bench_common_timeline_rtt(STATS *pktStats, uint32_t rtt_ms)
+{
+    if (pktStats->timeline)
+        bench_hist_add(&pktStats->timeline->rtt, rtt_ms);
+}
+
+/************************************************************************
+ ************************************************************************/
+void bench_common_timeline_handshake(STATS *pktStats, uint32_t handshake_ms)
+{
+    if (pktStats->timeline)
+        pktStats->timeline->handshake_ms = handshake_ms;
+}
+
+/************************************************************************
+ ************************************************************************/
+void bench_common_timeline_free(STATS *pktStats)
+{
+    if (pktStats->timeline)
+    {
+        free(pktStats->timeline);
+        pktStats->timeline = NULL;
+    }
+}
+
+static void bench_timeline_print(const BENCH_TIMELINE *tl)
+{
+    uint32_t i, kbps_min = 0, kbps_max = 0;
+    unsigned long long kbps_sum = 0;
+
+    for (i = 0; i < tl->samples_count; i++)
+    {
+        if (i == 0 || tl->kbps[i] < kbps_min)
+            kbps_min = tl->kbps[i];
+        if (tl->kbps[i] > kbps_max)
+            kbps_max = tl->kbps[i];
+        kbps_sum += tl->kbps[i];
+    }
+
+    if (tl->samples_count)
+    {
+        QCLI_Printf(qcli_net_handle, "\tPer %u ms: min %u avg %u max %u Kbits/sec, %u of %u intervals stalled\n",
+                tl->interval_ms, kbps_min, (uint32_t)(kbps_sum / tl->samples_count), kbps_max,
+                tl->stalls, tl->samples_count + tl->samples_dropped);
+    }
+
+    if (tl->latency.count)
+    {
+        QCLI_Printf(qcli_net_handle, "\tPacket gap: p50 %u p99 %u max %u ms, jitter: p50 %u p99 %u max %u ms\n",
+                bench_hist_percentile(&tl->latency, 50), bench_hist_percentile(&tl->latency, 99), tl->latency.max,
+                bench_hist_percentile(&tl->jitter, 50), bench_hist_percentile(&tl->jitter, 99), tl->jitter.max);
+    }
+
+    if (tl->rtt.count)
+    {
+        QCLI_Printf(qcli_net_handle, "\tEndmark/ACK round trip: %u samples, avg %u max %u ms\n",
+                tl->rtt.count, (uint32_t)(tl->rtt.sum / tl->rtt.count), tl->rtt.max);
+    }
+
+    if (tl->handshake_ms)
+    {
+        QCLI_Printf(qcli_net_handle, "\tSSL handshake: %u ms\n", tl->handshake_ms);
+    }
+}
+
+/************************************************************************
+* NAME: bench_common_timeline_finish
+*
+* DESCRIPTION: Closes the last interval at the last packet, prints the
+* summary and keeps a copy of the timeline for "benchstats".
+************************************************************************/
+static void bench_common_timeline_finish(STATS *pktStats)
+{
+    BENCH_TIMELINE *tl = pktStats->timeline;
+    uint32_t partial_ms;
+
+    if (tl == NULL)
+        return;
+
+    if (tl->started)
+    {
+        partial_ms = tl->last_ms - (tl->interval_end - tl->interval_ms);
+        if (partial_ms > 0)
+            bench_timeline_add_sample(tl, tl->interval_bytes, partial_ms);
+
+        bench_timeline_print(tl);
+        memcpy(&bench_last_timeline, tl, sizeof(BENCH_TIMELINE));
+    }
+
+    bench_common_timeline_free(pktStats);
+}
+
 /************************************************************************
 ************************************************************************/
 void bench_common_print_test_results(THROUGHPUT_CXT *p_tCxt, STATS *pktStats)
@@ -250,12 +513,20 @@ void bench_common_print_test_results(THROUGHPUT_CXT *p_tCxt, STATS *pktStats)
         throughput = 0;
     }
 
+    if (p_tCxt->multi)
+    {
+        /* benchmulti prints the results of all its streams together */
+        return;
+    }
+
     QCLI_Printf(qcli_net_handle, "\nResults for %s %s test:\n\n", (p_tCxt->protocol == TCP)? "TCP":((p_tCxt->protocol == UDP)?"UDP": "SSL"),
 	    							(p_tCxt->test_type == RX)?"Receive":"Transmit");
     QCLI_Printf(qcli_net_handle, "\t%llu KBytes %llu bytes (%llu bytes) in %u seconds %u ms (%llu miliseconds)\n",
             total_bytes/1024, total_bytes%1024, total_bytes, sec_interval, (uint32_t)(total_interval%1000), total_interval);
 
     QCLI_Printf(qcli_net_handle, "\n\tThroughput: %u Kbits/sec\n", throughput);
+
+    bench_common_timeline_finish(pktStats);
 }
 
 
@@ -478,6 +749,8 @@ static QCLI_Command_Status_t bench_common_tx(THROUGHPUT_CXT *p_tCxt, uint32_t Pa
 	if (DUMP_IS_TX_ENABLED)
 		p_tCxt->print_buf = 1;
 
+    bench_common_timeline_start(p_tCxt, &p_tCxt->pktStats);
+
     switch(p_tCxt->protocol) {
 	    case TCP:
    		if (bench_common_IsZeroCopy(p_tCxt)) {
@@ -556,6 +829,8 @@ static QCLI_Command_Status_t bench_common_tx(THROUGHPUT_CXT *p_tCxt, uint32_t Pa
 	}
 
 end:
+    bench_common_timeline_free(&p_tCxt->pktStats);
+
     if (e != 0)
     {
         return QCLI_STATUS_ERROR_E;
@@ -918,6 +1193,7 @@ static QCLI_Command_Status_t bench_common_rx(uint32_t v6, uint32_t Parameter_Cou
 
 	end:
 	if (ctxt) {
+		bench_common_timeline_free(&ctxt->pktStats);
 		free(ctxt);
 		ctxt = NULL;
 	}
@@ -1146,6 +1422,7 @@ void send_ack(THROUGHPUT_CXT *p_tCxt, struct sockaddr *faddr, int addrlen)
         {
             int32_t conn_sock;
             fd_set rset;
+            uint32_t ack_time = app_get_time(NULL);
 #ifdef SEND_ACK_DEBUG
             QCLI_Printf(qcli_net_handle, "%d sent ACK\n", retry);
 #endif
@@ -1168,6 +1445,8 @@ void send_ack(THROUGHPUT_CXT *p_tCxt, struct sockaddr *faddr, int addrlen)
 
                 if (received > 0)
                 {
+                    /* The peer answered the ACK, time the exchange */
+                    bench_common_timeline_rtt(&p_tCxt->pktStats, app_get_time(NULL) - ack_time);
                     QCLI_Printf(qcli_net_handle, "ACK success (%u)\n", MAX_ACK_RETRY - retry);
                     break;
                 }
@@ -1488,4 +1767,128 @@ void bench_config_queue_size(int32_t sock)
         qapi_setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &txqueue_size, sizeof(int32_t));
 }
 
+static void bench_timeline_csv_hist(const char *name, const BENCH_HIST *hist)
+{
+    uint32_t n;
+
+    for (n = 0; n < BENCH_HIST_BUCKETS; n++)
+    {
+        if (hist->bucket[n] == 0)
+            continue;
+
+        /* Bucket bounds in ms, the upper one is exclusive and empty for the last bucket */
+        if (n == BENCH_HIST_BUCKETS - 1)
+            QCLI_Printf(qcli_net_handle, "hist,%s,%u,,%u\n", name, 1u << (n - 1), hist->bucket[n]);
+        else
+            QCLI_Printf(qcli_net_handle, "hist,%s,%u,%u,%u\n", name, (n == 0) ? 0 : 1u << (n - 1), 1u << n, hist->bucket[n]);
+    }
+
+    if (hist->count)
+    {
+        QCLI_Printf(qcli_net_handle, "summary,%s_count,,,%u\n", name, hist->count);
+        QCLI_Printf(qcli_net_handle, "summary,%s_avg_ms,,,%u\n", name, (uint32_t)(hist->sum / hist->count));
+        QCLI_Printf(qcli_net_handle, "summary,%s_p99_ms,,,%u\n", name, bench_hist_percentile(hist, 99));
+        QCLI_Printf(qcli_net_handle, "summary,%s_max_ms,,,%u\n", name, hist->max);
+    }
+}
+
+/************************************************************************
+ * Dumps the timeline of the last test as CSV, one record per line:
+ *
+ * record,metric,start_ms,end_ms,value
+ * interval,kbps,<start>,<end>,<Kbits/sec>
+ * hist,<latency|jitter|rtt>,<low>,<high>,<packets>
+ * summary,<name>,,,<value>
+ ************************************************************************/
+static void bench_timeline_csv(const BENCH_TIMELINE *tl)
+{
+    uint32_t i, start;
+
+    QCLI_Printf(qcli_net_handle, "record,metric,start_ms,end_ms,value\n");
+    QCLI_Printf(qcli_net_handle, "summary,test,,,%s %s\n", bench_common_protocol_name(tl->protocol),
+            (tl->test_type == RX) ? "RX" : "TX");
+
+    for (i = 0, start = 0; i < tl->samples_count; i++, start += tl->interval_ms)
+    {
+        QCLI_Printf(qcli_net_handle, "interval,kbps,%u,%u,%u\n", start,
+                start + ((i == tl->samples_count - 1) ? tl->last_sample_ms : tl->interval_ms), tl->kbps[i]);
+    }
+
+    QCLI_Printf(qcli_net_handle, "summary,intervals_stalled,,,%u\n", tl->stalls);
+    QCLI_Printf(qcli_net_handle, "summary,intervals_dropped,,,%u\n", tl->samples_dropped);
+
+    bench_timeline_csv_hist("latency", &tl->latency);
+    bench_timeline_csv_hist("jitter", &tl->jitter);
+    bench_timeline_csv_hist("rtt", &tl->rtt);
+
+    if (tl->handshake_ms)
+    {
+        QCLI_Printf(qcli_net_handle, "summary,handshake_ms,,,%u\n", tl->handshake_ms);
+    }
+}
+
+/************************************************************************
+ *            [0]  [1]
+ * benchstats [on [<interval_ms>] | off | show | csv]
+ ************************************************************************/
+QCLI_Command_Status_t benchstats(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+    if (Parameter_Count == 0)
+    {
+        if (bench_timeline_interval_ms)
+            QCLI_Printf(qcli_net_handle, "benchstats on, %u ms intervals\n", bench_timeline_interval_ms);
+        else
+            QCLI_Printf(qcli_net_handle, "benchstats off\n");
+        return QCLI_STATUS_SUCCESS_E;
+    }
+
+    if (strcasecmp("on", Parameter_List[0].String_Value) == 0)
+    {
+        uint32_t interval_ms = BENCH_TIMELINE_INTERVAL_MS;
+
+        if (Parameter_Count >= 2)
+        {
+            if (!Parameter_List[1].Integer_Is_Valid || Parameter_List[1].Integer_Value < BENCH_TIMELINE_MIN_INTERVAL_MS)
+            {
+                QCLI_Printf(qcli_net_handle, "Interval must be at least %u ms\n", BENCH_TIMELINE_MIN_INTERVAL_MS);
+                return QCLI_STATUS_ERROR_E;
+            }
+            interval_ms = Parameter_List[1].Integer_Value;
+        }
+
+        bench_timeline_interval_ms = interval_ms;
+        QCLI_Printf(qcli_net_handle, "benchstats on, %u ms intervals\n", bench_timeline_interval_ms);
+    }
+    else if (strcasecmp("off", Parameter_List[0].String_Value) == 0)
+    {
+        bench_timeline_interval_ms = 0;
+    }
+    else if (strcasecmp("show", Parameter_List[0].String_Value) == 0 ||
+             strcasecmp("csv", Parameter_List[0].String_Value) == 0)
+    {
+        if (!bench_last_timeline.started)
+        {
+            QCLI_Printf(qcli_net_handle, "No test results\n");
+            return QCLI_STATUS_ERROR_E;
+        }
+
+        if (strcasecmp("csv", Parameter_List[0].String_Value) == 0)
+        {
+            bench_timeline_csv(&bench_last_timeline);
+        }
+        else
+        {
+            QCLI_Printf(qcli_net_handle, "Last %s %s test:\n", bench_common_protocol_name(bench_last_timeline.protocol),
+                    (bench_last_timeline.test_type == RX) ? "Receive" : "Transmit");
+            bench_timeline_print(&bench_last_timeline);
+        }
+    }
+    else
+    {
+        return QCLI_STATUS_USAGE_E;
+    }
+
+    return QCLI_STATUS_SUCCESS_E;
+}
+
 #endif
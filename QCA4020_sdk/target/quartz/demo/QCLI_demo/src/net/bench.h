@@ -125,6 +125,9 @@ typedef struct transmit_params
     uint8_t test_mode;      /* TIME_TEST or PACKET_TEST */
     uint8_t v6;             /* 1 = this is to TX IPv6 packets */
     uint8_t ip_tos;         /* TOS value in IPv4 header */
+    uint8_t rr_mode;        /* Request/response tests: BENCH_RR_TCP_RR, ... */
+    uint8_t rr_depth;       /* Request/response tests: requests in flight */
+    uint16_t rr_resp_size;  /* Request/response tests: response size, packet_size is the request size */
 } TX_PARAMS;
 
 typedef struct receive_params
@@ -141,6 +144,42 @@ typedef struct receive_params
     uint8_t v6;
 } RX_PARAMS;
 
+/************************************************************************
+*    Throughput over time and per-packet timing of a benchmark test.
+*************************************************************************/
+#define BENCH_TIMELINE_INTERVAL_MS      1000    /* Default throughput sampling interval */
+#define BENCH_TIMELINE_MIN_INTERVAL_MS  10
+#define BENCH_TIMELINE_MAX_SAMPLES      240     /* Throughput samples kept per test */
+#define BENCH_HIST_BUCKETS              16      /* Bucket 0 holds 0 ms, bucket n holds [2^(n-1), 2^n) ms */
+
+typedef struct bench_hist {
+    uint32_t count;
+    uint32_t max;
+    unsigned long long sum;
+    uint32_t bucket[BENCH_HIST_BUCKETS];
+} BENCH_HIST;
+
+typedef struct bench_timeline {
+    uint32_t interval_ms;           /* Throughput sampling interval */
+    uint32_t start_tick;            /* Tick of the first packet */
+    uint32_t interval_end;          /* End of the current interval, in ms from the first packet */
+    unsigned long long interval_bytes;  /* Bytes in the current interval */
+    uint32_t last_ms;               /* Time of the previous packet, in ms from the first packet */
+    uint32_t last_gap;              /* Gap before the previous packet, in ms */
+    uint32_t samples_count;
+    uint32_t samples_dropped;       /* Intervals that did not fit in kbps[] */
+    uint32_t stalls;                /* Intervals without any traffic */
+    uint32_t handshake_ms;          /* SSL handshake time, 0 if there was none */
+    uint32_t kbps[BENCH_TIMELINE_MAX_SAMPLES];
+    uint32_t last_sample_ms;        /* Length of the last, possibly partial, interval */
+    BENCH_HIST latency;             /* Time between consecutive packets */
+    BENCH_HIST jitter;              /* Change of that time from one packet to the next */
+    BENCH_HIST rtt;                 /* Endmark/ACK round trips */
+    uint8_t started;
+    uint8_t protocol;
+    uint8_t test_type;
+} BENCH_TIMELINE;
+
 typedef struct stats {
     time_struct_t first_time;       /* Test start time */
     time_struct_t last_time;
@@ -158,6 +197,7 @@ typedef struct stats {
     uint32_t    iperf_time_sec;
     uint32_t    iperf_stream_id;
     uint32_t    iperf_udp_rate;
+    BENCH_TIMELINE *timeline;       /* Throughput samples and histograms, NULL if not recorded */
 } STATS;
 
 /************************************************************************
@@ -184,6 +224,8 @@ typedef struct throughput_cxt
     uint8_t is_iperf:1;
     uint8_t print_buf:1;
     uint8_t echo:1;
+    struct bench_multi_stream *multi;   /* Stream of a benchmulti test, NULL otherwise */
+    struct ssl_inst *ssl_inst;          /* SSL connection of a benchmulti stream, NULL to use SSL_CLIENT_INST */
 } THROUGHPUT_CXT;
 
 typedef struct {
@@ -411,4 +453,54 @@ void bench_tcp_rx_dump_servers();
 QCLI_Command_Status_t bench_common_set_pattern(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 QCLI_Command_Status_t queuecfg(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
 void bench_config_queue_size(int32_t sock);
+void bench_common_timeline_start(THROUGHPUT_CXT *p_tCxt, STATS *pktStats);
+void bench_common_timeline_update(STATS *pktStats, uint32_t bytes);
+void bench_common_timeline_rtt(STATS *pktStats, uint32_t rtt_ms);
+void bench_common_timeline_handshake(STATS *pktStats, uint32_t handshake_ms);
+void bench_common_timeline_free(STATS *pktStats);
+QCLI_Command_Status_t benchstats(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+
+/************************************************************************
+*    Request/response latency tests (TCP_RR, TCP_CRR, UDP_RR).
+*
+*    Every request starts with a BENCH_RR_HDR, in network order, telling
+*    the responder how big the response must be. The response starts with
+*    the same header so that the requester can match it. The Linux peer in
+*    build/tools/net/benchrr uses the same format.
+*************************************************************************/
+#define BENCH_RR_MAGIC              (0x42525231)    /* "BRR1" */
+#define BENCH_RR_MIN_SIZE           ((int)sizeof(BENCH_RR_HDR))
+#define BENCH_RR_MAX_SIZE           (1400)
+#define BENCH_RR_MAX_DEPTH          (16)
+#define BENCH_RR_LATENCY_BINS       (500)           /* 1 ms bins, slower transactions land in the last one */
+#define BENCH_RR_UDP_TIMEOUT_MS     (1000)          /* UDP request is lost when not answered in this time */
+
+typedef struct bench_rr_hdr {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t req_len;       /* Size of this request, header included */
+    uint32_t resp_len;      /* Size of the response asked for, header included */
+} BENCH_RR_HDR;
+
+enum bench_rr_mode {
+    BENCH_RR_TCP_RR,        /* Transactions over one TCP connection */
+    BENCH_RR_TCP_CRR,       /* One TCP connection per transaction */
+    BENCH_RR_UDP_RR,        /* One datagram each way */
+};
+
+QCLI_Command_Status_t benchrr(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+void bench_rr_tx(THROUGHPUT_CXT *p_tCxt);
+void bench_rr_rx(THROUGHPUT_CXT *p_tCxt);
+
+/************************************************************************
+*    Multi-stream tests (benchmulti).
+*
+*    Every stream runs benchtx in its own thread. The streams connect
+*    first and then wait at a barrier, so that they all start sending at
+*    the same time.
+*************************************************************************/
+#define BENCH_MULTI_MAX_STREAMS     (8)
+
+QCLI_Command_Status_t benchmulti(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+void bench_multi_barrier(THROUGHPUT_CXT *p_tCxt);
 #endif /* _BENCH_H_ */
@@ -0,0 +1,492 @@
+/*
+* Copyright (c) 2016 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "qapi_status.h"
+#include "bench.h"
+#include "qapi_delay.h"
+#include "qurt_error.h"
+#include "qurt_thread.h"
+#include "qurt_signal.h"
+#include "qurt_timer.h"
+
+#ifdef CONFIG_NET_TXRX_DEMO
+
+extern QCLI_Group_Handle_t qcli_net_handle; /* Handle for Net Command Group. */
+extern uint8_t benchtx_quit;
+extern uint16_t G_Cmd_Task_Prio;
+
+#define BENCH_MULTI_STACK_SIZE          (3072)
+#define BENCH_MULTI_CONNECT_TIMEOUT_MS  (30000)     /* Streams not connected by then start late */
+#define BENCH_MULTI_STOP_GRACE_MS       (30000)     /* Streams still running this long after the test time are told to quit */
+#define BENCH_MULTI_QUIT_TIMEOUT_MS     (5000)      /* Streams still running this long after being told to quit are left behind */
+#define BENCH_MULTI_CALIBRATE_MS        (500)
+
+/* Signal bits */
+#define BENCH_MULTI_READY(i)            (1 << (i))  /* Stream i is connected, or has failed */
+#define BENCH_MULTI_DONE(i)             (1 << (BENCH_MULTI_MAX_STREAMS + (i)))
+#define BENCH_MULTI_LOOPER_DONE         (0x40000000)
+#define BENCH_MULTI_START               (0x80000000)
+
+struct bench_multi;
+
+typedef struct bench_multi_stream {
+    THROUGHPUT_CXT cxt;
+    struct bench_multi *test;
+    uint32_t index;
+    uint32_t rate_kbps;             /* 0 if the stream is not paced */
+    uint8_t started;
+#ifdef CONFIG_NET_SSL_DEMO
+    SSL_INST ssl;                   /* Own connection on the SSL client context */
+#endif
+} BENCH_MULTI_STREAM;
+
+typedef struct bench_multi {
+    qurt_signal_t signal;
+    uint32_t streams;
+    volatile uint32_t looper_count; /* Incremented by the lowest priority thread while the CPU is otherwise idle */
+    volatile uint8_t looper_run;
+    BENCH_MULTI_STREAM stream[BENCH_MULTI_MAX_STREAMS];
+} BENCH_MULTI;
+
+static int bench_multi_thread_start(const char *name, uint16_t priority, void (*entry)(void *), void *arg)
+{
+    qurt_thread_attr_t attr;
+    qurt_thread_t handle;
+
+    qurt_thread_attr_init(&attr);
+    qurt_thread_attr_set_name(&attr, name);
+    qurt_thread_attr_set_priority(&attr, priority);
+    qurt_thread_attr_set_stack_size(&attr, BENCH_MULTI_STACK_SIZE);
+
+    return qurt_thread_create(&handle, &attr, entry, arg);
+}
+
+/************************************************************************
+* NAME: bench_multi_looper
+*
+* DESCRIPTION: Counts as fast as it can at the lowest priority. The rate
+* drops as the test takes CPU time away, which gives the CPU load of the
+* test without help from the kernel.
+************************************************************************/
+static void bench_multi_looper(void *arg)
+{
+    BENCH_MULTI *test = (BENCH_MULTI *)arg;
+
+    while (test->looper_run)
+    {
+        test->looper_count++;
+    }
+
+    qurt_signal_set(&test->signal, BENCH_MULTI_LOOPER_DONE);
+    qurt_thread_stop();
+}
+
+static void bench_multi_stream_thread(void *arg)
+{
+    BENCH_MULTI_STREAM *stream = (BENCH_MULTI_STREAM *)arg;
+    THROUGHPUT_CXT *p_tCxt = &stream->cxt;
+
+#ifdef CONFIG_NET_SSL_DEMO
+    if (p_tCxt->protocol == SSL && bench_ssl_IsDTLS(SSL_CLIENT_INST))
+        bench_udp_tx(p_tCxt);
+    else
+#endif
+    if (p_tCxt->protocol == UDP)
+        bench_udp_tx(p_tCxt);
+    else
+        bench_tcp_tx(p_tCxt);
+
+    /* READY as well, in case the stream failed before the barrier */
+    qurt_signal_set(&stream->test->signal, BENCH_MULTI_READY(stream->index) | BENCH_MULTI_DONE(stream->index));
+    qurt_thread_stop();
+}
+
+/************************************************************************
+* NAME: bench_multi_barrier
+*
+* DESCRIPTION: Called by a benchmulti stream once it is connected, returns
+* when all streams are connected.
+************************************************************************/
+void bench_multi_barrier(THROUGHPUT_CXT *p_tCxt)
+{
+    BENCH_MULTI_STREAM *stream = p_tCxt->multi;
+
+    qurt_signal_set(&stream->test->signal, BENCH_MULTI_READY(stream->index));
+    qurt_signal_wait(&stream->test->signal, BENCH_MULTI_START, QURT_SIGNAL_ATTR_WAIT_ANY);
+}
+
+static uint32_t bench_multi_wait(BENCH_MULTI *test, uint32_t mask, uint32_t timeout_ms)
+{
+    uint32 signals = 0;
+
+    if (timeout_ms == 0)
+    {
+        return qurt_signal_wait(&test->signal, mask, QURT_SIGNAL_ATTR_WAIT_ALL);
+    }
+
+    qurt_signal_wait_timed(&test->signal, mask, QURT_SIGNAL_ATTR_WAIT_ALL, &signals,
+            qurt_timer_convert_time_to_ticks(timeout_ms, QURT_TIME_MSEC));
+
+    /* On a timeout, tell which of the signals did come */
+    return qurt_signal_get(&test->signal);
+}
+
+static void bench_multi_print_results(BENCH_MULTI *test, uint32_t duration, uint32_t idle_per_ms, uint32_t loops)
+{
+    BENCH_MULTI_STREAM *stream;
+    unsigned long long total_bytes = 0;
+    unsigned long long share, sum = 0, sum_sq = 0;
+    uint32_t i, ms, kbps, paced = 1;
+    uint32_t min_share = ~0, max_share = 0;
+    uint32_t busy, fairness;
+
+    for (i = 0; i < test->streams; i++)
+    {
+        paced &= (test->stream[i].rate_kbps != 0);
+    }
+
+    QCLI_Printf(qcli_net_handle, "\nResults for %u %s Transmit streams:\n\n", test->streams,
+            (test->stream[0].cxt.protocol == TCP) ? "TCP" : ((test->stream[0].cxt.protocol == UDP) ? "UDP" : "SSL"));
+    QCLI_Printf(qcli_net_handle, "\tStream  Port   KBytes      ms      Kbits/sec  Target\n");
+
+    for (i = 0; i < test->streams; i++)
+    {
+        stream = &test->stream[i];
+        ms = app_get_time_difference(&stream->cxt.pktStats.first_time, &stream->cxt.pktStats.last_time);
+        kbps = ms ? (uint32_t)(stream->cxt.pktStats.bytes * 8 / ms) : 0;
+        total_bytes += stream->cxt.pktStats.bytes;
+
+        if (stream->rate_kbps)
+        {
+            QCLI_Printf(qcli_net_handle, "\t%-6u  %-5u  %-10llu  %-6u  %-9u  %u\n", i, stream->cxt.params.tx_params.port,
+                    stream->cxt.pktStats.bytes / 1024, ms, kbps, stream->rate_kbps);
+        }
+        else
+        {
+            QCLI_Printf(qcli_net_handle, "\t%-6u  %-5u  %-10llu  %-6u  %-9u  -\n", i, stream->cxt.params.tx_params.port,
+                    stream->cxt.pktStats.bytes / 1024, ms, kbps);
+        }
+
+        /* Paced streams are compared by how much of their target they reached */
+        share = paced ? (unsigned long long)kbps * 1000 / stream->rate_kbps : kbps;
+        sum += share;
+        sum_sq += share * share;
+        if (share < min_share)
+            min_share = share;
+        if (share > max_share)
+            max_share = share;
+    }
+
+    QCLI_Printf(qcli_net_handle, "\n\tAggregate: %llu KBytes in %u ms, %u Kbits/sec\n", total_bytes / 1024, duration,
+            duration ? (uint32_t)(total_bytes * 8 / duration) : 0);
+
+    /* Jain's index: 1 when all streams get the same share, 1/n when one stream gets everything */
+    if (sum_sq)
+    {
+        fairness = (uint32_t)(sum * sum * 1000 / (test->streams * sum_sq));
+        QCLI_Printf(qcli_net_handle, "\tFairness index: %u.%03u, slowest stream at %u%% of the fastest%s\n",
+                fairness / 1000, fairness % 1000, max_share ? (uint32_t)((unsigned long long)min_share * 100 / max_share) : 0,
+                paced ? " (relative to target)" : "");
+    }
+
+    if (idle_per_ms && duration)
+    {
+        busy = (uint32_t)((unsigned long long)loops * 1000 / ((unsigned long long)idle_per_ms * duration));
+        busy = (busy > 1000) ? 0 : 1000 - busy;
+        QCLI_Printf(qcli_net_handle, "\tCPU busy: %u.%u%%", busy / 10, busy % 10);
+        if (total_bytes)
+        {
+            QCLI_Printf(qcli_net_handle, ", %u ns per byte", (uint32_t)((unsigned long long)busy * duration * 1000 / total_bytes));
+        }
+        QCLI_Printf(qcli_net_handle, "\n");
+    }
+}
+
+static void benchmulti_help(void)
+{
+    QCLI_Printf(qcli_net_handle, "\nbenchmulti <Rx IP> <port> {tcp|tcpzc|udp|udpzc|ssl} <streams> <msg size> <seconds> [<Kbits/sec>[,<Kbits/sec>...]]\n");
+    QCLI_Printf(qcli_net_handle, "    Runs 1 to %d benchtx streams at the same time. They connect first and start sending together.\n", BENCH_MULTI_MAX_STREAMS);
+    QCLI_Printf(qcli_net_handle, "    TCP and TLS streams all go to <port>, UDP and DTLS stream n goes to <port>+n.\n");
+    QCLI_Printf(qcli_net_handle, "    The optional rates pace each stream, the last one is used for the remaining streams.\n");
+    QCLI_Printf(qcli_net_handle, "    Receive them with benchrx on the peer: one TCP benchrx takes the streams of its port as separate\n");
+    QCLI_Printf(qcli_net_handle, "    sessions and reports each, UDP needs a benchrx per port.\n");
+    QCLI_Printf(qcli_net_handle, "    The CPU load is measured by a counter at the lowest priority, calibrated for %u ms before the test.\n", BENCH_MULTI_CALIBRATE_MS);
+    QCLI_Printf(qcli_net_handle, "Examples:\n");
+    QCLI_Printf(qcli_net_handle, "    benchmulti 192.168.1.10 5001 tcp 4 1400 30\n");
+    QCLI_Printf(qcli_net_handle, "    benchmulti 192.168.1.10 5001 udp 3 1000 30 2000,500\n");
+}
+
+/************************************************************************
+ *            [0]           [1]  [2] [3] [4]  [5] [6]
+ * benchmulti 192.168.1.100 5001 tcp 4   1400 30  2000,500
+ ************************************************************************/
+QCLI_Command_Status_t benchmulti(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+    BENCH_MULTI *test;
+    BENCH_MULTI_STREAM *stream;
+    TX_PARAMS tx;
+    const char *protocol;
+    char *rate;
+    uint32_t i, streams, rate_kbps = 0, ready, all, signals, stuck = 0;
+    uint32_t start_ms, duration, loops, idle_per_ms = 0;
+    QCLI_Command_Status_t status = QCLI_STATUS_ERROR_E;
+#ifdef CONFIG_NET_SSL_DEMO
+    SSL_INST *ssl_inst = NULL;
+#endif
+
+    if (Parameter_Count < 6 || Parameter_Count > 7 || Parameter_List == NULL)
+    {
+        benchmulti_help();
+        return QCLI_STATUS_SUCCESS_E;
+    }
+
+    memset(&tx, 0, sizeof(tx));
+
+    if (inet_pton(AF_INET, Parameter_List[0].String_Value, &tx.ip_address) != 0)
+    {
+        char *interface_name;
+
+        if (inet_pton(AF_INET6, Parameter_List[0].String_Value, tx.v6addr) != 0)
+        {
+            QCLI_Printf(qcli_net_handle, "Incorrect address %s\n", Parameter_List[0].String_Value);
+            return QCLI_STATUS_ERROR_E;
+        }
+        tx.v6 = 1;
+
+        if (QAPI_IS_IPV6_LINK_LOCAL(tx.v6addr))
+        {
+            /* if this is a link local address, then the interface must be specified after % */
+            if ((interface_name = bench_common_GetInterfaceNameFromStr(Parameter_List[0].String_Value)) == NULL ||
+                qapi_Net_IPv6_Get_Scope_ID(interface_name, &tx.scope_id) != 0)
+            {
+                return QCLI_STATUS_ERROR_E;
+            }
+        }
+    }
+
+    streams = Parameter_List[3].Integer_Value;
+    if (!Parameter_List[1].Integer_Is_Valid || !Parameter_List[3].Integer_Is_Valid ||
+        streams < 1 || streams > BENCH_MULTI_MAX_STREAMS ||
+        !Parameter_List[4].Integer_Is_Valid || Parameter_List[4].Integer_Value <= 0 ||
+        !Parameter_List[5].Integer_Is_Valid || Parameter_List[5].Integer_Value <= 0)
+    {
+        benchmulti_help();
+        return QCLI_STATUS_ERROR_E;
+    }
+
+    tx.packet_size = Parameter_List[4].Integer_Value;
+    tx.tx_time     = Parameter_List[5].Integer_Value;
+    tx.test_mode   = TIME_TEST;
+    protocol       = Parameter_List[2].String_Value;
+
+    if ((test = (BENCH_MULTI *)malloc(sizeof(BENCH_MULTI))) == NULL)
+    {
+        QCLI_Printf(qcli_net_handle, "No memory\n");
+        return QCLI_STATUS_ERROR_E;
+    }
+    memset(test, 0, sizeof(BENCH_MULTI));
+    test->streams = streams;
+
+    rate = (Parameter_Count > 6) ? Parameter_List[6].String_Value : NULL;
+
+    for (i = 0; i < streams; i++)
+    {
+        stream = &test->stream[i];
+        stream->test  = test;
+        stream->index = i;
+
+        /* Rates are separated by commas, the last one applies to the remaining streams */
+        if (rate)
+        {
+            rate_kbps = strtoul(rate, &rate, 0);
+            rate = (*rate == ',') ? rate + 1 : NULL;
+        }
+        stream->rate_kbps = rate_kbps;
+
+        stream->cxt.params.tx_params = tx;
+        if (bench_common_SetParams(&stream->cxt, tx.v6, protocol, Parameter_List[1].Integer_Value, TX) != 0)
+        {
+            goto end;
+        }
+
+        if (stream->cxt.protocol != TCP && stream->cxt.protocol != UDP
+#ifdef CONFIG_NET_SSL_DEMO
+            && stream->cxt.protocol != SSL
+#endif
+           )
+        {
+            QCLI_Printf(qcli_net_handle, "Invalid protocol: %s\n", protocol);
+            goto end;
+        }
+
+        if (stream->cxt.protocol == UDP
+#ifdef CONFIG_NET_SSL_DEMO
+            || (stream->cxt.protocol == SSL && bench_ssl_IsDTLS(SSL_CLIENT_INST))
+#endif
+           )
+        {
+            /* A UDP receiver tells streams apart by port */
+            stream->cxt.params.tx_params.port += i;
+        }
+
+        stream->cxt.params.tx_params.zerocopy_send = stream->cxt.zc;
+        if (rate_kbps)
+        {
+            stream->cxt.params.tx_params.interval_us = (uint32_t)((unsigned long long)tx.packet_size * 8 * 1000 / rate_kbps);
+        }
+        stream->cxt.multi = stream;
+    }
+
+#ifdef CONFIG_NET_SSL_DEMO
+    if (test->stream[0].cxt.protocol == SSL)
+    {
+        if (*bench_ssl_GetSSLRole(SSL_CLIENT_INST))
+        {
+            QCLI_Printf(qcli_net_handle, "ERROR: busy.\n");
+            goto end;
+        }
+
+        ssl_inst = bench_ssl_GetInstance(SSL_CLIENT_INST);
+        if (ssl_inst->sslCtx == QAPI_NET_SSL_INVALID_HANDLE || ssl_inst->role != QAPI_NET_SSL_CLIENT_E)
+        {
+            QCLI_Printf(qcli_net_handle, "ERROR: SSL client not started (Use 'ssl start client' first).\n");
+            ssl_inst = NULL;
+            goto end;
+        }
+
+        /* Every stream has its own connection on the client context */
+        for (i = 0; i < streams; i++)
+        {
+            test->stream[i].ssl = *ssl_inst;
+            test->stream[i].ssl.ssl = QAPI_NET_SSL_INVALID_HANDLE;
+            test->stream[i].cxt.ssl_inst = &test->stream[i].ssl;
+        }
+        bench_ssl_InitInstance(SSL_CLIENT_INST, QAPI_NET_SSL_CLIENT_E);
+    }
+#endif
+
+    qurt_signal_create(&test->signal);
+    benchtx_quit = 0;
+
+    /* Calibrate the idle count before the streams add any load */
+    test->looper_run = 1;
+    if (bench_multi_thread_start("bench looper", QURT_THREAD_ATTR_PRIORITY_MIN, bench_multi_looper, test) == QURT_EOK)
+    {
+        loops = test->looper_count;
+        qapi_Task_Delay(BENCH_MULTI_CALIBRATE_MS * 1000);
+        idle_per_ms = (test->looper_count - loops) / BENCH_MULTI_CALIBRATE_MS;
+    }
+    else
+    {
+        test->looper_run = 0;
+        qurt_signal_set(&test->signal, BENCH_MULTI_LOOPER_DONE);
+        QCLI_Printf(qcli_net_handle, "CPU load will not be measured\n");
+    }
+
+    QCLI_Printf(qcli_net_handle, "\n**********************************************************\n");
+    QCLI_Printf(qcli_net_handle, "IOT Multi-stream TX Test: %u %s streams\n", streams, protocol);
+    QCLI_Printf(qcli_net_handle, "Remote IP addr: %s\n", Parameter_List[0].String_Value);
+    QCLI_Printf(qcli_net_handle, "Message size: %d, test time: %d seconds\n", tx.packet_size, tx.tx_time);
+    QCLI_Printf(qcli_net_handle, "Type benchquit to cancel\n");
+    QCLI_Printf(qcli_net_handle, "**********************************************************\n");
+
+    ready = all = 0;
+    for (i = 0; i < streams; i++)
+    {
+        ready |= BENCH_MULTI_READY(i);
+        all |= BENCH_MULTI_READY(i) | BENCH_MULTI_DONE(i);
+
+        if (bench_multi_thread_start("bench stream", G_Cmd_Task_Prio, bench_multi_stream_thread, &test->stream[i]) != QURT_EOK)
+        {
+            QCLI_Printf(qcli_net_handle, "Stream %u: thread creation failed\n", i);
+            qurt_signal_set(&test->signal, BENCH_MULTI_READY(i) | BENCH_MULTI_DONE(i));
+        }
+    }
+
+    /* Start barrier: all streams connected, or given up on */
+    signals = bench_multi_wait(test, ready, BENCH_MULTI_CONNECT_TIMEOUT_MS);
+    for (i = 0; i < streams; i++)
+    {
+        if (!(signals & BENCH_MULTI_READY(i)))
+        {
+            QCLI_Printf(qcli_net_handle, "Stream %u is not connected yet, starting without it\n", i);
+        }
+    }
+
+    loops = test->looper_count;
+    start_ms = app_get_time(NULL);
+    qurt_signal_set(&test->signal, BENCH_MULTI_START);
+
+    /* Stop barrier */
+    signals = bench_multi_wait(test, all, tx.tx_time * 1000 + BENCH_MULTI_STOP_GRACE_MS);
+    if ((signals & all) != all)
+    {
+        QCLI_Printf(qcli_net_handle, "Streams did not stop in time, stopping them\n");
+        benchtx_quit = 1;
+        signals = bench_multi_wait(test, all, BENCH_MULTI_QUIT_TIMEOUT_MS);
+    }
+
+    /* A stream blocked in the stack does not see benchtx_quit. It keeps using
+     * the test, which is then left allocated instead of waiting for it forever.
+     */
+    for (i = 0; i < streams; i++)
+    {
+        if (!(signals & BENCH_MULTI_DONE(i)))
+        {
+            QCLI_Printf(qcli_net_handle, "Stream %u did not stop, its results are partial\n", i);
+            stuck = 1;
+        }
+    }
+
+    duration = app_get_time(NULL) - start_ms;
+    loops = test->looper_count - loops;
+
+    test->looper_run = 0;
+    bench_multi_wait(test, BENCH_MULTI_LOOPER_DONE, 0);
+
+    bench_multi_print_results(test, duration, idle_per_ms, loops);
+    QCLI_Printf(qcli_net_handle, BENCH_TEST_COMPLETED);
+
+    if (stuck)
+    {
+        test = NULL;
+        goto end;
+    }
+
+    qurt_signal_delete(&test->signal);
+    status = QCLI_STATUS_SUCCESS_E;
+
+end:
+#ifdef CONFIG_NET_SSL_DEMO
+    if (ssl_inst)
+    {
+        bench_ssl_ResetInstance(SSL_CLIENT_INST);
+    }
+#endif
+    free(test);
+    return status;
+}
+
+#endif
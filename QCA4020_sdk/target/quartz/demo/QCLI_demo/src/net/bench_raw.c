@@ -264,6 +264,7 @@ int bench_raw_tx(THROUGHPUT_CXT *p_tCxt)
             {
                 p_tCxt->pktStats.bytes += send_bytes;
                 ++n_send_ok;
+                bench_common_timeline_update(&p_tCxt->pktStats, send_bytes);
             }
 
             /*Test mode can be "number of packets" or "fixed time duration"*/
@@ -0,0 +1,1002 @@
+/*
+* Copyright (c) 2016 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "qapi_status.h"
+#include "bench.h"
+#include "qapi_delay.h"
+#include "qurt_types.h"
+#include "qurt_timer.h"
+
+#ifdef CONFIG_NET_TXRX_DEMO
+
+extern QCLI_Group_Handle_t qcli_net_handle; /* Handle for Net Command Group. */
+extern uint8_t benchtx_quit;
+extern uint8_t benchrx_quit;
+
+#ifndef min
+#define  min(a,b)    (((a) <= (b)) ? (a) : (b))
+#endif
+
+typedef struct bench_rr_slot {
+    uint32_t seq;
+    uint32_t sent_ms;
+    uint8_t in_use;
+} BENCH_RR_SLOT;
+
+typedef struct bench_rr_stats {
+    uint32_t transactions;
+    uint32_t lost;                  /* UDP requests not answered in BENCH_RR_UDP_TIMEOUT_MS */
+    uint32_t late;                  /* UDP responses to requests already counted as lost */
+    uint32_t errors;
+    uint32_t min_ms;
+    uint32_t max_ms;
+    unsigned long long sum_ms;
+    uint32_t bins[BENCH_RR_LATENCY_BINS];
+} BENCH_RR_STATS;
+
+typedef struct bench_rr_cxt {
+    THROUGHPUT_CXT *p_tCxt;
+    struct sockaddr *to;
+    uint32_t tolen;
+    int family;
+    char *rx_buf;
+    uint32_t next_seq;
+    uint32_t end_ms;                /* Time at which no more requests are sent */
+    BENCH_RR_SLOT slots[BENCH_RR_MAX_DEPTH];
+    BENCH_RR_STATS stats;
+} BENCH_RR_CXT;
+
+static const char *bench_rr_mode_name(uint32_t mode)
+{
+    switch (mode)
+    {
+        case BENCH_RR_TCP_RR:   return "TCP_RR";
+        case BENCH_RR_TCP_CRR:  return "TCP_CRR";
+        case BENCH_RR_UDP_RR:   return "UDP_RR";
+        default:                return "?";
+    }
+}
+
+static uint32_t bench_rr_is_done(BENCH_RR_CXT *cxt)
+{
+    return (benchtx_quit || (int32_t)(app_get_time(NULL) - cxt->end_ms) >= 0);
+}
+
+/************************************************************************
+* NAME: bench_rr_send
+*
+* DESCRIPTION: Sends one request. With zero-copy a new system buffer is
+* sent, the stack frees it; the payload after the header is not looked at
+* by the responder and is left as is.
+************************************************************************/
+static int32_t bench_rr_send(THROUGHPUT_CXT *p_tCxt, int32_t sock, BENCH_RR_HDR *hdr, uint32_t len,
+        struct sockaddr *to, uint32_t tolen)
+{
+    char *buf;
+    int32_t sent;
+    uint32_t netbuf_id = p_tCxt->zc ? QAPI_NETBUF_SYS : QAPI_NETBUF_APP;
+
+    if (p_tCxt->zc)
+    {
+        if ((buf = qapi_Net_Buf_Alloc(len, netbuf_id)) == NULL)
+        {
+            return A_ERROR;
+        }
+    }
+    else
+    {
+        buf = p_tCxt->buffer;
+    }
+
+    qapi_Net_Buf_Update(buf, 0, hdr, sizeof(BENCH_RR_HDR), netbuf_id);
+
+    if (to)
+    {
+        sent = qapi_sendto(sock, buf, len, p_tCxt->zc ? MSG_ZEROCOPYSEND : 0, to, tolen);
+    }
+    else
+    {
+        sent = qapi_send(sock, buf, len, p_tCxt->zc ? MSG_ZEROCOPYSEND : 0);
+    }
+
+    if (sent != (int32_t)len)
+    {
+        return A_ERROR;
+    }
+
+    p_tCxt->pktStats.sent_bytes += len;
+    return QAPI_OK;
+}
+
+static int32_t bench_rr_send_request(BENCH_RR_CXT *cxt, int32_t sock, uint32_t seq)
+{
+    BENCH_RR_HDR hdr;
+
+    hdr.magic    = htonl(BENCH_RR_MAGIC);
+    hdr.seq      = htonl(seq);
+    hdr.req_len  = htonl(cxt->p_tCxt->params.tx_params.packet_size);
+    hdr.resp_len = htonl(cxt->p_tCxt->params.tx_params.rr_resp_size);
+
+    return bench_rr_send(cxt->p_tCxt, sock, &hdr, cxt->p_tCxt->params.tx_params.packet_size, NULL, 0);
+}
+
+static void bench_rr_complete(BENCH_RR_CXT *cxt, uint32_t sent_ms)
+{
+    BENCH_RR_STATS *s = &cxt->stats;
+    uint32_t latency = app_get_time(NULL) - sent_ms;
+
+    if (s->transactions == 0 || latency < s->min_ms)
+        s->min_ms = latency;
+    if (latency > s->max_ms)
+        s->max_ms = latency;
+    s->sum_ms += latency;
+    s->bins[min(latency, BENCH_RR_LATENCY_BINS - 1)]++;
+    s->transactions++;
+
+    cxt->p_tCxt->pktStats.bytes += cxt->p_tCxt->params.tx_params.rr_resp_size;
+    cxt->p_tCxt->pktStats.pkts_recvd++;
+}
+
+/************************************************************************
+* NAME: bench_rr_tcp_recv_response
+*
+* DESCRIPTION: Reads one whole response from a TCP connection and returns
+* the sequence number it carries in *seq.
+************************************************************************/
+static int32_t bench_rr_tcp_recv_response(BENCH_RR_CXT *cxt, int32_t sock, uint32_t *seq)
+{
+    uint32_t want = cxt->p_tCxt->params.tx_params.rr_resp_size;
+    uint32_t have = 0;
+    int32_t received;
+    BENCH_RR_HDR *hdr = (BENCH_RR_HDR *)cxt->rx_buf;
+
+    while (have < want)
+    {
+        fd_set rset;
+
+        qapi_fd_zero(&rset);
+        qapi_fd_set(sock, &rset);
+        if (qapi_select(&rset, NULL, NULL, 500) <= 0)
+        {
+            if (benchtx_quit)
+            {
+                return A_ERROR;
+            }
+
+            if ((int32_t)(app_get_time(NULL) - cxt->end_ms) >= BENCH_RR_UDP_TIMEOUT_MS)
+            {
+                QCLI_Printf(qcli_net_handle, "No response from peer\n");
+                return A_ERROR;
+            }
+            continue;
+        }
+
+        received = qapi_recv(sock, cxt->rx_buf + have, want - have, 0);
+        if (received <= 0)
+        {
+            QCLI_Printf(qcli_net_handle, "Connection closed by peer\n");
+            return A_ERROR;
+        }
+        have += received;
+    }
+
+    if (ntohl(hdr->magic) != BENCH_RR_MAGIC)
+    {
+        QCLI_Printf(qcli_net_handle, "Bad response from peer\n");
+        return A_ERROR;
+    }
+
+    *seq = ntohl(hdr->seq);
+    return QAPI_OK;
+}
+
+static int32_t bench_rr_tcp_connect(BENCH_RR_CXT *cxt)
+{
+    int32_t sock;
+
+    if ((sock = qapi_socket(cxt->family, SOCK_STREAM, 0)) == A_ERROR)
+    {
+        QCLI_Printf(qcli_net_handle, "ERROR: Unable to create socket\n");
+        return A_ERROR;
+    }
+
+    bench_config_queue_size(sock);
+
+    if (qapi_connect(sock, cxt->to, cxt->tolen) == A_ERROR)
+    {
+        QCLI_Printf(qcli_net_handle, "Connection failed.\n");
+        qapi_socketclose(sock);
+        return A_ERROR;
+    }
+
+    return sock;
+}
+
+/************************************************************************
+* NAME: bench_rr_tcp_rr
+*
+* DESCRIPTION: TCP_RR, transactions over one connection with up to
+* rr_depth requests in flight. Responses come back in order.
+************************************************************************/
+static void bench_rr_tcp_rr(BENCH_RR_CXT *cxt)
+{
+    uint32_t depth = cxt->p_tCxt->params.tx_params.rr_depth;
+    uint32_t outstanding = 0;
+    uint32_t seq, expected;
+    int32_t sock;
+    BENCH_RR_SLOT *slot;
+
+    if ((sock = bench_rr_tcp_connect(cxt)) == A_ERROR)
+    {
+        cxt->stats.errors++;
+        return;
+    }
+
+    while (1)
+    {
+        /* Keep the pipe full until the test time is over, then drain it */
+        while (outstanding < depth && !bench_rr_is_done(cxt))
+        {
+            slot = &cxt->slots[cxt->next_seq % depth];
+            slot->seq     = cxt->next_seq;
+            slot->sent_ms = app_get_time(NULL);
+
+            if (bench_rr_send_request(cxt, sock, cxt->next_seq) != QAPI_OK)
+            {
+                QCLI_Printf(qcli_net_handle, "Send failed, errno=%d\n", qapi_errno(sock));
+                cxt->stats.errors++;
+                goto tcp_rr_DONE;
+            }
+            cxt->next_seq++;
+            outstanding++;
+        }
+
+        if (outstanding == 0)
+        {
+            break;
+        }
+
+        if (bench_rr_tcp_recv_response(cxt, sock, &seq) != QAPI_OK)
+        {
+            cxt->stats.errors++;
+            break;
+        }
+
+        expected = cxt->next_seq - outstanding;
+        if (seq != expected)
+        {
+            QCLI_Printf(qcli_net_handle, "Response %u out of order, expected %u\n", seq, expected);
+            cxt->stats.errors++;
+            break;
+        }
+
+        bench_rr_complete(cxt, cxt->slots[expected % depth].sent_ms);
+        outstanding--;
+    }
+
+tcp_rr_DONE:
+    qapi_socketclose(sock);
+}
+
+/************************************************************************
+* NAME: bench_rr_tcp_crr
+*
+* DESCRIPTION: TCP_CRR, connect, one transaction and close. The latency
+* includes the connection setup. There is always one transaction in flight.
+************************************************************************/
+static void bench_rr_tcp_crr(BENCH_RR_CXT *cxt)
+{
+    uint32_t start_ms, seq;
+    int32_t sock;
+
+    while (!bench_rr_is_done(cxt))
+    {
+        start_ms = app_get_time(NULL);
+
+        if ((sock = bench_rr_tcp_connect(cxt)) == A_ERROR)
+        {
+            cxt->stats.errors++;
+            break;
+        }
+
+        if (bench_rr_send_request(cxt, sock, cxt->next_seq) != QAPI_OK ||
+            bench_rr_tcp_recv_response(cxt, sock, &seq) != QAPI_OK ||
+            seq != cxt->next_seq)
+        {
+            cxt->stats.errors++;
+            qapi_socketclose(sock);
+            break;
+        }
+
+        bench_rr_complete(cxt, start_ms);
+        cxt->next_seq++;
+        qapi_socketclose(sock);
+    }
+}
+
+/************************************************************************
+* NAME: bench_rr_udp_rr
+*
+* DESCRIPTION: UDP_RR, up to rr_depth requests in flight. A request that
+* is not answered in BENCH_RR_UDP_TIMEOUT_MS is counted as lost and its
+* slot is reused for a new one.
+************************************************************************/
+static void bench_rr_udp_rr(BENCH_RR_CXT *cxt)
+{
+    uint32_t depth = cxt->p_tCxt->params.tx_params.rr_depth;
+    uint32_t outstanding = 0;
+    uint32_t i, seq, now;
+    int32_t sock, received;
+    BENCH_RR_HDR *hdr = (BENCH_RR_HDR *)cxt->rx_buf;
+    fd_set rset;
+
+    if ((sock = qapi_socket(cxt->family, SOCK_DGRAM, 0)) == A_ERROR)
+    {
+        QCLI_Printf(qcli_net_handle, "ERROR: Unable to create socket\n");
+        cxt->stats.errors++;
+        return;
+    }
+
+    bench_config_queue_size(sock);
+
+    if (qapi_connect(sock, cxt->to, cxt->tolen) == A_ERROR)
+    {
+        QCLI_Printf(qcli_net_handle, "ERROR: Conection failed\n");
+        cxt->stats.errors++;
+        goto udp_rr_DONE;
+    }
+
+    while (1)
+    {
+        for (i = 0; i < depth && !bench_rr_is_done(cxt); i++)
+        {
+            if (cxt->slots[i].in_use)
+                continue;
+
+            cxt->slots[i].seq     = cxt->next_seq;
+            cxt->slots[i].sent_ms = app_get_time(NULL);
+
+            if (bench_rr_send_request(cxt, sock, cxt->next_seq) != QAPI_OK)
+            {
+                /* Out of buffers, try again on the next round */
+                break;
+            }
+            cxt->slots[i].in_use = 1;
+            cxt->next_seq++;
+            outstanding++;
+        }
+
+        if (outstanding == 0)
+        {
+            if (bench_rr_is_done(cxt))
+                break;
+            qapi_Task_Delay(1000);
+            continue;
+        }
+
+        qapi_fd_zero(&rset);
+        qapi_fd_set(sock, &rset);
+        if (qapi_select(&rset, NULL, NULL, 10) > 0)
+        {
+            received = qapi_recv(sock, cxt->rx_buf, BENCH_RR_MAX_SIZE, 0);
+            if (received >= BENCH_RR_MIN_SIZE && ntohl(hdr->magic) == BENCH_RR_MAGIC)
+            {
+                seq = ntohl(hdr->seq);
+                for (i = 0; i < depth; i++)
+                {
+                    if (cxt->slots[i].in_use && cxt->slots[i].seq == seq)
+                        break;
+                }
+
+                if (i < depth)
+                {
+                    bench_rr_complete(cxt, cxt->slots[i].sent_ms);
+                    cxt->slots[i].in_use = 0;
+                    outstanding--;
+                }
+                else
+                {
+                    cxt->stats.late++;
+                }
+            }
+        }
+
+        now = app_get_time(NULL);
+        for (i = 0; i < depth; i++)
+        {
+            if (cxt->slots[i].in_use && now - cxt->slots[i].sent_ms >= BENCH_RR_UDP_TIMEOUT_MS)
+            {
+                cxt->slots[i].in_use = 0;
+                cxt->stats.lost++;
+                outstanding--;
+            }
+        }
+    }
+
+udp_rr_DONE:
+    qapi_socketclose(sock);
+}
+
+/* Latency, in ms, below which the given share (in 1/1000) of the transactions completed */
+static uint32_t bench_rr_percentile(BENCH_RR_STATS *s, uint32_t per_mille)
+{
+    uint32_t n, seen = 0;
+    uint32_t target = (uint32_t)(((unsigned long long)s->transactions * per_mille + 999) / 1000);
+
+    for (n = 0; n < BENCH_RR_LATENCY_BINS; n++)
+    {
+        seen += s->bins[n];
+        if (seen >= target)
+            return (n == BENCH_RR_LATENCY_BINS - 1) ? s->max_ms : n;
+    }
+
+    return s->max_ms;
+}
+
+static void bench_rr_print_results(BENCH_RR_CXT *cxt)
+{
+    THROUGHPUT_CXT *p_tCxt = cxt->p_tCxt;
+    BENCH_RR_STATS *s = &cxt->stats;
+    uint32_t duration = app_get_time_difference(&p_tCxt->pktStats.first_time, &p_tCxt->pktStats.last_time);
+    uint32_t tps_x10 = duration ? (uint32_t)((unsigned long long)s->transactions * 10000 / duration) : 0;
+
+    QCLI_Printf(qcli_net_handle, "\nResults for %s test:\n\n", bench_rr_mode_name(p_tCxt->params.tx_params.rr_mode));
+    QCLI_Printf(qcli_net_handle, "\tRequest %u bytes, response %u bytes, %u in flight\n",
+            p_tCxt->params.tx_params.packet_size, p_tCxt->params.tx_params.rr_resp_size, p_tCxt->params.tx_params.rr_depth);
+    QCLI_Printf(qcli_net_handle, "\t%u transactions in %u seconds %u ms (%u lost, %u late, %u errors)\n",
+            s->transactions, duration / 1000, duration % 1000, s->lost, s->late, s->errors);
+    QCLI_Printf(qcli_net_handle, "\n\tTransactions/sec: %u.%u\n", tps_x10 / 10, tps_x10 % 10);
+
+    if (s->transactions)
+    {
+        QCLI_Printf(qcli_net_handle, "\tLatency: min %u avg %u p50 %u p90 %u p99 %u p99.9 %u max %u ms\n",
+                s->min_ms, (uint32_t)(s->sum_ms / s->transactions),
+                bench_rr_percentile(s, 500), bench_rr_percentile(s, 900),
+                bench_rr_percentile(s, 990), bench_rr_percentile(s, 999), s->max_ms);
+    }
+}
+
+/************************************************************************
+* NAME: bench_rr_tx
+*
+* DESCRIPTION: Runs a request/response test against a responder: the
+* Linux benchrr_peer or another board running "benchrr -s".
+************************************************************************/
+void bench_rr_tx(THROUGHPUT_CXT *p_tCxt)
+{
+    struct sockaddr_in foreign_addr;
+    struct sockaddr_in6 foreign_addr6;
+    char ip_str[48];
+    BENCH_RR_CXT *cxt;
+
+    memset(ip_str, 0, sizeof(ip_str));
+
+    if ((cxt = (BENCH_RR_CXT *)malloc(sizeof(BENCH_RR_CXT))) == NULL)
+    {
+        QCLI_Printf(qcli_net_handle, "No memory\n");
+        return;
+    }
+    memset(cxt, 0, sizeof(BENCH_RR_CXT));
+    cxt->p_tCxt = p_tCxt;
+
+    if (p_tCxt->params.tx_params.v6)
+    {
+        cxt->family = AF_INET6;
+        inet_ntop(cxt->family, &p_tCxt->params.tx_params.v6addr[0], ip_str, sizeof(ip_str));
+
+        memset(&foreign_addr6, 0, sizeof(foreign_addr6));
+        memcpy(&foreign_addr6.sin_addr, p_tCxt->params.tx_params.v6addr, sizeof(foreign_addr6.sin_addr));
+        foreign_addr6.sin_port     = htons(p_tCxt->params.tx_params.port);
+        foreign_addr6.sin_family   = cxt->family;
+        foreign_addr6.sin_scope_id = p_tCxt->params.tx_params.scope_id;
+
+        cxt->to = (struct sockaddr *)&foreign_addr6;
+        cxt->tolen = sizeof(foreign_addr6);
+    }
+    else
+    {
+        cxt->family = AF_INET;
+        inet_ntop(cxt->family, &p_tCxt->params.tx_params.ip_address, ip_str, sizeof(ip_str));
+
+        memset(&foreign_addr, 0, sizeof(foreign_addr));
+        foreign_addr.sin_addr.s_addr    = p_tCxt->params.tx_params.ip_address;
+        foreign_addr.sin_port           = htons(p_tCxt->params.tx_params.port);
+        foreign_addr.sin_family         = cxt->family;
+
+        cxt->to = (struct sockaddr *)&foreign_addr;
+        cxt->tolen = sizeof(foreign_addr);
+    }
+
+    QCLI_Printf(qcli_net_handle, "\n**********************************************************\n");
+    QCLI_Printf(qcli_net_handle, "IOT %s Test\n", bench_rr_mode_name(p_tCxt->params.tx_params.rr_mode));
+    QCLI_Printf(qcli_net_handle, "**********************************************************\n");
+    QCLI_Printf(qcli_net_handle, "Remote IP addr: %s\n", ip_str);
+    QCLI_Printf(qcli_net_handle, "Remote port: %d\n", p_tCxt->params.tx_params.port);
+    QCLI_Printf(qcli_net_handle, "Request/response size: %d/%u\n", p_tCxt->params.tx_params.packet_size, p_tCxt->params.tx_params.rr_resp_size);
+    QCLI_Printf(qcli_net_handle, "Requests in flight: %u\n", p_tCxt->params.tx_params.rr_depth);
+    QCLI_Printf(qcli_net_handle, "Test time: %d seconds\n", p_tCxt->params.tx_params.tx_time);
+    QCLI_Printf(qcli_net_handle, "Zerocopy send: %s\n", p_tCxt->zc ? "Yes" : "No");
+    QCLI_Printf(qcli_net_handle, "Type benchquit to cancel\n");
+    QCLI_Printf(qcli_net_handle, "**********************************************************\n");
+
+    if ((cxt->rx_buf = qapi_Net_Buf_Alloc(BENCH_RR_MAX_SIZE, QAPI_NETBUF_APP)) == NULL)
+    {
+        QCLI_Printf(qcli_net_handle, "ERROR: buffer allocation failed\n");
+        goto ERROR_1;
+    }
+
+    if (!p_tCxt->zc)
+    {
+        if ((p_tCxt->buffer = qapi_Net_Buf_Alloc(BENCH_RR_MAX_SIZE, QAPI_NETBUF_APP)) == NULL)
+        {
+            QCLI_Printf(qcli_net_handle, "ERROR: buffer allocation failed\n");
+            goto ERROR_1;
+        }
+        bench_common_add_pattern(p_tCxt->buffer, p_tCxt->params.tx_params.packet_size);
+    }
+
+    bench_common_clear_stats(p_tCxt);
+    app_get_time(&p_tCxt->pktStats.first_time);
+    cxt->end_ms = app_get_time(NULL) + p_tCxt->params.tx_params.tx_time * 1000;
+
+    switch (p_tCxt->params.tx_params.rr_mode)
+    {
+        case BENCH_RR_TCP_RR:
+            bench_rr_tcp_rr(cxt);
+            break;
+        case BENCH_RR_TCP_CRR:
+            bench_rr_tcp_crr(cxt);
+            break;
+        case BENCH_RR_UDP_RR:
+            bench_rr_udp_rr(cxt);
+            break;
+    }
+
+    app_get_time(&p_tCxt->pktStats.last_time);
+    bench_rr_print_results(cxt);
+
+ERROR_1:
+    if (p_tCxt->buffer)
+    {
+        qapi_Net_Buf_Free(p_tCxt->buffer, QAPI_NETBUF_APP);
+        p_tCxt->buffer = NULL;
+    }
+
+    if (cxt->rx_buf)
+    {
+        qapi_Net_Buf_Free(cxt->rx_buf, QAPI_NETBUF_APP);
+    }
+
+    free(cxt);
+
+    QCLI_Printf(qcli_net_handle, BENCH_TEST_COMPLETED);
+}
+
+/************************************************************************
+* NAME: bench_rr_respond
+*
+* DESCRIPTION: Answers a request with a response of the size it asks for.
+* Returns A_ERROR if the request is not a valid RR request.
+************************************************************************/
+static int32_t bench_rr_respond(THROUGHPUT_CXT *p_tCxt, int32_t sock, BENCH_RR_HDR *req,
+        struct sockaddr *to, uint32_t tolen)
+{
+    BENCH_RR_HDR hdr;
+    uint32_t resp_len = ntohl(req->resp_len);
+
+    if (ntohl(req->magic) != BENCH_RR_MAGIC || resp_len < BENCH_RR_MIN_SIZE || resp_len > BENCH_RR_MAX_SIZE)
+    {
+        return A_ERROR;
+    }
+
+    hdr.magic    = req->magic;
+    hdr.seq      = req->seq;
+    hdr.req_len  = req->req_len;
+    hdr.resp_len = req->resp_len;
+
+    ++p_tCxt->pktStats.pkts_recvd;
+    if (bench_rr_send(p_tCxt, sock, &hdr, resp_len, to, tolen) != QAPI_OK)
+    {
+        return A_ERROR;
+    }
+
+    return QAPI_OK;
+}
+
+/* Waits up to 500 ms for the socket to be readable. Returns 0 on timeout. */
+static int32_t bench_rr_wait_readable(int32_t sock)
+{
+    fd_set rset;
+
+    qapi_fd_zero(&rset);
+    qapi_fd_set(sock, &rset);
+    return qapi_select(&rset, NULL, NULL, 500);
+}
+
+/* Reads exactly len bytes from a TCP connection. */
+static int32_t bench_rr_tcp_read(int32_t sock, char *buf, uint32_t len)
+{
+    uint32_t have = 0;
+    int32_t received;
+
+    while (have < len)
+    {
+        if (benchrx_quit)
+        {
+            return A_ERROR;
+        }
+
+        if (bench_rr_wait_readable(sock) <= 0)
+        {
+            continue;
+        }
+
+        received = qapi_recv(sock, buf + have, len - have, 0);
+        if (received <= 0)
+        {
+            return A_ERROR;
+        }
+        have += received;
+    }
+
+    return QAPI_OK;
+}
+
+/************************************************************************
+* NAME: bench_rr_rx
+*
+* DESCRIPTION: Responder for request/response tests, so that the Linux
+* benchrr_peer can measure the board, the same way iperf -r turns the
+* board around for iperf3. TCP connections are served one at a time,
+* which is all TCP_RR and TCP_CRR need.
+************************************************************************/
+void bench_rr_rx(THROUGHPUT_CXT *p_tCxt)
+{
+    struct sockaddr_in local_addr;
+    struct sockaddr_in6 local_addr6;
+    struct sockaddr *addr;
+    uint32_t addrlen;
+    struct sockaddr_in6 from_addr;
+    struct sockaddr *from = (struct sockaddr *)&from_addr;
+    int32_t fromlen;
+    int family = p_tCxt->params.rx_params.v6 ? AF_INET6 : AF_INET;
+    int type = (p_tCxt->protocol == UDP) ? SOCK_DGRAM : SOCK_STREAM;
+    BENCH_RR_HDR *req;
+    uint32_t req_len, connections = 0;
+    int32_t received;
+
+    if (family == AF_INET6)
+    {
+        memset(&local_addr6, 0, sizeof(local_addr6));
+        local_addr6.sin_port = htons(p_tCxt->params.rx_params.port);
+        local_addr6.sin_family = family;
+        addr = (struct sockaddr *)&local_addr6;
+        addrlen = sizeof(struct sockaddr_in6);
+    }
+    else
+    {
+        memset(&local_addr, 0, sizeof(local_addr));
+        local_addr.sin_port = htons(p_tCxt->params.rx_params.port);
+        local_addr.sin_family = family;
+        addr = (struct sockaddr *)&local_addr;
+        addrlen = sizeof(struct sockaddr_in);
+    }
+
+    if ((p_tCxt->buffer = qapi_Net_Buf_Alloc(BENCH_RR_MAX_SIZE, QAPI_NETBUF_APP)) == NULL)
+    {
+        QCLI_Printf(qcli_net_handle, "ERROR: buffer allocation failed\n");
+        goto ERROR_1;
+    }
+    req = (BENCH_RR_HDR *)p_tCxt->buffer;
+
+    if ((p_tCxt->sock_local = qapi_socket(family, type, 0)) == A_ERROR)
+    {
+        QCLI_Printf(qcli_net_handle, "ERROR: Socket creation error.\n");
+        goto ERROR_1;
+    }
+
+    if (qapi_bind(p_tCxt->sock_local, addr, addrlen) != QAPI_OK)
+    {
+        QCLI_Printf(qcli_net_handle, "ERROR: Socket bind error.\n");
+        goto ERROR_2;
+    }
+
+    if (type == SOCK_STREAM && qapi_listen(p_tCxt->sock_local, 1) < 0)
+    {
+        QCLI_Printf(qcli_net_handle, "ERROR: Socket listen error.\n");
+        goto ERROR_2;
+    }
+
+    bench_config_queue_size(p_tCxt->sock_local);
+    bench_common_clear_stats(p_tCxt);
+
+    QCLI_Printf(qcli_net_handle, "\n****************************************************\n");
+    QCLI_Printf(qcli_net_handle, " %s request/response responder (IPv%d)\n", (type == SOCK_DGRAM) ? "UDP" : "TCP",
+            (family == AF_INET6) ? 6 : 4);
+    QCLI_Printf(qcli_net_handle, " Local port %d, zerocopy send: %s\n", p_tCxt->params.rx_params.port, p_tCxt->zc ? "Yes" : "No");
+    QCLI_Printf(qcli_net_handle, " Type benchquit to terminate test\n");
+    QCLI_Printf(qcli_net_handle, "****************************************************\n");
+
+    while (!benchrx_quit)
+    {
+        if (bench_rr_wait_readable(p_tCxt->sock_local) <= 0)
+        {
+            continue;
+        }
+
+        fromlen = sizeof(from_addr);
+
+        if (type == SOCK_DGRAM)
+        {
+            received = qapi_recvfrom(p_tCxt->sock_local, p_tCxt->buffer, BENCH_RR_MAX_SIZE, 0, from, &fromlen);
+            if (received >= BENCH_RR_MIN_SIZE)
+            {
+                p_tCxt->pktStats.bytes += received;
+                bench_rr_respond(p_tCxt, p_tCxt->sock_local, req, from, fromlen);
+            }
+            continue;
+        }
+
+        if ((p_tCxt->sock_peer = qapi_accept(p_tCxt->sock_local, from, &fromlen)) == A_ERROR)
+        {
+            continue;
+        }
+        connections++;
+
+        /* Serve the connection until the peer closes it */
+        while (bench_rr_tcp_read(p_tCxt->sock_peer, p_tCxt->buffer, BENCH_RR_MIN_SIZE) == QAPI_OK)
+        {
+            req_len = ntohl(req->req_len);
+            if (ntohl(req->magic) != BENCH_RR_MAGIC || req_len < BENCH_RR_MIN_SIZE || req_len > BENCH_RR_MAX_SIZE)
+            {
+                QCLI_Printf(qcli_net_handle, "Bad request, closing connection\n");
+                break;
+            }
+
+            /* The rest of the request is not looked at */
+            if (bench_rr_tcp_read(p_tCxt->sock_peer, p_tCxt->buffer + BENCH_RR_MIN_SIZE, req_len - BENCH_RR_MIN_SIZE) != QAPI_OK)
+            {
+                break;
+            }
+            p_tCxt->pktStats.bytes += req_len;
+
+            if (bench_rr_respond(p_tCxt, p_tCxt->sock_peer, req, NULL, 0) != QAPI_OK)
+            {
+                break;
+            }
+        }
+
+        qapi_socketclose(p_tCxt->sock_peer);
+    }
+
+    QCLI_Printf(qcli_net_handle, "Answered %u requests, %llu bytes received, %llu bytes sent, %u connections\n",
+            p_tCxt->pktStats.pkts_recvd, p_tCxt->pktStats.bytes, p_tCxt->pktStats.sent_bytes, connections);
+
+ERROR_2:
+    qapi_socketclose(p_tCxt->sock_local);
+
+ERROR_1:
+    if (p_tCxt->buffer)
+    {
+        qapi_Net_Buf_Free(p_tCxt->buffer, QAPI_NETBUF_APP);
+        p_tCxt->buffer = NULL;
+    }
+
+    QCLI_Printf(qcli_net_handle, BENCH_TEST_COMPLETED);
+}
+
+static void benchrr_help(void)
+{
+    QCLI_Printf(qcli_net_handle, "\nbenchrr <Rx IP> <port> <mode> <request size> <response size> <seconds> [<depth>] [zc]\n");
+    QCLI_Printf(qcli_net_handle, "    <mode>  tcp_rr: transactions over one TCP connection\n");
+    QCLI_Printf(qcli_net_handle, "            tcp_crr: one TCP connection per transaction\n");
+    QCLI_Printf(qcli_net_handle, "            udp_rr: one datagram each way, lost after %u ms\n", BENCH_RR_UDP_TIMEOUT_MS);
+    QCLI_Printf(qcli_net_handle, "    Sizes are %d to %d bytes, <depth> is the number of requests in flight (1 to %d, 1 for tcp_crr)\n",
+            BENCH_RR_MIN_SIZE, BENCH_RR_MAX_SIZE, BENCH_RR_MAX_DEPTH);
+    QCLI_Printf(qcli_net_handle, "benchrr -s <port> <tcp|udp|tcpzc|udpzc> [v6]\n");
+    QCLI_Printf(qcli_net_handle, "    Answer requests from benchrr_peer -c or another board\n");
+    QCLI_Printf(qcli_net_handle, "Examples:\n");
+    QCLI_Printf(qcli_net_handle, "    benchrr 192.168.1.10 5003 tcp_rr 64 64 10\n");
+    QCLI_Printf(qcli_net_handle, "    benchrr 192.168.1.10 5003 udp_rr 32 256 10 4 zc\n");
+    QCLI_Printf(qcli_net_handle, "    benchrr -s 5003 udp\n");
+}
+
+static int32_t benchrr_size(QCLI_Parameter_t *Parameter)
+{
+    if (!Parameter->Integer_Is_Valid || Parameter->Integer_Value < BENCH_RR_MIN_SIZE || Parameter->Integer_Value > BENCH_RR_MAX_SIZE)
+    {
+        QCLI_Printf(qcli_net_handle, "Incorrect size %s\n", Parameter->String_Value);
+        return A_ERROR;
+    }
+
+    return Parameter->Integer_Value;
+}
+
+/************************************************************************
+ *         [0]           [1]  [2]    [3] [4] [5] [6] [7]
+ * benchrr 192.168.1.100 5003 tcp_rr 64  64  10  1   zc
+ *         [0] [1]  [2] [3]
+ * benchrr -s  5003 udp v6
+ ************************************************************************/
+QCLI_Command_Status_t benchrr(uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List)
+{
+    THROUGHPUT_CXT *ctxt;
+    TX_PARAMS *tx;
+    const char *mode;
+    int32_t size;
+    uint32_t i;
+    QCLI_Command_Status_t status = QCLI_STATUS_ERROR_E;
+
+    if (Parameter_Count == 0 || Parameter_List == NULL)
+    {
+        benchrr_help();
+        return QCLI_STATUS_SUCCESS_E;
+    }
+
+    if ((ctxt = (THROUGHPUT_CXT *)malloc(sizeof(THROUGHPUT_CXT))) == NULL)
+    {
+        QCLI_Printf(qcli_net_handle, "No memory\n");
+        return QCLI_STATUS_ERROR_E;
+    }
+    memset(ctxt, 0, sizeof(THROUGHPUT_CXT));
+
+    if (strcmp(Parameter_List[0].String_Value, "-s") == 0)
+    {
+        if (Parameter_Count < 3 || !Parameter_List[1].Integer_Is_Valid)
+        {
+            benchrr_help();
+            goto end;
+        }
+
+        if (bench_common_SetParams(ctxt, (Parameter_Count > 3 && strcasecmp(Parameter_List[3].String_Value, "v6") == 0),
+                Parameter_List[2].String_Value, Parameter_List[1].Integer_Value, RX) != 0)
+        {
+            goto end;
+        }
+
+        if (ctxt->protocol != TCP && ctxt->protocol != UDP)
+        {
+            QCLI_Printf(qcli_net_handle, "Invalid protocol: %s\n", Parameter_List[2].String_Value);
+            goto end;
+        }
+
+        benchrx_quit = 0;
+        bench_rr_rx(ctxt);
+        status = QCLI_STATUS_SUCCESS_E;
+        goto end;
+    }
+
+    if (Parameter_Count < 6 || Parameter_Count > 8)
+    {
+        benchrr_help();
+        goto end;
+    }
+
+    tx = &ctxt->params.tx_params;
+
+    if (inet_pton(AF_INET, Parameter_List[0].String_Value, &tx->ip_address) != 0)
+    {
+        char *interface_name;
+
+        if (inet_pton(AF_INET6, Parameter_List[0].String_Value, tx->v6addr) != 0)
+        {
+            QCLI_Printf(qcli_net_handle, "Incorrect address %s\n", Parameter_List[0].String_Value);
+            goto end;
+        }
+        tx->v6 = 1;
+
+        if (QAPI_IS_IPV6_LINK_LOCAL(tx->v6addr))
+        {
+            /* if this is a link local address, then the interface must be specified after % */
+            if ((interface_name = bench_common_GetInterfaceNameFromStr(Parameter_List[0].String_Value)) == NULL ||
+                qapi_Net_IPv6_Get_Scope_ID(interface_name, &tx->scope_id) != 0)
+            {
+                goto end;
+            }
+        }
+    }
+
+    if (!Parameter_List[1].Integer_Is_Valid)
+    {
+        benchrr_help();
+        goto end;
+    }
+
+    mode = Parameter_List[2].String_Value;
+    if (strcasecmp(mode, "tcp_rr") == 0)
+    {
+        tx->rr_mode = BENCH_RR_TCP_RR;
+        bench_common_SetParams(ctxt, tx->v6, "tcp", Parameter_List[1].Integer_Value, TX);
+    }
+    else if (strcasecmp(mode, "tcp_crr") == 0)
+    {
+        tx->rr_mode = BENCH_RR_TCP_CRR;
+        bench_common_SetParams(ctxt, tx->v6, "tcp", Parameter_List[1].Integer_Value, TX);
+    }
+    else if (strcasecmp(mode, "udp_rr") == 0)
+    {
+        tx->rr_mode = BENCH_RR_UDP_RR;
+        bench_common_SetParams(ctxt, tx->v6, "udp", Parameter_List[1].Integer_Value, TX);
+    }
+    else
+    {
+        QCLI_Printf(qcli_net_handle, "Invalid mode: %s\n", mode);
+        goto end;
+    }
+
+    if ((size = benchrr_size(&Parameter_List[3])) == A_ERROR)
+    {
+        goto end;
+    }
+    tx->packet_size = size;
+
+    if ((size = benchrr_size(&Parameter_List[4])) == A_ERROR)
+    {
+        goto end;
+    }
+    tx->rr_resp_size = (uint16_t)size;
+
+    if (!Parameter_List[5].Integer_Is_Valid || Parameter_List[5].Integer_Value <= 0)
+    {
+        QCLI_Printf(qcli_net_handle, "Incorrect test time %s\n", Parameter_List[5].String_Value);
+        goto end;
+    }
+    tx->tx_time   = Parameter_List[5].Integer_Value;
+    tx->test_mode = TIME_TEST;
+    tx->rr_depth  = 1;
+
+    for (i = 6; i < Parameter_Count; i++)
+    {
+        if (strcasecmp(Parameter_List[i].String_Value, "zc") == 0)
+        {
+            ctxt->zc = 1;
+        }
+        else if (Parameter_List[i].Integer_Is_Valid &&
+                 Parameter_List[i].Integer_Value >= 1 && Parameter_List[i].Integer_Value <= BENCH_RR_MAX_DEPTH)
+        {
+            tx->rr_depth = (uint8_t)Parameter_List[i].Integer_Value;
+        }
+        else
+        {
+            QCLI_Printf(qcli_net_handle, "Incorrect depth %s\n", Parameter_List[i].String_Value);
+            goto end;
+        }
+    }
+
+    if (tx->rr_mode == BENCH_RR_TCP_CRR)
+    {
+        tx->rr_depth = 1;
+    }
+
+    benchtx_quit = 0;
+    bench_rr_tx(ctxt);
+    status = QCLI_STATUS_SUCCESS_E;
+
+end:
+    free(ctxt);
+    return status;
+}
+
+#endif
@@ -524,6 +524,7 @@ void bench_tcp_rx(THROUGHPUT_CXT *p_tCxt)
 			session = &g_tcpSessions[sessionId];
 			session->ctxt = p_tCxt;
 			session->port = tcpServer->port;
+			bench_common_timeline_start(p_tCxt, &session->pktStats);
 
 			/*Allocate buffer*/
 			if ((session->buffer = qapi_Net_Buf_Alloc(CFG_PACKET_SIZE_MAX_RX, netbuf_id)) == NULL)
@@ -599,6 +600,12 @@ void bench_tcp_rx(THROUGHPUT_CXT *p_tCxt)
 							bench_ssl_Print_SSL_Handshake_Status(sslSession->sslInst.ssl_state);
 
 							if (sslSession->sslInst.ssl_state == QAPI_SSL_OK_HS){
+									time_struct_t hs_end_time;
+
+									app_get_time(&hs_end_time);
+									bench_common_timeline_handshake(&sslSession->pktStats,
+											app_get_time_difference(&sslSession->sslInst.hs_start_time, &hs_end_time));
+
 									sslSession->isFirst = 1;
 									qapi_fd_set(sslSession->sock_peer, &rd_set);
 
@@ -675,7 +682,7 @@ void bench_tcp_rx(THROUGHPUT_CXT *p_tCxt)
 					if (received > 0)
 					{
 						sess->pktStats.bytes += received;
-
+						bench_common_timeline_update(&sess->pktStats, received);
 
 						if (sess->isFirst)
 						{
@@ -889,15 +896,18 @@ void bench_tcp_rx_zc(THROUGHPUT_CXT *p_tCxt)
         memset(&p_tCxt->pktStats.first_time, 0, sizeof(time_struct_t));
         memset(&p_tCxt->pktStats.last_time, 0, sizeof(time_struct_t));
         memset(ip_str, 0, sizeof(ip_str));
+        bench_common_timeline_start(p_tCxt, &p_tCxt->pktStats);
 
 #ifdef CONFIG_NET_SSL_DEMO
         if (p_tCxt->protocol == SSL && p_tCxt->test_type == RX)
         {
+            uint32_t hs_start = app_get_time(NULL);
+
             if (bench_ssl_rx_setup(ssl, p_tCxt->sock_peer, &ssl->ssl, 1) < 0) {
                 qapi_socketclose(p_tCxt->sock_peer);
                 goto tcp_rx_QUIT;
             }
-
+            bench_common_timeline_handshake(&p_tCxt->pktStats, app_get_time(NULL) - hs_start);
         }
 #endif
 
@@ -950,6 +960,7 @@ void bench_tcp_rx_zc(THROUGHPUT_CXT *p_tCxt)
                 ++i;
 
                 p_tCxt->pktStats.bytes += pkt->nb_Tlen;
+                bench_common_timeline_update(&p_tCxt->pktStats, pkt->nb_Tlen);
 
                 if (isFirst)
                 {
@@ -1047,7 +1058,7 @@ void bench_tcp_tx(THROUGHPUT_CXT *p_tCxt)
     uint32_t buffer_offset;
 #ifdef CONFIG_NET_SSL_DEMO
     int32_t result;
-    SSL_INST *ssl = bench_ssl_GetInstance(SSL_CLIENT_INST);
+    SSL_INST *ssl = p_tCxt->ssl_inst ? p_tCxt->ssl_inst : bench_ssl_GetInstance(SSL_CLIENT_INST);
 #endif
     uint32_t i = BENCH_TCP_PKTS_PER_DOT, j = 0;
     uint32_t netbuf_id;
@@ -1105,7 +1116,7 @@ void bench_tcp_tx(THROUGHPUT_CXT *p_tCxt)
 
     zerocopy_send = p_tCxt->params.tx_params.zerocopy_send;
 
-    if (!p_tCxt->is_iperf)
+    if (!p_tCxt->is_iperf && !p_tCxt->multi)
     {
         /* ------ Start test.----------- */
         QCLI_Printf(qcli_net_handle, "\n**********************************************************\n");
@@ -1155,7 +1166,8 @@ void bench_tcp_tx(THROUGHPUT_CXT *p_tCxt)
     bench_config_queue_size(p_tCxt->sock_peer);
 
     /* Connect to the server.*/
-    QCLI_Printf(qcli_net_handle, "Connecting\n");
+    if (!p_tCxt->multi)
+        QCLI_Printf(qcli_net_handle, "Connecting\n");
     if (qapi_connect( p_tCxt->sock_peer, to, tolen) == A_ERROR)
     {
         QCLI_Printf(qcli_net_handle, "Connection failed.\n");
@@ -1201,6 +1213,7 @@ void bench_tcp_tx(THROUGHPUT_CXT *p_tCxt)
         result = qapi_Net_SSL_Connect(ssl->ssl);
         app_get_time(&p_tCxt->pktStats.last_time);
         QCLI_Printf(qcli_net_handle, "TLS Handshake time: %d ms\n", app_get_time_difference(&p_tCxt->pktStats.first_time, &p_tCxt->pktStats.last_time));
+        bench_common_timeline_handshake(&p_tCxt->pktStats, app_get_time_difference(&p_tCxt->pktStats.first_time, &p_tCxt->pktStats.last_time));
 
         if (result < 0)
         {
@@ -1240,7 +1253,15 @@ void bench_tcp_tx(THROUGHPUT_CXT *p_tCxt)
     }
 #endif
 
-    QCLI_Printf(qcli_net_handle, "Sending\n");
+    if (p_tCxt->multi)
+    {
+        /* Start sending together with the other streams of the test */
+        bench_multi_barrier(p_tCxt);
+    }
+    else
+    {
+        QCLI_Printf(qcli_net_handle, "Sending\n");
+    }
 
     if (zerocopy_send)
     {
@@ -1425,7 +1446,7 @@ void bench_tcp_tx(THROUGHPUT_CXT *p_tCxt)
         QCLI_Printf(qcli_net_handle, "%d bytes_sent = %d\n", j, bytes_sent);
 #endif
 
-        if (++i >= BENCH_TCP_PKTS_PER_DOT && !p_tCxt->print_buf)
+        if (++i >= BENCH_TCP_PKTS_PER_DOT && !p_tCxt->print_buf && !p_tCxt->multi)
         {
             QCLI_Printf(qcli_net_handle, ".");
             i = 0;
@@ -1474,6 +1495,7 @@ void bench_tcp_tx(THROUGHPUT_CXT *p_tCxt)
         if ( bytes_sent >= 0  )
         {
             p_tCxt->pktStats.bytes += bytes_sent;
+            bench_common_timeline_update(&p_tCxt->pktStats, bytes_sent);
 
             if ( bytes_sent == bytes_to_send )
             {
@@ -1547,7 +1569,7 @@ void bench_tcp_tx(THROUGHPUT_CXT *p_tCxt)
     {
         iperf_result_print(&p_tCxt->pktStats, 0, 0);
     }
-    else
+    else if (!p_tCxt->multi)
     {
         QCLI_Printf(qcli_net_handle, "\nSent %u/%u messages, %llu bytes to %s %d\n",
             cur_packet_number, j, p_tCxt->pktStats.bytes, ip_str, p_tCxt->params.tx_params.port);
@@ -1573,7 +1595,10 @@ ERROR_2:
     qapi_socketclose( p_tCxt->sock_peer);
 
 ERROR_1:
-    QCLI_Printf(qcli_net_handle, BENCH_TEST_COMPLETED);
+    if (!p_tCxt->multi)
+    {
+        QCLI_Printf(qcli_net_handle, BENCH_TEST_COMPLETED);
+    }
 
     return;
 }
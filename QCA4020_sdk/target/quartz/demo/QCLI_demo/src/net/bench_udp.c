@@ -440,6 +440,7 @@ void bench_udp_rx(THROUGHPUT_CXT *p_tCxt)
         QCLI_Printf(qcli_net_handle, "Waiting\n");
 
         bench_common_clear_stats(p_tCxt);
+        bench_common_timeline_start(p_tCxt, &p_tCxt->pktStats);
         memset(ip_str,0,sizeof(ip_str));
         rxreorder_udp_payload_init(&stat_udp);
 
@@ -538,6 +539,7 @@ void bench_udp_rx(THROUGHPUT_CXT *p_tCxt)
 #endif
                     p_tCxt->pktStats.bytes += received;
                     ++p_tCxt->pktStats.pkts_recvd;
+                    bench_common_timeline_update(&p_tCxt->pktStats, received);
                     rxreorder_udp_payload_statistics(&stat_udp,
                         p_tCxt->buffer, received);
                     if (is_first)
@@ -1022,8 +1024,9 @@ int bench_common_wait_for_response(THROUGHPUT_CXT *p_tCxt, struct sockaddr *to,
     stat_packet_t *stat_packet, stats;
     EOT_PACKET eot_packet, *endmark;
     uint32_t retry_counter = 0;
+    uint32_t endmark_time;
 #ifdef CONFIG_NET_SSL_DEMO
-    SSL_INST *ssl = bench_ssl_GetInstance(SSL_CLIENT_INST);
+    SSL_INST *ssl = p_tCxt->ssl_inst ? p_tCxt->ssl_inst : bench_ssl_GetInstance(SSL_CLIENT_INST);
 #endif
     int family = (int)to->sa_family;
 
@@ -1127,6 +1130,7 @@ int bench_common_wait_for_response(THROUGHPUT_CXT *p_tCxt, struct sockaddr *to,
         /* Send endmark packet */
         ((EOT_PACKET*)endmark)->code            = HOST_TO_LE_LONG(END_OF_TEST_CODE);
         ((EOT_PACKET*)endmark)->packet_count    = htonl(cur_packet_number);
+        endmark_time = app_get_time(NULL);
 
 #ifdef CONFIG_NET_SSL_DEMO
         if (p_tCxt->protocol == SSL && p_tCxt->test_type == TX)
@@ -1176,8 +1180,10 @@ int bench_common_wait_for_response(THROUGHPUT_CXT *p_tCxt, struct sockaddr *to,
 
             if (received == sizeof(stat_packet_t))
             {
-                QCLI_Printf(qcli_net_handle, "%d received %u-byte statistics\n", retry_counter, received);
+                if (!p_tCxt->multi)
+                    QCLI_Printf(qcli_net_handle, "%d received %u-byte statistics\n", retry_counter, received);
                 error = QAPI_OK;
+                bench_common_timeline_rtt(&p_tCxt->pktStats, app_get_time(NULL) - endmark_time);
 
 #ifdef USE_SERVER_STATS
                 /*Response received from peer, extract test statistics*/
@@ -1238,7 +1244,7 @@ void bench_udp_tx(THROUGHPUT_CXT *p_tCxt)
     int tos_opt;
     uint32_t zerocopy_send;
 #ifdef CONFIG_NET_SSL_DEMO
-    SSL_INST *ssl = bench_ssl_GetInstance(SSL_CLIENT_INST);
+    SSL_INST *ssl = p_tCxt->ssl_inst ? p_tCxt->ssl_inst : bench_ssl_GetInstance(SSL_CLIENT_INST);
     uint32_t dtls_data_mtu = 0;
 #endif
     struct sockaddr_in src_sin;
@@ -1295,7 +1301,7 @@ void bench_udp_tx(THROUGHPUT_CXT *p_tCxt)
         QCLI_Printf(qcli_net_handle, "------------------------------------------------------------\n");
 
     }
-    else
+    else if (!p_tCxt->multi)
     {
         /* ------ Start test.----------- */
         QCLI_Printf(qcli_net_handle, "****************************************************************\n");
@@ -1408,6 +1414,7 @@ void bench_udp_tx(THROUGHPUT_CXT *p_tCxt)
         result = qapi_Net_SSL_Connect(ssl->ssl);
         app_get_time(&p_tCxt->pktStats.last_time);
         QCLI_Printf(qcli_net_handle, "DTLS Handshake time: %d ms\n", app_get_time_difference(&p_tCxt->pktStats.first_time, &p_tCxt->pktStats.last_time));
+        bench_common_timeline_handshake(&p_tCxt->pktStats, app_get_time_difference(&p_tCxt->pktStats.first_time, &p_tCxt->pktStats.last_time));
 
         if (result < 0)
         {
@@ -1478,6 +1485,12 @@ void bench_udp_tx(THROUGHPUT_CXT *p_tCxt)
     i = BENCH_UDP_PKTS_PER_DOT;
     n_send_ok = 0;
 
+    if (p_tCxt->multi)
+    {
+        /* Start sending together with the other streams of the test */
+        bench_multi_barrier(p_tCxt);
+    }
+
     app_get_time(&p_tCxt->pktStats.first_time);
 
 
@@ -1685,7 +1698,7 @@ void bench_udp_tx(THROUGHPUT_CXT *p_tCxt)
                 cur_packet_number ++;
             }
 
-            if (++i >= BENCH_UDP_PKTS_PER_DOT && !p_tCxt->print_buf && !p_tCxt->is_iperf)
+            if (++i >= BENCH_UDP_PKTS_PER_DOT && !p_tCxt->print_buf && !p_tCxt->is_iperf && !p_tCxt->multi)
             {
                 QCLI_Printf(qcli_net_handle, ".");
                 i = 0;
@@ -1715,6 +1728,7 @@ void bench_udp_tx(THROUGHPUT_CXT *p_tCxt)
             {
                 p_tCxt->pktStats.bytes += send_bytes;
                 ++n_send_ok;
+                bench_common_timeline_update(&p_tCxt->pktStats, send_bytes);
 
                 if (p_tCxt->is_iperf)
                 {
@@ -1808,7 +1822,7 @@ void bench_udp_tx(THROUGHPUT_CXT *p_tCxt)
         qapi_Net_Buf_Free(p_tCxt->buffer, netbuf_id);
     }
 
-    if (!p_tCxt->is_iperf)
+    if (!p_tCxt->is_iperf && !p_tCxt->multi)
     {
         QCLI_Printf(qcli_net_handle, "\nSent %u packets, %llu bytes to %s %d (%u)\n",
             cur_packet_number, p_tCxt->pktStats.bytes, ip_str, p_tCxt->params.tx_params.port, cur_packet_number - n_send_ok);
@@ -1846,7 +1860,7 @@ ERROR_2:
     qapi_socketclose(p_tCxt->sock_peer);
 
 ERROR_1:
-    if (!p_tCxt->is_iperf)
+    if (!p_tCxt->is_iperf && !p_tCxt->multi)
     {
         QCLI_Printf(qcli_net_handle, BENCH_TEST_COMPLETED);
     }
@@ -295,6 +295,21 @@ const QCLI_Command_t net_cmd_list[] =
 #ifdef CONFIG_NET_USER_ACCOUNT_DEMO
     {user,     false,  "user",    "\n\nType \"user\" to get more info on usage\n", "User account management"},
 #endif
+#ifdef CONFIG_NET_TXRX_DEMO
+    {benchstats,
+                false,  "benchstats", "\n\nbenchstats [on [<interval_ms>]|off|show|csv]\n",
+                                    "\nRecord throughput per interval and packet timing histograms of benchtx/rx tests, show or export them as CSV"},
+#endif
+#ifdef CONFIG_NET_TXRX_DEMO
+    {benchrr,
+                true,   "benchrr",  "\n\nType \"benchrr\" to get more info on usage\n",
+                                    "\nMeasure request/response transactions per second and latency (TCP_RR, TCP_CRR, UDP_RR)"},
+#endif
+#ifdef CONFIG_NET_TXRX_DEMO
+    {benchmulti,
+                true,   "benchmulti", "\n\nType \"benchmulti\" to get more info on usage\n",
+                                    "\nRun parallel TX streams started together, report per-stream and aggregate throughput, fairness and CPU load"},
+#endif
 };
 
 const QCLI_Command_Group_t net_cmd_group =
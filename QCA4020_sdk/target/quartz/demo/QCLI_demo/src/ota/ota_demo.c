@@ -538,7 +538,8 @@ static QCLI_Command_Status_t Command_Fw_Upgrade_HTTP_Upgrade(uint32_t Parameter_
                                 plugin_Http_Recv_Data,
                                 plugin_Http_Abort,
 								plugin_Http_Resume,
-                                plugin_Http_Fin};
+                                plugin_Http_Fin,
+                                plugin_Http_Recv_Buffer};
 
     if (Parameter_Count != 3)
     {
@@ -20,6 +20,7 @@
 // WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
 // EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -42,22 +43,49 @@ extern QCLI_Group_Handle_t qcli_fw_upgrade_group;              /* Handle for our
 #define HTTPC_DEFAULT_MAX_HEADER_LEN   350
 #define MAX_PRINTF_LENGTH 256
 
+/*
+ * The file is fetched in ranges of HTTPC_OTA_SEGMENT_BLOCKS flash blocks. Two sessions take turns: while
+ * the upgrade consumes the end of one range, the next range is already requested on the other session.
+ */
+#define HTTPC_OTA_SESSIONS                          2
+#ifndef HTTPC_OTA_SEGMENT_BLOCKS
+#define HTTPC_OTA_SEGMENT_BLOCKS                    8
+#endif
+
+#define HTTP_STATUS_OK                              200
+#define HTTP_STATUS_PARTIAL_CONTENT                 206
+#define HTTP_STATUS_RANGE_NOT_SATISFIABLE           416
+
 #define   HTTPC_RX_DATA_DONE_SIG_MASK    			0x01
 #define   HTTPC_RX_DATA_ERROR_SIG_MASK              0x02
 #define   HTTPC_RX_DATA_FINISH_SIG_MASK             0x04
 #define   HTTPC_DATA_RX_ALL_SIG_MASK				(HTTPC_RX_DATA_DONE_SIG_MASK | HTTPC_RX_DATA_FINISH_SIG_MASK | HTTPC_RX_DATA_ERROR_SIG_MASK)
-qurt_signal_t   data_ready_signal;
 
 #define   HTTPC_BUFFER_EMPTY_SIG_MASK               0x01
-qurt_signal_t   data_drain_signal;
 
-uint32_t  data_ready_len;
-char  *data_ready_ptr;
+struct http_segment_t
+{
+	qapi_Net_HTTPc_handle_t client;
+	qurt_signal_t  data_ready_signal;     /* set by the HTTP client callback */
+	qurt_signal_t  data_drain_signal;     /* set when the received data has been consumed */
+	const uint8_t *data_ready_ptr;        /* received data not handed out yet */
+	uint32_t  data_ready_len;
+	uint32_t  resp_code;
+	uint32_t  start;                      /* file offset of the requested range */
+	uint32_t  received;                   /* response data received for the range */
+	uint8_t   busy;                       /* request is outstanding */
+	uint8_t   held;                       /* data is handed out, the callback waits for the drain signal */
+};
 
 struct http_client_t
 {
-	qapi_Net_HTTPc_handle_t client;
-	uint32_t total_len;
+	struct http_segment_t seg[HTTPC_OTA_SESSIONS];
+	struct http_segment_t *active;        /* segment delivering data, NULL at end of file */
+	uint32_t  next_start;                 /* file offset of the next range to request */
+	uint32_t  seg_len;                    /* range length, HTTPC_OTA_SEGMENT_BLOCKS flash blocks */
+	uint32_t  skip;                       /* data to drop when the server ignores the range */
+	uint8_t   no_range;                   /* server sends the whole file, no more ranges are requested */
+	uint8_t   stop;                       /* plugin shuts down, callbacks must not wait */
 	qapi_Net_SSL_Obj_Hdl_t sslCtx;
     qapi_Net_SSL_Config_t *sslCfg;
 	char http_svr[64];
@@ -67,54 +95,133 @@ struct http_client_t
 
 /*
  *  HTTP client thread callback
- *        arg:  parameter that qapi_Net_HTTPc_New_sess pass, that is, &http_client
+ *        arg:  parameter that qapi_Net_HTTPc_New_sess2 pass, that is, the segment of the session
  *      state:  indicate HTPP client status 
  *  http_resp:  HTTP client response
  */
 void http_client_cb(void* arg, int32_t state, void* http_resp)
 {
     qapi_Net_HTTPc_Response_t* temp = (qapi_Net_HTTPc_Response_t *)http_resp;
-    struct http_client_t* hc = (struct http_client_t *)arg;
+    struct http_segment_t* seg = (struct http_segment_t *)arg;
 
     if (state >= 0)
     {
+        seg->resp_code = temp->resp_Code;
 
-        if (temp->length && temp->data)
-        {			
-			data_ready_len = temp->length;
-			data_ready_ptr = (char *)temp->data;
+        if (temp->length && temp->data && !http_client.stop)
+        {
+			/* the data is used in place, the receive buffer must not be reused until it is drained */
+			seg->data_ready_len = temp->length;
+			seg->data_ready_ptr = temp->data;
 			
-			qurt_signal_set(&data_ready_signal, HTTPC_RX_DATA_DONE_SIG_MASK);
-			qurt_signal_wait(&data_drain_signal, HTTPC_BUFFER_EMPTY_SIG_MASK, QURT_SIGNAL_ATTR_CLEAR_MASK);
-			hc->total_len += temp->length;
+			qurt_signal_set(&seg->data_ready_signal, HTTPC_RX_DATA_DONE_SIG_MASK);
+			qurt_signal_wait(&seg->data_drain_signal, HTTPC_BUFFER_EMPTY_SIG_MASK, QURT_SIGNAL_ATTR_CLEAR_MASK);
         }
 
-        if (state == 0 && hc->total_len)
+        if (state == QAPI_NET_HTTPC_RX_FINISHED)
         {
-            hc->total_len = 0; // Finished
-			qurt_signal_set(&data_ready_signal, HTTPC_RX_DATA_FINISH_SIG_MASK);
+			qurt_signal_set(&seg->data_ready_signal, HTTPC_RX_DATA_FINISH_SIG_MASK);
         }
     }
     else
     {
-		qurt_signal_set(&data_ready_signal, HTTPC_RX_DATA_ERROR_SIG_MASK);
-        hc->total_len = 0;
+		qurt_signal_set(&seg->data_ready_signal, HTTPC_RX_DATA_ERROR_SIG_MASK);
     }
 }
 
 /*
- * OTA HTTP plugin Init
- * interface_name:    interface name, such as wlan1
+ * request the range starting at http_client.next_start on a segment
+ */
+static qapi_Status_t http_segment_request(struct http_segment_t *seg)
+{
+	char  range[32];
+	qapi_Status_t  error;
+
+	/* the previous response of the session has to be finished first */
+	if (seg->busy)
+	{
+		qurt_signal_wait(&seg->data_ready_signal, HTTPC_RX_DATA_FINISH_SIG_MASK | HTTPC_RX_DATA_ERROR_SIG_MASK, QURT_SIGNAL_ATTR_CLEAR_MASK);
+	}
+	qurt_signal_clear(&seg->data_ready_signal, HTTPC_DATA_RX_ALL_SIG_MASK);
+
+	seg->start = http_client.next_start;
+	seg->received = 0;
+	seg->resp_code = 0;
+	seg->data_ready_len = 0;
+	http_client.next_start += http_client.seg_len;
+
+	snprintf(range, sizeof(range), "bytes=%lu-%lu", (unsigned long)seg->start, (unsigned long)(seg->start + http_client.seg_len - 1));
+	qapi_Net_HTTPc_Clear_Header(seg->client);
+	qapi_Net_HTTPc_Add_Header_Field(seg->client, "Range", range);
+
+	error = qapi_Net_HTTPc_Request(seg->client, QAPI_NET_HTTP_CLIENT_GET_E, http_client.dl_file);
+	if (error != QAPI_OK)
+	{
+		/* the server may have closed the idle connection, the segment fails if it cannot be reconnected */
+		error = qapi_Net_HTTPc_Connect(seg->client, http_client.http_svr, http_client.port);
+		if (error == QAPI_OK)
+		{
+			error = qapi_Net_HTTPc_Request(seg->client, QAPI_NET_HTTP_CLIENT_GET_E, http_client.dl_file);
+		}
+	}
+	seg->busy = (error == QAPI_OK);
+	return error;
+}
+
+/*
+ * release HTTP client sessions
+ */
+static qapi_Status_t http_client_close(void)
+{
+	qapi_Status_t  error;
+	int  i;
+
+	/* wake up callbacks waiting for their data to be drained */
+	http_client.stop = 1;
+	for (i = 0; i < HTTPC_OTA_SESSIONS; i++)
+	{
+		if (http_client.seg[i].client != NULL)
+			qurt_signal_set(&http_client.seg[i].data_drain_signal, HTTPC_BUFFER_EMPTY_SIG_MASK);
+	}
+
+    error = qapi_Net_HTTPc_Stop();
+
+	for (i = 0; i < HTTPC_OTA_SESSIONS; i++)
+	{
+		if (http_client.seg[i].client != NULL)
+		{
+			qapi_Net_HTTPc_Free_sess(http_client.seg[i].client);
+			qurt_signal_delete(&http_client.seg[i].data_ready_signal);
+			qurt_signal_delete(&http_client.seg[i].data_drain_signal);
+		}
+	}
+
+	if (http_client.sslCtx != QAPI_NET_SSL_INVALID_HANDLE)
+		qapi_Net_SSL_Obj_Free(http_client.sslCtx);
+
+	if (http_client.sslCfg)
+	{
+		free(http_client.sslCfg);
+	}
+
+	memset(&http_client, 0, sizeof(struct http_client_t));
+	return error;
+}
+
+/*
+ * connect HTTP server and request the file from offset
  *            url:    parameters, format: <timeout>:<server>:<port>/<url>
+ *         offset:    file offset to start the download
  */
-qapi_Fw_Upgrade_Status_Code_t plugin_Http_Init(const char* interface_name, const char *url, void *init_param)
+static qapi_Fw_Upgrade_Status_Code_t http_client_open(const char *url, uint32_t offset)
 {
     int error = QAPI_OK;
 	char  *svr_ptr, *ptr, ed_buf[32];
-    qapi_Net_HTTPc_Method_e req_cmd = 0;
     uint32_t port = 0;
     uint32_t server_offset = 0;
     uint32_t timeout = 0;
+    uint32_t block_size;
+	int  i;
 
     /* start HTTP client thread */
     error = qapi_Net_HTTPc_Start();
@@ -123,197 +230,271 @@ qapi_Fw_Upgrade_Status_Code_t plugin_Http_Init(const char* interface_name, const
         return QCLI_STATUS_ERROR_E;
     }
 	    
-    /* connect HTTP server */
+	memset(&http_client, 0, sizeof(struct http_client_t));
+
+	ptr = strchr(url, ':');
+	
+	if( ptr == NULL )
+	{
+		return FW_UPGRADE_ERR_HTTP_URL_FORMAT_E;
+	}
+	
+	memcpy(ed_buf, url, ptr - url);
+	ed_buf[ptr - url] = '\0';
+	
+    http_client.timeout = atoi(ed_buf);
+
+	ptr = ptr + 1;
+    if(strlen(ptr) >= 64)
     {
+        return QAPI_FW_UPGRADE_ERROR_E;
+    }
 
-		ptr = strchr(url, ':');
-		
-		if( ptr == NULL )
-		{
-			return FW_UPGRADE_ERR_HTTP_URL_FORMAT_E;
-		}
-		
-		memcpy(ed_buf, url, ptr - url);
-		ed_buf[ptr - url] = '\0';
-		
-        http_client.timeout = atoi(ed_buf);
-
-		ptr = ptr + 1;
-        if(strlen(ptr) >= 64)
+    if(strncmp(ptr, "https://", 8) == 0)
+    {
+        server_offset = 8;
+        http_client.sslCtx = qapi_Net_SSL_Obj_New(QAPI_NET_SSL_CLIENT_E);
+        if (http_client.sslCtx == QAPI_NET_SSL_INVALID_HANDLE)
         {
-            return QAPI_FW_UPGRADE_ERROR_E;
+            memset(&http_client, 0, sizeof(struct http_client_t));
+            return QCLI_STATUS_ERROR_E;
         }
+    }
+    else if(strncmp(ptr, "http://", 7) == 0)
+    {
+        server_offset = 7;
+    }
 
-        if(strncmp(ptr, "https://", 8) == 0)
-        {
-            server_offset = 8;
-            http_client.sslCtx = qapi_Net_SSL_Obj_New(QAPI_NET_SSL_CLIENT_E);
-            if (http_client.sslCtx == QAPI_NET_SSL_INVALID_HANDLE)
-            {
-                if (http_client.sslCfg)
-                {
-                    free(http_client.sslCfg);
-                }
-                memset(&http_client, 0, sizeof(struct http_client_t));
-                return QCLI_STATUS_ERROR_E;
-            }
-        }
-        else if(strncmp(ptr, "http://", 7) == 0)
-        {
-            server_offset = 7;
-        }
+	svr_ptr = ptr + server_offset;
+	
+	ptr = strchr(svr_ptr, '/');
+	if( ptr == NULL )
+	{
+		http_client_close();
+		return FW_UPGRADE_ERR_HTTP_URL_FORMAT_E;
+	}
+	memcpy(http_client.http_svr, svr_ptr, ptr - svr_ptr);
+	http_client.http_svr[ptr - svr_ptr]='\0';
+	
+	strcpy(http_client.dl_file, ptr+1);
 
-		svr_ptr = ptr + server_offset;
-		
-		ptr = strchr(svr_ptr, '/');
-		if( ptr == NULL )
-		{
-			return FW_UPGRADE_ERR_HTTP_URL_FORMAT_E;
-		}
-		memcpy(http_client.http_svr, svr_ptr, ptr - svr_ptr);
-		http_client.http_svr[ptr - svr_ptr]='\0';
-		
-		strcpy(http_client.dl_file, ptr+1);
-
-        http_client.port = 80;
-		svr_ptr = http_client.http_svr;
-		ptr = strchr(svr_ptr, ':');
-		if (ptr != NULL)
-		{
-			*ptr = '\0';
-			ptr++;
-			port = atoi(ptr);
+    http_client.port = 80;
+	svr_ptr = http_client.http_svr;
+	ptr = strchr(svr_ptr, ':');
+	if (ptr != NULL)
+	{
+		*ptr = '\0';
+		ptr++;
+		port = atoi(ptr);
 
-        	if (port != 0)
-				http_client.port = port;			
-		}
-		
-	    QCLI_Printf(FW_UPGRADE_PRINTF_HANDLE, "svr_ptr: %s\r\n", http_client.http_svr);
-		QCLI_Printf(FW_UPGRADE_PRINTF_HANDLE, "port=%d\r\n", http_client.port);
-	    QCLI_Printf(FW_UPGRADE_PRINTF_HANDLE, "file uri: %s\r\n", http_client.dl_file);
-		
-		qurt_signal_init(&data_ready_signal);
-		qurt_signal_init(&data_drain_signal);
-		
-        http_client.client = qapi_Net_HTTPc_New_sess(timeout, http_client.sslCtx, http_client_cb, 
-		                            (void *)&http_client, HTTPC_DEFAULT_MAX_BODY_LEN, HTTPC_DEFAULT_MAX_HEADER_LEN);
-		
-        if (http_client.client == NULL)
+    	if (port != 0)
+			http_client.port = port;			
+	}
+	
+    QCLI_Printf(FW_UPGRADE_PRINTF_HANDLE, "svr_ptr: %s\r\n", http_client.http_svr);
+	QCLI_Printf(FW_UPGRADE_PRINTF_HANDLE, "port=%d\r\n", http_client.port);
+    QCLI_Printf(FW_UPGRADE_PRINTF_HANDLE, "file uri: %s\r\n", http_client.dl_file);
+
+	/* receive one flash block at a time and request ranges of whole blocks */
+	if ((qapi_Fw_Upgrade_Get_Flash_Block_Size(&block_size) != QAPI_OK) || (block_size == 0))
+		block_size = HTTPC_DEFAULT_MAX_BODY_LEN;
+	if (block_size > 0xFFFF)
+		block_size = 0xFFFF;
+	http_client.seg_len = block_size * HTTPC_OTA_SEGMENT_BLOCKS;
+
+	for (i = 0; i < HTTPC_OTA_SESSIONS; i++)
+	{
+		qurt_signal_create(&http_client.seg[i].data_ready_signal);
+		qurt_signal_create(&http_client.seg[i].data_drain_signal);
+
+        http_client.seg[i].client = qapi_Net_HTTPc_New_sess2(timeout, http_client.sslCtx, http_client_cb, (void *)&http_client.seg[i],
+		                            HTTPC_DEFAULT_MAX_BODY_LEN, HTTPC_DEFAULT_MAX_HEADER_LEN, (uint16_t)block_size);
+        if (http_client.seg[i].client == NULL)
         {
+			qurt_signal_delete(&http_client.seg[i].data_ready_signal);
+			qurt_signal_delete(&http_client.seg[i].data_drain_signal);
 			QCLI_Printf(FW_UPGRADE_PRINTF_HANDLE, "There is no available http client session\r\n");
-            if (http_client.sslCtx != QAPI_NET_SSL_INVALID_HANDLE)
-                qapi_Net_SSL_Obj_Free(http_client.sslCtx);
-
-            if (http_client.sslCfg)
-            {
-                free(http_client.sslCfg);
-            }
-
-            memset(&http_client, 0, sizeof(struct http_client_t));
+            http_client_close();
             return QAPI_FW_UPGRADE_ERROR_E;
         }
-		QCLI_Printf(FW_UPGRADE_PRINTF_HANDLE, "new session done\r\n");
-
-        error = QAPI_OK;
-
-        if (error == QAPI_OK)
-        {
-            error = qapi_Net_HTTPc_Connect(http_client.client, http_client.http_svr, http_client.port);
-        }
 
+        error = qapi_Net_HTTPc_Connect(http_client.seg[i].client, http_client.http_svr, http_client.port);
         if (error)
         {
-            qapi_Net_HTTPc_Free_sess(http_client.client);
-            if (http_client.sslCtx != QAPI_NET_SSL_INVALID_HANDLE)
-                qapi_Net_SSL_Obj_Free(http_client.sslCtx);
-
-            if (http_client.sslCfg)
-            {
-                free(http_client.sslCfg);
-            }
-
-            memset(&http_client, 0, sizeof(struct http_client_t));
+            http_client_close();
             return QAPI_FW_UPGRADE_ERROR_E;
         }
+	}
+	QCLI_Printf(FW_UPGRADE_PRINTF_HANDLE, "connect done !!!\r\n");
 
-		QCLI_Printf(FW_UPGRADE_PRINTF_HANDLE, "connect done !!!\r\n");
-    }
-	
 /*
- * trigger GET request
+ * trigger GET request of the first range
  */
-    req_cmd = QAPI_NET_HTTP_CLIENT_GET_E;
-    error = qapi_Net_HTTPc_Request(http_client.client, req_cmd, http_client.dl_file);
-	if (error == QAPI_OK)
-		QCLI_Printf(FW_UPGRADE_PRINTF_HANDLE, "request done\r\n");
-		
+	http_client.next_start = offset;
+	http_client.active = &http_client.seg[0];
+	if (http_segment_request(http_client.active) != QAPI_OK)
+	{
+		http_client_close();
+		return FW_UPGRADE_ERR_HTTP_SEND_E;
+	}
+	QCLI_Printf(FW_UPGRADE_PRINTF_HANDLE, "request done\r\n");
+
 	return QAPI_FW_UPGRADE_OK_E;
 }
 
 /*
- * OTA HTTP plugin receive data
- *    buffer:    received data buffer
- *   buf_len:    received data buffer size in bytes
- *  ret_size:    data size in buffer after receiving done
+ * check the response of the data just received on the active segment
  */
+static qapi_Fw_Upgrade_Status_Code_t http_segment_check(struct http_segment_t *seg)
+{
+	uint32_t  len;
 
-qapi_Fw_Upgrade_Status_Code_t plugin_Http_Recv_Data(uint8_t *buffer, uint32_t buf_len, uint32_t *ret_size)
+	seg->received += seg->data_ready_len;
+
+	switch (seg->resp_code)
+	{
+	case HTTP_STATUS_PARTIAL_CONTENT:
+		break;
+
+	case HTTP_STATUS_OK:
+		/* the server ignores Range:, the whole file comes with this response */
+		if (!http_client.no_range)
+		{
+			http_client.no_range = 1;
+			http_client.skip = seg->start;
+		}
+		break;
+
+	case HTTP_STATUS_RANGE_NOT_SATISFIABLE:
+		/* the range starts at the end of the file, drop the error page */
+		seg->data_ready_len = 0;
+		return QAPI_FW_UPGRADE_OK_E;
+
+	default:
+		QCLI_Printf(FW_UPGRADE_PRINTF_HANDLE, "HTTP response %d\r\n", seg->resp_code);
+		return QAPI_FW_UPGRADE_ERROR_E;
+	}
+
+	/* data before the resume offset */
+	if (http_client.skip)
+	{
+		len = (http_client.skip < seg->data_ready_len) ? http_client.skip : seg->data_ready_len;
+		seg->data_ready_ptr += len;
+		seg->data_ready_len -= len;
+		http_client.skip -= len;
+	}
+
+	/* last data of a full range is in hand, request the next range on the other session */
+	if (!http_client.no_range && (seg->received == http_client.seg_len))
+	{
+		if (http_segment_request(&http_client.seg[(seg - http_client.seg + 1) % HTTPC_OTA_SESSIONS]) != QAPI_OK)
+			return QAPI_FW_UPGRADE_ERROR_E;
+	}
+	return QAPI_FW_UPGRADE_OK_E;
+}
+
+/*
+ * OTA HTTP plugin receive data without copy
+ *    buffer:    returns the HTTP client receive buffer, valid until the next receive call
+ *   buf_len:    maximum data size to return
+ *  ret_size:    data size in buffer, 0 at end of file
+ */
+qapi_Fw_Upgrade_Status_Code_t plugin_Http_Recv_Buffer(uint8_t **buffer, uint32_t buf_len, uint32_t *ret_size)
 {
-	uint32_t  signals;
-	
+	struct http_segment_t *seg;
+	uint32_t  signals, len;
+
 	*ret_size = 0;
-	do {
-		signals = qurt_signal_wait(&data_ready_signal, HTTPC_DATA_RX_ALL_SIG_MASK, QURT_SIGNAL_ATTR_CLEAR_MASK);
-		
-		if (signals & HTTPC_RX_DATA_DONE_SIG_MASK)
+	while ((seg = http_client.active) != NULL)
+	{
+		if (seg->held && (seg->data_ready_len > 0))
 		{
-			if  (data_ready_len > buf_len)
-			{
-				memcpy(buffer, data_ready_ptr, buf_len);
-				
-				data_ready_len -= buf_len;
-				data_ready_ptr += buf_len;
-				
-				*ret_size = buf_len;
-				qurt_signal_set(&data_ready_signal, HTTPC_RX_DATA_DONE_SIG_MASK);
-				break;
-			}
-			else
-			{
-				memcpy(buffer, data_ready_ptr, data_ready_len);
-				
-				*ret_size = data_ready_len;
-				data_ready_len = 0;
-				qurt_signal_set(&data_drain_signal, HTTPC_BUFFER_EMPTY_SIG_MASK);				
-			}
+			len = (seg->data_ready_len > buf_len) ? buf_len : seg->data_ready_len;
+			*buffer = (uint8_t *)seg->data_ready_ptr;
+			*ret_size = len;
+			seg->data_ready_ptr += len;
+			seg->data_ready_len -= len;
+			return QAPI_FW_UPGRADE_OK_E;
+		}
+
+		/* the data handed out last time is consumed, let the HTTP client reuse its buffer */
+		if (seg->held)
+		{
+			seg->held = 0;
+			qurt_signal_set(&seg->data_drain_signal, HTTPC_BUFFER_EMPTY_SIG_MASK);
 		}
-		if (signals & HTTPC_RX_DATA_FINISH_SIG_MASK)
+
+		/* range is complete, continue with the one requested ahead */
+		if (!http_client.no_range && (seg->received == http_client.seg_len))
 		{
-			
+			http_client.active = &http_client.seg[(seg - http_client.seg + 1) % HTTPC_OTA_SESSIONS];
+			continue;
 		}
+
+		signals = qurt_signal_wait(&seg->data_ready_signal, HTTPC_DATA_RX_ALL_SIG_MASK, QURT_SIGNAL_ATTR_CLEAR_MASK);
+
 		if (signals & HTTPC_RX_DATA_ERROR_SIG_MASK)
 		{
-			
+			seg->busy = 0;
+			return QAPI_FW_UPGRADE_ERROR_E;
+		}
+		if (signals & HTTPC_RX_DATA_DONE_SIG_MASK)
+		{
+			seg->held = 1;
+			if (http_segment_check(seg) != QAPI_FW_UPGRADE_OK_E)
+				return QAPI_FW_UPGRADE_ERROR_E;
+		}
+		else if (signals & HTTPC_RX_DATA_FINISH_SIG_MASK)
+		{
+			seg->busy = 0;
+			if ((seg->resp_code != HTTP_STATUS_OK) && (seg->resp_code != HTTP_STATUS_PARTIAL_CONTENT) && (seg->resp_code != HTTP_STATUS_RANGE_NOT_SATISFIABLE))
+			{
+				QCLI_Printf(FW_UPGRADE_PRINTF_HANDLE, "HTTP response %d\r\n", seg->resp_code);
+				return QAPI_FW_UPGRADE_ERROR_E;
+			}
+			/* a short range, an empty response or a range past the end finishes the file */
+			http_client.active = NULL;
 		}
-	} while (0);
+	}
 
 	return QAPI_FW_UPGRADE_OK_E;
 }
 
 /*
- *  OTA HTTP done
+ * OTA HTTP plugin receive data
+ *    buffer:    received data buffer
+ *   buf_len:    received data buffer size in bytes
+ *  ret_size:    data size in buffer after receiving done
  */
-qapi_Fw_Upgrade_Status_Code_t plugin_Http_Fin(void)
+qapi_Fw_Upgrade_Status_Code_t plugin_Http_Recv_Data(uint8_t *buffer, uint32_t buf_len, uint32_t *ret_size)
 {
-    int error = qapi_Net_HTTPc_Stop();
-	
-	if (http_client.client != NULL)
+	qapi_Fw_Upgrade_Status_Code_t rtn;
+	uint8_t  *data;
+
+	rtn = plugin_Http_Recv_Buffer(&data, buf_len, ret_size);
+	if ((rtn == QAPI_FW_UPGRADE_OK_E) && (*ret_size > 0))
 	{
-		qapi_Net_HTTPc_Free_sess(http_client.client);
-		http_client.client = NULL;
+		memcpy(buffer, data, *ret_size);
 	}
+	return rtn;
+}
 
-	if (error == QAPI_OK)
+/*
+ * OTA HTTP plugin Init
+ * interface_name:    interface name, such as wlan1
+ *            url:    parameters, format: <timeout>:<server>:<port>/<url>
+ */
+qapi_Fw_Upgrade_Status_Code_t plugin_Http_Init(const char* interface_name, const char *url, void *init_param)
+{
+	return http_client_open(url, 0);
+}
+
+/*
+ *  OTA HTTP done
+ */
+qapi_Fw_Upgrade_Status_Code_t plugin_Http_Fin(void)
+{
+	if (http_client_close() == QAPI_OK)
        return QAPI_FW_UPGRADE_OK_E;
    
     return QAPI_FW_UPGRADE_ERROR_E;
@@ -324,21 +505,15 @@ qapi_Fw_Upgrade_Status_Code_t plugin_Http_Fin(void)
  */
 qapi_Fw_Upgrade_Status_Code_t plugin_Http_Abort(void)
 {
-    qapi_Net_HTTPc_Stop();
-
-	if (http_client.client != NULL)
-	{
-		qapi_Net_HTTPc_Free_sess(http_client.client);
-		http_client.client = NULL;
-	}
+	http_client_close();
 	return QAPI_FW_UPGRADE_OK_E;
 }
 
 /*
- *  HTTP doesn't support resume
+ *  OTA HTTP resume, the download restarts at offset with a range request
  */
 qapi_Fw_Upgrade_Status_Code_t plugin_Http_Resume(const char* interface_name, const char *url, uint32_t offset)
 {
-	return QAPI_FW_UPGRADE_OK_E;
+	return http_client_open(url, offset);
 }
 
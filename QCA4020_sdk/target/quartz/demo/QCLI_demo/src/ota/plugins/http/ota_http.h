@@ -49,6 +49,7 @@ typedef enum {
 qapi_Fw_Upgrade_Status_Code_t plugin_Http_Init(const char* interface_name, const char *url, void *init_param);
 qapi_Fw_Upgrade_Status_Code_t plugin_Http_Fin(void);
 qapi_Fw_Upgrade_Status_Code_t plugin_Http_Recv_Data(uint8_t *buffer, uint32_t buf_len, uint32_t *ret_size);
+qapi_Fw_Upgrade_Status_Code_t plugin_Http_Recv_Buffer(uint8_t **buffer, uint32_t buf_len, uint32_t *ret_size);
 qapi_Fw_Upgrade_Status_Code_t plugin_Http_Abort(void);
 qapi_Fw_Upgrade_Status_Code_t plugin_Http_Resume(const char* interface_name, const char *url, uint32_t offset);
 
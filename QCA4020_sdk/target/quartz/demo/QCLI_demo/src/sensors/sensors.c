@@ -329,6 +329,13 @@ int32_t sensors_humidity_get_measured_value()
 	T1_OUT_val = humidity_read_sensor_reg16(&config_humidity, HUMIDITY_I2C_REG_ADDR_T1_OUT);
 	QCLI_Printf(qcli_sensors_group, "register 2's comp T0:%d T1:%d T:%d\n", T0_OUT_val, T1_OUT_val, T_OUT_val);
 	
+	// equal calibration points mean the sensor is not answering, the slope would divide by zero
+	if (T1_OUT_val == T0_OUT_val)
+	{
+		QCLI_Printf(qcli_sensors_group, "Invalid temperature calibration\n");
+		return -1;
+	}
+
 	T0_DegCx8_f = T0_DegCx8;
 	T1_DegCx8_f = T1_DegCx8;
 	T_DegCx8_fx10 = (T1_DegCx8_f - T0_DegCx8_f)  * (T_OUT_val - T0_OUT_val) * 10 / (T1_OUT_val - T0_OUT_val) + T0_DegCx8_f * 10;
@@ -350,6 +357,12 @@ int32_t sensors_humidity_get_measured_value()
 	H1_T0_OUT_val = humidity_read_sensor_reg16(&config_humidity, HUMIDITY_I2C_REG_ADDR_H1_T0_OUT);
 	QCLI_Printf(qcli_sensors_group, "2's comp H0_T0:%d H1_T0:%d H:%d\n", H0_T0_OUT_val, H1_T0_OUT_val, H_OUT_val);
 	
+	if (H1_T0_OUT_val == H0_T0_OUT_val)
+	{
+		QCLI_Printf(qcli_sensors_group, "Invalid humidity calibration\n");
+		return -1;
+	}
+
 	H_rHx2_fx10 = (H1_rHx2 - H0_rHx2)  * (H_OUT_val - H0_T0_OUT_val) * 10 / (H1_T0_OUT_val - H0_T0_OUT_val) + H0_rHx2 * 10;
 	
 	QCLI_Printf(qcli_sensors_group, "rHx2 Hx10:%d\n", H_rHx2_fx10);
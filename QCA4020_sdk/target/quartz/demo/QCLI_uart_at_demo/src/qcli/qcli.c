@@ -59,10 +59,37 @@
 #define TAKE_LOCK(__lock__)                                             ((qurt_mutex_lock_timed(&(__lock__), QURT_TIME_WAIT_FOREVER)) == QURT_EOK)
 #define RELEASE_LOCK(__lock__)                                          do { qurt_mutex_unlock(&(__lock__)); } while(0)
 
+/**
+   The number of subgroups a group's lookup index is given room for on top
+   of the ones already registered, so that registering a few more subgroups
+   doesn't need a new allocation.
+*/
+#define COMMAND_INDEX_SPARE_SUBGROUPS                                   (4)
+
 /*-------------------------------------------------------------------------
  * Type Declarations
  *-----------------------------------------------------------------------*/
 
+/**
+  This structure is the lookup index of a group, it lets Find_Command()
+  find a name without searching the command lists.  It is rebuilt
+  whenever a subgroup is registered or unregistered.
+
+  The hash table holds every name that can be entered in the group (the
+  common commands, the group's commands and its subgroups) and uses linear
+  probing.  Each slot holds the command index of an entry plus one, zero
+  marks an empty slot.
+  */
+typedef struct Command_Index_s
+{
+    uint32_t                   Entry_Count;       /**< The number of commands and subgroups of the group.          */
+    uint32_t                   Subgroup_Count;    /**< The number of subgroups in the subgroup array.               */
+    uint32_t                   Subgroup_Capacity; /**< The number of subgroups the subgroup array has room for.     */
+    uint32_t                   Hash_Mask;         /**< The size of the hash table minus one (a power of two).       */
+    uint16_t                  *Hash_Table;        /**< The hash table of the names.                                 */
+    struct Group_List_Entry_s **Subgroup_Array;   /**< The subgroups of the group, in the order of the subgroup list. */
+} Command_Index_t;
+
 /**
   This structure reprents the result of a Find_Command() operation.
   */
@@ -97,6 +124,11 @@ void Display_Command_List(const Group_List_Entry_t *Group_List_Entry);
 static void Command_Thread(void *Thread_Parameter);
 
 static void Execute_Command(uint32_t Command_Index, const QCLI_Command_t *Command, uint32_t Parameter_Count, QCLI_Parameter_t *Parameter_List);
+static uint32_t Hash_Command_String(const char *String, uint32_t Length);
+static const char *Get_Command_Entry(Group_List_Entry_t *Group_List_Entry, uint32_t Command_Index, Find_Result_t *Find_Result);
+static uint32_t Find_Hash_Slot(Group_List_Entry_t *Group_List_Entry, const char *String, uint32_t Length);
+static qbool_t Lookup_Command(Group_List_Entry_t *Group_List_Entry, const char *String, uint32_t Length, uint32_t *Command_Index);
+static qbool_t Build_Command_Index(Group_List_Entry_t *Group_List_Entry);
 static qbool_t Find_Command(Group_List_Entry_t *Group_List_Entry, QCLI_Parameter_t *Command_Parameter, Find_Result_t *Find_Result);
 static void Process_Command(void);
 static qbool_t Unregister_Command_Group(Group_List_Entry_t *Group_List_Entry);
@@ -728,173 +760,300 @@ static void Execute_Command(uint32_t Command_Index, const QCLI_Command_t *Comman
 }
 
 /**
-  @brief This function searches the command and/or group lists for a
-  match to the provided parameter.
+  @brief This function calculates the case insensitive hash (FNV-1a) of a
+         command or group name.
 
-  @param Group_List_Entry is the group to search.
-  @param Command_Parameter is the paramter to search for.
-  @param Find_Result is a pointer to where the found entry will be stored
-  if successful (i.e., true was returned).
+  @param String is the name to hash.
+  @param Length is the length of the name.
+
+  @return The hash of the name.
+  */
+static uint32_t Hash_Command_String(const char *String, uint32_t Length)
+{
+    uint32_t Hash;
+    uint8_t  Byte;
+
+    Hash = 2166136261UL;
+
+    while(Length)
+    {
+        /* Fold the case the same way as Memcmpi(). */
+        Byte = (uint8_t)(*String);
+        if((Byte >= 'a') && (Byte <= 'z'))
+        {
+            Byte = Byte - ('a' - 'A');
+        }
+
+        Hash ^= Byte;
+        Hash *= 16777619UL;
+
+        String ++;
+        Length --;
+    }
+
+    return(Hash);
+}
+
+/**
+  @brief This function gets an entry of a group from its command index.
+
+  The command index counts the common commands first, then the group's
+  commands and then its subgroups, in the same order they are displayed
+  by Display_Command_List() (less COMMAND_START_INDEX).
+
+  @param Group_List_Entry is the group the entry belongs to.
+  @param Command_Index is the command index of the entry.
+  @param Find_Result is a pointer to where the entry will be stored if it
+         exists.  This parameter may be NULL if only the name is needed.
 
   @return
-  - true if a matching command or group was found in the list.
-  - false if the command or group was not found.
+   - The name of the entry.
+   - NULL if the command index is not valid for the group.
   */
-static qbool_t Find_Command(Group_List_Entry_t *Group_List_Entry, QCLI_Parameter_t *Command_Parameter, Find_Result_t *Find_Result)
+static const char *Get_Command_Entry(Group_List_Entry_t *Group_List_Entry, uint32_t Command_Index, Find_Result_t *Find_Result)
 {
-    qbool_t               Ret_Val;
-    uint32_t              Index;
-    uint32_t              Command_Index;
-    uint32_t              String_Length;
+    const char           *Ret_Val;
+    const QCLI_Command_t *Command;
     const QCLI_Command_t *Command_List;
     uint32_t              Command_List_Length;
     Group_List_Entry_t   *Subgroup_List_Entry;
 
-    /* Get the size of the string. Include the null byte so the comparison
-       doesn't match substrings. */
-    String_Length = strlen((const char *)(Command_Parameter->String_Value)) + 1;
+    /* Determine which common command list is used by the group. */
+    if(Group_List_Entry == &(QCLI_Context.Root_Group))
+    {
+        Command_List        = Root_Command_List;
+        Command_List_Length = ROOT_COMMAND_LIST_SIZE;
+    }
+    else
+    {
+        Command_List        = Common_Command_List;
+        Command_List_Length = COMMON_COMMAND_LIST_SIZE;
+    }
 
-    if(Group_List_Entry != NULL)
+    Ret_Val = NULL;
+    Command = NULL;
+
+    if(Command_Index < Command_List_Length)
     {
-        /* Determine which common command list is going to be used. */
-        if(Group_List_Entry == &(QCLI_Context.Root_Group))
+        /* Entry is in the common command list. */
+        Command = &(Command_List[Command_Index]);
+    }
+    else
+    {
+        Command_Index -= Command_List_Length;
+
+        if((Group_List_Entry->Command_Group != NULL) && (Command_Index < Group_List_Entry->Command_Group->Command_Count))
         {
-            Command_List        = Root_Command_List;
-            Command_List_Length = ROOT_COMMAND_LIST_SIZE;
+            /* Entry is in the group's command list. */
+            Command = &(Group_List_Entry->Command_Group->Command_List[Command_Index]);
         }
         else
         {
-            Command_List        = Common_Command_List;
-            Command_List_Length = COMMON_COMMAND_LIST_SIZE;
-        }
+            if(Group_List_Entry->Command_Group != NULL)
+            {
+                Command_Index -= Group_List_Entry->Command_Group->Command_Count;
+            }
 
-        if(Command_Parameter->Integer_Is_Valid)
-        {
-            /* Command was specified as an integer. */
-            if(Command_Parameter->Integer_Value >= COMMAND_START_INDEX)
+            if((Group_List_Entry->Command_Index != NULL) && (Command_Index < Group_List_Entry->Command_Index->Subgroup_Count))
             {
-                Command_Index = Command_Parameter->Integer_Value - COMMAND_START_INDEX;
+                /* Entry is in the subgroup list. */
+                Subgroup_List_Entry = Group_List_Entry->Command_Index->Subgroup_Array[Command_Index];
+                Ret_Val             = Subgroup_List_Entry->Command_Group->Group_String;
 
-                /* If the integer is a valid value for the command group, use it. */
-                if(Command_Index < Command_List_Length)
+                if(Find_Result != NULL)
                 {
-                    /* Command is in the common command list. */
-                    Ret_Val                   = true;
-                    Find_Result->Is_Group     = false;
-                    Find_Result->Data.Command = &(Command_List[Command_Index]);
+                    Find_Result->Is_Group              = true;
+                    Find_Result->Data.Group_List_Entry = Subgroup_List_Entry;
                 }
-                else
-                {
-                    Command_Index -= Command_List_Length;
+            }
+        }
+    }
 
-                    if((Group_List_Entry->Command_Group != NULL) && (Command_Index < Group_List_Entry->Command_Group->Command_Count))
-                    {
-                        /* Command is in the group's command list. */
-                        Ret_Val                   = true;
-                        Find_Result->Is_Group     = false;
-                        Find_Result->Data.Command = &(Group_List_Entry->Command_Group->Command_List[Command_Index]);
-                    }
-                    else
-                    {
-                        if(Group_List_Entry->Command_Group != NULL)
-                        {
-                            Command_Index -= Group_List_Entry->Command_Group->Command_Count;
-                        }
+    if(Command != NULL)
+    {
+        Ret_Val = Command->Command_String;
 
-                        /* Search the group list. */
-                        Group_List_Entry = Group_List_Entry->Subgroup_List;
-                        while((Group_List_Entry != NULL) && (Command_Index != 0))
-                        {
-                            Group_List_Entry = Group_List_Entry->Next_Group_List_Entry;
-                            Command_Index --;
-                        }
+        if(Find_Result != NULL)
+        {
+            Find_Result->Is_Group     = false;
+            Find_Result->Data.Command = Command;
+        }
+    }
 
-                        if(Group_List_Entry != NULL)
-                        {
-                            /* Command is in the subgroup list. */
-                            Ret_Val                            = true;
-                            Find_Result->Is_Group              = true;
-                            Find_Result->Data.Group_List_Entry = Group_List_Entry;
-                        }
-                        else
-                        {
-                            Ret_Val = false;
-                        }
-                    }
-                }
-            }
-            else
-            {
-                Ret_Val = false;
-            }
+    return(Ret_Val);
+}
+
+/**
+  @brief This function finds the slot of the hash table of a group that
+         holds a name, or the empty slot the name would be added to.
+
+  @param Group_List_Entry is the group to search.  Its index must exist.
+  @param String is the name to search for.  It doesn't need to be NULL
+         terminated.
+  @param Length is the length of the name.
+
+  @return The slot of the hash table.
+  */
+static uint32_t Find_Hash_Slot(Group_List_Entry_t *Group_List_Entry, const char *String, uint32_t Length)
+{
+    Command_Index_t *Index;
+    uint32_t         Slot;
+    const char      *Name;
+
+    Index = Group_List_Entry->Command_Index;
+    Slot  = Hash_Command_String(String, Length) & Index->Hash_Mask;
+
+    /* The table is never more than half full, so an empty slot is always
+        reached. */
+    while(Index->Hash_Table[Slot] != 0)
+    {
+        Name = Get_Command_Entry(Group_List_Entry, Index->Hash_Table[Slot] - 1, NULL);
+
+        if((Memcmpi(String, Name, Length) == 0) && (Name[Length] == '\0'))
+        {
+            break;
         }
-        else
+
+        Slot = (Slot + 1) & Index->Hash_Mask;
+    }
+
+    return(Slot);
+}
+
+/**
+  @brief This function looks up a command or subgroup name in the index
+         of a group.  The comparison is case insensitive.
+
+  @param Group_List_Entry is the group to search.
+  @param String is the name to search for.  It doesn't need to be NULL
+         terminated.
+  @param Length is the length of the name.
+  @param Command_Index is a pointer to where the command index of the
+         entry will be stored if it was found.
+
+  @return
+   - true if the name was found.
+   - false if the name was not found.
+  */
+static qbool_t Lookup_Command(Group_List_Entry_t *Group_List_Entry, const char *String, uint32_t Length, uint32_t *Command_Index)
+{
+    qbool_t  Ret_Val;
+    uint32_t Slot;
+
+    Ret_Val = false;
+
+    if(Group_List_Entry->Command_Index != NULL)
+    {
+        Slot = Find_Hash_Slot(Group_List_Entry, String, Length);
+
+        if(Group_List_Entry->Command_Index->Hash_Table[Slot] != 0)
+        {
+            *Command_Index = Group_List_Entry->Command_Index->Hash_Table[Slot] - 1;
+            Ret_Val        = true;
+        }
+    }
+
+    return(Ret_Val);
+}
+
+/**
+  @brief This function (re)builds the lookup index of a group from its
+         command lists and subgroup list.
+
+  The existing index is reused if it has room for all the subgroups, so
+  rebuilding the index after a subgroup was removed can't fail.
+
+  @param Group_List_Entry is the group to build the index for.
+
+  @return
+   - true if the index was built.
+   - false if there was not enough memory for the index.
+  */
+static qbool_t Build_Command_Index(Group_List_Entry_t *Group_List_Entry)
+{
+    qbool_t             Ret_Val;
+    Command_Index_t    *Index;
+    Group_List_Entry_t *Subgroup_List_Entry;
+    uint32_t            Subgroup_Count;
+    uint32_t            Entry_Count;
+    uint32_t            Capacity;
+    uint32_t            Table_Size;
+    uint32_t            Command_Index;
+    uint32_t            Slot;
+    const char         *Name;
+
+    /* Count the entries of the group. */
+    Subgroup_Count = 0;
+    for(Subgroup_List_Entry = Group_List_Entry->Subgroup_List; Subgroup_List_Entry != NULL; Subgroup_List_Entry = Subgroup_List_Entry->Next_Group_List_Entry)
+    {
+        Subgroup_Count ++;
+    }
+
+    Entry_Count = (Group_List_Entry == &(QCLI_Context.Root_Group)) ? ROOT_COMMAND_LIST_SIZE : COMMON_COMMAND_LIST_SIZE;
+    if(Group_List_Entry->Command_Group != NULL)
+    {
+        Entry_Count += Group_List_Entry->Command_Group->Command_Count;
+    }
+    Entry_Count += Subgroup_Count;
+
+    Index = Group_List_Entry->Command_Index;
+
+    if((Index == NULL) || (Subgroup_Count > Index->Subgroup_Capacity))
+    {
+        /* Allocate a new index with room for a few more subgroups. The hash
+            table is sized so it is never more than half full. */
+        Capacity   = Subgroup_Count + COMMAND_INDEX_SPARE_SUBGROUPS;
+        Table_Size = 8;
+        while(Table_Size < 2 * (Entry_Count + COMMAND_INDEX_SPARE_SUBGROUPS))
         {
-            /* Command was specified as a string. */
-            Command_Index = COMMAND_START_INDEX;
-            Ret_Val       = false;
+            Table_Size <<= 1;
+        }
 
-            /* Search the common command list. */
-            for(Index = 0; (Index < Command_List_Length) && (!Ret_Val); Index ++)
-            {
-                if(Memcmpi(Command_Parameter->String_Value, Command_List[Index].Command_String, String_Length) == 0)
-                {
-                    /* Command found. */
-                    Ret_Val                          = true;
-                    Find_Result->Is_Group            = false;
-                    Find_Result->Data.Command        = &(Command_List[Index]);
-                    Command_Parameter->Integer_Value = Command_Index;
-                }
-                else
-                {
-                    Command_Index ++;
-                }
-            }
+        Index = (Command_Index_t *)malloc(sizeof(Command_Index_t) + (Capacity * sizeof(Group_List_Entry_t *)) + (Table_Size * sizeof(uint16_t)));
+        if(Index != NULL)
+        {
+            Index->Subgroup_Capacity = Capacity;
+            Index->Hash_Mask         = Table_Size - 1;
+            Index->Subgroup_Array    = (Group_List_Entry_t **)(Index + 1);
+            Index->Hash_Table        = (uint16_t *)(Index->Subgroup_Array + Capacity);
 
-            /* Only search the command group if it isn't NULL. */
-            if((!Ret_Val) && (Group_List_Entry->Command_Group != NULL))
+            if(Group_List_Entry->Command_Index != NULL)
             {
-                /* If the comamnd wasn't found yet, search the group's command list. */
-                for(Index = 0; (Index < Group_List_Entry->Command_Group->Command_Count) && (!Ret_Val); Index ++)
-                {
-                    if(Memcmpi(Command_Parameter->String_Value, Group_List_Entry->Command_Group->Command_List[Index].Command_String, String_Length) == 0)
-                    {
-                        /* Command found. */
-                        Ret_Val                           = true;
-                        Find_Result->Is_Group             = false;
-                        Find_Result->Data.Command         = &(Group_List_Entry->Command_Group->Command_List[Index]);
-                        Command_Parameter->Integer_Value  = Command_Index;
-                    }
-                    else
-                    {
-                        Command_Index ++;
-                    }
-                }
+                free(Group_List_Entry->Command_Index);
             }
 
-            if(!Ret_Val)
+            Group_List_Entry->Command_Index = Index;
+        }
+    }
+
+    if(Index != NULL)
+    {
+        Index->Entry_Count    = Entry_Count;
+        Index->Subgroup_Count = 0;
+
+        for(Subgroup_List_Entry = Group_List_Entry->Subgroup_List; Subgroup_List_Entry != NULL; Subgroup_List_Entry = Subgroup_List_Entry->Next_Group_List_Entry)
+        {
+            Index->Subgroup_Array[Index->Subgroup_Count] = Subgroup_List_Entry;
+            Index->Subgroup_Count ++;
+        }
+
+        memset(Index->Hash_Table, 0, (Index->Hash_Mask + 1) * sizeof(uint16_t));
+
+        /* Add the names in command index order. A name that is already in the
+            table is skipped so the first entry with a name is found, as when
+            the lists were searched in order. */
+        for(Command_Index = 0; Command_Index < Entry_Count; Command_Index ++)
+        {
+            Name = Get_Command_Entry(Group_List_Entry, Command_Index, NULL);
+            Slot = Find_Hash_Slot(Group_List_Entry, Name, strlen(Name));
+
+            if(Index->Hash_Table[Slot] == 0)
             {
-                /* If the comamnd wasn't found yet, search the group's subgroup
-                   list. */
-                Subgroup_List_Entry = Group_List_Entry->Subgroup_List;
-                while((Subgroup_List_Entry != NULL) && (!Ret_Val))
-                {
-                    if(Memcmpi(Command_Parameter->String_Value, Subgroup_List_Entry->Command_Group->Group_String, String_Length) == 0)
-                    {
-                        /* Command found. */
-                        Ret_Val                            = true;
-                        Find_Result->Is_Group              = true;
-                        Find_Result->Data.Group_List_Entry = Subgroup_List_Entry;
-                        Command_Parameter->Integer_Value   = Command_Index;
-                    }
-                    else
-                    {
-                        Command_Index ++;
-                        Subgroup_List_Entry = Subgroup_List_Entry->Next_Group_List_Entry;
-                    }
-                }
+                Index->Hash_Table[Slot] = (uint16_t)(Command_Index + 1);
             }
         }
+
+        Ret_Val = true;
     }
     else
     {
@@ -904,6 +1063,53 @@ static qbool_t Find_Command(Group_List_Entry_t *Group_List_Entry, QCLI_Parameter
     return(Ret_Val);
 }
 
+/**
+  @brief This function searches the command and/or group lists for a
+  match to the provided parameter.
+
+  @param Group_List_Entry is the group to search.
+  @param Command_Parameter is the paramter to search for.
+  @param Find_Result is a pointer to where the found entry will be stored
+  if successful (i.e., true was returned).
+
+  @return
+  - true if a matching command or group was found in the list.
+  - false if the command or group was not found.
+  */
+static qbool_t Find_Command(Group_List_Entry_t *Group_List_Entry, QCLI_Parameter_t *Command_Parameter, Find_Result_t *Find_Result)
+{
+    qbool_t  Ret_Val;
+    uint32_t Command_Index;
+
+    Ret_Val = false;
+
+    if(Group_List_Entry != NULL)
+    {
+        if(Command_Parameter->Integer_Is_Valid)
+        {
+            /* Command was specified as an integer. */
+            if((Command_Parameter->Integer_Value >= COMMAND_START_INDEX) && (Get_Command_Entry(Group_List_Entry, Command_Parameter->Integer_Value - COMMAND_START_INDEX, Find_Result) != NULL))
+            {
+                Ret_Val = true;
+            }
+        }
+        else
+        {
+            /* Command was specified as a string, look it up in the group's
+                index. */
+            if(Lookup_Command(Group_List_Entry, Command_Parameter->String_Value, strlen((const char *)(Command_Parameter->String_Value)), &Command_Index))
+            {
+                Get_Command_Entry(Group_List_Entry, Command_Index, Find_Result);
+
+                Command_Parameter->Integer_Value = Command_Index + COMMAND_START_INDEX;
+                Ret_Val                          = true;
+            }
+        }
+    }
+
+    return(Ret_Val);
+}
+
 /**
   @brief This function processes a command received from the console.
   */
@@ -1233,13 +1439,17 @@ static qbool_t Unregister_Command_Group(Group_List_Entry_t *Group_List_Entry)
 
     if(Group_Is_Valid)
     {
-        /* Unregsiter any subgroups of the command. */
-        Current_Entry = Group_List_Entry->Subgroup_List;
-        Ret_Val       = false;
+        /* Remove the group from the index of its parent. The parent's index
+            is reused, so this can't fail. */
+        Build_Command_Index(Group_List_Entry->Parent_Group);
+
+        /* Unregsiter any subgroups of the command. Each one removes itself
+            from the subgroup list. */
+        Ret_Val = false;
 
-        while(Current_Entry != NULL)
+        while(Group_List_Entry->Subgroup_List != NULL)
         {
-            if(Unregister_Command_Group(Current_Entry))
+            if(Unregister_Command_Group(Group_List_Entry->Subgroup_List))
             {
                 Ret_Val = true;
             }
@@ -1253,6 +1463,11 @@ static qbool_t Unregister_Command_Group(Group_List_Entry_t *Group_List_Entry)
         }
 
         /* Free the resources for the group. */
+        if(Group_List_Entry->Command_Index != NULL)
+        {
+            free(Group_List_Entry->Command_Index);
+        }
+
         free(Group_List_Entry);
     }
     else
@@ -1284,7 +1499,8 @@ qbool_t QCLI_Initialize(void)
     /* Initialize the thread ready event. */
     qurt_signal_init(&QCLI_Context.Thread_Info.Thread_Ready_Event);
 
-    return(true);
+    /* Index the commands of the root group. */
+    return(Build_Command_Index(&(QCLI_Context.Root_Group)));
 }
 
 void QCLI_Set_DataMode(uint32_t enable, uint32_t len)
@@ -1479,6 +1695,7 @@ QCLI_Group_Handle_t QCLI_Register_Command_Group(QCLI_Group_Handle_t Parent_Group
             New_Entry->Command_Group         = Command_Group;
             New_Entry->Next_Group_List_Entry = NULL;
             New_Entry->Subgroup_List         = NULL;
+            New_Entry->Command_Index         = NULL;
 
             if(Parent_Group == NULL)
             {
@@ -1488,22 +1705,31 @@ QCLI_Group_Handle_t QCLI_Register_Command_Group(QCLI_Group_Handle_t Parent_Group
             {
                 New_Entry->Parent_Group = (Group_List_Entry_t *)Parent_Group;
             }
-        }
 
-        /* Add the new entry to its parents subgroup list. */
-        if(New_Entry->Parent_Group->Subgroup_List == NULL)
-        {
-            New_Entry->Parent_Group->Subgroup_List = New_Entry;
-        }
-        else
-        {
-            Current_Entry = New_Entry->Parent_Group->Subgroup_List;
-            while(Current_Entry->Next_Group_List_Entry != NULL)
+            /* Add the new entry to its parents subgroup list. */
+            if(New_Entry->Parent_Group->Subgroup_List == NULL)
+            {
+                New_Entry->Parent_Group->Subgroup_List = New_Entry;
+            }
+            else
             {
-                Current_Entry = Current_Entry->Next_Group_List_Entry;
+                Current_Entry = New_Entry->Parent_Group->Subgroup_List;
+                while(Current_Entry->Next_Group_List_Entry != NULL)
+                {
+                    Current_Entry = Current_Entry->Next_Group_List_Entry;
+                }
+
+                Current_Entry->Next_Group_List_Entry = New_Entry;
             }
 
-            Current_Entry->Next_Group_List_Entry = New_Entry;
+            /* Index the commands of the new group and add the group to the
+                index of its parent. */
+            if((!Build_Command_Index(New_Entry)) || (!Build_Command_Index(New_Entry->Parent_Group)))
+            {
+                Unregister_Command_Group(New_Entry);
+
+                New_Entry = NULL;
+            }
         }
 
         RELEASE_LOCK(QCLI_Context.CLI_Mutex);
@@ -170,6 +170,7 @@ typedef struct Group_List_Entry_s
    struct Group_List_Entry_s  *Parent_Group;          /**< the parent group for this subgroup. */
    struct Group_List_Entry_s  *Subgroup_List;         /**< The list of subgroups registerd for this group. */
    struct Group_List_Entry_s  *Next_Group_List_Entry; /**< The next entry in the list. */
+   struct Command_Index_s     *Command_Index;         /**< The lookup index of the group's commands and subgroups. */
 } Group_List_Entry_t;
 
 /**
@@ -39,6 +39,9 @@ IF /I "%1" == "clobber" (
 
 REM Sources to compile
 SET CSrcs=fw_upgrade\fw_upgrade.c
+SET CSrcs=%CSrcs% fw_upgrade\fw_upgrade_sha256.c
+SET CSrcs=%CSrcs% fw_upgrade\fw_upgrade_delta.c
+SET CSrcs=%CSrcs% fw_upgrade\fw_upgrade_lz.c
 
 REM Include directories
 SET Includes=-I"%RootDir%\include"
@@ -45,6 +45,7 @@
 #include "qurt_mutex.h"
 #include "qurt_signal.h"
 #include "qurt_thread.h"
+#include "qurt_timer.h"
 #include "qurt_types.h"
 #include "malloc.h"
 #include "fw_upgrade.h"
@@ -93,6 +94,35 @@ extern int fs_umount(const char *mount_dir);
 
 #define   FWUP_THREAD_CLOSE_SIG_MASK               0x01
 
+#define   FWUP_PIPE_BUF_FILLED_SIG_MASK            0x01
+#define   FWUP_PIPE_BUF_FREE_SIG_MASK              0x02
+#define   FWUP_PIPE_THREAD_DONE_SIG_MASK           0x04
+
+#define   FWUP_PIPE_STOP_TIMEOUT_MS                5000     //receive thread still in the plugin by then is left behind
+
+/*
+ * receive pipeline
+ *
+ * While images are received, a receive thread keeps the free buffers of the
+ * ring filled from the plugin, so the network receive of the next buffers
+ * overlaps with the hash update and flash write of the current one.
+ */
+typedef struct {
+    uint8_t      *buf;                                     //FW_UPGRADE_BUF_COUNT buffers of FW_UPGRADE_BUF_SIZE
+    uint32_t      len[FW_UPGRADE_BUF_COUNT];               //received bytes in each buffer
+    qapi_Fw_Upgrade_Status_Code_t status[FW_UPGRADE_BUF_COUNT];
+    uint32_t      head;                                    //next buffer to process
+    uint32_t      tail;                                    //next buffer to fill
+    uint32_t      filled;                                  //buffers filled and not released yet
+    uint32_t      budget;                                  //bytes still expected on this connection
+    uint8_t       running;
+    uint8_t       held;                                    //head buffer is being processed
+    volatile uint8_t stop;
+    volatile uint8_t done;
+    uint8_t       abandoned;                               //session stopped waiting for the receive thread
+    uint8_t       released;                                //session is finished, receive thread frees the buffers
+    qurt_signal_t signal;
+} fw_Upgrade_Pipe_t;
 
 
 /*************************************************************************************************************/
@@ -105,6 +135,8 @@ qurt_mutex_t    Fw_Upgrade_Mutex;
 qurt_signal_t   data_ready_signal;
 qurt_signal_t   data_drain_signal;
 qurt_signal_t   thread_close_signal;
+static fw_Upgrade_Pipe_t fw_upgrade_pipe;
+static qapi_Fw_Upgrade_Status_Code_t fw_upgrade_image_rtn;     /* failure in the delta and decompressor callbacks */
 
 /*************************************************************************************************************/
 /*************************************************************************************************************/
@@ -114,6 +146,13 @@ static void fw_Upgrade_Update_Callback(uint32_t state, uint32_t status);
 static void fw_Upgrade_Set_State(qapi_Fw_Upgrade_State_t state);
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Config_File(uint8_t *buf);
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Verify_Image_Hash(fw_Upgrade_Image_Hdr_t *image_hdr);
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Write_Image_Data(uint32_t offset, const uint8_t *data, uint32_t len);
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Stage_Image_Data(uint32_t offset, const uint8_t *data, uint32_t len);
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Flush_Image_Data(void);
+static int fw_Upgrade_Delta_Read(void *param, uint32_t offset, uint8_t *buf, uint32_t len);
+static int fw_Upgrade_Delta_Write(void *param, uint32_t offset, const uint8_t *data, uint32_t len);
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Store_Image_Data(fw_Upgrade_Image_Hdr_t *img_hdr, uint32_t offset, const uint8_t *data, uint32_t len);
+static int fw_Upgrade_Lz_Output(void *param, const uint8_t *data, uint32_t len);
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Receive_Image(uint8_t *buffer);
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Duplicate_FS(uint32_t flags);
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Duplicate_Images(void);
@@ -125,8 +164,13 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Finalize(qapi_Fw_Upgrade
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Plugin_Init(void);
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Plugin_Fin(void);
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Plugin_Recv_Data(uint8_t *buffer, uint32_t buf_len, uint32_t *ret_size);
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Plugin_Recv_Buffer(uint8_t **buffer, uint32_t *ret_size);
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Plugin_Abort(void);
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Plugin_Resume(void);
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Pipe_Start(uint8_t *buffer);
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Pipe_Get(uint8_t **buffer, uint32_t *ret_size);
+static void fw_Upgrade_Pipe_Stop(void);
+static void fw_Upgrade_Pipe_Free(uint8_t *buffer);
 
 /*************************************************************************************************************/
 /*************************************************************************************************************/
@@ -270,11 +314,17 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Fin(void)
 {
     qapi_OMSM_alloc_status_t alloc_status;
     uint16 buff_size;
+    uint8_t abandoned = 0;
 
     if (fw_upgrade_sess_cxt != NULL && fw_upgrade_sess_cxt->config_buf != NULL ) {
         free(fw_upgrade_sess_cxt->config_buf);
         fw_upgrade_sess_cxt->config_buf = NULL;
     }
+    if (fw_upgrade_sess_cxt != NULL && fw_upgrade_sess_cxt->stage_buf != NULL ) {
+        free(fw_upgrade_sess_cxt->stage_buf);
+        fw_upgrade_sess_cxt->stage_buf = NULL;
+        fw_upgrade_sess_cxt->stage_len = 0;
+    }
     
     //check AON_FW_UPGRADE memory 
     qapi_OMSM_Check_Status(QAPI_OMSM_DEFAULT_AON_POOL, OM_SMEM_FW_UPGRADE_ID_IMG_HDR, &alloc_status);    
@@ -294,6 +344,10 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Fin(void)
                 qapi_Fw_Upgrade_Close_Partition(fw_upgrade_sess_cxt->partition_hdl);
                 fw_upgrade_sess_cxt->partition_hdl = NULL;
             }
+            if( fw_upgrade_sess_cxt->delta_src_hdl != NULL ) {
+                qapi_Fw_Upgrade_Close_Partition(fw_upgrade_sess_cxt->delta_src_hdl);
+                fw_upgrade_sess_cxt->delta_src_hdl = NULL;
+            }
 
             //free crypto
             if( fw_upgrade_sess_cxt->digest_ctx != 0 ) {
@@ -309,7 +363,13 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Fin(void)
         fw_upgrade_sess_cxt = NULL;
     }
 
-    if( Fw_Upgrade_Mutex_Init != 0 ) {
+    //a receive thread left behind in the plugin still takes the mutex, keep it for the next session
+    if( (Fw_Upgrade_Mutex_Init != 0) && TAKE_LOCK(Fw_Upgrade_Mutex) ) {
+        abandoned = fw_upgrade_pipe.abandoned;
+        RELEASE_LOCK(Fw_Upgrade_Mutex);
+    }
+
+    if( (Fw_Upgrade_Mutex_Init != 0) && (abandoned == 0) ) {
         qurt_signal_set(&data_drain_signal, FWUP_BUFFER_EMPTY_SIG_MASK);
         qurt_mutex_destroy(&Fw_Upgrade_Mutex);
         qurt_signal_delete(&data_ready_signal);
@@ -326,11 +386,26 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Fin(void)
  */
 static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Prepare_Suspend(void)
 {
+    qapi_Fw_Upgrade_Status_Code_t rtn = QAPI_FW_UPGRADE_OK_E;
+
     if (fw_upgrade_sess_cxt) {
+        //resume continues from what is in flash, the staged data has to be there before suspend
+        if( fw_upgrade_sess_cxt->stage_buf != NULL ) {
+            if( fw_upgrade_sess_cxt->partition_hdl != NULL ) {
+                rtn = fw_Upgrade_Flush_Image_Data();
+            }
+            free(fw_upgrade_sess_cxt->stage_buf);
+            fw_upgrade_sess_cxt->stage_buf = NULL;
+            fw_upgrade_sess_cxt->stage_len = 0;
+        }
         if( fw_upgrade_sess_cxt->partition_hdl != NULL ) {
             qapi_Fw_Upgrade_Close_Partition(fw_upgrade_sess_cxt->partition_hdl);
             fw_upgrade_sess_cxt->partition_hdl = NULL;
         }
+        if( fw_upgrade_sess_cxt->delta_src_hdl != NULL ) {
+            qapi_Fw_Upgrade_Close_Partition(fw_upgrade_sess_cxt->delta_src_hdl);
+            fw_upgrade_sess_cxt->delta_src_hdl = NULL;
+        }
 
         //free crypto
         if( fw_upgrade_sess_cxt->digest_ctx != 0 ) {
@@ -338,7 +413,7 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Prepare_Suspend(void)
             fw_upgrade_sess_cxt->digest_ctx = 0;
         }
     }
-    return QAPI_FW_UPGRADE_OK_E;
+    return rtn;
 }
 
 /*
@@ -348,7 +423,7 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
 {
     qapi_Fw_Upgrade_Status_Code_t rtn = QAPI_FW_UPGRADE_OK_E;
     fw_Upgrade_Context_t *fw_upgrade_cxt;
-    uint8_t *buffer = NULL;
+    uint8_t *buffer = NULL, *data;
     uint8_t  run = 1;
     uint32_t received, param;
 
@@ -378,11 +453,12 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
         return QAPI_FW_UPGRADE_ERR_SESSION_NOT_START_E;
     }
     
-    /*Allocate buffer*/
-    if((buffer = malloc(FW_UPGRADE_BUF_SIZE)) == NULL) {
+    /*Allocate receive buffers, the first one is also used when the receive pipeline is not running*/
+    if((buffer = malloc(FW_UPGRADE_BUF_SIZE * FW_UPGRADE_BUF_COUNT)) == NULL) {
         FW_UPGRADE_D_PRINTF("Out of memory error\r\n");
         return QAPI_FW_UPGRADE_ERR_INSUFFICIENT_MEMORY_E;
     }
+    data = buffer;
 
     while( (run == 1) && (fw_Upgrade_Get_Session_Status() == FW_UPGRADE_SESSION_RUNNING_E) )
     {
@@ -553,7 +629,7 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
 
             case QAPI_FW_UPGRADE_STATE_RESUME_SERVICE_E:
             {
-                uint32_t offset, len, nbytes, total;
+                uint32_t offset, len, nbytes, total, written;
                 fw_Upgrade_Image_Hdr_t *img_hdr;
 
                 fw_Upgrade_Update_Callback(fw_Upgrade_Get_State(), fw_Upgrade_Get_Error_Code());
@@ -576,7 +652,6 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
                     break;
                 }
 
-                //re-calculate hash
                 //allocate crypto resource
                 //if( fw_upgrade_cxt->digest_ctx != 0 )
                 //	qapi_Crypto_Op_Free(fw_upgrade_sess_cxt->digest_ctx);
@@ -597,13 +672,30 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
                 len = 0;
                 total = 0;
 
+                //a delta or compressed image writes the flash as far as it has rebuilt the image
+                written = fw_upgrade_cxt->image_wrt_count;
+                if( fw_upgrade_cxt->image_wrt_length != 0 ) {
+                    if( img_hdr->hash_type & FW_UPGRADE_HASH_TYPE_DELTA ) {
+                        written = fw_upgrade_cxt->delta.out_count;
+                    } else if( img_hdr->hash_type & FW_UPGRADE_HASH_TYPE_COMPRESSED ) {
+                        written = fw_upgrade_cxt->lz.out_count;
+                    }
+                }
+
+                //image digest is kept in the session context, re-calculate it only if it is not in step with the flash
+                if( (fw_upgrade_cxt->image_wrt_length == 0) || (fw_upgrade_cxt->image_digest.count == written) ) {
+                    total = written;
+                } else {
+                    fw_Upgrade_Sha256_Init(&fw_upgrade_cxt->image_digest);
+                }
+
                 //calculate fw upgrade image HASH
-                while( total < fw_upgrade_cxt->image_wrt_count )
+                while( total < written )
                 {
-                    if( (fw_upgrade_cxt->image_wrt_count- total) > FW_UPGRADE_BUF_SIZE) {
+                    if( (written - total) > FW_UPGRADE_BUF_SIZE) {
                         len = FW_UPGRADE_BUF_SIZE;
                     } else {
-                        len = fw_upgrade_cxt->image_wrt_count- total;
+                        len = written - total;
                     }
                     if( qapi_Fw_Upgrade_Read_Partition(fw_upgrade_cxt->partition_hdl, offset, (char *)buffer, len, &nbytes) != QAPI_OK) {
                         rtn = QAPI_FW_UPGRADE_ERR_FLASH_READ_FAIL_E;
@@ -611,7 +703,7 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
                         break;
                     }
 
-                    qapi_Crypto_Op_Digest_Update(fw_upgrade_cxt->digest_ctx, (uint8_t *)buffer, nbytes);
+                    fw_Upgrade_Sha256_Update(&fw_upgrade_cxt->image_digest, (uint8_t *)buffer, nbytes);
                     offset += nbytes;
                     total += nbytes;
                 }
@@ -634,8 +726,17 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
 
             case QAPI_FW_UPGRADE_STATE_RECEIVE_DATA_E:
                 fw_Upgrade_Update_Callback(fw_Upgrade_Get_State(), fw_Upgrade_Get_Error_Code());
-                /* Receiving data from FTP server.*/
-                rtn = fw_Upgrade_Plugin_Recv_Data((uint8_t *)buffer, FW_UPGRADE_BUF_SIZE, &received);
+                if( (fw_upgrade_cxt->is_first == 0) && (fw_upgrade_cxt->plugin.fw_Upgrade_Plugin_Recv_Buffer != NULL) ) {
+                    /* image data is used in place from the plugin's receive buffer, the plugin fetches ahead itself */
+                    rtn = fw_Upgrade_Plugin_Recv_Buffer(&data, &received);
+                } else if( (fw_upgrade_cxt->is_first == 0) && (fw_Upgrade_Pipe_Start(buffer) == QAPI_FW_UPGRADE_OK_E) ) {
+                    /* image data is received ahead by the receive pipeline */
+                    rtn = fw_Upgrade_Pipe_Get(&data, &received);
+                } else {
+                    /* Receiving data from FTP server.*/
+                    data = buffer;
+                    rtn = fw_Upgrade_Plugin_Recv_Data((uint8_t *)data, FW_UPGRADE_BUF_SIZE, &received);
+                }
                 if( (rtn == QAPI_FW_UPGRADE_OK_E) && (received > 0) ) {
                     /* handle data */
                     fw_upgrade_cxt->buf_len = received;
@@ -658,7 +759,8 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
             case QAPI_FW_UPGRADE_STATE_PROCESS_CONFIG_FILE_E:
                 fw_Upgrade_Update_Callback(fw_Upgrade_Get_State(), fw_Upgrade_Get_Error_Code());
                 /* parse fw upgrade image Header */
-                if( (rtn = fw_Upgrade_Process_Config_File(buffer)) != QAPI_FW_UPGRADE_OK_E ) {
+                if( (rtn = fw_Upgrade_Process_Config_File(data)) != QAPI_FW_UPGRADE_OK_E ) {
+                    fw_Upgrade_Pipe_Stop();
                     fw_Upgrade_Plugin_Abort();
                     run = 0;
                 }
@@ -666,7 +768,8 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
                 
             case  QAPI_FW_UPGRADE_STATE_PROCESS_IMAGE_E:
                 fw_Upgrade_Update_Callback(fw_Upgrade_Get_State(), fw_Upgrade_Get_Error_Code());
-                if( (rtn = fw_Upgrade_Process_Receive_Image(buffer)) != QAPI_FW_UPGRADE_OK_E ) {
+                if( (rtn = fw_Upgrade_Process_Receive_Image(data)) != QAPI_FW_UPGRADE_OK_E ) {
+                    fw_Upgrade_Pipe_Stop();
                     fw_Upgrade_Plugin_Abort();
                     run = 0;
                 } else if(  fw_Upgrade_Get_State() == QAPI_FW_UPGRADE_STATE_PROCESS_IMAGE_E){
@@ -677,6 +780,7 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
 
             case QAPI_FW_UPGRADE_STATE_DISCONNECT_SERVER_E:
                 fw_Upgrade_Update_Callback(fw_Upgrade_Get_State(), fw_Upgrade_Get_Error_Code());
+                fw_Upgrade_Pipe_Stop();
                 fw_Upgrade_Plugin_Fin();
                 fw_Upgrade_Set_State(QAPI_FW_UPGRADE_STATE_PREPARE_CONNECT_E);
                 break;
@@ -714,10 +818,11 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Process(void)
 
     }  //while(...
 
+    /* receive thread must be out of the plugin before it is finished */
+    fw_Upgrade_Pipe_Stop();
+
     /* free bufer */
-    if(buffer) {
-    	free(buffer);
-    }
+    fw_Upgrade_Pipe_Free(buffer);
     
     //set error code
     if( fw_Upgrade_Get_Session_Status() == FW_UPGRADE_SESSION_CANCEL_E ) {
@@ -769,8 +874,13 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Session_Finalize(qapi_Fw_Upgrade
     }
 
     if( fw_Upgrade_Get_Session_Status() == FW_UPGRADE_SESSION_SUSPEND_E ) {
-    	fw_Upgrade_Session_Prepare_Suspend();
-    	rtn = QAPI_FW_UPGRADE_ERR_SESSION_SUSPEND_E;
+        //session can't be resumed if the image received so far is not in flash
+        if( (rtn = fw_Upgrade_Session_Prepare_Suspend()) == QAPI_FW_UPGRADE_OK_E ) {
+            rtn = QAPI_FW_UPGRADE_ERR_SESSION_SUSPEND_E;
+        } else {
+            fw_Upgrade_Set_Error_Code(rtn);
+            fw_Upgrade_Session_Fin();
+        }
 	} else {
     	fw_Upgrade_Session_Fin();
     }
@@ -1013,7 +1123,8 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Config_File(uint8_t *buf
             ||  (img_hdr->magic == 0)
             ||  (img_hdr->hash_type == 0)
             ||  (img_hdr->disk_size == 0)
-            ||  (img_hdr->disk_size <  img_hdr->image_length) ) {
+            ||  (img_hdr->disk_size <  img_hdr->image_length)
+            ||  ((img_hdr->hash_type & FW_UPGRADE_HASH_TYPE_DELTA) && ((img_hdr->image_id == FS1_IMG_ID) || (img_hdr->image_id == FS2_IMG_ID))) ) {
             FW_UPGRADE_D_PRINTF("firmware upgrade image length setting is not correct\r\n");
             rtn = QAPI_FW_UPGRADE_ERR_INCORRECT_IMAGE_HDR_E;
             goto parse_img_hdr_end;  
@@ -1136,8 +1247,6 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Verify_Image_Hash(fw_Upgrade_Ima
     qapi_Fw_Upgrade_Status_Code_t rtn = QAPI_FW_UPGRADE_OK_E;
     fw_Upgrade_Context_t *fw_upgrade_cxt;
     uint8_t *hash_org, hash_result[FW_UPGRADE_HASH_LEN];
-    uint8_t *hash_buf = NULL;
-    uint32_t len;
         
     fw_upgrade_cxt = fw_Upgrade_Get_Context();
     if( fw_upgrade_cxt == NULL ) {
@@ -1147,22 +1256,13 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Verify_Image_Hash(fw_Upgrade_Ima
     /* get org hash offset at image header */
     hash_org = (uint8_t *) image_hdr + sizeof(fw_Upgrade_Image_Hdr_t) - FW_UPGRADE_HASH_LEN;
 
+    //partial fw upgrade hash covers the erased rest of the partition
     if( fw_upgrade_cxt->format == FW_UPGRADE_FORAMT_PARTIAL_UPGRADE ) {
-        len = image_hdr->disk_size - image_hdr->image_length;
-        hash_buf = (uint8_t *) malloc(len);
-        if( hash_buf == NULL ) {
-            return QAPI_FW_UPGRADE_ERR_INSUFFICIENT_MEMORY_E;    
-        }    
-        memset(hash_buf, 0xff, len);
-        qapi_Crypto_Op_Digest_Update(fw_upgrade_cxt->digest_ctx, hash_buf, len);
+        fw_Upgrade_Sha256_Update_Fill(&fw_upgrade_cxt->image_digest, image_hdr->disk_size - fw_upgrade_cxt->image_digest.count);
     }
     
     /* get result */ 
-    len = FW_UPGRADE_HASH_LEN;
-    qapi_Crypto_Op_Digest_Final(fw_upgrade_cxt->digest_ctx, NULL, 0, hash_result, &len );
-    
-    if( hash_buf != NULL)
-        free(hash_buf);
+    fw_Upgrade_Sha256_Final(&fw_upgrade_cxt->image_digest, hash_result);
     
     /* compare fw upgrade image HASH */
     if( memcmp(hash_org, hash_result, FW_UPGRADE_HASH_LEN) != 0 ) {
@@ -1173,6 +1273,237 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Verify_Image_Hash(fw_Upgrade_Ima
     return rtn;
 }
 
+/*
+ * hash image data and write it at offset of the image partition
+ */
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Write_Image_Data(uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    fw_Upgrade_Context_t *fw_upgrade_cxt;
+    uint32_t block_size, first_block, last_block;
+
+    fw_upgrade_cxt = fw_Upgrade_Get_Context();
+    if( fw_upgrade_cxt == NULL )
+      return QAPI_FW_UPGRADE_ERR_SESSION_NOT_START_E;
+
+    /* get flash block size */
+    qapi_Fw_Upgrade_Get_Flash_Block_Size(&block_size);
+
+    //update firmware upgrade image HASH
+    fw_Upgrade_Sha256_Update(&fw_upgrade_cxt->image_digest, data, len);
+
+    //erase the blocks the data reaches first, the first block is erased when the partition is created
+    //and a block started by an earlier write is erased already
+    first_block = (offset + block_size - 1) / block_size;
+    if( first_block == 0 ) first_block = 1;
+    last_block = (offset + len + block_size - 1) / block_size;
+    if( last_block > first_block ) {
+        if( qapi_Fw_Upgrade_Erase_Partition(fw_upgrade_cxt->partition_hdl, first_block*block_size, (last_block-first_block)*block_size) != QAPI_OK ) {
+            return QAPI_FW_UPGRADE_ERR_FLASH_ERASE_PARTITION_E;
+        }
+    }
+
+    //write flash
+    if( qapi_Fw_Upgrade_Write_Partition(fw_upgrade_cxt->partition_hdl, offset, (char *)data, len) != QAPI_OK ) {
+        return QAPI_FW_UPGRADE_ERR_FLASH_WRITE_PARTITION_E;
+    }
+    return QAPI_FW_UPGRADE_OK_E;
+}
+
+/*
+ * gather image data which comes in small pieces, it is written to flash in FW_UPGRADE_STAGE_SIZE aligned writes
+ */
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Stage_Image_Data(uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    qapi_Fw_Upgrade_Status_Code_t rtn;
+    fw_Upgrade_Context_t *fw_upgrade_cxt;
+    uint32_t n;
+
+    fw_upgrade_cxt = fw_Upgrade_Get_Context();
+    if( fw_upgrade_cxt == NULL )
+      return QAPI_FW_UPGRADE_ERR_SESSION_NOT_START_E;
+
+    //data which doesn't follow the staged data goes after it
+    if( (fw_upgrade_cxt->stage_len != 0) && (offset != (fw_upgrade_cxt->stage_offset + fw_upgrade_cxt->stage_len)) ) {
+        if( (rtn = fw_Upgrade_Flush_Image_Data()) != QAPI_FW_UPGRADE_OK_E ) {
+            return rtn;
+        }
+    }
+
+    //whole aligned pieces need no copy
+    if( (fw_upgrade_cxt->stage_len == 0) && ((offset % FW_UPGRADE_STAGE_SIZE) == 0) && (len >= FW_UPGRADE_STAGE_SIZE) ) {
+        n = len - (len % FW_UPGRADE_STAGE_SIZE);
+        if( (rtn = fw_Upgrade_Write_Image_Data(offset, data, n)) != QAPI_FW_UPGRADE_OK_E ) {
+            return rtn;
+        }
+        offset += n;
+        data += n;
+        len -= n;
+    }
+
+    while( len > 0 ) {
+        if( fw_upgrade_cxt->stage_buf == NULL ) {
+            if( (fw_upgrade_cxt->stage_buf = malloc(FW_UPGRADE_STAGE_SIZE)) == NULL ) {
+                FW_UPGRADE_D_PRINTF("Out of memory error\r\n");
+                return QAPI_FW_UPGRADE_ERR_INSUFFICIENT_MEMORY_E;
+            }
+            fw_upgrade_cxt->stage_len = 0;
+        }
+        if( fw_upgrade_cxt->stage_len == 0 ) {
+            fw_upgrade_cxt->stage_offset = offset;
+        }
+
+        //fill up to the next FW_UPGRADE_STAGE_SIZE boundary of the image
+        n = FW_UPGRADE_STAGE_SIZE - ((fw_upgrade_cxt->stage_offset + fw_upgrade_cxt->stage_len) % FW_UPGRADE_STAGE_SIZE);
+        n = MIN(n, len);
+        memcpy(fw_upgrade_cxt->stage_buf + fw_upgrade_cxt->stage_len, data, n);
+        fw_upgrade_cxt->stage_len += n;
+        offset += n;
+        data += n;
+        len -= n;
+
+        if( ((fw_upgrade_cxt->stage_offset + fw_upgrade_cxt->stage_len) % FW_UPGRADE_STAGE_SIZE) == 0 ) {
+            if( (rtn = fw_Upgrade_Flush_Image_Data()) != QAPI_FW_UPGRADE_OK_E ) {
+                return rtn;
+            }
+        }
+    }
+    return QAPI_FW_UPGRADE_OK_E;
+}
+
+/*
+ * write the staged image data to flash
+ */
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Flush_Image_Data(void)
+{
+    fw_Upgrade_Context_t *fw_upgrade_cxt;
+    uint32_t len;
+
+    fw_upgrade_cxt = fw_Upgrade_Get_Context();
+    if( fw_upgrade_cxt == NULL )
+      return QAPI_FW_UPGRADE_ERR_SESSION_NOT_START_E;
+
+    if( fw_upgrade_cxt->stage_len == 0 ) {
+        return QAPI_FW_UPGRADE_OK_E;
+    }
+    len = fw_upgrade_cxt->stage_len;
+    fw_upgrade_cxt->stage_len = 0;
+    return fw_Upgrade_Write_Image_Data(fw_upgrade_cxt->stage_offset, fw_upgrade_cxt->stage_buf, len);
+}
+
+/*
+ * delta applier source read, the source is the same image at the active FWD
+ */
+static int fw_Upgrade_Delta_Read(void *param, uint32_t offset, uint8_t *buf, uint32_t len)
+{
+    fw_Upgrade_Image_Hdr_t *img_hdr = (fw_Upgrade_Image_Hdr_t *)param;
+    fw_Upgrade_Context_t *fw_upgrade_cxt;
+    uint32_t nbytes = 0;
+
+    fw_upgrade_cxt = fw_Upgrade_Get_Context();
+    if( fw_upgrade_cxt == NULL ) {
+        fw_upgrade_image_rtn = QAPI_FW_UPGRADE_ERR_SESSION_NOT_START_E;
+        return -1;
+    }
+
+    //open active image at first read
+    if( fw_upgrade_cxt->delta_src_hdl == NULL ) {
+        if( qapi_Fw_Upgrade_Find_Partition(qapi_Fw_Upgrade_Get_Active_FWD(NULL, NULL), img_hdr->image_id, &fw_upgrade_cxt->delta_src_hdl) != QAPI_OK ) {
+            fw_upgrade_cxt->delta_src_hdl = NULL;
+            fw_upgrade_image_rtn = QAPI_FW_UPGRADE_ERR_FLASH_IMAGE_NOT_FOUND_E;
+            return -1;
+        }
+    }
+
+    if( (qapi_Fw_Upgrade_Read_Partition(fw_upgrade_cxt->delta_src_hdl, offset, (char *)buf, len, &nbytes) != QAPI_OK) || (nbytes != len) ) {
+        fw_upgrade_image_rtn = QAPI_FW_UPGRADE_ERR_FLASH_READ_FAIL_E;
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * delta applier write of the rebuilt image
+ */
+static int fw_Upgrade_Delta_Write(void *param, uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    fw_Upgrade_Image_Hdr_t *img_hdr = (fw_Upgrade_Image_Hdr_t *)param;
+
+    if( (offset + len) > img_hdr->disk_size ) {
+        fw_upgrade_image_rtn = QAPI_FW_UPGRADE_ERR_INCORRECT_IMAGE_LENGTH_E;
+        return -1;
+    }
+
+    //applier copies and adds in small chunks, flash is written in whole pieces
+    fw_upgrade_image_rtn = fw_Upgrade_Stage_Image_Data(offset, data, len);
+    return (fw_upgrade_image_rtn == QAPI_FW_UPGRADE_OK_E) ? 0 : -1;
+}
+
+/*
+ * pass image data to the delta applier, or write it at offset for a full image
+ */
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Store_Image_Data(fw_Upgrade_Image_Hdr_t *img_hdr, uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    fw_Upgrade_Context_t *fw_upgrade_cxt;
+    fw_Upgrade_Delta_IO_t delta_io;
+    int delta_rtn;
+
+    fw_upgrade_cxt = fw_Upgrade_Get_Context();
+    if( fw_upgrade_cxt == NULL )
+      return QAPI_FW_UPGRADE_ERR_SESSION_NOT_START_E;
+
+    if( (img_hdr->hash_type & FW_UPGRADE_HASH_TYPE_DELTA) == 0 ) {
+        //hash and write flash
+        return fw_Upgrade_Write_Image_Data(offset, data, len);
+    }
+
+    //rebuild image from the active one, the applier writes it as far as the delta goes
+    delta_io.read = fw_Upgrade_Delta_Read;
+    delta_io.write = fw_Upgrade_Delta_Write;
+    delta_io.param = img_hdr;
+    fw_upgrade_image_rtn = QAPI_FW_UPGRADE_OK_E;
+    delta_rtn = fw_Upgrade_Delta_Apply(&fw_upgrade_cxt->delta, &delta_io, data, len);
+    if( delta_rtn == FW_UPGRADE_DELTA_OK ) {
+        return QAPI_FW_UPGRADE_OK_E;
+    }
+
+    FW_UPGRADE_D_PRINTF("delta image fails %d\r\n", delta_rtn);
+    if( delta_rtn == FW_UPGRADE_DELTA_ERR_SOURCE ) {
+        return QAPI_FW_UPGRADE_ERR_DELTA_SOURCE_MISMATCH_E;
+    } else if( delta_rtn == FW_UPGRADE_DELTA_ERR_IO ) {
+        return fw_upgrade_image_rtn;
+    }
+    return QAPI_FW_UPGRADE_ERR_INCORRECT_IMAGE_HDR_E;
+}
+
+/*
+ * decompressor output, the decompressed data is stored as a received image
+ */
+static int fw_Upgrade_Lz_Output(void *param, const uint8_t *data, uint32_t len)
+{
+    fw_Upgrade_Image_Hdr_t *img_hdr = (fw_Upgrade_Image_Hdr_t *)param;
+    fw_Upgrade_Context_t *fw_upgrade_cxt;
+
+    fw_upgrade_cxt = fw_Upgrade_Get_Context();
+    if( fw_upgrade_cxt == NULL ) {
+        fw_upgrade_image_rtn = QAPI_FW_UPGRADE_ERR_SESSION_NOT_START_E;
+        return -1;
+    }
+
+    //decompressed full image has to fit the partition, a delta checks its own writes
+    if( ((img_hdr->hash_type & FW_UPGRADE_HASH_TYPE_DELTA) == 0) && ((fw_upgrade_cxt->lz.out_count + len) > img_hdr->disk_size) ) {
+        fw_upgrade_image_rtn = QAPI_FW_UPGRADE_ERR_INCORRECT_IMAGE_LENGTH_E;
+        return -1;
+    }
+
+    if( img_hdr->hash_type & FW_UPGRADE_HASH_TYPE_DELTA ) {
+        fw_upgrade_image_rtn = fw_Upgrade_Store_Image_Data(img_hdr, fw_upgrade_cxt->lz.out_count, data, len);
+    } else {
+        //decompressor hands out a match or a literal run at a time, flash is written in whole pieces
+        fw_upgrade_image_rtn = fw_Upgrade_Stage_Image_Data(fw_upgrade_cxt->lz.out_count, data, len);
+    }
+    return (fw_upgrade_image_rtn == QAPI_FW_UPGRADE_OK_E) ? 0 : -1;
+}
+
 /*
  * process firmware upgrade image
  */
@@ -1182,6 +1513,7 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Receive_Image(uint8_t *b
     fw_Upgrade_Context_t *fw_upgrade_cxt;
     fw_Upgrade_Image_Hdr_t *img_hdr;
     uint32_t buf_len = 0, write_len, block_size;
+    int lz_rtn;
 
     fw_upgrade_cxt = fw_Upgrade_Get_Context();
     if( fw_upgrade_cxt == NULL )
@@ -1273,10 +1605,13 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Receive_Image(uint8_t *b
                 
                 continue;
             }
-            //reset crypto engine
-            if (qapi_Crypto_Op_Reset(fw_upgrade_cxt->digest_ctx) != QAPI_OK) {
-                rtn = QAPI_FW_UPGRADE_ERR_CRYPTO_FAIL_E;
-                break;
+            //start image digest
+            fw_Upgrade_Sha256_Init(&fw_upgrade_cxt->image_digest);
+            if( img_hdr->hash_type & FW_UPGRADE_HASH_TYPE_DELTA ) {
+                fw_Upgrade_Delta_Init(&fw_upgrade_cxt->delta);
+            }
+            if( img_hdr->hash_type & FW_UPGRADE_HASH_TYPE_COMPRESSED ) {
+                fw_Upgrade_Lz_Init(&fw_upgrade_cxt->lz);
             }
         }
       
@@ -1292,30 +1627,19 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Receive_Image(uint8_t *b
             write_len = MIN(buf_len, (fw_upgrade_cxt->image_wrt_length - fw_upgrade_cxt->image_wrt_count));
         }
 
-        //update firmware upgrade image HASH
-        qapi_Crypto_Op_Digest_Update(fw_upgrade_cxt->digest_ctx, (uint8_t *)&buffer[fw_upgrade_cxt->buf_offset], write_len);
-
-        //check flash block if need erase first
-        {
-            uint32_t first_block, last_block;
-        
-            if(  (fw_upgrade_cxt->image_wrt_count / block_size) != ((fw_upgrade_cxt->image_wrt_count + write_len - 1) / block_size ) ) {
-                first_block = fw_upgrade_cxt->image_wrt_count / block_size+1;
-                
-                last_block = (fw_upgrade_cxt->image_wrt_count + write_len) / block_size;
-                if(((fw_upgrade_cxt->image_wrt_count + write_len) % block_size) != 0 ) last_block++;
-                // erase blocks
-                if( qapi_Fw_Upgrade_Erase_Partition(fw_upgrade_cxt->partition_hdl, first_block*block_size, (last_block-first_block)*block_size) != QAPI_OK ) {
-                    rtn = QAPI_FW_UPGRADE_ERR_FLASH_ERASE_PARTITION_E;
-                    break;
-                }
+        if( img_hdr->hash_type & FW_UPGRADE_HASH_TYPE_COMPRESSED ) {
+            //decompress on the way to the flash
+            fw_upgrade_image_rtn = QAPI_FW_UPGRADE_OK_E;
+            lz_rtn = fw_Upgrade_Lz_Apply(&fw_upgrade_cxt->lz, fw_Upgrade_Lz_Output, img_hdr, &buffer[fw_upgrade_cxt->buf_offset], write_len);
+            if( lz_rtn != FW_UPGRADE_LZ_OK ) {
+                FW_UPGRADE_D_PRINTF("compressed image fails %d\r\n", lz_rtn);
+                rtn = (lz_rtn == FW_UPGRADE_LZ_ERR_OUTPUT) ? fw_upgrade_image_rtn : QAPI_FW_UPGRADE_ERR_INCORRECT_IMAGE_HDR_E;
+                break;
+            }
+        } else {
+            if( (rtn = fw_Upgrade_Store_Image_Data(img_hdr, fw_upgrade_cxt->image_wrt_count, &buffer[fw_upgrade_cxt->buf_offset], write_len)) != QAPI_FW_UPGRADE_OK_E ) {
+                break;
             }
-        }
-        
-        //write flash
-        if( qapi_Fw_Upgrade_Write_Partition(fw_upgrade_cxt->partition_hdl, fw_upgrade_cxt->image_wrt_count, (char *)&buffer[fw_upgrade_cxt->buf_offset], write_len) != QAPI_OK ) {
-            rtn = QAPI_FW_UPGRADE_ERR_FLASH_WRITE_PARTITION_E;
-            break;
         }
         
         //update record
@@ -1325,6 +1649,28 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Receive_Image(uint8_t *b
     
         //flash one image, move to next one 
         if( fw_upgrade_cxt->image_wrt_count >= fw_upgrade_cxt->image_wrt_length ) {
+            //compressed image has to decompress to the whole image
+            if( (img_hdr->hash_type & FW_UPGRADE_HASH_TYPE_COMPRESSED) && !fw_Upgrade_Lz_Done(&fw_upgrade_cxt->lz) ) {
+                rtn = QAPI_FW_UPGRADE_ERR_INCORRECT_IMAGE_LENGTH_E;
+                break;
+            }
+            if( img_hdr->hash_type & FW_UPGRADE_HASH_TYPE_DELTA ) {
+                //delta has to rebuild the whole image
+                if( !fw_Upgrade_Delta_Done(&fw_upgrade_cxt->delta) ) {
+                    rtn = QAPI_FW_UPGRADE_ERR_INCORRECT_IMAGE_LENGTH_E;
+                    break;
+                }
+                if( fw_upgrade_cxt->delta_src_hdl != NULL ) {
+                    qapi_Fw_Upgrade_Close_Partition(fw_upgrade_cxt->delta_src_hdl);
+                    fw_upgrade_cxt->delta_src_hdl = NULL;
+                }
+            }
+
+            //write out the staged end of the image
+            if( (rtn = fw_Upgrade_Flush_Image_Data()) != QAPI_FW_UPGRADE_OK_E ) {
+                break;
+            }
+
             //verify image HASH
             if( (rtn = fw_Upgrade_Verify_Image_Hash(img_hdr)) != QAPI_FW_UPGRADE_OK_E ) {
                 break;              
@@ -1356,15 +1702,6 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Process_Receive_Image(uint8_t *b
             }
         }
         
-        //check if need erase block for next round
-        if(  ((fw_upgrade_cxt->image_wrt_count % block_size) == 0) && (fw_upgrade_cxt->image_wrt_length >0) ) {
-            // erase block
-            if( qapi_Fw_Upgrade_Erase_Partition(fw_upgrade_cxt->partition_hdl, fw_upgrade_cxt->image_wrt_count, block_size) != QAPI_OK ) {
-                rtn = QAPI_FW_UPGRADE_ERR_FLASH_ERASE_PARTITION_E;
-                break;
-            }
-        }
-
         if( fw_upgrade_cxt->format == FW_UPGRADE_FORAMT_PARTIAL_UPGRADE ) {
             /* it is done for this round */
             break;
@@ -1663,6 +2000,25 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Plugin_Recv_Data(uint8_t *buffer
     return fw_upgrade_cxt->plugin.fw_Upgrade_Plugin_Recv_Data(buffer, buf_len, ret_size);
 }
 
+/*
+ * call fw upgrade plugin's Recv_Buffer callback, at most one flash block is taken at a time
+ */
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Plugin_Recv_Buffer(uint8_t **buffer, uint32_t *ret_size)
+{
+    fw_Upgrade_Context_t *fw_upgrade_cxt;
+    uint32_t block_size;
+    
+    fw_upgrade_cxt = fw_Upgrade_Get_Context();
+    if( fw_upgrade_cxt == NULL )
+      return QAPI_FW_UPGRADE_ERR_SESSION_NOT_START_E;
+ 
+    //hand out no more than a flash block at a time, a buffer if the block size is unknown
+    if( (qapi_Fw_Upgrade_Get_Flash_Block_Size(&block_size) != QAPI_OK) || (block_size == 0) ) {
+        block_size = FW_UPGRADE_BUF_SIZE;
+    }
+    return fw_upgrade_cxt->plugin.fw_Upgrade_Plugin_Recv_Buffer(buffer, block_size, ret_size);
+}
+
 /*
  * call fw upgrade plugin's Fin callback
  */
@@ -1732,6 +2088,274 @@ static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Plugin_Resume(void)
     return ret;
 }
 
+/*
+ * receive thread of the pipeline, fills the free buffers from the plugin until
+ * all bytes expected on this connection are received or the pipeline is stopped
+ */
+static void fw_Upgrade_Pipe_Thread(void *Thread_Parameter)
+{
+    fw_Upgrade_Pipe_t *pipe = &fw_upgrade_pipe;
+    qapi_Fw_Upgrade_Status_Code_t rtn;
+    uint32_t slot, len, received, filled = 0;
+    uint8_t  abandoned = 0;
+    uint8_t *buf = NULL;
+
+    while( (pipe->stop == 0) && (pipe->budget > 0) )
+    {
+        if( TAKE_LOCK(Fw_Upgrade_Mutex) ) {
+            filled = pipe->filled;
+            RELEASE_LOCK(Fw_Upgrade_Mutex);
+        }
+
+        //wait for the session thread to give a buffer back
+        if( filled >= FW_UPGRADE_BUF_COUNT ) {
+            qurt_signal_wait(&pipe->signal, FWUP_PIPE_BUF_FREE_SIG_MASK, QURT_SIGNAL_ATTR_CLEAR_MASK);
+            continue;
+        }
+
+        //never read past the data expected, the plugin may block waiting for it
+        slot = pipe->tail;
+        len = (pipe->budget < FW_UPGRADE_BUF_SIZE) ? pipe->budget : FW_UPGRADE_BUF_SIZE;
+        received = 0;
+        rtn = fw_Upgrade_Plugin_Recv_Data(&pipe->buf[slot * FW_UPGRADE_BUF_SIZE], len, &received);
+        if( (rtn != QAPI_FW_UPGRADE_OK_E) || (received == 0) || (received >= pipe->budget) ) {
+            pipe->budget = 0;
+        } else {
+            pipe->budget -= received;
+        }
+
+        pipe->len[slot] = received;
+        pipe->status[slot] = rtn;
+        pipe->tail = (slot + 1) % FW_UPGRADE_BUF_COUNT;
+
+        if( TAKE_LOCK(Fw_Upgrade_Mutex) ) {
+            pipe->filled++;
+            RELEASE_LOCK(Fw_Upgrade_Mutex);
+        }
+        qurt_signal_set(&pipe->signal, FWUP_PIPE_BUF_FILLED_SIG_MASK);
+    }
+
+    //the signal may be deleted as soon as done is seen, so set both under the lock
+    if( TAKE_LOCK(Fw_Upgrade_Mutex) ) {
+        pipe->done = 1;
+        qurt_signal_set(&pipe->signal, FWUP_PIPE_THREAD_DONE_SIG_MASK);
+        if( pipe->abandoned != 0 ) {
+            //the session stopped waiting, clean up for it
+            abandoned = 1;
+            pipe->abandoned = 0;
+            if( pipe->released != 0 ) {
+                buf = pipe->buf;
+                pipe->released = 0;
+            }
+        }
+        RELEASE_LOCK(Fw_Upgrade_Mutex);
+    }
+
+    if( abandoned != 0 ) {
+        qurt_signal_delete(&pipe->signal);
+        if( buf ) {
+            free(buf);
+        }
+    }
+
+    /* Terminate the thread. */
+    qurt_thread_stop();
+    return;
+}
+
+/*
+ * start the receive pipeline for the image data expected on this connection,
+ * returns OK if the pipeline is running
+ *    buffer:    FW_UPGRADE_BUF_COUNT buffers of FW_UPGRADE_BUF_SIZE
+ */
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Pipe_Start(uint8_t *buffer)
+{
+    fw_Upgrade_Pipe_t *pipe = &fw_upgrade_pipe;
+    fw_Upgrade_Context_t *fw_upgrade_cxt;
+    fw_Upgrade_Image_Hdr_t *img_hdr;
+    qurt_thread_attr_t    Thread_Attribte;
+    qurt_thread_t         Thread_Handle;
+    uint32_t i, budget = 0;
+    uint8_t abandoned = 0;
+
+    if( pipe->running != 0 ) {
+        return QAPI_FW_UPGRADE_OK_E;
+    }
+
+    //a receive thread left behind still uses the pipe, receive without it
+    if( TAKE_LOCK(Fw_Upgrade_Mutex) ) {
+        abandoned = pipe->abandoned;
+        RELEASE_LOCK(Fw_Upgrade_Mutex);
+    }
+    if( abandoned != 0 ) {
+        return QAPI_FW_UPGRADE_ERROR_E;
+    }
+
+    fw_upgrade_cxt = fw_Upgrade_Get_Context();
+    if( (FW_UPGRADE_BUF_COUNT < 2) || (fw_upgrade_cxt == NULL) || (fw_upgrade_image_hdr == NULL) ) {
+        return QAPI_FW_UPGRADE_ERROR_E;
+    }
+
+    //bytes expected: rest of the current image for partial fw upgrade, rest of all images for all-in-one
+    img_hdr = fw_upgrade_image_hdr;
+    img_hdr += fw_upgrade_cxt->image_index;
+    for( i = fw_upgrade_cxt->image_index; i < fw_upgrade_cxt->total_images; i++, img_hdr++ )
+    {
+        budget += img_hdr->image_length;
+        if( fw_upgrade_cxt->format == FW_UPGRADE_FORAMT_PARTIAL_UPGRADE )
+            break;
+    }
+    if( fw_upgrade_cxt->image_wrt_length != 0 ) {
+        budget = (budget > fw_upgrade_cxt->image_wrt_count) ? (budget - fw_upgrade_cxt->image_wrt_count) : 0;
+    }
+    if( budget == 0 ) {
+        return QAPI_FW_UPGRADE_ERROR_E;
+    }
+
+    pipe->buf = buffer;
+    pipe->head = 0;
+    pipe->tail = 0;
+    pipe->filled = 0;
+    pipe->budget = budget;
+    pipe->held = 0;
+    pipe->stop = 0;
+    pipe->done = 0;
+    qurt_signal_create(&pipe->signal);
+
+    /* Create the receive thread. */
+    qurt_thread_attr_init(&Thread_Attribte);
+    qurt_thread_attr_set_name(&Thread_Attribte, "FWUP_Recv");
+    qurt_thread_attr_set_priority(&Thread_Attribte, FWUP_THREAD_PRIORITY);
+    qurt_thread_attr_set_stack_size(&Thread_Attribte, THREAD_STACK_SIZE);
+    if( qurt_thread_create(&Thread_Handle, &Thread_Attribte, fw_Upgrade_Pipe_Thread, (void *)NULL) != QURT_EOK ) {
+        FW_UPGRADE_D_PRINTF("fail to create receive thread\r\n");
+        qurt_signal_delete(&pipe->signal);
+        return QAPI_FW_UPGRADE_ERR_CREATE_THREAD_ERROR_E;
+    }
+
+    pipe->running = 1;
+    return QAPI_FW_UPGRADE_OK_E;
+}
+
+/*
+ * get next received buffer from the pipeline, the buffer got last time is
+ * given back to the receive thread
+ *    buffer:    received data buffer
+ *  ret_size:    data size in buffer, 0 if no more data
+ */
+static qapi_Fw_Upgrade_Status_Code_t fw_Upgrade_Pipe_Get(uint8_t **buffer, uint32_t *ret_size)
+{
+    fw_Upgrade_Pipe_t *pipe = &fw_upgrade_pipe;
+    uint32_t filled = 0;
+    uint8_t  done = 0;
+
+    *ret_size = 0;
+
+    if( pipe->held != 0 ) {
+        pipe->held = 0;
+        pipe->head = (pipe->head + 1) % FW_UPGRADE_BUF_COUNT;
+        if( TAKE_LOCK(Fw_Upgrade_Mutex) ) {
+            pipe->filled--;
+            RELEASE_LOCK(Fw_Upgrade_Mutex);
+        }
+        qurt_signal_set(&pipe->signal, FWUP_PIPE_BUF_FREE_SIG_MASK);
+    }
+
+    while(1)
+    {
+        if( TAKE_LOCK(Fw_Upgrade_Mutex) ) {
+            filled = pipe->filled;
+            done = pipe->done;
+            RELEASE_LOCK(Fw_Upgrade_Mutex);
+        }
+        if( filled > 0 ) {
+            break;
+        }
+        if( done != 0 ) {
+            //receive thread finished and everything is processed
+            return QAPI_FW_UPGRADE_OK_E;
+        }
+        qurt_signal_wait(&pipe->signal, FWUP_PIPE_BUF_FILLED_SIG_MASK | FWUP_PIPE_THREAD_DONE_SIG_MASK, QURT_SIGNAL_ATTR_CLEAR_MASK);
+    }
+
+    pipe->held = 1;
+    *buffer = &pipe->buf[pipe->head * FW_UPGRADE_BUF_SIZE];
+    *ret_size = pipe->len[pipe->head];
+    return pipe->status[pipe->head];
+}
+
+/*
+ * stop the receive pipeline, returns when the receive thread is out of the
+ * plugin so the plugin can be finished or aborted. A receive thread blocked
+ * in the plugin for FWUP_PIPE_STOP_TIMEOUT_MS is left behind, it cleans up
+ * the pipe when the plugin lets it go
+ */
+static void fw_Upgrade_Pipe_Stop(void)
+{
+    fw_Upgrade_Pipe_t *pipe = &fw_upgrade_pipe;
+    uint32 signals = 0;
+    uint8_t done = 0;
+
+    if( pipe->running == 0 ) {
+        return;
+    }
+
+    pipe->stop = 1;
+    qurt_signal_set(&pipe->signal, FWUP_PIPE_BUF_FREE_SIG_MASK);
+
+    if( TAKE_LOCK(Fw_Upgrade_Mutex) ) {
+        done = pipe->done;
+        RELEASE_LOCK(Fw_Upgrade_Mutex);
+    }
+    if( done == 0 ) {
+        //only the receive thread's exit sets this signal
+        qurt_signal_wait_timed(&pipe->signal, FWUP_PIPE_THREAD_DONE_SIG_MASK, QURT_SIGNAL_ATTR_CLEAR_MASK, &signals,
+                qurt_timer_convert_time_to_ticks(FWUP_PIPE_STOP_TIMEOUT_MS, QURT_TIME_MSEC));
+
+        if( TAKE_LOCK(Fw_Upgrade_Mutex) ) {
+            done = pipe->done;
+            if( done == 0 ) {
+                pipe->abandoned = 1;
+            }
+            RELEASE_LOCK(Fw_Upgrade_Mutex);
+        }
+    }
+
+    if( done != 0 ) {
+        qurt_signal_delete(&pipe->signal);
+    } else {
+        FW_UPGRADE_D_PRINTF("receive thread is stuck in the plugin, left behind\r\n");
+    }
+    pipe->held = 0;
+    pipe->running = 0;
+}
+
+/*
+ * free the pipeline buffers at the end of the session, a receive thread left
+ * behind in the plugin frees them when it gets out
+ *    buffer:    FW_UPGRADE_BUF_COUNT buffers of FW_UPGRADE_BUF_SIZE
+ */
+static void fw_Upgrade_Pipe_Free(uint8_t *buffer)
+{
+    fw_Upgrade_Pipe_t *pipe = &fw_upgrade_pipe;
+
+    if( buffer == NULL ) {
+        return;
+    }
+
+    if( TAKE_LOCK(Fw_Upgrade_Mutex) ) {
+        if( (pipe->abandoned != 0) && (pipe->buf == buffer) ) {
+            pipe->released = 1;
+            buffer = NULL;
+        }
+        RELEASE_LOCK(Fw_Upgrade_Mutex);
+    }
+
+    if( buffer ) {
+        free(buffer);
+    }
+}
+
 /*
  * get Firmware Upgrade Scheme Parameter from DEVCFG
  */
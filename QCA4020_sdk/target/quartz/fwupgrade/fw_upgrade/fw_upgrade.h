@@ -23,6 +23,9 @@
 #ifndef _FW_UPGRADE_H
 #define _FW_UPGRADE_H
 #include <qapi/qapi_crypto.h>
+#include "fw_upgrade_sha256.h"
+#include "fw_upgrade_delta.h"
+#include "fw_upgrade_lz.h"
 
 /**********************************************************************************************************/
 /* Firmware Upgrade definition                                                                            */      
@@ -30,7 +33,15 @@
 #define OM_SMEM_FW_UPGRADE_ID_SESSION_CXT       0x18
 #define OM_SMEM_FW_UPGRADE_ID_IMG_HDR           0x19
 
+#ifndef FW_UPGRADE_BUF_SIZE
 #define FW_UPGRADE_BUF_SIZE                 2048
+#endif
+#ifndef FW_UPGRADE_BUF_COUNT
+#define FW_UPGRADE_BUF_COUNT                3                                            //receive buffers, 1 disables the receive pipeline
+#endif
+#ifndef FW_UPGRADE_STAGE_SIZE
+#define FW_UPGRADE_STAGE_SIZE               FW_UPGRADE_BUF_SIZE                          //image data is gathered to this size before it is written to flash
+#endif
 #define FW_UPGRADE_HASH_LEN                 QAPI_CRYPTO_SHA256_DIGEST_BYTES              //32B
 #define FW_UPGRADE_INTERFACE_NAME_LEN       32
 #define FW_UPGRADE_URL_LEN                  256
@@ -38,6 +49,8 @@
 #define FW_UPGRADE_URL_TOTAL_LEN            (FW_UPGRADE_URL_LEN + FW_UPGRADE_FILENAME_LEN)
 #define FW_UPGRADE_MAX_IMAGES_NUM           30
 #define FW_UPGRADE_FORAMT_PARTIAL_UPGRADE   1
+#define FW_UPGRADE_HASH_TYPE_DELTA          0x80000000                                   //hash_type flag: image is a delta against the active image
+#define FW_UPGRADE_HASH_TYPE_COMPRESSED     0x40000000                                   //hash_type flag: image is compressed
 
 #define QAPI_FU_FWD_RANK_TRIAL		0xFFFFFFFF
 #define QAPI_FU_FWD_RANK_GOLDEN		0x00000000
@@ -122,6 +135,13 @@ typedef struct {
     qapi_Fw_Upgrade_Plugin_t plugin;
     qapi_Fw_Upgrade_CB_t     fw_upgrade_cb;
     qapi_Crypto_Op_Hdl_t     digest_ctx;        /* crypto ctx */
+    fw_Upgrade_Sha256_Ctx_t  image_digest;      /* digest of the image being received, kept over suspend */
+    fw_Upgrade_Delta_Ctx_t   delta;             /* delta applier state of the image being received */
+    fw_Upgrade_Lz_Ctx_t      lz;                /* decompressor state and window of the image being received */
+    qapi_Part_Hdl_t          delta_src_hdl;     /* active image the delta is applied to */
+    uint8_t  *stage_buf;     /* image data not written to flash yet */
+    uint32_t  stage_offset;  /* image offset of the staged data */
+    uint32_t  stage_len;     /* staged data length */
     uint8_t  *config_buf;    /* buffer to store config file before parse */
     
     uint32_t  data_ready_len;
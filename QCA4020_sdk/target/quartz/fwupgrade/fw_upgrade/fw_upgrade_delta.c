@@ -0,0 +1,277 @@
+/*
+* Copyright (c) 2017-2018 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*****************************************************************************************************************************/
+/*                                                                                                                           */
+/*       Firmware Upgrade delta image                                                                                        */
+/*                                                                                                                           */
+/*****************************************************************************************************************************/
+#include <stdint.h>
+#include <string.h>
+#include "fw_upgrade_sha256.h"
+#include "fw_upgrade_delta.h"
+
+#define FW_UPGRADE_DELTA_CHUNK              128                 /* stack buffer for source bytes */
+
+enum {
+    FW_UPGRADE_DELTA_STATE_HDR = 0,
+    FW_UPGRADE_DELTA_STATE_OP,
+    FW_UPGRADE_DELTA_STATE_ADD_OFFSET,
+    FW_UPGRADE_DELTA_STATE_ADD_LEN,
+    FW_UPGRADE_DELTA_STATE_ADD_SAME,
+    FW_UPGRADE_DELTA_STATE_ADD_DIFF_LEN,
+    FW_UPGRADE_DELTA_STATE_ADD_DIFF,
+    FW_UPGRADE_DELTA_STATE_DATA_LEN,
+    FW_UPGRADE_DELTA_STATE_DATA,
+    FW_UPGRADE_DELTA_STATE_DONE,
+};
+
+/*
+ * add one byte to the varint, return 1 when the varint is complete
+ */
+static int fw_Upgrade_Delta_Varint(fw_Upgrade_Delta_Ctx_t *ctx, uint8_t c)
+{
+    if( ctx->shift > 28 ) {
+        return FW_UPGRADE_DELTA_ERR_FORMAT;
+    }
+    ctx->varint |= (uint32_t)(c & 0x7F) << ctx->shift;
+    ctx->shift += 7;
+    if( c & 0x80 ) {
+        return 0;
+    }
+    ctx->shift = 0;
+    return 1;
+}
+
+/*
+ * check the source image against the header hash
+ */
+static int fw_Upgrade_Delta_Check_Source(fw_Upgrade_Delta_Ctx_t *ctx, const fw_Upgrade_Delta_IO_t *io)
+{
+    fw_Upgrade_Sha256_Ctx_t sha;
+    uint8_t buf[FW_UPGRADE_DELTA_CHUNK];
+    uint8_t digest[FW_UPGRADE_SHA256_DIGEST_LEN];
+    uint32_t offset, n;
+
+    fw_Upgrade_Sha256_Init(&sha);
+    for( offset = 0; offset < ctx->hdr.source_length; offset += n )
+    {
+        n = ctx->hdr.source_length - offset;
+        if( n > sizeof(buf) )
+            n = sizeof(buf);
+        if( io->read(io->param, offset, buf, n) != 0 ) {
+            return FW_UPGRADE_DELTA_ERR_IO;
+        }
+        fw_Upgrade_Sha256_Update(&sha, buf, n);
+    }
+    fw_Upgrade_Sha256_Final(&sha, digest);
+
+    if( memcmp(digest, ctx->hdr.source_hash, sizeof(digest)) != 0 ) {
+        return FW_UPGRADE_DELTA_ERR_SOURCE;
+    }
+    return FW_UPGRADE_DELTA_OK;
+}
+
+/*
+ * write len source bytes from src_pos, plus the changed bytes if diff is not NULL
+ */
+static int fw_Upgrade_Delta_Copy(fw_Upgrade_Delta_Ctx_t *ctx, const fw_Upgrade_Delta_IO_t *io, const uint8_t *diff, uint32_t len)
+{
+    uint8_t buf[FW_UPGRADE_DELTA_CHUNK];
+    uint32_t i, n;
+
+    while( len > 0 )
+    {
+        n = (len > sizeof(buf)) ? sizeof(buf) : len;
+        if( io->read(io->param, ctx->src_pos, buf, n) != 0 ) {
+            return FW_UPGRADE_DELTA_ERR_IO;
+        }
+        if( diff != NULL ) {
+            for( i = 0; i < n; i++ )
+                buf[i] += diff[i];
+            diff += n;
+        }
+        if( io->write(io->param, ctx->out_count, buf, n) != 0 ) {
+            return FW_UPGRADE_DELTA_ERR_IO;
+        }
+        ctx->src_pos += n;
+        ctx->out_count += n;
+        ctx->remaining -= n;
+        len -= n;
+    }
+    return FW_UPGRADE_DELTA_OK;
+}
+
+/*
+ * go to next command, or finish once the whole new image is written
+ */
+static void fw_Upgrade_Delta_Next(fw_Upgrade_Delta_Ctx_t *ctx)
+{
+    ctx->state = (ctx->out_count == ctx->hdr.target_length) ? FW_UPGRADE_DELTA_STATE_DONE : FW_UPGRADE_DELTA_STATE_OP;
+}
+
+void fw_Upgrade_Delta_Init(fw_Upgrade_Delta_Ctx_t *ctx)
+{
+    memset(ctx, 0, sizeof(fw_Upgrade_Delta_Ctx_t));
+    ctx->state = FW_UPGRADE_DELTA_STATE_HDR;
+}
+
+int fw_Upgrade_Delta_Apply(fw_Upgrade_Delta_Ctx_t *ctx, const fw_Upgrade_Delta_IO_t *io, const uint8_t *data, uint32_t len)
+{
+    uint32_t n;
+    int32_t  offset;
+    int rtn;
+
+    while( len > 0 )
+    {
+        switch( ctx->state )
+        {
+        case FW_UPGRADE_DELTA_STATE_HDR:
+            n = sizeof(fw_Upgrade_Delta_Hdr_t) - ctx->hdr_count;
+            if( n > len )
+                n = len;
+            memcpy((uint8_t *)&ctx->hdr + ctx->hdr_count, data, n);
+            ctx->hdr_count += n;
+            data += n;
+            len -= n;
+            if( ctx->hdr_count < sizeof(fw_Upgrade_Delta_Hdr_t) )
+                break;
+
+            if( ctx->hdr.magic != FW_UPGRADE_DELTA_MAGIC ) {
+                return FW_UPGRADE_DELTA_ERR_FORMAT;
+            }
+            rtn = fw_Upgrade_Delta_Check_Source(ctx, io);
+            if( rtn != FW_UPGRADE_DELTA_OK ) {
+                return rtn;
+            }
+            fw_Upgrade_Delta_Next(ctx);
+            break;
+
+        case FW_UPGRADE_DELTA_STATE_OP:
+            if( *data == FW_UPGRADE_DELTA_OP_ADD ) {
+                ctx->state = FW_UPGRADE_DELTA_STATE_ADD_OFFSET;
+            } else if( *data == FW_UPGRADE_DELTA_OP_DATA ) {
+                ctx->state = FW_UPGRADE_DELTA_STATE_DATA_LEN;
+            } else {
+                return FW_UPGRADE_DELTA_ERR_FORMAT;
+            }
+            ctx->varint = 0;
+            data++;
+            len--;
+            break;
+
+        case FW_UPGRADE_DELTA_STATE_ADD_OFFSET:
+        case FW_UPGRADE_DELTA_STATE_ADD_LEN:
+        case FW_UPGRADE_DELTA_STATE_ADD_SAME:
+        case FW_UPGRADE_DELTA_STATE_ADD_DIFF_LEN:
+        case FW_UPGRADE_DELTA_STATE_DATA_LEN:
+            rtn = fw_Upgrade_Delta_Varint(ctx, *data);
+            data++;
+            len--;
+            if( rtn < 0 ) {
+                return rtn;
+            }
+            if( rtn == 0 )
+                break;
+
+            n = ctx->varint;
+            ctx->varint = 0;
+            if( ctx->state == FW_UPGRADE_DELTA_STATE_ADD_OFFSET ) {
+                //zigzag, source offset may go backwards
+                offset = (int32_t)(n >> 1) ^ -(int32_t)(n & 1);
+                ctx->src_pos += offset;
+                ctx->state = FW_UPGRADE_DELTA_STATE_ADD_LEN;
+            } else if( ctx->state == FW_UPGRADE_DELTA_STATE_ADD_LEN ) {
+                if( n == 0 || n > ctx->hdr.target_length - ctx->out_count ||
+                    ctx->src_pos > ctx->hdr.source_length || n > ctx->hdr.source_length - ctx->src_pos ) {
+                    return FW_UPGRADE_DELTA_ERR_FORMAT;
+                }
+                ctx->remaining = n;
+                ctx->state = FW_UPGRADE_DELTA_STATE_ADD_SAME;
+            } else if( ctx->state == FW_UPGRADE_DELTA_STATE_ADD_SAME ) {
+                if( n > ctx->remaining ) {
+                    return FW_UPGRADE_DELTA_ERR_FORMAT;
+                }
+                rtn = fw_Upgrade_Delta_Copy(ctx, io, NULL, n);
+                if( rtn != FW_UPGRADE_DELTA_OK ) {
+                    return rtn;
+                }
+                if( ctx->remaining == 0 )
+                    fw_Upgrade_Delta_Next(ctx);
+                else
+                    ctx->state = FW_UPGRADE_DELTA_STATE_ADD_DIFF_LEN;
+            } else if( ctx->state == FW_UPGRADE_DELTA_STATE_ADD_DIFF_LEN ) {
+                if( n == 0 || n > ctx->remaining ) {
+                    return FW_UPGRADE_DELTA_ERR_FORMAT;
+                }
+                ctx->run = n;
+                ctx->state = FW_UPGRADE_DELTA_STATE_ADD_DIFF;
+            } else {
+                if( n == 0 || n > ctx->hdr.target_length - ctx->out_count ) {
+                    return FW_UPGRADE_DELTA_ERR_FORMAT;
+                }
+                ctx->remaining = n;
+                ctx->state = FW_UPGRADE_DELTA_STATE_DATA;
+            }
+            break;
+
+        case FW_UPGRADE_DELTA_STATE_ADD_DIFF:
+            n = (ctx->run > len) ? len : ctx->run;
+            rtn = fw_Upgrade_Delta_Copy(ctx, io, data, n);
+            if( rtn != FW_UPGRADE_DELTA_OK ) {
+                return rtn;
+            }
+            ctx->run -= n;
+            data += n;
+            len -= n;
+            if( ctx->run > 0 )
+                break;
+            if( ctx->remaining == 0 )
+                fw_Upgrade_Delta_Next(ctx);
+            else
+                ctx->state = FW_UPGRADE_DELTA_STATE_ADD_SAME;
+            break;
+
+        case FW_UPGRADE_DELTA_STATE_DATA:
+            n = (ctx->remaining > len) ? len : ctx->remaining;
+            if( io->write(io->param, ctx->out_count, data, n) != 0 ) {
+                return FW_UPGRADE_DELTA_ERR_IO;
+            }
+            ctx->out_count += n;
+            ctx->remaining -= n;
+            data += n;
+            len -= n;
+            if( ctx->remaining == 0 )
+                fw_Upgrade_Delta_Next(ctx);
+            break;
+
+        default:
+            //data after the end of the new image
+            return FW_UPGRADE_DELTA_ERR_FORMAT;
+        }
+    }
+    return FW_UPGRADE_DELTA_OK;
+}
+
+int fw_Upgrade_Delta_Done(const fw_Upgrade_Delta_Ctx_t *ctx)
+{
+    return (ctx->state == FW_UPGRADE_DELTA_STATE_DONE);
+}
@@ -0,0 +1,99 @@
+/*
+* Copyright (c) 2017-2018 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _FW_UPGRADE_DELTA_H
+#define _FW_UPGRADE_DELTA_H
+
+#include <stdint.h>
+
+/*
+ * Delta image
+ *
+ * A delta image rebuilds the new image from the same image in the active FWD.
+ * It starts with fw_Upgrade_Delta_Hdr_t followed by commands:
+ *
+ *   ADD  <zigzag varint source offset from end of last ADD> <varint length>
+ *        (<varint unchanged length> [<varint changed length> <changed bytes>])...
+ *        new bytes are source bytes plus the changed bytes (mod 256), the
+ *        unchanged/changed runs cover length
+ *   DATA <varint length> <bytes>
+ *        new bytes are given as is
+ *
+ * Varints are little endian base 128. The applier keeps no data between calls,
+ * only its state, so a delta image can be suspended and resumed anywhere.
+ */
+#define FW_UPGRADE_DELTA_MAGIC              0x4C544446          /* "FDTL" */
+#define FW_UPGRADE_DELTA_HASH_LEN           32
+
+#define FW_UPGRADE_DELTA_OP_ADD             1
+#define FW_UPGRADE_DELTA_OP_DATA            2
+
+#define FW_UPGRADE_DELTA_OK                 0
+#define FW_UPGRADE_DELTA_ERR_FORMAT         -1                  /* corrupted delta */
+#define FW_UPGRADE_DELTA_ERR_SOURCE         -2                  /* delta is not for this source image */
+#define FW_UPGRADE_DELTA_ERR_IO             -3                  /* read or write callback failed */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t source_length;                     /* source bytes the delta was made against */
+    uint32_t target_length;                     /* length of the new image */
+    uint8_t  source_hash[FW_UPGRADE_DELTA_HASH_LEN];   /* SHA-256 of the source bytes */
+} __attribute__ ((packed)) fw_Upgrade_Delta_Hdr_t;
+
+typedef struct {
+    uint32_t state;
+    uint32_t hdr_count;                         /* header bytes received */
+    fw_Upgrade_Delta_Hdr_t hdr;
+    uint32_t varint;                            /* varint being decoded */
+    uint32_t shift;
+    uint32_t src_pos;                           /* source offset of next ADD byte */
+    uint32_t remaining;                         /* bytes left in current command */
+    uint32_t run;                               /* bytes left in current unchanged/changed run */
+    uint32_t out_count;                         /* new image bytes written */
+} fw_Upgrade_Delta_Ctx_t;
+
+/*
+ * source read and new image write, return 0 on success
+ */
+typedef struct {
+    int  (*read)(void *param, uint32_t offset, uint8_t *buf, uint32_t len);
+    int  (*write)(void *param, uint32_t offset, const uint8_t *data, uint32_t len);
+    void  *param;
+} fw_Upgrade_Delta_IO_t;
+
+/*
+ * start a new delta image
+ */
+void fw_Upgrade_Delta_Init(fw_Upgrade_Delta_Ctx_t *ctx);
+
+/*
+ * apply the next len bytes of the delta image, the source is checked against
+ * the header hash once the header is received
+ */
+int fw_Upgrade_Delta_Apply(fw_Upgrade_Delta_Ctx_t *ctx, const fw_Upgrade_Delta_IO_t *io, const uint8_t *data, uint32_t len);
+
+/*
+ * check if the whole new image is written
+ */
+int fw_Upgrade_Delta_Done(const fw_Upgrade_Delta_Ctx_t *ctx);
+
+#endif /* _FW_UPGRADE_DELTA_H */
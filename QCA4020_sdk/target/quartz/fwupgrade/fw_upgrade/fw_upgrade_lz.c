@@ -0,0 +1,242 @@
+/*
+* Copyright (c) 2017-2018 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+/*****************************************************************************************************************************/
+/*                                                                                                                           */
+/*       Firmware Upgrade compressed image                                                                                   */
+/*                                                                                                                           */
+/*****************************************************************************************************************************/
+#include <stdint.h>
+#include <string.h>
+#include "fw_upgrade_lz.h"
+
+#define FW_UPGRADE_LZ_WINDOW_MASK           (FW_UPGRADE_LZ_WINDOW_SIZE - 1)
+
+enum {
+    FW_UPGRADE_LZ_STATE_HDR = 0,
+    FW_UPGRADE_LZ_STATE_TOKEN,
+    FW_UPGRADE_LZ_STATE_LIT_LEN,
+    FW_UPGRADE_LZ_STATE_LIT,
+    FW_UPGRADE_LZ_STATE_OFFSET_LO,
+    FW_UPGRADE_LZ_STATE_OFFSET_HI,
+    FW_UPGRADE_LZ_STATE_MATCH_LEN,
+    FW_UPGRADE_LZ_STATE_DONE,
+};
+
+/*
+ * add one byte to the varint, return 1 when the varint is complete
+ */
+static int fw_Upgrade_Lz_Varint(fw_Upgrade_Lz_Ctx_t *ctx, uint8_t c)
+{
+    if( ctx->shift > 28 ) {
+        return FW_UPGRADE_LZ_ERR_FORMAT;
+    }
+    ctx->varint |= (uint32_t)(c & 0x7F) << ctx->shift;
+    ctx->shift += 7;
+    if( c & 0x80 ) {
+        return 0;
+    }
+    ctx->shift = 0;
+    return 1;
+}
+
+/*
+ * literals are done, go on with the match or finish once the whole image is out
+ */
+static int fw_Upgrade_Lz_End_Literals(fw_Upgrade_Lz_Ctx_t *ctx)
+{
+    if( ctx->out_count == ctx->hdr.length ) {
+        ctx->state = FW_UPGRADE_LZ_STATE_DONE;
+    } else {
+        ctx->state = FW_UPGRADE_LZ_STATE_OFFSET_LO;
+    }
+    return FW_UPGRADE_LZ_OK;
+}
+
+/*
+ * start the literals of a sequence
+ */
+static int fw_Upgrade_Lz_Start_Literals(fw_Upgrade_Lz_Ctx_t *ctx, uint32_t len)
+{
+    if( len > ctx->hdr.length - ctx->out_count ) {
+        return FW_UPGRADE_LZ_ERR_FORMAT;
+    }
+    ctx->lit_len = len;
+    if( len == 0 ) {
+        return fw_Upgrade_Lz_End_Literals(ctx);
+    }
+    ctx->state = FW_UPGRADE_LZ_STATE_LIT;
+    return FW_UPGRADE_LZ_OK;
+}
+
+/*
+ * copy the match from the window, the window is output in contiguous pieces
+ */
+static int fw_Upgrade_Lz_Match(fw_Upgrade_Lz_Ctx_t *ctx, fw_Upgrade_Lz_Output_t output, void *param)
+{
+    uint32_t start, n, i;
+
+    if( ctx->match_len > ctx->hdr.length - ctx->out_count ) {
+        return FW_UPGRADE_LZ_ERR_FORMAT;
+    }
+
+    while( ctx->match_len > 0 )
+    {
+        start = ctx->out_count & FW_UPGRADE_LZ_WINDOW_MASK;
+        n = FW_UPGRADE_LZ_WINDOW_SIZE - start;
+        if( n > ctx->match_len )
+            n = ctx->match_len;
+
+        //byte by byte, the match may overlap itself
+        for( i = 0; i < n; i++ )
+            ctx->window[start + i] = ctx->window[(ctx->out_count + i - ctx->offset) & FW_UPGRADE_LZ_WINDOW_MASK];
+
+        if( output(param, &ctx->window[start], n) != 0 ) {
+            return FW_UPGRADE_LZ_ERR_OUTPUT;
+        }
+        ctx->out_count += n;
+        ctx->match_len -= n;
+    }
+
+    ctx->state = (ctx->out_count == ctx->hdr.length) ? FW_UPGRADE_LZ_STATE_DONE : FW_UPGRADE_LZ_STATE_TOKEN;
+    return FW_UPGRADE_LZ_OK;
+}
+
+void fw_Upgrade_Lz_Init(fw_Upgrade_Lz_Ctx_t *ctx)
+{
+    memset(ctx, 0, sizeof(fw_Upgrade_Lz_Ctx_t));
+    ctx->state = FW_UPGRADE_LZ_STATE_HDR;
+}
+
+int fw_Upgrade_Lz_Apply(fw_Upgrade_Lz_Ctx_t *ctx, fw_Upgrade_Lz_Output_t output, void *param, const uint8_t *data, uint32_t len)
+{
+    uint32_t n, start, part;
+    uint8_t  c;
+    int rtn = FW_UPGRADE_LZ_OK;
+
+    while( (len > 0) && (rtn == FW_UPGRADE_LZ_OK) )
+    {
+        switch( ctx->state )
+        {
+        case FW_UPGRADE_LZ_STATE_HDR:
+            n = sizeof(fw_Upgrade_Lz_Hdr_t) - ctx->hdr_count;
+            if( n > len )
+                n = len;
+            memcpy((uint8_t *)&ctx->hdr + ctx->hdr_count, data, n);
+            ctx->hdr_count += n;
+            data += n;
+            len -= n;
+            if( ctx->hdr_count < sizeof(fw_Upgrade_Lz_Hdr_t) )
+                break;
+
+            if( (ctx->hdr.magic != FW_UPGRADE_LZ_MAGIC) || (ctx->hdr.window_size > FW_UPGRADE_LZ_WINDOW_SIZE) ) {
+                return FW_UPGRADE_LZ_ERR_FORMAT;
+            }
+            ctx->state = (ctx->hdr.length == 0) ? FW_UPGRADE_LZ_STATE_DONE : FW_UPGRADE_LZ_STATE_TOKEN;
+            break;
+
+        case FW_UPGRADE_LZ_STATE_TOKEN:
+            c = *data++;
+            len--;
+            ctx->match_len = c & 0x0F;
+            if( (c >> 4) == 0x0F ) {
+                ctx->varint = 0;
+                ctx->state = FW_UPGRADE_LZ_STATE_LIT_LEN;
+            } else {
+                rtn = fw_Upgrade_Lz_Start_Literals(ctx, c >> 4);
+            }
+            break;
+
+        case FW_UPGRADE_LZ_STATE_LIT_LEN:
+        case FW_UPGRADE_LZ_STATE_MATCH_LEN:
+            rtn = fw_Upgrade_Lz_Varint(ctx, *data++);
+            len--;
+            if( rtn <= 0 )
+                break;
+
+            if( ctx->varint > ctx->hdr.length ) {
+                return FW_UPGRADE_LZ_ERR_FORMAT;
+            }
+            if( ctx->state == FW_UPGRADE_LZ_STATE_LIT_LEN ) {
+                rtn = fw_Upgrade_Lz_Start_Literals(ctx, 0x0F + ctx->varint);
+            } else {
+                ctx->match_len = 0x0F + FW_UPGRADE_LZ_MIN_MATCH + ctx->varint;
+                rtn = fw_Upgrade_Lz_Match(ctx, output, param);
+            }
+            break;
+
+        case FW_UPGRADE_LZ_STATE_LIT:
+            n = (ctx->lit_len > len) ? len : ctx->lit_len;
+
+            //keep the last literals in the window, the output gets them from the input
+            start = (n > FW_UPGRADE_LZ_WINDOW_SIZE) ? (n - FW_UPGRADE_LZ_WINDOW_SIZE) : 0;
+            while( start < n )
+            {
+                part = FW_UPGRADE_LZ_WINDOW_SIZE - ((ctx->out_count + start) & FW_UPGRADE_LZ_WINDOW_MASK);
+                if( part > n - start )
+                    part = n - start;
+                memcpy(&ctx->window[(ctx->out_count + start) & FW_UPGRADE_LZ_WINDOW_MASK], data + start, part);
+                start += part;
+            }
+            if( output(param, data, n) != 0 ) {
+                return FW_UPGRADE_LZ_ERR_OUTPUT;
+            }
+            ctx->out_count += n;
+            ctx->lit_len -= n;
+            data += n;
+            len -= n;
+            if( ctx->lit_len == 0 )
+                rtn = fw_Upgrade_Lz_End_Literals(ctx);
+            break;
+
+        case FW_UPGRADE_LZ_STATE_OFFSET_LO:
+            ctx->offset = *data++;
+            len--;
+            ctx->state = FW_UPGRADE_LZ_STATE_OFFSET_HI;
+            break;
+
+        case FW_UPGRADE_LZ_STATE_OFFSET_HI:
+            ctx->offset |= (uint32_t)(*data++) << 8;
+            len--;
+            if( (ctx->offset == 0) || (ctx->offset > ctx->hdr.window_size) || (ctx->offset > ctx->out_count) ) {
+                return FW_UPGRADE_LZ_ERR_FORMAT;
+            }
+            if( ctx->match_len == 0x0F ) {
+                ctx->varint = 0;
+                ctx->state = FW_UPGRADE_LZ_STATE_MATCH_LEN;
+            } else {
+                ctx->match_len += FW_UPGRADE_LZ_MIN_MATCH;
+                rtn = fw_Upgrade_Lz_Match(ctx, output, param);
+            }
+            break;
+
+        default:
+            //data after the end of the image
+            return FW_UPGRADE_LZ_ERR_FORMAT;
+        }
+    }
+    return (rtn < 0) ? rtn : FW_UPGRADE_LZ_OK;
+}
+
+int fw_Upgrade_Lz_Done(const fw_Upgrade_Lz_Ctx_t *ctx)
+{
+    return (ctx->state == FW_UPGRADE_LZ_STATE_DONE);
+}
@@ -0,0 +1,92 @@
+/*
+* Copyright (c) 2017-2018 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _FW_UPGRADE_LZ_H
+#define _FW_UPGRADE_LZ_H
+
+#include <stdint.h>
+
+/*
+ * Compressed image
+ *
+ * A compressed image starts with fw_Upgrade_Lz_Hdr_t followed by sequences:
+ *
+ *   <token> [<varint literal length - 15>] <literals> <offset lo> <offset hi> [<varint match length - 19>]
+ *
+ * The high nibble of the token is the literal length and the low nibble is the
+ * match length - FW_UPGRADE_LZ_MIN_MATCH, 15 means a varint follows. The match
+ * copies from offset bytes back in the output. The image ends after the
+ * literals which complete the output, without offset.
+ *
+ * The window of the last output bytes is part of the context, so the context
+ * is all that needs to be kept over suspend.
+ */
+#define FW_UPGRADE_LZ_MAGIC                 0x5A4C4446          /* "FDLZ" */
+#ifndef FW_UPGRADE_LZ_WINDOW_SIZE
+#define FW_UPGRADE_LZ_WINDOW_SIZE           1024                /* power of 2, images with a larger window are rejected */
+#endif
+#define FW_UPGRADE_LZ_MIN_MATCH             4
+
+#define FW_UPGRADE_LZ_OK                    0
+#define FW_UPGRADE_LZ_ERR_FORMAT            -1                  /* corrupted image */
+#define FW_UPGRADE_LZ_ERR_OUTPUT            -2                  /* output callback failed */
+
+typedef struct {
+    uint32_t magic;
+    uint32_t length;                            /* length of the decompressed image */
+    uint32_t window_size;                       /* largest match offset used */
+} __attribute__ ((packed)) fw_Upgrade_Lz_Hdr_t;
+
+typedef struct {
+    uint32_t state;
+    uint32_t hdr_count;                         /* header bytes received */
+    fw_Upgrade_Lz_Hdr_t hdr;
+    uint32_t varint;                            /* varint being decoded */
+    uint32_t shift;
+    uint32_t lit_len;                           /* literals left in current sequence */
+    uint32_t match_len;
+    uint32_t offset;
+    uint32_t out_count;                         /* decompressed bytes passed to output */
+    uint8_t  window[FW_UPGRADE_LZ_WINDOW_SIZE]; /* last output bytes, indexed by out_count */
+} fw_Upgrade_Lz_Ctx_t;
+
+/*
+ * decompressed data output, out_count of the context is the offset of data, return 0 on success
+ */
+typedef int (*fw_Upgrade_Lz_Output_t)(void *param, const uint8_t *data, uint32_t len);
+
+/*
+ * start a new compressed image
+ */
+void fw_Upgrade_Lz_Init(fw_Upgrade_Lz_Ctx_t *ctx);
+
+/*
+ * decompress the next len bytes of the compressed image
+ */
+int fw_Upgrade_Lz_Apply(fw_Upgrade_Lz_Ctx_t *ctx, fw_Upgrade_Lz_Output_t output, void *param, const uint8_t *data, uint32_t len);
+
+/*
+ * check if the whole image is decompressed
+ */
+int fw_Upgrade_Lz_Done(const fw_Upgrade_Lz_Ctx_t *ctx);
+
+#endif /* _FW_UPGRADE_LZ_H */
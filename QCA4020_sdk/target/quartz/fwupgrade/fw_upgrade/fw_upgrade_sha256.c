@@ -0,0 +1,193 @@
+/*
+* Copyright (c) 2017-2018 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/*****************************************************************************************************************************/
+/*                                                                                                                           */
+/*       Firmware Upgrade image SHA-256                                                                                      */
+/*                                                                                                                           */
+/*****************************************************************************************************************************/
+#include <stdint.h>
+#include <string.h>
+#include "fw_upgrade_sha256.h"
+
+#define ROR32(x, n)     (((x) >> (n)) | ((x) << (32 - (n))))
+
+static const uint32_t fw_upgrade_sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/*
+ * hash one 64 bytes block into the state
+ */
+static void fw_Upgrade_Sha256_Block(uint32_t *state, const uint8_t *block)
+{
+    uint32_t w[16], a, b, c, d, e, f, g, h, t1, t2, s0, s1;
+    uint32_t i;
+
+    a = state[0]; b = state[1]; c = state[2]; d = state[3];
+    e = state[4]; f = state[5]; g = state[6]; h = state[7];
+
+    for( i = 0; i < 64; i++ )
+    {
+        //message schedule is kept as a 16 word ring
+        if( i < 16 ) {
+            w[i] = ((uint32_t)block[4*i] << 24) | ((uint32_t)block[4*i+1] << 16) | ((uint32_t)block[4*i+2] << 8) | block[4*i+3];
+        } else {
+            s0 = ROR32(w[(i+1) & 15], 7) ^ ROR32(w[(i+1) & 15], 18) ^ (w[(i+1) & 15] >> 3);
+            s1 = ROR32(w[(i+14) & 15], 17) ^ ROR32(w[(i+14) & 15], 19) ^ (w[(i+14) & 15] >> 10);
+            w[i & 15] += s0 + s1 + w[(i+9) & 15];
+        }
+
+        t1 = h + (ROR32(e, 6) ^ ROR32(e, 11) ^ ROR32(e, 25)) + ((e & f) ^ (~e & g)) + fw_upgrade_sha256_k[i] + w[i & 15];
+        t2 = (ROR32(a, 2) ^ ROR32(a, 13) ^ ROR32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+/*
+ * start a new digest
+ */
+void fw_Upgrade_Sha256_Init(fw_Upgrade_Sha256_Ctx_t *ctx)
+{
+    ctx->state[0] = 0x6a09e667;
+    ctx->state[1] = 0xbb67ae85;
+    ctx->state[2] = 0x3c6ef372;
+    ctx->state[3] = 0xa54ff53a;
+    ctx->state[4] = 0x510e527f;
+    ctx->state[5] = 0x9b05688c;
+    ctx->state[6] = 0x1f83d9ab;
+    ctx->state[7] = 0x5be0cd19;
+    ctx->count = 0;
+}
+
+/*
+ * add data to the digest
+ */
+void fw_Upgrade_Sha256_Update(fw_Upgrade_Sha256_Ctx_t *ctx, const uint8_t *data, uint32_t len)
+{
+    uint32_t used, n;
+
+    used = ctx->count % FW_UPGRADE_SHA256_BLOCK_LEN;
+    ctx->count += len;
+
+    //complete the pending block first
+    if( used != 0 ) {
+        n = FW_UPGRADE_SHA256_BLOCK_LEN - used;
+        if( len < n ) {
+            memcpy(&ctx->block[used], data, len);
+            return;
+        }
+        memcpy(&ctx->block[used], data, n);
+        fw_Upgrade_Sha256_Block(ctx->state, ctx->block);
+        data += n;
+        len -= n;
+    }
+
+    //full blocks are hashed in place
+    while( len >= FW_UPGRADE_SHA256_BLOCK_LEN )
+    {
+        fw_Upgrade_Sha256_Block(ctx->state, data);
+        data += FW_UPGRADE_SHA256_BLOCK_LEN;
+        len -= FW_UPGRADE_SHA256_BLOCK_LEN;
+    }
+
+    if( len > 0 ) {
+        memcpy(ctx->block, data, len);
+    }
+}
+
+/*
+ * add len bytes of 0xFF to the digest
+ */
+void fw_Upgrade_Sha256_Update_Fill(fw_Upgrade_Sha256_Ctx_t *ctx, uint32_t len)
+{
+    uint32_t used, n;
+
+    used = ctx->count % FW_UPGRADE_SHA256_BLOCK_LEN;
+    ctx->count += len;
+
+    if( used != 0 ) {
+        n = FW_UPGRADE_SHA256_BLOCK_LEN - used;
+        if( len < n ) {
+            memset(&ctx->block[used], 0xFF, len);
+            return;
+        }
+        memset(&ctx->block[used], 0xFF, n);
+        fw_Upgrade_Sha256_Block(ctx->state, ctx->block);
+        len -= n;
+    }
+
+    //the pending block is free now, fill it once and hash it as many times as needed
+    memset(ctx->block, 0xFF, FW_UPGRADE_SHA256_BLOCK_LEN);
+    while( len >= FW_UPGRADE_SHA256_BLOCK_LEN )
+    {
+        fw_Upgrade_Sha256_Block(ctx->state, ctx->block);
+        len -= FW_UPGRADE_SHA256_BLOCK_LEN;
+    }
+}
+
+/*
+ * get the digest
+ */
+void fw_Upgrade_Sha256_Final(fw_Upgrade_Sha256_Ctx_t *ctx, uint8_t *digest)
+{
+    uint32_t used, i;
+    uint32_t bits_hi, bits_lo;
+
+    used = ctx->count % FW_UPGRADE_SHA256_BLOCK_LEN;
+    bits_hi = ctx->count >> 29;
+    bits_lo = ctx->count << 3;
+
+    //append 0x80, zeros and the length in bits
+    ctx->block[used++] = 0x80;
+    if( used > FW_UPGRADE_SHA256_BLOCK_LEN - 8 ) {
+        memset(&ctx->block[used], 0, FW_UPGRADE_SHA256_BLOCK_LEN - used);
+        fw_Upgrade_Sha256_Block(ctx->state, ctx->block);
+        used = 0;
+    }
+    memset(&ctx->block[used], 0, FW_UPGRADE_SHA256_BLOCK_LEN - 8 - used);
+    for( i = 0; i < 4; i++ )
+    {
+        ctx->block[56 + i] = (uint8_t)(bits_hi >> (24 - 8*i));
+        ctx->block[60 + i] = (uint8_t)(bits_lo >> (24 - 8*i));
+    }
+    fw_Upgrade_Sha256_Block(ctx->state, ctx->block);
+
+    for( i = 0; i < 8; i++ )
+    {
+        digest[4*i]   = (uint8_t)(ctx->state[i] >> 24);
+        digest[4*i+1] = (uint8_t)(ctx->state[i] >> 16);
+        digest[4*i+2] = (uint8_t)(ctx->state[i] >> 8);
+        digest[4*i+3] = (uint8_t)(ctx->state[i]);
+    }
+}
@@ -0,0 +1,64 @@
+/*
+* Copyright (c) 2017-2018 Qualcomm Technologies, Inc.
+* All Rights Reserved.
+*/
+// Copyright (c) 2018 Qualcomm Technologies, Inc.
+// All rights reserved.
+// Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below) 
+// provided that the following conditions are met:
+// Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+// Redistributions in binary form must reproduce the above copyright notice, 
+// this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+// Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived 
+// from this software without specific prior written permission.
+// NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE. 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, 
+// BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. 
+// IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, 
+// OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, 
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, 
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef _FW_UPGRADE_SHA256_H
+#define _FW_UPGRADE_SHA256_H
+
+#include <stdint.h>
+
+/*
+ * SHA-256 of the received images
+ *
+ * The state is plain data, so it is kept in the session context in AON memory
+ * and a resumed session goes on hashing from it instead of re-reading the
+ * partition.
+ */
+#define FW_UPGRADE_SHA256_BLOCK_LEN         64
+#define FW_UPGRADE_SHA256_DIGEST_LEN        32
+
+typedef struct {
+    uint32_t state[8];
+    uint32_t count;             /* hashed length in bytes */
+    uint8_t  block[FW_UPGRADE_SHA256_BLOCK_LEN];
+} fw_Upgrade_Sha256_Ctx_t;
+
+/*
+ * start a new digest
+ */
+void fw_Upgrade_Sha256_Init(fw_Upgrade_Sha256_Ctx_t *ctx);
+
+/*
+ * add data to the digest
+ */
+void fw_Upgrade_Sha256_Update(fw_Upgrade_Sha256_Ctx_t *ctx, const uint8_t *data, uint32_t len);
+
+/*
+ * add len bytes of 0xFF to the digest, used for the erased tail of a partition
+ */
+void fw_Upgrade_Sha256_Update_Fill(fw_Upgrade_Sha256_Ctx_t *ctx, uint32_t len);
+
+/*
+ * get the digest, ctx must be initialized again before next use
+ */
+void fw_Upgrade_Sha256_Final(fw_Upgrade_Sha256_Ctx_t *ctx, uint8_t *digest);
+
+#endif /* _FW_UPGRADE_SHA256_H */
@@ -0,0 +1,135 @@
+#!/usr/bin/python
+#
+# Copyright (c) 2018 Qualcomm Technologies, Inc.
+# All Rights Reserved.
+# Copyright (c) 2018 Qualcomm Technologies, Inc.
+# All rights reserved.
+# Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below)
+# provided that the following conditions are met:
+# Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+# Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+# Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived
+# from this software without specific prior written permission.
+# NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE.
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+# BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+# OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+# EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+##################################################################################################################################
+# cpu_profiler_fold_stacks.py: Tool to turn the call stacks recorded by the QCLI_demo CPU profiler into folded stacks, the
+# input format of flamegraph.pl and speedscope.
+#
+# The stacks are the "stack <thread_id> <pc> <return address> ..." lines printed by the CpuProfiler dump_stacks command,
+# innermost address first. Any other console text in the capture is ignored, so a full console log can be given. Addresses
+# are resolved with the function symbols of the image ELF.
+#
+# :params:
+#  --elf :  ELF of the profiled image
+#  --log :  console capture holding one or more dump_stacks outputs (several files may be given)
+#  --nm  :  (Optional) nm to read the ELF symbols with, arm-none-eabi-nm by default.
+#  --threads : (Optional) put the thread ID at the root of each stack.
+#  --out :  (Optional) output file. If not specified StdOUT will be used.
+#
+# Example usage :
+#     python cpu_profiler_fold_stacks.py --elf=QCLI_demo.elf --log=console.log --threads > stacks.folded
+#     flamegraph.pl stacks.folded > stacks.svg
+#
+#############################################################################################################################
+
+import re
+import sys
+import bisect
+import argparse
+import subprocess
+
+STACK_LINE = re.compile(r'stack ([0-9a-fA-F]{8})((?: [0-9a-fA-F]{8})+)')
+NM_LINE = re.compile(r'^([0-9a-fA-F]+) ([0-9a-fA-F]+ )?([tTwWaA]) (.+)$')
+
+class symbol_table:
+    """ Function symbols of the ELF, sorted by address """
+    def __init__(self,elf,nm):
+        symbols = {}
+        output = subprocess.check_output([nm, '-n', '-S', '--defined-only', elf])
+        for line in output.decode('ascii', 'replace').splitlines():
+            match = NM_LINE.match(line.strip())
+            if match is None:
+                continue
+            # Thumb function symbols have bit 0 set, the ROM functions are absolute
+            # symbols and only the Thumb bit tells them apart from data
+            address = int(match.group(1), 16)
+            if (match.group(3) in 'aA') and not (address & 1):
+                continue
+            address &= ~1
+            size = int(match.group(2), 16) if match.group(2) else 0
+            name = match.group(4)
+            if name.startswith('$'):
+                continue
+            if (address not in symbols) or (symbols[address][1] == 0):
+                symbols[address] = (name, size)
+
+        self.addresses = sorted(symbols.keys())
+        self.names = [symbols[address][0] for address in self.addresses]
+        self.sizes = [symbols[address][1] for address in self.addresses]
+
+    def lookup(self,address):
+        index = bisect.bisect_right(self.addresses, address) - 1
+        if index < 0:
+            return '0x%08x' % address
+        if self.sizes[index] and (address >= self.addresses[index] + self.sizes[index]):
+            return '0x%08x' % address
+        return self.names[index]
+
+def fold_stacks(lines, symbols, threads):
+    """ Counts each distinct call stack, root first """
+    stacks = {}
+    samples = 0
+    for line in lines:
+        match = STACK_LINE.search(line)
+        if match is None:
+            continue
+        addresses = [int(word, 16) for word in match.group(2).split()]
+
+        # the first address is the interrupted PC, the others are return addresses, which
+        # point after the call instruction
+        frames = [symbols.lookup(addresses[0])]
+        frames += [symbols.lookup(address - 2) for address in addresses[1:]]
+        frames.reverse()
+        if threads:
+            frames.insert(0, 'thread_' + match.group(1).lower())
+
+        key = ';'.join(frames)
+        stacks[key] = stacks.get(key, 0) + 1
+        samples += 1
+    return stacks, samples
+
+def main():
+    parser = argparse.ArgumentParser(description='Folds the CPU profiler call stacks for flame graphs')
+    parser.add_argument('--elf', required=True, help='ELF of the profiled image')
+    parser.add_argument('--log', required=True, action='append', help='console capture with dump_stacks output')
+    parser.add_argument('--nm', default='arm-none-eabi-nm', help='nm to read the ELF symbols with')
+    parser.add_argument('--threads', action='store_true', help='put the thread ID at the root of each stack')
+    parser.add_argument('--out', help='output file, StdOUT if not given')
+    args = parser.parse_args()
+
+    symbols = symbol_table(args.elf, args.nm)
+
+    lines = []
+    for log in args.log:
+        with open(log, 'r') as fin:
+            lines += fin.readlines()
+
+    stacks, samples = fold_stacks(lines, symbols, args.threads)
+
+    fout = open(args.out, 'w') if args.out else sys.stdout
+    for key in sorted(stacks.keys()):
+        fout.write('%s %u\n' % (key, stacks[key]))
+
+    sys.stderr.write('%u samples, %u distinct stacks\n' % (samples, len(stacks)))
+
+if __name__ == '__main__':
+    main()
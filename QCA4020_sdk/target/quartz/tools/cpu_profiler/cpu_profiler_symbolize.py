@@ -0,0 +1,106 @@
+#!/usr/bin/python
+#
+# Copyright (c) 2018 Qualcomm Technologies, Inc.
+# All Rights Reserved.
+# Copyright (c) 2018 Qualcomm Technologies, Inc.
+# All rights reserved.
+# Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below)
+# provided that the following conditions are met:
+# Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+# Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+# Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived
+# from this software without specific prior written permission.
+# NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE.
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+# BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+# OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+# EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+##################################################################################################################################
+# cpu_profiler_symbolize.py: Tool to turn the results of the QCLI_demo CPU profiler, spooled to the console without a symbol
+# server, into a flat profile with function names.
+#
+# The results are the "results" / "sample <function_address> <samples>" / "thread <thread_id> <samples>" / "results_end"
+# lines printed by "send_results uart" or "send_results flash_read". Any other console text in the capture is ignored, when
+# the capture holds several results the last one is used. Addresses are resolved with the function symbols of the image ELF.
+#
+# :params:
+#  --elf :  ELF of the profiled image
+#  --log :  console capture holding the results
+#  --nm  :  (Optional) nm to read the ELF symbols with, arm-none-eabi-nm by default.
+#  --top :  (Optional) number of functions to show, all by default.
+#
+# Example usage :
+#     python cpu_profiler_symbolize.py --elf=QCLI_demo.elf --log=console.log --top=20
+#
+#############################################################################################################################
+
+import re
+import sys
+import argparse
+from cpu_profiler_fold_stacks import symbol_table
+
+RESULTS_LINE = re.compile(r'results (\d+) (\d+)')
+ENTRY_LINE = re.compile(r'(sample|thread) ([0-9a-fA-F]{8}) (\d+)')
+
+def read_results(lines):
+    """ Function and thread counters of the last complete results in the capture """
+    results = None
+    current = None
+    for line in lines:
+        if 'results_end' in line:
+            if current is not None:
+                results = current
+            current = None
+            continue
+        match = RESULTS_LINE.search(line)
+        if match is not None:
+            current = { 'total' : int(match.group(2)), 'sample' : [], 'thread' : [] }
+            continue
+        match = ENTRY_LINE.search(line)
+        if (match is not None) and (current is not None):
+            current[match.group(1)].append((int(match.group(2), 16), int(match.group(3))))
+    return results
+
+def main():
+    parser = argparse.ArgumentParser(description='Symbolizes the CPU profiler results spooled to the console')
+    parser.add_argument('--elf', required=True, help='ELF of the profiled image')
+    parser.add_argument('--log', required=True, help='console capture with the results')
+    parser.add_argument('--nm', default='arm-none-eabi-nm', help='nm to read the ELF symbols with')
+    parser.add_argument('--top', type=int, default=0, help='number of functions to show')
+    args = parser.parse_args()
+
+    with open(args.log, 'r') as fin:
+        results = read_results(fin.readlines())
+    if results is None:
+        sys.stderr.write('no complete results found in %s\n' % args.log)
+        sys.exit(1)
+
+    symbols = symbol_table(args.elf, args.nm)
+    total = results['total']
+
+    # several table entries may resolve to the same symbol (aliases, ROM patches)
+    functions = {}
+    for address, samples in results['sample']:
+        name = symbols.lookup(address)
+        functions[name] = functions.get(name, 0) + samples
+
+    ranked = sorted(functions.items(), key=lambda item: item[1], reverse=True)
+    if args.top > 0:
+        ranked = ranked[:args.top]
+
+    print('%8s %7s  %s' % ('Samples', 'CPU %', 'Function'))
+    for name, samples in ranked:
+        print('%8u %6.2f%%  %s' % (samples, (100.0 * samples / total) if total else 0, name))
+
+    print('')
+    print('%8s %7s  %s' % ('Samples', 'CPU %', 'Thread ID'))
+    for thread_id, samples in sorted(results['thread'], key=lambda item: item[1], reverse=True):
+        print('%8u %6.2f%%  0x%08x' % (samples, (100.0 * samples / total) if total else 0, thread_id))
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,178 @@
+#!/usr/bin/python
+#
+# Copyright (c) 2018 Qualcomm Technologies, Inc.
+# All Rights Reserved.
+# Copyright (c) 2018 Qualcomm Technologies, Inc.
+# All rights reserved.
+# Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below)
+# provided that the following conditions are met:
+# Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+# Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+# Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived
+# from this software without specific prior written permission.
+# NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE.
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+# BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+# OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+# EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+##################################################################################################################################
+# kpi_diff.py: Tool to compare the KPI results of two firmware builds.
+#
+# The results are the "KPI_JSON" or "KPI_CSV" lines printed by the KPI_Demo kpi_run command, one set per scenario. Any other
+# console text in the captures is ignored, so full console logs can be given. When a scenario was run more than once in a log,
+# the last result is used. The mean and p95 of every phase of the new build are compared with the baseline, and a phase is
+# reported as a regression when either one is slower by more than both the percentage and the absolute threshold. A phase
+# with more failed runs, or missing from the new log, is also a regression.
+#
+# :params:
+#  --base :  console capture of the baseline build
+#  --new  :  console capture of the build under test
+#  --threshold : (Optional) allowed slow down in percent, 10 by default.
+#  --min-delta : (Optional) allowed slow down in ms, 5 by default. Keeps short phases from failing on timer granularity.
+#
+# The exit code is 1 when there is at least one regression, so the tool can gate a release.
+#
+# Example usage :
+#     python kpi_diff.py --base=console_sdk_3_0.log --new=console_sdk_3_1.log
+#     python kpi_diff.py --base=base.log --new=new.log --threshold=5 --min-delta=2
+#
+#############################################################################################################################
+
+import sys
+import json
+import argparse
+
+KPI_SCHEMA = 'qca402x-kpi/1'
+KPI_CSV_FIELDS = ['schema', 'firmware', 'build', 'scenario', 'runs', 'failures', 'phase', 'unit', 'count', 'min', 'mean', 'p95', 'max']
+
+class kpi_log:
+    """ KPI results found in one console capture, by (scenario, phase) """
+    def __init__(self,path):
+        self.phases = {}
+        self.builds = set()
+        self.bad_records = 0
+
+        with open(path, 'r') as fin:
+            for line in fin:
+                line = line.rstrip('\r\n')
+                if 'KPI_JSON ' in line:
+                    self.json_record(line[line.index('KPI_JSON ') + len('KPI_JSON '):])
+                elif 'KPI_CSV ' in line:
+                    self.csv_record(line[line.index('KPI_CSV ') + len('KPI_CSV '):])
+
+    def add(self,scenario,phase,firmware,build,failures,stats):
+        self.builds.add('%s (%s)' % (firmware, build))
+        self.phases[(scenario, phase)] = dict(stats, failures=failures)
+
+    def json_record(self,text):
+        try:
+            record = json.loads(text)
+            if record['schema'] != KPI_SCHEMA:
+                raise ValueError('unknown schema')
+            # a new result for a scenario replaces all of its phases
+            for key in [key for key in self.phases if key[0] == record['scenario']]:
+                del self.phases[key]
+            for phase in record['phases']:
+                self.add(record['scenario'], phase['name'], record['firmware'], record['build'], int(record['failures']),
+                         dict(count=int(phase['count']), mean=float(phase['mean']), p95=float(phase['p95'])))
+        except (ValueError, KeyError, TypeError):
+            # console output of another thread may have been printed in the middle of the line
+            self.bad_records += 1
+
+    def csv_record(self,text):
+        fields = text.split(',')
+        if fields[0] == 'schema':
+            return
+        if (len(fields) != len(KPI_CSV_FIELDS)) or (fields[0] != KPI_SCHEMA):
+            self.bad_records += 1
+            return
+        record = dict(zip(KPI_CSV_FIELDS, fields))
+        try:
+            self.add(record['scenario'], record['phase'], record['firmware'], record['build'], int(record['failures']),
+                     dict(count=int(record['count']), mean=float(record['mean']), p95=float(record['p95'])))
+        except ValueError:
+            self.bad_records += 1
+
+def percent(base,new):
+    if base == 0:
+        return '%+.1fms' % (new - base)
+    return '%+.1f%%' % ((new - base) * 100.0 / base)
+
+def slower(base,new,threshold,min_delta):
+    return (new - base > min_delta) and (new - base > base * threshold / 100.0)
+
+def compare(base,new,threshold,min_delta):
+    """ Returns the table rows and the number of regressions """
+    rows = []
+    regressions = 0
+
+    for key in sorted(set(base.phases.keys()) | set(new.phases.keys())):
+        scenario, phase = key
+        b = base.phases.get(key)
+        n = new.phases.get(key)
+
+        if n is None:
+            rows.append((scenario, phase, '%.1f' % b['mean'], '-', '', '%.1f' % b['p95'], '-', '', 'MISSING'))
+            regressions += 1
+            continue
+        if b is None:
+            rows.append((scenario, phase, '-', '%.1f' % n['mean'], '', '-', '%.1f' % n['p95'], '', 'NEW'))
+            continue
+
+        status = []
+        if slower(b['mean'], n['mean'], threshold, min_delta):
+            status.append('MEAN')
+        if slower(b['p95'], n['p95'], threshold, min_delta):
+            status.append('P95')
+        if n['failures'] > b['failures']:
+            status.append('FAILURES %u->%u' % (b['failures'], n['failures']))
+        if status:
+            regressions += 1
+
+        rows.append((scenario, phase, '%.1f' % b['mean'], '%.1f' % n['mean'], percent(b['mean'], n['mean']),
+                     '%.1f' % b['p95'], '%.1f' % n['p95'], percent(b['p95'], n['p95']),
+                     'REGRESSION ' + ' '.join(status) if status else 'ok'))
+
+    return rows, regressions
+
+def main():
+    parser = argparse.ArgumentParser(description='Compares the kpi_run results of two firmware builds')
+    parser.add_argument('--base', required=True, help='console capture of the baseline build')
+    parser.add_argument('--new', required=True, help='console capture of the build under test')
+    parser.add_argument('--threshold', type=float, default=10.0, help='allowed slow down in percent')
+    parser.add_argument('--min-delta', type=float, default=5.0, help='allowed slow down in ms')
+    args = parser.parse_args()
+
+    base = kpi_log(args.base)
+    new = kpi_log(args.new)
+
+    for name, log in (('base', base), ('new', new)):
+        sys.stdout.write('%-5s %s\n' % (name, ', '.join(sorted(log.builds)) or 'no KPI results'))
+        if log.bad_records:
+            sys.stderr.write('%s: %u unreadable KPI records skipped\n' % (name, log.bad_records))
+
+    if not base.phases:
+        sys.stderr.write('no KPI results in %s\n' % args.base)
+        sys.exit(2)
+
+    rows, regressions = compare(base, new, args.threshold, args.min_delta)
+
+    header = ('scenario', 'phase', 'base mean', 'new mean', 'delta', 'base p95', 'new p95', 'delta', 'status')
+    widths = [max(len(row[i]) for row in rows + [header]) for i in range(len(header))]
+    sys.stdout.write('\n')
+    for row in [header] + rows:
+        sys.stdout.write('  '.join(row[i].ljust(widths[i]) for i in range(len(header))).rstrip() + '\n')
+
+    sys.stdout.write('\n%u phases compared, %u regressions (threshold %.1f%% and %.1f ms)\n' %
+                     (len(rows), regressions, args.threshold, args.min_delta))
+
+    sys.exit(1 if regressions else 0)
+
+if __name__ == '__main__':
+    main()
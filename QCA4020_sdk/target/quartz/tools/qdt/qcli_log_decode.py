@@ -0,0 +1,265 @@
+#!/usr/bin/python
+#
+# Copyright (c) 2018 Qualcomm Technologies, Inc.
+# All Rights Reserved.
+# Copyright (c) 2018 Qualcomm Technologies, Inc.
+# All rights reserved.
+# Redistribution and use in source and binary forms, with or without modification, are permitted (subject to the limitations in the disclaimer below)
+# provided that the following conditions are met:
+# Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+# Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+# Neither the name of Qualcomm Technologies, Inc. nor the names of its contributors may be used to endorse or promote products derived
+# from this software without specific prior written permission.
+# NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY THIS LICENSE.
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,
+# BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+# IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY,
+# OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+# EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+##################################################################################################################################
+# qcli_log_decode.py: Tool to rebuild the QCLI console text of an image built with QCLI_LOG_COMPACT=1, from a live COM port
+# or from a raw capture of the console.
+#
+# QCLI_LOG() messages are sent as binary frames holding the string ID of the format and the raw arguments (see qcli_api.h).
+# The format strings are taken from the string database written by diagMsgCompact.py when the image was linked. Plain QCLI
+# text is passed through unchanged, other frames (for example the Music_Demo2 telemetry) are shown as a one line summary.
+#
+# :params:
+#  --capture :  raw byte capture of the console UART
+#            (OR)
+#  --port :  console COM port
+#  --baud :  (Optional) console baud rate, 115200 by default.
+#  --apps :  (Optional) string database of the image, bin/cortex-m4/diag_msg_QCLI_demo.strdb by default.
+#  --out  :  (Optional) output file for the text. If not specified StdOUT will be used.
+#
+# Example usage :
+#     python qcli_log_decode.py --port=/dev/ttyUSB1
+#     python qcli_log_decode.py --capture=console.bin --out=console.log
+#
+#############################################################################################################################
+
+import re
+import sys
+import argparse
+import struct
+from qca402x_dictionary import qca402x_dictionary
+
+FRAME_SYNC_0 = 0xA5
+FRAME_SYNC_1 = 0x5A
+FRAME_HEADER_SIZE = 9
+FRAME_CRC_SIZE = 2
+FRAME_TYPE_LOG = 0x10
+
+APPS_DICTIONARY = '../../../bin/cortex-m4/diag_msg_QCLI_demo.strdb'
+
+# printf conversions: flags, width, precision, length and conversion
+FORMAT_SPEC = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|j|z|t|L)?([diouxXcsp%])')
+
+def to_text(data):
+    return ''.join(chr(byte) if (0x20 <= byte < 0x7F) or (byte in (0x09, 0x0A, 0x0D)) else '?' for byte in bytearray(data))
+
+def crc16(data):
+    crc = 0xFFFF
+    for byte in bytearray(data):
+        crc ^= byte << 8
+        for bit in range(8):
+            if crc & 0x8000:
+                crc = ((crc << 1) ^ 0x1021) & 0xFFFF
+            else:
+                crc = (crc << 1) & 0xFFFF
+    return crc
+
+class log_arguments:
+    """ Reads the packed arguments of a log frame in the order the format asks for them """
+    def __init__(self,data):
+        self.data = data
+        self.offset = 0
+
+    def int32(self):
+        if self.offset + 4 > len(self.data):
+            raise ValueError('missing argument')
+        value = struct.unpack_from('<I', self.data, self.offset)[0]
+        self.offset += 4
+        return value
+
+    def int64(self):
+        if self.offset + 8 > len(self.data):
+            raise ValueError('missing argument')
+        value = struct.unpack_from('<Q', self.data, self.offset)[0]
+        self.offset += 8
+        return value
+
+    def string(self):
+        end = self.data.find(b'\0', self.offset)
+        if end < 0:
+            raise ValueError('missing argument')
+        value = to_text(self.data[self.offset:end])
+        self.offset = end + 1
+        return value
+
+def format_message(fmt, data):
+    """ Rebuilds the text of a message from its format and packed arguments """
+    args = log_arguments(data)
+    out = []
+    pos = 0
+
+    for spec in FORMAT_SPEC.finditer(fmt):
+        out.append(fmt[pos:spec.start()])
+        pos = spec.end()
+        flags, width, precision, length, conversion = spec.groups()
+
+        if conversion == '%':
+            out.append('%')
+            continue
+
+        if width == '*':
+            width = str(struct.unpack('<i', struct.pack('<I', args.int32()))[0])
+        if precision == '*':
+            precision = str(struct.unpack('<i', struct.pack('<I', args.int32()))[0])
+
+        py_spec = '%' + flags + (width or '') + ('.' + precision if precision is not None else '')
+
+        if conversion == 's':
+            out.append((py_spec + 's') % args.string())
+        elif conversion == 'p':
+            out.append((py_spec + 's') % ('0x%x' % args.int32()))
+        elif conversion == 'c':
+            out.append((py_spec + 'c') % (args.int32() & 0xFF))
+        else:
+            if length in ('ll', 'j'):
+                value = args.int64()
+                if conversion in 'di' and value & (1 << 63):
+                    value -= (1 << 64)
+            else:
+                value = args.int32()
+                if length == 'hh':
+                    value &= 0xFF
+                elif length == 'h':
+                    value &= 0xFFFF
+                if conversion in 'di' and value & (1 << 31):
+                    value -= (1 << 32)
+            out.append((py_spec + ('d' if conversion in 'diu' else conversion)) % value)
+
+    out.append(fmt[pos:])
+    return ''.join(out)
+
+class console_decoder:
+    """ Splits the console byte stream into text and frames """
+    def __init__(self,qdict,fout):
+        self.qdict = qdict
+        self.fout = fout
+        self.buf = bytearray()
+        self.frames = 0
+        self.crc_errors = 0
+        self.unknown_ids = 0
+
+    def feed(self,data):
+        self.buf.extend(bytearray(data))
+
+        while len(self.buf) > 0:
+            start = self.buf.find(bytearray([FRAME_SYNC_0, FRAME_SYNC_1]))
+            if start < 0:
+                # keep a trailing sync byte, it may start a frame
+                keep = 1 if self.buf[-1] == FRAME_SYNC_0 else 0
+                self.text(self.buf[:len(self.buf) - keep])
+                del self.buf[:len(self.buf) - keep]
+                return
+
+            if start > 0:
+                self.text(self.buf[:start])
+                del self.buf[:start]
+
+            if len(self.buf) < FRAME_HEADER_SIZE:
+                return
+
+            size = FRAME_HEADER_SIZE + self.buf[2] + FRAME_CRC_SIZE
+            if len(self.buf) < size:
+                return
+
+            frame = bytes(self.buf[:size])
+            if crc16(frame[2:size - FRAME_CRC_SIZE]) != struct.unpack_from('<H', frame, size - FRAME_CRC_SIZE)[0]:
+                # not a frame after all, drop the sync byte and look again
+                self.crc_errors += 1
+                del self.buf[:1]
+                continue
+
+            del self.buf[:size]
+            self.frames += 1
+            self.frame(frame)
+
+    def text(self,data):
+        if len(data) > 0:
+            self.fout.write(to_text(data))
+
+    def frame(self,frame):
+        length, ftype, sequence, timestamp = struct.unpack_from('<BBBI', frame, 2)
+        payload = frame[FRAME_HEADER_SIZE:FRAME_HEADER_SIZE + length]
+
+        if ftype != FRAME_TYPE_LOG:
+            self.fout.write('[frame type %u seq %u at %u ms, %u bytes]\n' % (ftype, sequence, timestamp, length))
+            return
+
+        if length < 4:
+            self.fout.write('[log seq %u at %u ms: short frame]\n' % (sequence, timestamp))
+            return
+
+        message_id = struct.unpack_from('<I', payload, 0)[0]
+        fmt = self.qdict.find_message(message_id, 0)
+        if fmt == '':
+            self.unknown_ids += 1
+            self.fout.write('[log seq %u at %u ms: message ID %u not found]\n' % (sequence, timestamp, message_id))
+            return
+
+        try:
+            self.fout.write(format_message(fmt, payload[4:]))
+        except (ValueError, TypeError):
+            self.fout.write('[log seq %u at %u ms: bad arguments for "%s"]\n' % (sequence, timestamp, fmt.rstrip('\n')))
+
+def main():
+    parser = argparse.ArgumentParser(description='Rebuilds the QCLI text of an image built with QCLI_LOG_COMPACT=1')
+    parser.add_argument('--capture', help='raw capture of the console UART')
+    parser.add_argument('--port', help='console COM port')
+    parser.add_argument('--baud', type=int, default=115200, help='console baud rate')
+    parser.add_argument('--apps', default=APPS_DICTIONARY, help='string database of the image')
+    parser.add_argument('--out', help='output file, StdOUT if not given')
+    args = parser.parse_args()
+
+    if (args.capture is None) == (args.port is None):
+        parser.error('give one of --capture or --port')
+
+    qdict = qca402x_dictionary()
+    qdict.update(0, args.apps)
+    if qdict.create_apps_cnss_proc_dictionary(0) != 0:
+        sys.exit(1)
+
+    fout = open(args.out, 'w') if args.out else sys.stdout
+    decoder = console_decoder(qdict, fout)
+
+    try:
+        if args.capture is not None:
+            with open(args.capture, 'rb') as fin:
+                while True:
+                    data = fin.read(4096)
+                    if not data:
+                        break
+                    decoder.feed(data)
+        else:
+            import serial
+            ser = serial.Serial(args.port, args.baud, timeout=0.1)
+            while True:
+                data = ser.read(256)
+                if data:
+                    decoder.feed(data)
+                    fout.flush()
+    except KeyboardInterrupt:
+        pass
+
+    decoder.text(decoder.buf)
+    sys.stderr.write('%u frames, %u CRC errors, %u unknown message IDs\n' % (decoder.frames, decoder.crc_errors, decoder.unknown_ids))
+
+if __name__ == '__main__':
+    main()